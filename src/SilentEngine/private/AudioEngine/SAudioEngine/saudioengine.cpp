@@ -16,6 +16,7 @@
 #include "SilentEngine/Public/SCamera/SCamera.h"
 #include "../SSoundMix/ssoundmix.h"
 #include "../SSound/ssound.h"
+#include "../SAudioOutputSink/sxaudio2outputsink.h"
 
 
 SAudioEngine::SAudioEngine()
@@ -46,6 +47,18 @@ bool SAudioEngine::init(bool bEnableLowLatency)
 
     initX3DAudio();
 
+
+    // Batched spatialization outputs a stereo matrix, other layouts use X3DAudio.
+    XAUDIO2_VOICE_DETAILS masterVoiceDetails;
+    pMasteringVoice->GetVoiceDetails(&masterVoiceDetails);
+
+    bStereoOutput = (masterVoiceDetails.InputChannels == 2);
+
+    if (spatializer.start())
+    {
+        return true;
+    }
+
     bEngineInitialized = true;
 
     return false;
@@ -128,8 +141,71 @@ bool SAudioEngine::getMasterVolume(float &fVolume)
     return false;
 }
 
+void SAudioEngine::setDecodedAudioCacheBudget(size_t iBudgetInBytes)
+{
+    decodedAudioCache.setBudget(iBudgetInBytes);
+}
+
+void SAudioEngine::clearUnusedDecodedAudio()
+{
+    decodedAudioCache.removeUnused();
+}
+
+SDecodedAudioCacheStats SAudioEngine::getDecodedAudioCacheStats()
+{
+    return decodedAudioCache.getStats();
+}
+
+bool SAudioEngine::startSoftwareMixer(SAudioOutputSink* pOutputSink)
+{
+    if (bEngineInitialized == false)
+    {
+		SError::showErrorMessageBoxAndLog("the audio engine is not initialized.");
+        return true;
+    }
+
+    if (pOutputSink == nullptr)
+    {
+        if (pSoftwareMixerOutput == nullptr)
+        {
+            pSoftwareMixerOutput = std::make_unique<SXAudio2OutputSink>(pXAudio2Engine);
+        }
+
+        pOutputSink = pSoftwareMixerOutput.get();
+    }
+
+    return softwareMixer.start(pOutputSink);
+}
+
+void SAudioEngine::stopSoftwareMixer()
+{
+    softwareMixer.stop();
+}
+
+SSoftwareMixer* SAudioEngine::getSoftwareMixer()
+{
+    return &softwareMixer;
+}
+
+void SAudioEngine::setMaxReal3DVoiceCount(size_t iMaxRealVoiceCount)
+{
+    voiceVirtualizer.setMaxRealVoiceCount(iMaxRealVoiceCount);
+}
+
+SVoiceVirtualizerStats SAudioEngine::getVoiceVirtualizationStats()
+{
+    return voiceVirtualizer.getStats();
+}
+
 SAudioEngine::~SAudioEngine()
 {
+    // Closes the output voice (if used).
+    softwareMixer.stop();
+    pSoftwareMixerOutput = nullptr;
+
+    spatializer.stop();
+
+
     mtxSoundMix.lock();
 
     for (size_t i = 0; i < vCreatedSoundMixes.size(); i++)
@@ -157,6 +233,13 @@ void SAudioEngine::registerNew3DAudioComponent(SAudioComponent* pAudioComponent)
 	// called in onSpawn() (in spawn mutex)
 
 	vSpawned3DAudioComponents.push_back(pAudioComponent);
+	vVirtualVoices.push_back(SVirtualVoice());
+
+	S3DEmitterState emitter;
+	emitter.iId = iNext3DEmitterId;
+	iNext3DEmitterId++;
+
+	v3DEmitters.push_back(emitter);
 }
 
 void SAudioEngine::unregister3DAudioComponent(SAudioComponent* pAudioComponent)
@@ -169,6 +252,10 @@ void SAudioEngine::unregister3DAudioComponent(SAudioComponent* pAudioComponent)
 	{
 		if (vSpawned3DAudioComponents[i] == pAudioComponent)
 		{
+			vSpawned3DAudioComponents.erase(vSpawned3DAudioComponents.begin() + i);
+			vVirtualVoices.erase(vVirtualVoices.begin() + i);
+			v3DEmitters.erase(v3DEmitters.begin() + i);
+
 			bFound = true;
 			break;
 		}
@@ -184,8 +271,9 @@ void SAudioEngine::update3DSound(SCamera* pPlayerCamera)
 {
 	SVector vCameraLocation = pPlayerCamera->getCameraLocationInWorld();
 	SVector vCameraForwardVector;
+	SVector vCameraRightVector;
 	SVector vCameraUpVector;
-	pPlayerCamera->getCameraBasicVectors(&vCameraForwardVector, nullptr, &vCameraUpVector);
+	pPlayerCamera->getCameraBasicVectors(&vCameraForwardVector, &vCameraRightVector, &vCameraUpVector);
 
 	SListenerProps listenerProps;
 	listenerProps.position = { vCameraLocation.getX(), vCameraLocation.getY(), vCameraLocation.getZ() };
@@ -198,9 +286,139 @@ void SAudioEngine::update3DSound(SCamera* pPlayerCamera)
 
 
 
+	const auto currentTime = std::chrono::steady_clock::now();
+	const double dDeltaTimeInSec = b3DSoundUpdated ? std::chrono::duration<double>(currentTime - last3DSoundUpdateTime).count() : 0.0;
+	last3DSoundUpdateTime = currentTime;
+	b3DSoundUpdated = true;
+
+	const float fInvDeltaTime = (dDeltaTimeInSec > 0.0) ? static_cast<float>(1.0 / dDeltaTimeInSec) : 0.0f;
+
+
+	// Velocities (for doppler) are computed from the positions of the previous frame.
+
+	const float vListenerPosition[3] = { vCameraLocation.getX(), vCameraLocation.getY(), vCameraLocation.getZ() };
+
+	for (int i = 0; i < 3; i++)
+	{
+		spatializerListener.vVelocity[i] = (vListenerPosition[i] - spatializerListener.vPosition[i]) * fInvDeltaTime;
+		spatializerListener.vPosition[i] = vListenerPosition[i];
+	}
+
+	spatializerListener.vRight[0] = vCameraRightVector.getX();
+	spatializerListener.vRight[1] = vCameraRightVector.getY();
+	spatializerListener.vRight[2] = vCameraRightVector.getZ();
+
+
+	// Latest spatialized frame (usually the previous one), emitters are matched by their IDs
+	// (components that were spawned/despawned since then are not matched).
+
+	const SSpatializerOutput* pSpatialized = spatializer.getLatestOutput();
+
+	auto isSpatialized = [&](size_t i)
+	{
+		return pSpatialized && (i < pSpatialized->vEmitterIds.size()) && (pSpatialized->vEmitterIds[i] == v3DEmitters[i].iId);
+	};
+
+
+	// Gather the emitters of this frame (one array per field) and rank non-streamed sounds by the volume at the listener.
+
+	spatializerInput.clear();
+
 	for (size_t i = 0; i < vSpawned3DAudioComponents.size(); i++)
 	{
-		apply3DPropsForComponent(vSpawned3DAudioComponents[i]);
+		SSound* pSound = vSpawned3DAudioComponents[i]->pSound;
+		SVirtualVoice& voice = vVirtualVoices[i];
+		S3DEmitterState& emitter = v3DEmitters[i];
+
+		const SVector vLocation = vSpawned3DAudioComponents[i]->getLocationInWorld();
+		const float vPosition[3] = { vLocation.getX(), vLocation.getY(), vLocation.getZ() };
+		float vVelocity[3] = { 0.0f, 0.0f, 0.0f };
+
+		for (int j = 0; j < 3; j++)
+		{
+			if (emitter.bHasLastPosition)
+			{
+				vVelocity[j] = (vPosition[j] - emitter.vLastPosition[j]) * fInvDeltaTime;
+			}
+
+			emitter.vLastPosition[j] = vPosition[j];
+		}
+		emitter.bHasLastPosition = true;
+
+		spatializerInput.addEmitter(emitter.iId, vPosition, vVelocity, pSound->sound3DProps.fSoundAttenuationMultiplier,
+			pSound->sound3DProps.fDopplerScaler, pSound->sound3DProps.vCustomVolumeCurve);
+
+
+		voice.bActive = pSound->isVoiceActive();
+		if (voice.bActive == false)
+		{
+			continue;
+		}
+
+		float fAttenuation = 0.0f;
+
+		if (isSpatialized(i))
+		{
+			fAttenuation = pSpatialized->vAttenuation[i];
+		}
+		else
+		{
+			fAttenuation = SVoiceVirtualizer::getDistanceAttenuation((vLocation - vCameraLocation).length(),
+				pSound->sound3DProps.fSoundAttenuationMultiplier, pSound->sound3DProps.vCustomVolumeCurve);
+		}
+
+		voice.fAudibility = pSound->fVolume * fAttenuation;
+		voice.iPriority = pSound->sound3DProps.iPriority;
+		voice.fPitch = pSound->fPitch;
+		voice.dLengthInSec = pSound->soundInfo.dSoundLengthInSec;
+		voice.bReal = (pSound->bVirtual == false);
+		voice.dPositionInSec = pSound->dVirtualPositionInSec;
+	}
+
+	// Spatialized on the spatializer thread while this frame is rendered.
+	spatializer.submit(spatializerListener, spatializerInput);
+
+	voiceVirtualizer.update(vVirtualVoices, dDeltaTimeInSec);
+
+
+	for (size_t i = 0; i < vSpawned3DAudioComponents.size(); i++)
+	{
+		SSound* pSound = vSpawned3DAudioComponents[i]->pSound;
+		const SVirtualVoice& voice = vVirtualVoices[i];
+
+		if (pSound->bSoundLoaded == false)
+		{
+			continue;
+		}
+
+		if (voice.bBecameVirtual)
+		{
+			pSound->virtualizeVoice();
+		}
+		else if (voice.bBecameReal)
+		{
+			// Also applies 3D props.
+			pSound->devirtualizeVoice(voice.dPositionInSec);
+		}
+		else if (voice.bFinished)
+		{
+			pSound->endVirtualVoice();
+		}
+		else if (pSound->bVirtual)
+		{
+			if (voice.bActive)
+			{
+				pSound->dVirtualPositionInSec = voice.dPositionInSec;
+			}
+		}
+		else if (bStereoOutput && isSpatialized(i))
+		{
+			pSound->applySpatialization(pSpatialized->vLeftGain[i], pSpatialized->vRightGain[i], pSpatialized->vDopplerFactor[i]);
+		}
+		else
+		{
+			apply3DPropsForComponent(vSpawned3DAudioComponents[i]);
+		}
 	}
 }
 
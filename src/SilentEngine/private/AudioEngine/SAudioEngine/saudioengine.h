@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <mutex>
+#include <chrono>
 
 // XAudio2
 #include <xaudio2.h>
@@ -37,6 +38,13 @@
 
 #pragma comment(lib, "shlwapi.lib")
 
+// Custom
+#include "../SAudioStreamRing/saudiostreamring.h"
+#include "../SDecodedAudioCache/sdecodedaudiocache.h"
+#include "../SSoftwareMixer/ssoftwaremixer.h"
+#include "../SVoiceVirtualizer/svoicevirtualizer.h"
+#include "../SSpatializer/sspatializer.h"
+
 
 
 // ------------------------------------------------------------------------------------------------
@@ -190,7 +198,11 @@ struct VoiceCallback : public IXAudio2VoiceCallback
     }
     void OnBufferEnd(void * pBufferContext)
     {
-        UNREFERENCED_PARAMETER(pBufferContext);
+        if (pBufferContext)
+        {
+            // Buffers of streamed sounds are the slots of their stream ring.
+            static_cast<SAudioStreamRing*>(pBufferContext)->releaseReadSlot();
+        }
 
         SetEvent(hBufferEndEvent);
     }
@@ -214,6 +226,7 @@ struct VoiceCallback : public IXAudio2VoiceCallback
 class SSoundMix;
 class SSound;
 class SAudioComponent;
+class SXAudio2OutputSink;
 
 struct SListenerProps
 {
@@ -223,6 +236,14 @@ struct SListenerProps
     X3DAUDIO_VECTOR velocity; // in units per sec. (only for doppler)
 };
 
+// Spatialization state of a spawned 3D audio component.
+struct S3DEmitterState
+{
+    unsigned long long iId = 0; // see SSpatializerOutput::vEmitterIds
+    float vLastPosition[3] = { 0.0f, 0.0f, 0.0f };
+    bool  bHasLastPosition = false;
+};
+
 //@@Class
 /*
 This class represents an audio engine that controlls all the sounds.
@@ -258,6 +279,62 @@ public:
     bool getMasterVolume(float& fVolume);
 
 
+	//@@Function
+	/*
+	* desc: sets the memory budget of the decoded audio cache (sounds that are not streamed share the decoded data
+	of the same file, the data is kept in the cache after all sounds that used it are deleted so that it's not
+	decoded again, see getDecodedAudioCacheStats()).
+	* remarks: the data that is used by sounds is never removed so the cache can exceed this budget.
+	*/
+	void setDecodedAudioCacheBudget(size_t iBudgetInBytes);
+	//@@Function
+	/*
+	* desc: removes the decoded data that is not used by any sound from the cache (for example, after a level is unloaded).
+	*/
+	void clearUnusedDecodedAudio();
+	//@@Function
+	/*
+	* desc: returns the cache hits, misses, resident size and etc. of the decoded audio cache.
+	*/
+	SDecodedAudioCacheStats getDecodedAudioCacheStats();
+
+
+	//@@Function
+	/*
+	* desc: starts the built-in software mixer (see getSoftwareMixer()) that mixes its voices on the CPU
+	into buses (every SSoundMix has a bus) and outputs them from a dedicated thread.
+	* param "pOutputSink": output of the mixer, pass nullptr to play through XAudio2.
+	* return: true if an error occurred, false otherwise.
+	* remarks: optional, SSound objects are still played by XAudio2 voices.
+	*/
+	bool startSoftwareMixer(SAudioOutputSink* pOutputSink = nullptr);
+	//@@Function
+	/*
+	* desc: stops the software mixer thread.
+	*/
+	void stopSoftwareMixer();
+	//@@Function
+	/*
+	* desc: returns the software mixer, voices can be played and controlled from any thread.
+	*/
+	SSoftwareMixer* getSoftwareMixer();
+
+
+	//@@Function
+	/*
+	* desc: sets the number of 3D sounds that can play on their voices at the same time, when more 3D sounds are playing
+	the quietest ones (see S3DSoundProps::iPriority) become virtual: their voices are stopped and not spatialized,
+	but their position is advanced, so they continue from the right position when they become audible again.
+	* remarks: streamed sounds are never virtual.
+	*/
+	void setMaxReal3DVoiceCount(size_t iMaxRealVoiceCount);
+	//@@Function
+	/*
+	* desc: returns the number of real and virtual 3D sounds (of the last frame).
+	*/
+	SVoiceVirtualizerStats getVoiceVirtualizationStats();
+
+
     ~SAudioEngine();
 
 private:
@@ -300,12 +377,31 @@ private:
 
 
 	std::vector<SAudioComponent*> vSpawned3DAudioComponents;
+	// Same order as vSpawned3DAudioComponents.
+	std::vector<SVirtualVoice>    vVirtualVoices;
+	std::vector<S3DEmitterState>  v3DEmitters;
+	SVoiceVirtualizer             voiceVirtualizer;
+	// Spatializes emitters of a frame on its thread, used if the output is stereo.
+	SSpatializer                  spatializer;
+	SSpatializerInput             spatializerInput;
+	SSpatializerListener          spatializerListener;
+	unsigned long long            iNext3DEmitterId = 1;
+	bool                          bStereoOutput = false;
+	std::chrono::steady_clock::time_point last3DSoundUpdateTime;
+	bool                          b3DSoundUpdated = false;
 
 
     std::mutex mtxSoundMix;
     std::vector<SSoundMix*> vCreatedSoundMixes;
 
 
+    SDecodedAudioCache decodedAudioCache;
+
+
+    SSoftwareMixer softwareMixer;
+    std::unique_ptr<SXAudio2OutputSink> pSoftwareMixerOutput;
+
+
     bool bEngineInitialized;
     bool bEnableLowLatency;
 };
@@ -0,0 +1,44 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+
+
+//@@Class
+/*
+The interface of the output device of the software mixer (SSoftwareMixer).
+The mixer thread writes mixed blocks of interleaved 32 bit float samples and the sink paces the mixer:
+write() blocks until the device is ready to take the block.
+*/
+class SAudioOutputSink
+{
+public:
+	virtual ~SAudioOutputSink() = default;
+
+	//@@Function
+	/*
+	* desc: prepares the sink to receive blocks of the specified format.
+	* return: true if an error occurred, false otherwise.
+	*/
+	virtual bool open (unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock) = 0;
+	//@@Function
+	/*
+	* desc: outputs the block (waits if the device is not ready to take it).
+	* param "pInterleavedSamples": iFrameCount * channel count samples.
+	* param "iFrameCount": not more than the frames per block passed to open().
+	* return: true if an error occurred, false otherwise.
+	*/
+	virtual bool write(const float* pInterleavedSamples, size_t iFrameCount) = 0;
+	//@@Function
+	/*
+	* desc: stops the output, the sink can be opened again.
+	*/
+	virtual void close() = 0;
+};
@@ -0,0 +1,53 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "snullaudiooutputsink.h"
+
+// STL
+#include <thread>
+
+
+SNullAudioOutputSink::SNullAudioOutputSink(bool bRealTime)
+{
+	this->bRealTime = bRealTime;
+}
+
+bool SNullAudioOutputSink::open(unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock)
+{
+	this->iSampleRate = iSampleRate;
+
+	iWrittenFrameCount = 0;
+
+	nextBlockTime = std::chrono::steady_clock::now();
+
+	return false;
+}
+
+bool SNullAudioOutputSink::write(const float* pInterleavedSamples, size_t iFrameCount)
+{
+	if (bRealTime)
+	{
+		// Deadline based so that the sleep error does not accumulate.
+		nextBlockTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(static_cast<double>(iFrameCount) / iSampleRate));
+
+		std::this_thread::sleep_until(nextBlockTime);
+	}
+
+	iWrittenFrameCount += iFrameCount;
+
+	return false;
+}
+
+void SNullAudioOutputSink::close()
+{
+}
+
+unsigned long long SNullAudioOutputSink::getWrittenFrameCount() const
+{
+	return iWrittenFrameCount;
+}
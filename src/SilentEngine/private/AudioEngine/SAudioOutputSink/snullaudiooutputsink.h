@@ -0,0 +1,55 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <atomic>
+#include <chrono>
+
+// Custom
+#include "saudiooutputsink.h"
+
+
+//@@Class
+/*
+The output sink that discards mixed blocks (headless runs, tests and benchmarks).
+*/
+class SNullAudioOutputSink : public SAudioOutputSink
+{
+public:
+	//@@Function
+	/*
+	* desc: creates the sink.
+	* param "bRealTime": if true write() waits for the duration of the block like a real device does,
+	otherwise the mixer runs as fast as it can.
+	*/
+	SNullAudioOutputSink(bool bRealTime = false);
+	SNullAudioOutputSink(const SNullAudioOutputSink&) = delete;
+	SNullAudioOutputSink& operator= (const SNullAudioOutputSink&) = delete;
+
+	bool open (unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock) override;
+	bool write(const float* pInterleavedSamples, size_t iFrameCount) override;
+	void close() override;
+
+	//@@Function
+	/*
+	* desc: returns the number of frames written since open().
+	* remarks: thread-safe.
+	*/
+	unsigned long long getWrittenFrameCount() const;
+
+private:
+
+	std::chrono::steady_clock::time_point nextBlockTime;
+
+	std::atomic<unsigned long long> iWrittenFrameCount{ 0 };
+
+	unsigned long iSampleRate = 0;
+
+	bool bRealTime;
+};
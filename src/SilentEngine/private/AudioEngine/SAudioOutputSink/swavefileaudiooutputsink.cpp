@@ -0,0 +1,207 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "swavefileaudiooutputsink.h"
+
+// STL
+#include <filesystem>
+#include <cstring>
+
+// Engine
+#include "SilentEngine/Private/SError/serror.h"
+
+namespace fs = std::filesystem;
+
+
+#pragma pack(push, 1)
+struct SWaveFileHeader
+{
+	char     vRiffId[4];
+	uint32_t iRiffSizeInBytes;
+	char     vWaveId[4];
+
+	char     vFormatId[4];
+	uint32_t iFormatSizeInBytes;
+	uint16_t iFormatTag;
+	uint16_t iChannelCount;
+	uint32_t iSampleRate;
+	uint32_t iBytesPerSecond;
+	uint16_t iBlockAlign;
+	uint16_t iBitsPerSample;
+
+	char     vDataId[4];
+	uint32_t iDataSizeInBytes;
+};
+#pragma pack(pop)
+
+static const uint16_t iWaveFormatIEEEFloat = 3;
+
+
+SWaveFileAudioOutputSink::SWaveFileAudioOutputSink(const std::wstring& sPathToFile)
+{
+	this->sPathToFile = sPathToFile;
+}
+
+SWaveFileAudioOutputSink::~SWaveFileAudioOutputSink()
+{
+	close();
+}
+
+bool SWaveFileAudioOutputSink::open(unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock)
+{
+	close();
+
+	file.open(fs::path(sPathToFile), std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		SError::showErrorMessageBoxAndLog("failed to create the WAV file.");
+		return true;
+	}
+
+	this->iSampleRate = static_cast<uint32_t>(iSampleRate);
+	this->iChannelCount = static_cast<uint16_t>(iChannelCount);
+	iDataSizeInBytes = 0;
+
+	// Sizes are written in close().
+	writeHeader();
+
+	return false;
+}
+
+bool SWaveFileAudioOutputSink::write(const float* pInterleavedSamples, size_t iFrameCount)
+{
+	if (file.is_open() == false)
+	{
+		SError::showErrorMessageBoxAndLog("the sink is not opened.");
+		return true;
+	}
+
+	const size_t iSizeInBytes = iFrameCount * iChannelCount * sizeof(float);
+
+	file.write(reinterpret_cast<const char*>(pInterleavedSamples), static_cast<std::streamsize>(iSizeInBytes));
+	if (file.fail())
+	{
+		SError::showErrorMessageBoxAndLog("failed to write to the WAV file.");
+		return true;
+	}
+
+	iDataSizeInBytes += static_cast<uint32_t>(iSizeInBytes);
+
+	return false;
+}
+
+void SWaveFileAudioOutputSink::close()
+{
+	if (file.is_open() == false)
+	{
+		return;
+	}
+
+	file.seekp(0);
+	writeHeader();
+
+	file.close();
+}
+
+bool SWaveFileAudioOutputSink::readWaveFile(const std::wstring& sPathToFile, unsigned long& iOutSampleRate, size_t& iOutChannelCount, std::vector<float>& vOutSamples)
+{
+	std::ifstream waveFile(fs::path(sPathToFile), std::ios::binary);
+	if (waveFile.is_open() == false)
+	{
+		SError::showErrorMessageBoxAndLog("failed to open the WAV file.");
+		return true;
+	}
+
+	char vRiffHeader[12];
+	waveFile.read(vRiffHeader, sizeof(vRiffHeader));
+	if (waveFile.fail() || (memcmp(vRiffHeader, "RIFF", 4) != 0) || (memcmp(vRiffHeader + 8, "WAVE", 4) != 0))
+	{
+		SError::showErrorMessageBoxAndLog("the file is not a WAV file.");
+		return true;
+	}
+
+	bool bFormatFound = false;
+
+	// Look for "fmt " and "data" chunks, skip others.
+	while (true)
+	{
+		char vChunkId[4];
+		uint32_t iChunkSizeInBytes = 0;
+
+		waveFile.read(vChunkId, sizeof(vChunkId));
+		waveFile.read(reinterpret_cast<char*>(&iChunkSizeInBytes), sizeof(iChunkSizeInBytes));
+		if (waveFile.fail())
+		{
+			SError::showErrorMessageBoxAndLog("the WAV file has no data.");
+			return true;
+		}
+
+		if (memcmp(vChunkId, "fmt ", 4) == 0)
+		{
+			uint16_t vFormat[8] = {};
+			waveFile.read(reinterpret_cast<char*>(vFormat), 16);
+			waveFile.seekg(iChunkSizeInBytes - 16 + (iChunkSizeInBytes % 2), std::ios::cur);
+
+			// tag, channels, rate (2), bytes per second (2), block align, bits per sample
+			if ((vFormat[0] != iWaveFormatIEEEFloat) || (vFormat[7] != 32))
+			{
+				SError::showErrorMessageBoxAndLog("only 32 bit float WAV files are supported.");
+				return true;
+			}
+
+			iOutChannelCount = vFormat[1];
+			iOutSampleRate = vFormat[2] | (static_cast<uint32_t>(vFormat[3]) << 16);
+
+			bFormatFound = true;
+		}
+		else if (memcmp(vChunkId, "data", 4) == 0)
+		{
+			if (bFormatFound == false)
+			{
+				SError::showErrorMessageBoxAndLog("the WAV file has no format.");
+				return true;
+			}
+
+			vOutSamples.resize(iChunkSizeInBytes / sizeof(float));
+			waveFile.read(reinterpret_cast<char*>(vOutSamples.data()), static_cast<std::streamsize>(vOutSamples.size() * sizeof(float)));
+			if (waveFile.fail())
+			{
+				SError::showErrorMessageBoxAndLog("failed to read the WAV file.");
+				return true;
+			}
+
+			return false;
+		}
+		else
+		{
+			waveFile.seekg(iChunkSizeInBytes + (iChunkSizeInBytes % 2), std::ios::cur);
+		}
+	}
+}
+
+void SWaveFileAudioOutputSink::writeHeader()
+{
+	SWaveFileHeader header;
+
+	memcpy(header.vRiffId, "RIFF", 4);
+	header.iRiffSizeInBytes = sizeof(SWaveFileHeader) - 8 + iDataSizeInBytes;
+	memcpy(header.vWaveId, "WAVE", 4);
+
+	memcpy(header.vFormatId, "fmt ", 4);
+	header.iFormatSizeInBytes = 16;
+	header.iFormatTag = iWaveFormatIEEEFloat;
+	header.iChannelCount = iChannelCount;
+	header.iSampleRate = iSampleRate;
+	header.iBlockAlign = static_cast<uint16_t>(iChannelCount * sizeof(float));
+	header.iBytesPerSecond = iSampleRate * header.iBlockAlign;
+	header.iBitsPerSample = 32;
+
+	memcpy(header.vDataId, "data", 4);
+	header.iDataSizeInBytes = iDataSizeInBytes;
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(SWaveFileHeader));
+}
@@ -0,0 +1,63 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+// Custom
+#include "saudiooutputsink.h"
+
+
+//@@Class
+/*
+The output sink that writes mixed blocks to a WAV file (32 bit float), used for headless runs and golden file tests.
+*/
+class SWaveFileAudioOutputSink : public SAudioOutputSink
+{
+public:
+	//@@Function
+	/*
+	* desc: creates the sink, the file is created in open().
+	*/
+	SWaveFileAudioOutputSink(const std::wstring& sPathToFile);
+	SWaveFileAudioOutputSink(const SWaveFileAudioOutputSink&) = delete;
+	SWaveFileAudioOutputSink& operator= (const SWaveFileAudioOutputSink&) = delete;
+	~SWaveFileAudioOutputSink() override;
+
+	bool open (unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock) override;
+	bool write(const float* pInterleavedSamples, size_t iFrameCount) override;
+	//@@Function
+	/*
+	* desc: writes the final sizes to the file header and closes the file.
+	*/
+	void close() override;
+
+	//@@Function
+	/*
+	* desc: reads a 32 bit float WAV file (for example, written by this sink).
+	* param "vOutSamples": interleaved samples.
+	* return: true if an error occurred, false otherwise.
+	*/
+	static bool readWaveFile(const std::wstring& sPathToFile, unsigned long& iOutSampleRate, size_t& iOutChannelCount, std::vector<float>& vOutSamples);
+
+private:
+
+	void writeHeader();
+
+
+	std::wstring  sPathToFile;
+	std::ofstream file;
+
+	uint32_t iSampleRate = 0;
+	uint16_t iChannelCount = 0;
+	uint32_t iDataSizeInBytes = 0;
+};
@@ -0,0 +1,138 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sxaudio2outputsink.h"
+
+// STL
+#include <cstring>
+
+// Engine
+#include "SilentEngine/Private/SError/serror.h"
+
+
+SXAudio2OutputSink::SXAudio2OutputSink(IXAudio2* pXAudio2Engine)
+{
+	this->pXAudio2Engine = pXAudio2Engine;
+}
+
+SXAudio2OutputSink::~SXAudio2OutputSink()
+{
+	close();
+}
+
+bool SXAudio2OutputSink::open(unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock)
+{
+	close();
+
+	this->iChannelCount = iChannelCount;
+
+	WAVEFORMATEX format = { 0 };
+	format.wFormatTag = WAVE_FORMAT_IEEE_FLOAT;
+	format.nChannels = static_cast<WORD>(iChannelCount);
+	format.nSamplesPerSec = iSampleRate;
+	format.wBitsPerSample = 32;
+	format.nBlockAlign = static_cast<WORD>(iChannelCount * sizeof(float));
+	format.nAvgBytesPerSec = iSampleRate * format.nBlockAlign;
+
+	HRESULT hr = pXAudio2Engine->CreateSourceVoice(&pSourceVoice, &format, 0, XAUDIO2_DEFAULT_FREQ_RATIO, &voiceCallback);
+	if (FAILED(hr))
+	{
+		pSourceVoice = nullptr;
+
+		SError::showErrorMessageBoxAndLog(hr);
+		return true;
+	}
+
+	pRing = std::make_unique<SAudioStreamRing>(iSlotCount, iFramesPerBlock * format.nBlockAlign);
+
+	hr = pSourceVoice->Start();
+	if (FAILED(hr))
+	{
+		SError::showErrorMessageBoxAndLog(hr);
+		return true;
+	}
+
+	return false;
+}
+
+bool SXAudio2OutputSink::write(const float* pInterleavedSamples, size_t iFrameCount)
+{
+	if (pSourceVoice == nullptr)
+	{
+		SError::showErrorMessageBoxAndLog("the sink is not opened.");
+		return true;
+	}
+
+	const size_t iSizeInBytes = iFrameCount * iChannelCount * sizeof(float);
+	if (iSizeInBytes > pRing->getSlotSizeInBytes())
+	{
+		SError::showErrorMessageBoxAndLog("the block is bigger than the size passed to open().");
+		return true;
+	}
+
+
+	// Wait for a free slot (slots are released in VoiceCallback::OnBufferEnd()).
+
+	unsigned char* pSlot = pRing->getWriteSlot();
+	while (pSlot == nullptr)
+	{
+		WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
+
+		pSlot = pRing->getWriteSlot();
+	}
+
+	memcpy(pSlot, pInterleavedSamples, iSizeInBytes);
+
+	pRing->commitWriteSlot(iSizeInBytes);
+
+
+	const unsigned char* pSlotData = nullptr;
+	size_t iSlotSizeInBytes = 0;
+	pRing->acquireReadSlot(pSlotData, iSlotSizeInBytes);
+
+	XAUDIO2_VOICE_STATE state;
+	pSourceVoice->GetState(&state);
+
+	if ((state.BuffersQueued == 0) && (state.SamplesPlayed > 0))
+	{
+		// The voice played all blocks before the mixer wrote this one.
+		pRing->reportUnderrun();
+	}
+
+	XAUDIO2_BUFFER buf = { 0 };
+	buf.AudioBytes = static_cast<UINT32>(iSlotSizeInBytes);
+	buf.pAudioData = pSlotData;
+	buf.pContext = pRing.get(); // the slot is released in VoiceCallback::OnBufferEnd()
+
+	HRESULT hr = pSourceVoice->SubmitSourceBuffer(&buf);
+	if (FAILED(hr))
+	{
+		pRing->releaseReadSlot();
+
+		SError::showErrorMessageBoxAndLog(hr);
+		return true;
+	}
+
+	return false;
+}
+
+void SXAudio2OutputSink::close()
+{
+	if (pSourceVoice == nullptr)
+	{
+		return;
+	}
+
+	pSourceVoice->Stop();
+	pSourceVoice->FlushSourceBuffers();
+
+	// Waits for the callbacks to finish.
+	pSourceVoice->DestroyVoice();
+	pSourceVoice = nullptr;
+
+	pRing = nullptr;
+}
@@ -0,0 +1,50 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <memory>
+
+// Custom
+#include "saudiooutputsink.h"
+#include "../SAudioEngine/saudioengine.h"
+
+
+//@@Class
+/*
+The output sink that plays mixed blocks through an XAudio2 source voice (connected to the mastering voice).
+Blocks are copied to the slots of a stream ring, write() waits for a free slot (released when the voice played it).
+*/
+class SXAudio2OutputSink : public SAudioOutputSink
+{
+public:
+	//@@Function
+	SXAudio2OutputSink(IXAudio2* pXAudio2Engine);
+	SXAudio2OutputSink(const SXAudio2OutputSink&) = delete;
+	SXAudio2OutputSink& operator= (const SXAudio2OutputSink&) = delete;
+	~SXAudio2OutputSink() override;
+
+	bool open (unsigned long iSampleRate, size_t iChannelCount, size_t iFramesPerBlock) override;
+	bool write(const float* pInterleavedSamples, size_t iFrameCount) override;
+	void close() override;
+
+
+	// Blocks queued on the voice (latency is iSlotCount * block duration).
+	static constexpr size_t iSlotCount = 3;
+
+private:
+
+	IXAudio2*               pXAudio2Engine;
+	IXAudio2SourceVoice*    pSourceVoice = nullptr;
+
+	VoiceCallback           voiceCallback;
+
+	std::unique_ptr<SAudioStreamRing> pRing;
+
+	size_t iChannelCount = 0;
+};
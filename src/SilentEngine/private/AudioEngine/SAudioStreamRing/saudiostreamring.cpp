@@ -0,0 +1,216 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "saudiostreamring.h"
+
+// STL
+#include <memory>
+
+
+SAudioStreamRing::SAudioStreamRing(size_t iSlotCount, size_t iSlotSizeInBytes)
+{
+	this->iSlotCount = (iSlotCount < 2) ? 2 : iSlotCount;
+	this->iSlotSizeInBytes = iSlotSizeInBytes;
+
+	// Every slot starts on a cache line.
+	iSlotStride = (iSlotSizeInBytes + iCacheLineSize - 1) / iCacheLineSize * iCacheLineSize;
+
+	vSlotMemory.resize(iSlotStride * this->iSlotCount + iCacheLineSize);
+	vSlotSizes.resize(this->iSlotCount, 0);
+
+	void* pMemory = vSlotMemory.data();
+	size_t iMemorySize = vSlotMemory.size();
+	pFirstSlot = static_cast<unsigned char*>(std::align(iCacheLineSize, iSlotStride * this->iSlotCount, pMemory, iMemorySize));
+}
+
+unsigned char* SAudioStreamRing::getWriteSlot()
+{
+	const size_t iCommitted = iCommittedSlotCount.load(std::memory_order_relaxed);
+
+	if (iCommitted - iReleasedSlotCount.load(std::memory_order_acquire) >= iSlotCount)
+	{
+		return nullptr;
+	}
+
+	return getSlotData(iCommitted % iSlotCount);
+}
+
+bool SAudioStreamRing::fillWriteSlot(SPCMSource* pSource, size_t& iFilledSizeInBytes, bool& bEndOfStream)
+{
+	iFilledSizeInBytes = 0;
+	bEndOfStream = false;
+
+	unsigned char* pSlot = getWriteSlot();
+	if (pSlot == nullptr)
+	{
+		return false;
+	}
+
+	// A decoded block can be bigger or smaller than a slot, the source continues the block on the next read.
+	while (iFilledSizeInBytes < iSlotSizeInBytes)
+	{
+		size_t iReadSizeInBytes = 0;
+
+		if (pSource->readPCM(pSlot + iFilledSizeInBytes, iSlotSizeInBytes - iFilledSizeInBytes, iReadSizeInBytes, bEndOfStream))
+		{
+			return true;
+		}
+
+		iFilledSizeInBytes += iReadSizeInBytes;
+
+		if (bEndOfStream || (iReadSizeInBytes == 0))
+		{
+			break;
+		}
+	}
+
+	return false;
+}
+
+void SAudioStreamRing::commitWriteSlot(size_t iSizeInBytes)
+{
+	const size_t iCommitted = iCommittedSlotCount.load(std::memory_order_relaxed);
+
+	vSlotSizes[iCommitted % iSlotCount] = iSizeInBytes;
+
+	iFilledSlotCount.fetch_add(1, std::memory_order_relaxed);
+	iStreamedBytes.fetch_add(iSizeInBytes, std::memory_order_relaxed);
+
+	// Publish the slot data and size to the consumer.
+	iCommittedSlotCount.store(iCommitted + 1, std::memory_order_release);
+}
+
+bool SAudioStreamRing::refill(SPCMSource* pSource)
+{
+	while (getWriteSlot() && (isEndOfStream() == false))
+	{
+		size_t iFilledSizeInBytes = 0;
+		bool bReachedEndOfStream = false;
+
+		if (fillWriteSlot(pSource, iFilledSizeInBytes, bReachedEndOfStream))
+		{
+			return true;
+		}
+
+		if (iFilledSizeInBytes > 0)
+		{
+			commitWriteSlot(iFilledSizeInBytes);
+		}
+
+		if (bReachedEndOfStream)
+		{
+			markEndOfStream();
+		}
+		else if (iFilledSizeInBytes < iSlotSizeInBytes)
+		{
+			// No data available right now.
+			break;
+		}
+	}
+
+	return false;
+}
+
+void SAudioStreamRing::markEndOfStream()
+{
+	bEndOfStream.store(true, std::memory_order_release);
+}
+
+bool SAudioStreamRing::acquireReadSlot(const unsigned char*& pData, size_t& iSizeInBytes)
+{
+	// Read the end of stream mark first: if it was set, all slots before it are already committed.
+	const bool bStreamEnded = bEndOfStream.load(std::memory_order_acquire);
+
+	const size_t iAcquired = iAcquiredSlotCount.load(std::memory_order_relaxed);
+
+	if (iAcquired == iCommittedSlotCount.load(std::memory_order_acquire))
+	{
+		if (bStreamEnded == false)
+		{
+			iUnderrunCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		pData = nullptr;
+		iSizeInBytes = 0;
+
+		return true;
+	}
+
+	const size_t iSlotIndex = iAcquired % iSlotCount;
+
+	pData = getSlotData(iSlotIndex);
+	iSizeInBytes = vSlotSizes[iSlotIndex];
+
+	iAcquiredSlotCount.store(iAcquired + 1, std::memory_order_relaxed);
+
+	return false;
+}
+
+void SAudioStreamRing::releaseReadSlot()
+{
+	// Can be called by another thread than acquireReadSlot() (the voice callback).
+	iReleasedSlotCount.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void SAudioStreamRing::reportUnderrun()
+{
+	iUnderrunCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SAudioStreamRing::reset()
+{
+	iCommittedSlotCount = 0;
+	iAcquiredSlotCount = 0;
+	iReleasedSlotCount = 0;
+
+	bEndOfStream = false;
+}
+
+size_t SAudioStreamRing::getFreeSlotCount() const
+{
+	return iSlotCount - (iCommittedSlotCount.load(std::memory_order_acquire) - iReleasedSlotCount.load(std::memory_order_acquire));
+}
+
+size_t SAudioStreamRing::getReadySlotCount() const
+{
+	return iCommittedSlotCount.load(std::memory_order_acquire) - iAcquiredSlotCount.load(std::memory_order_acquire);
+}
+
+size_t SAudioStreamRing::getAcquiredSlotCount() const
+{
+	return iAcquiredSlotCount.load(std::memory_order_acquire) - iReleasedSlotCount.load(std::memory_order_acquire);
+}
+
+size_t SAudioStreamRing::getSlotCount() const
+{
+	return iSlotCount;
+}
+
+size_t SAudioStreamRing::getSlotSizeInBytes() const
+{
+	return iSlotSizeInBytes;
+}
+
+bool SAudioStreamRing::isEndOfStream() const
+{
+	return bEndOfStream.load(std::memory_order_acquire);
+}
+
+SAudioStreamStats SAudioStreamRing::getStats() const
+{
+	SAudioStreamStats stats;
+	stats.iUnderrunCount = iUnderrunCount.load(std::memory_order_relaxed);
+	stats.iFilledSlotCount = iFilledSlotCount.load(std::memory_order_relaxed);
+	stats.iStreamedBytes = iStreamedBytes.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+unsigned char* SAudioStreamRing::getSlotData(size_t iSlotIndex)
+{
+	return pFirstSlot + iSlotIndex * iSlotStride;
+}
@@ -0,0 +1,184 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+#include <atomic>
+
+
+//@@Class
+/*
+The interface of the decoded PCM data provider used by SAudioStreamRing (the decoder of the streamed sound).
+*/
+class SPCMSource
+{
+public:
+	virtual ~SPCMSource() = default;
+
+	//@@Function
+	/*
+	* desc: copies the next decoded PCM data.
+	* param "pDestination": memory to copy the data to.
+	* param "iMaxSizeInBytes": size of the pDestination memory.
+	* param "iReadSizeInBytes": number of copied bytes (0 if there is no data available right now).
+	* param "bEndOfStream": set to true if there is no more data in the stream.
+	* return: true if an error occurred, false otherwise.
+	*/
+	virtual bool readPCM(unsigned char* pDestination, size_t iMaxSizeInBytes, size_t& iReadSizeInBytes, bool& bEndOfStream) = 0;
+};
+
+
+struct SAudioStreamStats
+{
+	unsigned long long iUnderrunCount = 0;
+	unsigned long long iFilledSlotCount = 0;
+	unsigned long long iStreamedBytes = 0;
+};
+
+
+//@@Class
+/*
+The class is a fixed ring of preallocated slots (buffers) for the decoded PCM data of a streamed sound.
+One thread (the producer) fills free slots, one consumer (the voice that plays the sound) acquires filled slots
+in the same order and releases them once they are played. The memory of the slots is allocated once
+and every slot starts on a cache line.
+*/
+class SAudioStreamRing
+{
+public:
+	//@@Function
+	/*
+	* desc: allocates the slots.
+	* param "iSlotCount": number of slots (at least 2).
+	* param "iSlotSizeInBytes": size of one slot, should be a multiple of the block align of the sound format.
+	*/
+	SAudioStreamRing(size_t iSlotCount, size_t iSlotSizeInBytes);
+	SAudioStreamRing(const SAudioStreamRing&) = delete;
+	SAudioStreamRing& operator= (const SAudioStreamRing&) = delete;
+
+
+	// Producer.
+
+	//@@Function
+	/*
+	* desc: returns the memory of the next free slot.
+	* return: nullptr if there are no free slots.
+	* remarks: the slot is not used until commitWriteSlot() is called.
+	*/
+	unsigned char* getWriteSlot();
+	//@@Function
+	/*
+	* desc: fills the next free slot with the data from the source (bulk copies directly to the slot memory).
+	* param "iFilledSizeInBytes": number of written bytes, less than the slot size if the source reached the end of stream
+	or had no data available.
+	* return: true if an error occurred, false otherwise.
+	* remarks: the slot is not committed, call commitWriteSlot() to pass it to the consumer.
+	*/
+	bool           fillWriteSlot  (SPCMSource* pSource, size_t& iFilledSizeInBytes, bool& bEndOfStream);
+	//@@Function
+	/*
+	* desc: passes the slot returned by getWriteSlot() to the consumer.
+	*/
+	void           commitWriteSlot(size_t iSizeInBytes);
+	//@@Function
+	/*
+	* desc: fills and commits all free slots.
+	* return: true if an error occurred, false otherwise.
+	* remarks: stops at the end of stream (see isEndOfStream()) or if the source has no data available.
+	*/
+	bool           refill         (SPCMSource* pSource);
+	//@@Function
+	/*
+	* desc: marks that no more slots will be committed until reset() so that the consumer does not count underruns.
+	*/
+	void           markEndOfStream();
+
+
+	// Consumer.
+
+	//@@Function
+	/*
+	* desc: returns the data of the oldest committed slot.
+	* return: true if there is no committed slot (counted as underrun if not the end of stream), false otherwise.
+	*/
+	bool           acquireReadSlot(const unsigned char*& pData, size_t& iSizeInBytes);
+	//@@Function
+	/*
+	* desc: frees the oldest acquired slot.
+	* remarks: thread-safe relative to the producer.
+	*/
+	void           releaseReadSlot();
+	//@@Function
+	/*
+	* desc: counts an underrun detected by the consumer (for example, the voice played all submitted slots).
+	*/
+	void           reportUnderrun ();
+
+
+	//@@Function
+	/*
+	* desc: frees all slots and clears the end of stream mark.
+	* remarks: should only be called when the slots are not used by the producer and the consumer.
+	*/
+	void           reset          ();
+
+	//@@Function
+	/*
+	* desc: returns the number of slots that can be filled.
+	*/
+	size_t         getFreeSlotCount () const;
+	//@@Function
+	/*
+	* desc: returns the number of committed slots that were not acquired yet.
+	*/
+	size_t         getReadySlotCount() const;
+	//@@Function
+	/*
+	* desc: returns the number of acquired slots that were not released yet (still used by the consumer).
+	*/
+	size_t         getAcquiredSlotCount() const;
+	size_t         getSlotCount     () const;
+	size_t         getSlotSizeInBytes() const;
+	bool           isEndOfStream    () const;
+	//@@Function
+	/*
+	* desc: returns the counters since the creation of the ring.
+	*/
+	SAudioStreamStats getStats      () const;
+
+private:
+
+	unsigned char* getSlotData(size_t iSlotIndex);
+
+
+	static constexpr size_t iCacheLineSize = 64;
+
+
+	std::vector<unsigned char> vSlotMemory;
+	std::vector<size_t>        vSlotSizes;
+	unsigned char*             pFirstSlot;
+
+	size_t                     iSlotCount;
+	size_t                     iSlotSizeInBytes;
+	size_t                     iSlotStride;
+
+
+	// The counters only grow, slot index is "counter % iSlotCount".
+	// Each side writes its own cache line.
+	alignas(iCacheLineSize) std::atomic<size_t> iCommittedSlotCount{ 0 };
+	alignas(iCacheLineSize) std::atomic<size_t> iAcquiredSlotCount{ 0 };
+	alignas(iCacheLineSize) std::atomic<size_t> iReleasedSlotCount{ 0 };
+
+	alignas(iCacheLineSize) std::atomic<bool>   bEndOfStream{ false };
+
+	std::atomic<unsigned long long> iUnderrunCount{ 0 };
+	std::atomic<unsigned long long> iFilledSlotCount{ 0 };
+	std::atomic<unsigned long long> iStreamedBytes{ 0 };
+};
@@ -0,0 +1,130 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sdecodedaudiocache.h"
+
+
+SDecodedAudioCache::SDecodedAudioCache(size_t iBudgetInBytes)
+{
+	this->iBudgetInBytes = iBudgetInBytes;
+}
+
+std::shared_ptr<const SDecodedAudio> SDecodedAudioCache::find(const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format)
+{
+	std::lock_guard<std::mutex> lock(mtxCache);
+
+	auto it = entriesByKey.find(makeKey(sAudioFilePath, format));
+	if (it == entriesByKey.end())
+	{
+		iMissCount++;
+
+		return nullptr;
+	}
+
+	iHitCount++;
+
+	// Move to the front (most recently used).
+	vEntries.splice(vEntries.begin(), vEntries, it->second);
+
+	return it->second->pDecodedAudio;
+}
+
+std::shared_ptr<const SDecodedAudio> SDecodedAudioCache::add(const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format, std::vector<unsigned char>&& vPCMData)
+{
+	std::shared_ptr<SDecodedAudio> pDecodedAudio = std::make_shared<SDecodedAudio>();
+	pDecodedAudio->format = format;
+	pDecodedAudio->vPCMData = std::move(vPCMData);
+	pDecodedAudio->vPCMData.shrink_to_fit();
+
+	const std::wstring sKey = makeKey(sAudioFilePath, format);
+
+	std::lock_guard<std::mutex> lock(mtxCache);
+
+	auto it = entriesByKey.find(sKey);
+	if (it != entriesByKey.end())
+	{
+		// Was decoded by another sound at the same time.
+		vEntries.splice(vEntries.begin(), vEntries, it->second);
+
+		return it->second->pDecodedAudio;
+	}
+
+	// Make room for the new entry first.
+	const size_t iNewSizeInBytes = pDecodedAudio->vPCMData.size();
+	removeUnusedEntries((iBudgetInBytes > iNewSizeInBytes) ? iBudgetInBytes - iNewSizeInBytes : 0);
+
+	SEntry entry;
+	entry.sKey = sKey;
+	entry.pDecodedAudio = pDecodedAudio;
+
+	vEntries.push_front(std::move(entry));
+	entriesByKey[sKey] = vEntries.begin();
+
+	iResidentBytes += iNewSizeInBytes;
+
+	return vEntries.front().pDecodedAudio;
+}
+
+void SDecodedAudioCache::setBudget(size_t iBudgetInBytes)
+{
+	std::lock_guard<std::mutex> lock(mtxCache);
+
+	this->iBudgetInBytes = iBudgetInBytes;
+
+	removeUnusedEntries(iBudgetInBytes);
+}
+
+void SDecodedAudioCache::removeUnused()
+{
+	std::lock_guard<std::mutex> lock(mtxCache);
+
+	removeUnusedEntries(0);
+}
+
+SDecodedAudioCacheStats SDecodedAudioCache::getStats()
+{
+	std::lock_guard<std::mutex> lock(mtxCache);
+
+	SDecodedAudioCacheStats stats;
+	stats.iHitCount = iHitCount;
+	stats.iMissCount = iMissCount;
+	stats.iEvictionCount = iEvictionCount;
+	stats.iResidentBytes = iResidentBytes;
+	stats.iEntryCount = vEntries.size();
+	stats.iBudgetInBytes = iBudgetInBytes;
+
+	return stats;
+}
+
+std::wstring SDecodedAudioCache::makeKey(const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format)
+{
+	return sAudioFilePath + L"|" + std::to_wstring(format.iFormatTag) + L"|" + std::to_wstring(format.iChannels)
+		+ L"|" + std::to_wstring(format.iSampleRate) + L"|" + std::to_wstring(format.iBitsPerSample);
+}
+
+void SDecodedAudioCache::removeUnusedEntries(size_t iTargetSizeInBytes)
+{
+	// From the least recently used.
+	auto it = vEntries.end();
+
+	while ((iResidentBytes > iTargetSizeInBytes) && (it != vEntries.begin()))
+	{
+		--it;
+
+		// The cache holds the only reference (sounds copy the pointer only under mtxCache).
+		if (it->pDecodedAudio.use_count() > 1)
+		{
+			continue;
+		}
+
+		iResidentBytes -= it->pDecodedAudio->vPCMData.size();
+		iEvictionCount++;
+
+		entriesByKey.erase(it->sKey);
+		it = vEntries.erase(it);
+	}
+}
@@ -0,0 +1,129 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+
+// Output format of the decoder (see WAVEFORMATEX).
+struct SDecodedAudioFormat
+{
+	unsigned short iFormatTag = 0;
+	unsigned short iChannels = 0;
+	unsigned long  iSampleRate = 0;
+	unsigned short iBitsPerSample = 0;
+};
+
+// Decoded PCM data of a file, shared by all sounds that use this file and never changed after decoding.
+struct SDecodedAudio
+{
+	SDecodedAudioFormat        format;
+	std::vector<unsigned char> vPCMData;
+};
+
+struct SDecodedAudioCacheStats
+{
+	unsigned long long iHitCount = 0;
+	unsigned long long iMissCount = 0;
+	unsigned long long iEvictionCount = 0;
+
+	size_t iResidentBytes = 0;
+	size_t iEntryCount = 0;
+	size_t iBudgetInBytes = 0;
+};
+
+
+//@@Class
+/*
+The class stores decoded PCM data of the sounds that are not streamed, keyed by the file path and the output format,
+so that the sounds that play the same file share one buffer and the file is decoded once.
+Entries that are not used by any sound are kept until the cache does not fit into its memory budget,
+then the least recently used ones are removed.
+*/
+class SDecodedAudioCache
+{
+public:
+	//@@Function
+	/*
+	* desc: creates the cache.
+	* param "iBudgetInBytes": memory budget for the decoded data (entries used by sounds are never removed
+	so the resident size can exceed it).
+	*/
+	SDecodedAudioCache(size_t iBudgetInBytes = iDefaultBudgetInBytes);
+	SDecodedAudioCache(const SDecodedAudioCache&) = delete;
+	SDecodedAudioCache& operator= (const SDecodedAudioCache&) = delete;
+
+	//@@Function
+	/*
+	* desc: returns the decoded data of the file.
+	* return: nullptr if the file was not decoded to this format (miss), valid pointer otherwise (hit).
+	* remarks: thread-safe.
+	*/
+	std::shared_ptr<const SDecodedAudio> find (const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format);
+	//@@Function
+	/*
+	* desc: adds the decoded data of the file.
+	* return: the cached data, if the file was added by another thread in the meantime returns the data that was added first.
+	* remarks: thread-safe.
+	*/
+	std::shared_ptr<const SDecodedAudio> add  (const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format, std::vector<unsigned char>&& vPCMData);
+
+	//@@Function
+	/*
+	* desc: sets the memory budget, removes unused entries that do not fit.
+	*/
+	void                    setBudget        (size_t iBudgetInBytes);
+	//@@Function
+	/*
+	* desc: removes all entries that are not used by sounds.
+	*/
+	void                    removeUnused     ();
+
+	//@@Function
+	/*
+	* desc: returns the counters (hits and misses are counted since the creation of the cache).
+	*/
+	SDecodedAudioCacheStats getStats         ();
+
+
+	static constexpr size_t iDefaultBudgetInBytes = 256 * 1024 * 1024;
+
+private:
+
+	struct SEntry
+	{
+		std::wstring                         sKey;
+		std::shared_ptr<const SDecodedAudio> pDecodedAudio;
+	};
+
+	static std::wstring makeKey(const std::wstring& sAudioFilePath, const SDecodedAudioFormat& format);
+
+	// call under mtxCache
+	void removeUnusedEntries(size_t iTargetSizeInBytes);
+
+
+	std::mutex mtxCache;
+
+	// Most recently used first.
+	std::list<SEntry> vEntries;
+	std::unordered_map<std::wstring, std::list<SEntry>::iterator> entriesByKey;
+
+	size_t iBudgetInBytes;
+	size_t iResidentBytes = 0;
+
+	unsigned long long iHitCount = 0;
+	unsigned long long iMissCount = 0;
+	unsigned long long iEvictionCount = 0;
+};
@@ -0,0 +1,282 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "smixerkernels.h"
+
+// STL
+#include <cmath>
+#include <algorithm>
+
+// SIMD
+#include <emmintrin.h>
+
+
+static const float fPCM16Scale = 1.0f / 32768.0f;
+
+static void convertPCM16ToFloat(const int16_t* pSource, size_t iSourceChannels, float* pOutLeft, float* pOutRight, size_t iFrameCount)
+{
+	const __m128 vScale = _mm_set1_ps(fPCM16Scale);
+
+	size_t i = 0;
+
+	if (iSourceChannels == 1)
+	{
+		for (; i + 4 <= iFrameCount; i += 4)
+		{
+			// Sign extend 4 samples to 32 bit.
+			const __m128i vSamples = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource + i));
+			const __m128i vSamples32 = _mm_srai_epi32(_mm_unpacklo_epi16(vSamples, vSamples), 16);
+
+			_mm_storeu_ps(pOutLeft + i, _mm_mul_ps(_mm_cvtepi32_ps(vSamples32), vScale));
+		}
+
+		for (; i < iFrameCount; i++)
+		{
+			pOutLeft[i] = pSource[i] * fPCM16Scale;
+		}
+	}
+	else
+	{
+		for (; i + 4 <= iFrameCount; i += 4)
+		{
+			// 4 frames: L0 R0 L1 R1 L2 R2 L3 R3.
+			const __m128i vFrames = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i * 2));
+			const __m128i vLeft32 = _mm_srai_epi32(_mm_slli_epi32(vFrames, 16), 16);
+			const __m128i vRight32 = _mm_srai_epi32(vFrames, 16);
+
+			_mm_storeu_ps(pOutLeft + i, _mm_mul_ps(_mm_cvtepi32_ps(vLeft32), vScale));
+			_mm_storeu_ps(pOutRight + i, _mm_mul_ps(_mm_cvtepi32_ps(vRight32), vScale));
+		}
+
+		for (; i < iFrameCount; i++)
+		{
+			pOutLeft[i] = pSource[i * 2] * fPCM16Scale;
+			pOutRight[i] = pSource[i * 2 + 1] * fPCM16Scale;
+		}
+	}
+}
+
+size_t SMixerKernels::resampleToFloat(const int16_t* pSource, size_t iSourceFrameCount, size_t iSourceChannels, double& dPosition, double dStep,
+	bool bLoop, float* pOutLeft, float* pOutRight, size_t iFrameCount)
+{
+	if (iSourceFrameCount == 0)
+	{
+		return 0;
+	}
+
+	size_t iProduced = 0;
+
+	if ((dStep == 1.0) && (dPosition == std::floor(dPosition)))
+	{
+		// Same sample rate: only convert.
+
+		size_t iPosition = static_cast<size_t>(dPosition);
+
+		while (iProduced < iFrameCount)
+		{
+			if (iPosition >= iSourceFrameCount)
+			{
+				if (bLoop == false)
+				{
+					break;
+				}
+
+				iPosition = 0;
+			}
+
+			const size_t iCount = std::min(iFrameCount - iProduced, iSourceFrameCount - iPosition);
+
+			convertPCM16ToFloat(pSource + iPosition * iSourceChannels, iSourceChannels, pOutLeft + iProduced,
+				(iSourceChannels == 2) ? pOutRight + iProduced : nullptr, iCount);
+
+			iProduced += iCount;
+			iPosition += iCount;
+		}
+
+		dPosition = static_cast<double>(iPosition);
+
+		return iProduced;
+	}
+
+
+	// Source frames are gathered for 4 output frames, then interpolated at once.
+
+	const __m128 vScale = _mm_set1_ps(fPCM16Scale);
+
+	alignas(16) float vFirst[2][4];
+	alignas(16) float vSecond[2][4];
+	alignas(16) float vFraction[4];
+	alignas(16) float vResult[2][4];
+
+	while (iProduced < iFrameCount)
+	{
+		size_t iGroupSize = 0;
+
+		for (; (iGroupSize < 4) && (iProduced + iGroupSize < iFrameCount); iGroupSize++)
+		{
+			if (dPosition >= iSourceFrameCount)
+			{
+				if (bLoop == false)
+				{
+					break;
+				}
+
+				dPosition = std::fmod(dPosition, static_cast<double>(iSourceFrameCount));
+			}
+
+			const size_t iFirst = static_cast<size_t>(dPosition);
+
+			size_t iSecond = iFirst + 1;
+			if (iSecond >= iSourceFrameCount)
+			{
+				iSecond = bLoop ? 0 : iFirst;
+			}
+
+			for (size_t iChannel = 0; iChannel < iSourceChannels; iChannel++)
+			{
+				vFirst[iChannel][iGroupSize] = pSource[iFirst * iSourceChannels + iChannel];
+				vSecond[iChannel][iGroupSize] = pSource[iSecond * iSourceChannels + iChannel];
+			}
+
+			vFraction[iGroupSize] = static_cast<float>(dPosition - static_cast<double>(iFirst));
+
+			dPosition += dStep;
+		}
+
+		if (iGroupSize == 0)
+		{
+			break;
+		}
+
+		for (size_t i = iGroupSize; i < 4; i++)
+		{
+			// Unused lanes.
+			vFraction[i] = 0.0f;
+
+			for (size_t iChannel = 0; iChannel < iSourceChannels; iChannel++)
+			{
+				vFirst[iChannel][i] = 0.0f;
+				vSecond[iChannel][i] = 0.0f;
+			}
+		}
+
+		const __m128 vFrac = _mm_load_ps(vFraction);
+
+		for (size_t iChannel = 0; iChannel < iSourceChannels; iChannel++)
+		{
+			const __m128 vA = _mm_load_ps(vFirst[iChannel]);
+			const __m128 vB = _mm_load_ps(vSecond[iChannel]);
+
+			const __m128 vLerp = _mm_add_ps(vA, _mm_mul_ps(_mm_sub_ps(vB, vA), vFrac));
+
+			float* pOut = (iChannel == 0) ? pOutLeft : pOutRight;
+
+			if (iGroupSize == 4)
+			{
+				_mm_storeu_ps(pOut + iProduced, _mm_mul_ps(vLerp, vScale));
+			}
+			else
+			{
+				_mm_store_ps(vResult[iChannel], _mm_mul_ps(vLerp, vScale));
+
+				for (size_t i = 0; i < iGroupSize; i++)
+				{
+					pOut[iProduced + i] = vResult[iChannel][i];
+				}
+			}
+		}
+
+		iProduced += iGroupSize;
+
+		if (iGroupSize < 4)
+		{
+			break;
+		}
+	}
+
+	return iProduced;
+}
+
+void SMixerKernels::mixToStereo(const float* pSourceLeft, const float* pSourceRight, float fLeftGainStart, float fLeftGainEnd,
+	float fRightGainStart, float fRightGainEnd, float* pOutLeft, float* pOutRight, size_t iFrameCount)
+{
+	if (iFrameCount == 0)
+	{
+		return;
+	}
+
+	const float fLeftDelta = (fLeftGainEnd - fLeftGainStart) / iFrameCount;
+	const float fRightDelta = (fRightGainEnd - fRightGainStart) / iFrameCount;
+
+	__m128 vLeftGain = _mm_setr_ps(fLeftGainStart, fLeftGainStart + fLeftDelta, fLeftGainStart + fLeftDelta * 2, fLeftGainStart + fLeftDelta * 3);
+	__m128 vRightGain = _mm_setr_ps(fRightGainStart, fRightGainStart + fRightDelta, fRightGainStart + fRightDelta * 2, fRightGainStart + fRightDelta * 3);
+
+	const __m128 vLeftStep = _mm_set1_ps(fLeftDelta * 4);
+	const __m128 vRightStep = _mm_set1_ps(fRightDelta * 4);
+
+	size_t i = 0;
+
+	for (; i + 4 <= iFrameCount; i += 4)
+	{
+		const __m128 vLeft = _mm_add_ps(_mm_loadu_ps(pOutLeft + i), _mm_mul_ps(_mm_loadu_ps(pSourceLeft + i), vLeftGain));
+		const __m128 vRight = _mm_add_ps(_mm_loadu_ps(pOutRight + i), _mm_mul_ps(_mm_loadu_ps(pSourceRight + i), vRightGain));
+
+		_mm_storeu_ps(pOutLeft + i, vLeft);
+		_mm_storeu_ps(pOutRight + i, vRight);
+
+		vLeftGain = _mm_add_ps(vLeftGain, vLeftStep);
+		vRightGain = _mm_add_ps(vRightGain, vRightStep);
+	}
+
+	for (; i < iFrameCount; i++)
+	{
+		pOutLeft[i] += pSourceLeft[i] * (fLeftGainStart + fLeftDelta * i);
+		pOutRight[i] += pSourceRight[i] * (fRightGainStart + fRightDelta * i);
+	}
+}
+
+void SMixerKernels::interleaveStereo(const float* pLeft, const float* pRight, float fGain, float* pOutput, size_t iFrameCount)
+{
+	const __m128 vGain = _mm_set1_ps(fGain);
+	const __m128 vMin = _mm_set1_ps(-1.0f);
+	const __m128 vMax = _mm_set1_ps(1.0f);
+
+	size_t i = 0;
+
+	for (; i + 4 <= iFrameCount; i += 4)
+	{
+		const __m128 vLeft = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pLeft + i), vGain), vMin), vMax);
+		const __m128 vRight = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pRight + i), vGain), vMin), vMax);
+
+		_mm_storeu_ps(pOutput + i * 2, _mm_unpacklo_ps(vLeft, vRight));
+		_mm_storeu_ps(pOutput + i * 2 + 4, _mm_unpackhi_ps(vLeft, vRight));
+	}
+
+	for (; i < iFrameCount; i++)
+	{
+		pOutput[i * 2] = std::min(std::max(pLeft[i] * fGain, -1.0f), 1.0f);
+		pOutput[i * 2 + 1] = std::min(std::max(pRight[i] * fGain, -1.0f), 1.0f);
+	}
+}
+
+void SMixerKernels::getPanGains(float fVolume, float fPan, size_t iSourceChannels, float& fOutLeftGain, float& fOutRightGain)
+{
+	fPan = std::min(std::max(fPan, -1.0f), 1.0f);
+
+	if (iSourceChannels == 1)
+	{
+		const float fAngle = (fPan + 1.0f) * 0.785398163f; // pi / 4
+
+		fOutLeftGain = fVolume * std::cos(fAngle);
+		fOutRightGain = fVolume * std::sin(fAngle);
+	}
+	else
+	{
+		fOutLeftGain = fVolume * std::min(1.0f, 1.0f - fPan);
+		fOutRightGain = fVolume * std::min(1.0f, 1.0f + fPan);
+	}
+}
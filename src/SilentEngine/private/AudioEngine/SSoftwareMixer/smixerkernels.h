@@ -0,0 +1,64 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <cstddef>
+#include <cstdint>
+
+
+//@@Class
+/*
+SIMD (SSE2) kernels of the software mixer, 4 frames are processed at a time.
+Mixer buffers are planar (separate left and right channels) 32 bit float.
+*/
+class SMixerKernels
+{
+public:
+
+	//@@Function
+	/*
+	* desc: converts 16 bit PCM source frames to float and resamples them (linear interpolation).
+	* param "pSource": interleaved source samples.
+	* param "iSourceFrameCount": number of frames in the source.
+	* param "iSourceChannels": 1 or 2.
+	* param "dPosition": position in the source (in frames), advanced by the function.
+	* param "dStep": source frames per output frame (source sample rate / mixer sample rate * pitch).
+	* param "bLoop": continue from the start of the source when the end is reached.
+	* param "pOutLeft": output of the left (or mono) channel.
+	* param "pOutRight": output of the right channel (only written for stereo sources).
+	* param "iFrameCount": number of frames to produce.
+	* return: number of produced frames, less than iFrameCount if the end of the (not looped) source was reached.
+	*/
+	static size_t resampleToFloat(const int16_t* pSource, size_t iSourceFrameCount, size_t iSourceChannels, double& dPosition, double dStep,
+		bool bLoop, float* pOutLeft, float* pOutRight, size_t iFrameCount);
+
+	//@@Function
+	/*
+	* desc: adds the source to the stereo output with the gain that linearly changes over the frames (to avoid clicks).
+	* param "pSourceLeft": left (or mono) source channel.
+	* param "pSourceRight": right source channel (pass pSourceLeft for mono).
+	* param "fLeftGainStart": gain of the left channel on the first frame.
+	* param "fLeftGainEnd": gain of the left channel after the last frame.
+	*/
+	static void   mixToStereo(const float* pSourceLeft, const float* pSourceRight, float fLeftGainStart, float fLeftGainEnd,
+		float fRightGainStart, float fRightGainEnd, float* pOutLeft, float* pOutRight, size_t iFrameCount);
+
+	//@@Function
+	/*
+	* desc: writes planar stereo to interleaved output with the gain, clamped to [-1, 1].
+	*/
+	static void   interleaveStereo(const float* pLeft, const float* pRight, float fGain, float* pOutput, size_t iFrameCount);
+
+	//@@Function
+	/*
+	* desc: returns left and right gains for the volume and the pan ([-1, 1], -1 is left).
+	* remarks: mono sources use constant power pan, stereo sources use balance (both channels are at full volume at the center).
+	*/
+	static void   getPanGains(float fVolume, float fPan, size_t iSourceChannels, float& fOutLeftGain, float& fOutRightGain);
+};
@@ -0,0 +1,707 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "ssoftwaremixer.h"
+
+// STL
+#include <chrono>
+#include <algorithm>
+
+// Engine
+#include "SilentEngine/Private/SError/serror.h"
+
+// Custom
+#include "smixerkernels.h"
+
+#if defined(_WIN32)
+#include <Windows.h>
+#endif
+
+
+SSoftwareMixer::SSoftwareMixer(unsigned long iSampleRate, size_t iFramesPerBlock, size_t iMaxVoiceCount, size_t iMaxBusCount)
+{
+	this->iSampleRate = iSampleRate;
+	this->iFramesPerBlock = iFramesPerBlock;
+	this->iMaxVoiceCount = iMaxVoiceCount;
+	this->iMaxBusCount = std::max<size_t>(iMaxBusCount, 1);
+
+	vVoiceDescs.resize(iMaxVoiceCount);
+	vFreeVoiceSlots.reserve(iMaxVoiceCount);
+
+	// Lower indices are used first.
+	for (size_t i = iMaxVoiceCount; i > 0; i--)
+	{
+		vFreeVoiceSlots.push_back(i - 1);
+	}
+
+	commandRing.init(std::max<size_t>(iMinCommandRingSize, iMaxVoiceCount * iCommandsPerVoice));
+	finishedVoiceRing.init(iMaxVoiceCount);
+
+	vVoices.resize(iMaxVoiceCount);
+	vActiveVoiceIndices.reserve(iMaxVoiceCount);
+
+	vBuses.resize(this->iMaxBusCount);
+	vBuses[iMasterBusIndex].bUsed = true;
+	vControlBuses = vBuses;
+	vBusBuffers.resize(this->iMaxBusCount * 2 * iFramesPerBlock);
+
+	vResampledLeft.resize(iFramesPerBlock);
+	vResampledRight.resize(iFramesPerBlock);
+	vOutputBlock.resize(iFramesPerBlock * 2);
+}
+
+SSoftwareMixer::~SSoftwareMixer()
+{
+	stop();
+}
+
+bool SSoftwareMixer::createBus(size_t& iOutBusIndex, size_t iParentBusIndex)
+{
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	if ((iParentBusIndex >= iMaxBusCount) || (vControlBuses[iParentBusIndex].bUsed == false))
+	{
+		SError::logError("the parent bus does not exist.");
+		return true;
+	}
+
+	// The parent has a lower index so buses are summed from the last one to the master bus.
+	size_t iBusIndex = iParentBusIndex + 1;
+	while ((iBusIndex < iMaxBusCount) && vControlBuses[iBusIndex].bUsed)
+	{
+		iBusIndex++;
+	}
+
+	if (iBusIndex == iMaxBusCount)
+	{
+		SError::logError("reached the maximum number of buses.");
+		return true;
+	}
+
+	SBus& bus = vControlBuses[iBusIndex];
+	bus.iParentBusIndex = iParentBusIndex;
+	bus.iGeneration++;
+	bus.fVolume = 1.0f;
+	bus.fAppliedVolume = 1.0f;
+	bus.bUsed = true;
+
+	if (bRunning)
+	{
+		SMixerCommand command;
+		command.type = SMixerCommandType::SMCT_CREATE_BUS;
+		command.iId = iBusIndex;
+		command.iIndex = iParentBusIndex;
+		command.iGeneration = bus.iGeneration;
+
+		// Waits for the running mixer if the ring is full.
+		pushCommand(command);
+	}
+
+	iOutBusIndex = iBusIndex;
+
+	return false;
+}
+
+bool SSoftwareMixer::releaseBus(size_t iBusIndex)
+{
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	if ((iBusIndex == iMasterBusIndex) || (iBusIndex >= iMaxBusCount) || (vControlBuses[iBusIndex].bUsed == false))
+	{
+		SError::logError("the bus does not exist.");
+		return true;
+	}
+
+	for (size_t i = iBusIndex + 1; i < iMaxBusCount; i++)
+	{
+		if (vControlBuses[i].bUsed && (vControlBuses[i].iParentBusIndex == iBusIndex))
+		{
+			SError::logError("the bus has child buses.");
+			return true;
+		}
+	}
+
+	vControlBuses[iBusIndex].bUsed = false;
+
+	if (bRunning)
+	{
+		SMixerCommand command;
+		command.type = SMixerCommandType::SMCT_RELEASE_BUS;
+		command.iId = iBusIndex;
+
+		pushCommand(command);
+	}
+
+	return false;
+}
+
+void SSoftwareMixer::setBusVolume(size_t iBusIndex, float fVolume)
+{
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	if ((iBusIndex >= iMaxBusCount) || (vControlBuses[iBusIndex].bUsed == false))
+	{
+		return;
+	}
+
+	vControlBuses[iBusIndex].fVolume = fVolume;
+
+	if (bRunning)
+	{
+		SMixerCommand command;
+		command.type = SMixerCommandType::SMCT_SET_BUS_VOLUME;
+		command.iId = iBusIndex;
+		command.fValue = fVolume;
+
+		pushCommand(command);
+	}
+}
+
+bool SSoftwareMixer::playVoice(const SMixerVoiceDesc& voiceDesc, size_t& iOutVoiceId)
+{
+	if (voiceDesc.pDecodedAudio == nullptr)
+	{
+		SError::logError("no audio data specified.");
+		return true;
+	}
+
+	const SDecodedAudioFormat& format = voiceDesc.pDecodedAudio->format;
+
+	if ((format.iFormatTag != 1 /* WAVE_FORMAT_PCM */) || (format.iBitsPerSample != 16)
+		|| (format.iChannels == 0) || (format.iChannels > 2) || (format.iSampleRate == 0))
+	{
+		SError::logError("only 16 bit PCM mono and stereo audio is supported.");
+		return true;
+	}
+
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	if ((voiceDesc.iBusIndex >= iMaxBusCount) || (vControlBuses[voiceDesc.iBusIndex].bUsed == false))
+	{
+		SError::logError("the bus does not exist.");
+		return true;
+	}
+
+	iOutVoiceId = iNextVoiceId++;
+
+	releaseFinishedVoicesLocked();
+
+	if (vFreeVoiceSlots.empty())
+	{
+		iDroppedVoiceCount++;
+		return false;
+	}
+
+	const size_t iVoiceSlot = vFreeVoiceSlots.back();
+	vFreeVoiceSlots.pop_back();
+
+	// The mixer reads the desc after it pops the command and does not touch it after it reports the voice as finished.
+	vVoiceDescs[iVoiceSlot] = voiceDesc;
+
+	SMixerCommand command;
+	command.type = SMixerCommandType::SMCT_PLAY_VOICE;
+	command.iId = iOutVoiceId;
+	command.iIndex = iVoiceSlot;
+
+	if (pushCommand(command))
+	{
+		vVoiceDescs[iVoiceSlot].pDecodedAudio = nullptr;
+		vFreeVoiceSlots.push_back(iVoiceSlot);
+
+		return true;
+	}
+
+	return false;
+}
+
+void SSoftwareMixer::releaseFinishedVoices()
+{
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	releaseFinishedVoicesLocked();
+}
+
+void SSoftwareMixer::stopVoice(size_t iVoiceId)
+{
+	SMixerCommand command;
+	command.type = SMixerCommandType::SMCT_STOP_VOICE;
+	command.iId = iVoiceId;
+
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	pushCommand(command);
+}
+
+void SSoftwareMixer::setVoiceVolume(size_t iVoiceId, float fVolume)
+{
+	SMixerCommand command;
+	command.type = SMixerCommandType::SMCT_SET_VOICE_VOLUME;
+	command.iId = iVoiceId;
+	command.fValue = fVolume;
+
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	pushCommand(command);
+}
+
+void SSoftwareMixer::setVoicePan(size_t iVoiceId, float fPan)
+{
+	SMixerCommand command;
+	command.type = SMixerCommandType::SMCT_SET_VOICE_PAN;
+	command.iId = iVoiceId;
+	command.fValue = fPan;
+
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	pushCommand(command);
+}
+
+void SSoftwareMixer::setVoicePitch(size_t iVoiceId, float fPitch)
+{
+	SMixerCommand command;
+	command.type = SMixerCommandType::SMCT_SET_VOICE_PITCH;
+	command.iId = iVoiceId;
+	command.fValue = fPitch;
+
+	std::lock_guard<std::mutex> guard(mtxControl);
+
+	pushCommand(command);
+}
+
+void SSoftwareMixer::mix(float* pInterleavedOutput, size_t iFrameCount)
+{
+	{
+		// Bus commands are not pushed while the mixer thread is stopped.
+		std::lock_guard<std::mutex> guard(mtxControl);
+
+		applyControlBuses();
+	}
+
+	mixBlocks(pInterleavedOutput, iFrameCount);
+}
+
+void SSoftwareMixer::mixBlocks(float* pInterleavedOutput, size_t iFrameCount)
+{
+	executeCommands();
+
+	for (size_t iOffset = 0; iOffset < iFrameCount; iOffset += iFramesPerBlock)
+	{
+		mixBlock(pInterleavedOutput + iOffset * 2, std::min(iFramesPerBlock, iFrameCount - iOffset));
+	}
+}
+
+bool SSoftwareMixer::start(SAudioOutputSink* pOutputSink)
+{
+	if (bRunning)
+	{
+		SError::showErrorMessageBoxAndLog("the mixer is already started.");
+		return true;
+	}
+
+	if (mixerThreadHandle.joinable())
+	{
+		// Stopped because of an output error.
+		stop();
+	}
+
+	if (pOutputSink->open(iSampleRate, 2, iFramesPerBlock))
+	{
+		return true;
+	}
+
+	this->pOutputSink = pOutputSink;
+
+	{
+		std::lock_guard<std::mutex> guard(mtxControl);
+
+		// Bus changes made while the mixer was stopped, the next ones are pushed as commands.
+		applyControlBuses();
+
+		bRunning = true;
+	}
+
+	mixerThreadHandle = std::thread(&SSoftwareMixer::mixerThread, this);
+
+	return false;
+}
+
+void SSoftwareMixer::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(mtxControl);
+
+		bRunning = false;
+	}
+
+	if (mixerThreadHandle.joinable())
+	{
+		mixerThreadHandle.join();
+
+		// Commands that the mixer thread did not take, so that old bus commands are not applied over the state taken in start().
+		executeCommands();
+	}
+
+	if (pOutputSink)
+	{
+		pOutputSink->close();
+		pOutputSink = nullptr;
+	}
+
+	releaseFinishedVoices();
+}
+
+bool SSoftwareMixer::isStarted() const
+{
+	return bRunning;
+}
+
+SSoftwareMixerStats SSoftwareMixer::getStats() const
+{
+	SSoftwareMixerStats stats;
+	stats.iMixedBlockCount = iMixedBlockCount;
+	stats.iMixedVoiceCount = iMixedVoiceCount;
+	stats.iDroppedVoiceCount = iDroppedVoiceCount;
+	stats.iActiveVoiceCount = iActiveVoiceCount;
+	stats.dLastBlockMixTimeInMs = iLastBlockMixTimeInNs / 1000000.0;
+	stats.dTotalMixTimeInMs = iTotalMixTimeInNs / 1000000.0;
+
+	return stats;
+}
+
+unsigned long SSoftwareMixer::getSampleRate() const
+{
+	return iSampleRate;
+}
+
+size_t SSoftwareMixer::getFramesPerBlock() const
+{
+	return iFramesPerBlock;
+}
+
+bool SSoftwareMixer::pushCommand(const SMixerCommand& command)
+{
+	while (commandRing.push(command))
+	{
+		if (bRunning == false)
+		{
+			// Nobody will empty the ring (mix() is not called).
+			SError::logError("the command ring is full.");
+			return true;
+		}
+
+		// The mixer thread will take the commands before the next block.
+		std::this_thread::yield();
+	}
+
+	return false;
+}
+
+void SSoftwareMixer::releaseFinishedVoicesLocked()
+{
+	size_t iVoiceSlot = 0;
+
+	while (finishedVoiceRing.pop(iVoiceSlot) == false)
+	{
+		vVoiceDescs[iVoiceSlot].pDecodedAudio = nullptr;
+		vFreeVoiceSlots.push_back(iVoiceSlot);
+	}
+}
+
+void SSoftwareMixer::applyControlBuses()
+{
+	for (size_t i = 0; i < iMaxBusCount; i++)
+	{
+		const SBus& controlBus = vControlBuses[i];
+		SBus& bus = vBuses[i];
+
+		if (bus.bUsed && ((controlBus.bUsed == false) || (controlBus.iGeneration != bus.iGeneration)))
+		{
+			releaseMixerBus(i);
+		}
+
+		if (controlBus.bUsed == false)
+		{
+			continue;
+		}
+
+		if (bus.bUsed == false)
+		{
+			// Created at the full volume like with SMCT_CREATE_BUS, then ramped to the current volume.
+			bus = controlBus;
+			bus.fAppliedVolume = 1.0f;
+
+			iMixerBusCount = std::max(iMixerBusCount, i + 1);
+		}
+		else
+		{
+			// Ramped over the next block.
+			bus.fVolume = controlBus.fVolume;
+		}
+	}
+}
+
+void SSoftwareMixer::executeCommands()
+{
+	SMixerCommand command;
+
+	while (commandRing.pop(command) == false)
+	{
+		switch (command.type)
+		{
+		case (SMixerCommandType::SMCT_CREATE_BUS):
+		{
+			vBuses[command.iId].iParentBusIndex = command.iIndex;
+			vBuses[command.iId].iGeneration = command.iGeneration;
+			vBuses[command.iId].fVolume = 1.0f;
+			vBuses[command.iId].fAppliedVolume = 1.0f;
+			vBuses[command.iId].bUsed = true;
+
+			iMixerBusCount = std::max(iMixerBusCount, command.iId + 1);
+
+			break;
+		}
+		case (SMixerCommandType::SMCT_SET_BUS_VOLUME):
+		{
+			vBuses[command.iId].fVolume = command.fValue;
+
+			break;
+		}
+		case (SMixerCommandType::SMCT_RELEASE_BUS):
+		{
+			releaseMixerBus(command.iId);
+
+			break;
+		}
+		case (SMixerCommandType::SMCT_PLAY_VOICE):
+		{
+			playVoiceInSlot(command.iIndex, command.iId);
+
+			break;
+		}
+		default:
+		{
+			SVoice* pVoice = findVoice(command.iId);
+			if (pVoice == nullptr)
+			{
+				// Finished or dropped.
+				break;
+			}
+
+			if (command.type == SMixerCommandType::SMCT_STOP_VOICE)
+			{
+				// Removed after the next block (fades out).
+				pVoice->bStopping = true;
+			}
+			else if (command.type == SMixerCommandType::SMCT_SET_VOICE_VOLUME)
+			{
+				pVoice->fVolume = command.fValue;
+			}
+			else if (command.type == SMixerCommandType::SMCT_SET_VOICE_PAN)
+			{
+				pVoice->fPan = command.fValue;
+			}
+			else if (command.type == SMixerCommandType::SMCT_SET_VOICE_PITCH)
+			{
+				pVoice->fPitch = command.fValue;
+			}
+
+			break;
+		}
+		}
+	}
+}
+
+void SSoftwareMixer::playVoiceInSlot(size_t iVoiceSlot, size_t iVoiceId)
+{
+	const SMixerVoiceDesc& voiceDesc = vVoiceDescs[iVoiceSlot];
+
+	if (vBuses[voiceDesc.iBusIndex].bUsed == false)
+	{
+		// The bus was released after the voice was pushed.
+		finishedVoiceRing.push(iVoiceSlot);
+		return;
+	}
+	const SDecodedAudioFormat& format = voiceDesc.pDecodedAudio->format;
+
+	SVoice& voice = vVoices[iVoiceSlot];
+	voice.pSamples = reinterpret_cast<const int16_t*>(voiceDesc.pDecodedAudio->vPCMData.data());
+	voice.iSourceChannels = format.iChannels;
+	voice.iSourceFrameCount = voiceDesc.pDecodedAudio->vPCMData.size() / (sizeof(int16_t) * format.iChannels);
+	voice.iVoiceId = iVoiceId;
+	voice.iBusIndex = voiceDesc.iBusIndex;
+	voice.dPosition = 0.0;
+	voice.dRateRatio = static_cast<double>(format.iSampleRate) / iSampleRate;
+	voice.fVolume = voiceDesc.fVolume;
+	voice.fPan = voiceDesc.fPan;
+	voice.fPitch = voiceDesc.fPitch;
+	voice.bLoop = voiceDesc.bLoop;
+	voice.bStopping = false;
+
+	// Start at the target gains.
+	SMixerKernels::getPanGains(voice.fVolume, voice.fPan, voice.iSourceChannels, voice.fLeftGain, voice.fRightGain);
+
+	vActiveVoiceIndices.push_back(iVoiceSlot);
+}
+
+void SSoftwareMixer::releaseMixerBus(size_t iBusIndex)
+{
+	vBuses[iBusIndex].bUsed = false;
+
+	for (size_t i = 0; i < vActiveVoiceIndices.size(); i++)
+	{
+		SVoice& voice = vVoices[vActiveVoiceIndices[i]];
+
+		if (voice.iBusIndex == iBusIndex)
+		{
+			// Removed after the next block (the bus is not mixed anymore so it's silent).
+			voice.bStopping = true;
+		}
+	}
+}
+
+void SSoftwareMixer::mixBlock(float* pInterleavedOutput, size_t iFrameCount)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::fill(vBusBuffers.begin(), vBusBuffers.begin() + iMixerBusCount * 2 * iFramesPerBlock, 0.0f);
+
+
+	// Voices.
+
+	const size_t iVoicesToMix = vActiveVoiceIndices.size();
+
+	for (size_t i = 0; i < vActiveVoiceIndices.size(); )
+	{
+		const size_t iVoiceIndex = vActiveVoiceIndices[i];
+		SVoice& voice = vVoices[iVoiceIndex];
+
+		const size_t iProducedFrameCount = SMixerKernels::resampleToFloat(voice.pSamples, voice.iSourceFrameCount, voice.iSourceChannels,
+			voice.dPosition, voice.dRateRatio * voice.fPitch, voice.bLoop, vResampledLeft.data(), vResampledRight.data(), iFrameCount);
+
+		float fLeftGain = 0.0f;
+		float fRightGain = 0.0f;
+
+		if (voice.bStopping == false)
+		{
+			SMixerKernels::getPanGains(voice.fVolume, voice.fPan, voice.iSourceChannels, fLeftGain, fRightGain);
+		}
+
+		SMixerKernels::mixToStereo(vResampledLeft.data(), (voice.iSourceChannels == 2) ? vResampledRight.data() : vResampledLeft.data(),
+			voice.fLeftGain, fLeftGain, voice.fRightGain, fRightGain, getBusLeft(voice.iBusIndex), getBusRight(voice.iBusIndex), iProducedFrameCount);
+
+		voice.fLeftGain = fLeftGain;
+		voice.fRightGain = fRightGain;
+
+		if (voice.bStopping || (iProducedFrameCount < iFrameCount))
+		{
+			// Finished, the decoded audio is released on the control side.
+			voice.pSamples = nullptr;
+
+			// Can't be full, it has a place for every voice.
+			finishedVoiceRing.push(iVoiceIndex);
+
+			vActiveVoiceIndices[i] = vActiveVoiceIndices.back();
+			vActiveVoiceIndices.pop_back();
+
+			continue;
+		}
+
+		i++;
+	}
+
+
+	// Buses (children have higher indices than their parents).
+
+	for (size_t iBusIndex = iMixerBusCount - 1; iBusIndex > iMasterBusIndex; iBusIndex--)
+	{
+		SBus& bus = vBuses[iBusIndex];
+
+		if (bus.bUsed == false)
+		{
+			continue;
+		}
+
+		SMixerKernels::mixToStereo(getBusLeft(iBusIndex), getBusRight(iBusIndex), bus.fAppliedVolume, bus.fVolume, bus.fAppliedVolume, bus.fVolume,
+			getBusLeft(bus.iParentBusIndex), getBusRight(bus.iParentBusIndex), iFrameCount);
+
+		bus.fAppliedVolume = bus.fVolume;
+	}
+
+
+	// Output.
+
+	SBus& masterBus = vBuses[iMasterBusIndex];
+
+	if (masterBus.fAppliedVolume != masterBus.fVolume)
+	{
+		std::fill(vResampledLeft.begin(), vResampledLeft.end(), 0.0f);
+		std::fill(vResampledRight.begin(), vResampledRight.end(), 0.0f);
+
+		SMixerKernels::mixToStereo(getBusLeft(iMasterBusIndex), getBusRight(iMasterBusIndex), masterBus.fAppliedVolume, masterBus.fVolume,
+			masterBus.fAppliedVolume, masterBus.fVolume, vResampledLeft.data(), vResampledRight.data(), iFrameCount);
+
+		SMixerKernels::interleaveStereo(vResampledLeft.data(), vResampledRight.data(), 1.0f, pInterleavedOutput, iFrameCount);
+
+		masterBus.fAppliedVolume = masterBus.fVolume;
+	}
+	else
+	{
+		SMixerKernels::interleaveStereo(getBusLeft(iMasterBusIndex), getBusRight(iMasterBusIndex), masterBus.fVolume, pInterleavedOutput, iFrameCount);
+	}
+
+
+	// Stats.
+
+	const long long iMixTimeInNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+	iMixedBlockCount++;
+	iMixedVoiceCount += iVoicesToMix;
+	iActiveVoiceCount = vActiveVoiceIndices.size();
+	iLastBlockMixTimeInNs = iMixTimeInNs;
+	iTotalMixTimeInNs += iMixTimeInNs;
+}
+
+SSoftwareMixer::SVoice* SSoftwareMixer::findVoice(size_t iVoiceId)
+{
+	for (size_t i = 0; i < vActiveVoiceIndices.size(); i++)
+	{
+		if (vVoices[vActiveVoiceIndices[i]].iVoiceId == iVoiceId)
+		{
+			return &vVoices[vActiveVoiceIndices[i]];
+		}
+	}
+
+	return nullptr;
+}
+
+void SSoftwareMixer::mixerThread()
+{
+#if defined(_WIN32)
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#endif
+
+	while (bRunning)
+	{
+		mixBlocks(vOutputBlock.data(), iFramesPerBlock);
+
+		// Waits until the device takes the block.
+		if (pOutputSink->write(vOutputBlock.data(), iFramesPerBlock))
+		{
+			bRunning = false;
+		}
+	}
+}
+
+float* SSoftwareMixer::getBusLeft(size_t iBusIndex)
+{
+	return vBusBuffers.data() + iBusIndex * 2 * iFramesPerBlock;
+}
+
+float* SSoftwareMixer::getBusRight(size_t iBusIndex)
+{
+	return vBusBuffers.data() + iBusIndex * 2 * iFramesPerBlock + iFramesPerBlock;
+}
@@ -0,0 +1,370 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <cstddef>
+
+// Custom
+#include "../SDecodedAudioCache/sdecodedaudiocache.h"
+#include "../SAudioOutputSink/saudiooutputsink.h"
+
+
+// Description of a voice for SSoftwareMixer::playVoice().
+struct SMixerVoiceDesc
+{
+	// 16 bit PCM, mono or stereo, any sample rate.
+	std::shared_ptr<const SDecodedAudio> pDecodedAudio;
+
+	float  fVolume = 1.0f;
+	// [-1, 1], -1 is left.
+	float  fPan = 0.0f;
+	// Frequency ratio (2.0 is one octave up).
+	float  fPitch = 1.0f;
+
+	bool   bLoop = false;
+
+	size_t iBusIndex = 0;
+};
+
+struct SSoftwareMixerStats
+{
+	unsigned long long iMixedBlockCount = 0;
+	// Sum of the voices mixed in every block.
+	unsigned long long iMixedVoiceCount = 0;
+	// Voices that were not played because all voices were used.
+	unsigned long long iDroppedVoiceCount = 0;
+
+	size_t iActiveVoiceCount = 0;
+
+	double dLastBlockMixTimeInMs = 0.0;
+	double dTotalMixTimeInMs = 0.0;
+};
+
+
+//@@Class
+/*
+The class mixes source voices into buses (a bus per SSoundMix, bus 0 is the master bus) on the CPU using SIMD kernels
+(see SMixerKernels) and outputs the mixed stereo to an output sink from a dedicated real-time thread.
+Control functions (play, stop, volume, etc.) can be called from any thread, they push commands to a preallocated ring
+that the mixer executes before mixing the next block, so the mixer never waits for other threads and never allocates memory.
+The decoded audio of the finished voices is released on the control threads (see releaseFinishedVoices()).
+The state of the buses is kept on the control side and bus commands are only pushed while the mixer thread is running,
+the mixer takes the whole state in start() and mix(), so a mixer that is never started does not accumulate bus commands.
+All buffers are allocated in the constructor.
+*/
+class SSoftwareMixer
+{
+public:
+	//@@Function
+	/*
+	* desc: creates the mixer and the master bus.
+	* param "iSampleRate": output sample rate, sources of other sample rates are resampled.
+	* param "iFramesPerBlock": number of frames mixed at once (latency of the output and of the commands).
+	* param "iMaxVoiceCount": number of voices that can play at the same time.
+	* param "iMaxBusCount": number of buses (including the master bus).
+	*/
+	SSoftwareMixer(unsigned long iSampleRate = 48000, size_t iFramesPerBlock = 480, size_t iMaxVoiceCount = 256, size_t iMaxBusCount = 64);
+	SSoftwareMixer(const SSoftwareMixer&) = delete;
+	SSoftwareMixer& operator= (const SSoftwareMixer&) = delete;
+	~SSoftwareMixer();
+
+	//@@Function
+	/*
+	* desc: creates a bus that is mixed into the parent bus.
+	* param "iOutBusIndex": index of the new bus.
+	* param "iParentBusIndex": index of an existing bus.
+	* return: true if an error occurred (no free buses, the error is written to the log), false otherwise.
+	* remarks: thread-safe. Indices of the released buses are reused.
+	*/
+	bool createBus     (size_t& iOutBusIndex, size_t iParentBusIndex = iMasterBusIndex);
+	//@@Function
+	/*
+	* desc: releases the bus created by createBus(), voices that play on this bus are faded out.
+	* return: true if an error occurred (the bus does not exist or has child buses, the error is written to the log), false otherwise.
+	* remarks: thread-safe. The master bus can't be released.
+	*/
+	bool releaseBus    (size_t iBusIndex);
+	//@@Function
+	/*
+	* desc: sets the volume of the bus (ramped over the next block to avoid clicks).
+	* remarks: thread-safe.
+	*/
+	void setBusVolume  (size_t iBusIndex, float fVolume);
+
+	//@@Function
+	/*
+	* desc: starts playing a voice.
+	* param "iOutVoiceId": id that is used to control the voice.
+	* return: true if an error occurred (unsupported format or bus, the error is written to the log), false otherwise.
+	* remarks: thread-safe. If all voices are used the voice is dropped (see SSoftwareMixerStats::iDroppedVoiceCount).
+	*/
+	bool playVoice     (const SMixerVoiceDesc& voiceDesc, size_t& iOutVoiceId);
+	//@@Function
+	/*
+	* desc: releases the decoded audio of the voices that finished playing so that their voices can be reused.
+	* remarks: thread-safe. Also called in playVoice() and stop().
+	*/
+	void releaseFinishedVoices();
+	//@@Function
+	/*
+	* desc: fades out and stops the voice (does nothing if the voice already stopped).
+	* remarks: thread-safe.
+	*/
+	void stopVoice     (size_t iVoiceId);
+	//@@Function
+	/*
+	* remarks: thread-safe.
+	*/
+	void setVoiceVolume(size_t iVoiceId, float fVolume);
+	//@@Function
+	/*
+	* remarks: thread-safe.
+	*/
+	void setVoicePan   (size_t iVoiceId, float fPan);
+	//@@Function
+	/*
+	* remarks: thread-safe.
+	*/
+	void setVoicePitch (size_t iVoiceId, float fPitch);
+
+	//@@Function
+	/*
+	* desc: mixes the next frames (executes the pushed commands first).
+	* param "pInterleavedOutput": iFrameCount * 2 samples (stereo).
+	* remarks: used by the mixer thread, can be used directly (offline rendering, tests) if the mixer is not started.
+	*/
+	void mix           (float* pInterleavedOutput, size_t iFrameCount);
+
+	//@@Function
+	/*
+	* desc: opens the sink and starts the mixer thread that mixes blocks and writes them to the sink.
+	* return: true if an error occurred, false otherwise.
+	* remarks: the sink should exist until stop() is called.
+	*/
+	bool start         (SAudioOutputSink* pOutputSink);
+	//@@Function
+	/*
+	* desc: stops the mixer thread and closes the sink.
+	*/
+	void stop          ();
+	//@@Function
+	/*
+	* desc: returns true if the mixer thread is running.
+	*/
+	bool isStarted     () const;
+
+	//@@Function
+	/*
+	* desc: returns the counters of the mixer.
+	* remarks: thread-safe.
+	*/
+	SSoftwareMixerStats getStats() const;
+
+	unsigned long getSampleRate    () const;
+	size_t        getFramesPerBlock() const;
+
+
+	static constexpr size_t iMasterBusIndex = 0;
+
+private:
+
+	enum class SMixerCommandType
+	{
+		SMCT_CREATE_BUS,
+		SMCT_SET_BUS_VOLUME,
+		SMCT_RELEASE_BUS,
+		SMCT_PLAY_VOICE,
+		SMCT_STOP_VOICE,
+		SMCT_SET_VOICE_VOLUME,
+		SMCT_SET_VOICE_PAN,
+		SMCT_SET_VOICE_PITCH
+	};
+
+	struct SMixerCommand
+	{
+		SMixerCommandType type = SMixerCommandType::SMCT_STOP_VOICE;
+
+		// Voice ID or bus index.
+		size_t iId = 0;
+		// Voice slot (play) or parent bus index (create bus).
+		size_t iIndex = 0;
+		// Generation of the created bus.
+		size_t iGeneration = 0;
+		// Volume, pan or pitch.
+		float  fValue = 0.0f;
+	};
+
+	// Preallocated ring of trivially copyable items for one producer and one consumer.
+	template<typename T>
+	class SRing
+	{
+	public:
+		void init(size_t iCapacity)
+		{
+			vItems.resize(iCapacity + 1);
+		}
+
+		// Returns true if the ring is full.
+		bool push(const T& item)
+		{
+			const size_t iWrite = iWriteIndex.load(std::memory_order_relaxed);
+			const size_t iNextWrite = (iWrite + 1) % vItems.size();
+
+			if (iNextWrite == iReadIndex.load(std::memory_order_acquire))
+			{
+				return true;
+			}
+
+			vItems[iWrite] = item;
+			iWriteIndex.store(iNextWrite, std::memory_order_release);
+
+			return false;
+		}
+
+		// Returns true if the ring is empty.
+		bool pop(T& outItem)
+		{
+			const size_t iRead = iReadIndex.load(std::memory_order_relaxed);
+
+			if (iRead == iWriteIndex.load(std::memory_order_acquire))
+			{
+				return true;
+			}
+
+			outItem = vItems[iRead];
+			iReadIndex.store((iRead + 1) % vItems.size(), std::memory_order_release);
+
+			return false;
+		}
+
+	private:
+		std::vector<T>      vItems;
+		std::atomic<size_t> iWriteIndex{ 0 };
+		std::atomic<size_t> iReadIndex{ 0 };
+	};
+
+	struct SVoice
+	{
+		const int16_t* pSamples = nullptr;
+		size_t iSourceFrameCount = 0;
+		size_t iSourceChannels = 0;
+
+		size_t iVoiceId = 0;
+		size_t iBusIndex = 0;
+
+		double dPosition = 0.0;
+		// Source sample rate / mixer sample rate.
+		double dRateRatio = 1.0;
+
+		float  fVolume = 1.0f;
+		float  fPan = 0.0f;
+		float  fPitch = 1.0f;
+
+		// Gains at the end of the last mixed block.
+		float  fLeftGain = 0.0f;
+		float  fRightGain = 0.0f;
+
+		bool   bLoop = false;
+		bool   bStopping = false;
+	};
+
+	struct SBus
+	{
+		size_t iParentBusIndex = 0;
+		// Incremented every time the index is reused.
+		size_t iGeneration = 0;
+
+		float  fVolume = 1.0f;
+		// Volume at the end of the last mixed block.
+		float  fAppliedVolume = 1.0f;
+
+		bool   bUsed = false;
+	};
+
+	// expects mtxControl to be locked
+	bool    pushCommand                  (const SMixerCommand& command);
+	void    releaseFinishedVoicesLocked  ();
+	// expects mtxControl to be locked and the mixer thread to be stopped
+	void    applyControlBuses            ();
+
+	// called on the mixer thread
+	void    executeCommands();
+	void    playVoiceInSlot(size_t iVoiceSlot, size_t iVoiceId);
+	void    releaseMixerBus(size_t iBusIndex);
+	void    mixBlocks(float* pInterleavedOutput, size_t iFrameCount);
+	void    mixBlock (float* pInterleavedOutput, size_t iFrameCount);
+	SVoice* findVoice(size_t iVoiceId);
+	void    mixerThread();
+
+	float*  getBusLeft (size_t iBusIndex);
+	float*  getBusRight(size_t iBusIndex);
+
+
+	// Control threads data (guarded by mtxControl).
+
+	std::mutex                   mtxControl;
+	// Voices by slot (the same index as in vVoices), hold the decoded audio until the mixer finishes the voice.
+	std::vector<SMixerVoiceDesc> vVoiceDescs;
+	std::vector<size_t>          vFreeVoiceSlots;
+	// Buses as the control threads see them, sent to the mixer while it's running (see applyControlBuses()).
+	std::vector<SBus>            vControlBuses;
+
+
+	static constexpr size_t iMinCommandRingSize = 4096;
+	static constexpr size_t iCommandsPerVoice = 16;
+
+	// Control threads -> mixer thread (control threads push under mtxControl).
+	SRing<SMixerCommand> commandRing;
+	// Mixer thread -> control threads (slots of the finished voices, popped under mtxControl).
+	SRing<size_t>        finishedVoiceRing;
+
+
+	// Mixer thread data.
+
+	std::vector<SVoice> vVoices;
+	std::vector<size_t> vActiveVoiceIndices;
+
+	std::vector<SBus>   vBuses;
+	// Planar: left then right of each bus, iFramesPerBlock each.
+	std::vector<float>  vBusBuffers;
+	std::vector<float>  vResampledLeft;
+	std::vector<float>  vResampledRight;
+	std::vector<float>  vOutputBlock;
+
+	size_t iMixerBusCount = 1;
+
+
+	std::atomic<size_t> iNextVoiceId{ 1 };
+
+
+	// Stats.
+
+	std::atomic<unsigned long long> iMixedBlockCount{ 0 };
+	std::atomic<unsigned long long> iMixedVoiceCount{ 0 };
+	std::atomic<unsigned long long> iDroppedVoiceCount{ 0 };
+	std::atomic<size_t>             iActiveVoiceCount{ 0 };
+	std::atomic<long long>          iLastBlockMixTimeInNs{ 0 };
+	std::atomic<long long>          iTotalMixTimeInNs{ 0 };
+
+
+	std::thread         mixerThreadHandle;
+	std::atomic<bool>   bRunning{ false };
+	SAudioOutputSink*   pOutputSink = nullptr;
+
+
+	unsigned long iSampleRate;
+	size_t        iFramesPerBlock;
+	size_t        iMaxVoiceCount;
+	size_t        iMaxBusCount;
+};
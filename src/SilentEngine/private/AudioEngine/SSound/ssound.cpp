@@ -29,6 +29,11 @@ SSound::SSound(SAudioEngine* pAudioEngine, bool bIs3DSound, SAudioComponent* pOw
 
     pSourceVoice = nullptr;
 
+    pStreamingSampleData = nullptr;
+    iStreamingSampleSizeInBytes = 0;
+    iStreamingSampleReadOffset = 0;
+    bStreamingVoiceFed = false;
+
     bSoundLoaded = false;
     bUseStreaming = false;
     bSoundStoppedManually = false;
@@ -85,7 +90,7 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
 
     if (bStreamAudio == false)
     {
-        if (loadFileIntoMemory(sAudioFilePath, vAudioData, &waveFormatEx, iWaveFormatSize))
+        if (loadFileIntoMemory(sAudioFilePath, pDecodedAudio, &waveFormatEx, iWaveFormatSize))
         {
             return true;
         }
@@ -131,9 +136,11 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
         }
 
         ZeroMemory(&audioBuffer, sizeof(XAUDIO2_BUFFER));
-        audioBuffer.AudioBytes = static_cast<UINT32>(vAudioData.size());
-        audioBuffer.pAudioData = &vAudioData[0];
+        audioBuffer.AudioBytes = static_cast<UINT32>(pDecodedAudio->vPCMData.size());
+        audioBuffer.pAudioData = pDecodedAudio->vPCMData.data();
         audioBuffer.pContext = nullptr;
+
+        pStreamRing = nullptr;
     }
     else
     {
@@ -149,6 +156,20 @@ bool SSound::loadAudioFile(const std::wstring &sAudioFilePath, bool bStreamAudio
         readSoundInfo(pAsyncSourceReader, &soundFormat);
 
 
+        // Slots for the decoded data are allocated once (each slot holds about iStreamingSlotDurationInMs of sound).
+
+        size_t iBlockAlign = (soundFormat.nBlockAlign > 0) ? soundFormat.nBlockAlign : 1;
+
+        size_t iSlotSizeInBytes = static_cast<size_t>(soundFormat.nAvgBytesPerSec) * iStreamingSlotDurationInMs / 1000;
+        iSlotSizeInBytes -= iSlotSizeInBytes % iBlockAlign;
+        if (iSlotSizeInBytes == 0)
+        {
+            iSlotSizeInBytes = iBlockAlign;
+        }
+
+        pStreamRing = std::make_unique<SAudioStreamRing>(iStreamingSlotCount, iSlotSizeInBytes);
+
+
 
 		HRESULT hr = S_OK;
 
@@ -248,6 +269,10 @@ bool SSound::playSound()
     dCurrentStreamingPosInSec = 0.0;
     iSamplesPlayedOnLastSetPos = 0;
 
+    // Starts real, SAudioEngine::update3DSound() decides if it should be virtual.
+    bVirtual = false;
+    bVirtualPlayEnded = false;
+
 
     if (onPlayEndCallback)
     {
@@ -344,18 +369,21 @@ bool SSound::unpauseSound()
         return false;
     }
 
-    HRESULT hr = pSourceVoice->Start();
-    if (FAILED(hr))
+    if (bVirtual == false)
     {
-		SError::showErrorMessageBoxAndLog(hr);
-        return true;
-    }
+        HRESULT hr = pSourceVoice->Start();
+        if (FAILED(hr))
+        {
+            SError::showErrorMessageBoxAndLog(hr);
+            return true;
+        }
 
 
-	if (bIs3DSound)
-	{
-		pAudioEngine->apply3DPropsForComponent(pOwnerComponent);
-	}
+        if (bIs3DSound)
+        {
+            pAudioEngine->apply3DPropsForComponent(pOwnerComponent);
+        }
+    }
 
 
     mtxSoundState.lock();
@@ -441,6 +469,9 @@ bool SSound::stopSound()
 
     dCurrentStreamingPosInSec = 0.0;
 
+    bVirtual = false;
+    bVirtualPlayEnded = false;
+
 
     pSourceVoice->FlushSourceBuffers();
 
@@ -469,6 +500,18 @@ bool SSound::setPositionInSec(double dPositionInSec)
     }
 
 
+    if (bVirtual)
+    {
+        // Will continue from this position when the voice becomes real.
+        std::lock_guard<std::mutex> lock(mtxSoundState);
+
+        dVirtualPositionInSec = dPositionInSec;
+        bVirtualPlayEnded = false;
+
+        return false;
+    }
+
+
 
     if (bUseStreaming)
     {
@@ -484,6 +527,12 @@ bool SSound::setPositionInSec(double dPositionInSec)
 
             std::lock_guard<std::mutex> lock(mtxStreamingReadSampleSubmit);
 
+            // Drop the rest of the sample from the old position.
+            releaseStreamingSample();
+
+            // The voice is flushed below, this is not an underrun.
+            bStreamingVoiceFed = false;
+
             hr = pAsyncSourceReader->Flush((DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM);
             if (FAILED(hr))
             {
@@ -596,6 +645,8 @@ bool SSound::setVolume(float fVolume)
         return true;
     }
 
+    this->fVolume = fVolume;
+
 
     return false;
 }
@@ -624,6 +675,8 @@ bool SSound::setPitchInFreqRatio(float fRatio)
         return true;
     }
 
+    fPitch = fRatio;
+
     return false;
 }
 
@@ -651,6 +704,8 @@ bool SSound::setPitchInSemitones(float fSemitones)
         return true;
     }
 
+    fPitch = powf(2.0f, fSemitones / 12.0f);
+
     return false;
 }
 
@@ -787,6 +842,48 @@ bool SSound::applyNew3DSoundProps(SEmitterProps &emitterProps)
     }
 }
 
+bool SSound::applySpatialization(float fLeftGain, float fRightGain, float fDopplerFactor)
+{
+    std::lock_guard<std::mutex> lock(mtxUpdate3DSound);
+
+    // Mono source, stereo output.
+    float matrix[2] = { fLeftGain, fRightGain };
+
+    HRESULT hr = S_OK;
+
+    if (pSoundMix)
+    {
+        hr = pSourceVoice->SetOutputMatrix(pSoundMix->pSubmixVoice, 1, 2, matrix);
+        hr = pSourceVoice->SetOutputMatrix(pSoundMix->pSubmixVoiceFX, 1, 2, matrix);
+    }
+    else
+    {
+        hr = pSourceVoice->SetOutputMatrix(pAudioEngine->pMasteringVoice, 1, 2, matrix);
+    }
+
+    if (FAILED(hr))
+    {
+        SError::showErrorMessageBoxAndLog(hr);
+        return true;
+    }
+
+
+    if (sound3DProps.fDopplerScaler > 0.0f)
+    {
+        const float fRatio = std::min<float>(std::max<float>(fPitch * fDopplerFactor, 0.03125f), 32.0f);
+
+        hr = pSourceVoice->SetFrequencyRatio(fRatio);
+        if (FAILED(hr))
+        {
+            SError::showErrorMessageBoxAndLog(hr);
+            return true;
+        }
+    }
+
+
+    return false;
+}
+
 bool SSound::getVolume(float &fVolume)
 {
     if (bSoundLoaded == false)
@@ -841,6 +938,10 @@ bool SSound::getPositionInSec(double &dPositionInSec)
     {
         dPositionInSec = dCurrentStreamingPosInSec;
     }
+    else if (bVirtual)
+    {
+        dPositionInSec = dVirtualPositionInSec;
+    }
     else
     {
         XAUDIO2_VOICE_STATE state;
@@ -881,9 +982,28 @@ bool SSound::getLoadedAudioDataSizeInBytes(size_t& iSizeInBytes)
     }
     else
     {
-        iSizeInBytes = vAudioData.size();
+        iSizeInBytes = pDecodedAudio->vPCMData.size();
+    }
+
+
+    return false;
+}
+
+bool SSound::getStreamingStats(SAudioStreamStats& stats)
+{
+    if (bSoundLoaded == false)
+    {
+        SError::showErrorMessageBoxAndLog("no sound is loaded.");
+        return true;
+    }
+
+    if (bUseStreaming == false || pStreamRing == nullptr)
+    {
+        SError::showErrorMessageBoxAndLog("the sound is not streamed.");
+        return true;
     }
 
+    stats = pStreamRing->getStats();
 
     return false;
 }
@@ -893,6 +1013,68 @@ bool SSound::isSoundStoppedManually() const
     return bSoundStoppedManually;
 }
 
+void SSound::virtualizeVoice()
+{
+    std::lock_guard<std::mutex> lock(mtxSoundState);
+
+    getPositionInSec(dVirtualPositionInSec);
+
+    // The buffer stays submitted (flushing it would signal the end of the sound), stopped voices are not processed.
+    pSourceVoice->Stop();
+
+    bVirtualPlayEnded = false;
+    bVirtual = true;
+}
+
+bool SSound::devirtualizeVoice(double dPositionInSec)
+{
+    mtxSoundState.lock();
+
+    bVirtual = false;
+
+    mtxSoundState.unlock();
+
+
+    if (dPositionInSec > soundInfo.dSoundLengthInSec)
+    {
+        dPositionInSec = soundInfo.dSoundLengthInSec;
+    }
+
+    // Resubmits the buffer from the position, starts the voice and applies 3D props.
+    return setPositionInSec(dPositionInSec);
+}
+
+void SSound::endVirtualVoice()
+{
+    mtxSoundState.lock();
+
+    dVirtualPositionInSec = soundInfo.dSoundLengthInSec;
+    bVirtualPlayEnded = true;
+
+    mtxSoundState.unlock();
+
+    // Like a real voice that played the whole buffer.
+    SetEvent(voiceCallback.hStreamEnd);
+}
+
+bool SSound::isVoiceActive()
+{
+    if ((bSoundLoaded == false) || (bUseStreaming) || (soundState != SSoundState::SS_PLAYING))
+    {
+        return false;
+    }
+
+    if (bVirtual)
+    {
+        return bVirtualPlayEnded == false;
+    }
+
+    XAUDIO2_VOICE_STATE state;
+    pSourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED);
+
+    return state.BuffersQueued > 0;
+}
+
 bool SSound::readWaveData(std::vector<unsigned char>* pvWaveData, bool& bEndOfStream)
 {
 	if (bSoundLoaded == false)
@@ -965,10 +1147,7 @@ bool SSound::readWaveData(std::vector<unsigned char>* pvWaveData, bool& bEndOfSt
         return true;
     }
 
-    for (size_t i = 0; i < iLocalAudioDataLength; i++)
-    {
-        pvWaveData->push_back(pLocalAudioData[i]);
-    }
+    pvWaveData->insert(pvWaveData->end(), pLocalAudioData, pLocalAudioData + iLocalAudioDataLength);
 
     // Unlock the buffer.
     hr = pBuffer->Unlock();
@@ -1008,9 +1187,15 @@ void SSound::clearSound()
             pSourceVoice->DestroyVoice();
         }
 
-        vAudioData.clear();
+        pDecodedAudio = nullptr; // the voice does not use it anymore
         vSpeedChangedAudioData.clear();
 
+        mtxStreamingReadSampleSubmit.lock();
+        releaseStreamingSample();
+        mtxStreamingReadSampleSubmit.unlock();
+
+        pStreamRing = nullptr;
+
         if (pAsyncSourceReader)
         {
             pAsyncSourceReader->Release();
@@ -1146,7 +1331,7 @@ bool SSound::readSoundInfo(IMFSourceReader* pSourceReader, WAVEFORMATEX* pFormat
     return false;
 }
 
-bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<unsigned char> &vAudioData, WAVEFORMATEX **pFormat, unsigned int &iWaveFormatSize)
+bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::shared_ptr<const SDecodedAudio>& pOutDecodedAudio, WAVEFORMATEX **pFormat, unsigned int &iWaveFormatSize)
 {
     if (pAudioEngine->bEngineInitialized == false)
     {
@@ -1177,6 +1362,27 @@ bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<
     Microsoft::WRL::ComPtr<IMFSourceReader> pSourceReader(pSourceReaderOut);
 
 
+    // Sounds that play the same file share the decoded data.
+
+    SDecodedAudioFormat decodedFormat;
+    decodedFormat.iFormatTag = (*pFormat)->wFormatTag;
+    decodedFormat.iChannels = (*pFormat)->nChannels;
+    decodedFormat.iSampleRate = (*pFormat)->nSamplesPerSec;
+    decodedFormat.iBitsPerSample = (*pFormat)->wBitsPerSample;
+
+    pOutDecodedAudio = pAudioEngine->decodedAudioCache.find(sAudioFilePath, decodedFormat);
+    if (pOutDecodedAudio)
+    {
+        return false;
+    }
+
+
+    // Reserve the memory for the whole sound to avoid reallocations while decoding.
+
+    std::vector<unsigned char> vAudioData;
+    vAudioData.reserve(static_cast<size_t>(soundInfo.dSoundLengthInSec * (*pFormat)->nAvgBytesPerSec) + (*pFormat)->nBlockAlign);
+
+
     // Copy data into byte vector.
 
     Microsoft::WRL::ComPtr<IMFSample> pSample = nullptr;
@@ -1232,10 +1438,7 @@ bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<
             return true;
         }
 
-        for (size_t i = 0; i < iLocalAudioDataLength; i++)
-        {
-            vAudioData.push_back(pLocalAudioData[i]);
-        }
+        vAudioData.insert(vAudioData.end(), pLocalAudioData, pLocalAudioData + iLocalAudioDataLength);
 
         // Unlock the buffer.
         hr = pBuffer->Unlock();
@@ -1250,6 +1453,9 @@ bool SSound::loadFileIntoMemory(const std::wstring &sAudioFilePath, std::vector<
 
     pSourceReader.Reset();
 
+
+    pOutDecodedAudio = pAudioEngine->decodedAudioCache.add(sAudioFilePath, decodedFormat, std::move(vAudioData));
+
     return false;
 }
 
@@ -1312,8 +1518,48 @@ bool SSound::streamAudioFile(IMFSourceReader *pAsyncReader)
 	}
 
 
+    // Slots of the previous playback are released when the voice processes the flushed buffers
+    // (in VoiceCallback::OnBufferEnd()), the ring can't be reset while the voice still uses some of them.
+
+    pSourceVoice->FlushSourceBuffers();
+
+    XAUDIO2_VOICE_STATE state;
+    pSourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED);
+
+    for (size_t i = 0; (i < 100) && ((state.BuffersQueued > 0) || (pStreamRing->getAcquiredSlotCount() > 0)); i++)
+    {
+        WaitForSingleObject(voiceCallback.hBufferEndEvent, 10);
+
+        pSourceVoice->GetState(&state, XAUDIO2_VOICE_NOSAMPLESPLAYED);
+    }
+
+    if ((state.BuffersQueued > 0) || (pStreamRing->getAcquiredSlotCount() > 0))
+    {
+        SError::logError("the voice did not return the buffers of the previous playback.");
+
+        pSourceVoice->Stop();
+
+        mtxStreamingSwitch.lock();
+        bCurrentlyStreaming = false;
+        mtxStreamingSwitch.unlock();
+        promiseStreaming.set_value(false);
+
+        return true;
+    }
+
+    pStreamRing->reset();
+
+    mtxStreamingReadSampleSubmit.lock();
+    bStreamingVoiceFed = false;
+    mtxStreamingReadSampleSubmit.unlock();
+
+
     if (loopStream(pAsyncReader, pSourceVoice))
     {
+        mtxStreamingReadSampleSubmit.lock();
+        releaseStreamingSample();
+        mtxStreamingReadSampleSubmit.unlock();
+
         mtxStreamingSwitch.lock();
         bCurrentlyStreaming = false;
         mtxStreamingSwitch.unlock();
@@ -1323,6 +1569,10 @@ bool SSound::streamAudioFile(IMFSourceReader *pAsyncReader)
     }
 
 
+    mtxStreamingReadSampleSubmit.lock();
+    releaseStreamingSample();
+    mtxStreamingReadSampleSubmit.unlock();
+
     pAsyncReader->Flush(iStreamIndex);
 
     pSourceVoice->Stop();
@@ -1340,51 +1590,94 @@ bool SSound::streamAudioFile(IMFSourceReader *pAsyncReader)
 
 bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSourceVoice)
 {
-    DWORD streamIndex = (DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM;
     HRESULT hr = S_OK;
 
-    DWORD iCurrentStreamBufferIndex = 0;
-
     while(true)
     {
-        if (bStopStreaming)
+        if (waitForUnpause())
         {
             // Exit.
             break;
         }
 
 
-        if (waitForUnpause())
+
+        // Wait for a free slot (slots are released in VoiceCallback::OnBufferEnd()).
+
+        if (pStreamRing->getWriteSlot() == nullptr)
+        {
+            WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
+
+            continue;
+        }
+
+
+
+        // Decode directly to the slot (see readPCM()).
+
+        size_t iFilledSizeInBytes = 0;
+        bool bEndOfStream = false;
+
+        if (pStreamRing->fillWriteSlot(this, iFilledSizeInBytes, bEndOfStream))
         {
+            return true;
+        }
+
+        if (bStopStreaming)
+        {
+            // Exit (the slot is not committed).
             break;
         }
 
 
-        mtxStreamingReadSampleSubmit.lock();
 
-        hr = pAsyncReader->ReadSample(streamIndex, 0, nullptr, nullptr, nullptr, nullptr);
-        if (FAILED(hr))
+        // Play audio.
+
+        if (iFilledSizeInBytes > 0)
         {
-            mtxStreamingReadSampleSubmit.unlock();
+            pStreamRing->commitWriteSlot(iFilledSizeInBytes);
 
-            if (hr == MF_E_NOTACCEPTING)
+            const unsigned char* pSlotData = nullptr;
+            size_t iSlotSizeInBytes = 0;
+            pStreamRing->acquireReadSlot(pSlotData, iSlotSizeInBytes);
+
+            XAUDIO2_BUFFER buf = { 0 };
+            buf.AudioBytes = static_cast<UINT32>(iSlotSizeInBytes);
+            buf.pAudioData = pSlotData;
+            buf.pContext = pStreamRing.get(); // the slot is released in VoiceCallback::OnBufferEnd()
+
+            mtxStreamingReadSampleSubmit.lock();
+
+            XAUDIO2_VOICE_STATE state;
+            pSourceVoice->GetState(&state);
+
+            if (bStreamingVoiceFed && (state.BuffersQueued == 0))
             {
-                continue;
+                // The voice played all submitted slots before we filled this one.
+                pStreamRing->reportUnderrun();
             }
 
-            SError::showErrorMessageBoxAndLog(hr);
-            return true;
-        }
+            hr = pSourceVoice->SubmitSourceBuffer(&buf);
+            bStreamingVoiceFed = true;
 
-        WaitForSingleObject(sourceReaderCallback.hReadSampleEvent, INFINITE);
+            mtxStreamingReadSampleSubmit.unlock();
 
-        mtxStreamingReadSampleSubmit.unlock();
+            if (FAILED(hr))
+            {
+                pStreamRing->releaseReadSlot();
 
+                SError::showErrorMessageBoxAndLog(hr);
+                return true;
+            }
+        }
 
-        dCurrentStreamingPosInSec = sourceReaderCallback.llTimestamp / 10000000.0;
 
-        if (sourceReaderCallback.bIsEndOfStream)
+
+        if (bEndOfStream)
         {
+            pStreamRing->markEndOfStream();
+
+
             // Notify about onPlayEnd.
 
             XAUDIO2_VOICE_STATE state;
@@ -1403,102 +1696,112 @@ bool SSound::loopStream(IMFSourceReader *pAsyncReader, IXAudio2SourceVoice *pSou
 
             break;
         }
+    }
 
+    return false;
+}
 
+bool SSound::readPCM(unsigned char* pDestination, size_t iMaxSizeInBytes, size_t& iReadSizeInBytes, bool& bEndOfStream)
+{
+    iReadSizeInBytes = 0;
+    bEndOfStream = false;
 
-        // Sample to contiguous buffer.
+    std::lock_guard<std::mutex> lock(mtxStreamingReadSampleSubmit);
 
-        Microsoft::WRL::ComPtr<IMFMediaBuffer> pMediaBuffer;
-        hr = sourceReaderCallback.sample->ConvertToContiguousBuffer(pMediaBuffer.GetAddressOf());
-        if (FAILED(hr))
+    if (pStreamingSampleBuffer == nullptr)
+    {
+        if (bStopStreaming)
         {
-            SError::showErrorMessageBoxAndLog(hr);
-            return true;
+            return false;
         }
 
 
+        // Read the next sample.
 
-        // Read buffer.
+        DWORD streamIndex = (DWORD)MF_SOURCE_READER_FIRST_AUDIO_STREAM;
 
-        unsigned char* pAudioData = nullptr;
-        DWORD iSampleBufferSize = 0;
-
-        hr = pMediaBuffer->Lock(&pAudioData, nullptr, &iSampleBufferSize);
+        HRESULT hr = pAsyncSourceReader->ReadSample(streamIndex, 0, nullptr, nullptr, nullptr, nullptr);
         if (FAILED(hr))
         {
+            if (hr == MF_E_NOTACCEPTING)
+            {
+                return false;
+            }
+
             SError::showErrorMessageBoxAndLog(hr);
             return true;
         }
 
+        WaitForSingleObject(sourceReaderCallback.hReadSampleEvent, INFINITE);
 
 
-        // Recreate proper buffer if needed.
+        dCurrentStreamingPosInSec = sourceReaderCallback.llTimestamp / 10000000.0;
 
-        if (vSizeOfBuffers[iCurrentStreamBufferIndex] < iSampleBufferSize)
+        if (sourceReaderCallback.bIsEndOfStream)
         {
-            vBuffers[iCurrentStreamBufferIndex].reset(new uint8_t[iSampleBufferSize]);
-            vSizeOfBuffers[iCurrentStreamBufferIndex] = iSampleBufferSize;
-        }
-
+            bEndOfStream = true;
 
+            return false;
+        }
 
-        // Copy data to our buffer.
 
-        std::memcpy(vBuffers[iCurrentStreamBufferIndex].get(), pAudioData, iSampleBufferSize);
 
+        // Sample to contiguous buffer (stays locked until all of its data is copied).
 
-        hr = pMediaBuffer->Unlock();
+        hr = sourceReaderCallback.sample->ConvertToContiguousBuffer(pStreamingSampleBuffer.GetAddressOf());
         if (FAILED(hr))
         {
             SError::showErrorMessageBoxAndLog(hr);
             return true;
         }
 
-
-
-        // Wait until there is 'iMaxBufferDuringStreaming - 1' buffers in the queue (leave 1 buffer for reader).
-
-        XAUDIO2_VOICE_STATE state;
-        while(true)
+        hr = pStreamingSampleBuffer->Lock(&pStreamingSampleData, nullptr, &iStreamingSampleSizeInBytes);
+        if (FAILED(hr))
         {
-            pSourceVoice->GetState(&state);
-
-            if (state.BuffersQueued < iMaxBufferDuringStreaming - 1)
-            {
-                break;
-            }
+            pStreamingSampleBuffer.Reset();
 
-            WaitForSingleObject(voiceCallback.hBufferEndEvent, INFINITE);
-
-            if (waitForUnpause())
-            {
-                return false;
-            }
+            SError::showErrorMessageBoxAndLog(hr);
+            return true;
         }
 
+        iStreamingSampleReadOffset = 0;
+    }
 
 
-        // Play audio.
 
-        XAUDIO2_BUFFER buf = { 0 };
-        buf.AudioBytes = iSampleBufferSize;
-        buf.pAudioData = vBuffers[iCurrentStreamBufferIndex].get();
-
-        mtxStreamingReadSampleSubmit.lock();
-        pSourceVoice->SubmitSourceBuffer(&buf);
-        mtxStreamingReadSampleSubmit.unlock();
+    // Copy data to the slot.
 
+    iReadSizeInBytes = iStreamingSampleSizeInBytes - iStreamingSampleReadOffset;
+    if (iReadSizeInBytes > iMaxSizeInBytes)
+    {
+        iReadSizeInBytes = iMaxSizeInBytes;
+    }
 
+    std::memcpy(pDestination, pStreamingSampleData + iStreamingSampleReadOffset, iReadSizeInBytes);
 
-        // Next buffer.
+    iStreamingSampleReadOffset += static_cast<DWORD>(iReadSizeInBytes);
 
-        iCurrentStreamBufferIndex++;
-        iCurrentStreamBufferIndex %= iMaxBufferDuringStreaming;
+    if (iStreamingSampleReadOffset == iStreamingSampleSizeInBytes)
+    {
+        releaseStreamingSample();
     }
 
     return false;
 }
 
+void SSound::releaseStreamingSample()
+{
+    if (pStreamingSampleBuffer)
+    {
+        pStreamingSampleBuffer->Unlock();
+        pStreamingSampleBuffer.Reset();
+    }
+
+    pStreamingSampleData = nullptr;
+    iStreamingSampleSizeInBytes = 0;
+    iStreamingSampleReadOffset = 0;
+}
+
 bool SSound::createSourceReader(const std::wstring &sAudioFilePath, SourceReaderCallback** pAsyncSourceReaderCallback,
                                 IMFSourceReader *& pOutSourceReader, WAVEFORMATEX **pFormat, unsigned int &iWaveFormatSize, bool bOptional)
 {
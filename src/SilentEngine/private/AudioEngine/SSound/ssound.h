@@ -12,6 +12,7 @@
 #include <string>
 #include <functional>
 #include <future>
+#include <atomic>
 
 // XAudio2
 #include <xaudio2.h>
@@ -19,6 +20,7 @@
 
 // Custom
 #include "../SAudioEngine/saudioengine.h"
+#include "../SAudioStreamRing/saudiostreamring.h"
 
 
 class SAudioEngine;
@@ -62,13 +64,18 @@ struct S3DSoundProps
 	// props.vCustomVolumeCurve.push_back(point1);
 	// props.vCustomVolumeCurve.push_back(point2);
 	std::vector<X3DAUDIO_DISTANCE_CURVE_POINT> vCustomVolumeCurve;
+	// When there are more playing 3D sounds than SAudioEngine::setMaxReal3DVoiceCount() sounds with higher priority
+	// keep playing on their voices first, others become virtual (silent, but continue from the right position when audible again).
+	int iPriority = 0;
+	// Pitch change of moving sounds (1.0f - physically correct), 0.0f disables the doppler effect.
+	float fDopplerScaler = 0.0f;
 };
 
 //@@Class
 /*
 This class is used for playing an audio files in 2D or 3D.
 */
-class SSound
+class SSound : public SPCMSource
 {
 public:
 
@@ -80,7 +87,8 @@ public:
 	* desc: use to load/reload an audio file to play.
 	* param "sAudioFilePath": path to the audio file. Supported audio formats are: .wav, .mp3, .ogg.
 	* param "bStreamAudio": if set to 'false' the whole audio file will be uncompressed and
-	loaded in the RAM (you can use getLoadedAudioDataSizeInBytes() to see the size),
+	loaded in the RAM (you can use getLoadedAudioDataSizeInBytes() to see the size, the decoded data is shared between
+	the sounds that load the same file, see SAudioEngine::getDecodedAudioCacheStats()),
 	if set to 'true' the sound will be loaded in small chunks while playing and thus
 	keeping the amount of used memory very low. Note that there are some cons for using streaming because the sound
 	that is being streamed will apply operations (such as pause/unpause/stop and etc.) with a delay and
@@ -194,6 +202,13 @@ public:
 	* remarks: returns valid value only if not using streaming.
 	*/
     bool getLoadedAudioDataSizeInBytes(size_t& iSizeInBytes);
+	//@@Function
+	/*
+	* desc: used to retrieve the streaming counters (buffer underruns, streamed bytes and etc.).
+	* return: true if an error occurred, false otherwise.
+	* remarks: returns valid value only if using streaming.
+	*/
+    bool getStreamingStats(SAudioStreamStats& stats);
 	//@@Function
 	/*
 	* desc: tells if the sound was stopped manually (using stopSound()).
@@ -212,17 +227,33 @@ private:
 	friend class SAudioEngine;
 
     void init3DSound();
-    bool loadFileIntoMemory(const std::wstring& sAudioFilePath, std::vector<unsigned char>& vAudioData, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize);
+    bool loadFileIntoMemory(const std::wstring& sAudioFilePath, std::shared_ptr<const SDecodedAudio>& pOutDecodedAudio, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize);
 
     bool createAsyncReader(const std::wstring& sAudioFilePath, IMFSourceReader*& pSourceReader, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize);
     bool streamAudioFile(IMFSourceReader* pAsyncReader);
     bool loopStream(IMFSourceReader* pAsyncReader, IXAudio2SourceVoice* pSourceVoice);
 
+    // Reads the decoded samples of the stream into the slots of the stream ring.
+    virtual bool readPCM(unsigned char* pDestination, size_t iMaxSizeInBytes, size_t& iReadSizeInBytes, bool& bEndOfStream) override;
+    void releaseStreamingSample();
+
     bool createSourceReader(const std::wstring& sAudioFilePath, SourceReaderCallback** pAsyncSourceReaderCallback,
                             IMFSourceReader*& pOutSourceReader, WAVEFORMATEX** pFormat, unsigned int& iWaveFormatSize, bool bOptional = false);
 
 	// update listener first
 	bool applyNew3DSoundProps(SEmitterProps& emitterProps);
+	// Applies the result of SSpatializer (stereo output only), called in SAudioEngine::update3DSound().
+	bool applySpatialization (float fLeftGain, float fRightGain, float fDopplerFactor);
+
+	// Voice virtualization (see SVoiceVirtualizer), called in SAudioEngine::update3DSound().
+	// Remembers the position and stops the source voice.
+	void virtualizeVoice  ();
+	// Continues playing on the source voice from the position of the virtual playhead.
+	bool devirtualizeVoice(double dPositionInSec);
+	// The virtual playhead reached the end of the sound.
+	void endVirtualVoice  ();
+	// Playing and not finished (non-streamed sounds only).
+	bool isVoiceActive    ();
 
     bool waitForUnpause();
 
@@ -264,15 +295,20 @@ private:
     SourceReaderCallback   sourceReaderCallback;
     VoiceCallback          voiceCallback;
     bool bStopStreaming = false;
-    static const int iMaxBufferDuringStreaming = 3; // see XAUDIO2_MAX_QUEUED_BUFFERS
+    static const size_t iStreamingSlotCount = 4; // see XAUDIO2_MAX_QUEUED_BUFFERS
+    static const size_t iStreamingSlotDurationInMs = 100;
 
 
     // Used in sync mode.
-    std::vector<unsigned char> vAudioData;
+    std::shared_ptr<const SDecodedAudio> pDecodedAudio; // shared with other sounds (see SDecodedAudioCache)
     std::vector<unsigned char> vSpeedChangedAudioData;
     // Used in async mode (streaming).
-    size_t vSizeOfBuffers[iMaxBufferDuringStreaming] = { 0 };
-    std::unique_ptr<uint8_t[]> vBuffers[iMaxBufferDuringStreaming];
+    std::unique_ptr<SAudioStreamRing> pStreamRing;
+    Microsoft::WRL::ComPtr<IMFMediaBuffer> pStreamingSampleBuffer; // locked while its data is copied to the ring
+    unsigned char* pStreamingSampleData;
+    DWORD          iStreamingSampleSizeInBytes;
+    DWORD          iStreamingSampleReadOffset;
+    bool           bStreamingVoiceFed;
 
 
     std::promise<bool> promiseStreaming;
@@ -293,6 +329,14 @@ private:
 	std::mutex     mtxUpdate3DSound;
 
 
+	// Voice virtualization.
+	std::atomic<bool> bVirtual{ false };
+	bool           bVirtualPlayEnded = false;
+	double         dVirtualPositionInSec = 0.0;
+	float          fVolume = 1.0f;
+	float          fPitch = 1.0f;
+
+
     XAUDIO2_BUFFER audioBuffer;
     WAVEFORMATEX   soundFormat;
     unsigned int   iWaveFormatSize;
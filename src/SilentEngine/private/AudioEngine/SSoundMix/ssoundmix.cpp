@@ -41,6 +41,10 @@ bool SSoundMix::init()
 
     pSubmixVoiceFX->SetVolume(0.0f);
 
+
+    // The software mixer is optional, if it has no free buses this mix uses the master bus (the error is written to the log).
+    bMixerBusCreated = pAudioEngine->softwareMixer.createBus(iMixerBusIndex) == false;
+
     return false;
 }
 
@@ -53,6 +57,11 @@ bool SSoundMix::setVolume(float fVolume)
         return true;
     }
 
+    if (bMixerBusCreated)
+    {
+        pAudioEngine->softwareMixer.setBusVolume(iMixerBusIndex, fVolume);
+    }
+
 
     return false;
 }
@@ -303,8 +312,18 @@ void SSoundMix::getFXVolume(float &fFXVolume)
     fFXVolume = this->fFXVolume;
 }
 
+size_t SSoundMix::getMixerBusIndex() const
+{
+    return iMixerBusIndex;
+}
+
 SSoundMix::~SSoundMix()
 {
+    if (bMixerBusCreated)
+    {
+        pAudioEngine->softwareMixer.releaseBus(iMixerBusIndex);
+    }
+
     if (pSubmixVoice)
     {
         pSubmixVoice->DestroyVoice();
@@ -75,6 +75,15 @@ public:
     void getFXVolume(float& fFXVolume);
 
 
+	//@@Function
+	/*
+	* desc: returns the bus of the software mixer (see SAudioEngine::getSoftwareMixer()) that represents this SSoundMix,
+	use it in SMixerVoiceDesc::iBusIndex.
+	* remarks: returns the master bus if the software mixer had no free buses.
+	*/
+    size_t getMixerBusIndex() const;
+
+
 
     ~SSoundMix();
 
@@ -100,5 +109,9 @@ private:
     float fFXVolume = 1.0f;
 
 
+    size_t iMixerBusIndex = 0;
+    bool   bMixerBusCreated = false;
+
+
     bool bEffectsSet;
 };
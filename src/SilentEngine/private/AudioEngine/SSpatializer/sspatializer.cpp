@@ -0,0 +1,438 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "sspatializer.h"
+
+// STL
+#include <cmath>
+#include <algorithm>
+
+// SSE2
+#include <emmintrin.h>
+
+// Custom
+#include "SilentEngine/Private/SError/serror.h"
+
+
+// Closer emitters are considered to be at the listener position (not panned, no doppler).
+static constexpr float fMinDistance = 0.0001f;
+// Projected velocities are clamped so that the doppler factor stays in [1/3, 3].
+static constexpr float fMaxDopplerSpeed = SSpatializer::fSpeedOfSound * 0.5f;
+
+static void resizeOutput(const SSpatializerInput& input, SSpatializerOutput& output)
+{
+	const size_t iCount = input.size();
+
+	output.vEmitterIds = input.vEmitterIds;
+
+	output.vDistance.resize(iCount);
+	output.vAttenuation.resize(iCount);
+	output.vDopplerFactor.resize(iCount);
+	output.vLeftGain.resize(iCount);
+	output.vRightGain.resize(iCount);
+}
+
+static float getCurveAttenuation(const SSpatializerInput& input, size_t iEmitter, float fDistance)
+{
+	// Same as SVoiceVirtualizer::getDistanceAttenuation() (custom curve).
+
+	const float fAttenuationMultiplier = input.vAttenuationMultiplier[iEmitter];
+
+	if (fAttenuationMultiplier <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	const float* pDistances = &input.vCurveDistances[input.vCurveOffset[iEmitter]];
+	const float* pVolumes = &input.vCurveVolumes[input.vCurveOffset[iEmitter]];
+	const uint32_t iPointCount = input.vCurvePointCount[iEmitter];
+
+	fDistance /= fAttenuationMultiplier;
+
+	if (fDistance <= pDistances[0])
+	{
+		return pVolumes[0];
+	}
+
+	for (uint32_t i = 1; i < iPointCount; i++)
+	{
+		if (fDistance <= pDistances[i])
+		{
+			const float fRatio = (fDistance - pDistances[i - 1]) / (pDistances[i] - pDistances[i - 1]);
+
+			return pVolumes[i - 1] + (pVolumes[i] - pVolumes[i - 1]) * fRatio;
+		}
+	}
+
+	return pVolumes[iPointCount - 1];
+}
+
+// Distance, inverse distance attenuation, doppler and panning (not multiplied by the attenuation) of 4 emitters.
+static void spatialize4(const SSpatializerListener& listener, const float* pPositionX, const float* pPositionY, const float* pPositionZ,
+	const float* pVelocityX, const float* pVelocityY, const float* pVelocityZ, const float* pAttenuationMultiplier,
+	const float* pDopplerScaler, float* pOutDistance, float* pOutAttenuation, float* pOutDopplerFactor, float* pOutLeftPan,
+	float* pOutRightPan)
+{
+	const __m128 vZero = _mm_setzero_ps();
+	const __m128 vOne = _mm_set1_ps(1.0f);
+	const __m128 vHalf = _mm_set1_ps(0.5f);
+	const __m128 vMinusOne = _mm_set1_ps(-1.0f);
+
+
+	// Direction from the emitter to the listener.
+
+	const __m128 vDirX = _mm_sub_ps(_mm_set1_ps(listener.vPosition[0]), _mm_loadu_ps(pPositionX));
+	const __m128 vDirY = _mm_sub_ps(_mm_set1_ps(listener.vPosition[1]), _mm_loadu_ps(pPositionY));
+	const __m128 vDirZ = _mm_sub_ps(_mm_set1_ps(listener.vPosition[2]), _mm_loadu_ps(pPositionZ));
+
+	const __m128 vDistance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vDirX, vDirX), _mm_mul_ps(vDirY, vDirY)), _mm_mul_ps(vDirZ, vDirZ)));
+
+	const __m128 vFar = _mm_cmpge_ps(vDistance, _mm_set1_ps(fMinDistance));
+	const __m128 vInvDistance = _mm_and_ps(vFar, _mm_div_ps(vOne, _mm_max_ps(vDistance, _mm_set1_ps(fMinDistance))));
+
+	const __m128 vNormX = _mm_mul_ps(vDirX, vInvDistance);
+	const __m128 vNormY = _mm_mul_ps(vDirY, vInvDistance);
+	const __m128 vNormZ = _mm_mul_ps(vDirZ, vInvDistance);
+
+	_mm_storeu_ps(pOutDistance, vDistance);
+
+
+	// Inverse distance: full volume closer than the multiplier.
+
+	const __m128 vMultiplier = _mm_loadu_ps(pAttenuationMultiplier);
+	const __m128 vAttenuation = _mm_and_ps(_mm_cmpgt_ps(vMultiplier, vZero), _mm_div_ps(vMultiplier, _mm_max_ps(vDistance, vMultiplier)));
+
+	_mm_storeu_ps(pOutAttenuation, vAttenuation);
+
+
+	// Doppler.
+
+	const __m128 vDopplerScaler = _mm_loadu_ps(pDopplerScaler);
+	const __m128 vSpeedOfSound = _mm_set1_ps(SSpatializer::fSpeedOfSound);
+	const __m128 vMaxSpeed = _mm_set1_ps(fMaxDopplerSpeed);
+	const __m128 vMinSpeed = _mm_set1_ps(-fMaxDopplerSpeed);
+
+	__m128 vListenerSpeed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(listener.vVelocity[0]), vNormX),
+		_mm_mul_ps(_mm_set1_ps(listener.vVelocity[1]), vNormY)), _mm_mul_ps(_mm_set1_ps(listener.vVelocity[2]), vNormZ));
+	__m128 vEmitterSpeed = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(pVelocityX), vNormX),
+		_mm_mul_ps(_mm_loadu_ps(pVelocityY), vNormY)), _mm_mul_ps(_mm_loadu_ps(pVelocityZ), vNormZ));
+
+	vListenerSpeed = _mm_min_ps(_mm_max_ps(_mm_mul_ps(vListenerSpeed, vDopplerScaler), vMinSpeed), vMaxSpeed);
+	vEmitterSpeed = _mm_min_ps(_mm_max_ps(_mm_mul_ps(vEmitterSpeed, vDopplerScaler), vMinSpeed), vMaxSpeed);
+
+	_mm_storeu_ps(pOutDopplerFactor, _mm_div_ps(_mm_sub_ps(vSpeedOfSound, vListenerSpeed), _mm_sub_ps(vSpeedOfSound, vEmitterSpeed)));
+
+
+	// Constant power panning: -1 (left) .. 1 (right), the direction points to the listener so it's negated.
+
+	__m128 vPan = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(listener.vRight[0]), vNormX),
+		_mm_mul_ps(_mm_set1_ps(listener.vRight[1]), vNormY)), _mm_mul_ps(_mm_set1_ps(listener.vRight[2]), vNormZ));
+	vPan = _mm_min_ps(_mm_max_ps(_mm_sub_ps(vZero, vPan), vMinusOne), vOne);
+
+	_mm_storeu_ps(pOutLeftPan, _mm_sqrt_ps(_mm_mul_ps(_mm_sub_ps(vOne, vPan), vHalf)));
+	_mm_storeu_ps(pOutRightPan, _mm_sqrt_ps(_mm_mul_ps(_mm_add_ps(vOne, vPan), vHalf)));
+}
+
+void SSpatializerInput::clear()
+{
+	vEmitterIds.clear();
+
+	vPositionX.clear();
+	vPositionY.clear();
+	vPositionZ.clear();
+	vVelocityX.clear();
+	vVelocityY.clear();
+	vVelocityZ.clear();
+	vAttenuationMultiplier.clear();
+	vDopplerScaler.clear();
+
+	vCurveOffset.clear();
+	vCurvePointCount.clear();
+	vCurveDistances.clear();
+	vCurveVolumes.clear();
+}
+
+size_t SSpatializerInput::size() const
+{
+	return vEmitterIds.size();
+}
+
+SSpatializer::SSpatializer() : iMiddleState(1)
+{
+}
+
+void SSpatializer::compute(const SSpatializerListener& listener, const SSpatializerInput& input, SSpatializerOutput& output)
+{
+	resizeOutput(input, output);
+
+	const size_t iCount = input.size();
+	const size_t iSimdCount = iCount - iCount % 4;
+
+	for (size_t i = 0; i < iSimdCount; i += 4)
+	{
+		spatialize4(listener, &input.vPositionX[i], &input.vPositionY[i], &input.vPositionZ[i], &input.vVelocityX[i], &input.vVelocityY[i],
+			&input.vVelocityZ[i], &input.vAttenuationMultiplier[i], &input.vDopplerScaler[i], &output.vDistance[i], &output.vAttenuation[i],
+			&output.vDopplerFactor[i], &output.vLeftGain[i], &output.vRightGain[i]);
+	}
+
+	if (iSimdCount < iCount)
+	{
+		// Padded with silent emitters.
+
+		const size_t iTailCount = iCount - iSimdCount;
+
+		float vTail[8][4] = {};
+		float vTailOutput[5][4];
+
+		for (size_t i = 0; i < iTailCount; i++)
+		{
+			vTail[0][i] = input.vPositionX[iSimdCount + i];
+			vTail[1][i] = input.vPositionY[iSimdCount + i];
+			vTail[2][i] = input.vPositionZ[iSimdCount + i];
+			vTail[3][i] = input.vVelocityX[iSimdCount + i];
+			vTail[4][i] = input.vVelocityY[iSimdCount + i];
+			vTail[5][i] = input.vVelocityZ[iSimdCount + i];
+			vTail[6][i] = input.vAttenuationMultiplier[iSimdCount + i];
+			vTail[7][i] = input.vDopplerScaler[iSimdCount + i];
+		}
+
+		spatialize4(listener, vTail[0], vTail[1], vTail[2], vTail[3], vTail[4], vTail[5], vTail[6], vTail[7],
+			vTailOutput[0], vTailOutput[1], vTailOutput[2], vTailOutput[3], vTailOutput[4]);
+
+		for (size_t i = 0; i < iTailCount; i++)
+		{
+			output.vDistance[iSimdCount + i] = vTailOutput[0][i];
+			output.vAttenuation[iSimdCount + i] = vTailOutput[1][i];
+			output.vDopplerFactor[iSimdCount + i] = vTailOutput[2][i];
+			output.vLeftGain[iSimdCount + i] = vTailOutput[3][i];
+			output.vRightGain[iSimdCount + i] = vTailOutput[4][i];
+		}
+	}
+
+
+	// Custom volume curves (the number of points differs between emitters).
+
+	if (input.vCurveDistances.empty() == false)
+	{
+		for (size_t i = 0; i < iCount; i++)
+		{
+			if (input.vCurvePointCount[i] > 0)
+			{
+				output.vAttenuation[i] = getCurveAttenuation(input, i, output.vDistance[i]);
+			}
+		}
+	}
+
+
+	// Output matrix.
+
+	for (size_t i = 0; i < iSimdCount; i += 4)
+	{
+		const __m128 vAttenuation = _mm_loadu_ps(&output.vAttenuation[i]);
+
+		_mm_storeu_ps(&output.vLeftGain[i], _mm_mul_ps(_mm_loadu_ps(&output.vLeftGain[i]), vAttenuation));
+		_mm_storeu_ps(&output.vRightGain[i], _mm_mul_ps(_mm_loadu_ps(&output.vRightGain[i]), vAttenuation));
+	}
+
+	for (size_t i = iSimdCount; i < iCount; i++)
+	{
+		output.vLeftGain[i] *= output.vAttenuation[i];
+		output.vRightGain[i] *= output.vAttenuation[i];
+	}
+}
+
+void SSpatializer::computeScalar(const SSpatializerListener& listener, const SSpatializerInput& input, SSpatializerOutput& output)
+{
+	resizeOutput(input, output);
+
+	for (size_t i = 0; i < input.size(); i++)
+	{
+		const float fDirX = listener.vPosition[0] - input.vPositionX[i];
+		const float fDirY = listener.vPosition[1] - input.vPositionY[i];
+		const float fDirZ = listener.vPosition[2] - input.vPositionZ[i];
+
+		const float fDistance = std::sqrt(fDirX * fDirX + fDirY * fDirY + fDirZ * fDirZ);
+		const float fInvDistance = (fDistance >= fMinDistance) ? 1.0f / fDistance : 0.0f;
+
+		const float fNormX = fDirX * fInvDistance;
+		const float fNormY = fDirY * fInvDistance;
+		const float fNormZ = fDirZ * fInvDistance;
+
+		output.vDistance[i] = fDistance;
+
+
+		const float fMultiplier = input.vAttenuationMultiplier[i];
+
+		float fAttenuation = (fMultiplier > 0.0f) ? fMultiplier / std::max<float>(fDistance, fMultiplier) : 0.0f;
+		if (input.vCurvePointCount[i] > 0)
+		{
+			fAttenuation = getCurveAttenuation(input, i, fDistance);
+		}
+
+		output.vAttenuation[i] = fAttenuation;
+
+
+		float fListenerSpeed = listener.vVelocity[0] * fNormX + listener.vVelocity[1] * fNormY + listener.vVelocity[2] * fNormZ;
+		float fEmitterSpeed = input.vVelocityX[i] * fNormX + input.vVelocityY[i] * fNormY + input.vVelocityZ[i] * fNormZ;
+
+		fListenerSpeed = std::min<float>(std::max<float>(fListenerSpeed * input.vDopplerScaler[i], -fMaxDopplerSpeed), fMaxDopplerSpeed);
+		fEmitterSpeed = std::min<float>(std::max<float>(fEmitterSpeed * input.vDopplerScaler[i], -fMaxDopplerSpeed), fMaxDopplerSpeed);
+
+		output.vDopplerFactor[i] = (fSpeedOfSound - fListenerSpeed) / (fSpeedOfSound - fEmitterSpeed);
+
+
+		float fPan = listener.vRight[0] * fNormX + listener.vRight[1] * fNormY + listener.vRight[2] * fNormZ;
+		fPan = std::min<float>(std::max<float>(0.0f - fPan, -1.0f), 1.0f);
+
+		output.vLeftGain[i] = std::sqrt((1.0f - fPan) * 0.5f) * fAttenuation;
+		output.vRightGain[i] = std::sqrt((1.0f + fPan) * 0.5f) * fAttenuation;
+	}
+}
+
+bool SSpatializer::start()
+{
+	std::lock_guard<std::mutex> lock(mtxSubmit);
+
+	if (bStarted)
+	{
+		SError::showErrorMessageBoxAndLog("the spatializer is already started.");
+		return true;
+	}
+
+	bStopWorker = false;
+	bStarted = true;
+
+	worker = std::thread(&SSpatializer::workerThread, this);
+
+	return false;
+}
+
+void SSpatializer::stop()
+{
+	mtxSubmit.lock();
+
+	if (bStarted == false)
+	{
+		mtxSubmit.unlock();
+		return;
+	}
+
+	bStopWorker = true;
+
+	mtxSubmit.unlock();
+
+	cvSubmit.notify_one();
+
+	worker.join();
+
+
+	mtxSubmit.lock();
+
+	bStarted = false;
+	bPendingTick = false;
+
+	mtxSubmit.unlock();
+
+	cvIdle.notify_all();
+}
+
+void SSpatializer::submit(const SSpatializerListener& listener, SSpatializerInput& input)
+{
+	std::unique_lock<std::mutex> lock(mtxSubmit);
+
+	std::swap(pendingInput, input);
+	pendingListener = listener;
+	iSubmittedTickCount++;
+
+	if (bStarted == false)
+	{
+		compute(pendingListener, pendingInput, vOutputs[iBackIndex]);
+		vOutputs[iBackIndex].iTick = iSubmittedTickCount;
+
+		publish();
+
+		return;
+	}
+
+	bPendingTick = true;
+
+	lock.unlock();
+
+	cvSubmit.notify_one();
+}
+
+const SSpatializerOutput* SSpatializer::getLatestOutput()
+{
+	if (iMiddleState.load(std::memory_order_acquire) & iNewOutputBit)
+	{
+		const unsigned int iOldMiddle = iMiddleState.exchange(iFrontIndex, std::memory_order_acq_rel);
+
+		iFrontIndex = iOldMiddle & (iNewOutputBit - 1);
+		bFrontPublished = true;
+	}
+
+	return bFrontPublished ? &vOutputs[iFrontIndex] : nullptr;
+}
+
+void SSpatializer::waitForIdle()
+{
+	std::unique_lock<std::mutex> lock(mtxSubmit);
+
+	cvIdle.wait(lock, [this]() { return (bPendingTick == false) && (bComputing == false); });
+}
+
+SSpatializer::~SSpatializer()
+{
+	stop();
+}
+
+void SSpatializer::workerThread()
+{
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mtxSubmit);
+
+		cvSubmit.wait(lock, [this]() { return bPendingTick || bStopWorker; });
+
+		if (bStopWorker)
+		{
+			return;
+		}
+
+		std::swap(pendingInput, workingInput);
+		workingListener = pendingListener;
+		iWorkingTick = iSubmittedTickCount;
+
+		bPendingTick = false;
+		bComputing = true;
+
+		lock.unlock();
+
+
+		compute(workingListener, workingInput, vOutputs[iBackIndex]);
+		vOutputs[iBackIndex].iTick = iWorkingTick;
+
+		publish();
+
+
+		lock.lock();
+
+		bComputing = false;
+
+		lock.unlock();
+
+		cvIdle.notify_all();
+	}
+}
+
+void SSpatializer::publish()
+{
+	// The back buffer becomes the middle one, the old middle one is reused.
+	const unsigned int iOldMiddle = iMiddleState.exchange(iBackIndex | iNewOutputBit, std::memory_order_acq_rel);
+
+	iBackIndex = iOldMiddle & (iNewOutputBit - 1);
+}
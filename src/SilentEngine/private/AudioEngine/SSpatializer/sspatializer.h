@@ -0,0 +1,216 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+
+// World space, the right vector is used for panning.
+struct SSpatializerListener
+{
+	float vPosition[3] = { 0.0f, 0.0f, 0.0f };
+	float vVelocity[3] = { 0.0f, 0.0f, 0.0f }; // in units per sec. (only for doppler)
+	float vRight[3]    = { 1.0f, 0.0f, 0.0f }; // should be normalized
+};
+
+// Emitters of one tick, one array per field (SoA) so that 4 emitters are processed at once.
+struct SSpatializerInput
+{
+	void clear();
+
+	//@@Function
+	/*
+	* desc: adds an emitter.
+	* param "iEmitterId": returned in the output (see SSpatializerOutput::vEmitterIds).
+	* param "pPosition": world position (3 floats).
+	* param "pVelocity": units per sec. (3 floats).
+	* param "fAttenuationMultiplier": see S3DSoundProps::fSoundAttenuationMultiplier.
+	* param "fDopplerScaler": 0 disables the doppler effect.
+	* param "vVolumeCurve": points (Distance and DSPSetting) sorted by distance, if empty the inverse distance curve is used.
+	*/
+	template<typename CurvePoint>
+	void addEmitter(uint64_t iEmitterId, const float* pPosition, const float* pVelocity, float fAttenuationMultiplier,
+		float fDopplerScaler, const std::vector<CurvePoint>& vVolumeCurve);
+
+	size_t size() const;
+
+
+	std::vector<uint64_t> vEmitterIds;
+
+	std::vector<float>    vPositionX;
+	std::vector<float>    vPositionY;
+	std::vector<float>    vPositionZ;
+	std::vector<float>    vVelocityX;
+	std::vector<float>    vVelocityY;
+	std::vector<float>    vVelocityZ;
+	std::vector<float>    vAttenuationMultiplier;
+	std::vector<float>    vDopplerScaler;
+
+	// Points [offset, offset + count) of vCurveDistances/vCurveVolumes, count 0 - inverse distance.
+	std::vector<uint32_t> vCurveOffset;
+	std::vector<uint32_t> vCurvePointCount;
+	std::vector<float>    vCurveDistances;
+	std::vector<float>    vCurveVolumes;
+};
+
+// Same order as the input.
+struct SSpatializerOutput
+{
+	std::vector<uint64_t> vEmitterIds;
+
+	std::vector<float>    vDistance;
+	// Volume multiplier of the volume curve.
+	std::vector<float>    vAttenuation;
+	// Frequency ratio (1 if the doppler effect is disabled).
+	std::vector<float>    vDopplerFactor;
+	// Mono to stereo output matrix (constant power panning multiplied by the attenuation).
+	std::vector<float>    vLeftGain;
+	std::vector<float>    vRightGain;
+
+	// Number of submit() calls including the one that produced this output.
+	unsigned long long    iTick = 0;
+};
+
+
+//@@Class
+/*
+The class spatializes all 3D emitters of a tick at once: the emitters are stored in SoA arrays and the distance,
+volume curve attenuation, doppler factor and stereo panning are computed for 4 emitters at a time using SSE2.
+When started, the computation runs on a separate thread and the results are published atomically
+(the reader always gets a complete output of one tick).
+*/
+class SSpatializer
+{
+public:
+
+	SSpatializer();
+	SSpatializer(const SSpatializer&) = delete;
+	SSpatializer& operator= (const SSpatializer&) = delete;
+
+	//@@Function
+	/*
+	* desc: spatializes the emitters on the calling thread.
+	* param "listener": the listener.
+	* param "input": emitters.
+	* param "output": the result (resized to the number of emitters).
+	*/
+	static void compute(const SSpatializerListener& listener, const SSpatializerInput& input, SSpatializerOutput& output);
+
+	//@@Function
+	/*
+	* desc: same as compute() but without SSE2, used as a reference.
+	*/
+	static void computeScalar(const SSpatializerListener& listener, const SSpatializerInput& input, SSpatializerOutput& output);
+
+	//@@Function
+	/*
+	* desc: starts the thread that spatializes submitted emitters.
+	* return: true if an error occurred, false otherwise.
+	*/
+	bool start();
+	//@@Function
+	/*
+	* desc: stops the thread (submitted emitters that were not spatialized yet are discarded).
+	*/
+	void stop ();
+
+	//@@Function
+	/*
+	* desc: submits the emitters of a tick, if the thread is not started they are spatialized on the calling thread.
+	* param "listener": the listener.
+	* param "input": emitters, swapped with the buffer of an older tick (so it needs to be cleared before it's refilled).
+	* remarks: if the thread did not pick up the previous tick yet, the previous tick is replaced.
+	*/
+	void submit(const SSpatializerListener& listener, SSpatializerInput& input);
+
+	//@@Function
+	/*
+	* desc: returns the latest published output.
+	* return: nullptr if nothing was published yet, the output is valid until the next getLatestOutput() call.
+	* remarks: should be called from one thread.
+	*/
+	const SSpatializerOutput* getLatestOutput();
+
+	//@@Function
+	/*
+	* desc: blocks until the output of the last submitted tick is published.
+	*/
+	void waitForIdle();
+
+	~SSpatializer();
+
+
+	// Used for the doppler effect (units per sec.).
+	static constexpr float fSpeedOfSound = 343.5f;
+
+private:
+
+	void workerThread();
+	void publish();
+
+
+	std::thread             worker;
+	std::mutex              mtxSubmit;
+	std::condition_variable cvSubmit;
+	std::condition_variable cvIdle;
+	SSpatializerInput       pendingInput;
+	SSpatializerListener    pendingListener;
+	bool                    bPendingTick = false;
+	bool                    bComputing = false;
+	bool                    bStopWorker = false;
+	bool                    bStarted = false;
+	unsigned long long      iSubmittedTickCount = 0;
+
+	SSpatializerInput       workingInput;
+	SSpatializerListener    workingListener;
+	unsigned long long      iWorkingTick = 0;
+
+
+	// Triple buffer: the writer fills vOutputs[iBackIndex] and swaps it with the middle one,
+	// the reader swaps the front one with the middle one if it has a new output.
+	SSpatializerOutput      vOutputs[3];
+	std::atomic<unsigned int> iMiddleState;
+	unsigned int            iBackIndex = 0;
+	unsigned int            iFrontIndex = 2;
+	bool                    bFrontPublished = false;
+
+	static constexpr unsigned int iNewOutputBit = 4;
+};
+
+
+template<typename CurvePoint>
+void SSpatializerInput::addEmitter(uint64_t iEmitterId, const float* pPosition, const float* pVelocity, float fAttenuationMultiplier,
+	float fDopplerScaler, const std::vector<CurvePoint>& vVolumeCurve)
+{
+	vEmitterIds.push_back(iEmitterId);
+
+	vPositionX.push_back(pPosition[0]);
+	vPositionY.push_back(pPosition[1]);
+	vPositionZ.push_back(pPosition[2]);
+	vVelocityX.push_back(pVelocity[0]);
+	vVelocityY.push_back(pVelocity[1]);
+	vVelocityZ.push_back(pVelocity[2]);
+	vAttenuationMultiplier.push_back(fAttenuationMultiplier);
+	vDopplerScaler.push_back(fDopplerScaler);
+
+	vCurveOffset.push_back(static_cast<uint32_t>(vCurveDistances.size()));
+	vCurvePointCount.push_back(static_cast<uint32_t>(vVolumeCurve.size()));
+
+	for (size_t i = 0; i < vVolumeCurve.size(); i++)
+	{
+		vCurveDistances.push_back(vVolumeCurve[i].Distance);
+		vCurveVolumes.push_back(vVolumeCurve[i].DSPSetting);
+	}
+}
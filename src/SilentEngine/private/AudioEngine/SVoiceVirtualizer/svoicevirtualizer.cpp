@@ -0,0 +1,161 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "svoicevirtualizer.h"
+
+// STL
+#include <algorithm>
+
+
+SVoiceVirtualizer::SVoiceVirtualizer(size_t iMaxRealVoiceCount, float fAudibilityThreshold)
+{
+	this->iMaxRealVoiceCount = iMaxRealVoiceCount;
+	this->fAudibilityThreshold = fAudibilityThreshold;
+}
+
+void SVoiceVirtualizer::update(std::vector<SVirtualVoice>& vVoices, double dDeltaTimeInSec)
+{
+	vCandidates.clear();
+	vShouldBeReal.assign(vVoices.size(), 0);
+
+	stats.iRealVoiceCount = 0;
+	stats.iVirtualVoiceCount = 0;
+	stats.iInaudibleVoiceCount = 0;
+
+
+	// Advance virtual playheads first so that voices that become real now resume at the current position.
+
+	for (size_t i = 0; i < vVoices.size(); i++)
+	{
+		SVirtualVoice& voice = vVoices[i];
+
+		voice.bBecameReal = false;
+		voice.bBecameVirtual = false;
+		voice.bFinished = false;
+
+		if (voice.bActive == false)
+		{
+			continue;
+		}
+
+		if (voice.bReal == false)
+		{
+			voice.dPositionInSec += dDeltaTimeInSec * voice.fPitch;
+
+			if (voice.dPositionInSec >= voice.dLengthInSec)
+			{
+				voice.dPositionInSec = voice.dLengthInSec;
+				voice.bFinished = true;
+				voice.bActive = false;
+
+				continue;
+			}
+		}
+
+		if (voice.fAudibility < fAudibilityThreshold)
+		{
+			stats.iInaudibleVoiceCount++;
+			continue;
+		}
+
+		vCandidates.push_back(i);
+	}
+
+
+	// Rank.
+
+	auto isLouder = [&](size_t iA, size_t iB)
+	{
+		const SVirtualVoice& a = vVoices[iA];
+		const SVirtualVoice& b = vVoices[iB];
+
+		if (a.iPriority != b.iPriority)
+		{
+			return a.iPriority > b.iPriority;
+		}
+
+		const float fScoreA = a.bReal ? a.fAudibility * fRealVoiceBias : a.fAudibility;
+		const float fScoreB = b.bReal ? b.fAudibility * fRealVoiceBias : b.fAudibility;
+
+		if (fScoreA != fScoreB)
+		{
+			return fScoreA > fScoreB;
+		}
+
+		return iA < iB;
+	};
+
+	if (vCandidates.size() > iMaxRealVoiceCount)
+	{
+		// Only the first N are needed (not sorted).
+		std::nth_element(vCandidates.begin(), vCandidates.begin() + iMaxRealVoiceCount, vCandidates.end(), isLouder);
+		vCandidates.resize(iMaxRealVoiceCount);
+	}
+
+	for (size_t i = 0; i < vCandidates.size(); i++)
+	{
+		vShouldBeReal[vCandidates[i]] = 1;
+	}
+
+
+	// Transitions.
+
+	for (size_t i = 0; i < vVoices.size(); i++)
+	{
+		SVirtualVoice& voice = vVoices[i];
+
+		if (voice.bActive == false)
+		{
+			continue;
+		}
+
+		if (vShouldBeReal[i])
+		{
+			if (voice.bReal == false)
+			{
+				voice.bReal = true;
+				voice.bBecameReal = true;
+
+				stats.iDevirtualizedCount++;
+			}
+
+			stats.iRealVoiceCount++;
+		}
+		else
+		{
+			if (voice.bReal)
+			{
+				voice.bReal = false;
+				voice.bBecameVirtual = true;
+
+				stats.iVirtualizedCount++;
+			}
+
+			stats.iVirtualVoiceCount++;
+		}
+	}
+}
+
+void SVoiceVirtualizer::setMaxRealVoiceCount(size_t iMaxRealVoiceCount)
+{
+	this->iMaxRealVoiceCount = iMaxRealVoiceCount;
+}
+
+void SVoiceVirtualizer::setAudibilityThreshold(float fAudibilityThreshold)
+{
+	this->fAudibilityThreshold = fAudibilityThreshold;
+}
+
+size_t SVoiceVirtualizer::getMaxRealVoiceCount() const
+{
+	return iMaxRealVoiceCount;
+}
+
+SVoiceVirtualizerStats SVoiceVirtualizer::getStats() const
+{
+	return stats;
+}
@@ -0,0 +1,155 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstddef>
+
+
+// Virtualization state of a 3D sound, the engine fills the input every tick and keeps the state between ticks.
+struct SVirtualVoice
+{
+	// Input.
+
+	// Volume after the distance attenuation.
+	float  fAudibility = 0.0f;
+	// Voices with higher priority stay real first (regardless of the audibility).
+	int    iPriority = 0;
+	// Frequency ratio, the virtual playhead moves at this speed.
+	float  fPitch = 1.0f;
+	double dLengthInSec = 0.0;
+	// Playing (not paused, stopped or finished).
+	bool   bActive = false;
+
+
+	// State.
+
+	// Plays on a source voice, otherwise only the playhead is advanced.
+	bool   bReal = true;
+	// Position of the virtual playhead.
+	double dPositionInSec = 0.0;
+
+
+	// Output of the last update().
+
+	bool   bBecameReal = false;
+	bool   bBecameVirtual = false;
+	// The virtual playhead reached the end of the sound.
+	bool   bFinished = false;
+};
+
+struct SVoiceVirtualizerStats
+{
+	size_t iRealVoiceCount = 0;
+	size_t iVirtualVoiceCount = 0;
+	// Virtual voices that are quieter than the audibility threshold.
+	size_t iInaudibleVoiceCount = 0;
+
+	unsigned long long iVirtualizedCount = 0;
+	unsigned long long iDevirtualizedCount = 0;
+};
+
+
+//@@Class
+/*
+The class decides which playing 3D sounds keep their source voices (real voices): voices are ranked by the priority
+and then by the audibility, only the first N voices are real. Other voices are virtual: they don't use a source voice
+and are not spatialized, only their playhead is advanced so that they continue from the right position when they
+become real again.
+*/
+class SVoiceVirtualizer
+{
+public:
+	//@@Function
+	/*
+	* desc: creates the virtualizer.
+	* param "iMaxRealVoiceCount": number of voices that can be real at the same time.
+	* param "fAudibilityThreshold": voices quieter than this are always virtual.
+	*/
+	SVoiceVirtualizer(size_t iMaxRealVoiceCount = 64, float fAudibilityThreshold = 0.0005f);
+
+	//@@Function
+	/*
+	* desc: advances the playheads of the virtual voices and decides which voices should be real.
+	* param "vVoices": voices with the filled input, the output is written to them.
+	* param "dDeltaTimeInSec": time since the last update.
+	* remarks: voices that are not active keep their state.
+	*/
+	void update(std::vector<SVirtualVoice>& vVoices, double dDeltaTimeInSec);
+
+	void   setMaxRealVoiceCount  (size_t iMaxRealVoiceCount);
+	void   setAudibilityThreshold(float fAudibilityThreshold);
+	size_t getMaxRealVoiceCount  () const;
+
+	//@@Function
+	/*
+	* desc: returns voice counts of the last update() and the number of transitions since the creation.
+	*/
+	SVoiceVirtualizerStats getStats() const;
+
+	//@@Function
+	/*
+	* desc: returns the volume multiplier of the sound at the distance (see S3DSoundProps).
+	* param "fAttenuationMultiplier": distances of the curve are multiplied by this value.
+	* param "vVolumeCurve": points (Distance and DSPSetting) sorted by distance, if empty the inverse distance curve is used
+	(like X3DAudio does).
+	*/
+	template<typename CurvePoint>
+	static float getDistanceAttenuation(float fDistance, float fAttenuationMultiplier, const std::vector<CurvePoint>& vVolumeCurve);
+
+
+	// The score of the real voices is multiplied by this value so that voices of similar audibility
+	// don't switch every tick.
+	static constexpr float fRealVoiceBias = 1.25f;
+
+private:
+
+	std::vector<size_t> vCandidates;
+	std::vector<char>   vShouldBeReal;
+
+	SVoiceVirtualizerStats stats;
+
+	size_t iMaxRealVoiceCount;
+	float  fAudibilityThreshold;
+};
+
+
+template<typename CurvePoint>
+float SVoiceVirtualizer::getDistanceAttenuation(float fDistance, float fAttenuationMultiplier, const std::vector<CurvePoint>& vVolumeCurve)
+{
+	if (fAttenuationMultiplier <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	if (vVolumeCurve.empty())
+	{
+		// Full volume closer than the multiplier.
+		return (fDistance <= fAttenuationMultiplier) ? 1.0f : fAttenuationMultiplier / fDistance;
+	}
+
+	fDistance /= fAttenuationMultiplier;
+
+	if (fDistance <= vVolumeCurve[0].Distance)
+	{
+		return vVolumeCurve[0].DSPSetting;
+	}
+
+	for (size_t i = 1; i < vVolumeCurve.size(); i++)
+	{
+		if (fDistance <= vVolumeCurve[i].Distance)
+		{
+			const float fRatio = (fDistance - vVolumeCurve[i - 1].Distance) / (vVolumeCurve[i].Distance - vVolumeCurve[i - 1].Distance);
+
+			return vVolumeCurve[i - 1].DSPSetting + (vVolumeCurve[i].DSPSetting - vVolumeCurve[i - 1].DSPSetting) * fRatio;
+		}
+	}
+
+	return vVolumeCurve.back().DSPSetting;
+}
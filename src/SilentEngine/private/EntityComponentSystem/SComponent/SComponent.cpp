@@ -15,6 +15,8 @@
 #include "SilentEngine/Public/SApplication/SApplication.h"
 #include "SilentEngine/Public/SPrimitiveShapeGenerator/SPrimitiveShapeGenerator.h"
 #include "SilentEngine/Public/EntityComponentSystem/SAudioComponent/SAudioComponent.h"
+#include "SilentEngine/Private/STransformSystem/STransformSystem.h"
+#include "SilentEngine/Private/SBoundingVolumeHierarchy/SBoundingVolumeHierarchy.h"
 
 SComponent::SComponent()
 {
@@ -29,6 +31,15 @@ SComponent::SComponent()
 	pParentComponent = nullptr;
 	pContainer       = nullptr;
 	pCustomShader    = nullptr;
+	pTransformSystem = nullptr;
+	pObjectCBDirtyQueue = nullptr;
+	pTriangleBVH     = nullptr;
+
+	bWorldBoundsOutdated = true;
+	iBVHProxyId          = SBoundingVolumeHierarchy::iNoProxy;
+
+	iTransformIndex = 0;
+	iRenderRegistryIndex = 0;
 
 	vObjectCenter = SVector(0.0f, 0.0f, 0.0f);
 
@@ -65,6 +76,11 @@ SComponent::~SComponent()
 	}
 	
 
+	if (pTriangleBVH)
+	{
+		delete pTriangleBVH;
+	}
+
 	for (size_t i = 0; i < vChildComponents.size(); i++)
 	{
 		delete vChildComponents[i];
@@ -178,7 +194,7 @@ void SComponent::setLocalLocation(const SVector& location)
 
 	vLocation = vParentXAxisVector * location + vParentYAxisVector * location + vParentZAxisVector * location;
 
-	updateMyAndChildsLocationRotationScale(true);
+	markTransformDirty();
 }
 
 void SComponent::setLocalRotation(const SVector& rotation)
@@ -210,7 +226,7 @@ void SComponent::setLocalRotation(const SVector& rotation)
 	vLocalYAxisVector = SVector(rotMat._21, rotMat._22, rotMat._23);
 	vLocalZAxisVector = SVector(rotMat._31, rotMat._32, rotMat._33);
 
-	updateMyAndChildsLocationRotationScale(true);
+	markTransformDirty();
 }
 
 void SComponent::setLocalScale(const SVector& scale)
@@ -224,7 +240,7 @@ void SComponent::setLocalScale(const SVector& scale)
 	SVector vScaleBefore = vScale;
 	vScale = scale;
 
-	updateMyAndChildsLocationRotationScale(true);
+	markTransformDirty();
 }
 
 bool SComponent::setComponentName(const std::string& sComponentName)
@@ -399,42 +415,47 @@ void SComponent::updateVertexBufferIndexForRuntimeMeshComponents(size_t iIfIndex
 	}
 }
 
-DirectX::XMMATRIX XM_CALLCONV SComponent::getWorldMatrix()
+void SComponent::markTransformDirty()
 {
-	DirectX::XMMATRIX parentWorld = DirectX::XMMatrixIdentity();
+	STransformSystem* pSystem = pTransformSystem;
 
-	if (pParentComponent)
+	if (pSystem)
 	{
-		parentWorld = pParentComponent->getWorldMatrix();
+		pSystem->setLocalTransform(this, vLocation, vRotation, vScale);
 	}
-	else
+}
+
+void SComponent::markObjectCBDirty()
+{
+	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+	bWorldBoundsOutdated = true;
+
+	if (pObjectCBDirtyQueue)
 	{
-		SVector vParentLocationInWorld = pContainer->getLocation();
-		SVector vParentScale           = pContainer->getScale();
-		SVector vParentRotation        = pContainer->getRotation();
+		pObjectCBDirtyQueue->push(this);
+	}
+}
 
-		DirectX::XMVECTOR rot = DirectX::XMVectorSet(DirectX::XMConvertToRadians(vParentRotation.getX()), DirectX::XMConvertToRadians(vParentRotation.getY()),
-			DirectX::XMConvertToRadians(vParentRotation.getZ()), 0.0f);
-		DirectX::XMFLOAT3 rotationFloat;
-		DirectX::XMStoreFloat3(&rotationFloat, rot);
-		
-		parentWorld *= DirectX::XMMatrixScaling(vParentScale.getX(), vParentScale.getY(), vParentScale.getZ());
-		parentWorld *=  DirectX::XMMatrixRotationX(rotationFloat.x) * DirectX::XMMatrixRotationY(rotationFloat.y) *
-			DirectX::XMMatrixRotationZ(rotationFloat.z);
-		parentWorld *= DirectX::XMMatrixTranslation(vParentLocationInWorld.getX(), vParentLocationInWorld.getY(), vParentLocationInWorld.getZ());
+DirectX::XMMATRIX XM_CALLCONV SComponent::getWorldMatrix()
+{
+	STransformSystem* pSystem = pTransformSystem;
+
+	DirectX::XMFLOAT4X4 vWorldMatrix;
+	if (pSystem && pSystem->getWorldMatrix(this, vWorldMatrix) == false)
+	{
+		return DirectX::XMLoadFloat4x4(&vWorldMatrix);
 	}
 
-	DirectX::XMVECTOR rot = DirectX::XMVectorSet(DirectX::XMConvertToRadians(vRotation.getX()), DirectX::XMConvertToRadians(vRotation.getY()),
-		DirectX::XMConvertToRadians(vRotation.getZ()), 0.0f);
-	DirectX::XMFLOAT3 rotationFloat;
-	DirectX::XMStoreFloat3(&rotationFloat, rot);
+	DirectX::XMMATRIX world = STransformSystem::composeLocalMatrix(vLocation, vRotation, vScale);
+
+	for (SComponent* pParent = pParentComponent; pParent != nullptr; pParent = pParent->pParentComponent)
+	{
+		world *= STransformSystem::composeLocalMatrix(pParent->vLocation, pParent->vRotation, pParent->vScale);
+	}
 
-	DirectX::XMMATRIX myWorld = DirectX::XMMatrixIdentity() * 
-		DirectX::XMMatrixScaling(vScale.getX(), vScale.getY(), vScale.getZ()) * 
-		DirectX::XMMatrixRotationX(rotationFloat.x) * DirectX::XMMatrixRotationY(rotationFloat.y) * DirectX::XMMatrixRotationZ(rotationFloat.z) *
-		DirectX::XMMatrixTranslation(vLocation.getX(), vLocation.getY(), vLocation.getZ());
+	world *= STransformSystem::composeLocalMatrix(pContainer->getLocation(), pContainer->getRotation(), pContainer->getScale());
 
-	return myWorld * parentWorld;
+	return world;
 }
 
 void SComponent::addMeshesByShader(std::vector<SShaderObjects>* pOpaqueMeshesByShader, std::vector<SShaderObjects>* pTransparentMeshesByShader) const
@@ -630,6 +651,9 @@ void SComponent::updateObjectBounds()
 	{
 		updateSphereBounds();
 	}
+
+	// Update cull bounds.
+	markObjectCBDirty();
 }
 
 void SComponent::updateSphereBounds()
@@ -744,26 +768,6 @@ void SComponent::updateSphereBounds()
 	DirectX::XMStoreFloat(&sphereCollision.Radius, vRadius);
 }
 
-void SComponent::getAllMeshComponents(std::vector<SComponent*>* pvOpaqueComponents, std::vector<SComponent*>* pvTransparentComponents)
-{
-	if (componentType == SComponentType::SCT_MESH || componentType == SComponentType::SCT_RUNTIME_MESH)
-	{
-		if (bEnableTransparency)
-		{
-			pvTransparentComponents->push_back(this);
-		}
-		else
-		{
-			pvOpaqueComponents->push_back(this);
-		}
-	}
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->getAllMeshComponents(pvOpaqueComponents, pvTransparentComponents);
-	}
-}
-
 size_t SComponent::getMeshComponentsCount() const
 {
 	size_t iCount = iMeshComponentsCount;
@@ -886,12 +890,8 @@ SVector SComponent::getLocationInWorld()
 		return SVector(0.0f, 0.0f, 0.0f);
 	}
 
-	DirectX::XMVECTOR scale, rotation, location;
-
-	DirectX::XMMatrixDecompose(&scale, &rotation, &location, getWorldMatrix());
-
 	DirectX::XMFLOAT3 vLocation;
-	DirectX::XMStoreFloat3(&vLocation, location);
+	DirectX::XMStoreFloat3(&vLocation, getWorldMatrix().r[3]);
 
 	SVector vLocationInWorld(vLocation.x, vLocation.y, vLocation.z);
 
@@ -944,15 +944,11 @@ void SComponent::setSpawnedInLevel(bool bSpawned)
 
 void SComponent::setUpdateCBForEveryMeshComponent()
 {
-	if (componentType == SComponentType::SCT_MESH)
-	{
-		SMeshComponent* pMeshComponent = dynamic_cast<SMeshComponent*>(this);
-		pMeshComponent->renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-	}
-	else if (componentType == SComponentType::SCT_RUNTIME_MESH)
+	if (componentType == SComponentType::SCT_MESH || componentType == SComponentType::SCT_RUNTIME_MESH)
 	{
-		SRuntimeMeshComponent* pRuntimeMeshComponent = dynamic_cast<SRuntimeMeshComponent*>(this);
-		pRuntimeMeshComponent->renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		mtxComponentProps.lock();
+		markObjectCBDirty();
+		mtxComponentProps.unlock();
 	}
 
 	for (size_t i = 0; i < vChildComponents.size(); i++)
@@ -982,7 +978,12 @@ void SComponent::setCBIndexForMeshComponents(size_t* iIndex, bool bCreateBuffers
 				pMeshComponent->mtxComponentProps.unlock();
 			}
 
+			// The data in the new CB slot is not ours, need to update it.
+			pMeshComponent->mtxComponentProps.lock();
 			pMeshComponent->renderData.iObjCBIndex = *iIndex;
+			pMeshComponent->markObjectCBDirty();
+			pMeshComponent->mtxComponentProps.unlock();
+
 			(*iIndex)++;
 		}
 		else
@@ -1003,7 +1004,13 @@ void SComponent::setCBIndexForMeshComponents(size_t* iIndex, bool bCreateBuffers
 					pRuntimeMeshComponent->mtxComponentProps.unlock();
 				}
 			}
+
+			// The data in the new CB slot is not ours, need to update it.
+			pRuntimeMeshComponent->mtxComponentProps.lock();
 			pRuntimeMeshComponent->renderData.iObjCBIndex = *iIndex;
+			pRuntimeMeshComponent->markObjectCBDirty();
+			pRuntimeMeshComponent->mtxComponentProps.unlock();
+
 			(*iIndex)++;
 		}
 	}
@@ -13,10 +13,12 @@
 #include <memory>
 #include <mutex>
 #include <functional>
+#include <atomic>
 
 // Custom
 #include "SilentEngine/Public/SVector/SVector.h"
 #include "SilentEngine/Private/SRenderItem/SRenderItem.h"
+#include "SilentEngine/Private/SDirtyQueue/SDirtyQueue.h"
 #include "SilentEngine/Public/SPrimitiveShapeGenerator/SPrimitiveShapeGenerator.h"
 
 enum class SComponentType
@@ -120,6 +122,8 @@ public:
 	/*
 	* desc: called when one of the parents (container/components) updates its location/rotation/scale.
 	* remarks: this function called when this component's location/rotation/scale (in world) is already updated according to the parent's new location.
+	World transforms of the spawned components are updated once per frame (before the frame is drawn) so this function is called
+	at that moment (once per frame even if the parent was moved multiple times during this frame).
 	*/
 	void setBindOnParentLocationRotationScaleChangedCallback(std::function<void(SComponent* pComponent)> function);
 
@@ -196,12 +200,6 @@ protected:
 
 	virtual void unbindMaterialsIncludingChilds() {};
 
-	//@@Function
-	/*
-	* desc: returns all opaque and transparent mesh components.
-	*/
-	void getAllMeshComponents(std::vector<SComponent*>* pvOpaqueComponents, std::vector<SComponent*>* pvTransparentComponents);
-
 	//@@Function
 	/*
 	* desc: returns the number of mesh components (mesh and runtime mesh components) (even in child components).
@@ -291,12 +289,21 @@ protected:
 
 	//@@Function
 	/*
-	* desc: called when parent's location/rotation/scale are changed.
+	* desc: passes the new local location/rotation/scale to the transform system (if spawned) so that the world matrix
+	of this component and its childs will be recalculated.
+	*/
+	void markTransformDirty();
+	//@@Function
+	/*
+	* desc: sets the renderData.iUpdateCBInFrameResourceCount to SFRAME_RES_COUNT and pushes this component to the
+	level's dirty queue (if spawned) so that its constant buffer and cull bounds will be updated in the next frames.
+	* remarks: expects mtxComponentProps to be locked.
 	*/
-	virtual void updateMyAndChildsLocationRotationScale (bool bCalledOnSelf) = 0;
+	void markObjectCBDirty();
 	//@@Function
 	/*
 	* desc: returns the world matrix (that includes parents).
+	* remarks: if spawned the world matrix is taken from the level's transform system, otherwise it's calculated using the parents.
 	*/
 	DirectX::XMMATRIX XM_CALLCONV getWorldMatrix();
 	//@@Function
@@ -337,6 +344,9 @@ protected:
 	friend class SLightComponent;
 	friend class SAudioComponent;
 	friend class SLevel;
+	friend class STransformSystem;
+	friend class SRenderRegistry;
+	template<typename T> friend class SDirtyQueue;
 
 	SComponent* pParentComponent;
 	SContainer* pContainer;
@@ -381,6 +391,27 @@ protected:
 	std::string sComponentName;
 
 
+	// not nullptr only while spawned (atomic because it's checked without the lock, the node is then looked up
+	// under STransformSystem::mtxTransforms which also guards iTransformIndex)
+	std::atomic<class STransformSystem*> pTransformSystem;
+	size_t iTransformIndex;
+
+	// index in SRenderRegistry's array of this component type (only while spawned)
+	size_t iRenderRegistryIndex;
+
+	// not nullptr only while spawned (only mesh and runtime mesh components)
+	SDirtyQueue<SComponent>* pObjectCBDirtyQueue;
+	SDirtyQueueNode<SComponent> dirtyQueueNode;
+	// true if world space bounds in SRenderRegistry need to be recalculated
+	bool bWorldBoundsOutdated;
+
+	// ID in SRenderRegistry's BVH (only while spawned)
+	uint32_t iBVHProxyId;
+
+	// BVH of the mesh triangles in local space, built on the first ray cast and deleted when the mesh data is changed
+	class SBoundingVolumeHierarchy* pTriangleBVH;
+
+
 	bool bSpawnedInLevel;
 	bool bEnableTransparency;
 	bool bVisible;
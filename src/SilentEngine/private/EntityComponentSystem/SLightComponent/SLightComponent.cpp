@@ -31,26 +31,3 @@ bool SLightComponent::isVisible() const
 {
 	return bVisible;
 }
-
-void SLightComponent::updateMyAndChildsLocationRotationScale(bool bCalledOnSelf)
-{
-	mtxComponentProps.lock();
-
-	XMStoreFloat4x4(&renderData.vWorld, getWorldMatrix());
-
-	mtxComponentProps.unlock();
-
-
-	if ((bCalledOnSelf == false) && onParentLocationRotationScaleChangedCallback)
-	{
-		onParentLocationRotationScaleChangedCallback(this);
-	}
-
-
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
-}
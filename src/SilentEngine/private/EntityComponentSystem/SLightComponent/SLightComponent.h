@@ -71,7 +71,6 @@ protected:
 
 	virtual class SRenderPassConstants* getShadowMapConstants() = 0;
 
-	virtual void updateMyAndChildsLocationRotationScale(bool bCalledOnSelf) override;
 	virtual void allocateShadowMaps(std::vector<std::unique_ptr<SFrameResource>>* vFrameResources, ID3D12Device* pDevice,
 		CD3DX12_CPU_DESCRIPTOR_HANDLE& dsvHeapHandle, UINT iDSVDescriptorSize,
 		CD3DX12_CPU_DESCRIPTOR_HANDLE& srvCpuHeapHandle, CD3DX12_GPU_DESCRIPTOR_HANDLE& srvGpuHeapHandle,
@@ -0,0 +1,76 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SGUIBatcher.h"
+
+void SGUIBatcher::beginFrame()
+{
+	stats = SGUIBatchStats();
+
+	vLayerItems.clear();
+}
+
+void SGUIBatcher::addItem(const SGUIBatchItem& item)
+{
+	vLayerItems.push_back(item);
+}
+
+void SGUIBatcher::flushLayer(SGUIBatchBackend* pBackend)
+{
+	if (vLayerItems.size() == 0)
+	{
+		return;
+	}
+
+	// Items are not reordered (items of one layer may overlap), only adjacent items are merged.
+	size_t iRunSpriteCount = 0;
+
+	for (size_t i = 0; i < vLayerItems.size(); i++)
+	{
+		const SGUIBatchItem& item = vLayerItems[i];
+
+		bool bNewBatch = (i == 0) || (vLayerItems[i - 1].blendMode != item.blendMode);
+		bool bNewRun   = bNewBatch || (vLayerItems[i - 1].iTextureKey != item.iTextureKey);
+
+		if (bNewBatch)
+		{
+			if (i != 0)
+			{
+				pBackend->endBatch();
+			}
+
+			pBackend->beginBatch(item.blendMode);
+			stats.iBatchCount++;
+		}
+
+		if (bNewRun)
+		{
+			iRunSpriteCount = 0;
+			stats.iDrawCount++;
+		}
+
+		// The sprite batch splits a draw when it's full.
+		size_t iDrawsBefore = iRunSpriteCount == 0 ? 1 : (iRunSpriteCount + iMaxSpritesPerDraw - 1) / iMaxSpritesPerDraw;
+		iRunSpriteCount += item.iSpriteCount;
+		size_t iDrawsAfter = iRunSpriteCount == 0 ? 1 : (iRunSpriteCount + iMaxSpritesPerDraw - 1) / iMaxSpritesPerDraw;
+		stats.iDrawCount += iDrawsAfter - iDrawsBefore;
+
+		pBackend->drawItem(item);
+
+		stats.iItemCount++;
+		stats.iSpriteCount += item.iSpriteCount;
+	}
+
+	pBackend->endBatch();
+
+	vLayerItems.clear();
+}
+
+SGUIBatchStats SGUIBatcher::getStats() const
+{
+	return stats;
+}
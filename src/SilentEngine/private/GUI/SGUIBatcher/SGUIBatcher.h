@@ -0,0 +1,120 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class SGUIObject;
+
+enum class SGUIBlendMode
+{
+	SGBM_PREMULTIPLIED,
+	SGBM_NON_PREMULTIPLIED
+};
+
+//@@Class
+/*
+One GUI object to draw.
+*/
+struct SGUIBatchItem
+{
+	SGUIObject*   pObject      = nullptr;
+	uint64_t      iTextureKey  = 0; // adjacent items with the same key (and blend mode) are drawn together
+	size_t        iSpriteCount = 1; // number of quads that the item adds to the batch (glyphs for text)
+	SGUIBlendMode blendMode    = SGUIBlendMode::SGBM_PREMULTIPLIED;
+};
+
+
+//@@Class
+/*
+Interface used by the SGUIBatcher to record the batches (implemented on top of DirectXTK's SpriteBatch).
+*/
+class SGUIBatchBackend
+{
+public:
+	virtual ~SGUIBatchBackend() = default;
+
+	//@@Function
+	/*
+	* desc: starts a new sprite batch with the specified blend mode.
+	*/
+	virtual void beginBatch(SGUIBlendMode blendMode) = 0;
+	//@@Function
+	/*
+	* desc: adds the sprites of the item to the current batch.
+	*/
+	virtual void drawItem  (const SGUIBatchItem& item) = 0;
+	//@@Function
+	/*
+	* desc: submits the current batch.
+	*/
+	virtual void endBatch  () = 0;
+};
+
+
+//@@Class
+/*
+Statistics of the SGUIBatcher since the last beginFrame() call.
+*/
+struct SGUIBatchStats
+{
+	size_t iItemCount   = 0;
+	size_t iBatchCount  = 0; // beginBatch()/endBatch() pairs
+	size_t iDrawCount   = 0; // draw calls that the backend will issue (one per texture run)
+	size_t iSpriteCount = 0;
+};
+
+
+//@@Class
+/*
+The class collects the GUI objects of one layer and records them to the backend in the order in which they were added
+(objects of one layer may overlap), adjacent objects that use the same texture or font and blend mode are drawn with one draw call.
+Layers are submitted in the order in which they were flushed. Not thread-safe.
+*/
+class SGUIBatcher
+{
+public:
+	// Max. number of quads in one draw call (DirectXTK's SpriteBatch::MaxBatchSize).
+	static constexpr size_t iMaxSpritesPerDraw = 2048;
+
+	SGUIBatcher() = default;
+	SGUIBatcher(const SGUIBatcher&) = delete;
+	SGUIBatcher& operator= (const SGUIBatcher&) = delete;
+
+	//@@Function
+	/*
+	* desc: resets the stats.
+	*/
+	void           beginFrame ();
+	//@@Function
+	/*
+	* desc: adds the item to the current layer.
+	*/
+	void           addItem    (const SGUIBatchItem& item);
+	//@@Function
+	/*
+	* desc: records the items of the current layer to the backend in the order in which they were added
+	(a new batch when the blend mode changes), the next added item will start a new layer.
+	*/
+	void           flushLayer (SGUIBatchBackend* pBackend);
+
+	//@@Function
+	/*
+	* desc: returns the stats since the last beginFrame() call.
+	*/
+	SGUIBatchStats getStats   () const;
+
+private:
+
+	std::vector<SGUIBatchItem> vLayerItems; // capacity is kept between the frames
+
+	SGUIBatchStats stats;
+};
@@ -0,0 +1,524 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SGUILayoutSolver.h"
+
+// STL
+#include <algorithm>
+
+size_t SGUILayoutSolver::createLayoutNode(const SGUILayoutParams& params, void* pUserData)
+{
+	size_t iNodeId = allocateNode();
+
+	SNode& node = vNodes[iNodeId];
+	node.params = params;
+	node.pUserData = pUserData;
+	node.bIsLayout = true;
+
+	return iNodeId;
+}
+
+size_t SGUILayoutSolver::createItemNode(void* pUserData)
+{
+	size_t iNodeId = allocateNode();
+
+	vNodes[iNodeId].pUserData = pUserData;
+
+	return iNodeId;
+}
+
+void SGUILayoutSolver::destroyNode(size_t iNodeId)
+{
+	if (iNodeId >= vNodes.size() || vNodes[iNodeId].bAlive == false)
+	{
+		return;
+	}
+
+	removeFromParent(iNodeId);
+
+	for (size_t i = 0; i < vNodes[iNodeId].vChilds.size(); i++)
+	{
+		vNodes[vNodes[iNodeId].vChilds[i]].iParent = iInvalidNodeId;
+	}
+
+	bool bInDirtyList = vNodes[iNodeId].bInDirtyList;
+
+	vNodes[iNodeId] = SNode();
+
+	// The ID stays in the dirty list until the next solve(), dead nodes are skipped there.
+	vNodes[iNodeId].bInDirtyList = bInDirtyList;
+
+	vFreeNodeIds.push_back(iNodeId);
+}
+
+bool SGUILayoutSolver::addChild(size_t iLayoutId, size_t iChildId, int iRatio)
+{
+	if (iLayoutId >= vNodes.size() || iChildId >= vNodes.size() || iLayoutId == iChildId)
+	{
+		return true;
+	}
+
+	if (vNodes[iLayoutId].bAlive == false || vNodes[iLayoutId].bIsLayout == false || vNodes[iChildId].bAlive == false
+		|| vNodes[iChildId].iParent != iInvalidNodeId)
+	{
+		return true;
+	}
+
+	// The child should not be a parent of the layout.
+	for (size_t iParent = vNodes[iLayoutId].iParent; iParent != iInvalidNodeId; iParent = vNodes[iParent].iParent)
+	{
+		if (iParent == iChildId)
+		{
+			return true;
+		}
+	}
+
+	vNodes[iChildId].iParent = iLayoutId;
+	vNodes[iChildId].iRatio = iRatio;
+
+	vNodes[iLayoutId].vChilds.push_back(iChildId);
+
+	markLayoutDirty(iLayoutId);
+
+	return false;
+}
+
+void SGUILayoutSolver::removeFromParent(size_t iNodeId)
+{
+	if (iNodeId >= vNodes.size() || vNodes[iNodeId].iParent == iInvalidNodeId)
+	{
+		return;
+	}
+
+	size_t iParentId = vNodes[iNodeId].iParent;
+	std::vector<size_t>& vChilds = vNodes[iParentId].vChilds;
+
+	vChilds.erase(std::find(vChilds.begin(), vChilds.end(), iNodeId));
+
+	vNodes[iNodeId].iParent = iInvalidNodeId;
+	vNodes[iNodeId].result = SGUILayoutResult();
+	vNodes[iNodeId].bSelfDirty = false;
+
+	markLayoutDirty(iParentId);
+}
+
+void SGUILayoutSolver::setLayoutParams(size_t iLayoutId, const SGUILayoutParams& params)
+{
+	if (iLayoutId >= vNodes.size() || vNodes[iLayoutId].bIsLayout == false)
+	{
+		return;
+	}
+
+	vNodes[iLayoutId].params = params;
+
+	markLayoutDirty(iLayoutId);
+}
+
+void SGUILayoutSolver::setContentSize(size_t iNodeId, float fWidthInPixels, float fHeightInPixels)
+{
+	if (iNodeId >= vNodes.size() || vNodes[iNodeId].bAlive == false)
+	{
+		return;
+	}
+
+	SNode& node = vNodes[iNodeId];
+
+	if (node.fContentWidth == fWidthInPixels && node.fContentHeight == fHeightInPixels)
+	{
+		return;
+	}
+
+	node.fContentWidth = fWidthInPixels;
+	node.fContentHeight = fHeightInPixels;
+
+	// The parent has a fixed size so the change stops at this node.
+	if (node.iParent != iInvalidNodeId && node.bIsLayout == false)
+	{
+		node.bSelfDirty = true;
+		addToDirtyList(iNodeId);
+	}
+}
+
+void SGUILayoutSolver::setScreenSize(float fWidthInPixels, float fHeightInPixels)
+{
+	if (fScreenWidth == fWidthInPixels && fScreenHeight == fHeightInPixels)
+	{
+		return;
+	}
+
+	fScreenWidth = fWidthInPixels;
+	fScreenHeight = fHeightInPixels;
+
+	// Child layouts are relayed out by their parents (in the same pass).
+	for (size_t i = 0; i < vNodes.size(); i++)
+	{
+		markLayoutDirty(i);
+	}
+}
+
+void SGUILayoutSolver::markLayoutDirty(size_t iLayoutId)
+{
+	if (iLayoutId >= vNodes.size() || vNodes[iLayoutId].bAlive == false || vNodes[iLayoutId].bIsLayout == false)
+	{
+		return;
+	}
+
+	vNodes[iLayoutId].bLayoutDirty = true;
+
+	addToDirtyList(iLayoutId);
+}
+
+size_t SGUILayoutSolver::solve()
+{
+	vUpdatedNodes.clear();
+
+	if (vDirtyNodes.size() == 0)
+	{
+		return 0;
+	}
+
+	// Parents first so that the childs use the new slots.
+	std::vector<std::pair<size_t, size_t>> vDepthAndId(vDirtyNodes.size());
+	for (size_t i = 0; i < vDirtyNodes.size(); i++)
+	{
+		vDepthAndId[i] = { getDepth(vDirtyNodes[i]), vDirtyNodes[i] };
+	}
+
+	std::sort(vDepthAndId.begin(), vDepthAndId.end());
+
+	for (size_t i = 0; i < vDepthAndId.size(); i++)
+	{
+		size_t iNodeId = vDepthAndId[i].second;
+		SNode& node = vNodes[iNodeId];
+
+		node.bInDirtyList = false;
+
+		if (node.bAlive == false)
+		{
+			continue;
+		}
+
+		if (node.bLayoutDirty)
+		{
+			relayout(iNodeId);
+		}
+
+		// Can be already recalculated by the relayout of the parent.
+		if (node.bSelfDirty && node.iParent != iInvalidNodeId)
+		{
+			calculateChild(node.iParent, iNodeId);
+		}
+
+		node.bSelfDirty = false;
+	}
+
+	vDirtyNodes.clear();
+
+	for (size_t i = 0; i < vUpdatedNodes.size(); i++)
+	{
+		vNodes[vUpdatedNodes[i]].bUpdated = false;
+	}
+
+	return vUpdatedNodes.size();
+}
+
+const std::vector<size_t>& SGUILayoutSolver::getUpdatedNodes() const
+{
+	return vUpdatedNodes;
+}
+
+const SGUILayoutResult& SGUILayoutSolver::getResult(size_t iNodeId) const
+{
+	return vNodes[iNodeId].result;
+}
+
+void* SGUILayoutSolver::getUserData(size_t iNodeId) const
+{
+	return vNodes[iNodeId].pUserData;
+}
+
+size_t SGUILayoutSolver::getParent(size_t iNodeId) const
+{
+	return vNodes[iNodeId].iParent;
+}
+
+bool SGUILayoutSolver::isDirty() const
+{
+	return vDirtyNodes.size() != 0;
+}
+
+size_t SGUILayoutSolver::allocateNode()
+{
+	size_t iNodeId = 0;
+
+	if (vFreeNodeIds.size() != 0)
+	{
+		iNodeId = vFreeNodeIds.back();
+		vFreeNodeIds.pop_back();
+	}
+	else
+	{
+		iNodeId = vNodes.size();
+		vNodes.push_back(SNode());
+	}
+
+	bool bInDirtyList = vNodes[iNodeId].bInDirtyList;
+
+	vNodes[iNodeId] = SNode();
+	vNodes[iNodeId].bAlive = true;
+	vNodes[iNodeId].bInDirtyList = bInDirtyList;
+
+	return iNodeId;
+}
+
+void SGUILayoutSolver::addToDirtyList(size_t iNodeId)
+{
+	if (vNodes[iNodeId].bInDirtyList)
+	{
+		return;
+	}
+
+	vNodes[iNodeId].bInDirtyList = true;
+	vDirtyNodes.push_back(iNodeId);
+}
+
+size_t SGUILayoutSolver::getDepth(size_t iNodeId) const
+{
+	size_t iDepth = 0;
+
+	for (size_t iParent = vNodes[iNodeId].iParent; iParent != iInvalidNodeId; iParent = vNodes[iParent].iParent)
+	{
+		iDepth++;
+	}
+
+	return iDepth;
+}
+
+void SGUILayoutSolver::relayout(size_t iLayoutId)
+{
+	SNode& layout = vNodes[iLayoutId];
+
+	layout.bLayoutDirty = false;
+
+	if (layout.vChilds.size() == 0)
+	{
+		return;
+	}
+
+	float fWidth = 0.0f;
+	float fHeight = 0.0f;
+	getLayoutFrame(iLayoutId, fWidth, fHeight);
+
+	int iFullRatio = 0;
+	for (size_t i = 0; i < layout.vChilds.size(); i++)
+	{
+		if (layout.params.bExpandItems)
+		{
+			iFullRatio += vNodes[layout.vChilds[i]].iRatio;
+		}
+		else
+		{
+			iFullRatio += 1; // ignore ratios
+		}
+	}
+
+	float fPosBefore = 0.0f;
+
+	for (size_t i = 0; i < layout.vChilds.size(); i++)
+	{
+		size_t iChildId = layout.vChilds[i];
+		SNode& child = vNodes[iChildId];
+
+		int iRatio = layout.params.bExpandItems ? child.iRatio : 1;
+		float fShare = iFullRatio != 0 ? iRatio / static_cast<float>(iFullRatio) : 0.0f;
+
+		child.fSlotStart = fPosBefore;
+		child.fSlotShare = fShare;
+
+		float fOldFrameWidth = child.result.fFrameWidth;
+		float fOldFrameHeight = child.result.fFrameHeight;
+
+		calculateChild(iLayoutId, iChildId);
+
+		child.bSelfDirty = false;
+
+		if (child.bIsLayout && (child.bLayoutDirty || fOldFrameWidth != child.result.fFrameWidth || fOldFrameHeight != child.result.fFrameHeight))
+		{
+			relayout(iChildId);
+		}
+
+		if (layout.params.layoutType == SLayoutType::SLT_HORIZONTAL)
+		{
+			fPosBefore += fWidth * fShare;
+		}
+		else
+		{
+			fPosBefore += fHeight * fShare;
+		}
+	}
+}
+
+void SGUILayoutSolver::calculateChild(size_t iLayoutId, size_t iChildId)
+{
+	const SNode& layout = vNodes[iLayoutId];
+	SNode& child = vNodes[iChildId];
+
+	float fWidth = 0.0f;
+	float fHeight = 0.0f;
+	getLayoutFrame(iLayoutId, fWidth, fHeight);
+
+	float fFullWidth = fWidth * fScreenWidth * layout.params.fScaleX;
+	float fFullHeight = fHeight * fScreenHeight * layout.params.fScaleY;
+
+	const float fShare = child.fSlotShare;
+	const float fPosBefore = child.fSlotStart;
+	const bool bHorizontal = layout.params.layoutType == SLayoutType::SLT_HORIZONTAL;
+
+	SGUILayoutResult result;
+
+	if (child.bIsLayout)
+	{
+		// Child layouts fill their slot.
+		if (bHorizontal)
+		{
+			result.fFrameWidth = fWidth * fShare;
+			result.fFrameHeight = fHeight;
+			result.fOffsetX = -fWidth / 2.0f + fPosBefore + result.fFrameWidth / 2.0f;
+		}
+		else
+		{
+			result.fFrameWidth = fWidth;
+			result.fFrameHeight = fHeight * fShare;
+			result.fOffsetY = -fHeight / 2.0f + fPosBefore + result.fFrameHeight / 2.0f;
+		}
+
+		child.result = result;
+	}
+	else
+	{
+		// Offset from the top-left corner of the layout.
+		float x = 0.0f;
+		float y = 0.0f;
+
+		float fScreenScaleX = 1.0f;
+		float fScreenScaleY = 1.0f;
+
+		result.fOriginX = 0.0f;
+		result.fOriginY = 0.0f;
+
+		if (bHorizontal)
+		{
+			fScreenScaleX = child.fContentWidth > 0.0f ? fFullWidth * fShare / child.fContentWidth : 1.0f;
+			fScreenScaleY = child.fContentHeight > 0.0f ? fFullHeight / child.fContentHeight : 1.0f;
+
+			if (layout.params.bExpandItems)
+			{
+				x = fPosBefore + fWidth * fShare / 2.0f;
+				y = fHeight / 2.0f;
+			}
+			else
+			{
+				x = fPosBefore;
+
+				if (layout.params.alignment == SLayoutAlignment::SLA_CENTER)
+				{
+					y += fHeight / 2.0f;
+					result.fOriginX = 0.5f;
+				}
+				else if (layout.params.alignment == SLayoutAlignment::SLA_RIGHT)
+				{
+					y += fHeight;
+					result.fOriginX = 1.0f;
+
+					x -= fWidth * layout.params.indent.fRightIndent;
+				}
+				else // SLA_LEFT
+				{
+					x += fWidth * layout.params.indent.fLeftIndent;
+				}
+
+				y += fHeight * layout.params.indent.fTopIndent - fHeight * layout.params.indent.fBottomIndent;
+
+				result.bHasSizeToKeep = true;
+				result.fSizeToKeepX = fWidth * fShare;
+				result.fSizeToKeepY = fHeight;
+			}
+		}
+		else
+		{
+			fScreenScaleX = child.fContentWidth > 0.0f ? fFullWidth / child.fContentWidth : 1.0f;
+			fScreenScaleY = child.fContentHeight > 0.0f ? fFullHeight * fShare / child.fContentHeight : 1.0f;
+
+			if (layout.params.bExpandItems)
+			{
+				x = fWidth / 2.0f;
+				y = fPosBefore + fHeight * fShare / 2.0f;
+			}
+			else
+			{
+				y = fPosBefore;
+
+				if (layout.params.alignment == SLayoutAlignment::SLA_CENTER)
+				{
+					x += fWidth / 2.0f;
+					result.fOriginX = 0.5f;
+				}
+				else if (layout.params.alignment == SLayoutAlignment::SLA_RIGHT)
+				{
+					x += fWidth;
+					result.fOriginX = 1.0f;
+
+					x -= fWidth * layout.params.indent.fRightIndent;
+				}
+				else // SLA_LEFT
+				{
+					x += fWidth * layout.params.indent.fLeftIndent;
+				}
+
+				y += fHeight * layout.params.indent.fTopIndent - fHeight * layout.params.indent.fBottomIndent;
+
+				result.bHasSizeToKeep = true;
+				result.fSizeToKeepX = fWidth;
+				result.fSizeToKeepY = fHeight * fShare;
+			}
+		}
+
+		if (layout.params.bExpandItems)
+		{
+			result.fLayoutScreenScaleX = fScreenScaleX;
+			result.fLayoutScreenScaleY = fScreenScaleY;
+		}
+
+		// Offset from the center of the layout.
+		result.fOffsetX = x - fWidth / 2.0f;
+		result.fOffsetY = y - fHeight / 2.0f;
+
+		child.result = result;
+	}
+
+	if (child.bUpdated == false)
+	{
+		child.bUpdated = true;
+		vUpdatedNodes.push_back(iChildId);
+	}
+}
+
+void SGUILayoutSolver::getLayoutFrame(size_t iLayoutId, float& fWidth, float& fHeight) const
+{
+	const SNode& layout = vNodes[iLayoutId];
+
+	if (layout.iParent != iInvalidNodeId)
+	{
+		fWidth = layout.result.fFrameWidth;
+		fHeight = layout.result.fFrameHeight;
+	}
+	else
+	{
+		fWidth = layout.params.fWidth;
+		fHeight = layout.params.fHeight;
+	}
+}
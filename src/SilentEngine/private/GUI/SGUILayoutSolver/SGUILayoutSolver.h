@@ -0,0 +1,241 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class SLayoutType
+{
+	SLT_HORIZONTAL,
+	SLT_VERTICAL,
+};
+
+enum class SLayoutAlignment
+{
+	SLA_LEFT,
+	SLA_CENTER,
+	SLA_RIGHT,
+};
+
+struct SLayoutIndent
+{
+	float fLeftIndent = 0.0f;
+	float fRightIndent = 0.0f;
+	float fTopIndent = 0.0f;
+	float fBottomIndent = 0.0f;
+};
+
+
+//@@Class
+/*
+Parameters of a layout node.
+*/
+struct SGUILayoutParams
+{
+	SLayoutType      layoutType   = SLayoutType::SLT_HORIZONTAL;
+	SLayoutAlignment alignment    = SLayoutAlignment::SLA_LEFT;
+	SLayoutIndent    indent;
+
+	// Size (in normalized range: [0, 1]), ignored when the layout is a child of another layout.
+	float            fWidth       = 1.0f;
+	float            fHeight      = 1.0f;
+
+	float            fScaleX      = 1.0f;
+	float            fScaleY      = 1.0f;
+
+	bool             bExpandItems = true;
+};
+
+
+//@@Class
+/*
+Result of the layout for one child node (same values that SGUILayout used to write to its childs).
+*/
+struct SGUILayoutResult
+{
+	// Offset from the center of the parent layout (in normalized range).
+	float fOffsetX            = 0.0f;
+	float fOffsetY            = 0.0f;
+
+	float fOriginX            = 0.5f;
+	float fOriginY            = 0.5f;
+
+	float fLayoutScreenScaleX = 1.0f;
+	float fLayoutScreenScaleY = 1.0f;
+
+	// Size to keep of the item (in normalized range), only valid if bHasSizeToKeep is true (items of non expanding layouts).
+	float fSizeToKeepX        = 0.0f;
+	float fSizeToKeepY        = 0.0f;
+
+	// Size (in normalized range) of the child layout.
+	float fFrameWidth         = 0.0f;
+	float fFrameHeight        = 0.0f;
+
+	bool  bHasSizeToKeep      = false;
+};
+
+
+//@@Class
+/*
+The class positions the childs of the GUI layouts incrementally: changes only mark the nodes as dirty and solve()
+recalculates only the dirty nodes in one pass (parents before childs).
+A change of an item's size only invalidates the item itself, because layouts have fixed sizes
+(the size of a root layout is fixed and the size of a child layout is fixed by its parent),
+a change of a layout's parameters or childs relays out its childs and the child layouts which sizes were changed.
+Not thread-safe.
+*/
+class SGUILayoutSolver
+{
+public:
+	static constexpr size_t iInvalidNodeId = SIZE_MAX;
+
+	SGUILayoutSolver() = default;
+	SGUILayoutSolver(const SGUILayoutSolver&) = delete;
+	SGUILayoutSolver& operator= (const SGUILayoutSolver&) = delete;
+
+	//@@Function
+	/*
+	* desc: creates a layout node.
+	* param "pUserData": pointer that will be returned by getUserData().
+	* return: ID of the node.
+	*/
+	size_t createLayoutNode  (const SGUILayoutParams& params, void* pUserData);
+	//@@Function
+	/*
+	* desc: creates an item (not a layout) node.
+	* return: ID of the node.
+	*/
+	size_t createItemNode    (void* pUserData);
+	//@@Function
+	/*
+	* desc: removes the node from its parent, detaches its childs and frees the ID.
+	*/
+	void   destroyNode       (size_t iNodeId);
+
+	//@@Function
+	/*
+	* desc: adds the node as the last child of the layout.
+	* param "iRatio": the ratio that the child will take in the layout (ignored for non expanding layouts).
+	* return: false if successful, true if the node already has a parent or the parent is not a layout (or is the node itself or its child).
+	*/
+	bool   addChild          (size_t iLayoutId, size_t iChildId, int iRatio);
+	//@@Function
+	/*
+	* desc: removes the node from its parent.
+	*/
+	void   removeFromParent  (size_t iNodeId);
+
+	//@@Function
+	/*
+	* desc: sets the parameters of the layout (its childs will be relayed out).
+	*/
+	void   setLayoutParams   (size_t iLayoutId, const SGUILayoutParams& params);
+	//@@Function
+	/*
+	* desc: sets the size of the node (in pixels, including scaling), only this node will be recalculated.
+	*/
+	void   setContentSize    (size_t iNodeId, float fWidthInPixels, float fHeightInPixels);
+	//@@Function
+	/*
+	* desc: sets the screen size in pixels, all layouts will be relayed out if the size was changed.
+	*/
+	void   setScreenSize     (float fWidthInPixels, float fHeightInPixels);
+	//@@Function
+	/*
+	* desc: marks the layout as dirty (all childs will be relayed out).
+	*/
+	void   markLayoutDirty   (size_t iLayoutId);
+
+	//@@Function
+	/*
+	* desc: recalculates the dirty nodes.
+	* return: number of nodes which results were recalculated (see getUpdatedNodes()).
+	*/
+	size_t solve             ();
+
+	//@@Function
+	/*
+	* desc: returns the nodes which results were recalculated in the last solve() call.
+	*/
+	const std::vector<size_t>& getUpdatedNodes() const;
+	//@@Function
+	/*
+	* desc: returns the result of the child node.
+	*/
+	const SGUILayoutResult&    getResult      (size_t iNodeId) const;
+	//@@Function
+	/*
+	* desc: returns the user data passed on node creation.
+	*/
+	void*                      getUserData    (size_t iNodeId) const;
+	//@@Function
+	/*
+	* desc: returns the parent node ID or iInvalidNodeId.
+	*/
+	size_t                     getParent      (size_t iNodeId) const;
+	//@@Function
+	/*
+	* desc: returns true if solve() has something to do.
+	*/
+	bool                       isDirty        () const;
+
+private:
+
+	struct SNode
+	{
+		SGUILayoutParams    params;
+		SGUILayoutResult    result;
+
+		std::vector<size_t> vChilds;
+
+		void*  pUserData        = nullptr;
+
+		size_t iParent          = iInvalidNodeId;
+
+		int    iRatio           = 1;
+
+		// Content size (in pixels) of the item.
+		float  fContentWidth    = 0.0f;
+		float  fContentHeight   = 0.0f;
+
+		// Slot of this node in the parent layout (from the last relayout of the parent).
+		float  fSlotStart       = 0.0f;
+		float  fSlotShare       = 0.0f;
+
+		bool   bAlive           = false;
+		bool   bIsLayout        = false;
+		bool   bLayoutDirty     = false; // all childs should be relayed out
+		bool   bSelfDirty       = false; // only the result of this node should be recalculated
+		bool   bInDirtyList     = false;
+		bool   bUpdated         = false; // added to vUpdatedNodes in the current solve()
+	};
+
+	size_t allocateNode     ();
+	void   addToDirtyList   (size_t iNodeId);
+	size_t getDepth         (size_t iNodeId) const;
+
+	// Recalculates the slots and results of all childs of the layout (and child layouts which sizes changed).
+	void   relayout         (size_t iLayoutId);
+	// Recalculates the result of the child using its slot.
+	void   calculateChild   (size_t iLayoutId, size_t iChildId);
+
+	void   getLayoutFrame   (size_t iLayoutId, float& fWidth, float& fHeight) const;
+
+
+	std::vector<SNode>  vNodes;
+	std::vector<size_t> vFreeNodeIds;
+
+	std::vector<size_t> vDirtyNodes;
+	std::vector<size_t> vUpdatedNodes;
+
+	float fScreenWidth  = 0.0f;
+	float fScreenHeight = 0.0f;
+};
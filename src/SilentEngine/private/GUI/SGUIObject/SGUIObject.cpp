@@ -71,6 +71,8 @@ SGUIObject::SGUIObject(const std::string& sObjectName)
 	iZLayer = 0;
 	fRotationInRad = 0.0f;
 
+	iLayoutNodeId = SGUILayoutSolver::iInvalidNodeId;
+
 	vSizeToKeep = SVector(-1.0f, -1.0f);
 
 	scale = DirectX::XMFLOAT2(1.0f, 1.0f);
@@ -146,6 +148,11 @@ void SGUIObject::setPosition(const SVector& vPos)
 void SGUIObject::setScale(const SVector& vScale)
 {
 	scale = DirectX::XMFLOAT2(vScale.getX(), vScale.getY());
+
+	if (layoutData.pLayout && objectType != SGUIType::SGT_LAYOUT)
+	{
+		updateLayoutContentSize(getFullSizeInPixels());
+	}
 }
 
 void SGUIObject::setTint(const SVector& vColor)
@@ -228,6 +235,21 @@ int SGUIObject::getZLayer() const
 	return iZLayer;
 }
 
+void SGUIObject::updateLayoutContentSize(const SVector& vFullSizeInPixels)
+{
+	SApplication* pApp = SApplication::getApp();
+
+	std::lock_guard<std::mutex> layoutGuard(pApp->mtxGUILayout);
+
+	if (iLayoutNodeId == SGUILayoutSolver::iInvalidNodeId)
+	{
+		return;
+	}
+
+	// Only this object will be recalculated, the size of the layout does not depend on its childs.
+	pApp->guiLayoutSolver.setContentSize(iLayoutNodeId, vFullSizeInPixels.getX(), vFullSizeInPixels.getY());
+}
+
 SGUIObject::~SGUIObject()
 {
 }
\ No newline at end of file
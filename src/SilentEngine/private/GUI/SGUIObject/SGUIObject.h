@@ -20,6 +20,7 @@
 
 // Custom
 #include "SilentEngine/Public/SVector/SVector.h"
+#include "SilentEngine/Private/GUI/SGUILayoutSolver/SGUILayoutSolver.h"
 
 class SGUIObject;
 
@@ -104,6 +105,7 @@ public:
 	* desc: use to set the Z-layer, GUI objects with bigger layer value will be rendered on top of the objects with lower layer value.
 	* param "iZLayer": positive layer value.
 	* remarks: by default all GUI objects have Z-layer index equal to 0 (lowest layer).
+	Objects of the same layer are rendered in the order in which they were added to the layer (registered or moved by this function).
 	*/
 	void setZLayer      (int iZLayer);
 
@@ -164,6 +166,7 @@ protected:
 	friend class SApplication;
 	friend class SGUILayout;
 	friend class SProfiler;
+	friend class SGUISpriteRenderer;
 
 	SVector getFullScreenScaling();
 	SVector getFullPosition();
@@ -174,8 +177,10 @@ protected:
 	virtual void setViewport(D3D12_VIEWPORT viewport) = 0;
 	virtual bool checkRequiredResourcesBeforeRegister() = 0;
 	virtual void recalculateSizeToKeepScaling() = 0;
-	// including scale (but not screenScale), used in layout's recalculateSizeToKeepScaling() to calculate screenScale for this object
+	// including scale (but not screenScale), used by the layout solver to calculate layoutScreenScale for this object
 	virtual SVector getFullSizeInPixels() = 0;
+	// should be called when the result of getFullSizeInPixels() is changed, does nothing if not in a layout
+	void updateLayoutContentSize(const SVector& vFullSizeInPixels);
 
 
 	SLayoutData layoutData;
@@ -194,6 +199,8 @@ protected:
 
 	int          iZLayer;
 
+	size_t       iLayoutNodeId; // node in the SApplication's layout solver (guarded by SApplication::mtxGUILayout)
+
 	float        fRotationInRad;
 
 	bool         bIsRegistered;
@@ -0,0 +1,224 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SGUISpriteRenderer.h"
+
+// DirectX
+#include "SilentEngine/Private/d3dx12.h"
+
+// DirectXTK
+#include "ResourceUploadBatch.h"
+#include "CommonStates.h"
+#include "DirectXHelpers.h"
+#include "SimpleMath.h"
+
+// Custom
+#include "SilentEngine/Public/GUI/SGUIImage/SGUIImage.h"
+#include "SilentEngine/Public/GUI/SGUISimpleText/SGUISimpleText.h"
+#include "SilentEngine/Private/SError/SError.h"
+
+bool SGUISpriteRenderer::init(ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue, const DirectX::RenderTargetState& rtState)
+{
+	DirectX::ResourceUploadBatch resourceUpload(pDevice);
+
+	resourceUpload.Begin();
+
+	// Text and .dds images use premultiplied alpha.
+	DirectX::SpriteBatchPipelineStateDescription premultipliedDesc(rtState);
+	pPremultipliedBatch = std::make_unique<DirectX::SpriteBatch>(pDevice, resourceUpload, premultipliedDesc);
+
+	// Images loaded using WIC use straight alpha.
+	DirectX::SpriteBatchPipelineStateDescription nonPremultipliedDesc(rtState, &DirectX::CommonStates::NonPremultiplied);
+	pNonPremultipliedBatch = std::make_unique<DirectX::SpriteBatch>(pDevice, resourceUpload, nonPremultipliedDesc);
+
+	auto uploadResourcesFinished = resourceUpload.End(pCommandQueue);
+	uploadResourcesFinished.wait();
+
+	if (pPremultipliedBatch == nullptr || pNonPremultipliedBatch == nullptr)
+	{
+		SError::showErrorMessageBoxAndLog("failed to create the GUI sprite batches.");
+		return true;
+	}
+
+	return false;
+}
+
+void SGUISpriteRenderer::setViewport(const D3D12_VIEWPORT& viewport)
+{
+	pPremultipliedBatch->SetViewport(viewport);
+	pNonPremultipliedBatch->SetViewport(viewport);
+}
+
+void SGUISpriteRenderer::beginFrame(ID3D12GraphicsCommandList* pCommandList, D3D12_GPU_DESCRIPTOR_HANDLE heapStart, UINT iDescriptorSize,
+	int iWindowWidth, int iWindowHeight)
+{
+	this->pCommandList = pCommandList;
+	this->heapStart = heapStart;
+	this->iDescriptorSize = iDescriptorSize;
+	this->iWindowWidth = iWindowWidth;
+	this->iWindowHeight = iWindowHeight;
+}
+
+void SGUISpriteRenderer::beginBatch(SGUIBlendMode blendMode)
+{
+	if (blendMode == SGUIBlendMode::SGBM_NON_PREMULTIPLIED)
+	{
+		pCurrentBatch = pNonPremultipliedBatch.get();
+	}
+	else
+	{
+		pCurrentBatch = pPremultipliedBatch.get();
+	}
+
+	// Deferred mode: consecutive sprites with the same texture are drawn with one draw call.
+	pCurrentBatch->Begin(pCommandList, DirectX::SpriteSortMode_Deferred);
+}
+
+void SGUISpriteRenderer::drawItem(const SGUIBatchItem& item)
+{
+	if (item.pObject->objectType == SGUIType::SGT_IMAGE)
+	{
+		drawImage(static_cast<SGUIImage*>(item.pObject));
+	}
+	else if (item.pObject->objectType == SGUIType::SGT_SIMPLE_TEXT)
+	{
+		drawText(static_cast<SGUISimpleText*>(item.pObject));
+	}
+}
+
+void SGUISpriteRenderer::endBatch()
+{
+	pCurrentBatch->End();
+
+	pCurrentBatch = nullptr;
+}
+
+uint64_t SGUISpriteRenderer::getImageTextureKey(SGUIImage* pImage) const
+{
+	auto heapHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart);
+	heapHandle.Offset(pImage->iIndexInHeap, iDescriptorSize);
+
+	return heapHandle.ptr;
+}
+
+void SGUISpriteRenderer::drawImage(SGUIImage* pImage)
+{
+	auto heapHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(heapStart);
+	heapHandle.Offset(pImage->iIndexInHeap, iDescriptorSize);
+
+	// Position.
+	SVector position = pImage->getFullPosition();
+	DirectX::SimpleMath::Vector2 pos = DirectX::SimpleMath::Vector2(position.getX(), position.getY());
+	pos.x *= iWindowWidth;
+	pos.y *= iWindowHeight;
+
+	DirectX::XMUINT2 texSize = DirectX::GetTextureSize(pImage->pTexture.Get());
+
+	// Origin.
+	DirectX::SimpleMath::Vector2 origin = pImage->origin;
+	origin.x *= texSize.x;
+	origin.y *= texSize.y;
+
+	// Source rect.
+	RECT sourceRect;
+	sourceRect.left = static_cast<LONG>(pImage->sourceRect.getX() * texSize.x);
+	sourceRect.top = static_cast<LONG>(pImage->sourceRect.getY() * texSize.y);
+	sourceRect.right = static_cast<LONG>(pImage->sourceRect.getZ() * texSize.x);
+	sourceRect.bottom = static_cast<LONG>(pImage->sourceRect.getW() * texSize.y);
+
+	// Scaling.
+	DirectX::XMFLOAT2 scaling = pImage->scale; // usual scale
+	SVector screenScaling = pImage->getFullScreenScaling();
+	scaling.x *= screenScaling.getX();
+	scaling.y *= screenScaling.getY();
+
+	RECT bounds;
+	bounds.left = static_cast<LONG>(pos.x - (texSize.x * scaling.x / 2));
+	bounds.right = static_cast<LONG>(pos.x + (texSize.x * scaling.x / 2));
+	bounds.top = static_cast<LONG>(pos.y - (texSize.y * scaling.y / 2));
+	bounds.bottom = static_cast<LONG>(pos.y + (texSize.y * scaling.y / 2));
+	pImage->lastDrawBounds = bounds;
+
+	pCurrentBatch->Draw(heapHandle,
+		texSize, pos, &sourceRect, DirectX::XMLoadFloat4(&pImage->color), pImage->fRotationInRad, origin,
+		scaling);
+}
+
+void SGUISpriteRenderer::drawText(SGUISimpleText* pText)
+{
+	const SGUITextLayout& layout = pText->textLayout;
+
+	// Origin.
+	DirectX::SimpleMath::Vector2 texSize;
+	layout.getSize(texSize.x, texSize.y);
+	DirectX::SimpleMath::Vector2 origin = pText->origin;
+	origin.x *= texSize.x;
+	origin.y *= texSize.y;
+
+	// Position.
+	SVector position = pText->getFullPosition();
+	DirectX::SimpleMath::Vector2 pos = DirectX::SimpleMath::Vector2(position.getX(), position.getY());
+	pos.x *= iWindowWidth;
+	pos.y *= iWindowHeight;
+
+	// Scaling.
+	DirectX::XMFLOAT2 scaling = pText->scale;
+	SVector screenScaling = pText->getFullScreenScaling();
+	scaling.x *= screenScaling.getX();
+	scaling.y *= screenScaling.getY();
+
+	// All passes replay the cached glyph quads and use the same font texture so they end up in the same draw call.
+
+	if (pText->bDrawOutline)
+	{
+		DirectX::XMVECTOR outlineColor = DirectX::XMLoadFloat4(&pText->outlineColor);
+
+		const DirectX::SimpleMath::Vector2 vOutlineOffsets[] = { {1.f, 1.f}, {-1.f, 1.f}, {-1.f, -1.f}, {1.f, -1.f} };
+
+		for (const auto& offset : vOutlineOffsets)
+		{
+			drawGlyphs(pText, pos + offset, outlineColor, origin, scaling);
+		}
+	}
+
+	if (pText->bDrawShadow)
+	{
+		const DirectX::SimpleMath::Vector2 vShadowOffsets[] = { {1.f, 1.f}, {-1.f, 1.f} };
+
+		for (const auto& offset : vShadowOffsets)
+		{
+			drawGlyphs(pText, pos + offset, DirectX::Colors::Black, origin, scaling);
+		}
+	}
+
+	drawGlyphs(pText, pos, DirectX::XMLoadFloat4(&pText->color), origin, scaling);
+}
+
+void XM_CALLCONV SGUISpriteRenderer::drawGlyphs(SGUISimpleText* pText, const DirectX::XMFLOAT2& position, DirectX::FXMVECTOR color,
+	const DirectX::XMFLOAT2& origin, const DirectX::XMFLOAT2& scaling)
+{
+	const std::vector<SGUIGlyphQuad>& vQuads = pText->textLayout.getQuads();
+
+	D3D12_GPU_DESCRIPTOR_HANDLE spriteSheet = pText->pSpriteFont->GetSpriteSheet();
+	DirectX::XMUINT2 spriteSheetSize = pText->pSpriteFont->GetSpriteSheetSize();
+
+	for (size_t i = 0; i < vQuads.size(); i++)
+	{
+		const SGUIGlyphQuad& quad = vQuads[i];
+
+		RECT sourceRect;
+		sourceRect.left = quad.iLeft;
+		sourceRect.top = quad.iTop;
+		sourceRect.right = quad.iRight;
+		sourceRect.bottom = quad.iBottom;
+
+		// Same as SpriteFont::DrawString(): the glyph offset is applied through the origin so that rotation and scaling stay correct.
+		DirectX::XMFLOAT2 glyphOrigin(origin.x - quad.fX, origin.y - quad.fY);
+
+		pCurrentBatch->Draw(spriteSheet, spriteSheetSize, position, &sourceRect, color, pText->fRotationInRad, glyphOrigin, scaling);
+	}
+}
@@ -0,0 +1,89 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <memory>
+
+// DirectX
+#include <wrl.h> // smart pointers
+#include <d3d12.h>
+
+// DirectXTK
+#include "SpriteBatch.h"
+
+// Custom
+#include "SilentEngine/Private/GUI/SGUIBatcher/SGUIBatcher.h"
+
+class SGUIImage;
+class SGUISimpleText;
+
+//@@Class
+/*
+The class records the GUI batches using one shared SpriteBatch per blend mode.
+*/
+class SGUISpriteRenderer : public SGUIBatchBackend
+{
+public:
+	SGUISpriteRenderer() = default;
+	SGUISpriteRenderer(const SGUISpriteRenderer&) = delete;
+	SGUISpriteRenderer& operator= (const SGUISpriteRenderer&) = delete;
+	virtual ~SGUISpriteRenderer() override = default;
+
+	//@@Function
+	/*
+	* desc: creates the sprite batches.
+	* param "rtState": render target state of the pass in which the GUI is drawn.
+	* return: false if successful, true otherwise.
+	*/
+	bool init(ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue, const DirectX::RenderTargetState& rtState);
+
+	//@@Function
+	/*
+	* desc: sets the viewport of the sprite batches.
+	*/
+	void setViewport(const D3D12_VIEWPORT& viewport);
+
+	//@@Function
+	/*
+	* desc: should be called before the GUI objects of the frame are recorded.
+	* param "heapStart": GPU handle of the start of the CBV/SRV/UAV heap (used for the SRVs of the images).
+	*/
+	void beginFrame(ID3D12GraphicsCommandList* pCommandList, D3D12_GPU_DESCRIPTOR_HANDLE heapStart, UINT iDescriptorSize,
+		int iWindowWidth, int iWindowHeight);
+
+	virtual void beginBatch(SGUIBlendMode blendMode) override;
+	virtual void drawItem  (const SGUIBatchItem& item) override;
+	virtual void endBatch  () override;
+
+	//@@Function
+	/*
+	* desc: returns the batch key of the image.
+	*/
+	uint64_t getImageTextureKey(SGUIImage* pImage) const;
+
+private:
+
+	void drawImage(SGUIImage* pImage);
+	void drawText (SGUISimpleText* pText);
+	void XM_CALLCONV drawGlyphs(SGUISimpleText* pText, const DirectX::XMFLOAT2& position, DirectX::FXMVECTOR color,
+		const DirectX::XMFLOAT2& origin, const DirectX::XMFLOAT2& scaling);
+
+	std::unique_ptr<DirectX::SpriteBatch> pPremultipliedBatch;
+	std::unique_ptr<DirectX::SpriteBatch> pNonPremultipliedBatch;
+
+	DirectX::SpriteBatch*        pCurrentBatch = nullptr;
+
+	ID3D12GraphicsCommandList*   pCommandList = nullptr;
+
+	D3D12_GPU_DESCRIPTOR_HANDLE  heapStart = {};
+	UINT                         iDescriptorSize = 0;
+
+	int                          iWindowWidth = 0;
+	int                          iWindowHeight = 0;
+};
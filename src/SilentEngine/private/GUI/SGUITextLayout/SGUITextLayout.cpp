@@ -0,0 +1,228 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SGUITextLayout.h"
+
+// STL
+#include <algorithm>
+#include <cwctype>
+
+// Same as SpriteFont::Impl::ForEachGlyph().
+template<typename TAction>
+static void forEachGlyph(const SGUIGlyphSource* pFont, const std::wstring& sText, bool bIgnoreWhitespace, TAction action)
+{
+	float x = 0.0f;
+	float y = 0.0f;
+
+	const float fLineSpacing = pFont->getLineSpacing();
+
+	for (size_t i = 0; i < sText.size(); i++)
+	{
+		wchar_t character = sText[i];
+
+		if (character == L'\r')
+		{
+			continue;
+		}
+
+		if (character == L'\n')
+		{
+			x = 0.0f;
+			y += fLineSpacing;
+			continue;
+		}
+
+		SGUIGlyph glyph = pFont->getGlyph(character);
+
+		x += glyph.fXOffset;
+
+		if (x < 0.0f)
+		{
+			x = 0.0f;
+		}
+
+		float fAdvance = static_cast<float>(glyph.iRight) - static_cast<float>(glyph.iLeft) + glyph.fXAdvance;
+
+		if (bIgnoreWhitespace == false
+			|| std::iswspace(character) == 0
+			|| (glyph.iRight - glyph.iLeft) > 1
+			|| (glyph.iBottom - glyph.iTop) > 1)
+		{
+			action(glyph, x, y);
+		}
+
+		x += fAdvance;
+	}
+}
+
+void SGUITextLayout::build(const SGUIGlyphSource* pFont, const std::wstring& sRawText, float fMaxLineWidth, bool bAlignTextAtCenter,
+	float fCenterAlignDelta)
+{
+	clear();
+
+	if (pFont == nullptr)
+	{
+		return;
+	}
+
+	sWrappedText = wrapText(pFont, sRawText, fMaxLineWidth, bAlignTextAtCenter, fCenterAlignDelta);
+
+	const float fLineSpacing = pFont->getLineSpacing();
+
+	// Quads and the size (ignoring whitespace) in one pass.
+	forEachGlyph(pFont, sWrappedText, true, [&](const SGUIGlyph& glyph, float x, float y)
+	{
+		SGUIGlyphQuad quad;
+		quad.fX = x;
+		quad.fY = y + glyph.fYOffset;
+		quad.iLeft = glyph.iLeft;
+		quad.iTop = glyph.iTop;
+		quad.iRight = glyph.iRight;
+		quad.iBottom = glyph.iBottom;
+
+		vQuads.push_back(quad);
+
+		float w = static_cast<float>(glyph.iRight - glyph.iLeft);
+		float h = static_cast<float>(glyph.iBottom - glyph.iTop) + glyph.fYOffset;
+
+		h = std::iswspace(static_cast<wchar_t>(glyph.iCharacter)) ? fLineSpacing : std::max(h, fLineSpacing);
+
+		fWidth = std::max(fWidth, x + w);
+		fHeight = std::max(fHeight, y + h);
+	});
+
+	measureString(pFont, sWrappedText, false, fWidthWhitespace, fHeightWhitespace);
+}
+
+void SGUITextLayout::clear()
+{
+	vQuads.clear();
+	sWrappedText.clear();
+
+	fWidth = 0.0f;
+	fHeight = 0.0f;
+	fWidthWhitespace = 0.0f;
+	fHeightWhitespace = 0.0f;
+}
+
+void SGUITextLayout::getSize(float& fWidth, float& fHeight, bool bIgnoreWhitespace) const
+{
+	if (bIgnoreWhitespace)
+	{
+		fWidth = this->fWidth;
+		fHeight = this->fHeight;
+	}
+	else
+	{
+		fWidth = fWidthWhitespace;
+		fHeight = fHeightWhitespace;
+	}
+}
+
+const std::wstring& SGUITextLayout::getWrappedText() const
+{
+	return sWrappedText;
+}
+
+const std::vector<SGUIGlyphQuad>& SGUITextLayout::getQuads() const
+{
+	return vQuads;
+}
+
+void SGUITextLayout::measureString(const SGUIGlyphSource* pFont, const std::wstring& sText, bool bIgnoreWhitespace, float& fWidth, float& fHeight)
+{
+	fWidth = 0.0f;
+	fHeight = 0.0f;
+
+	const float fLineSpacing = pFont->getLineSpacing();
+
+	forEachGlyph(pFont, sText, bIgnoreWhitespace, [&](const SGUIGlyph& glyph, float x, float y)
+	{
+		float w = static_cast<float>(glyph.iRight - glyph.iLeft);
+		float h = static_cast<float>(glyph.iBottom - glyph.iTop) + glyph.fYOffset;
+
+		h = std::iswspace(static_cast<wchar_t>(glyph.iCharacter)) ? fLineSpacing : std::max(h, fLineSpacing);
+
+		fWidth = std::max(fWidth, x + w);
+		fHeight = std::max(fHeight, y + h);
+	});
+}
+
+std::wstring SGUITextLayout::wrapText(const SGUIGlyphSource* pFont, const std::wstring& sRawText, float fMaxLineWidth, bool bAlignTextAtCenter,
+	float fCenterAlignDelta) const
+{
+	if (fMaxLineWidth < 0.001f)
+	{
+		return sRawText;
+	}
+
+	std::vector<std::wstring> vWords;
+
+	// Split.
+	std::wstring sCurrentWord = L"";
+	for (size_t i = 0; i < sRawText.size(); i++)
+	{
+		if (sRawText[i] == L' ' && sCurrentWord != L"")
+		{
+			vWords.push_back(sCurrentWord);
+			sCurrentWord = L"";
+		}
+		else
+		{
+			sCurrentWord += sRawText[i];
+		}
+	}
+
+	if (sCurrentWord != L"")
+	{
+		vWords.push_back(sCurrentWord);
+	}
+
+
+	float fCurrentLineWidth = 0.0f;
+	float fSpaceWidth = 0.0f;
+	float fUnused = 0.0f;
+	measureString(pFont, L" ", false, fSpaceWidth, fUnused);
+
+	std::wstring sWrappedText = L"";
+
+	size_t iLastLineStartIndex = 0;
+
+	for (size_t i = 0; i < vWords.size(); i++)
+	{
+		float fWordWidth = 0.0f;
+		measureString(pFont, vWords[i], true, fWordWidth, fUnused);
+
+		if (fCurrentLineWidth + fWordWidth < fMaxLineWidth)
+		{
+			sWrappedText.append(vWords[i] + L" ");
+			fCurrentLineWidth += fWordWidth + fSpaceWidth;
+		}
+		else
+		{
+			sWrappedText += L"\n";
+
+			iLastLineStartIndex = sWrappedText.size();
+
+			sWrappedText.append(vWords[i] + L" ");
+			fCurrentLineWidth = fWordWidth + fSpaceWidth;
+		}
+	}
+
+	if (bAlignTextAtCenter && fSpaceWidth > 0.0f)
+	{
+		if (fCurrentLineWidth < fMaxLineWidth - fCenterAlignDelta)
+		{
+			float fNeedToAdd = fMaxLineWidth - fCurrentLineWidth;
+			size_t iAddCount = static_cast<size_t>(fNeedToAdd / fSpaceWidth / 2.0);
+
+			sWrappedText.insert(iLastLineStartIndex, iAddCount, L' ');
+		}
+	}
+
+	return sWrappedText;
+}
@@ -0,0 +1,138 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//@@Class
+/*
+One glyph of a font (same layout as DirectXTK's SpriteFont::Glyph).
+*/
+struct SGUIGlyph
+{
+	uint32_t iCharacter = 0;
+
+	// Rectangle of the glyph in the sprite sheet (in pixels).
+	int32_t  iLeft      = 0;
+	int32_t  iTop       = 0;
+	int32_t  iRight     = 0;
+	int32_t  iBottom    = 0;
+
+	float    fXOffset   = 0.0f;
+	float    fYOffset   = 0.0f;
+	float    fXAdvance  = 0.0f;
+};
+
+
+//@@Class
+/*
+Interface used by the SGUITextLayout to get the glyphs of a font.
+*/
+class SGUIGlyphSource
+{
+public:
+	virtual ~SGUIGlyphSource() = default;
+
+	//@@Function
+	/*
+	* desc: returns the glyph of the character (or the glyph of the default character).
+	*/
+	virtual SGUIGlyph getGlyph      (wchar_t character) const = 0;
+	//@@Function
+	/*
+	* desc: returns the distance between two lines (in pixels).
+	*/
+	virtual float     getLineSpacing() const = 0;
+};
+
+
+//@@Class
+/*
+One glyph quad of the laid out text.
+*/
+struct SGUIGlyphQuad
+{
+	// Top-left corner of the glyph relative to the top-left corner of the text (in pixels, without scaling).
+	float   fX      = 0.0f;
+	float   fY      = 0.0f;
+
+	// Rectangle of the glyph in the sprite sheet (in pixels).
+	int32_t iLeft   = 0;
+	int32_t iTop    = 0;
+	int32_t iRight  = 0;
+	int32_t iBottom = 0;
+};
+
+
+//@@Class
+/*
+The class wraps the text and calculates the positions of its glyphs and its size once, the quads
+can then be drawn every frame (and for every outline/shadow pass) without laying out the text again.
+The glyphs are placed the same way as DirectXTK's SpriteFont::DrawString() does.
+*/
+class SGUITextLayout
+{
+public:
+	SGUITextLayout() = default;
+
+	//@@Function
+	/*
+	* desc: wraps the text and calculates the glyph quads.
+	* param "fMaxLineWidth": max. line width (in pixels) for text wrapping, 0 to disable wrapping.
+	* param "bAlignTextAtCenter": whether the last line should be moved to the center (using spaces) or not.
+	* param "fCenterAlignDelta": the last line is not moved if it's shorter than max. line width by less than this value (in pixels).
+	*/
+	void build(const SGUIGlyphSource* pFont, const std::wstring& sRawText, float fMaxLineWidth, bool bAlignTextAtCenter, float fCenterAlignDelta);
+	//@@Function
+	/*
+	* desc: removes all quads.
+	*/
+	void clear();
+
+	//@@Function
+	/*
+	* desc: returns the size of the text (in pixels, same as SpriteFont::MeasureString()).
+	* param "bIgnoreWhitespace": whether the whitespace glyphs should be ignored or not.
+	*/
+	void getSize(float& fWidth, float& fHeight, bool bIgnoreWhitespace = true) const;
+
+	//@@Function
+	/*
+	* desc: returns the text with the line breaks added by the wrapping.
+	*/
+	const std::wstring&               getWrappedText() const;
+	//@@Function
+	/*
+	* desc: returns the quads of the visible glyphs.
+	*/
+	const std::vector<SGUIGlyphQuad>& getQuads      () const;
+
+	//@@Function
+	/*
+	* desc: measures the text the same way as SpriteFont::MeasureString() does.
+	*/
+	static void measureString(const SGUIGlyphSource* pFont, const std::wstring& sText, bool bIgnoreWhitespace, float& fWidth, float& fHeight);
+
+private:
+
+	std::wstring wrapText(const SGUIGlyphSource* pFont, const std::wstring& sRawText, float fMaxLineWidth, bool bAlignTextAtCenter,
+		float fCenterAlignDelta) const;
+
+	std::vector<SGUIGlyphQuad> vQuads;
+
+	std::wstring sWrappedText;
+
+	float fWidth            = 0.0f;
+	float fHeight           = 0.0f;
+	float fWidthWhitespace  = 0.0f;
+	float fHeightWhitespace = 0.0f;
+};
@@ -0,0 +1,747 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SBoundingVolumeHierarchy.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+// SSE
+#include <emmintrin.h>
+
+static float getAxis(const DirectX::XMFLOAT3& v, size_t iAxis)
+{
+	return iAxis == 0 ? v.x : (iAxis == 1 ? v.y : v.z);
+}
+
+static void setUnion(SBVHNode& outNode, const SBVHNode& a, const SBVHNode& b)
+{
+	outNode.vMin = DirectX::XMFLOAT3(std::min(a.vMin.x, b.vMin.x), std::min(a.vMin.y, b.vMin.y), std::min(a.vMin.z, b.vMin.z));
+	outNode.vMax = DirectX::XMFLOAT3(std::max(a.vMax.x, b.vMax.x), std::max(a.vMax.y, b.vMax.y), std::max(a.vMax.z, b.vMax.z));
+}
+
+static float getArea(const DirectX::XMFLOAT3& vMin, const DirectX::XMFLOAT3& vMax)
+{
+	const float fX = vMax.x - vMin.x;
+	const float fY = vMax.y - vMin.y;
+	const float fZ = vMax.z - vMin.z;
+
+	return 2.0f * (fX * fY + fY * fZ + fZ * fX);
+}
+
+static float getUnionArea(const SBVHNode& a, const SBVHNode& b)
+{
+	SBVHNode unionNode;
+	setUnion(unionNode, a, b);
+
+	return getArea(unionNode.vMin, unionNode.vMax);
+}
+
+static void setBox(SBVHNode& outNode, const DirectX::BoundingBox& box)
+{
+	outNode.vMin = DirectX::XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+	outNode.vMax = DirectX::XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+}
+
+void SBoundingVolumeHierarchy::build(const std::vector<DirectX::BoundingBox>& vBoxes)
+{
+	vNodes.clear();
+	vFreeNodes.clear();
+	iRootNode = -1;
+
+	vProxyNodes.clear();
+	vFreeProxies.clear();
+	iProxyCount = 0;
+
+	for (size_t i = 0; i < vBoxes.size(); i++)
+	{
+		const int32_t iLeaf = allocateNode();
+		setBox(vNodes[iLeaf], vBoxes[i]);
+		vNodes[iLeaf].iProxy = static_cast<int32_t>(i);
+
+		vProxyNodes.push_back(iLeaf);
+	}
+
+	iProxyCount = vBoxes.size();
+
+	rebuild();
+}
+
+void SBoundingVolumeHierarchy::rebuild()
+{
+	// Collect leaves.
+
+	std::vector<SBVHNode> vItems;
+	vItems.reserve(iProxyCount);
+
+	for (size_t i = 0; i < vProxyNodes.size(); i++)
+	{
+		if (vProxyNodes[i] != -1)
+		{
+			vItems.push_back(vNodes[vProxyNodes[i]]);
+		}
+	}
+
+	vNodes.clear();
+	vFreeNodes.clear();
+	iRootNode = -1;
+
+	if (vItems.empty() == false)
+	{
+		vNodes.reserve(vItems.size() * 2 - 1);
+
+		iRootNode = buildNode(vItems, 0, vItems.size(), -1);
+	}
+
+	fCostAfterBuild        = getCost();
+	iChangesSinceLastCheck = 0;
+}
+
+bool SBoundingVolumeHierarchy::rebuildIfDegraded()
+{
+	// Computing the cost requires a walk over all nodes so don't check after every change.
+
+	if (iChangesSinceLastCheck < std::max<size_t>(64, iProxyCount / 4))
+	{
+		return false;
+	}
+
+	iChangesSinceLastCheck = 0;
+
+	if (fCostAfterBuild == 0.0f || getCost() > fCostAfterBuild * 1.5f)
+	{
+		rebuild();
+
+		return true;
+	}
+
+	return false;
+}
+
+uint32_t SBoundingVolumeHierarchy::addProxy(const DirectX::BoundingBox& box)
+{
+	uint32_t iProxy = 0;
+
+	if (vFreeProxies.empty())
+	{
+		iProxy = static_cast<uint32_t>(vProxyNodes.size());
+		vProxyNodes.push_back(-1);
+	}
+	else
+	{
+		iProxy = vFreeProxies.back();
+		vFreeProxies.pop_back();
+	}
+
+	const int32_t iLeaf = allocateNode();
+	setBox(vNodes[iLeaf], box);
+	vNodes[iLeaf].iProxy = static_cast<int32_t>(iProxy);
+
+	insertLeaf(iLeaf);
+
+	vProxyNodes[iProxy] = iLeaf;
+	iProxyCount++;
+
+	iChangesSinceLastCheck++;
+
+	return iProxy;
+}
+
+void SBoundingVolumeHierarchy::removeProxy(uint32_t iProxy)
+{
+	const int32_t iLeaf = vProxyNodes[iProxy];
+
+	removeLeaf(iLeaf);
+	freeNode(iLeaf);
+
+	vProxyNodes[iProxy] = -1;
+	vFreeProxies.push_back(iProxy);
+	iProxyCount--;
+
+	iChangesSinceLastCheck++;
+}
+
+void SBoundingVolumeHierarchy::updateProxy(uint32_t iProxy, const DirectX::BoundingBox& box)
+{
+	const int32_t iLeaf = vProxyNodes[iProxy];
+
+	setBox(vNodes[iLeaf], box);
+
+	refitAncestors(vNodes[iLeaf].iParent);
+
+	iChangesSinceLastCheck++;
+}
+
+void SBoundingVolumeHierarchy::rayCast(const DirectX::XMFLOAT3& vOrigin, const DirectX::XMFLOAT3& vDirection, float fMaxDistance,
+	std::vector<uint32_t>& vOutProxies) const
+{
+	traverseRay(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), vOrigin, vDirection, fMaxDistance, vOutProxies);
+}
+
+void SBoundingVolumeHierarchy::rayCastPacket(const DirectX::XMFLOAT3* pOrigins, const DirectX::XMFLOAT3* pDirections,
+	const float* pMaxDistances, size_t iRayCount, std::vector<uint32_t>* pOutProxies) const
+{
+	if (iRootNode == -1 || iRayCount == 0)
+	{
+		return;
+	}
+
+	// Rays in SoA, unused lanes have negative max distance so they never hit anything.
+
+	float vOriginX[iRayPacketSize], vOriginY[iRayPacketSize], vOriginZ[iRayPacketSize];
+	float vInvDirectionX[iRayPacketSize], vInvDirectionY[iRayPacketSize], vInvDirectionZ[iRayPacketSize];
+	float vMaxDistance[iRayPacketSize];
+
+	for (size_t i = 0; i < iRayPacketSize; i++)
+	{
+		const size_t iRay = std::min(i, iRayCount - 1);
+		const DirectX::XMFLOAT3 vInvDirection = getInvDirection(pDirections[iRay]);
+
+		vOriginX[i] = pOrigins[iRay].x;
+		vOriginY[i] = pOrigins[iRay].y;
+		vOriginZ[i] = pOrigins[iRay].z;
+
+		vInvDirectionX[i] = vInvDirection.x;
+		vInvDirectionY[i] = vInvDirection.y;
+		vInvDirectionZ[i] = vInvDirection.z;
+
+		vMaxDistance[i] = i < iRayCount ? pMaxDistances[iRay] : -1.0f;
+	}
+
+	const __m128 vPacketOriginX = _mm_loadu_ps(vOriginX);
+	const __m128 vPacketOriginY = _mm_loadu_ps(vOriginY);
+	const __m128 vPacketOriginZ = _mm_loadu_ps(vOriginZ);
+	const __m128 vPacketInvDirectionX = _mm_loadu_ps(vInvDirectionX);
+	const __m128 vPacketInvDirectionY = _mm_loadu_ps(vInvDirectionY);
+	const __m128 vPacketInvDirectionZ = _mm_loadu_ps(vInvDirectionZ);
+	const __m128 vPacketMaxDistance = _mm_loadu_ps(vMaxDistance);
+	const __m128 vZero = _mm_setzero_ps();
+
+	std::vector<int32_t> vStack;
+	vStack.reserve(64);
+	vStack.push_back(iRootNode);
+
+	while (vStack.empty() == false)
+	{
+		const SBVHNode& node = vNodes[vStack.back()];
+		vStack.pop_back();
+
+		// Same operations as in intersectsRay() but for 4 rays.
+
+		const __m128 vX1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMin.x), vPacketOriginX), vPacketInvDirectionX);
+		const __m128 vX2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMax.x), vPacketOriginX), vPacketInvDirectionX);
+		const __m128 vY1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMin.y), vPacketOriginY), vPacketInvDirectionY);
+		const __m128 vY2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMax.y), vPacketOriginY), vPacketInvDirectionY);
+		const __m128 vZ1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMin.z), vPacketOriginZ), vPacketInvDirectionZ);
+		const __m128 vZ2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(node.vMax.z), vPacketOriginZ), vPacketInvDirectionZ);
+
+		const __m128 vEnter = _mm_max_ps(_mm_max_ps(_mm_min_ps(vX1, vX2), _mm_min_ps(vY1, vY2)), _mm_max_ps(_mm_min_ps(vZ1, vZ2), vZero));
+		const __m128 vExit  = _mm_min_ps(_mm_min_ps(_mm_max_ps(vX1, vX2), _mm_max_ps(vY1, vY2)), _mm_min_ps(_mm_max_ps(vZ1, vZ2), vPacketMaxDistance));
+
+		const int iHitMask = _mm_movemask_ps(_mm_cmple_ps(vEnter, vExit));
+
+		if (iHitMask == 0)
+		{
+			continue;
+		}
+
+		if (node.iProxy != -1)
+		{
+			for (size_t i = 0; i < iRayCount; i++)
+			{
+				if (iHitMask & (1 << i))
+				{
+					pOutProxies[i].push_back(static_cast<uint32_t>(node.iProxy));
+				}
+			}
+		}
+		else
+		{
+			vStack.push_back(node.iLeft);
+			vStack.push_back(node.iRight);
+		}
+	}
+}
+
+void SBoundingVolumeHierarchy::overlap(const DirectX::BoundingBox& box, std::vector<uint32_t>& vOutProxies) const
+{
+	if (iRootNode == -1)
+	{
+		return;
+	}
+
+	SBVHNode boxNode;
+	setBox(boxNode, box);
+
+	std::vector<int32_t> vStack;
+	vStack.reserve(64);
+	vStack.push_back(iRootNode);
+
+	while (vStack.empty() == false)
+	{
+		const SBVHNode& node = vNodes[vStack.back()];
+		vStack.pop_back();
+
+		if (node.vMin.x > boxNode.vMax.x || node.vMax.x < boxNode.vMin.x
+			|| node.vMin.y > boxNode.vMax.y || node.vMax.y < boxNode.vMin.y
+			|| node.vMin.z > boxNode.vMax.z || node.vMax.z < boxNode.vMin.z)
+		{
+			continue;
+		}
+
+		if (node.iProxy != -1)
+		{
+			vOutProxies.push_back(static_cast<uint32_t>(node.iProxy));
+		}
+		else
+		{
+			vStack.push_back(node.iLeft);
+			vStack.push_back(node.iRight);
+		}
+	}
+}
+
+void SBoundingVolumeHierarchy::sweep(const DirectX::BoundingBox& box, const DirectX::XMFLOAT3& vDirection, float fMaxDistance,
+	std::vector<uint32_t>& vOutProxies) const
+{
+	// Moving box vs node is the same as the ray from the box center vs the node expanded by the box extents.
+
+	traverseRay(box.Extents, box.Center, vDirection, fMaxDistance, vOutProxies);
+}
+
+DirectX::BoundingBox SBoundingVolumeHierarchy::getProxyBox(uint32_t iProxy) const
+{
+	const SBVHNode& node = vNodes[vProxyNodes[iProxy]];
+
+	DirectX::BoundingBox box;
+	box.Center  = DirectX::XMFLOAT3((node.vMin.x + node.vMax.x) * 0.5f, (node.vMin.y + node.vMax.y) * 0.5f, (node.vMin.z + node.vMax.z) * 0.5f);
+	box.Extents = DirectX::XMFLOAT3((node.vMax.x - node.vMin.x) * 0.5f, (node.vMax.y - node.vMin.y) * 0.5f, (node.vMax.z - node.vMin.z) * 0.5f);
+
+	return box;
+}
+
+size_t SBoundingVolumeHierarchy::getProxyCount() const
+{
+	return iProxyCount;
+}
+
+float SBoundingVolumeHierarchy::getCost() const
+{
+	if (iRootNode == -1)
+	{
+		return 0.0f;
+	}
+
+	const float fRootArea = getArea(vNodes[iRootNode].vMin, vNodes[iRootNode].vMax);
+	if (fRootArea <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	float fInternalArea = 0.0f;
+
+	std::vector<int32_t> vStack;
+	vStack.push_back(iRootNode);
+
+	while (vStack.empty() == false)
+	{
+		const SBVHNode& node = vNodes[vStack.back()];
+		vStack.pop_back();
+
+		if (node.iProxy == -1)
+		{
+			fInternalArea += getArea(node.vMin, node.vMax);
+
+			vStack.push_back(node.iLeft);
+			vStack.push_back(node.iRight);
+		}
+	}
+
+	return fInternalArea / fRootArea;
+}
+
+bool SBoundingVolumeHierarchy::getRayHitDistance(const DirectX::BoundingBox& box, const DirectX::XMFLOAT3& vOrigin,
+	const DirectX::XMFLOAT3& vDirection, float fMaxDistance, float& fOutDistance)
+{
+	SBVHNode boxNode;
+	setBox(boxNode, box);
+
+	return intersectsRay(boxNode, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), vOrigin, getInvDirection(vDirection), fMaxDistance, fOutDistance);
+}
+
+bool SBoundingVolumeHierarchy::intersectsRay(const SBVHNode& node, const DirectX::XMFLOAT3& vExpand, const DirectX::XMFLOAT3& vOrigin,
+	const DirectX::XMFLOAT3& vInvDirection, float fMaxDistance, float& fOutDistance)
+{
+	const float fX1 = (node.vMin.x - vExpand.x - vOrigin.x) * vInvDirection.x;
+	const float fX2 = (node.vMax.x + vExpand.x - vOrigin.x) * vInvDirection.x;
+	const float fY1 = (node.vMin.y - vExpand.y - vOrigin.y) * vInvDirection.y;
+	const float fY2 = (node.vMax.y + vExpand.y - vOrigin.y) * vInvDirection.y;
+	const float fZ1 = (node.vMin.z - vExpand.z - vOrigin.z) * vInvDirection.z;
+	const float fZ2 = (node.vMax.z + vExpand.z - vOrigin.z) * vInvDirection.z;
+
+	const float fEnter = std::max(std::max(std::min(fX1, fX2), std::min(fY1, fY2)), std::max(std::min(fZ1, fZ2), 0.0f));
+	const float fExit  = std::min(std::min(std::max(fX1, fX2), std::max(fY1, fY2)), std::min(std::max(fZ1, fZ2), fMaxDistance));
+
+	fOutDistance = fEnter;
+
+	return fEnter <= fExit;
+}
+
+DirectX::XMFLOAT3 SBoundingVolumeHierarchy::getInvDirection(const DirectX::XMFLOAT3& vDirection)
+{
+	// Big value instead of the infinity to avoid (0 * inf) for axis aligned rays.
+	return DirectX::XMFLOAT3(
+		vDirection.x != 0.0f ? 1.0f / vDirection.x : 1e30f,
+		vDirection.y != 0.0f ? 1.0f / vDirection.y : 1e30f,
+		vDirection.z != 0.0f ? 1.0f / vDirection.z : 1e30f);
+}
+
+void SBoundingVolumeHierarchy::traverseRay(const DirectX::XMFLOAT3& vExpand, const DirectX::XMFLOAT3& vOrigin, const DirectX::XMFLOAT3& vDirection,
+	float fMaxDistance, std::vector<uint32_t>& vOutProxies) const
+{
+	if (iRootNode == -1)
+	{
+		return;
+	}
+
+	const DirectX::XMFLOAT3 vInvDirection = getInvDirection(vDirection);
+
+	float fHitDistance = 0.0f;
+
+	std::vector<int32_t> vStack;
+	vStack.reserve(64);
+	vStack.push_back(iRootNode);
+
+	while (vStack.empty() == false)
+	{
+		const SBVHNode& node = vNodes[vStack.back()];
+		vStack.pop_back();
+
+		if (intersectsRay(node, vExpand, vOrigin, vInvDirection, fMaxDistance, fHitDistance) == false)
+		{
+			continue;
+		}
+
+		if (node.iProxy != -1)
+		{
+			vOutProxies.push_back(static_cast<uint32_t>(node.iProxy));
+		}
+		else
+		{
+			vStack.push_back(node.iLeft);
+			vStack.push_back(node.iRight);
+		}
+	}
+}
+
+int32_t SBoundingVolumeHierarchy::buildNode(std::vector<SBVHNode>& vItems, size_t iFirst, size_t iLast, int32_t iParent)
+{
+	const int32_t iNode = allocateNode();
+
+	if (iLast - iFirst == 1)
+	{
+		vNodes[iNode] = vItems[iFirst];
+		vNodes[iNode].iParent = iParent;
+
+		vProxyNodes[vItems[iFirst].iProxy] = iNode;
+
+		return iNode;
+	}
+
+
+	// Find bounds of the items and bounds of their centers.
+
+	SBVHNode bounds = vItems[iFirst];
+	DirectX::XMFLOAT3 vCenterMin(FLT_MAX, FLT_MAX, FLT_MAX);
+	DirectX::XMFLOAT3 vCenterMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for (size_t i = iFirst; i < iLast; i++)
+	{
+		setUnion(bounds, bounds, vItems[i]);
+
+		const DirectX::XMFLOAT3 vCenter((vItems[i].vMin.x + vItems[i].vMax.x) * 0.5f, (vItems[i].vMin.y + vItems[i].vMax.y) * 0.5f,
+			(vItems[i].vMin.z + vItems[i].vMax.z) * 0.5f);
+
+		vCenterMin = DirectX::XMFLOAT3(std::min(vCenterMin.x, vCenter.x), std::min(vCenterMin.y, vCenter.y), std::min(vCenterMin.z, vCenter.z));
+		vCenterMax = DirectX::XMFLOAT3(std::max(vCenterMax.x, vCenter.x), std::max(vCenterMax.y, vCenter.y), std::max(vCenterMax.z, vCenter.z));
+	}
+
+
+	// Split along the longest axis of the centers.
+
+	size_t iAxis = 0;
+	if (getAxis(vCenterMax, 1) - getAxis(vCenterMin, 1) > getAxis(vCenterMax, iAxis) - getAxis(vCenterMin, iAxis)) iAxis = 1;
+	if (getAxis(vCenterMax, 2) - getAxis(vCenterMin, 2) > getAxis(vCenterMax, iAxis) - getAxis(vCenterMin, iAxis)) iAxis = 2;
+
+	const float fCenterMin = getAxis(vCenterMin, iAxis);
+	const float fCenterExtent = getAxis(vCenterMax, iAxis) - fCenterMin;
+
+	size_t iMiddle = iFirst + (iLast - iFirst) / 2;
+
+	if (fCenterExtent > 0.0f)
+	{
+		// Binned SAH: put centers into bins and find the cheapest split between bins.
+
+		const size_t iBinCount = 16;
+
+		SBVHNode vBinBounds[iBinCount];
+		size_t   vBinItemCount[iBinCount] = { 0 };
+
+		auto getBin = [&](const SBVHNode& item) {
+			const float fCenter = (getAxis(item.vMin, iAxis) + getAxis(item.vMax, iAxis)) * 0.5f;
+			const size_t iBin = static_cast<size_t>((fCenter - fCenterMin) / fCenterExtent * iBinCount);
+
+			return std::min<size_t>(iBin, iBinCount - 1);
+		};
+
+		for (size_t i = iFirst; i < iLast; i++)
+		{
+			const size_t iBin = getBin(vItems[i]);
+
+			if (vBinItemCount[iBin] == 0)
+			{
+				vBinBounds[iBin] = vItems[i];
+			}
+			else
+			{
+				setUnion(vBinBounds[iBin], vBinBounds[iBin], vItems[i]);
+			}
+
+			vBinItemCount[iBin]++;
+		}
+
+		// Cost of the split after bin i = area(left) * count(left) + area(right) * count(right).
+
+		float  vLeftCost[iBinCount - 1];
+		SBVHNode leftBounds;
+		size_t iLeftCount = 0;
+
+		for (size_t i = 0; i < iBinCount - 1; i++)
+		{
+			if (vBinItemCount[i] > 0)
+			{
+				if (iLeftCount == 0) leftBounds = vBinBounds[i];
+				else setUnion(leftBounds, leftBounds, vBinBounds[i]);
+
+				iLeftCount += vBinItemCount[i];
+			}
+
+			vLeftCost[i] = iLeftCount > 0 ? getArea(leftBounds.vMin, leftBounds.vMax) * iLeftCount : 0.0f;
+		}
+
+		float  fBestCost = FLT_MAX;
+		size_t iBestSplit = 0;
+		SBVHNode rightBounds;
+		size_t iRightCount = 0;
+
+		for (size_t i = iBinCount - 1; i > 0; i--)
+		{
+			if (vBinItemCount[i] > 0)
+			{
+				if (iRightCount == 0) rightBounds = vBinBounds[i];
+				else setUnion(rightBounds, rightBounds, vBinBounds[i]);
+
+				iRightCount += vBinItemCount[i];
+			}
+
+			if (iRightCount == 0 || iRightCount == iLast - iFirst)
+			{
+				continue;
+			}
+
+			const float fCost = vLeftCost[i - 1] + getArea(rightBounds.vMin, rightBounds.vMax) * iRightCount;
+			if (fCost < fBestCost)
+			{
+				fBestCost = fCost;
+				iBestSplit = i;
+			}
+		}
+
+		if (fBestCost < FLT_MAX)
+		{
+			iMiddle = std::partition(vItems.begin() + iFirst, vItems.begin() + iLast,
+				[&](const SBVHNode& item) { return getBin(item) < iBestSplit; }) - vItems.begin();
+		}
+	}
+
+	if (iMiddle == iFirst || iMiddle == iLast)
+	{
+		// All centers are in the same place, split in half.
+		iMiddle = iFirst + (iLast - iFirst) / 2;
+	}
+
+
+	const int32_t iLeft  = buildNode(vItems, iFirst, iMiddle, iNode);
+	const int32_t iRight = buildNode(vItems, iMiddle, iLast, iNode);
+
+	// vNodes could be reallocated in recursive calls.
+	SBVHNode& node = vNodes[iNode];
+	node.vMin    = bounds.vMin;
+	node.vMax    = bounds.vMax;
+	node.iParent = iParent;
+	node.iLeft   = iLeft;
+	node.iRight  = iRight;
+	node.iProxy  = -1;
+
+	return iNode;
+}
+
+int32_t SBoundingVolumeHierarchy::allocateNode()
+{
+	if (vFreeNodes.empty() == false)
+	{
+		const int32_t iNode = vFreeNodes.back();
+		vFreeNodes.pop_back();
+
+		vNodes[iNode] = SBVHNode();
+
+		return iNode;
+	}
+
+	vNodes.push_back(SBVHNode());
+
+	return static_cast<int32_t>(vNodes.size() - 1);
+}
+
+void SBoundingVolumeHierarchy::freeNode(int32_t iNode)
+{
+	vFreeNodes.push_back(iNode);
+}
+
+void SBoundingVolumeHierarchy::insertLeaf(int32_t iLeaf)
+{
+	if (iRootNode == -1)
+	{
+		iRootNode = iLeaf;
+		vNodes[iLeaf].iParent = -1;
+
+		return;
+	}
+
+
+	// Go down the tree choosing the child that is cheaper to insert into (by the increase of the area).
+
+	int32_t iSibling = iRootNode;
+
+	while (vNodes[iSibling].iProxy == -1)
+	{
+		const SBVHNode& node = vNodes[iSibling];
+		const SBVHNode& leaf = vNodes[iLeaf];
+
+		const float fArea         = getArea(node.vMin, node.vMax);
+		const float fCombinedArea = getUnionArea(node, leaf);
+
+		// Cost of creating a new parent for this node and the leaf.
+		const float fNewParentCost = 2.0f * fCombinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree.
+		const float fInheritanceCost = 2.0f * (fCombinedArea - fArea);
+
+		float vChildCost[2];
+		const int32_t vChilds[2] = { node.iLeft, node.iRight };
+
+		for (size_t i = 0; i < 2; i++)
+		{
+			const SBVHNode& child = vNodes[vChilds[i]];
+
+			if (child.iProxy != -1)
+			{
+				vChildCost[i] = getUnionArea(child, leaf) + fInheritanceCost;
+			}
+			else
+			{
+				vChildCost[i] = getUnionArea(child, leaf) - getArea(child.vMin, child.vMax) + fInheritanceCost;
+			}
+		}
+
+		if (fNewParentCost < vChildCost[0] && fNewParentCost < vChildCost[1])
+		{
+			break;
+		}
+
+		iSibling = vChildCost[0] < vChildCost[1] ? vChilds[0] : vChilds[1];
+	}
+
+
+	// Create a new parent for the sibling and the leaf.
+
+	const int32_t iOldParent = vNodes[iSibling].iParent;
+	const int32_t iNewParent = allocateNode();
+
+	SBVHNode& newParent = vNodes[iNewParent];
+	newParent.iParent = iOldParent;
+	newParent.iLeft   = iSibling;
+	newParent.iRight  = iLeaf;
+	setUnion(newParent, vNodes[iSibling], vNodes[iLeaf]);
+
+	if (iOldParent == -1)
+	{
+		iRootNode = iNewParent;
+	}
+	else if (vNodes[iOldParent].iLeft == iSibling)
+	{
+		vNodes[iOldParent].iLeft = iNewParent;
+	}
+	else
+	{
+		vNodes[iOldParent].iRight = iNewParent;
+	}
+
+	vNodes[iSibling].iParent = iNewParent;
+	vNodes[iLeaf].iParent    = iNewParent;
+
+	refitAncestors(iOldParent);
+}
+
+void SBoundingVolumeHierarchy::removeLeaf(int32_t iLeaf)
+{
+	if (iLeaf == iRootNode)
+	{
+		iRootNode = -1;
+
+		return;
+	}
+
+	const int32_t iParent      = vNodes[iLeaf].iParent;
+	const int32_t iGrandParent = vNodes[iParent].iParent;
+	const int32_t iSibling     = vNodes[iParent].iLeft == iLeaf ? vNodes[iParent].iRight : vNodes[iParent].iLeft;
+
+	// Replace the parent with the sibling.
+
+	if (iGrandParent == -1)
+	{
+		iRootNode = iSibling;
+	}
+	else if (vNodes[iGrandParent].iLeft == iParent)
+	{
+		vNodes[iGrandParent].iLeft = iSibling;
+	}
+	else
+	{
+		vNodes[iGrandParent].iRight = iSibling;
+	}
+
+	vNodes[iSibling].iParent = iGrandParent;
+
+	freeNode(iParent);
+
+	refitAncestors(iGrandParent);
+}
+
+void SBoundingVolumeHierarchy::refitAncestors(int32_t iNode)
+{
+	while (iNode != -1)
+	{
+		SBVHNode& node = vNodes[iNode];
+
+		setUnion(node, vNodes[node.iLeft], vNodes[node.iRight]);
+
+		iNode = node.iParent;
+	}
+}
@@ -0,0 +1,201 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// DirectX
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+
+//@@Class
+/*
+Node of the SBoundingVolumeHierarchy, leaf nodes store exactly one proxy.
+*/
+struct SBVHNode
+{
+	DirectX::XMFLOAT3 vMin;
+	DirectX::XMFLOAT3 vMax;
+
+	int32_t iParent = -1;
+	int32_t iLeft   = -1; // -1 for leaf nodes
+	int32_t iRight  = -1;
+	int32_t iProxy  = -1; // -1 for internal nodes
+};
+
+
+//@@Class
+/*
+Dynamic AABB tree. Every box added to the tree is identified by a proxy ID that does not change
+until the proxy is removed (even if the tree is rebuilt).
+The tree can be built at once using the surface area heuristic (SAH) or changed incrementally:
+added proxies are inserted near the cheapest sibling and changed proxies only refit their ancestors,
+rebuildIfDegraded() rebuilds the tree when refitting made it too expensive to traverse.
+Not thread-safe: queries can be done from multiple threads only while the tree is not changed.
+*/
+class SBoundingVolumeHierarchy
+{
+public:
+	// Can be used by the owners of the proxies as "not in the tree" value.
+	static constexpr uint32_t iNoProxy = UINT32_MAX;
+
+	// Maximum number of rays in rayCastPacket().
+	static constexpr size_t iRayPacketSize = 4;
+
+	//@@Function
+	SBoundingVolumeHierarchy() = default;
+	SBoundingVolumeHierarchy(const SBoundingVolumeHierarchy&) = delete;
+	SBoundingVolumeHierarchy& operator= (const SBoundingVolumeHierarchy&) = delete;
+
+	//@@Function
+	/*
+	* desc: removes all proxies and builds the tree using the surface area heuristic.
+	* param "vBoxes": proxy ID of each box will be equal to its index in this array.
+	*/
+	void     build             (const std::vector<DirectX::BoundingBox>& vBoxes);
+	//@@Function
+	/*
+	* desc: rebuilds the tree from the current proxies using the surface area heuristic.
+	*/
+	void     rebuild           ();
+	//@@Function
+	/*
+	* desc: rebuilds the tree if it was changed a lot since the last build and became expensive to traverse.
+	* return: true if the tree was rebuilt, false otherwise.
+	*/
+	bool     rebuildIfDegraded ();
+
+	//@@Function
+	/*
+	* desc: inserts the box into the tree.
+	* return: proxy ID of the box.
+	*/
+	uint32_t addProxy          (const DirectX::BoundingBox& box);
+	//@@Function
+	/*
+	* desc: removes the proxy from the tree, the proxy ID can be returned by addProxy() later.
+	*/
+	void     removeProxy       (uint32_t iProxy);
+	//@@Function
+	/*
+	* desc: changes the box of the proxy and refits all nodes above it.
+	*/
+	void     updateProxy       (uint32_t iProxy, const DirectX::BoundingBox& box);
+
+
+	//@@Function
+	/*
+	* desc: appends IDs of the proxies which boxes are hit by the ray.
+	* param "vDirection": normalized direction of the ray.
+	* param "fMaxDistance": boxes that are farther than this distance along the ray are ignored.
+	* remarks: the order of the appended proxies is not specified.
+	*/
+	void     rayCast           (const DirectX::XMFLOAT3& vOrigin, const DirectX::XMFLOAT3& vDirection, float fMaxDistance,
+		std::vector<uint32_t>& vOutProxies) const;
+	//@@Function
+	/*
+	* desc: same as rayCast() but traverses the tree with up to iRayPacketSize rays at once (using SSE),
+	works best for rays that go in similar directions.
+	* param "iRayCount": number of rays in the arrays (not bigger than iRayPacketSize).
+	* param "pOutProxies": array of iRayCount vectors, proxies hit by each ray are appended to the vector of the ray.
+	* remarks: each ray gets the same proxies as rayCast() would return.
+	*/
+	void     rayCastPacket     (const DirectX::XMFLOAT3* pOrigins, const DirectX::XMFLOAT3* pDirections, const float* pMaxDistances,
+		size_t iRayCount, std::vector<uint32_t>* pOutProxies) const;
+	//@@Function
+	/*
+	* desc: appends IDs of the proxies which boxes intersect with the specified box.
+	*/
+	void     overlap           (const DirectX::BoundingBox& box, std::vector<uint32_t>& vOutProxies) const;
+	//@@Function
+	/*
+	* desc: appends IDs of the proxies which boxes are hit by the specified box moving along the direction.
+	* param "vDirection": normalized direction of the movement.
+	* param "fMaxDistance": length of the movement.
+	*/
+	void     sweep             (const DirectX::BoundingBox& box, const DirectX::XMFLOAT3& vDirection, float fMaxDistance,
+		std::vector<uint32_t>& vOutProxies) const;
+
+
+	//@@Function
+	/*
+	* desc: ray/box test.
+	* param "vDirection": normalized direction of the ray.
+	* param "fOutDistance": distance from the ray origin to the box (0 if the origin is inside of the box).
+	* return: true if the box is hit not farther than fMaxDistance, false otherwise.
+	*/
+	static bool getRayHitDistance (const DirectX::BoundingBox& box, const DirectX::XMFLOAT3& vOrigin, const DirectX::XMFLOAT3& vDirection,
+		float fMaxDistance, float& fOutDistance);
+
+
+	//@@Function
+	/*
+	* desc: returns the box of the proxy.
+	*/
+	DirectX::BoundingBox getProxyBox (uint32_t iProxy) const;
+	//@@Function
+	/*
+	* desc: returns the number of proxies in the tree.
+	*/
+	size_t   getProxyCount     () const;
+	//@@Function
+	/*
+	* desc: returns the surface area heuristic cost of the tree (sum of the internal node areas divided by the root area),
+	lower cost means faster queries.
+	*/
+	float    getCost           () const;
+
+private:
+
+	//@@Function
+	/*
+	* desc: ray/box slab test, where vInvDirection is (1 / vDirection), fOutDistance is the entry distance.
+	*/
+	static bool intersectsRay (const SBVHNode& node, const DirectX::XMFLOAT3& vExpand, const DirectX::XMFLOAT3& vOrigin,
+		const DirectX::XMFLOAT3& vInvDirection, float fMaxDistance, float& fOutDistance);
+	//@@Function
+	/*
+	* desc: returns 1 / vDirection (big values instead of the infinity).
+	*/
+	static DirectX::XMFLOAT3 getInvDirection (const DirectX::XMFLOAT3& vDirection);
+	//@@Function
+	/*
+	* desc: traverses the tree testing the ray against node boxes expanded by vExpand (used by rayCast() and sweep()).
+	*/
+	void    traverseRay       (const DirectX::XMFLOAT3& vExpand, const DirectX::XMFLOAT3& vOrigin, const DirectX::XMFLOAT3& vDirection,
+		float fMaxDistance, std::vector<uint32_t>& vOutProxies) const;
+
+	//@@Function
+	/*
+	* desc: recursively builds nodes for the items in range [iFirst, iLast).
+	* return: index of the created node.
+	*/
+	int32_t buildNode         (std::vector<SBVHNode>& vItems, size_t iFirst, size_t iLast, int32_t iParent);
+	int32_t allocateNode      ();
+	void    freeNode          (int32_t iNode);
+	void    insertLeaf        (int32_t iLeaf);
+	void    removeLeaf        (int32_t iLeaf);
+	void    refitAncestors    (int32_t iNode);
+
+
+	std::vector<SBVHNode> vNodes;
+	std::vector<int32_t>  vFreeNodes;
+	int32_t               iRootNode = -1;
+
+	// Leaf node of each proxy (-1 if the proxy ID is free).
+	std::vector<int32_t>  vProxyNodes;
+	std::vector<uint32_t> vFreeProxies;
+	size_t                iProxyCount = 0;
+
+	// Cost right after the last build (0 if the tree was never built).
+	float  fCostAfterBuild       = 0.0f;
+	size_t iChangesSinceLastCheck = 0;
+};
@@ -0,0 +1,102 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SCommandListPool.h"
+
+// Custom
+#include "SilentEngine/Private/SFrameResource/SFrameResource.h"
+#include "SilentEngine/Private/SError/SError.h"
+
+void SCommandListPool::init(ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue)
+{
+	this->pDevice = pDevice;
+	this->pCommandQueue = pCommandQueue;
+}
+
+bool SCommandListPool::beginFrame(SFrameResource* pFrameResource, size_t iCommandListCount)
+{
+	this->pFrameResource = pFrameResource;
+
+	if (pFrameResource->vRecordingThreadAllocators.size() == 0)
+	{
+		SError::showErrorMessageBoxAndLog("the frame resource has no recording thread allocators.");
+		return true;
+	}
+
+	for (size_t i = 0; i < pFrameResource->vRecordingThreadAllocators.size(); i++)
+	{
+		HRESULT hresult = pFrameResource->vRecordingThreadAllocators[i]->Reset();
+		if (FAILED(hresult))
+		{
+			SError::showErrorMessageBoxAndLog(hresult);
+			return true;
+		}
+	}
+
+	// Command lists are created here (not while recording) because the array can't grow while other threads use it.
+	while (vCommandLists.size() < iCommandListCount)
+	{
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> pCommandList;
+
+		HRESULT hresult = pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT,
+			pFrameResource->vRecordingThreadAllocators[0].Get(), nullptr, IID_PPV_ARGS(pCommandList.GetAddressOf()));
+		if (FAILED(hresult))
+		{
+			SError::showErrorMessageBoxAndLog(hresult);
+			return true;
+		}
+
+		// Will be reset in beginCommandList().
+		pCommandList->Close();
+
+		vCommandLists.push_back(pCommandList);
+	}
+
+	return false;
+}
+
+ID3D12GraphicsCommandList* SCommandListPool::getCommandList(size_t iCommandListIndex) const
+{
+	return vCommandLists[iCommandListIndex].Get();
+}
+
+bool SCommandListPool::beginCommandList(size_t iThreadIndex, size_t iCommandListIndex)
+{
+	// A command list can be reset right after it was submitted, but the allocator only when the GPU is done with it (see beginFrame()).
+	HRESULT hresult = vCommandLists[iCommandListIndex]->Reset(pFrameResource->vRecordingThreadAllocators[iThreadIndex].Get(), nullptr);
+	if (FAILED(hresult))
+	{
+		SError::showErrorMessageBoxAndLog(hresult);
+		return true;
+	}
+
+	return false;
+}
+
+bool SCommandListPool::endCommandList(size_t iThreadIndex, size_t iCommandListIndex)
+{
+	HRESULT hresult = vCommandLists[iCommandListIndex]->Close();
+	if (FAILED(hresult))
+	{
+		SError::showErrorMessageBoxAndLog(hresult);
+		return true;
+	}
+
+	return false;
+}
+
+void SCommandListPool::submitCommandLists(const std::vector<size_t>& vCommandListIndices)
+{
+	vCommandListsToExecute.clear();
+
+	for (size_t i = 0; i < vCommandListIndices.size(); i++)
+	{
+		vCommandListsToExecute.push_back(vCommandLists[vCommandListIndices[i]].Get());
+	}
+
+	pCommandQueue->ExecuteCommandLists(static_cast<UINT>(vCommandListsToExecute.size()), vCommandListsToExecute.data());
+}
@@ -0,0 +1,69 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// DirectX
+#include <wrl.h> // smart pointers
+#include <d3d12.h>
+
+// Custom
+#include "SilentEngine/Private/SRenderJobGraph/SRenderJobGraph.h"
+
+class SFrameResource;
+
+//@@Class
+/*
+The class owns the command lists of the render job graph, each job records to its own command list
+using the command allocator of the recording thread (stored in the current frame resource).
+*/
+class SCommandListPool : public SCommandListRecorder
+{
+public:
+	//@@Function
+	SCommandListPool() = default;
+	SCommandListPool(const SCommandListPool&) = delete;
+	SCommandListPool& operator= (const SCommandListPool&) = delete;
+	virtual ~SCommandListPool() override = default;
+
+	//@@Function
+	/*
+	* desc: sets the device (used to create command lists) and the command queue (used to submit command lists).
+	*/
+	void init (ID3D12Device* pDevice, ID3D12CommandQueue* pCommandQueue);
+
+	//@@Function
+	/*
+	* desc: resets the recording thread allocators of the frame resource and creates missing command lists.
+	* remarks: should only be called when the GPU is not using the frame resource.
+	* return: false if successful, true otherwise.
+	*/
+	bool beginFrame (SFrameResource* pFrameResource, size_t iCommandListCount);
+
+	//@@Function
+	/*
+	* desc: returns the command list (valid until the next beginFrame() call).
+	*/
+	ID3D12GraphicsCommandList* getCommandList (size_t iCommandListIndex) const;
+
+	virtual bool beginCommandList   (size_t iThreadIndex, size_t iCommandListIndex) override;
+	virtual bool endCommandList     (size_t iThreadIndex, size_t iCommandListIndex) override;
+	virtual void submitCommandLists (const std::vector<size_t>& vCommandListIndices) override;
+
+private:
+
+	std::vector<Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>> vCommandLists;
+
+	std::vector<ID3D12CommandList*> vCommandListsToExecute;
+
+	ID3D12Device*       pDevice        = nullptr;
+	ID3D12CommandQueue* pCommandQueue  = nullptr;
+	SFrameResource*     pFrameResource = nullptr;
+};
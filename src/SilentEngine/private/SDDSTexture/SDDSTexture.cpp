@@ -0,0 +1,437 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SDDSTexture.h"
+
+// STL
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+
+// Layout of the .dds headers (offsets from the start of the file).
+static constexpr size_t   iDDSMagicSize                = 4;
+static constexpr size_t   iDDSHeaderSize               = 124;
+static constexpr size_t   iDDSHeaderDX10Size           = 20;
+
+static constexpr size_t   iDDSFlagsOffset              = 8;
+static constexpr size_t   iDDSHeightOffset             = 12;
+static constexpr size_t   iDDSWidthOffset              = 16;
+static constexpr size_t   iDDSDepthOffset              = 24;
+static constexpr size_t   iDDSMipCountOffset           = 28;
+static constexpr size_t   iDDSPixelFormatFlagsOffset   = 80;
+static constexpr size_t   iDDSFourCCOffset             = 84;
+static constexpr size_t   iDDSRGBBitCountOffset        = 88;
+static constexpr size_t   iDDSRBitMaskOffset           = 92;
+static constexpr size_t   iDDSGBitMaskOffset           = 96;
+static constexpr size_t   iDDSBBitMaskOffset           = 100;
+static constexpr size_t   iDDSABitMaskOffset           = 104;
+static constexpr size_t   iDDSCaps2Offset              = 112;
+
+static constexpr size_t   iDX10FormatOffset            = iDDSMagicSize + iDDSHeaderSize;
+static constexpr size_t   iDX10DimensionOffset         = iDX10FormatOffset + 4;
+static constexpr size_t   iDX10MiscFlagOffset          = iDX10FormatOffset + 8;
+static constexpr size_t   iDX10ArraySizeOffset         = iDX10FormatOffset + 12;
+
+static constexpr uint32_t iDDSFlagMipCount             = 0x20000;
+static constexpr uint32_t iDDSFlagDepth                = 0x800000;
+static constexpr uint32_t iDDSPixelFormatFourCC        = 0x4;
+static constexpr uint32_t iDDSPixelFormatRGB           = 0x40;
+static constexpr uint32_t iDDSCaps2CubeMap             = 0x200;
+static constexpr uint32_t iDDSCaps2CubeMapAllFaces     = 0xFC00;
+static constexpr uint32_t iDDSCaps2Volume              = 0x200000;
+static constexpr uint32_t iDX10DimensionTexture3D      = 4;
+static constexpr uint32_t iDX10MiscTextureCube         = 0x4;
+
+// Limits of the D3D12 textures.
+static constexpr size_t   iMaxTextureDimension         = 16384;
+static constexpr size_t   iMaxTextureArraySize         = 2048;
+
+
+static uint32_t readUInt32(const unsigned char* pData, size_t iOffset)
+{
+	uint32_t iValue = 0;
+	std::memcpy(&iValue, pData + iOffset, sizeof(iValue));
+
+	return iValue;
+}
+
+static constexpr uint32_t makeFourCC(char c0, char c1, char c2, char c3)
+{
+	return static_cast<uint32_t>(static_cast<unsigned char>(c0))
+		| (static_cast<uint32_t>(static_cast<unsigned char>(c1)) << 8)
+		| (static_cast<uint32_t>(static_cast<unsigned char>(c2)) << 16)
+		| (static_cast<uint32_t>(static_cast<unsigned char>(c3)) << 24);
+}
+
+static SDDSFormat getLegacyFormat(const unsigned char* pData)
+{
+	uint32_t iFlags = readUInt32(pData, iDDSPixelFormatFlagsOffset);
+
+	if (iFlags & iDDSPixelFormatFourCC)
+	{
+		uint32_t iFourCC = readUInt32(pData, iDDSFourCCOffset);
+
+		if (iFourCC == makeFourCC('D', 'X', 'T', '1'))                                                   return SDDSFormat::SDF_BC1_UNORM;
+		if (iFourCC == makeFourCC('D', 'X', 'T', '2') || iFourCC == makeFourCC('D', 'X', 'T', '3'))      return SDDSFormat::SDF_BC2_UNORM;
+		if (iFourCC == makeFourCC('D', 'X', 'T', '4') || iFourCC == makeFourCC('D', 'X', 'T', '5'))      return SDDSFormat::SDF_BC3_UNORM;
+		if (iFourCC == makeFourCC('A', 'T', 'I', '1') || iFourCC == makeFourCC('B', 'C', '4', 'U'))      return SDDSFormat::SDF_BC4_UNORM;
+		if (iFourCC == makeFourCC('B', 'C', '4', 'S'))                                                   return SDDSFormat::SDF_BC4_SNORM;
+		if (iFourCC == makeFourCC('A', 'T', 'I', '2') || iFourCC == makeFourCC('B', 'C', '5', 'U'))      return SDDSFormat::SDF_BC5_UNORM;
+		if (iFourCC == makeFourCC('B', 'C', '5', 'S'))                                                   return SDDSFormat::SDF_BC5_SNORM;
+
+		return SDDSFormat::SDF_UNKNOWN;
+	}
+
+	if ((iFlags & iDDSPixelFormatRGB) && readUInt32(pData, iDDSRGBBitCountOffset) == 32)
+	{
+		uint32_t iR = readUInt32(pData, iDDSRBitMaskOffset);
+		uint32_t iG = readUInt32(pData, iDDSGBitMaskOffset);
+		uint32_t iB = readUInt32(pData, iDDSBBitMaskOffset);
+		uint32_t iA = readUInt32(pData, iDDSABitMaskOffset);
+
+		if (iR == 0x000000FF && iG == 0x0000FF00 && iB == 0x00FF0000 && iA == 0xFF000000) return SDDSFormat::SDF_R8G8B8A8_UNORM;
+		if (iR == 0x00FF0000 && iG == 0x0000FF00 && iB == 0x000000FF && iA == 0xFF000000) return SDDSFormat::SDF_B8G8R8A8_UNORM;
+		if (iR == 0x00FF0000 && iG == 0x0000FF00 && iB == 0x000000FF && iA == 0)          return SDDSFormat::SDF_B8G8R8X8_UNORM;
+	}
+
+	return SDDSFormat::SDF_UNKNOWN;
+}
+
+bool SDDSTexture::readDesc(const std::wstring& sPathToFile, SDDSTextureDesc& outDesc)
+{
+	std::ifstream file(std::filesystem::path(sPathToFile), std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return true;
+	}
+
+	unsigned char vHeader[iDDSMagicSize + iDDSHeaderSize + iDDSHeaderDX10Size] = {};
+
+	file.read(reinterpret_cast<char*>(vHeader), sizeof(vHeader));
+
+	size_t iHeaderSize = 0;
+
+	return parseHeader(vHeader, static_cast<size_t>(file.gcount()), outDesc, iHeaderSize);
+}
+
+bool SDDSTexture::parseHeader(const void* pData, size_t iDataSize, SDDSTextureDesc& outDesc, size_t& iOutHeaderSize)
+{
+	const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+	if (iDataSize < iDDSMagicSize + iDDSHeaderSize || readUInt32(pBytes, 0) != makeFourCC('D', 'D', 'S', ' ')
+		|| readUInt32(pBytes, iDDSMagicSize) != iDDSHeaderSize)
+	{
+		return true;
+	}
+
+	SDDSTextureDesc desc;
+
+	uint32_t iFlags = readUInt32(pBytes, iDDSFlagsOffset);
+	uint32_t iCaps2 = readUInt32(pBytes, iDDSCaps2Offset);
+
+	desc.iWidth  = readUInt32(pBytes, iDDSWidthOffset);
+	desc.iHeight = readUInt32(pBytes, iDDSHeightOffset);
+
+	if (iFlags & iDDSFlagMipCount)
+	{
+		desc.iMipCount = readUInt32(pBytes, iDDSMipCountOffset);
+	}
+
+	if (desc.iMipCount == 0)
+	{
+		desc.iMipCount = 1;
+	}
+
+	iOutHeaderSize = iDDSMagicSize + iDDSHeaderSize;
+
+	if ((readUInt32(pBytes, iDDSPixelFormatFlagsOffset) & iDDSPixelFormatFourCC)
+		&& readUInt32(pBytes, iDDSFourCCOffset) == makeFourCC('D', 'X', '1', '0'))
+	{
+		if (iDataSize < iDDSMagicSize + iDDSHeaderSize + iDDSHeaderDX10Size)
+		{
+			return true;
+		}
+
+		iOutHeaderSize += iDDSHeaderDX10Size;
+
+		desc.format     = static_cast<SDDSFormat>(readUInt32(pBytes, iDX10FormatOffset));
+		desc.iArraySize = readUInt32(pBytes, iDX10ArraySizeOffset);
+
+		if (readUInt32(pBytes, iDX10DimensionOffset) == iDX10DimensionTexture3D)
+		{
+			desc.iDepth = readUInt32(pBytes, iDDSDepthOffset);
+		}
+		else if (readUInt32(pBytes, iDX10MiscFlagOffset) & iDX10MiscTextureCube)
+		{
+			desc.bIsCubeMap  = true;
+			desc.iArraySize *= 6;
+		}
+	}
+	else
+	{
+		desc.format = getLegacyFormat(pBytes);
+
+		if ((iCaps2 & iDDSCaps2Volume) && (iFlags & iDDSFlagDepth))
+		{
+			desc.iDepth = readUInt32(pBytes, iDDSDepthOffset);
+		}
+		else if (iCaps2 & iDDSCaps2CubeMap)
+		{
+			if ((iCaps2 & iDDSCaps2CubeMapAllFaces) != iDDSCaps2CubeMapAllFaces)
+			{
+				// Partial cube maps are not supported.
+				return true;
+			}
+
+			desc.bIsCubeMap = true;
+			desc.iArraySize = 6;
+		}
+	}
+
+	if (desc.iWidth == 0 || desc.iHeight == 0 || desc.iDepth == 0 || desc.iArraySize == 0)
+	{
+		return true;
+	}
+
+	if (getFormatBlockInfo(desc.format, desc.iBlockSize, desc.iBytesPerBlock))
+	{
+		return true;
+	}
+
+	outDesc = desc;
+
+	return false;
+}
+
+bool SDDSTexture::parseLayout(const void* pData, size_t iDataSize, SDDSTextureDesc& outDesc, size_t& iOutHeaderSize,
+	std::vector<SDDSMipRegion>& vOutRegions)
+{
+	vOutRegions.clear();
+
+	if (parseHeader(pData, iDataSize, outDesc, iOutHeaderSize))
+	{
+		return true;
+	}
+
+	if (outDesc.iWidth > iMaxTextureDimension || outDesc.iHeight > iMaxTextureDimension || outDesc.iDepth > iMaxTextureDimension
+		|| outDesc.iArraySize > iMaxTextureArraySize)
+	{
+		// Corrupted header (also keeps the size calculations below from overflowing).
+		return true;
+	}
+
+	// Mip chain can't be longer than the number of times the biggest dimension can be halved.
+	size_t iMaxDimension = std::max(std::max(outDesc.iWidth, outDesc.iHeight), outDesc.iDepth);
+	size_t iMaxMipCount = 1;
+	while (iMaxDimension > 1)
+	{
+		iMaxDimension >>= 1;
+		iMaxMipCount++;
+	}
+
+	if (outDesc.iMipCount > iMaxMipCount)
+	{
+		return true;
+	}
+
+	getMipRange(outDesc, 0, outDesc.iMipCount, vOutRegions);
+
+	const SDDSMipRegion& lastRegion = vOutRegions.back();
+
+	if (iDataSize - iOutHeaderSize < lastRegion.iOffset + lastRegion.iSizeInBytes)
+	{
+		// Truncated file.
+		vOutRegions.clear();
+
+		return true;
+	}
+
+	return false;
+}
+
+bool SDDSTexture::getFormatBlockInfo(SDDSFormat format, size_t& iOutBlockSize, size_t& iOutBytesPerBlock)
+{
+	iOutBlockSize = 1;
+
+	switch (format)
+	{
+	case SDDSFormat::SDF_BC1_TYPELESS:
+	case SDDSFormat::SDF_BC1_UNORM:
+	case SDDSFormat::SDF_BC1_UNORM_SRGB:
+	case SDDSFormat::SDF_BC4_TYPELESS:
+	case SDDSFormat::SDF_BC4_UNORM:
+	case SDDSFormat::SDF_BC4_SNORM:
+		iOutBlockSize = 4;
+		iOutBytesPerBlock = 8;
+		return false;
+
+	case SDDSFormat::SDF_BC2_TYPELESS:
+	case SDDSFormat::SDF_BC2_UNORM:
+	case SDDSFormat::SDF_BC2_UNORM_SRGB:
+	case SDDSFormat::SDF_BC3_TYPELESS:
+	case SDDSFormat::SDF_BC3_UNORM:
+	case SDDSFormat::SDF_BC3_UNORM_SRGB:
+	case SDDSFormat::SDF_BC5_TYPELESS:
+	case SDDSFormat::SDF_BC5_UNORM:
+	case SDDSFormat::SDF_BC5_SNORM:
+	case SDDSFormat::SDF_BC6H_TYPELESS:
+	case SDDSFormat::SDF_BC6H_UF16:
+	case SDDSFormat::SDF_BC6H_SF16:
+	case SDDSFormat::SDF_BC7_TYPELESS:
+	case SDDSFormat::SDF_BC7_UNORM:
+	case SDDSFormat::SDF_BC7_UNORM_SRGB:
+		iOutBlockSize = 4;
+		iOutBytesPerBlock = 16;
+		return false;
+
+	case SDDSFormat::SDF_R32G32B32A32_TYPELESS:
+	case SDDSFormat::SDF_R32G32B32A32_FLOAT:
+	case SDDSFormat::SDF_R32G32B32A32_UINT:
+	case SDDSFormat::SDF_R32G32B32A32_SINT:
+		iOutBytesPerBlock = 16;
+		return false;
+
+	case SDDSFormat::SDF_R16G16B16A16_TYPELESS:
+	case SDDSFormat::SDF_R16G16B16A16_FLOAT:
+	case SDDSFormat::SDF_R16G16B16A16_UNORM:
+	case SDDSFormat::SDF_R16G16B16A16_UINT:
+	case SDDSFormat::SDF_R16G16B16A16_SNORM:
+	case SDDSFormat::SDF_R16G16B16A16_SINT:
+	case SDDSFormat::SDF_R32G32_TYPELESS:
+	case SDDSFormat::SDF_R32G32_FLOAT:
+	case SDDSFormat::SDF_R32G32_UINT:
+	case SDDSFormat::SDF_R32G32_SINT:
+		iOutBytesPerBlock = 8;
+		return false;
+
+	case SDDSFormat::SDF_R10G10B10A2_TYPELESS:
+	case SDDSFormat::SDF_R10G10B10A2_UNORM:
+	case SDDSFormat::SDF_R10G10B10A2_UINT:
+	case SDDSFormat::SDF_R11G11B10_FLOAT:
+	case SDDSFormat::SDF_R8G8B8A8_TYPELESS:
+	case SDDSFormat::SDF_R8G8B8A8_UNORM:
+	case SDDSFormat::SDF_R8G8B8A8_UNORM_SRGB:
+	case SDDSFormat::SDF_R8G8B8A8_UINT:
+	case SDDSFormat::SDF_R8G8B8A8_SNORM:
+	case SDDSFormat::SDF_R8G8B8A8_SINT:
+	case SDDSFormat::SDF_B8G8R8A8_TYPELESS:
+	case SDDSFormat::SDF_B8G8R8A8_UNORM:
+	case SDDSFormat::SDF_B8G8R8A8_UNORM_SRGB:
+	case SDDSFormat::SDF_B8G8R8X8_TYPELESS:
+	case SDDSFormat::SDF_B8G8R8X8_UNORM:
+	case SDDSFormat::SDF_B8G8R8X8_UNORM_SRGB:
+	case SDDSFormat::SDF_R16G16_TYPELESS:
+	case SDDSFormat::SDF_R16G16_FLOAT:
+	case SDDSFormat::SDF_R16G16_UNORM:
+	case SDDSFormat::SDF_R16G16_UINT:
+	case SDDSFormat::SDF_R16G16_SNORM:
+	case SDDSFormat::SDF_R16G16_SINT:
+	case SDDSFormat::SDF_R32_TYPELESS:
+	case SDDSFormat::SDF_R32_FLOAT:
+	case SDDSFormat::SDF_R32_UINT:
+	case SDDSFormat::SDF_R32_SINT:
+		iOutBytesPerBlock = 4;
+		return false;
+
+	case SDDSFormat::SDF_R8G8_TYPELESS:
+	case SDDSFormat::SDF_R8G8_UNORM:
+	case SDDSFormat::SDF_R8G8_UINT:
+	case SDDSFormat::SDF_R8G8_SNORM:
+	case SDDSFormat::SDF_R8G8_SINT:
+	case SDDSFormat::SDF_R16_TYPELESS:
+	case SDDSFormat::SDF_R16_FLOAT:
+	case SDDSFormat::SDF_R16_UNORM:
+	case SDDSFormat::SDF_R16_UINT:
+	case SDDSFormat::SDF_R16_SNORM:
+	case SDDSFormat::SDF_R16_SINT:
+		iOutBytesPerBlock = 2;
+		return false;
+
+	case SDDSFormat::SDF_R8_TYPELESS:
+	case SDDSFormat::SDF_R8_UNORM:
+	case SDDSFormat::SDF_R8_UINT:
+	case SDDSFormat::SDF_R8_SNORM:
+	case SDDSFormat::SDF_R8_SINT:
+	case SDDSFormat::SDF_A8_UNORM:
+		iOutBytesPerBlock = 1;
+		return false;
+
+	default:
+		return true;
+	}
+}
+
+size_t SDDSTexture::getMipDimension(size_t iSize, size_t iMip)
+{
+	size_t iMipSize = iSize >> iMip;
+
+	return iMipSize == 0 ? 1 : iMipSize;
+}
+
+size_t SDDSTexture::getMipSizeInBytes(const SDDSTextureDesc& desc, size_t iMip)
+{
+	size_t iWidthInBlocks  = (getMipDimension(desc.iWidth, iMip) + desc.iBlockSize - 1) / desc.iBlockSize;
+	size_t iHeightInBlocks = (getMipDimension(desc.iHeight, iMip) + desc.iBlockSize - 1) / desc.iBlockSize;
+
+	return iWidthInBlocks * desc.iBytesPerBlock * iHeightInBlocks * getMipDimension(desc.iDepth, iMip) * desc.iArraySize;
+}
+
+void SDDSTexture::getMipRange(const SDDSTextureDesc& desc, size_t iFirstMip, size_t iLastMip, std::vector<SDDSMipRegion>& vOutRegions)
+{
+	size_t iOffset = 0;
+
+	for (size_t iArrayIndex = 0; iArrayIndex < desc.iArraySize; iArrayIndex++)
+	{
+		for (size_t iMip = 0; iMip < desc.iMipCount; iMip++)
+		{
+			SDDSMipRegion region;
+			region.iArrayIndex  = iArrayIndex;
+			region.iMip         = iMip;
+			region.iWidth       = getMipDimension(desc.iWidth, iMip);
+			region.iHeight      = getMipDimension(desc.iHeight, iMip);
+			region.iRowPitch    = (region.iWidth + desc.iBlockSize - 1) / desc.iBlockSize * desc.iBytesPerBlock;
+			region.iRowCount    = (region.iHeight + desc.iBlockSize - 1) / desc.iBlockSize;
+			region.iOffset      = iOffset;
+			region.iSizeInBytes = region.iRowPitch * region.iRowCount * getMipDimension(desc.iDepth, iMip);
+
+			iOffset += region.iSizeInBytes;
+
+			if (iMip >= iFirstMip && iMip < iLastMip)
+			{
+				vOutRegions.push_back(region);
+			}
+		}
+	}
+}
+
+size_t SDDSTexture::getDataSizeInBytes(const SDDSTextureDesc& desc)
+{
+	size_t iSize = 0;
+
+	for (size_t iMip = 0; iMip < desc.iMipCount; iMip++)
+	{
+		iSize += getMipSizeInBytes(desc, iMip);
+	}
+
+	return iSize;
+}
+
+size_t SDDSTexture::getFirstMipNotBiggerThan(const SDDSTextureDesc& desc, size_t iMaxSize)
+{
+	for (size_t iMip = 0; iMip < desc.iMipCount; iMip++)
+	{
+		if (getMipDimension(desc.iWidth, iMip) <= iMaxSize && getMipDimension(desc.iHeight, iMip) <= iMaxSize)
+		{
+			return iMip;
+		}
+	}
+
+	return desc.iMipCount - 1;
+}
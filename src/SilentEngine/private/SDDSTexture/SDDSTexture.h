@@ -0,0 +1,209 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+//@@Class
+/*
+Pixel formats of the textures stored in .dds files (only the formats that can be loaded).
+Values are the same as in DXGI_FORMAT so that the format of the DX10 header can be used as is.
+*/
+enum class SDDSFormat : uint32_t
+{
+	SDF_UNKNOWN               = 0,
+	SDF_R32G32B32A32_TYPELESS = 1,
+	SDF_R32G32B32A32_FLOAT    = 2,
+	SDF_R32G32B32A32_UINT     = 3,
+	SDF_R32G32B32A32_SINT     = 4,
+	SDF_R16G16B16A16_TYPELESS = 9,
+	SDF_R16G16B16A16_FLOAT    = 10,
+	SDF_R16G16B16A16_UNORM    = 11,
+	SDF_R16G16B16A16_UINT     = 12,
+	SDF_R16G16B16A16_SNORM    = 13,
+	SDF_R16G16B16A16_SINT     = 14,
+	SDF_R32G32_TYPELESS       = 15,
+	SDF_R32G32_FLOAT          = 16,
+	SDF_R32G32_UINT           = 17,
+	SDF_R32G32_SINT           = 18,
+	SDF_R10G10B10A2_TYPELESS  = 23,
+	SDF_R10G10B10A2_UNORM     = 24,
+	SDF_R10G10B10A2_UINT      = 25,
+	SDF_R11G11B10_FLOAT       = 26,
+	SDF_R8G8B8A8_TYPELESS     = 27,
+	SDF_R8G8B8A8_UNORM        = 28,
+	SDF_R8G8B8A8_UNORM_SRGB   = 29,
+	SDF_R8G8B8A8_UINT         = 30,
+	SDF_R8G8B8A8_SNORM        = 31,
+	SDF_R8G8B8A8_SINT         = 32,
+	SDF_R16G16_TYPELESS       = 33,
+	SDF_R16G16_FLOAT          = 34,
+	SDF_R16G16_UNORM          = 35,
+	SDF_R16G16_UINT           = 36,
+	SDF_R16G16_SNORM          = 37,
+	SDF_R16G16_SINT           = 38,
+	SDF_R32_TYPELESS          = 39,
+	SDF_R32_FLOAT             = 41,
+	SDF_R32_UINT              = 42,
+	SDF_R32_SINT              = 43,
+	SDF_R8G8_TYPELESS         = 48,
+	SDF_R8G8_UNORM            = 49,
+	SDF_R8G8_UINT             = 50,
+	SDF_R8G8_SNORM            = 51,
+	SDF_R8G8_SINT             = 52,
+	SDF_R16_TYPELESS          = 53,
+	SDF_R16_FLOAT             = 54,
+	SDF_R16_UNORM             = 56,
+	SDF_R16_UINT              = 57,
+	SDF_R16_SNORM             = 58,
+	SDF_R16_SINT              = 59,
+	SDF_R8_TYPELESS           = 60,
+	SDF_R8_UNORM              = 61,
+	SDF_R8_UINT               = 62,
+	SDF_R8_SNORM              = 63,
+	SDF_R8_SINT               = 64,
+	SDF_A8_UNORM              = 65,
+	SDF_BC1_TYPELESS          = 70,
+	SDF_BC1_UNORM             = 71,
+	SDF_BC1_UNORM_SRGB        = 72,
+	SDF_BC2_TYPELESS          = 73,
+	SDF_BC2_UNORM             = 74,
+	SDF_BC2_UNORM_SRGB        = 75,
+	SDF_BC3_TYPELESS          = 76,
+	SDF_BC3_UNORM             = 77,
+	SDF_BC3_UNORM_SRGB        = 78,
+	SDF_BC4_TYPELESS          = 79,
+	SDF_BC4_UNORM             = 80,
+	SDF_BC4_SNORM             = 81,
+	SDF_BC5_TYPELESS          = 82,
+	SDF_BC5_UNORM             = 83,
+	SDF_BC5_SNORM             = 84,
+	SDF_B8G8R8A8_UNORM        = 87,
+	SDF_B8G8R8X8_UNORM        = 88,
+	SDF_B8G8R8A8_TYPELESS     = 90,
+	SDF_B8G8R8A8_UNORM_SRGB   = 91,
+	SDF_B8G8R8X8_TYPELESS     = 92,
+	SDF_B8G8R8X8_UNORM_SRGB   = 93,
+	SDF_BC6H_TYPELESS         = 94,
+	SDF_BC6H_UF16             = 95,
+	SDF_BC6H_SF16             = 96,
+	SDF_BC7_TYPELESS          = 97,
+	SDF_BC7_UNORM             = 98,
+	SDF_BC7_UNORM_SRGB        = 99,
+};
+
+
+//@@Class
+/*
+Description of the texture stored in a .dds file.
+*/
+struct SDDSTextureDesc
+{
+	size_t iWidth     = 0;
+	size_t iHeight    = 0;
+	size_t iDepth     = 1; // bigger than 1 only for volume textures
+	size_t iMipCount  = 1;
+	size_t iArraySize = 1; // 6 for cube maps
+
+	bool   bIsCubeMap = false;
+
+	SDDSFormat format = SDDSFormat::SDF_UNKNOWN;
+
+	size_t iBlockSize     = 1; // 4 for block compressed formats
+	size_t iBytesPerBlock = 0; // bytes per pixel for not compressed formats
+};
+
+
+//@@Class
+/*
+Location of one mip of one array slice in the pixel data of a .dds file.
+*/
+struct SDDSMipRegion
+{
+	size_t iArrayIndex  = 0;
+	size_t iMip         = 0;
+
+	size_t iWidth       = 0;
+	size_t iHeight      = 0;
+	size_t iRowPitch    = 0; // in bytes, one row of blocks for block compressed formats
+	size_t iRowCount    = 0; // rows of blocks for block compressed formats
+
+	size_t iOffset      = 0; // from the start of the pixel data (right after the header)
+	size_t iSizeInBytes = 0;
+};
+
+
+//@@Class
+/*
+The class reads .dds headers and calculates where each mip is stored in the file
+so that only a range of mips can be read/uploaded.
+*/
+class SDDSTexture
+{
+public:
+	//@@Function
+	/*
+	* desc: reads the header of the .dds file.
+	* return: false if successful, true otherwise.
+	*/
+	static bool   readDesc          (const std::wstring& sPathToFile, SDDSTextureDesc& outDesc);
+	//@@Function
+	/*
+	* desc: parses the header of the .dds file data (starting with the "DDS " magic).
+	* param "iOutHeaderSize": size of the magic and the headers, pixel data starts at this offset.
+	* return: false if successful, true otherwise (not a .dds file or the format is not supported).
+	*/
+	static bool   parseHeader       (const void* pData, size_t iDataSize, SDDSTextureDesc& outDesc, size_t& iOutHeaderSize);
+	//@@Function
+	/*
+	* desc: parses the header of the whole .dds file data and returns where each mip of each array slice is stored (nothing is copied).
+	* param "iOutHeaderSize": size of the magic and the headers, region offsets are relative to this offset.
+	* param "vOutRegions": cleared and filled with the regions of all mips of all array slices (in the order they are stored in the file).
+	* return: false if successful, true otherwise (not a .dds file, the format is not supported or the file is truncated).
+	* remarks: can be used with a memory mapped file to point the subresources straight into the mapping.
+	*/
+	static bool   parseLayout       (const void* pData, size_t iDataSize, SDDSTextureDesc& outDesc, size_t& iOutHeaderSize,
+		std::vector<SDDSMipRegion>& vOutRegions);
+	//@@Function
+	/*
+	* desc: returns the size of the block in pixels (1 for not compressed formats) and the size of one block (or pixel) in bytes.
+	* return: false if successful, true if the format is not supported.
+	*/
+	static bool   getFormatBlockInfo(SDDSFormat format, size_t& iOutBlockSize, size_t& iOutBytesPerBlock);
+
+	//@@Function
+	/*
+	* desc: returns the size of the texture dimension on the specified mip.
+	*/
+	static size_t getMipDimension   (size_t iSize, size_t iMip);
+	//@@Function
+	/*
+	* desc: returns the size of the mip in bytes (including all array slices).
+	*/
+	static size_t getMipSizeInBytes (const SDDSTextureDesc& desc, size_t iMip);
+	//@@Function
+	/*
+	* desc: appends regions of the mips in range [iFirstMip, iLastMip) of all array slices (in the order they are stored in the file).
+	*/
+	static void   getMipRange       (const SDDSTextureDesc& desc, size_t iFirstMip, size_t iLastMip, std::vector<SDDSMipRegion>& vOutRegions);
+	//@@Function
+	/*
+	* desc: returns the size of the pixel data of all mips and array slices.
+	*/
+	static size_t getDataSizeInBytes(const SDDSTextureDesc& desc);
+	//@@Function
+	/*
+	* desc: returns the most detailed mip which width and height are not bigger than iMaxSize
+	(returns the last mip if there is no such mip).
+	*/
+	static size_t getFirstMipNotBiggerThan(const SDDSTextureDesc& desc, size_t iMaxSize);
+};
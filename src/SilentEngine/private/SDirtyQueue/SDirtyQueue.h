@@ -0,0 +1,139 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <atomic>
+
+
+//@@Class
+/*
+Intrusive data that an object needs to have (as a member named "dirtyQueueNode") to be pushed to the SDirtyQueue.
+*/
+template<typename T>
+struct SDirtyQueueNode
+{
+	// True while the object is pushed or stored in the dirty items.
+	std::atomic<bool> bQueued{ false };
+
+	T*     pNextPushed     = nullptr;
+	size_t iDirtyItemIndex = 0;
+};
+
+
+//@@Class
+/*
+The class stores objects that need to update their GPU data (constant buffers) so that the per-frame code
+only touches the changed objects instead of scanning all objects.
+Any thread can push objects (lock-free), only one thread at a time (that holds the owner's mutex, for example, SApplication::mtxDraw)
+can collect and remove them.
+An object stays in the dirty items until it's removed by the consumer (usually after all frame resources were updated).
+*/
+template<typename T>
+class SDirtyQueue
+{
+public:
+	//@@Function
+	SDirtyQueue() = default;
+	SDirtyQueue(const SDirtyQueue&) = delete;
+	SDirtyQueue& operator= (const SDirtyQueue&) = delete;
+
+	//@@Function
+	/*
+	* desc: adds the object to the queue, does nothing if the object is already in the queue.
+	* remarks: thread-safe, lock-free.
+	*/
+	void push(T* pItem)
+	{
+		if (pItem->dirtyQueueNode.bQueued.exchange(true, std::memory_order_acq_rel))
+		{
+			return;
+		}
+
+		T* pHead = pPushedHead.load(std::memory_order_relaxed);
+
+		do
+		{
+			pItem->dirtyQueueNode.pNextPushed = pHead;
+		} while (pPushedHead.compare_exchange_weak(pHead, pItem, std::memory_order_release, std::memory_order_relaxed) == false);
+	}
+
+	//@@Function
+	/*
+	* desc: moves all pushed objects to the dirty items and returns the dirty items.
+	* remarks: should only be called by the consumer.
+	*/
+	const std::vector<T*>& collectDirtyItems()
+	{
+		T* pItem = pPushedHead.exchange(nullptr, std::memory_order_acquire);
+
+		while (pItem)
+		{
+			T* pNext = pItem->dirtyQueueNode.pNextPushed;
+
+			pItem->dirtyQueueNode.pNextPushed     = nullptr;
+			pItem->dirtyQueueNode.iDirtyItemIndex = vDirtyItems.size();
+
+			vDirtyItems.push_back(pItem);
+
+			pItem = pNext;
+		}
+
+		return vDirtyItems;
+	}
+
+	//@@Function
+	/*
+	* desc: removes the dirty item (swaps with the last item), after this the object can be pushed again.
+	* remarks: should only be called by the consumer.
+	*/
+	void removeDirtyItem(size_t iIndex)
+	{
+		T* pItem = vDirtyItems[iIndex];
+
+		vDirtyItems[iIndex] = vDirtyItems.back();
+		vDirtyItems[iIndex]->dirtyQueueNode.iDirtyItemIndex = iIndex;
+		vDirtyItems.pop_back();
+
+		pItem->dirtyQueueNode.bQueued.store(false, std::memory_order_release);
+	}
+
+	//@@Function
+	/*
+	* desc: removes the object from the queue (if it was pushed).
+	* remarks: should only be called by the consumer, for example, before the object is deleted.
+	The object should not be pushed again from other threads while this function is running.
+	*/
+	void remove(T* pItem)
+	{
+		if (pItem->dirtyQueueNode.bQueued.load(std::memory_order_acquire) == false)
+		{
+			return;
+		}
+
+		collectDirtyItems();
+
+		removeDirtyItem(pItem->dirtyQueueNode.iDirtyItemIndex);
+	}
+
+	//@@Function
+	/*
+	* desc: returns the number of dirty items (not including the objects pushed after the last collectDirtyItems() call).
+	*/
+	size_t getDirtyItemCount() const
+	{
+		return vDirtyItems.size();
+	}
+
+private:
+
+	std::atomic<T*> pPushedHead{ nullptr };
+
+	std::vector<T*> vDirtyItems;
+};
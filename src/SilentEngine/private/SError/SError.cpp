@@ -13,6 +13,7 @@
 #include <filesystem>
 #include <string>
 #include <ranges>
+#include <mutex>
 
 namespace fs = std::filesystem;
 
@@ -169,4 +170,71 @@ void SError::showErrorMessageBoxAndLog(std::string sErrorString, const std::sour
 
 	HRESULT error = S_OK;
 	throw DXException(error);
-}
\ No newline at end of file
+}
+
+std::string SError::logError(HRESULT hresult, const std::source_location& location)
+{
+	LPSTR errorText = NULL;
+
+	FormatMessageA(
+		FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_IGNORE_INSERTS,
+		NULL,
+		hresult,
+		MAKELANGID(LANG_ENGLISH, SUBLANG_ENGLISH_US),
+		(LPSTR)&errorText,
+		0,
+		NULL);
+
+	std::string sErrorString = "HRESULT " + std::to_string(static_cast<unsigned long>(hresult));
+
+	if (errorText != NULL)
+	{
+		sErrorString += ": ";
+		sErrorString += errorText;
+
+		LocalFree(errorText);
+	}
+
+	return logError(sErrorString, location);
+}
+
+std::string SError::logError(std::string sErrorString, const std::source_location& location)
+{
+	static std::mutex mtxLogFile;
+
+	std::string sErrorStr = "An error occurred at file ";
+
+	// Get last '\\' char location.
+	std::string_view file_name(location.file_name());
+	size_t iLastSlashPos = 0;
+	for (size_t i = 0; i < file_name.size(); i++)
+	{
+		if (file_name[i] == '\\')
+		{
+			iLastSlashPos = i;
+		}
+	}
+
+	sErrorStr += file_name.substr(iLastSlashPos + 1);
+	sErrorStr += ", function: ";
+	sErrorStr += location.function_name();
+	sErrorStr += ", [";
+	sErrorStr += std::to_string(location.line());
+	sErrorStr += ",";
+	sErrorStr += std::to_string(location.column());
+	sErrorStr += "]. Error description: ";
+	sErrorStr += sErrorString;
+
+	// Can be called from multiple threads.
+	std::lock_guard<std::mutex> guard(mtxLogFile);
+
+	std::ofstream errorFile(ERROR_FILE_NAME);
+	if (errorFile.is_open())
+	{
+		errorFile << sErrorStr;
+
+		errorFile.close();
+	}
+
+	return sErrorStr;
+}
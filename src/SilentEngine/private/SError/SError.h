@@ -43,4 +43,9 @@ public:
 
 	static void showErrorMessageBoxAndLog(HRESULT hresult, const std::source_location& location = std::source_location::current());
 	static void showErrorMessageBoxAndLog(std::string sErrorString, const std::source_location& location = std::source_location::current());
+
+	// Only write the error to the log file (no message box, does not throw), used on the worker threads
+	// that pass the error to the main thread. Return the logged message.
+	static std::string logError(HRESULT hresult, const std::source_location& location = std::source_location::current());
+	static std::string logError(std::string sErrorString, const std::source_location& location = std::source_location::current());
 };
\ No newline at end of file
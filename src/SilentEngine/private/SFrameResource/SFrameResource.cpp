@@ -285,6 +285,27 @@ void SFrameResource::removeInstancedMesh(SUploadBuffer<SObjectConstants>* pInsta
 	}
 }
 
+bool SFrameResource::createRecordingThreadAllocators(size_t iThreadCount)
+{
+	vRecordingThreadAllocators.clear();
+
+	for (size_t i = 0; i < iThreadCount; i++)
+	{
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator> pAllocator;
+
+		HRESULT hresult = pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(pAllocator.GetAddressOf()));
+		if (FAILED(hresult))
+		{
+			SError::showErrorMessageBoxAndLog(hresult);
+			return true;
+		}
+
+		vRecordingThreadAllocators.push_back(pAllocator);
+	}
+
+	return false;
+}
+
 size_t SFrameResource::addRuntimeMeshVertexBuffer(size_t iVertexCount)
 {
 	vRuntimeMeshVertexBuffers.push_back(std::make_unique<SUploadBuffer<SVertex>> (pDevice, iVertexCount, false));
@@ -189,6 +189,11 @@ public:
 	void                               removeInstancedMesh(SUploadBuffer<SObjectConstants>* pInstancedDataToDelete);
 
 
+	// creates one command allocator per thread that records the jobs of the render job graph
+	// returns false if successful, true otherwise
+	bool   createRecordingThreadAllocators (size_t iThreadCount);
+
+
 	// returns index of new buffer in vRuntimeMeshVertexBuffers
 	size_t addRuntimeMeshVertexBuffer      (size_t iVertexCount);
 	void   removeRuntimeMeshVertexBuffer   (size_t iVertexBufferIndex);
@@ -199,6 +204,8 @@ public:
 
 
 	Microsoft::WRL::ComPtr<ID3D12CommandAllocator>   pCommandListAllocator;
+	// Command lists of the render job graph (see SCommandListPool), one thread never records two lists at the same time.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12CommandAllocator>> vRecordingThreadAllocators;
 
 	// We cannot update a buffer until the GPU is done processing the commands that reference it. So each frame needs their own buffers.
 	std::unique_ptr<SUploadBuffer<SRenderPassConstants>> pShadowMapsCB = nullptr;
@@ -208,6 +215,8 @@ public:
 	std::vector<std::unique_ptr<SMaterialBundle>>        vMaterialBundles;
 	std::vector<std::unique_ptr<SUploadBuffer<SObjectConstants>>> vInstancedMeshes;
 	std::vector<std::unique_ptr<SUploadBuffer<SVertex>>> vRuntimeMeshVertexBuffers;
+	// Streamed textures that were replaced while this frame resource was current, released once the GPU reaches iFence.
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>>  vDeferredReleaseResources;
 
 	ID3D12Device* pDevice = nullptr;
 
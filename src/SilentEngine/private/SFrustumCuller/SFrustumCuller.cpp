@@ -0,0 +1,401 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SFrustumCuller.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// SSE
+#include <emmintrin.h>
+
+size_t SCullBounds::add()
+{
+	vCenterX.push_back(0.0f);
+	vCenterY.push_back(0.0f);
+	vCenterZ.push_back(0.0f);
+	vExtentX.push_back(0.0f);
+	vExtentY.push_back(0.0f);
+	vExtentZ.push_back(0.0f);
+
+	vOriginX.push_back(0.0f);
+	vOriginY.push_back(0.0f);
+	vOriginZ.push_back(0.0f);
+	vCullDistanceSquared.push_back(0.0f);
+
+	return vCenterX.size() - 1;
+}
+
+void SCullBounds::removeSwap(size_t iIndex)
+{
+	std::vector<float>* vArrays[] = { &vCenterX, &vCenterY, &vCenterZ, &vExtentX, &vExtentY, &vExtentZ,
+		&vOriginX, &vOriginY, &vOriginZ, &vCullDistanceSquared };
+
+	for (size_t i = 0; i < sizeof(vArrays) / sizeof(vArrays[0]); i++)
+	{
+		std::vector<float>& vArray = *vArrays[i];
+
+		vArray[iIndex] = vArray.back();
+		vArray.pop_back();
+	}
+}
+
+void SCullBounds::clear()
+{
+	vCenterX.clear();
+	vCenterY.clear();
+	vCenterZ.clear();
+	vExtentX.clear();
+	vExtentY.clear();
+	vExtentZ.clear();
+
+	vOriginX.clear();
+	vOriginY.clear();
+	vOriginZ.clear();
+	vCullDistanceSquared.clear();
+}
+
+void SCullBounds::set(size_t iIndex, const DirectX::BoundingBox& localBox, const DirectX::XMFLOAT4X4& vWorld, float fCullDistance)
+{
+	const DirectX::XMFLOAT3& c = localBox.Center;
+	const DirectX::XMFLOAT3& e = localBox.Extents;
+
+	// Row vectors: world = local * M.
+
+	vCenterX[iIndex] = c.x * vWorld._11 + c.y * vWorld._21 + c.z * vWorld._31 + vWorld._41;
+	vCenterY[iIndex] = c.x * vWorld._12 + c.y * vWorld._22 + c.z * vWorld._32 + vWorld._42;
+	vCenterZ[iIndex] = c.x * vWorld._13 + c.y * vWorld._23 + c.z * vWorld._33 + vWorld._43;
+
+	vExtentX[iIndex] = e.x * std::fabs(vWorld._11) + e.y * std::fabs(vWorld._21) + e.z * std::fabs(vWorld._31);
+	vExtentY[iIndex] = e.x * std::fabs(vWorld._12) + e.y * std::fabs(vWorld._22) + e.z * std::fabs(vWorld._32);
+	vExtentZ[iIndex] = e.x * std::fabs(vWorld._13) + e.y * std::fabs(vWorld._23) + e.z * std::fabs(vWorld._33);
+
+	vOriginX[iIndex] = vWorld._41;
+	vOriginY[iIndex] = vWorld._42;
+	vOriginZ[iIndex] = vWorld._43;
+
+	vCullDistanceSquared[iIndex] = fCullDistance > 0.0f ? fCullDistance * fCullDistance : 0.0f;
+}
+
+DirectX::BoundingBox SCullBounds::getWorldBox(size_t iIndex) const
+{
+	DirectX::BoundingBox box;
+	box.Center  = DirectX::XMFLOAT3(vCenterX[iIndex], vCenterY[iIndex], vCenterZ[iIndex]);
+	box.Extents = DirectX::XMFLOAT3(vExtentX[iIndex], vExtentY[iIndex], vExtentZ[iIndex]);
+
+	return box;
+}
+
+size_t SCullBounds::size() const
+{
+	return vCenterX.size();
+}
+
+SFrustumCuller::SFrustumCuller(size_t iWorkerCount) : threadPool(iWorkerCount)
+{
+}
+
+void SFrustumCuller::getFrustumPlanes(const DirectX::BoundingFrustum& worldFrustum, SFrustumPlanes& outPlanes)
+{
+	DirectX::XMVECTOR vPlanes[6];
+	worldFrustum.GetPlanes(&vPlanes[0], &vPlanes[1], &vPlanes[2], &vPlanes[3], &vPlanes[4], &vPlanes[5]);
+
+	for (size_t i = 0; i < 6; i++)
+	{
+		DirectX::XMFLOAT4 vPlane;
+		DirectX::XMStoreFloat4(&vPlane, vPlanes[i]);
+
+		outPlanes.vNormalX[i]  = vPlane.x;
+		outPlanes.vNormalY[i]  = vPlane.y;
+		outPlanes.vNormalZ[i]  = vPlane.z;
+		outPlanes.vDistance[i] = vPlane.w;
+	}
+}
+
+void SFrustumCuller::cull(const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+	std::vector<uint32_t>& vOutVisibleIndices)
+{
+	vOutVisibleIndices.clear();
+
+	const size_t iBoundsCount = bounds.size();
+	const size_t iJobs = std::min<size_t>(threadPool.getWorkerCount() + 1, iBoundsCount / iMinBoundsPerJob);
+
+	if (iJobs <= 1)
+	{
+		cullRange(planes, vCameraLocation, bounds, 0, iBoundsCount, vOutVisibleIndices);
+		return;
+	}
+
+	const size_t iBoundsPerJob = ((iBoundsCount + iJobs - 1) / iJobs + 3) & ~static_cast<size_t>(3); // keep SSE groups in one job
+
+	if (vJobResults.size() < iJobs)
+	{
+		vJobResults.resize(iJobs);
+	}
+
+	threadPool.runJobs(iJobs, [&](size_t iJob)
+	{
+		const size_t iFirst = std::min<size_t>(iJob * iBoundsPerJob, iBoundsCount);
+		const size_t iLast  = std::min<size_t>(iFirst + iBoundsPerJob, iBoundsCount);
+
+		// The first job writes directly to the output.
+		std::vector<uint32_t>& vResult = iJob == 0 ? vOutVisibleIndices : vJobResults[iJob];
+
+		vResult.clear();
+		cullRange(planes, vCameraLocation, bounds, iFirst, iLast, vResult);
+	});
+
+	for (size_t i = 1; i < iJobs; i++)
+	{
+		vOutVisibleIndices.insert(vOutVisibleIndices.end(), vJobResults[i].begin(), vJobResults[i].end());
+	}
+}
+
+size_t SFrustumCuller::cullInstances(const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+	const std::vector<float>& vLODDistances, const void* pInstanceData, size_t iInstanceDataStride, void* pOutInstanceData,
+	size_t iOutInstanceDataSizeInBytes, std::vector<size_t>& vOutLODInstanceCounts)
+{
+	// Never write past the output buffer (it may have fewer elements than the bounds).
+	const size_t iInstanceCount = std::min<size_t>(bounds.size(), iOutInstanceDataSizeInBytes / iInstanceDataStride);
+	const size_t iLODCount = vLODDistances.size() + 1;
+
+	vOutLODInstanceCounts.assign(iLODCount, 0);
+
+	if (iInstanceCount == 0)
+	{
+		return 0;
+	}
+
+	const size_t iJobs = std::max<size_t>(1, std::min<size_t>(threadPool.getWorkerCount() + 1, iInstanceCount / iMinBoundsPerJob));
+	const size_t iInstancesPerJob = ((iInstanceCount + iJobs - 1) / iJobs + 3) & ~static_cast<size_t>(3); // keep SSE groups in one job
+
+	if (vInstanceChunks.size() < iJobs)
+	{
+		vInstanceChunks.resize(iJobs);
+	}
+
+	std::vector<float> vLODDistancesSquared(vLODDistances.size());
+	for (size_t i = 0; i < vLODDistances.size(); i++)
+	{
+		vLODDistancesSquared[i] = vLODDistances[i] * vLODDistances[i];
+	}
+
+
+	// Cull each chunk and count the instances of each LOD.
+
+	auto cullJob = [&](size_t iJob)
+	{
+		SInstanceCullChunk& chunk = vInstanceChunks[iJob];
+
+		const size_t iFirst = std::min<size_t>(iJob * iInstancesPerJob, iInstanceCount);
+		const size_t iLast  = std::min<size_t>(iFirst + iInstancesPerJob, iInstanceCount);
+
+		chunk.vVisibleIndices.clear();
+		cullRange(planes, vCameraLocation, bounds, iFirst, iLast, chunk.vVisibleIndices);
+
+		chunk.vLODs.resize(chunk.vVisibleIndices.size());
+		chunk.vLODCounts.assign(iLODCount, 0);
+		chunk.vLODOutOffsets.resize(iLODCount);
+
+		for (size_t i = 0; i < chunk.vVisibleIndices.size(); i++)
+		{
+			const uint32_t iIndex = chunk.vVisibleIndices[i];
+
+			const float fToCameraX = bounds.vOriginX[iIndex] - vCameraLocation.x;
+			const float fToCameraY = bounds.vOriginY[iIndex] - vCameraLocation.y;
+			const float fToCameraZ = bounds.vOriginZ[iIndex] - vCameraLocation.z;
+			const float fDistanceSquared = fToCameraX * fToCameraX + fToCameraY * fToCameraY + fToCameraZ * fToCameraZ;
+
+			uint32_t iLOD = 0;
+			while (iLOD < vLODDistancesSquared.size() && fDistanceSquared >= vLODDistancesSquared[iLOD])
+			{
+				iLOD++;
+			}
+
+			chunk.vLODs[i] = iLOD;
+			chunk.vLODCounts[iLOD]++;
+		}
+	};
+
+	threadPool.runJobs(iJobs, cullJob);
+
+
+	// Output layout: LOD 0 of all chunks, then LOD 1 of all chunks and so on.
+
+	size_t iVisibleCount = 0;
+
+	for (size_t iLOD = 0; iLOD < iLODCount; iLOD++)
+	{
+		for (size_t iJob = 0; iJob < iJobs; iJob++)
+		{
+			SInstanceCullChunk& chunk = vInstanceChunks[iJob];
+
+			chunk.vLODOutOffsets[iLOD] = iVisibleCount;
+
+			iVisibleCount += chunk.vLODCounts[iLOD];
+			vOutLODInstanceCounts[iLOD] += chunk.vLODCounts[iLOD];
+		}
+	}
+
+
+	// Compact the data of each chunk in cached memory and copy it to the output at once
+	// (the output is usually a mapped upload buffer that should be written sequentially).
+
+	const unsigned char* pSourceData = static_cast<const unsigned char*>(pInstanceData);
+	unsigned char* pOutData = static_cast<unsigned char*>(pOutInstanceData);
+
+	auto copyJob = [&](size_t iJob)
+	{
+		SInstanceCullChunk& chunk = vInstanceChunks[iJob];
+
+		chunk.vCompactedData.resize(chunk.vVisibleIndices.size() * iInstanceDataStride);
+
+		std::vector<size_t> vLODWriteIndices(iLODCount);
+		for (size_t iLOD = 1; iLOD < iLODCount; iLOD++)
+		{
+			vLODWriteIndices[iLOD] = vLODWriteIndices[iLOD - 1] + chunk.vLODCounts[iLOD - 1];
+		}
+
+		for (size_t i = 0; i < chunk.vVisibleIndices.size(); i++)
+		{
+			std::memcpy(&chunk.vCompactedData[vLODWriteIndices[chunk.vLODs[i]] * iInstanceDataStride],
+				pSourceData + chunk.vVisibleIndices[i] * iInstanceDataStride, iInstanceDataStride);
+
+			vLODWriteIndices[chunk.vLODs[i]]++;
+		}
+
+		size_t iReadIndex = 0;
+		for (size_t iLOD = 0; iLOD < iLODCount; iLOD++)
+		{
+			if (chunk.vLODCounts[iLOD] > 0)
+			{
+				std::memcpy(pOutData + chunk.vLODOutOffsets[iLOD] * iInstanceDataStride, &chunk.vCompactedData[iReadIndex * iInstanceDataStride],
+					chunk.vLODCounts[iLOD] * iInstanceDataStride);
+			}
+
+			iReadIndex += chunk.vLODCounts[iLOD];
+		}
+	};
+
+	threadPool.runJobs(iJobs, copyJob);
+
+	return iVisibleCount;
+}
+
+void SFrustumCuller::cullRange(const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+	size_t iFirst, size_t iLast, std::vector<uint32_t>& vOutVisibleIndices)
+{
+	__m128 vPlaneNX[6], vPlaneNY[6], vPlaneNZ[6], vPlaneD[6];
+	__m128 vAbsPlaneNX[6], vAbsPlaneNY[6], vAbsPlaneNZ[6];
+
+	for (size_t i = 0; i < 6; i++)
+	{
+		vPlaneNX[i] = _mm_set1_ps(planes.vNormalX[i]);
+		vPlaneNY[i] = _mm_set1_ps(planes.vNormalY[i]);
+		vPlaneNZ[i] = _mm_set1_ps(planes.vNormalZ[i]);
+		vPlaneD[i]  = _mm_set1_ps(planes.vDistance[i]);
+
+		vAbsPlaneNX[i] = _mm_set1_ps(std::fabs(planes.vNormalX[i]));
+		vAbsPlaneNY[i] = _mm_set1_ps(std::fabs(planes.vNormalY[i]));
+		vAbsPlaneNZ[i] = _mm_set1_ps(std::fabs(planes.vNormalZ[i]));
+	}
+
+	const __m128 vCameraX = _mm_set1_ps(vCameraLocation.x);
+	const __m128 vCameraY = _mm_set1_ps(vCameraLocation.y);
+	const __m128 vCameraZ = _mm_set1_ps(vCameraLocation.z);
+	const __m128 vZero    = _mm_setzero_ps();
+
+	size_t i = iFirst;
+
+	for (; i + 4 <= iLast; i += 4)
+	{
+		const __m128 vCenterX = _mm_loadu_ps(&bounds.vCenterX[i]);
+		const __m128 vCenterY = _mm_loadu_ps(&bounds.vCenterY[i]);
+		const __m128 vCenterZ = _mm_loadu_ps(&bounds.vCenterZ[i]);
+		const __m128 vExtentX = _mm_loadu_ps(&bounds.vExtentX[i]);
+		const __m128 vExtentY = _mm_loadu_ps(&bounds.vExtentY[i]);
+		const __m128 vExtentZ = _mm_loadu_ps(&bounds.vExtentZ[i]);
+
+		__m128 vOutside = vZero;
+
+		for (size_t p = 0; p < 6; p++)
+		{
+			// Signed distance from the box center to the plane and the box "radius" projected on the plane normal.
+			__m128 vDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vPlaneNX[p], vCenterX), _mm_mul_ps(vPlaneNY[p], vCenterY)),
+				_mm_add_ps(_mm_mul_ps(vPlaneNZ[p], vCenterZ), vPlaneD[p]));
+			__m128 vRadius   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vAbsPlaneNX[p], vExtentX), _mm_mul_ps(vAbsPlaneNY[p], vExtentY)),
+				_mm_mul_ps(vAbsPlaneNZ[p], vExtentZ));
+
+			vOutside = _mm_or_ps(vOutside, _mm_cmpgt_ps(vDistance, vRadius));
+		}
+
+		// Cull distance.
+
+		const __m128 vToCameraX = _mm_sub_ps(_mm_loadu_ps(&bounds.vOriginX[i]), vCameraX);
+		const __m128 vToCameraY = _mm_sub_ps(_mm_loadu_ps(&bounds.vOriginY[i]), vCameraY);
+		const __m128 vToCameraZ = _mm_sub_ps(_mm_loadu_ps(&bounds.vOriginZ[i]), vCameraZ);
+		const __m128 vDistanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vToCameraX, vToCameraX), _mm_mul_ps(vToCameraY, vToCameraY)),
+			_mm_mul_ps(vToCameraZ, vToCameraZ));
+		const __m128 vCullDistanceSquared = _mm_loadu_ps(&bounds.vCullDistanceSquared[i]);
+
+		vOutside = _mm_or_ps(vOutside,
+			_mm_and_ps(_mm_cmpgt_ps(vCullDistanceSquared, vZero), _mm_cmpge_ps(vDistanceSquared, vCullDistanceSquared)));
+
+		const int iVisibleMask = ~_mm_movemask_ps(vOutside) & 0xF;
+
+		for (int k = 0; k < 4; k++)
+		{
+			if (iVisibleMask & (1 << k))
+			{
+				vOutVisibleIndices.push_back(static_cast<uint32_t>(i + k));
+			}
+		}
+	}
+
+	// Remaining bounds.
+
+	for (; i < iLast; i++)
+	{
+		bool bOutside = false;
+
+		for (size_t p = 0; p < 6; p++)
+		{
+			float fDistance = planes.vNormalX[p] * bounds.vCenterX[i] + planes.vNormalY[p] * bounds.vCenterY[i]
+				+ planes.vNormalZ[p] * bounds.vCenterZ[i] + planes.vDistance[p];
+			float fRadius = std::fabs(planes.vNormalX[p]) * bounds.vExtentX[i] + std::fabs(planes.vNormalY[p]) * bounds.vExtentY[i]
+				+ std::fabs(planes.vNormalZ[p]) * bounds.vExtentZ[i];
+
+			if (fDistance > fRadius)
+			{
+				bOutside = true;
+				break;
+			}
+		}
+
+		const float fToCameraX = bounds.vOriginX[i] - vCameraLocation.x;
+		const float fToCameraY = bounds.vOriginY[i] - vCameraLocation.y;
+		const float fToCameraZ = bounds.vOriginZ[i] - vCameraLocation.z;
+		const float fDistanceSquared = fToCameraX * fToCameraX + fToCameraY * fToCameraY + fToCameraZ * fToCameraZ;
+
+		if (bounds.vCullDistanceSquared[i] > 0.0f && fDistanceSquared >= bounds.vCullDistanceSquared[i])
+		{
+			bOutside = true;
+		}
+
+		if (bOutside == false)
+		{
+			vOutVisibleIndices.push_back(static_cast<uint32_t>(i));
+		}
+	}
+}
+
+size_t SFrustumCuller::getWorkerCount() const
+{
+	return threadPool.getWorkerCount();
+}
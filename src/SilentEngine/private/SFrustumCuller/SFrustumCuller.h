@@ -0,0 +1,180 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// DirectX
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+// Custom
+#include "SilentEngine/Private/SThreadPool/SThreadPool.h"
+
+
+//@@Class
+/*
+Six world space planes of the view frustum stored as structure of arrays.
+Plane normals point outside of the frustum so a point is outside if dot(normal, point) + d > 0.
+*/
+struct SFrustumPlanes
+{
+	float vNormalX[6];
+	float vNormalY[6];
+	float vNormalZ[6];
+	float vDistance[6];
+};
+
+
+//@@Class
+/*
+World space bounds of the objects that need to be culled, stored as structure of arrays so that the culler
+can test 4 objects at a time.
+*/
+class SCullBounds
+{
+public:
+	//@@Function
+	/*
+	* desc: adds new bounds (with zero size).
+	* return: index of the new bounds.
+	*/
+	size_t add        ();
+	//@@Function
+	/*
+	* desc: removes the bounds, the last bounds are moved to the removed index.
+	*/
+	void   removeSwap (size_t iIndex);
+	//@@Function
+	/*
+	* desc: removes all bounds.
+	*/
+	void   clear      ();
+	//@@Function
+	/*
+	* desc: calculates world space AABB from the local space box and the world matrix.
+	* param "fCullDistance": objects that are farther than this distance from the camera are culled, pass 0 to disable.
+	*/
+	void   set        (size_t iIndex, const DirectX::BoundingBox& localBox, const DirectX::XMFLOAT4X4& vWorld, float fCullDistance);
+	//@@Function
+	/*
+	* desc: returns world space AABB calculated in set().
+	*/
+	DirectX::BoundingBox getWorldBox (size_t iIndex) const;
+	//@@Function
+	/*
+	* desc: returns the number of bounds.
+	*/
+	size_t size       () const;
+
+private:
+
+	friend class SFrustumCuller;
+
+	// AABB.
+	std::vector<float> vCenterX;
+	std::vector<float> vCenterY;
+	std::vector<float> vCenterZ;
+	std::vector<float> vExtentX;
+	std::vector<float> vExtentY;
+	std::vector<float> vExtentZ;
+
+	// Origin of the object (used for cull distance).
+	std::vector<float> vOriginX;
+	std::vector<float> vOriginY;
+	std::vector<float> vOriginZ;
+	std::vector<float> vCullDistanceSquared; // 0 if disabled
+};
+
+
+//@@Class
+/*
+The class tests world space bounds against the frustum planes (4 bounds at a time using SSE) and outputs
+indices of the visible bounds (or compacted data of the visible instances). Big arrays are split between the worker threads.
+*/
+class SFrustumCuller
+{
+public:
+	//@@Function
+	/*
+	* desc: starts the worker threads.
+	* param "iWorkerCount": number of worker threads, pass 0 to use (number of hardware threads - 1).
+	*/
+	SFrustumCuller(size_t iWorkerCount = 0);
+	SFrustumCuller(const SFrustumCuller&) = delete;
+	SFrustumCuller& operator= (const SFrustumCuller&) = delete;
+
+	//@@Function
+	/*
+	* desc: extracts the planes of the world space frustum.
+	*/
+	static void getFrustumPlanes (const DirectX::BoundingFrustum& worldFrustum, SFrustumPlanes& outPlanes);
+	//@@Function
+	/*
+	* desc: writes indices of the bounds that intersect with (or are inside of) the frustum
+	and are closer to the camera than their cull distance.
+	* param "vOutVisibleIndices": cleared before writing, indices are sorted.
+	*/
+	void        cull             (const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+		std::vector<uint32_t>& vOutVisibleIndices);
+	//@@Function
+	/*
+	* desc: same as cull() but only tests bounds in range [iFirst, iLast) on the calling thread, indices are appended.
+	*/
+	static void cullRange        (const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+		size_t iFirst, size_t iLast, std::vector<uint32_t>& vOutVisibleIndices);
+	//@@Function
+	/*
+	* desc: culls instances in parallel chunks, puts each visible instance in a LOD bucket (by the distance between
+	the camera and the instance origin) and writes compacted data of the visible instances grouped by LOD (LOD 0 first).
+	* param "bounds": world space bounds of the instances.
+	* param "vLODDistances": sorted distances at which the next LOD starts, an instance closer than vLODDistances[0] is LOD 0,
+	pass an empty array to put all instances in LOD 0.
+	* param "pInstanceData": data of all instances (in the same order as the bounds).
+	* param "iInstanceDataStride": size of the data of one instance in bytes.
+	* param "pOutInstanceData": buffer for the visible instances, each chunk is written using one memcpy per LOD.
+	* param "iOutInstanceDataSizeInBytes": size of the 'pOutInstanceData' buffer, if it's smaller than (bounds.size() * iInstanceDataStride)
+	only the instances that fit in it are culled.
+	* param "vOutLODInstanceCounts": number of visible instances in each LOD (vLODDistances.size() + 1 values).
+	* return: number of visible instances.
+	* remarks: instances of the same LOD keep their original order.
+	*/
+	size_t      cullInstances    (const SFrustumPlanes& planes, const DirectX::XMFLOAT3& vCameraLocation, const SCullBounds& bounds,
+		const std::vector<float>& vLODDistances, const void* pInstanceData, size_t iInstanceDataStride, void* pOutInstanceData,
+		size_t iOutInstanceDataSizeInBytes, std::vector<size_t>& vOutLODInstanceCounts);
+	//@@Function
+	/*
+	* desc: returns the number of worker threads.
+	*/
+	size_t      getWorkerCount   () const;
+
+	// Arrays smaller than this are not split between threads.
+	static constexpr size_t iMinBoundsPerJob = 4096;
+
+private:
+
+	//@@Class
+	/*
+	Intermediate results of one chunk in cullInstances().
+	*/
+	struct SInstanceCullChunk
+	{
+		std::vector<uint32_t>      vVisibleIndices;
+		std::vector<uint32_t>      vLODs;            // LOD of each visible instance
+		std::vector<size_t>        vLODCounts;
+		std::vector<size_t>        vLODOutOffsets;   // where the instances of each LOD are written (in instances)
+		std::vector<unsigned char> vCompactedData;
+	};
+
+	SThreadPool threadPool;
+
+	std::vector<std::vector<uint32_t>> vJobResults;
+	std::vector<SInstanceCullChunk>    vInstanceChunks;
+};
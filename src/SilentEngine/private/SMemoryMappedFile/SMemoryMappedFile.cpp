@@ -0,0 +1,99 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SMemoryMappedFile.h"
+
+// OS
+#include <Windows.h>
+
+SMemoryMappedFile::~SMemoryMappedFile()
+{
+	close();
+}
+
+bool SMemoryMappedFile::open(const std::wstring& sPathToFile)
+{
+	close();
+
+	HANDLE hOpenedFile = CreateFileW(sPathToFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hOpenedFile == INVALID_HANDLE_VALUE)
+	{
+		return true;
+	}
+
+	hFile = hOpenedFile;
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(hFile, &fileSize) == FALSE)
+	{
+		close();
+		return true;
+	}
+
+	iSize = static_cast<size_t>(fileSize.QuadPart);
+
+	if (iSize == 0)
+	{
+		// CreateFileMapping() fails on empty files, leave the view empty.
+		return false;
+	}
+
+	hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping == nullptr)
+	{
+		close();
+		return true;
+	}
+
+	pData = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+	if (pData == nullptr)
+	{
+		close();
+		return true;
+	}
+
+	return false;
+}
+
+void SMemoryMappedFile::close()
+{
+	if (pData)
+	{
+		UnmapViewOfFile(pData);
+		pData = nullptr;
+	}
+
+	if (hMapping)
+	{
+		CloseHandle(hMapping);
+		hMapping = nullptr;
+	}
+
+	if (hFile)
+	{
+		CloseHandle(hFile);
+		hFile = nullptr;
+	}
+
+	iSize = 0;
+}
+
+const char* SMemoryMappedFile::getData() const
+{
+	return pData;
+}
+
+size_t SMemoryMappedFile::getSize() const
+{
+	return iSize;
+}
+
+bool SMemoryMappedFile::isOpen() const
+{
+	return hFile != nullptr;
+}
@@ -0,0 +1,40 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+
+// Read-only view of the whole file mapped into the address space.
+// The view stays valid until close() is called or the object is destroyed.
+class SMemoryMappedFile
+{
+public:
+
+	SMemoryMappedFile() = default;
+	SMemoryMappedFile(const SMemoryMappedFile&) = delete;
+	SMemoryMappedFile& operator= (const SMemoryMappedFile&) = delete;
+	~SMemoryMappedFile();
+
+	// Returns false if successful, true otherwise (the error is not shown, the caller decides what to do).
+	bool open(const std::wstring& sPathToFile);
+	void close();
+
+	const char* getData() const;
+	size_t      getSize() const;
+	bool        isOpen () const;
+
+private:
+
+	// Windows handles (stored as void* to not include Windows.h here).
+	void* hFile    = nullptr;
+	void* hMapping = nullptr;
+
+	const char* pData = nullptr;
+	size_t      iSize = 0;
+};
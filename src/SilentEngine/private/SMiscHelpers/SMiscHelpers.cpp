@@ -154,7 +154,8 @@ ATL::CComPtr<IDxcBlob> SMiscHelpers::compileShader(const std::wstring& sPathToSh
 	const D3D_SHADER_MACRO* defines,
 	const std::wstring& sShaderEntryPoint,
 	const std::wstring& sShaderModel,
-	bool bCompileShadersInRelease)
+	bool bCompileShadersInRelease,
+	SShaderCache* pShaderCache)
 {
 	// Check if the file exist.
 
@@ -198,6 +199,41 @@ ATL::CComPtr<IDxcBlob> SMiscHelpers::compileShader(const std::wstring& sPathToSh
 	DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&pUtils));
 	DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&pCompiler));
 
+
+
+	// Look in the cache.
+
+	uint64_t iCacheKey = 0;
+	bool bUseCache = false;
+
+	if (pShaderCache && pShaderCache->isEnabled())
+	{
+		std::vector<std::pair<std::string, std::string>> vDefines;
+		for (const D3D_SHADER_MACRO* pDefine = defines; pDefine && pDefine->Name; pDefine++)
+		{
+			vDefines.push_back({ pDefine->Name, pDefine->Definition ? pDefine->Definition : "" });
+		}
+
+#if defined(DEBUG) || defined(_DEBUG) 
+		bool bOptimized = bCompileShadersInRelease;
+#else
+		bool bOptimized = true;
+#endif
+
+		bUseCache = SShaderCache::computeShaderKey(sPathToShader, vDefines, sShaderEntryPoint, sShaderModel, bOptimized, iCacheKey) == false;
+
+		std::vector<char> vCachedShader;
+		if (bUseCache && pShaderCache->load(SShaderCacheEntryType::SCET_SHADER, iCacheKey, vCachedShader) == false)
+		{
+			CComPtr<IDxcBlobEncoding> pCachedShader = nullptr;
+			HRESULT hresult = pUtils->CreateBlob(vCachedShader.data(), static_cast<UINT32>(vCachedShader.size()), DXC_CP_ACP, &pCachedShader);
+			if (SUCCEEDED(hresult))
+			{
+				return CComPtr<IDxcBlob>(pCachedShader);
+			}
+		}
+	}
+
 	// Create default include handler.
 	CComPtr<IDxcIncludeHandler> pIncludeHandler;
 	pUtils->CreateDefaultIncludeHandler(&pIncludeHandler);
@@ -322,5 +358,11 @@ ATL::CComPtr<IDxcBlob> SMiscHelpers::compileShader(const std::wstring& sPathToSh
 	}
 #endif
 
+	if (bUseCache)
+	{
+		// Failing to write the cache is not an error.
+		pShaderCache->store(SShaderCacheEntryType::SCET_SHADER, iCacheKey, pShader->GetBufferPointer(), pShader->GetBufferSize());
+	}
+
 	return pShader;
 }
\ No newline at end of file
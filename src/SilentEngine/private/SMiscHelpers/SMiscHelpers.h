@@ -20,6 +20,9 @@
 #include "dxc/dxcapi.h"
 #include <atlbase.h> // Common COM helpers.
 
+// Custom
+#include "SilentEngine/Private/SShaderCache/SShaderCache.h"
+
 #define SE_VS_SM L"vs_6_0"
 #define SE_PS_SM L"ps_6_0"
 #define SE_CS_SM L"cs_6_0"
@@ -39,11 +42,13 @@ public:
 		Microsoft::WRL::ComPtr<ID3D12Resource>& pOutUploadBuffer, bool bCreateUAVBuffer = false);
 
 
+	// If pShaderCache is specified the compiled shader is taken from the cache (if it's there) or stored in the cache after compilation.
 	static ATL::CComPtr<IDxcBlob> compileShader(
 		const std::wstring& sPathToShader,
 		const D3D_SHADER_MACRO* defines,
 		const std::wstring& sShaderEntryPoint,
 		const std::wstring& sShaderModel,
-		bool bCompileShadersInRelease);
+		bool bCompileShadersInRelease,
+		SShaderCache* pShaderCache = nullptr);
 };
 
@@ -0,0 +1,82 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SRenderCommandQueue.h"
+
+SRenderCommandQueue::~SRenderCommandQueue()
+{
+	// Not executed commands are discarded.
+
+	SCommandNode* pNode = pPushedHead.exchange(nullptr, std::memory_order_acquire);
+
+	while (pNode)
+	{
+		SCommandNode* pNext = pNode->pNext;
+
+		delete pNode;
+
+		pNode = pNext;
+	}
+}
+
+void SRenderCommandQueue::push(std::function<void()> command)
+{
+	SCommandNode* pNode = new SCommandNode();
+	pNode->command = std::move(command);
+
+	SCommandNode* pHead = pPushedHead.load(std::memory_order_relaxed);
+
+	do
+	{
+		pNode->pNext = pHead;
+	} while (pPushedHead.compare_exchange_weak(pHead, pNode, std::memory_order_release, std::memory_order_relaxed) == false);
+}
+
+size_t SRenderCommandQueue::execute()
+{
+	SCommandNode* pNode = pPushedHead.exchange(nullptr, std::memory_order_acquire);
+
+	if (pNode == nullptr)
+	{
+		return 0;
+	}
+
+	// Reverse to get the push order.
+
+	SCommandNode* pFirst = nullptr;
+
+	while (pNode)
+	{
+		SCommandNode* pNext = pNode->pNext;
+
+		pNode->pNext = pFirst;
+		pFirst = pNode;
+
+		pNode = pNext;
+	}
+
+	size_t iExecutedCount = 0;
+
+	while (pFirst)
+	{
+		SCommandNode* pNext = pFirst->pNext;
+
+		pFirst->command();
+		iExecutedCount++;
+
+		delete pFirst;
+
+		pFirst = pNext;
+	}
+
+	return iExecutedCount;
+}
+
+bool SRenderCommandQueue::isEmpty() const
+{
+	return pPushedHead.load(std::memory_order_acquire) == nullptr;
+}
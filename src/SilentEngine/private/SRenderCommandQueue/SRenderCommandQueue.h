@@ -0,0 +1,62 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <functional>
+#include <atomic>
+
+
+//@@Class
+/*
+The class stores changes that other threads (game, physics) want to make to the engine state.
+Any thread can push commands (lock-free, does not wait for the render thread), only one thread (the render thread)
+executes them, once per frame, in the order in which they were pushed.
+*/
+class SRenderCommandQueue
+{
+public:
+	//@@Function
+	SRenderCommandQueue() = default;
+	SRenderCommandQueue(const SRenderCommandQueue&) = delete;
+	SRenderCommandQueue& operator= (const SRenderCommandQueue&) = delete;
+	~SRenderCommandQueue();
+
+	//@@Function
+	/*
+	* desc: adds the command to the queue.
+	* remarks: thread-safe, lock-free.
+	*/
+	void   push   (std::function<void()> command);
+
+	//@@Function
+	/*
+	* desc: executes and removes all pushed commands (in the push order).
+	* return: number of executed commands.
+	* remarks: should only be called by the consumer. Commands pushed by the executed commands will be executed in the next call.
+	*/
+	size_t execute();
+
+	//@@Function
+	/*
+	* desc: returns true if no commands are pushed.
+	*/
+	bool   isEmpty() const;
+
+private:
+
+	struct SCommandNode
+	{
+		std::function<void()> command;
+
+		SCommandNode* pNext = nullptr;
+	};
+
+	// Most recently pushed command first.
+	std::atomic<SCommandNode*> pPushedHead{ nullptr };
+};
@@ -0,0 +1,224 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SRenderJobGraph.h"
+
+// STL
+#include <algorithm>
+
+SRenderJobGraph::~SRenderJobGraph()
+{
+	stop();
+}
+
+void SRenderJobGraph::start(size_t iThreadCount)
+{
+	stop();
+
+	if (iThreadCount == 0)
+	{
+		// The calling thread of execute() also records jobs.
+		iThreadCount = std::max<size_t>(1, std::thread::hardware_concurrency()) - 1;
+	}
+
+	std::lock_guard<std::mutex> guard(mtxJobs);
+
+	bStop = false;
+
+	for (size_t i = 0; i < iThreadCount; i++)
+	{
+		// Index 0 is the calling thread.
+		vWorkers.push_back(std::thread(&SRenderJobGraph::workerThread, this, i + 1));
+	}
+}
+
+void SRenderJobGraph::stop()
+{
+	std::vector<std::thread> vStoppedWorkers;
+
+	{
+		std::lock_guard<std::mutex> guard(mtxJobs);
+
+		bStop = true;
+
+		vStoppedWorkers.swap(vWorkers);
+	}
+
+	cvJobsReady.notify_all();
+
+	for (size_t i = 0; i < vStoppedWorkers.size(); i++)
+	{
+		vStoppedWorkers[i].join();
+	}
+}
+
+size_t SRenderJobGraph::addJob(std::function<void(size_t iThreadIndex, size_t iCommandListIndex)> job, const std::vector<size_t>& vDependencies)
+{
+	const size_t iJobIndex = vJobs.size();
+
+	SRenderJob newJob;
+	newJob.job = std::move(job);
+
+	for (size_t i = 0; i < vDependencies.size(); i++)
+	{
+		if (vDependencies[i] >= iJobIndex)
+		{
+			// Only previously added jobs, so there are no cycles.
+			continue;
+		}
+
+		vJobs[vDependencies[i]].vDependentJobs.push_back(iJobIndex);
+		newJob.iDependencyCount++;
+	}
+
+	vJobs.push_back(std::move(newJob));
+
+	return iJobIndex;
+}
+
+void SRenderJobGraph::clear()
+{
+	vJobs.clear();
+}
+
+bool SRenderJobGraph::execute(SCommandListRecorder* pRecorder)
+{
+	if (vJobs.size() == 0)
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(mtxJobs);
+
+	this->pRecorder = pRecorder;
+	iFinishedJobCount = 0;
+	bRecordingFailed = false;
+
+	vRemainingDependencies.resize(vJobs.size());
+	vReadyJobs.clear();
+
+	for (size_t i = 0; i < vJobs.size(); i++)
+	{
+		vRemainingDependencies[i] = vJobs[i].iDependencyCount;
+
+		if (vRemainingDependencies[i] == 0)
+		{
+			vReadyJobs.push_back(i);
+		}
+	}
+
+	cvJobsReady.notify_all();
+
+	recordJobs(lock, 0, true);
+
+	this->pRecorder = nullptr;
+
+	const bool bFailed = bRecordingFailed;
+
+	lock.unlock();
+
+	if (bFailed)
+	{
+		return true;
+	}
+
+	std::vector<size_t> vCommandListIndices(vJobs.size());
+	for (size_t i = 0; i < vCommandListIndices.size(); i++)
+	{
+		vCommandListIndices[i] = i;
+	}
+
+	pRecorder->submitCommandLists(vCommandListIndices);
+
+	return false;
+}
+
+size_t SRenderJobGraph::getJobCount() const
+{
+	return vJobs.size();
+}
+
+size_t SRenderJobGraph::getRecordingThreadCount()
+{
+	std::lock_guard<std::mutex> guard(mtxJobs);
+
+	return vWorkers.size() + 1;
+}
+
+void SRenderJobGraph::recordJobs(std::unique_lock<std::mutex>& lock, size_t iThreadIndex, bool bIsCallingThread)
+{
+	while (true)
+	{
+		if (bIsCallingThread)
+		{
+			cvJobsReady.wait(lock, [this]() { return vReadyJobs.size() > 0 || iFinishedJobCount == vJobs.size(); });
+
+			if (iFinishedJobCount == vJobs.size())
+			{
+				return;
+			}
+		}
+		else
+		{
+			cvJobsReady.wait(lock, [this]() { return bStop || (pRecorder && vReadyJobs.size() > 0); });
+
+			if (bStop)
+			{
+				return;
+			}
+		}
+
+		const size_t iJobIndex = vReadyJobs.front();
+		vReadyJobs.pop_front();
+
+		SCommandListRecorder* pCurrentRecorder = pRecorder;
+
+		lock.unlock();
+
+		bool bFailed = pCurrentRecorder->beginCommandList(iThreadIndex, iJobIndex);
+		if (bFailed == false)
+		{
+			vJobs[iJobIndex].job(iThreadIndex, iJobIndex);
+
+			bFailed = pCurrentRecorder->endCommandList(iThreadIndex, iJobIndex);
+		}
+
+		lock.lock();
+
+		if (bFailed)
+		{
+			bRecordingFailed = true;
+		}
+
+		// Dependent jobs are started even if this job failed so that execute() does not wait forever.
+		const std::vector<size_t>& vDependentJobs = vJobs[iJobIndex].vDependentJobs;
+		for (size_t i = 0; i < vDependentJobs.size(); i++)
+		{
+			vRemainingDependencies[vDependentJobs[i]]--;
+
+			if (vRemainingDependencies[vDependentJobs[i]] == 0)
+			{
+				vReadyJobs.push_back(vDependentJobs[i]);
+			}
+		}
+
+		iFinishedJobCount++;
+
+		if (vDependentJobs.size() > 0 || iFinishedJobCount == vJobs.size())
+		{
+			// Wake up the workers for the new jobs and the calling thread if all jobs are finished.
+			cvJobsReady.notify_all();
+		}
+	}
+}
+
+void SRenderJobGraph::workerThread(size_t iThreadIndex)
+{
+	std::unique_lock<std::mutex> lock(mtxJobs);
+
+	recordJobs(lock, iThreadIndex, false);
+}
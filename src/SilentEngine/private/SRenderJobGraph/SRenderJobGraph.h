@@ -0,0 +1,151 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//@@Class
+/*
+Owner of the command lists that the jobs of the SRenderJobGraph record to.
+The render job graph does not know about the graphics API so that it can be tested with a mock recorder.
+*/
+class SCommandListRecorder
+{
+public:
+	virtual ~SCommandListRecorder() = default;
+
+	//@@Function
+	/*
+	* desc: prepares the command list for recording (called on the thread that will record the job).
+	* param "iThreadIndex": index of the recording thread in the range [0, SRenderJobGraph::getRecordingThreadCount()),
+	one thread never records two command lists at the same time so command allocators can be per thread.
+	* return: false if successful, true otherwise.
+	*/
+	virtual bool beginCommandList   (size_t iThreadIndex, size_t iCommandListIndex) = 0;
+	//@@Function
+	/*
+	* desc: finishes the recording of the command list (called on the thread that recorded the job).
+	* return: false if successful, true otherwise.
+	*/
+	virtual bool endCommandList     (size_t iThreadIndex, size_t iCommandListIndex) = 0;
+	//@@Function
+	/*
+	* desc: submits the recorded command lists (called on the thread that called SRenderJobGraph::execute()).
+	* param "vCommandListIndices": command lists in the order in which they should be executed.
+	*/
+	virtual void submitCommandLists (const std::vector<size_t>& vCommandListIndices) = 0;
+};
+
+
+//@@Class
+/*
+The class records render jobs (render passes or parts of a pass) into separate command lists on a pool of worker threads
+and submits the command lists in the order in which the jobs were added, no matter in which order they were recorded.
+A job can depend on other jobs (for example, when it uses the culling results of another job),
+it is started only after its dependencies finished recording.
+The thread that calls execute() also records jobs.
+*/
+class SRenderJobGraph
+{
+public:
+	//@@Function
+	SRenderJobGraph() = default;
+	SRenderJobGraph(const SRenderJobGraph&) = delete;
+	SRenderJobGraph& operator= (const SRenderJobGraph&) = delete;
+	~SRenderJobGraph();
+
+	//@@Function
+	/*
+	* desc: starts the worker threads.
+	* param "iThreadCount": number of worker threads, pass 0 to use all cores except for one (the calling thread of execute()).
+	*/
+	void   start                   (size_t iThreadCount = 0);
+	//@@Function
+	/*
+	* desc: stops the worker threads.
+	* remarks: after this function returns all jobs are recorded on the thread that calls execute().
+	*/
+	void   stop                    ();
+
+	//@@Function
+	/*
+	* desc: adds a job, the index of the job is also the index of its command list.
+	* param "job": function that records the job, receives the index of the recording thread and the index of the command list.
+	* param "vDependencies": indices of the previously added jobs that should be recorded before this job.
+	* return: index of the job.
+	*/
+	size_t addJob                  (std::function<void(size_t iThreadIndex, size_t iCommandListIndex)> job,
+		const std::vector<size_t>& vDependencies = std::vector<size_t>());
+	//@@Function
+	/*
+	* desc: removes all jobs (the graph is usually rebuilt every frame).
+	*/
+	void   clear                   ();
+
+	//@@Function
+	/*
+	* desc: records all jobs and submits their command lists in the order of the jobs.
+	* remarks: waits for all jobs to be recorded, the command lists are not submitted if one of them failed.
+	* return: false if successful, true otherwise.
+	*/
+	bool   execute                 (SCommandListRecorder* pRecorder);
+
+	//@@Function
+	/*
+	* desc: returns the number of added jobs.
+	*/
+	size_t getJobCount             () const;
+	//@@Function
+	/*
+	* desc: returns the maximum number of threads that record jobs at the same time (worker threads + the calling thread).
+	*/
+	size_t getRecordingThreadCount ();
+
+private:
+
+	struct SRenderJob
+	{
+		std::function<void(size_t, size_t)> job;
+		std::vector<size_t> vDependentJobs;
+		size_t iDependencyCount = 0;
+	};
+
+	//@@Function
+	/*
+	* desc: records ready jobs until all jobs are recorded (calling thread) or until stopped (worker thread).
+	*/
+	void recordJobs   (std::unique_lock<std::mutex>& lock, size_t iThreadIndex, bool bIsCallingThread);
+	//@@Function
+	/*
+	* desc: worker thread function.
+	*/
+	void workerThread (size_t iThreadIndex);
+
+
+	std::vector<SRenderJob>  vJobs;
+
+	std::vector<std::thread> vWorkers;
+
+	std::mutex              mtxJobs;
+	std::condition_variable cvJobsReady;
+
+	// Execution state, guarded by mtxJobs.
+	std::deque<size_t>      vReadyJobs;
+	std::vector<size_t>     vRemainingDependencies;
+	SCommandListRecorder*   pRecorder = nullptr;
+	size_t                  iFinishedJobCount = 0;
+	bool                    bRecordingFailed = false;
+
+	bool                    bStop = false;
+};
@@ -0,0 +1,221 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SRenderRegistry.h"
+
+// Custom
+#include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
+#include "SilentEngine/Public/EntityComponentSystem/SMeshComponent/SMeshComponent.h"
+#include "SilentEngine/Public/EntityComponentSystem/SRuntimeMeshComponent/SRuntimeMeshComponent.h"
+
+void SRenderRegistry::addContainer(SContainer* pContainer)
+{
+	for (size_t i = 0; i < pContainer->vComponents.size(); i++)
+	{
+		addComponentAndChilds(pContainer->vComponents[i]);
+	}
+}
+
+void SRenderRegistry::removeContainer(SContainer* pContainer)
+{
+	for (size_t i = 0; i < pContainer->vComponents.size(); i++)
+	{
+		removeComponentAndChilds(pContainer->vComponents[i]);
+	}
+}
+
+const std::vector<SMeshComponent*>& SRenderRegistry::getMeshComponents() const
+{
+	return vMeshComponents;
+}
+
+const std::vector<SRuntimeMeshComponent*>& SRenderRegistry::getRuntimeMeshComponents() const
+{
+	return vRuntimeMeshComponents;
+}
+
+const SCullBounds& SRenderRegistry::getMeshCullBounds() const
+{
+	return meshCullBounds;
+}
+
+const SCullBounds& SRenderRegistry::getRuntimeMeshCullBounds() const
+{
+	return runtimeMeshCullBounds;
+}
+
+const SBoundingVolumeHierarchy& SRenderRegistry::getBVH() const
+{
+	return bvh;
+}
+
+SComponent* SRenderRegistry::getBVHProxyComponent(uint32_t iProxy) const
+{
+	return vBVHProxyComponents[iProxy];
+}
+
+void SRenderRegistry::updateCullBounds(SComponent* pComponent)
+{
+	if (pComponent->pObjectCBDirtyQueue == nullptr)
+	{
+		return; // not registered
+	}
+
+	SCullBounds* pCullBounds = &meshCullBounds;
+	if (pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+	{
+		pCullBounds = &runtimeMeshCullBounds;
+	}
+
+	pCullBounds->set(pComponent->iRenderRegistryIndex, pComponent->boxCollision, pComponent->renderData.vWorld, pComponent->fCullDistance);
+
+	DirectX::BoundingBox worldBox = pCullBounds->getWorldBox(pComponent->iRenderRegistryIndex);
+
+	if (pComponent->iBVHProxyId == SBoundingVolumeHierarchy::iNoProxy)
+	{
+		pComponent->iBVHProxyId = bvh.addProxy(worldBox);
+
+		if (pComponent->iBVHProxyId >= vBVHProxyComponents.size())
+		{
+			vBVHProxyComponents.resize(pComponent->iBVHProxyId + 1, nullptr);
+		}
+
+		vBVHProxyComponents[pComponent->iBVHProxyId] = pComponent;
+	}
+	else
+	{
+		bvh.updateProxy(pComponent->iBVHProxyId, worldBox);
+	}
+
+	pComponent->bWorldBoundsOutdated = false;
+}
+
+void SRenderRegistry::updateDirtyBounds()
+{
+	const std::vector<SComponent*>& vDirtyComponents = objectCBDirtyQueue.collectDirtyItems();
+
+	for (size_t i = 0; i < vDirtyComponents.size(); i++)
+	{
+		SComponent* pComponent = vDirtyComponents[i];
+
+		pComponent->mtxComponentProps.lock();
+
+		if (pComponent->bWorldBoundsOutdated)
+		{
+			updateCullBounds(pComponent);
+		}
+
+		pComponent->mtxComponentProps.unlock();
+	}
+
+	bvh.rebuildIfDegraded();
+}
+
+size_t SRenderRegistry::getComponentCount() const
+{
+	return vMeshComponents.size() + vRuntimeMeshComponents.size();
+}
+
+bool SRenderRegistry::isComponentRegistered(SComponent* pComponent) const
+{
+	for (size_t i = 0; i < vMeshComponents.size(); i++)
+	{
+		if (vMeshComponents[i] == pComponent)
+		{
+			return true;
+		}
+	}
+
+	for (size_t i = 0; i < vRuntimeMeshComponents.size(); i++)
+	{
+		if (vRuntimeMeshComponents[i] == pComponent)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+SDirtyQueue<SComponent>& SRenderRegistry::getObjectCBDirtyQueue()
+{
+	return objectCBDirtyQueue;
+}
+
+void SRenderRegistry::addComponentAndChilds(SComponent* pComponent)
+{
+	if (pComponent->componentType == SComponentType::SCT_MESH)
+	{
+		pComponent->iRenderRegistryIndex = vMeshComponents.size();
+		vMeshComponents.push_back(static_cast<SMeshComponent*>(pComponent));
+		meshCullBounds.add();
+	}
+	else if (pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+	{
+		pComponent->iRenderRegistryIndex = vRuntimeMeshComponents.size();
+		vRuntimeMeshComponents.push_back(static_cast<SRuntimeMeshComponent*>(pComponent));
+		runtimeMeshCullBounds.add();
+	}
+
+	if (pComponent->componentType == SComponentType::SCT_MESH || pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+	{
+		pComponent->mtxComponentProps.lock();
+
+		pComponent->pObjectCBDirtyQueue = &objectCBDirtyQueue;
+		pComponent->markObjectCBDirty();
+		updateCullBounds(pComponent);
+
+		pComponent->mtxComponentProps.unlock();
+	}
+
+	for (size_t i = 0; i < pComponent->vChildComponents.size(); i++)
+	{
+		addComponentAndChilds(pComponent->vChildComponents[i]);
+	}
+}
+
+void SRenderRegistry::removeComponentAndChilds(SComponent* pComponent)
+{
+	if (pComponent->componentType == SComponentType::SCT_MESH)
+	{
+		const size_t iIndex = pComponent->iRenderRegistryIndex;
+
+		vMeshComponents[iIndex] = vMeshComponents.back();
+		vMeshComponents[iIndex]->iRenderRegistryIndex = iIndex;
+		vMeshComponents.pop_back();
+		meshCullBounds.removeSwap(iIndex);
+	}
+	else if (pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+	{
+		const size_t iIndex = pComponent->iRenderRegistryIndex;
+
+		vRuntimeMeshComponents[iIndex] = vRuntimeMeshComponents.back();
+		vRuntimeMeshComponents[iIndex]->iRenderRegistryIndex = iIndex;
+		vRuntimeMeshComponents.pop_back();
+		runtimeMeshCullBounds.removeSwap(iIndex);
+	}
+
+	if (pComponent->componentType == SComponentType::SCT_MESH || pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+	{
+		pComponent->mtxComponentProps.lock();
+
+		pComponent->pObjectCBDirtyQueue = nullptr;
+
+		bvh.removeProxy(pComponent->iBVHProxyId);
+		vBVHProxyComponents[pComponent->iBVHProxyId] = nullptr;
+		pComponent->iBVHProxyId = SBoundingVolumeHierarchy::iNoProxy;
+
+		pComponent->mtxComponentProps.unlock();
+
+		objectCBDirtyQueue.remove(pComponent);
+	}
+
+	for (size_t i = 0; i < pComponent->vChildComponents.size(); i++)
+	{
+		removeComponentAndChilds(pComponent->vChildComponents[i]);
+	}
+}
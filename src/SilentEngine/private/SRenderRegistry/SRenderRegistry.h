@@ -0,0 +1,140 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+
+// Custom
+#include "SilentEngine/Private/SDirtyQueue/SDirtyQueue.h"
+#include "SilentEngine/Private/SFrustumCuller/SFrustumCuller.h"
+#include "SilentEngine/Private/SBoundingVolumeHierarchy/SBoundingVolumeHierarchy.h"
+
+class SContainer;
+class SComponent;
+class SMeshComponent;
+class SRuntimeMeshComponent;
+
+//@@Class
+/*
+The class stores all spawned renderable components in flat arrays partitioned by the component type
+so that per-frame code (constant buffer updates, ray casts, collision tests) can iterate over them
+without walking the component tree, without dynamic_cast and without copying vectors.
+World space bounds of the components are also stored in a BVH for ray casts and collision queries.
+Access is guarded by SApplication::mtxDraw, the world space bounds, the BVH and the object CB dirty queue
+are also guarded by SLevel::mtxCollision (collision queries only lock mtxCollision).
+*/
+class SRenderRegistry
+{
+public:
+	//@@Function
+	SRenderRegistry() = default;
+	SRenderRegistry(const SRenderRegistry&) = delete;
+	SRenderRegistry& operator= (const SRenderRegistry&) = delete;
+
+	//@@Function
+	/*
+	* desc: adds all mesh and runtime mesh components of the container (including child components).
+	* remarks: added components are pushed to the object CB dirty queue.
+	*/
+	void addContainer    (SContainer* pContainer);
+	//@@Function
+	/*
+	* desc: removes all mesh and runtime mesh components of the container (including child components).
+	* remarks: the order of the other components may change.
+	*/
+	void removeContainer (SContainer* pContainer);
+
+	//@@Function
+	/*
+	* desc: returns all registered SMeshComponents.
+	*/
+	const std::vector<SMeshComponent*>&        getMeshComponents        () const;
+	//@@Function
+	/*
+	* desc: returns all registered SRuntimeMeshComponents.
+	*/
+	const std::vector<SRuntimeMeshComponent*>& getRuntimeMeshComponents () const;
+	//@@Function
+	/*
+	* desc: returns world space bounds of the registered SMeshComponents (same indices as in getMeshComponents()).
+	*/
+	const SCullBounds& getMeshCullBounds        () const;
+	//@@Function
+	/*
+	* desc: returns world space bounds of the registered SRuntimeMeshComponents (same indices as in getRuntimeMeshComponents()).
+	*/
+	const SCullBounds& getRuntimeMeshCullBounds () const;
+	//@@Function
+	/*
+	* desc: returns BVH with world space bounds of all registered components, use getBVHProxyComponent() to get
+	the component of the proxy.
+	* remarks: call updateDirtyBounds() before the query to make sure the bounds are up to date.
+	*/
+	const SBoundingVolumeHierarchy& getBVH () const;
+	//@@Function
+	/*
+	* desc: returns the component that owns the BVH proxy.
+	*/
+	SComponent* getBVHProxyComponent (uint32_t iProxy) const;
+	//@@Function
+	/*
+	* desc: recalculates world space bounds (cull bounds and BVH) of the registered component using its world matrix,
+	collision box and cull distance.
+	* remarks: expects the component's mtxComponentProps to be locked.
+	*/
+	void   updateCullBounds      (SComponent* pComponent);
+	//@@Function
+	/*
+	* desc: recalculates world space bounds of the components in the object CB dirty queue that were changed
+	since their bounds were calculated, rebuilds the BVH if it became too expensive.
+	* remarks: should only be called by the dirty queue consumer (while SLevel::mtxCollision is locked).
+	*/
+	void   updateDirtyBounds     ();
+	//@@Function
+	/*
+	* desc: returns the number of registered components (all types).
+	*/
+	size_t getComponentCount     () const;
+	//@@Function
+	/*
+	* desc: returns true if the component is registered, false otherwise.
+	* remarks: the component pointer is not dereferenced so it may point to a deleted component.
+	*/
+	bool   isComponentRegistered (SComponent* pComponent) const;
+	//@@Function
+	/*
+	* desc: returns the queue of registered components that need to update their object constant buffer.
+	*/
+	SDirtyQueue<SComponent>& getObjectCBDirtyQueue();
+
+private:
+
+	//@@Function
+	/*
+	* desc: adds the component and its childs.
+	*/
+	void addComponentAndChilds    (SComponent* pComponent);
+	//@@Function
+	/*
+	* desc: removes the component and its childs (swaps with the last element).
+	*/
+	void removeComponentAndChilds (SComponent* pComponent);
+
+
+	std::vector<SMeshComponent*>        vMeshComponents;
+	std::vector<SRuntimeMeshComponent*> vRuntimeMeshComponents;
+
+	SCullBounds meshCullBounds;
+	SCullBounds runtimeMeshCullBounds;
+
+	SBoundingVolumeHierarchy bvh;
+	std::vector<SComponent*> vBVHProxyComponents; // component of each proxy ID
+
+	SDirtyQueue<SComponent> objectCBDirtyQueue;
+};
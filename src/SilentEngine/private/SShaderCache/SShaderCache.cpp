@@ -0,0 +1,410 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SShaderCache.h"
+
+// STL
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <functional>
+
+namespace fs = std::filesystem;
+
+// Increase when the layout of the cache files or the way the keys are calculated changes.
+constexpr uint32_t SHADER_CACHE_VERSION = 1;
+constexpr char SHADER_CACHE_MAGIC[4] = { 'S', 'S', 'H', 'C' };
+
+struct SShaderCacheFileHeader
+{
+	char     magic[4];
+	uint32_t iVersion;
+	uint32_t iEntryType;
+	uint32_t iReserved;
+
+	uint64_t iKey;
+	uint64_t iDataSizeInBytes;
+	uint64_t iDataHash;
+};
+
+static_assert(sizeof(SShaderCacheFileHeader) == 40, "the layout of the shader cache header changed, increase SHADER_CACHE_VERSION and update this check");
+
+
+static bool readWholeFile(const fs::path& path, std::string& sOutData)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (file.is_open() == false)
+	{
+		return true;
+	}
+
+	sOutData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	return file.bad();
+}
+
+static void findIncludes(const std::string& sSource, std::vector<std::string>& vOutIncludes)
+{
+	size_t iLineStart = 0;
+
+	while (iLineStart < sSource.size())
+	{
+		size_t iLineEnd = sSource.find('\n', iLineStart);
+		if (iLineEnd == std::string::npos)
+		{
+			iLineEnd = sSource.size();
+		}
+
+		size_t i = iLineStart;
+		while (i < iLineEnd && (sSource[i] == ' ' || sSource[i] == '\t'))
+		{
+			i++;
+		}
+
+		if (sSource.compare(i, 8, "#include") == 0)
+		{
+			size_t iOpen = sSource.find_first_of("\"<", i + 8);
+
+			if (iOpen < iLineEnd)
+			{
+				char closing = sSource[iOpen] == '"' ? '"' : '>';
+				size_t iClose = sSource.find(closing, iOpen + 1);
+
+				if (iClose < iLineEnd)
+				{
+					vOutIncludes.push_back(sSource.substr(iOpen + 1, iClose - iOpen - 1));
+				}
+			}
+		}
+
+		iLineStart = iLineEnd + 1;
+	}
+}
+
+static bool hashShaderFile(const fs::path& pathToFile, std::vector<fs::path>& vHashedFiles, uint64_t& iHash)
+{
+	std::error_code error;
+	fs::path canonicalPath = fs::weakly_canonical(pathToFile, error);
+	if (error)
+	{
+		canonicalPath = pathToFile;
+	}
+
+	for (size_t i = 0; i < vHashedFiles.size(); i++)
+	{
+		if (vHashedFiles[i] == canonicalPath)
+		{
+			// Included twice (or include guard/pragma once).
+			return false;
+		}
+	}
+
+	vHashedFiles.push_back(canonicalPath);
+
+	std::string sSource;
+	if (readWholeFile(pathToFile, sSource))
+	{
+		return true;
+	}
+
+	iHash = SShaderCache::hashBytes(sSource.data(), sSource.size(), iHash);
+
+
+	// Included files.
+
+	std::vector<std::string> vIncludes;
+	findIncludes(sSource, vIncludes);
+
+	for (size_t i = 0; i < vIncludes.size(); i++)
+	{
+		iHash = SShaderCache::hashBytes(vIncludes[i].data(), vIncludes[i].size() + 1, iHash);
+
+		// If the file is not found only its name is hashed (the compiler will report it).
+		hashShaderFile(pathToFile.parent_path() / vIncludes[i], vHashedFiles, iHash);
+	}
+
+	return false;
+}
+
+bool SShaderCache::setCacheDirectory(const std::wstring& sPathToCacheDirectory)
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	std::error_code error;
+	fs::create_directories(sPathToCacheDirectory, error);
+	if (error || fs::is_directory(sPathToCacheDirectory, error) == false)
+	{
+		bEnabled = false;
+
+		return true;
+	}
+
+	this->sPathToCacheDirectory = sPathToCacheDirectory;
+	bEnabled = true;
+
+	return false;
+}
+
+void SShaderCache::setEnabled(bool bEnabled)
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	this->bEnabled = bEnabled && sPathToCacheDirectory.empty() == false;
+}
+
+bool SShaderCache::isEnabled() const
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	return bEnabled;
+}
+
+bool SShaderCache::computeShaderKey(const std::wstring& sPathToShader, const std::vector<std::pair<std::string, std::string>>& vDefines,
+	const std::wstring& sEntryPoint, const std::wstring& sShaderModel, bool bOptimized, uint64_t& iOutKey)
+{
+	uint64_t iHash = iHashSeed;
+
+	iHash = hashBytes(&SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION), iHash);
+	iHash = hashBytes(sEntryPoint.c_str(), (sEntryPoint.size() + 1) * sizeof(wchar_t), iHash);
+	iHash = hashBytes(sShaderModel.c_str(), (sShaderModel.size() + 1) * sizeof(wchar_t), iHash);
+
+	unsigned char iOptimized = bOptimized ? 1 : 0;
+	iHash = hashBytes(&iOptimized, sizeof(iOptimized), iHash);
+
+	for (size_t i = 0; i < vDefines.size(); i++)
+	{
+		iHash = hashBytes(vDefines[i].first.c_str(), vDefines[i].first.size() + 1, iHash);
+		iHash = hashBytes(vDefines[i].second.c_str(), vDefines[i].second.size() + 1, iHash);
+	}
+
+	std::vector<fs::path> vHashedFiles;
+	if (hashShaderFile(fs::path(sPathToShader), vHashedFiles, iHash))
+	{
+		return true;
+	}
+
+	iOutKey = iHash;
+
+	return false;
+}
+
+uint64_t SShaderCache::hashBytes(const void* pData, size_t iSizeInBytes, uint64_t iHash)
+{
+	const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+	for (size_t i = 0; i < iSizeInBytes; i++)
+	{
+		iHash ^= pBytes[i];
+		iHash *= 0x100000001b3ULL;
+	}
+
+	return iHash;
+}
+
+bool SShaderCache::load(SShaderCacheEntryType type, uint64_t iKey, std::vector<char>& vOutData)
+{
+	bool bHit = false;
+
+	std::wstring sPathToEntry;
+	{
+		std::lock_guard<std::mutex> guard(mtxCache);
+
+		if (bEnabled)
+		{
+			sPathToEntry = getEntryPath(type, iKey);
+		}
+	}
+
+	if (sPathToEntry.empty() == false)
+	{
+		std::string sFileData;
+
+		if (readWholeFile(sPathToEntry, sFileData) == false && sFileData.size() >= sizeof(SShaderCacheFileHeader))
+		{
+			SShaderCacheFileHeader header;
+			std::memcpy(&header, sFileData.data(), sizeof(SShaderCacheFileHeader));
+
+			const char* pData = sFileData.data() + sizeof(SShaderCacheFileHeader);
+
+			if (std::memcmp(header.magic, SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC)) == 0 && header.iVersion == SHADER_CACHE_VERSION
+				&& header.iEntryType == static_cast<uint32_t>(type) && header.iKey == iKey
+				&& header.iDataSizeInBytes == sFileData.size() - sizeof(SShaderCacheFileHeader)
+				&& header.iDataHash == hashBytes(pData, static_cast<size_t>(header.iDataSizeInBytes)))
+			{
+				vOutData.assign(pData, pData + header.iDataSizeInBytes);
+				bHit = true;
+			}
+		}
+	}
+
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	if (bHit)
+	{
+		if (type == SShaderCacheEntryType::SCET_SHADER)
+		{
+			stats.iShaderHits++;
+		}
+		else
+		{
+			stats.iPSOHits++;
+		}
+
+		stats.iBytesRead += vOutData.size();
+	}
+	else
+	{
+		if (type == SShaderCacheEntryType::SCET_SHADER)
+		{
+			stats.iShaderMisses++;
+		}
+		else
+		{
+			stats.iPSOMisses++;
+		}
+	}
+
+	return bHit == false;
+}
+
+bool SShaderCache::store(SShaderCacheEntryType type, uint64_t iKey, const void* pData, size_t iSizeInBytes)
+{
+	std::wstring sPathToEntry;
+	{
+		std::lock_guard<std::mutex> guard(mtxCache);
+
+		if (bEnabled == false)
+		{
+			return true;
+		}
+
+		sPathToEntry = getEntryPath(type, iKey);
+	}
+
+	SShaderCacheFileHeader header;
+	std::memset(&header, 0, sizeof(SShaderCacheFileHeader));
+
+	std::memcpy(header.magic, SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC));
+	header.iVersion         = SHADER_CACHE_VERSION;
+	header.iEntryType       = static_cast<uint32_t>(type);
+	header.iKey             = iKey;
+	header.iDataSizeInBytes = iSizeInBytes;
+	header.iDataHash        = hashBytes(pData, iSizeInBytes);
+
+
+	// Write to a temporary file first so that readers never see a partially written entry.
+
+	const fs::path pathToEntry    = sPathToEntry;
+	const fs::path pathToTempFile = sPathToEntry + L".tmp" + std::to_wstring(iTempFileCounter.fetch_add(1))
+		+ L"_" + std::to_wstring(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+	std::ofstream file(pathToTempFile, std::ios::binary | std::ios::trunc);
+	if (file.is_open() == false)
+	{
+		return true;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(SShaderCacheFileHeader));
+	file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(iSizeInBytes));
+
+	const bool bWriteFailed = file.fail();
+
+	file.close();
+
+	std::error_code error;
+
+	if (bWriteFailed)
+	{
+		fs::remove(pathToTempFile, error);
+		return true;
+	}
+
+	fs::rename(pathToTempFile, pathToEntry, error);
+	if (error)
+	{
+		fs::remove(pathToTempFile, error);
+		return true;
+	}
+
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	stats.iBytesWritten += sizeof(SShaderCacheFileHeader) + iSizeInBytes;
+
+	return false;
+}
+
+void SShaderCache::onPSORejected()
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	stats.iPSORejected++;
+}
+
+bool SShaderCache::clear()
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	if (sPathToCacheDirectory.empty())
+	{
+		return false;
+	}
+
+	// Collect first, removing files while iterating the directory is not safe.
+
+	std::vector<fs::path> vEntries;
+	std::error_code error;
+
+	for (fs::directory_iterator it(sPathToCacheDirectory, error); !error && it != fs::directory_iterator(); it.increment(error))
+	{
+		const std::wstring sExtension = it->path().extension().wstring();
+
+		if (sExtension == L".dxil" || sExtension == L".pso")
+		{
+			vEntries.push_back(it->path());
+		}
+	}
+
+	bool bError = static_cast<bool>(error);
+
+	for (size_t i = 0; i < vEntries.size(); i++)
+	{
+		fs::remove(vEntries[i], error);
+
+		bError = bError || static_cast<bool>(error);
+	}
+
+	return bError;
+}
+
+SShaderCacheStats SShaderCache::getStats()
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	return stats;
+}
+
+void SShaderCache::resetStats()
+{
+	std::lock_guard<std::mutex> guard(mtxCache);
+
+	stats = SShaderCacheStats();
+}
+
+std::wstring SShaderCache::getEntryPath(SShaderCacheEntryType type, uint64_t iKey) const
+{
+	const wchar_t* vHexDigits = L"0123456789abcdef";
+
+	std::wstring sName(16, L'0');
+	for (size_t i = 0; i < 16; i++)
+	{
+		sName[15 - i] = vHexDigits[(iKey >> (i * 4)) & 0xF];
+	}
+
+	return (fs::path(sPathToCacheDirectory) / (sName + (type == SShaderCacheEntryType::SCET_SHADER ? L".dxil" : L".pso"))).wstring();
+}
@@ -0,0 +1,155 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+
+//@@Class
+/*
+Type of the data stored in the SShaderCache.
+*/
+enum class SShaderCacheEntryType
+{
+	SCET_SHADER, // compiled shader (DXIL)
+	SCET_PSO     // cached blob of the pipeline state object (driver specific)
+};
+
+
+//@@Class
+/*
+Statistics of the SShaderCache (since the cache was created or the stats were reset).
+*/
+struct SShaderCacheStats
+{
+	size_t   iShaderHits    = 0;
+	size_t   iShaderMisses  = 0;
+
+	size_t   iPSOHits       = 0;
+	size_t   iPSOMisses     = 0;
+	size_t   iPSORejected   = 0; // cached PSO blobs that were rejected by the driver (also counted as hits)
+
+	uint64_t iBytesRead     = 0;
+	uint64_t iBytesWritten  = 0;
+};
+
+
+//@@Class
+/*
+The class stores compiled shaders and pipeline state blobs on the disk so that they don't need to be compiled/built again.
+Each entry is a file named by its 64 bit key, shader keys are made from the source file, its includes, the defines,
+the entry point, the shader model and the optimization flag (see computeShaderKey()).
+Thread-safe.
+*/
+class SShaderCache
+{
+public:
+	//@@Function
+	SShaderCache() = default;
+	SShaderCache(const SShaderCache&) = delete;
+	SShaderCache& operator= (const SShaderCache&) = delete;
+
+	//@@Function
+	/*
+	* desc: sets the directory to store the cache files in (created if it does not exist) and enables the cache.
+	* return: false if successful, true otherwise (the cache stays disabled).
+	*/
+	bool     setCacheDirectory (const std::wstring& sPathToCacheDirectory);
+	//@@Function
+	/*
+	* desc: enables/disables the cache, a disabled cache always misses and never writes.
+	*/
+	void     setEnabled        (bool bEnabled);
+	//@@Function
+	/*
+	* desc: returns true if the cache is enabled.
+	*/
+	bool     isEnabled         () const;
+
+	//@@Function
+	/*
+	* desc: calculates the key of the compiled shader.
+	* param "vDefines": pairs of the define name and value.
+	* param "bOptimized": true if the shader is compiled with optimizations (without debug info).
+	* return: false if successful, true if the shader file cannot be read.
+	* remarks: the content of the files included via #include is also hashed (recursively, relative to the including file).
+	*/
+	static bool computeShaderKey(const std::wstring& sPathToShader, const std::vector<std::pair<std::string, std::string>>& vDefines,
+		const std::wstring& sEntryPoint, const std::wstring& sShaderModel, bool bOptimized, uint64_t& iOutKey);
+	//@@Function
+	/*
+	* desc: returns the 64 bit FNV-1a hash of the data, pass the previous hash as iHash to hash multiple buffers.
+	*/
+	static uint64_t hashBytes  (const void* pData, size_t iSizeInBytes, uint64_t iHash = iHashSeed);
+
+	//@@Function
+	/*
+	* desc: reads the cached data.
+	* return: false if the entry was found (hit), true otherwise (miss).
+	*/
+	bool     load              (SShaderCacheEntryType type, uint64_t iKey, std::vector<char>& vOutData);
+	//@@Function
+	/*
+	* desc: writes the data to the cache (replaces the old entry).
+	* return: false if successful, true otherwise (failing to write the cache is not an error for the caller).
+	*/
+	bool     store             (SShaderCacheEntryType type, uint64_t iKey, const void* pData, size_t iSizeInBytes);
+	//@@Function
+	/*
+	* desc: should be called when the cached PSO blob was rejected by the driver (for example, after a driver update).
+	*/
+	void     onPSORejected     ();
+	//@@Function
+	/*
+	* desc: removes all cache files.
+	* return: false if successful, true otherwise.
+	*/
+	bool     clear             ();
+
+	//@@Function
+	/*
+	* desc: returns the statistics.
+	*/
+	SShaderCacheStats getStats ();
+	//@@Function
+	/*
+	* desc: sets all statistics to zero.
+	*/
+	void     resetStats        ();
+
+
+	// Initial value of the FNV-1a hash.
+	static constexpr uint64_t iHashSeed = 0xcbf29ce484222325ULL;
+
+private:
+
+	//@@Function
+	/*
+	* desc: returns the path to the file of the entry (should be called under mtxCache).
+	*/
+	std::wstring getEntryPath  (SShaderCacheEntryType type, uint64_t iKey) const;
+
+
+	mutable std::mutex mtxCache;
+
+	std::wstring sPathToCacheDirectory;
+
+	SShaderCacheStats stats;
+
+	// Makes temporary file names unique when several threads write the same entry.
+	std::atomic<uint64_t> iTempFileCounter{0};
+
+	bool         bEnabled = false;
+};
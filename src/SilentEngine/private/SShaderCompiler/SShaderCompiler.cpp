@@ -0,0 +1,132 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SShaderCompiler.h"
+
+// STL
+#include <algorithm>
+
+// Custom
+#include "SilentEngine/Private/SMiscHelpers/SMiscHelpers.h"
+#include "SilentEngine/Private/SError/SError.h"
+
+SShaderCompiler::~SShaderCompiler()
+{
+	stop();
+}
+
+void SShaderCompiler::start(size_t iThreadCount, SShaderCache* pShaderCache)
+{
+	stop();
+
+	if (iThreadCount == 0)
+	{
+		// Leave one core for the calling thread (it usually prepares other resources while shaders are compiled).
+		iThreadCount = std::max<size_t>(1, std::thread::hardware_concurrency()) - 1;
+		iThreadCount = std::max<size_t>(1, iThreadCount);
+	}
+
+	std::lock_guard<std::mutex> guard(mtxJobs);
+
+	this->pShaderCache = pShaderCache;
+	bStop = false;
+
+	for (size_t i = 0; i < iThreadCount; i++)
+	{
+		vWorkers.push_back(std::thread(&SShaderCompiler::workerThread, this));
+	}
+}
+
+void SShaderCompiler::stop()
+{
+	std::vector<std::thread> vStoppedWorkers;
+
+	{
+		std::lock_guard<std::mutex> guard(mtxJobs);
+
+		bStop = true;
+
+		vStoppedWorkers.swap(vWorkers);
+	}
+
+	cvJobsQueued.notify_all();
+
+	for (size_t i = 0; i < vStoppedWorkers.size(); i++)
+	{
+		vStoppedWorkers[i].join();
+	}
+}
+
+std::shared_future<ATL::CComPtr<IDxcBlob>> SShaderCompiler::compileShader(const SShaderCompileRequest& request)
+{
+	SShaderCache* pCache = nullptr;
+	{
+		std::lock_guard<std::mutex> guard(mtxJobs);
+		pCache = pShaderCache;
+	}
+
+	return submit<ATL::CComPtr<IDxcBlob>>([request, pCache]() -> ATL::CComPtr<IDxcBlob>
+	{
+		std::vector<D3D_SHADER_MACRO> vMacros;
+		for (size_t i = 0; i < request.vDefines.size(); i++)
+		{
+			vMacros.push_back({ request.vDefines[i].first.c_str(), request.vDefines[i].second.c_str() });
+		}
+		vMacros.push_back({ nullptr, nullptr });
+
+		try
+		{
+			return SMiscHelpers::compileShader(request.sPathToShader, vMacros.data(), request.sEntryPoint, request.sShaderModel,
+				request.bCompileInRelease, pCache);
+		}
+		catch (const DXException&)
+		{
+			// The error was already shown and logged, don't rethrow it from the future
+			// so that one failed shader does not fail the other shaders that are waited together.
+			return nullptr;
+		}
+	});
+}
+
+size_t SShaderCompiler::getThreadCount()
+{
+	std::lock_guard<std::mutex> guard(mtxJobs);
+
+	return vWorkers.size();
+}
+
+size_t SShaderCompiler::getQueuedJobCount()
+{
+	std::lock_guard<std::mutex> guard(mtxJobs);
+
+	return vJobs.size();
+}
+
+void SShaderCompiler::workerThread()
+{
+	std::unique_lock<std::mutex> lock(mtxJobs);
+
+	while (true)
+	{
+		cvJobsQueued.wait(lock, [this]() { return bStop || vJobs.size() > 0; });
+
+		if (vJobs.size() == 0)
+		{
+			// Stopped and all queued jobs are done.
+			return;
+		}
+
+		std::function<void()> job = std::move(vJobs.front());
+		vJobs.pop_front();
+
+		lock.unlock();
+
+		job();
+
+		lock.lock();
+	}
+}
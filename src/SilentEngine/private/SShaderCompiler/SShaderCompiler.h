@@ -0,0 +1,144 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+#include <utility>
+
+// DXC
+#include "dxc/dxcapi.h"
+#include <atlbase.h> // Common COM helpers.
+
+class SShaderCache;
+
+
+//@@Class
+/*
+One shader (entry point + permutation) to compile.
+*/
+struct SShaderCompileRequest
+{
+	std::wstring sPathToShader;
+	std::vector<std::pair<std::string, std::string>> vDefines; // name and value
+	std::wstring sEntryPoint;
+	std::wstring sShaderModel;
+	bool         bCompileInRelease = false;
+};
+
+
+//@@Class
+/*
+The class compiles shaders on a pool of worker threads, each compile request returns a future
+so that the caller only waits when the compiled shader is actually needed (usually to create a PSO).
+Independent entry points and permutations of the same file are compiled concurrently.
+*/
+class SShaderCompiler
+{
+public:
+	//@@Function
+	SShaderCompiler() = default;
+	SShaderCompiler(const SShaderCompiler&) = delete;
+	SShaderCompiler& operator= (const SShaderCompiler&) = delete;
+	~SShaderCompiler();
+
+	//@@Function
+	/*
+	* desc: starts the worker threads.
+	* param "iThreadCount": number of worker threads, pass 0 to use all cores except for one.
+	* param "pShaderCache": (optional) cache used for all compiled shaders.
+	*/
+	void   start              (size_t iThreadCount = 0, SShaderCache* pShaderCache = nullptr);
+	//@@Function
+	/*
+	* desc: finishes the queued jobs and stops the worker threads.
+	* remarks: after this function returns new jobs are executed on the calling thread.
+	*/
+	void   stop               ();
+
+	//@@Function
+	/*
+	* desc: queues the shader for compilation.
+	* return: future with the compiled shader (nullptr if the compilation failed, the error is already shown).
+	*/
+	std::shared_future<ATL::CComPtr<IDxcBlob>> compileShader (const SShaderCompileRequest& request);
+	//@@Function
+	/*
+	* desc: queues the job to run on a worker thread (or runs it right away if the workers are not started).
+	* return: future with the result of the job.
+	*/
+	template<typename T>
+	std::shared_future<T> submit(std::function<T()> job);
+
+	//@@Function
+	/*
+	* desc: returns the number of worker threads.
+	*/
+	size_t getThreadCount     ();
+	//@@Function
+	/*
+	* desc: returns the number of jobs that are not started yet.
+	*/
+	size_t getQueuedJobCount  ();
+
+private:
+
+	//@@Function
+	/*
+	* desc: worker thread function.
+	*/
+	void workerThread         ();
+
+
+	std::vector<std::thread> vWorkers;
+
+	std::mutex              mtxJobs;
+	std::condition_variable cvJobsQueued;
+
+	std::deque<std::function<void()>> vJobs;
+
+	SShaderCache* pShaderCache = nullptr;
+
+	bool   bStop = false;
+};
+
+
+template<typename T>
+std::shared_future<T> SShaderCompiler::submit(std::function<T()> job)
+{
+	// packaged_task is not copyable and std::function needs a copyable callable.
+	std::shared_ptr<std::packaged_task<T()>> pTask = std::make_shared<std::packaged_task<T()>>(std::move(job));
+	std::shared_future<T> future = pTask->get_future().share();
+
+	std::unique_lock<std::mutex> lock(mtxJobs);
+
+	if (vWorkers.size() == 0 || bStop)
+	{
+		lock.unlock();
+
+		(*pTask)();
+
+		return future;
+	}
+
+	vJobs.push_back([pTask]() { (*pTask)(); });
+
+	lock.unlock();
+
+	cvJobsQueued.notify_one();
+
+	return future;
+}
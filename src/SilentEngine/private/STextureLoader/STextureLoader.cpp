@@ -0,0 +1,520 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "STextureLoader.h"
+
+// STL
+#include <memory>
+#include <algorithm>
+
+// DirectX
+#pragma warning(push, 0) // disable warnings from this header
+#include "SilentEngine/private/d3dx12.h"
+#pragma warning(pop)
+
+// Custom
+#include "SilentEngine/Private/SError/SError.h"
+#include "SilentEngine/Private/SDDSTexture/SDDSTexture.h"
+#include "SilentEngine/Private/SMemoryMappedFile/SMemoryMappedFile.h"
+#include "SilentEngine/Public/SMaterial/SMaterial.h"
+
+static DXGI_FORMAT getDXGIFormat(SDDSFormat format)
+{
+	// SDDSFormat values are the same as in DXGI_FORMAT.
+	return static_cast<DXGI_FORMAT>(format);
+}
+
+STextureLoader::~STextureLoader()
+{
+	stop();
+}
+
+bool STextureLoader::init(ID3D12Device* pDevice, size_t iThreadCount)
+{
+	this->pDevice = pDevice;
+
+	D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+	queueDesc.Type  = D3D12_COMMAND_LIST_TYPE_COPY;
+	queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+
+	HRESULT hresult = pDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(pCopyQueue.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		SError::showErrorMessageBoxAndLog(hresult);
+		return true;
+	}
+
+	hresult = pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(pCopyFence.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		SError::showErrorMessageBoxAndLog(hresult);
+		return true;
+	}
+
+
+	if (iThreadCount == 0)
+	{
+		// Most of the time is spent waiting for the disk, a couple of threads is enough.
+		iThreadCount = 2;
+	}
+
+	bStop = false;
+
+	for (size_t i = 0; i < iThreadCount; i++)
+	{
+		vIOThreads.push_back(std::thread(&STextureLoader::ioThread, this));
+	}
+
+	return false;
+}
+
+void STextureLoader::stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(mtxLoader);
+		bStop = true;
+	}
+
+	cvTexturesQueued.notify_all();
+
+	for (size_t i = 0; i < vIOThreads.size(); i++)
+	{
+		vIOThreads[i].join();
+	}
+
+	vIOThreads.clear();
+
+
+	// Wait for the submitted uploads (the upload heaps and the command lists should not be released while they are used).
+
+	std::lock_guard<std::mutex> guard(mtxLoader);
+
+	if (vUploads.size() > 0)
+	{
+		waitForFence(iLastFenceValue);
+
+		vUploads.clear();
+	}
+
+	vFailedLoads.clear();
+	vTexturesToLoad.clear();
+}
+
+void STextureLoader::loadTexture(STextureInternal* pTexture)
+{
+	{
+		std::lock_guard<std::mutex> guard(mtxLoader);
+		vTexturesToLoad.push_back(pTexture);
+	}
+
+	cvTexturesQueued.notify_one();
+}
+
+void STextureLoader::collectUploadedTextures(std::vector<SLoadedTexture>& vOutTextures)
+{
+	std::lock_guard<std::mutex> guard(mtxLoader);
+
+	vOutTextures.insert(vOutTextures.end(), vFailedLoads.begin(), vFailedLoads.end());
+	vFailedLoads.clear();
+
+	if (vUploads.size() == 0)
+	{
+		return;
+	}
+
+	UINT64 iCompletedFenceValue = pCopyFence->GetCompletedValue();
+
+	for (size_t i = 0; i < vUploads.size(); )
+	{
+		if (vUploads[i].iFenceValue <= iCompletedFenceValue)
+		{
+			vOutTextures.push_back(vUploads[i].loadedTexture);
+
+			vUploads.erase(vUploads.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void STextureLoader::cancelTexture(STextureInternal* pTexture)
+{
+	std::unique_lock<std::mutex> lock(mtxLoader);
+
+	for (size_t i = 0; i < vTexturesToLoad.size(); i++)
+	{
+		if (vTexturesToLoad[i] == pTexture)
+		{
+			vTexturesToLoad.erase(vTexturesToLoad.begin() + i);
+			return;
+		}
+	}
+
+
+	// Wait until the I/O thread is finished with this texture.
+
+	cvTextureProcessed.wait(lock, [&]()
+	{
+		return std::find(vTexturesInIO.begin(), vTexturesInIO.end(), pTexture) == vTexturesInIO.end();
+	});
+
+
+	for (size_t i = 0; i < vUploads.size(); i++)
+	{
+		if (vUploads[i].loadedTexture.pTexture == pTexture)
+		{
+			waitForFence(vUploads[i].iFenceValue);
+
+			vUploads.erase(vUploads.begin() + i);
+
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < vFailedLoads.size(); i++)
+	{
+		if (vFailedLoads[i].pTexture == pTexture)
+		{
+			vFailedLoads.erase(vFailedLoads.begin() + i);
+
+			break;
+		}
+	}
+}
+
+size_t STextureLoader::getPendingTextureCount()
+{
+	std::lock_guard<std::mutex> guard(mtxLoader);
+
+	return vTexturesToLoad.size() + vTexturesInIO.size() + vUploads.size();
+}
+
+void STextureLoader::setResidencyTexture(size_t iResidencyId, STextureInternal* pTexture)
+{
+	if (iResidencyId >= vResidencyTextures.size())
+	{
+		vResidencyTextures.resize(iResidencyId + 1, nullptr);
+	}
+
+	vResidencyTextures[iResidencyId] = pTexture;
+}
+
+bool STextureLoader::requestResidentMips(size_t iResidencyId, size_t iMostDetailedMip)
+{
+	if (iResidencyId >= vResidencyTextures.size() || vResidencyTextures[iResidencyId] == nullptr || vIOThreads.size() == 0)
+	{
+		return true;
+	}
+
+	// The texture is reloaded from the disk with the new mip range (even to evict mips)
+	// so that the new resource has only the memory it needs.
+	vResidencyTextures[iResidencyId]->iLoadMip = iMostDetailedMip;
+
+	loadTexture(vResidencyTextures[iResidencyId]);
+
+	return false;
+}
+
+size_t STextureLoader::getMinResidentMip(const SDDSTextureDesc& desc)
+{
+	// Block compressed textures need the size of the most detailed mip to be a multiple of 4,
+	// this is true for any mip range of power of 2 textures (that has mips not smaller than 4).
+	bool bWidthIsPowerOf2  = (desc.iWidth & (desc.iWidth - 1)) == 0;
+	bool bHeightIsPowerOf2 = (desc.iHeight & (desc.iHeight - 1)) == 0;
+
+	if (bWidthIsPowerOf2 == false || bHeightIsPowerOf2 == false || desc.iWidth < iAlwaysResidentMipSize || desc.iHeight < iAlwaysResidentMipSize)
+	{
+		return 0;
+	}
+
+	return SDDSTexture::getFirstMipNotBiggerThan(desc, iAlwaysResidentMipSize);
+}
+
+void STextureLoader::ioThread()
+{
+	std::unique_lock<std::mutex> lock(mtxLoader);
+
+	while (true)
+	{
+		cvTexturesQueued.wait(lock, [&]() { return bStop || vTexturesToLoad.size() > 0; });
+
+		if (bStop)
+		{
+			return;
+		}
+
+		STextureInternal* pTexture = vTexturesToLoad.front();
+		vTexturesToLoad.pop_front();
+
+		vTexturesInIO.push_back(pTexture);
+
+
+		// Read the file and record the upload without holding the mutex.
+
+		lock.unlock();
+
+		STextureUpload upload;
+		upload.loadedTexture.pTexture = pTexture;
+
+		bool bError = recordUpload(pTexture, upload);
+
+		lock.lock();
+
+
+		if (bError == false)
+		{
+			// Submit under the mutex so that fence values are signaled in the same order as they are assigned.
+
+			ID3D12CommandList* vCommandLists[] = { upload.pCommandList.Get() };
+			pCopyQueue->ExecuteCommandLists(1, vCommandLists);
+
+			HRESULT hresult = pCopyQueue->Signal(pCopyFence.Get(), iLastFenceValue + 1);
+			if (FAILED(hresult))
+			{
+				// The fence will not reach this value (usually the device was removed).
+				upload.loadedTexture.sErrorMessage = SError::logError(hresult);
+				bError = true;
+			}
+			else
+			{
+				iLastFenceValue++;
+
+				upload.iFenceValue = iLastFenceValue;
+
+				vUploads.push_back(upload);
+			}
+		}
+
+		if (bError)
+		{
+			SLoadedTexture failedLoad;
+			failedLoad.pTexture      = pTexture;
+			failedLoad.bFailed       = true;
+			failedLoad.sErrorMessage = upload.loadedTexture.sErrorMessage;
+
+			vFailedLoads.push_back(failedLoad);
+		}
+
+		vTexturesInIO.erase(std::find(vTexturesInIO.begin(), vTexturesInIO.end(), pTexture));
+
+		cvTextureProcessed.notify_all();
+	}
+}
+
+bool STextureLoader::recordUpload(STextureInternal* pTexture, STextureUpload& outUpload)
+{
+	// Runs on the I/O thread: errors are only logged (SError::showErrorMessageBoxAndLog() would throw on this thread),
+	// the load is then returned from collectUploadedTextures() as failed.
+
+	// Map the file: the subresources point straight into the mapping, the pixel data is only copied to the upload heap.
+
+	SMemoryMappedFile textureFile;
+	if (textureFile.open(pTexture->sPathToTexture))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError("failed to open the texture file.");
+		return true;
+	}
+
+	SDDSTextureDesc desc;
+	size_t iHeaderSize = 0;
+	std::vector<SDDSMipRegion> vRegions;
+
+	if (SDDSTexture::parseLayout(textureFile.getData(), textureFile.getSize(), desc, iHeaderSize, vRegions))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError("failed to read the texture (the file is not a .dds file, the format is not supported or the file is corrupted).");
+		return true;
+	}
+
+	if (pTexture->ddsDesc.iWidth == 0)
+	{
+		// First load.
+
+		// Check if the texture size is x4.
+
+		if (desc.iWidth % 4 != 0 || desc.iHeight % 4 != 0 || desc.iWidth != desc.iHeight)
+		{
+			outUpload.loadedTexture.sErrorMessage = SError::logError("the texture size should be a multiple of 4.");
+			return true;
+		}
+
+		pTexture->ddsDesc = desc;
+		pTexture->iMinResidentMip = getMinResidentMip(desc);
+	}
+	else if (desc.iMipCount != pTexture->ddsDesc.iMipCount || desc.iWidth != pTexture->ddsDesc.iWidth
+		|| desc.iHeight != pTexture->ddsDesc.iHeight || desc.format != pTexture->ddsDesc.format)
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError("the texture file was changed after the texture was loaded.");
+		return true;
+	}
+
+	size_t iMostDetailedMip = pTexture->iLoadMip;
+	if (iMostDetailedMip > pTexture->iMinResidentMip)
+	{
+		iMostDetailedMip = pTexture->iMinResidentMip;
+	}
+
+
+
+	// Create the texture resource (in the COPY_DEST state) with mips in range [iMostDetailedMip, mip count).
+
+	UINT64 iWidth  = SDDSTexture::getMipDimension(desc.iWidth, iMostDetailedMip);
+	UINT   iHeight = static_cast<UINT>(SDDSTexture::getMipDimension(desc.iHeight, iMostDetailedMip));
+	UINT16 iMipCount = static_cast<UINT16>(desc.iMipCount - iMostDetailedMip);
+
+	CD3DX12_RESOURCE_DESC texDesc;
+	if (desc.iDepth > 1)
+	{
+		texDesc = CD3DX12_RESOURCE_DESC::Tex3D(getDXGIFormat(desc.format), iWidth, iHeight,
+			static_cast<UINT16>(SDDSTexture::getMipDimension(desc.iDepth, iMostDetailedMip)), iMipCount);
+	}
+	else
+	{
+		texDesc = CD3DX12_RESOURCE_DESC::Tex2D(getDXGIFormat(desc.format), iWidth, iHeight, static_cast<UINT16>(desc.iArraySize), iMipCount);
+	}
+
+	CD3DX12_HEAP_PROPERTIES defaultHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+
+	HRESULT hresult = pDevice->CreateCommittedResource(
+		&defaultHeapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&texDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(outUpload.loadedTexture.pResource.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError(hresult);
+		return true;
+	}
+
+	outUpload.loadedTexture.iMostDetailedMip = iMostDetailedMip;
+
+	ID3D12Resource* pResource = outUpload.loadedTexture.pResource.Get();
+
+
+
+	// Subresources of the mips we need (regions are stored slice by slice, the same order as the subresource indices).
+
+	std::vector<D3D12_SUBRESOURCE_DATA> vSubresources;
+
+	for (size_t i = 0; i < vRegions.size(); i++)
+	{
+		if (vRegions[i].iMip < iMostDetailedMip)
+		{
+			continue;
+		}
+
+		D3D12_SUBRESOURCE_DATA subresource = {};
+		subresource.pData      = textureFile.getData() + iHeaderSize + vRegions[i].iOffset;
+		subresource.RowPitch   = static_cast<LONG_PTR>(vRegions[i].iRowPitch);
+		subresource.SlicePitch = static_cast<LONG_PTR>(vRegions[i].iRowPitch * vRegions[i].iRowCount);
+
+		vSubresources.push_back(subresource);
+	}
+
+
+
+	// Get Resource size.
+
+	D3D12_RESOURCE_ALLOCATION_INFO info = pDevice->GetResourceAllocationInfo(0, 1, &texDesc);
+	outUpload.loadedTexture.iSizeInBytesOnGPU = info.SizeInBytes + info.Alignment;
+
+
+
+	// Create the upload heap.
+
+	UINT iSubresourceCount = static_cast<UINT>(vSubresources.size());
+	UINT64 iUploadSize = GetRequiredIntermediateSize(pResource, 0, iSubresourceCount);
+
+	CD3DX12_HEAP_PROPERTIES uploadHeapProps(D3D12_HEAP_TYPE_UPLOAD);
+	CD3DX12_RESOURCE_DESC buf = CD3DX12_RESOURCE_DESC::Buffer(iUploadSize);
+
+	hresult = pDevice->CreateCommittedResource(
+		&uploadHeapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&buf,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(outUpload.pUploadHeap.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError(hresult);
+		return true;
+	}
+
+
+
+	// Record the copy.
+	// No transition at the end: resources used on the copy queue decay to the COMMON state
+	// and are then implicitly promoted to the shader resource state on the direct queue.
+
+	hresult = pDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(outUpload.pCommandAllocator.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError(hresult);
+		return true;
+	}
+
+	hresult = pDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, outUpload.pCommandAllocator.Get(), nullptr,
+		IID_PPV_ARGS(outUpload.pCommandList.GetAddressOf()));
+	if (FAILED(hresult))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError(hresult);
+		return true;
+	}
+
+	UpdateSubresources(outUpload.pCommandList.Get(), pResource, outUpload.pUploadHeap.Get(),
+		0, 0, iSubresourceCount, vSubresources.data());
+
+	hresult = outUpload.pCommandList->Close();
+	if (FAILED(hresult))
+	{
+		outUpload.loadedTexture.sErrorMessage = SError::logError(hresult);
+		return true;
+	}
+
+	return false;
+}
+
+void STextureLoader::waitForFence(UINT64 iFenceValue)
+{
+	if (pCopyFence->GetCompletedValue() >= iFenceValue)
+	{
+		return;
+	}
+
+	// Called under mtxLoader: errors are only logged (a message box would block the I/O threads),
+	// the fence is then polled because the resources of the upload should not be released before the GPU is finished with them.
+
+	HANDLE eventHandle = CreateEventEx(nullptr, FALSE, FALSE, EVENT_ALL_ACCESS);
+	if (eventHandle == NULL)
+	{
+		SError::logError("failed to create an event, error code: " + std::to_string(GetLastError()));
+	}
+	else
+	{
+		HRESULT hresult = pCopyFence->SetEventOnCompletion(iFenceValue, eventHandle);
+		if (SUCCEEDED(hresult))
+		{
+			WaitForSingleObject(eventHandle, INFINITE);
+			CloseHandle(eventHandle);
+
+			return;
+		}
+
+		SError::logError(hresult);
+		CloseHandle(eventHandle);
+	}
+
+	// Returns UINT64_MAX if the device was removed.
+	while (pCopyFence->GetCompletedValue() < iFenceValue)
+	{
+		std::this_thread::yield();
+	}
+}
@@ -0,0 +1,182 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// DirectX
+#include <wrl.h> // smart pointers
+#include <d3d12.h>
+
+// Custom
+#include "SilentEngine/Private/STextureResidency/STextureResidency.h"
+
+class STextureInternal;
+struct SDDSTextureDesc;
+
+
+//@@Class
+/*
+Result of one STextureLoader::loadTexture() call.
+*/
+struct SLoadedTexture
+{
+	STextureInternal* pTexture = nullptr;
+
+	// New resource with mips in range [iMostDetailedMip, mip count) of the texture file (in the COMMON state).
+	Microsoft::WRL::ComPtr<ID3D12Resource> pResource;
+	size_t             iMostDetailedMip   = 0;
+	unsigned long long iSizeInBytesOnGPU  = 0;
+
+	bool               bFailed            = false;
+	std::string        sErrorMessage;     // if failed, the error is logged on the I/O thread
+};
+
+
+//@@Class
+/*
+The class loads DDS textures in the background: file reading and DDS parsing are done on the I/O threads,
+the upload is submitted to the copy queue and the texture is returned from collectUploadedTextures()
+once the copy queue fence passed its upload.
+Textures can be loaded with only a range of their mips, the class is used as a backend of the STextureResidencyManager.
+*/
+class STextureLoader : public STextureResidencyBackend
+{
+public:
+	// Mips that are not bigger than this are always resident (see getMinResidentMip()).
+	static constexpr size_t iAlwaysResidentMipSize = 64;
+
+	//@@Function
+	STextureLoader() = default;
+	STextureLoader(const STextureLoader&) = delete;
+	STextureLoader& operator= (const STextureLoader&) = delete;
+	~STextureLoader();
+
+	//@@Function
+	/*
+	* desc: creates the copy queue and starts the I/O threads.
+	* param "iThreadCount": number of I/O threads, pass 0 to use the default value.
+	* return: false if successful, true otherwise.
+	*/
+	bool   init                    (ID3D12Device* pDevice, size_t iThreadCount = 0);
+	//@@Function
+	/*
+	* desc: waits for the submitted uploads and stops the I/O threads, textures that were not processed yet stay in the STLS_LOADING state.
+	*/
+	void   stop                    ();
+
+	//@@Function
+	/*
+	* desc: queues the texture for loading, the texture should have the path and the cube map flag set.
+	* remarks: mips starting from STextureInternal::iLoadMip are loaded, the texture's resource is not changed
+	(the new resource is returned from collectUploadedTextures()). When the texture is loaded for the first time
+	its STextureInternal::ddsDesc and STextureInternal::iMinResidentMip are filled.
+	*/
+	void   loadTexture             (STextureInternal* pTexture);
+	//@@Function
+	/*
+	* desc: appends textures which upload was finished by the GPU and textures that failed to load (each result is returned only once).
+	* remarks: the caller is responsible for replacing the resource, creating the views and setting the STLS_RESIDENT state.
+	*/
+	void   collectUploadedTextures (std::vector<SLoadedTexture>& vOutTextures);
+	//@@Function
+	/*
+	* desc: removes the texture from the queue or waits until its loading is finished,
+	after this function returns the loader does not reference the texture.
+	*/
+	void   cancelTexture           (STextureInternal* pTexture);
+
+	//@@Function
+	/*
+	* desc: returns the number of textures that are queued, being read or being uploaded.
+	*/
+	size_t getPendingTextureCount  ();
+
+	//@@Function
+	/*
+	* desc: sets the texture that has this ID in the STextureResidencyManager (pass nullptr to clear).
+	*/
+	void   setResidencyTexture     (size_t iResidencyId, STextureInternal* pTexture);
+	//@@Function
+	/*
+	* desc: queues loading of the mips of the texture (STextureResidencyBackend implementation).
+	* return: false if the request was accepted, true otherwise.
+	*/
+	virtual bool requestResidentMips (size_t iResidencyId, size_t iMostDetailedMip) override;
+
+	//@@Function
+	/*
+	* desc: returns the most detailed mip that is always resident (all mips for textures which size is not a power of 2).
+	*/
+	static size_t getMinResidentMip (const SDDSTextureDesc& desc);
+
+private:
+
+	//@@Class
+	/*
+	Upload submitted to the copy queue.
+	*/
+	struct STextureUpload
+	{
+		SLoadedTexture loadedTexture;
+		UINT64         iFenceValue = 0;
+
+		Microsoft::WRL::ComPtr<ID3D12Resource>            pUploadHeap;
+		Microsoft::WRL::ComPtr<ID3D12CommandAllocator>    pCommandAllocator;
+		Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> pCommandList;
+	};
+
+	//@@Function
+	/*
+	* desc: I/O thread function.
+	*/
+	void ioThread      ();
+	//@@Function
+	/*
+	* desc: maps the texture file, creates the resource and records the upload to the command list (on the calling thread).
+	* return: false if successful, true otherwise (the error is only logged and stored in outUpload.loadedTexture.sErrorMessage).
+	*/
+	bool recordUpload  (STextureInternal* pTexture, STextureUpload& outUpload);
+	//@@Function
+	/*
+	* desc: blocks until the copy queue fence reaches the value.
+	* remarks: does not show errors (polls the fence if it cannot wait for it).
+	*/
+	void waitForFence  (UINT64 iFenceValue);
+
+
+	ID3D12Device* pDevice = nullptr;
+
+	Microsoft::WRL::ComPtr<ID3D12CommandQueue> pCopyQueue;
+	Microsoft::WRL::ComPtr<ID3D12Fence>        pCopyFence;
+
+
+	std::vector<std::thread> vIOThreads;
+
+	std::mutex              mtxLoader;
+	std::condition_variable cvTexturesQueued;
+	std::condition_variable cvTextureProcessed;
+
+	std::deque<STextureInternal*>  vTexturesToLoad;
+	std::vector<STextureInternal*> vTexturesInIO;    // being read by the I/O threads
+	std::vector<STextureUpload>    vUploads;         // submitted to the copy queue
+	std::vector<SLoadedTexture>    vFailedLoads;
+
+	// Accessed only by the thread that uses the STextureResidencyManager.
+	std::vector<STextureInternal*> vResidencyTextures;
+
+	UINT64 iLastFenceValue = 0;
+
+	bool   bStop = false;
+};
@@ -0,0 +1,321 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "STextureResidency.h"
+
+// STL
+#include <algorithm>
+
+STextureResidencyManager::STextureResidencyManager(STextureResidencyBackend* pBackend, uint64_t iBudgetInBytes)
+{
+	this->pBackend       = pBackend;
+	this->iBudgetInBytes = iBudgetInBytes;
+}
+
+size_t STextureResidencyManager::registerTexture(const std::vector<uint64_t>& vMipSizesInBytes, size_t iMinResidentMip, size_t iResidentMip)
+{
+	if (vMipSizesInBytes.size() == 0)
+	{
+		return iInvalidTextureId;
+	}
+
+	size_t iTextureId = 0;
+
+	if (vFreeTextureIds.size() > 0)
+	{
+		iTextureId = vFreeTextureIds.back();
+		vFreeTextureIds.pop_back();
+	}
+	else
+	{
+		iTextureId = vTextures.size();
+		vTextures.push_back(STextureResidencyInfo());
+	}
+
+	STextureResidencyInfo& info = vTextures[iTextureId];
+
+	size_t iMipCount = vMipSizesInBytes.size();
+
+	info.vMipRangeSizes.resize(iMipCount + 1);
+	info.vMipRangeSizes[iMipCount] = 0;
+
+	for (size_t i = iMipCount; i > 0; i--)
+	{
+		info.vMipRangeSizes[i - 1] = info.vMipRangeSizes[i] + vMipSizesInBytes[i - 1];
+	}
+
+	info.iMinResidentMip = std::min(iMinResidentMip, iMipCount - 1);
+	info.iResidentMip    = std::min(iResidentMip, iMipCount);
+	info.iRequestedMip   = info.iResidentMip;
+	info.iLastUsedFrame  = 0; // never used
+	info.bRegistered     = true;
+
+	iUsedBytes += info.vMipRangeSizes[info.iRequestedMip];
+
+	if (info.iResidentMip > info.iMinResidentMip)
+	{
+		// Lowest mips are always resident (even if they don't fit in the budget).
+		if (requestMips(iTextureId, info.iMinResidentMip))
+		{
+			unregisterTexture(iTextureId);
+
+			return iInvalidTextureId;
+		}
+	}
+
+	return iTextureId;
+}
+
+void STextureResidencyManager::unregisterTexture(size_t iTextureId)
+{
+	STextureResidencyInfo& info = vTextures[iTextureId];
+
+	if (info.bRegistered == false)
+	{
+		return;
+	}
+
+	iUsedBytes -= info.vMipRangeSizes[info.iRequestedMip];
+
+	info = STextureResidencyInfo();
+
+	vFreeTextureIds.push_back(iTextureId);
+}
+
+void STextureResidencyManager::markTextureUsed(size_t iTextureId)
+{
+	vTextures[iTextureId].iLastUsedFrame = iFrame;
+}
+
+void STextureResidencyManager::update()
+{
+	if (iUsedBytes > iBudgetInBytes)
+	{
+		// The budget was changed.
+		evictForBytes(0);
+	}
+
+
+	// Find used textures that can get more detailed mips.
+
+	vCandidates.clear();
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		const STextureResidencyInfo& info = vTextures[i];
+
+		if (info.bRegistered && info.iLastUsedFrame == iFrame && info.iRequestedMip == info.iResidentMip && info.iResidentMip > 0)
+		{
+			vCandidates.push_back(i);
+		}
+	}
+
+	// Least detailed textures first.
+	std::sort(vCandidates.begin(), vCandidates.end(), [&](size_t iA, size_t iB)
+	{
+		if (vTextures[iA].iResidentMip != vTextures[iB].iResidentMip)
+		{
+			return vTextures[iA].iResidentMip > vTextures[iB].iResidentMip;
+		}
+
+		return iA < iB;
+	});
+
+
+	// Request one more mip for each texture.
+
+	uint64_t iRequestedBytes = 0;
+
+	for (size_t i = 0; i < vCandidates.size(); i++)
+	{
+		size_t iTextureId = vCandidates[i];
+		const STextureResidencyInfo& info = vTextures[iTextureId];
+
+		size_t   iNewMip     = info.iResidentMip - 1;
+		uint64_t iExtraBytes = info.vMipRangeSizes[iNewMip] - info.vMipRangeSizes[info.iResidentMip];
+
+		if (iRequestedBytes > 0 && iRequestedBytes + iExtraBytes > iMaxRequestedBytesPerFrame)
+		{
+			break;
+		}
+
+		if (evictForBytes(iExtraBytes))
+		{
+			stats.iRequestsOverBudget++;
+			continue;
+		}
+
+		if (requestMips(iTextureId, iNewMip) == false)
+		{
+			iRequestedBytes += iExtraBytes;
+		}
+	}
+
+	iFrame++;
+}
+
+void STextureResidencyManager::onMipsResident(size_t iTextureId, size_t iMostDetailedMip)
+{
+	STextureResidencyInfo& info = vTextures[iTextureId];
+
+	if (info.bRegistered == false)
+	{
+		return;
+	}
+
+	if (iMostDetailedMip < info.iResidentMip)
+	{
+		if (info.iResidentMip < info.vMipRangeSizes.size() - 1)
+		{
+			// Not the initial request.
+			stats.iMipsStreamedIn += info.iResidentMip - iMostDetailedMip;
+		}
+	}
+	else
+	{
+		stats.iMipsEvicted += iMostDetailedMip - info.iResidentMip;
+	}
+
+	iUsedBytes = iUsedBytes - info.vMipRangeSizes[info.iRequestedMip] + info.vMipRangeSizes[iMostDetailedMip];
+
+	info.iResidentMip  = iMostDetailedMip;
+	info.iRequestedMip = iMostDetailedMip;
+}
+
+void STextureResidencyManager::onRequestFailed(size_t iTextureId)
+{
+	STextureResidencyInfo& info = vTextures[iTextureId];
+
+	if (info.bRegistered == false)
+	{
+		return;
+	}
+
+	iUsedBytes = iUsedBytes - info.vMipRangeSizes[info.iRequestedMip] + info.vMipRangeSizes[info.iResidentMip];
+
+	info.iRequestedMip = info.iResidentMip;
+}
+
+void STextureResidencyManager::setBudget(uint64_t iBudgetInBytes)
+{
+	this->iBudgetInBytes = iBudgetInBytes;
+}
+
+void STextureResidencyManager::setMaxRequestedBytesPerFrame(uint64_t iMaxBytes)
+{
+	iMaxRequestedBytesPerFrame = iMaxBytes;
+}
+
+size_t STextureResidencyManager::getResidentMip(size_t iTextureId) const
+{
+	return vTextures[iTextureId].iResidentMip;
+}
+
+size_t STextureResidencyManager::getRequestedMip(size_t iTextureId) const
+{
+	return vTextures[iTextureId].iRequestedMip;
+}
+
+STextureResidencyStats STextureResidencyManager::getStats() const
+{
+	STextureResidencyStats outStats = stats;
+	outStats.iUsedBytes     = iUsedBytes;
+	outStats.iBudgetInBytes = iBudgetInBytes;
+	outStats.iTextureCount  = vTextures.size() - vFreeTextureIds.size();
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		if (vTextures[i].bRegistered && vTextures[i].iRequestedMip != vTextures[i].iResidentMip)
+		{
+			outStats.iPendingRequestCount++;
+		}
+	}
+
+	return outStats;
+}
+
+bool STextureResidencyManager::requestMips(size_t iTextureId, size_t iMostDetailedMip)
+{
+	STextureResidencyInfo& info = vTextures[iTextureId];
+
+	size_t iPrevRequestedMip = info.iRequestedMip;
+
+	// Set before the call because the backend can finish the request right away.
+	iUsedBytes = iUsedBytes - info.vMipRangeSizes[iPrevRequestedMip] + info.vMipRangeSizes[iMostDetailedMip];
+	info.iRequestedMip = iMostDetailedMip;
+
+	if (pBackend->requestResidentMips(iTextureId, iMostDetailedMip))
+	{
+		iUsedBytes = iUsedBytes - info.vMipRangeSizes[iMostDetailedMip] + info.vMipRangeSizes[iPrevRequestedMip];
+		info.iRequestedMip = iPrevRequestedMip;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool STextureResidencyManager::evictForBytes(uint64_t iNeededBytes)
+{
+	if (iUsedBytes + iNeededBytes <= iBudgetInBytes)
+	{
+		return false;
+	}
+
+
+	// Textures that were not used in the current frame and have mips that can be evicted, least recently used first.
+
+	vEvictCandidates.clear();
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		const STextureResidencyInfo& info = vTextures[i];
+
+		if (info.bRegistered && info.iLastUsedFrame < iFrame && info.iRequestedMip == info.iResidentMip
+			&& info.iResidentMip < info.iMinResidentMip)
+		{
+			vEvictCandidates.push_back(i);
+		}
+	}
+
+	std::sort(vEvictCandidates.begin(), vEvictCandidates.end(), [&](size_t iA, size_t iB)
+	{
+		if (vTextures[iA].iLastUsedFrame != vTextures[iB].iLastUsedFrame)
+		{
+			return vTextures[iA].iLastUsedFrame < vTextures[iB].iLastUsedFrame;
+		}
+
+		return iA < iB;
+	});
+
+
+	for (size_t i = 0; i < vEvictCandidates.size(); i++)
+	{
+		size_t iTextureId = vEvictCandidates[i];
+		const STextureResidencyInfo& info = vTextures[iTextureId];
+
+		// Evict the most detailed mips of this texture until the bytes fit.
+
+		size_t iNewMip = info.iResidentMip;
+		uint64_t iFreedBytes = 0;
+
+		while (iNewMip < info.iMinResidentMip && iUsedBytes - iFreedBytes + iNeededBytes > iBudgetInBytes)
+		{
+			iNewMip++;
+			iFreedBytes = info.vMipRangeSizes[info.iResidentMip] - info.vMipRangeSizes[iNewMip];
+		}
+
+		requestMips(iTextureId, iNewMip);
+
+		if (iUsedBytes + iNeededBytes <= iBudgetInBytes)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
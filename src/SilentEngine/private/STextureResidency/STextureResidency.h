@@ -0,0 +1,193 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+//@@Class
+/*
+Interface used by the STextureResidencyManager to change the mips of the textures that are stored in the GPU memory.
+*/
+class STextureResidencyBackend
+{
+public:
+	virtual ~STextureResidencyBackend() = default;
+
+	//@@Function
+	/*
+	* desc: starts making mips in range [iMostDetailedMip, mip count) of the texture resident
+	(this can be more or less mips than the texture has now).
+	* return: false if the request was accepted, true otherwise.
+	* remarks: the backend should call STextureResidencyManager::onMipsResident() when the mips are resident
+	(can be called from this function).
+	*/
+	virtual bool requestResidentMips(size_t iTextureId, size_t iMostDetailedMip) = 0;
+};
+
+
+//@@Class
+/*
+Statistics of the STextureResidencyManager.
+*/
+struct STextureResidencyStats
+{
+	uint64_t iUsedBytes            = 0; // resident bytes with the requested changes applied
+	uint64_t iBudgetInBytes        = 0;
+
+	size_t   iTextureCount         = 0;
+	size_t   iPendingRequestCount  = 0;
+
+	// Totals since the manager was created.
+	size_t   iMipsStreamedIn       = 0;
+	size_t   iMipsEvicted          = 0;
+	size_t   iRequestsOverBudget   = 0; // mips that were wanted but did not fit in the budget
+};
+
+
+//@@Class
+/*
+The class decides which mips of the textures should be stored in the GPU memory.
+The textures start with their lowest mips, mips of the textures used in the last frame are streamed in
+(one mip per texture per frame) and when the budget is exceeded the most detailed mips of the least recently used textures are evicted.
+Not thread-safe.
+*/
+class STextureResidencyManager
+{
+public:
+	// Returned by registerTexture() on error.
+	static constexpr size_t iInvalidTextureId = SIZE_MAX;
+
+	//@@Function
+	/*
+	* param "pBackend": backend that changes the mips of the textures.
+	* param "iBudgetInBytes": memory budget for the mips of all textures.
+	*/
+	STextureResidencyManager(STextureResidencyBackend* pBackend, uint64_t iBudgetInBytes = UINT64_MAX);
+	STextureResidencyManager(const STextureResidencyManager&) = delete;
+	STextureResidencyManager& operator= (const STextureResidencyManager&) = delete;
+
+	//@@Function
+	/*
+	* desc: starts managing the texture.
+	* param "vMipSizesInBytes": size of each mip (mip 0 is the most detailed).
+	* param "iMinResidentMip": mips in range [iMinResidentMip, mip count) are never evicted.
+	* param "iResidentMip": most detailed mip that is already resident, pass the mip count if the texture has no mips in the memory
+	(in this case the mips from iMinResidentMip will be requested).
+	* return: ID of the texture.
+	*/
+	size_t   registerTexture    (const std::vector<uint64_t>& vMipSizesInBytes, size_t iMinResidentMip, size_t iResidentMip);
+	//@@Function
+	/*
+	* desc: stops managing the texture, the ID can be returned by registerTexture() later.
+	* remarks: the backend should cancel the requests of this texture.
+	*/
+	void     unregisterTexture  (size_t iTextureId);
+	//@@Function
+	/*
+	* desc: marks the texture as used in the current frame (used textures get more detailed mips).
+	*/
+	void     markTextureUsed    (size_t iTextureId);
+	//@@Function
+	/*
+	* desc: should be called once per frame (after the textures of the frame were marked),
+	requests more detailed mips for the used textures and evicts mips of the least recently used textures if needed.
+	*/
+	void     update             ();
+	//@@Function
+	/*
+	* desc: called by the backend when the request is finished.
+	*/
+	void     onMipsResident     (size_t iTextureId, size_t iMostDetailedMip);
+	//@@Function
+	/*
+	* desc: called by the backend when the request failed, the texture keeps its current mips.
+	*/
+	void     onRequestFailed    (size_t iTextureId);
+
+	//@@Function
+	/*
+	* desc: sets the memory budget, mips over the budget are evicted in the next update().
+	*/
+	void     setBudget          (uint64_t iBudgetInBytes);
+	//@@Function
+	/*
+	* desc: sets how many bytes can be requested for streaming in each frame (at least one request is made if needed).
+	*/
+	void     setMaxRequestedBytesPerFrame (uint64_t iMaxBytes);
+
+	//@@Function
+	/*
+	* desc: returns the most detailed resident mip of the texture.
+	*/
+	size_t   getResidentMip     (size_t iTextureId) const;
+	//@@Function
+	/*
+	* desc: returns the most detailed mip that the texture will have after its request is finished
+	(equal to getResidentMip() if there is no request).
+	*/
+	size_t   getRequestedMip    (size_t iTextureId) const;
+	//@@Function
+	/*
+	* desc: returns the statistics.
+	*/
+	STextureResidencyStats getStats () const;
+
+private:
+
+	//@@Class
+	/*
+	State of one texture.
+	*/
+	struct STextureResidencyInfo
+	{
+		std::vector<uint64_t> vMipRangeSizes; // size of mips in range [i, mip count), one more element (0) for "no mips"
+
+		size_t   iMinResidentMip = 0;
+		size_t   iResidentMip    = 0;
+		size_t   iRequestedMip   = 0; // equal to iResidentMip if there is no request
+
+		uint64_t iLastUsedFrame  = 0;
+
+		bool     bRegistered     = false;
+	};
+
+	//@@Function
+	/*
+	* desc: requests the mips and updates the budget accounting.
+	* return: false if the request was accepted, true otherwise.
+	*/
+	bool     requestMips        (size_t iTextureId, size_t iMostDetailedMip);
+	//@@Function
+	/*
+	* desc: evicts mips of the textures that were not used in the current frame (least recently used first)
+	until iNeededBytes fit in the budget.
+	* return: false if iNeededBytes fit in the budget, true otherwise.
+	*/
+	bool     evictForBytes      (uint64_t iNeededBytes);
+
+
+	STextureResidencyBackend* pBackend = nullptr;
+
+	std::vector<STextureResidencyInfo> vTextures;
+	std::vector<size_t>                vFreeTextureIds;
+
+	// Only to avoid allocations in update().
+	std::vector<size_t>                vCandidates;
+	std::vector<size_t>                vEvictCandidates;
+
+	uint64_t iBudgetInBytes             = UINT64_MAX;
+	uint64_t iMaxRequestedBytesPerFrame = UINT64_MAX;
+	uint64_t iUsedBytes                 = 0; // sum of vMipRangeSizes[iRequestedMip]
+	uint64_t iFrame                     = 1;
+
+	STextureResidencyStats stats;
+};
@@ -0,0 +1,113 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SThreadPool.h"
+
+// STL
+#include <algorithm>
+
+SThreadPool::SThreadPool(size_t iWorkerCount)
+{
+	if (iWorkerCount == 0)
+	{
+		iWorkerCount = std::max<size_t>(1, std::thread::hardware_concurrency()) - 1;
+	}
+
+	for (size_t i = 0; i < iWorkerCount; i++)
+	{
+		vWorkers.push_back(std::thread(&SThreadPool::workerThread, this, i));
+	}
+}
+
+SThreadPool::~SThreadPool()
+{
+	mtxJobs.lock();
+	bExit = true;
+	mtxJobs.unlock();
+
+	cvJobsReady.notify_all();
+
+	for (size_t i = 0; i < vWorkers.size(); i++)
+	{
+		vWorkers[i].join();
+	}
+}
+
+void SThreadPool::runJobs(size_t iJobs, const std::function<void(size_t)>& job)
+{
+	if (iJobs <= 1)
+	{
+		job(0);
+		return;
+	}
+
+
+	mtxJobs.lock();
+
+	pJob                = &job;
+	iJobCount           = iJobs;
+	iFinishedWorkerJobs = 0;
+
+	iJobGeneration++;
+
+	mtxJobs.unlock();
+
+	cvJobsReady.notify_all();
+
+
+	// The first job is done on this thread.
+	job(0);
+
+
+	std::unique_lock<std::mutex> lock(mtxJobs);
+	cvJobsFinished.wait(lock, [this]() { return iFinishedWorkerJobs == iJobCount - 1; });
+}
+
+size_t SThreadPool::getWorkerCount() const
+{
+	return vWorkers.size();
+}
+
+void SThreadPool::workerThread(size_t iWorkerIndex)
+{
+	size_t iLastGeneration = 0;
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(mtxJobs);
+		cvJobsReady.wait(lock, [this, &iLastGeneration]() { return bExit || iJobGeneration != iLastGeneration; });
+
+		if (bExit)
+		{
+			return;
+		}
+
+		iLastGeneration = iJobGeneration;
+
+		// Job 0 is done by the thread that called runJobs().
+		const size_t iJob = iWorkerIndex + 1;
+
+		if (iJob >= iJobCount)
+		{
+			continue;
+		}
+
+		const std::function<void(size_t)>* pCurrentJob = pJob;
+
+		lock.unlock();
+
+
+		(*pCurrentJob)(iJob);
+
+
+		lock.lock();
+		iFinishedWorkerJobs++;
+		lock.unlock();
+
+		cvJobsFinished.notify_one();
+	}
+}
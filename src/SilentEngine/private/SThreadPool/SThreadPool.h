@@ -0,0 +1,72 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+//@@Class
+/*
+The class owns persistent worker threads that run the jobs of one call to runJobs() at a time,
+so that splitting work between threads does not create threads every time.
+*/
+class SThreadPool
+{
+public:
+	//@@Function
+	/*
+	* desc: starts the worker threads.
+	* param "iWorkerCount": number of worker threads, pass 0 to use (number of hardware threads - 1).
+	*/
+	SThreadPool(size_t iWorkerCount = 0);
+	SThreadPool(const SThreadPool&) = delete;
+	SThreadPool& operator= (const SThreadPool&) = delete;
+	~SThreadPool();
+
+	//@@Function
+	/*
+	* desc: calls job(0) on this thread and job(i) on the worker (i - 1), returns when all jobs are finished.
+	* param "iJobs": not bigger than (getWorkerCount() + 1).
+	* remarks: not reentrant, only one thread should call this function at a time.
+	*/
+	void   runJobs        (size_t iJobs, const std::function<void(size_t)>& job);
+
+	//@@Function
+	/*
+	* desc: returns the number of worker threads.
+	*/
+	size_t getWorkerCount () const;
+
+private:
+
+	//@@Function
+	/*
+	* desc: worker thread function.
+	*/
+	void workerThread (size_t iWorkerIndex);
+
+
+	std::vector<std::thread> vWorkers;
+
+	std::mutex              mtxJobs;
+	std::condition_variable cvJobsReady;
+	std::condition_variable cvJobsFinished;
+
+	// Current jobs (set by runJobs()).
+	const std::function<void(size_t)>* pJob      = nullptr;
+	size_t                             iJobCount = 0;
+
+	size_t iJobGeneration      = 0;
+	size_t iFinishedWorkerJobs = 0;
+
+	bool bExit = false;
+};
@@ -0,0 +1,345 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "STransformSystem.h"
+
+// STL
+#include <algorithm>
+
+// Custom
+#include "SilentEngine/Private/EntityComponentSystem/SComponent/SComponent.h"
+#include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
+
+void STransformSystem::addContainer(SContainer* pContainer)
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	const size_t iContainerNode = addNode(pContainer, nullptr, iNoParent, pContainer->vLocation, pContainer->vRotation, pContainer->vScale);
+
+	pContainer->pTransformSystem = this;
+	pContainer->iTransformIndex  = iContainerNode;
+
+	// Breadth-first so that all nodes of one depth are stored next to each other
+	// and every parent is stored before its children.
+
+	for (size_t i = 0; i < pContainer->vComponents.size(); i++)
+	{
+		SComponent* pComponent = pContainer->vComponents[i];
+
+		pComponent->pTransformSystem = this;
+		pComponent->iTransformIndex  = addNode(pContainer, pComponent, iContainerNode, pComponent->vLocation, pComponent->vRotation, pComponent->vScale);
+	}
+
+	for (size_t i = iContainerNode + 1; i < vComponent.size(); i++)
+	{
+		SComponent* pParent = vComponent[i];
+
+		for (size_t j = 0; j < pParent->vChildComponents.size(); j++)
+		{
+			SComponent* pComponent = pParent->vChildComponents[j];
+
+			pComponent->pTransformSystem = this;
+			pComponent->iTransformIndex  = addNode(pContainer, pComponent, i, pComponent->vLocation, pComponent->vRotation, pComponent->vScale);
+		}
+	}
+
+	iFirstDirtyNode = std::min<size_t>(iFirstDirtyNode, iContainerNode);
+}
+
+void STransformSystem::removeContainer(SContainer* pContainer)
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	if (pContainer->pTransformSystem != this)
+	{
+		return;
+	}
+
+	const size_t iFirst = pContainer->iTransformIndex;
+	size_t iLast = iFirst + 1;
+
+	while (iLast < vOwnerContainer.size() && vOwnerContainer[iLast] == pContainer)
+	{
+		iLast++;
+	}
+
+	const size_t iRemovedCount = iLast - iFirst;
+
+
+	for (size_t i = iFirst; i < iLast; i++)
+	{
+		if (vComponent[i])
+		{
+			vComponent[i]->pTransformSystem = nullptr;
+			vComponent[i]->iTransformIndex  = 0;
+		}
+	}
+
+	pContainer->pTransformSystem = nullptr;
+	pContainer->iTransformIndex  = 0;
+
+
+	vLocalLocation  .erase(vLocalLocation  .begin() + iFirst, vLocalLocation  .begin() + iLast);
+	vLocalRotation  .erase(vLocalRotation  .begin() + iFirst, vLocalRotation  .begin() + iLast);
+	vLocalScale     .erase(vLocalScale     .begin() + iFirst, vLocalScale     .begin() + iLast);
+	vLocalMatrix    .erase(vLocalMatrix    .begin() + iFirst, vLocalMatrix    .begin() + iLast);
+	vWorldMatrix    .erase(vWorldMatrix    .begin() + iFirst, vWorldMatrix    .begin() + iLast);
+	vParentIndex    .erase(vParentIndex    .begin() + iFirst, vParentIndex    .begin() + iLast);
+	vFlags          .erase(vFlags          .begin() + iFirst, vFlags          .begin() + iLast);
+	vComponent      .erase(vComponent      .begin() + iFirst, vComponent      .begin() + iLast);
+	vOwnerContainer .erase(vOwnerContainer .begin() + iFirst, vOwnerContainer .begin() + iLast);
+
+
+	// Fix indices of the nodes that were moved.
+
+	for (size_t i = iFirst; i < vFlags.size(); i++)
+	{
+		if (vParentIndex[i] != iNoParent)
+		{
+			vParentIndex[i] -= iRemovedCount;
+		}
+
+		if (vComponent[i])
+		{
+			vComponent[i]->iTransformIndex = i;
+		}
+		else
+		{
+			vOwnerContainer[i]->iTransformIndex = i;
+		}
+	}
+
+	if (iFirstDirtyNode != SIZE_MAX)
+	{
+		iFirstDirtyNode = std::min<size_t>(iFirstDirtyNode, iFirst);
+	}
+
+
+	for (size_t i = 0; i < vQueuedParentChangedCallbacks.size(); i++)
+	{
+		if (vQueuedParentChangedCallbacks[i]->pContainer == pContainer)
+		{
+			vQueuedParentChangedCallbacks.erase(vQueuedParentChangedCallbacks.begin() + i);
+			i--;
+		}
+	}
+}
+
+void STransformSystem::setLocalTransform(SComponent* pComponent, const SVector& vLocation, const SVector& vRotation, const SVector& vScale)
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	// Could be removed (and the nodes renumbered) after the caller checked pTransformSystem.
+	if (pComponent->pTransformSystem != this || pComponent->iTransformIndex >= vComponent.size() ||
+		vComponent[pComponent->iTransformIndex] != pComponent)
+	{
+		return;
+	}
+
+	setNodeLocalTransform(pComponent->iTransformIndex, vLocation, vRotation, vScale);
+}
+
+void STransformSystem::setLocalTransform(SContainer* pContainer, const SVector& vLocation, const SVector& vRotation, const SVector& vScale)
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	if (pContainer->pTransformSystem != this || pContainer->iTransformIndex >= vComponent.size() ||
+		vComponent[pContainer->iTransformIndex] != nullptr || vOwnerContainer[pContainer->iTransformIndex] != pContainer)
+	{
+		return;
+	}
+
+	setNodeLocalTransform(pContainer->iTransformIndex, vLocation, vRotation, vScale);
+}
+
+void STransformSystem::updateWorldMatrices()
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	recalculateDirtyNodes();
+}
+
+void STransformSystem::callQueuedParentChangedCallbacks()
+{
+	std::vector<SComponent*> vCallbacks;
+
+	mtxTransforms.lock();
+
+	vCallbacks.swap(vQueuedParentChangedCallbacks);
+
+	for (size_t i = 0; i < vCallbacks.size(); i++)
+	{
+		vFlags[vCallbacks[i]->iTransformIndex] &= ~iCallbackQueuedFlag;
+	}
+
+	mtxTransforms.unlock();
+
+
+	for (size_t i = 0; i < vCallbacks.size(); i++)
+	{
+		if (vCallbacks[i]->onParentLocationRotationScaleChangedCallback)
+		{
+			vCallbacks[i]->onParentLocationRotationScaleChangedCallback(vCallbacks[i]);
+		}
+	}
+}
+
+bool STransformSystem::getWorldMatrix(SComponent* pComponent, DirectX::XMFLOAT4X4& vOutWorldMatrix)
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	if (pComponent->pTransformSystem != this || pComponent->iTransformIndex >= vComponent.size() ||
+		vComponent[pComponent->iTransformIndex] != pComponent)
+	{
+		return true;
+	}
+
+	recalculateDirtyNodes();
+
+	vOutWorldMatrix = vWorldMatrix[pComponent->iTransformIndex];
+
+	return false;
+}
+
+size_t STransformSystem::getNodeCount()
+{
+	std::lock_guard<std::mutex> guard(mtxTransforms);
+
+	return vFlags.size();
+}
+
+DirectX::XMMATRIX XM_CALLCONV STransformSystem::composeLocalMatrix(const SVector& vLocation, const SVector& vRotation, const SVector& vScale)
+{
+	return DirectX::XMMatrixScaling(vScale.getX(), vScale.getY(), vScale.getZ()) *
+		DirectX::XMMatrixRotationX(DirectX::XMConvertToRadians(vRotation.getX())) *
+		DirectX::XMMatrixRotationY(DirectX::XMConvertToRadians(vRotation.getY())) *
+		DirectX::XMMatrixRotationZ(DirectX::XMConvertToRadians(vRotation.getZ())) *
+		DirectX::XMMatrixTranslation(vLocation.getX(), vLocation.getY(), vLocation.getZ());
+}
+
+size_t STransformSystem::addNode(SContainer* pOwnerContainer, SComponent* pComponent, size_t iParentIndex,
+	const SVector& vLocation, const SVector& vRotation, const SVector& vScale)
+{
+	vLocalLocation .push_back({ vLocation.getX(), vLocation.getY(), vLocation.getZ() });
+	vLocalRotation .push_back({ DirectX::XMConvertToRadians(vRotation.getX()), DirectX::XMConvertToRadians(vRotation.getY()),
+		DirectX::XMConvertToRadians(vRotation.getZ()) });
+	vLocalScale    .push_back({ vScale.getX(), vScale.getY(), vScale.getZ() });
+	vLocalMatrix   .push_back(SMath::getIdentityMatrix4x4());
+	vWorldMatrix   .push_back(SMath::getIdentityMatrix4x4());
+	vParentIndex   .push_back(iParentIndex);
+	vFlags         .push_back(iLocalDirtyFlag | iJustAddedFlag);
+	vComponent     .push_back(pComponent);
+	vOwnerContainer.push_back(pOwnerContainer);
+
+	return vFlags.size() - 1;
+}
+
+void STransformSystem::setNodeLocalTransform(size_t iNodeIndex, const SVector& vLocation, const SVector& vRotation, const SVector& vScale)
+{
+	vLocalLocation[iNodeIndex] = { vLocation.getX(), vLocation.getY(), vLocation.getZ() };
+	vLocalRotation[iNodeIndex] = { DirectX::XMConvertToRadians(vRotation.getX()), DirectX::XMConvertToRadians(vRotation.getY()),
+		DirectX::XMConvertToRadians(vRotation.getZ()) };
+	vLocalScale   [iNodeIndex] = { vScale.getX(), vScale.getY(), vScale.getZ() };
+
+	vFlags[iNodeIndex] |= iLocalDirtyFlag;
+
+	iFirstDirtyNode = std::min<size_t>(iFirstDirtyNode, iNodeIndex);
+}
+
+void STransformSystem::recalculateDirtyNodes()
+{
+	if (iFirstDirtyNode == SIZE_MAX)
+	{
+		return;
+	}
+
+	vChangedNodes.clear();
+
+	// Parents are always stored before their children so when we reach a node
+	// its parent's world matrix is already up to date.
+
+	const size_t iNodeCount = vFlags.size();
+
+	for (size_t i = iFirstDirtyNode; i < iNodeCount; i++)
+	{
+		const size_t  iParent = vParentIndex[i];
+		const uint8_t iFlags  = vFlags[i];
+
+		const bool bParentChanged = (iParent != iNoParent) && (vFlags[iParent] & iWorldChangedFlag);
+
+		if (((iFlags & iLocalDirtyFlag) == 0) && (bParentChanged == false))
+		{
+			continue;
+		}
+
+		DirectX::XMMATRIX local;
+
+		if (iFlags & iLocalDirtyFlag)
+		{
+			const DirectX::XMFLOAT3& vRotation = vLocalRotation[i];
+
+			local = DirectX::XMMatrixScalingFromVector(DirectX::XMLoadFloat3(&vLocalScale[i])) *
+				DirectX::XMMatrixRotationX(vRotation.x) * DirectX::XMMatrixRotationY(vRotation.y) * DirectX::XMMatrixRotationZ(vRotation.z) *
+				DirectX::XMMatrixTranslationFromVector(DirectX::XMLoadFloat3(&vLocalLocation[i]));
+
+			DirectX::XMStoreFloat4x4(&vLocalMatrix[i], local);
+		}
+		else
+		{
+			local = DirectX::XMLoadFloat4x4(&vLocalMatrix[i]);
+		}
+
+		if (iParent != iNoParent)
+		{
+			DirectX::XMStoreFloat4x4(&vWorldMatrix[i], DirectX::XMMatrixMultiply(local, DirectX::XMLoadFloat4x4(&vWorldMatrix[iParent])));
+		}
+		else
+		{
+			DirectX::XMStoreFloat4x4(&vWorldMatrix[i], local);
+		}
+
+		if (bParentChanged && vComponent[i] && ((iFlags & (iJustAddedFlag | iCallbackQueuedFlag)) == 0)
+			&& vComponent[i]->onParentLocationRotationScaleChangedCallback)
+		{
+			vQueuedParentChangedCallbacks.push_back(vComponent[i]);
+			vFlags[i] |= iCallbackQueuedFlag;
+		}
+
+		vFlags[i] = (vFlags[i] & ~iLocalDirtyFlag) | iWorldChangedFlag;
+
+		vChangedNodes.push_back(i);
+	}
+
+	iFirstDirtyNode = SIZE_MAX;
+
+
+	// Publish new world matrices.
+
+	for (size_t i = 0; i < vChangedNodes.size(); i++)
+	{
+		const size_t iNode = vChangedNodes[i];
+
+		vFlags[iNode] &= ~(iWorldChangedFlag | iJustAddedFlag);
+
+		SComponent* pComponent = vComponent[iNode];
+
+		if (pComponent == nullptr)
+		{
+			continue;
+		}
+
+		pComponent->mtxComponentProps.lock();
+
+		pComponent->mtxWorldMatrixUpdate.lock();
+		pComponent->renderData.vWorld = vWorldMatrix[iNode];
+		pComponent->mtxWorldMatrixUpdate.unlock();
+
+		pComponent->markObjectCBDirty();
+
+		pComponent->mtxComponentProps.unlock();
+	}
+}
@@ -0,0 +1,156 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+// DirectX
+#include <DirectXMath.h>
+
+// Custom
+#include "SilentEngine/Public/SVector/SVector.h"
+
+class SComponent;
+class SContainer;
+
+//@@Class
+/*
+The class stores local and world transforms of all spawned containers and their components in contiguous arrays
+(structure of arrays) and recalculates the world matrices of the changed nodes in one linear pass.
+Every spawned container occupies a contiguous range of nodes: the container node goes first and then its components
+in breadth-first (depth) order, so a parent node always has a smaller index than its children.
+*/
+class STransformSystem
+{
+public:
+	//@@Function
+	STransformSystem() = default;
+	STransformSystem(const STransformSystem&) = delete;
+	STransformSystem& operator= (const STransformSystem&) = delete;
+
+	//@@Function
+	/*
+	* desc: adds the container and all of its components (including child components) to the system.
+	* remarks: world matrices of the added nodes will be calculated on the next updateWorldMatrices() call.
+	*/
+	void addContainer    (SContainer* pContainer);
+	//@@Function
+	/*
+	* desc: removes the container and all of its components (including child components) from the system.
+	*/
+	void removeContainer (SContainer* pContainer);
+
+	//@@Function
+	/*
+	* desc: stores the new local location/rotation/scale of the component's node and marks it as dirty.
+	* param "vRotation": rotation in degrees.
+	* remarks: the node is looked up under the lock (nodes are renumbered in removeContainer()), does nothing
+	if the component is not in this system. The world matrix of this node and its children will be recalculated on the
+	next updateWorldMatrices() call.
+	*/
+	void setLocalTransform(SComponent* pComponent, const SVector& vLocation, const SVector& vRotation, const SVector& vScale);
+	//@@Function
+	/*
+	* desc: stores the new location/rotation/scale of the container's node and marks it as dirty.
+	* param "vRotation": rotation in degrees.
+	* remarks: same as the component version.
+	*/
+	void setLocalTransform(SContainer* pContainer, const SVector& vLocation, const SVector& vRotation, const SVector& vScale);
+
+	//@@Function
+	/*
+	* desc: recalculates the world matrices of the dirty nodes and their children, writes them to the components' render data
+	and queues the "on parent location/rotation/scale changed" callbacks of the components whose parent has moved.
+	* remarks: does nothing if no nodes are dirty.
+	*/
+	void updateWorldMatrices();
+	//@@Function
+	/*
+	* desc: calls the "on parent location/rotation/scale changed" callbacks queued in updateWorldMatrices().
+	* remarks: should not be called while holding SApplication::mtxDraw because the user callbacks may use the engine.
+	*/
+	void callQueuedParentChangedCallbacks();
+
+	//@@Function
+	/*
+	* desc: returns the world matrix of the component's node (updates dirty nodes first).
+	* return: false if successful, true if the component is not in this system (was removed).
+	*/
+	bool getWorldMatrix(SComponent* pComponent, DirectX::XMFLOAT4X4& vOutWorldMatrix);
+
+	//@@Function
+	/*
+	* desc: returns the number of nodes in the system.
+	*/
+	size_t getNodeCount();
+
+	//@@Function
+	/*
+	* desc: returns the local matrix (scale * rotation X * rotation Y * rotation Z * translation).
+	* param "vRotation": rotation in degrees.
+	*/
+	static DirectX::XMMATRIX XM_CALLCONV composeLocalMatrix(const SVector& vLocation, const SVector& vRotation, const SVector& vScale);
+
+private:
+
+	//@@Function
+	/*
+	* desc: appends a new node.
+	* return: index of the new node.
+	*/
+	size_t addNode               (SContainer* pOwnerContainer, SComponent* pComponent, size_t iParentIndex,
+		const SVector& vLocation, const SVector& vRotation, const SVector& vScale);
+	//@@Function
+	/*
+	* desc: stores the new local transform of the node, expects mtxTransforms to be locked.
+	*/
+	void   setNodeLocalTransform (size_t iNodeIndex, const SVector& vLocation, const SVector& vRotation, const SVector& vScale);
+	//@@Function
+	/*
+	* desc: recalculates dirty nodes, expects mtxTransforms to be locked.
+	*/
+	void   recalculateDirtyNodes ();
+
+
+	static constexpr size_t iNoParent = SIZE_MAX;
+
+	static constexpr uint8_t iLocalDirtyFlag     = 1;
+	static constexpr uint8_t iWorldChangedFlag   = 2;
+	static constexpr uint8_t iJustAddedFlag      = 4;
+	static constexpr uint8_t iCallbackQueuedFlag = 8;
+
+
+	// Structure of arrays, one element per node.
+
+	std::vector<DirectX::XMFLOAT3>   vLocalLocation;
+	std::vector<DirectX::XMFLOAT3>   vLocalRotation; // in radians
+	std::vector<DirectX::XMFLOAT3>   vLocalScale;
+	std::vector<DirectX::XMFLOAT4X4> vLocalMatrix;
+	std::vector<DirectX::XMFLOAT4X4> vWorldMatrix;
+	std::vector<size_t>              vParentIndex;
+	std::vector<uint8_t>             vFlags;
+	std::vector<SComponent*>         vComponent; // nullptr for container nodes
+	std::vector<SContainer*>         vOwnerContainer;
+
+
+	// Nodes whose world matrix was changed in the last recalculateDirtyNodes() call.
+	std::vector<size_t> vChangedNodes;
+
+	std::vector<SComponent*> vQueuedParentChangedCallbacks;
+
+
+	// Also guards SComponent/SContainer::iTransformIndex of the nodes in this system.
+	std::mutex mtxTransforms;
+
+
+	// Nodes before this index are not dirty.
+	size_t iFirstDirtyNode = SIZE_MAX;
+};
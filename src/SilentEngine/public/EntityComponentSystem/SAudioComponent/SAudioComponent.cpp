@@ -35,26 +35,3 @@ SAudioComponent::~SAudioComponent()
 {
 	if (pSound) delete pSound;
 }
-
-void SAudioComponent::updateMyAndChildsLocationRotationScale(bool bCalledOnSelf)
-{
-	mtxComponentProps.lock();
-
-	XMStoreFloat4x4(&renderData.vWorld, getWorldMatrix());
-
-	mtxComponentProps.unlock();
-
-
-	if ((bCalledOnSelf == false) && onParentLocationRotationScaleChangedCallback)
-	{
-		onParentLocationRotationScaleChangedCallback(this);
-	}
-
-
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
-}
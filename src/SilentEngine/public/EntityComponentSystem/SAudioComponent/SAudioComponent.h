@@ -43,12 +43,6 @@ private:
 	friend class SAudioEngine;
 	friend class SSound;
 
-	//@@Function
-	/*
-	* desc: called when parent's location/rotation/scale are changed.
-	*/
-	virtual void updateMyAndChildsLocationRotationScale(bool bCalledOnSelf) override;
-
 
 	// --------------------------------------------------
 
@@ -11,6 +11,7 @@
 #include "SilentEngine/Public/SApplication/SApplication.h"
 #include "SilentEngine/Private/EntityComponentSystem/SComponent/SComponent.h"
 #include "SilentEngine/Public/EntityComponentSystem/SMeshComponent/SMeshComponent.h"
+#include "SilentEngine/Private/STransformSystem/STransformSystem.h"
 
 SContainer::SContainer(const std::string& sContainerName)
 {
@@ -22,6 +23,9 @@ SContainer::SContainer(const std::string& sContainerName)
 
 	iMeshComponentsCount  = 0;
 	iStartIndexCB         = 0;
+	iTransformIndex       = 0;
+
+	pTransformSystem      = nullptr;
 
 	vLocation             = SVector(0.0f, 0.0f, 0.0f);
 	vRotation             = SVector(0.0f, 0.0f, 0.0f);
@@ -67,10 +71,7 @@ void SContainer::setLocation(const SVector& vNewLocation, bool bLocationInWorldC
 		vLocation = vLocalXAxisVector * vNewLocation + vLocalYAxisVector * vNewLocation + vLocalZAxisVector  * vNewLocation;
 	}
 
-	for (size_t i = 0; i < vComponents.size(); i++)
-	{
-		vComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
+	markTransformDirty();
 }
 
 void SContainer::setRotation(const SVector& vNewRotation)
@@ -123,10 +124,7 @@ void SContainer::setRotation(const SVector& vNewRotation)
 	vLocalYAxisVector = SVector(rotMat._21, rotMat._22, rotMat._23);
 	vLocalZAxisVector = SVector(rotMat._31, rotMat._32, rotMat._33);
 
-	for (size_t i = 0; i < vComponents.size(); i++)
-	{
-		vComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
+	markTransformDirty();
 }
 
 void SContainer::setScale(const SVector& vNewScale)
@@ -138,10 +136,7 @@ void SContainer::setScale(const SVector& vNewScale)
 
 	vScale = vNewScale;
 
-	for (size_t i = 0; i < vComponents.size(); i++)
-	{
-		vComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
+	markTransformDirty();
 }
 
 bool SContainer::addComponentToContainer(SComponent* pComponent)
@@ -312,14 +307,6 @@ void SContainer::setStartIndexInCB(size_t iStartIndex)
 	iStartIndexCB = iStartIndex;
 }
 
-void SContainer::getAllMeshComponents(std::vector<SComponent*>* pvOpaqueComponents, std::vector<SComponent*>* pvTransparentComponents)
-{
-	for (size_t i = 0; i < vComponents.size(); i++)
-	{
-		vComponents[i]->getAllMeshComponents(pvOpaqueComponents, pvTransparentComponents);
-	}
-}
-
 void SContainer::createVertexBufferForRuntimeMeshComponents(SFrameResource* pFrameResource)
 {
 	for (size_t i = 0; i < vComponents.size(); i++)
@@ -444,3 +431,13 @@ void SContainer::unregisterAll3DSoundComponents()
 		vComponents[i]->unregisterAll3DSoundComponents();
 	}
 }
+
+void SContainer::markTransformDirty()
+{
+	STransformSystem* pSystem = pTransformSystem;
+
+	if (pSystem)
+	{
+		pSystem->setLocalTransform(this, vLocation, vRotation, vScale);
+	}
+}
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 // DirectX
 #include <d3d12.h>
@@ -160,6 +161,8 @@ private:
 	friend class SComponent;
 	friend class SRuntimeMeshComponent;
 	friend class SLevel;
+	friend class STransformSystem;
+	friend class SRenderRegistry;
 
 	//@@Function
 	/*
@@ -173,11 +176,6 @@ private:
 	void setStartIndexInCB        (size_t iStartIndex);
 	//@@Function
 	/*
-	* desc: returns all opaque and transparent mesh components.
-	*/
-	void getAllMeshComponents(std::vector<SComponent*>* pvOpaqueComponents, std::vector<SComponent*>* pvTransparentComponents);
-	//@@Function
-	/*
 	* desc: creates the vertex buffer for only runtime mesh components for given frame resource.
 	*/
 	void createVertexBufferForRuntimeMeshComponents (SFrameResource* pFrameResource);
@@ -248,6 +246,12 @@ private:
 	their 3D sound position in onTick().
 	*/
 	void unregisterAll3DSoundComponents();
+	//@@Function
+	/*
+	* desc: passes the new location/rotation/scale to the transform system (if spawned) so that the world matrices
+	of all components will be recalculated.
+	*/
+	void markTransformDirty();
 
 
 	// -----------------------------------------------
@@ -268,6 +272,12 @@ private:
 	std::string sContainerName;
 
 
+	// not nullptr only while spawned (atomic because it's checked without the lock, the node is then looked up
+	// under STransformSystem::mtxTransforms which also guards iTransformIndex)
+	std::atomic<class STransformSystem*> pTransformSystem;
+	size_t iTransformIndex;
+
+
 	size_t iStartIndexCB;
 	size_t iMeshComponentsCount;
 
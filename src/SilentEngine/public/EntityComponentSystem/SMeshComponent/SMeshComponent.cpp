@@ -7,6 +7,9 @@
 
 #include "SMeshComponent.h"
 
+// STL
+#include <cstring>
+
 // DirectX
 #include <D3Dcompiler.h>
 #pragma comment(lib, "d3dcompiler.lib")
@@ -16,6 +19,7 @@
 #include "SilentEngine/Public/SApplication/SApplication.h"
 #include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
 #include "SilentEngine/Private/SMiscHelpers/SMiscHelpers.h"
+#include "SilentEngine/Private/SMath/SMath.h"
 
 SMeshComponent::SMeshComponent(std::string sComponentName, bool bUseInstancing) : SComponent()
 {
@@ -29,6 +33,11 @@ SMeshComponent::SMeshComponent(std::string sComponentName, bool bUseInstancing)
 	bVertexBufferUsedInComputeShader = false;
 
 	this->bUseInstancing = bUseInstancing;
+
+	vInstanceCullBoundsWorld = SMath::getIdentityMatrix4x4();
+	fInstanceCullBoundsCullDistance = 0.0f;
+	bAllInstanceCullBoundsOutdated = true;
+	iVisibleInstanceCount = 0;
 }
 
 SMeshComponent::~SMeshComponent()
@@ -95,6 +104,7 @@ void SMeshComponent::addInstance(const SInstanceProps& instanceData)
 		std::lock_guard<std::mutex> lock(mtxInstancing);
 
 		vInstanceData.push_back(convertInstancePropsToConstants(instanceData));
+		markInstanceCullBoundsOutdated(static_cast<unsigned int>(vInstanceData.size() - 1));
 
 		if (bSpawnedInLevel)
 		{
@@ -134,6 +144,7 @@ void SMeshComponent::updateInstanceData(unsigned int iInstanceIndex, const SInst
 		std::lock_guard<std::mutex> lock(mtxInstancing);
 
 		vInstanceData[iInstanceIndex] = convertInstancePropsToConstants(instanceData);
+		markInstanceCullBoundsOutdated(iInstanceIndex);
 	}
 }
 
@@ -144,6 +155,8 @@ void SMeshComponent::clearAllInstances()
 		std::lock_guard<std::mutex> lock(mtxInstancing);
 
 		vInstanceData.clear();
+		bAllInstanceCullBoundsOutdated = true;
+		vOutdatedInstanceCullBounds.clear();
 
 		if (bSpawnedInLevel)
 		{
@@ -174,6 +187,13 @@ void SMeshComponent::setMeshData(const SMeshData& meshData, bool bAddedRemovedIn
 	this->meshData = meshData;
 	this->meshData.pMeshMaterial = pOldMat;
 
+	if (pTriangleBVH)
+	{
+		// Will be rebuilt on the next ray cast.
+		delete pTriangleBVH;
+		pTriangleBVH = nullptr;
+	}
+
 	updateObjectBounds();
 
 	if (bAddedRemovedIndices)
@@ -297,7 +317,38 @@ bool SMeshComponent::setMeshMaterial(SMaterial* pMaterial)
 
 void SMeshComponent::setCullDistance(float fCullDistance)
 {
+	mtxComponentProps.lock();
+
 	this->fCullDistance = fCullDistance;
+
+	// Update cull bounds.
+	markObjectCBDirty();
+
+	mtxComponentProps.unlock();
+}
+
+bool SMeshComponent::setInstanceLODDistances(const std::vector<float>& vLODDistances)
+{
+	if (bUseInstancing == false)
+	{
+		return false;
+	}
+
+	for (size_t i = 1; i < vLODDistances.size(); i++)
+	{
+		if (vLODDistances[i] < vLODDistances[i - 1])
+		{
+			SError::showErrorMessageBoxAndLog("LOD distances should be sorted.");
+
+			return true;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mtxInstancing);
+
+	vInstanceLODDistances = vLODDistances;
+
+	return false;
 }
 
 SMaterial* SMeshComponent::getMeshMaterial()
@@ -324,6 +375,13 @@ unsigned int SMeshComponent::getInstanceCount()
 	}
 }
 
+std::vector<size_t> SMeshComponent::getVisibleInstanceCountPerLOD()
+{
+	std::lock_guard<std::mutex> lock(mtxInstancing);
+
+	return vVisibleInstanceCountPerLOD;
+}
+
 bool SMeshComponent::getEnableTransparency() const
 {
 	return bEnableTransparency;
@@ -335,6 +393,11 @@ bool SMeshComponent::setMeshTextureUVOffset(const SVector& vMeshTexUVOffset)
 
 	bool bResult = renderData.setTextureUVOffset(vMeshTexUVOffset);
 
+	if (bResult == false)
+	{
+		markObjectCBDirty();
+	}
+
 	mtxComponentProps.unlock();
 
 	return bResult;
@@ -346,6 +409,8 @@ void SMeshComponent::setTextureUVScale(const SVector& vTextureUVScale)
 
 	renderData.setTextureUVScale(vTextureUVScale);
 
+	markObjectCBDirty();
+
 	mtxComponentProps.unlock();
 }
 
@@ -355,6 +420,8 @@ void SMeshComponent::setTextureUVRotation(float fRotation)
 
 	renderData.setTextureUVRotation(fRotation);
 
+	markObjectCBDirty();
+
 	mtxComponentProps.unlock();
 }
 
@@ -364,7 +431,7 @@ void SMeshComponent::setCustomShaderProperty(unsigned int iCustomProperty)
 
 	renderData.iCustomShaderProperty = iCustomProperty;
 
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+	markObjectCBDirty();
 
 	mtxComponentProps.unlock();
 }
@@ -536,25 +603,6 @@ void SMeshComponent::createGeometryBuffers(bool bAddedRemovedIndices)
 	}
 }
 
-void SMeshComponent::updateMyAndChildsLocationRotationScale(bool bCalledOnSelf)
-{
-	updateWorldMatrix();
-
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-
-
-	if ((bCalledOnSelf == false) && onParentLocationRotationScaleChangedCallback)
-	{
-		onParentLocationRotationScaleChangedCallback(this);
-	}
-
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
-}
-
 SObjectConstants SMeshComponent::convertInstancePropsToConstants(const SInstanceProps& instanceData)
 {
 	SObjectConstants constants;
@@ -593,16 +641,83 @@ SObjectConstants SMeshComponent::convertInstancePropsToConstants(const SInstance
 	return constants;
 }
 
-void SMeshComponent::updateWorldMatrix()
+void SMeshComponent::markInstanceCullBoundsOutdated(unsigned int iInstanceIndex)
 {
-	mtxComponentProps.lock();
+	if (bAllInstanceCullBoundsOutdated)
+	{
+		return;
+	}
 
-	DirectX::XMMATRIX world = getWorldMatrix();
+	// Bounds are updated only when the component is drawn, an instance can be changed many times before that.
+	if (vOutdatedInstanceCullBounds.size() >= vInstanceData.size())
+	{
+		bAllInstanceCullBoundsOutdated = true;
+		vOutdatedInstanceCullBounds.clear();
+		vOutdatedInstanceCullBounds.shrink_to_fit();
 
+		return;
+	}
+
+	vOutdatedInstanceCullBounds.push_back(iInstanceIndex);
+}
+
+void SMeshComponent::updateInstanceCullBounds()
+{
 	mtxWorldMatrixUpdate.lock();
-	XMStoreFloat4x4(&renderData.vWorld, world);
+	DirectX::XMFLOAT4X4 vComponentWorld = renderData.vWorld;
 	mtxWorldMatrixUpdate.unlock();
 
-	mtxComponentProps.unlock();
-}
+	// Bounds of all instances depend on the component.
+	if (std::memcmp(&vComponentWorld, &vInstanceCullBoundsWorld, sizeof(vComponentWorld)) != 0
+		|| std::memcmp(&boxCollision, &instanceCullBoundsBox, sizeof(boxCollision)) != 0
+		|| fCullDistance != fInstanceCullBoundsCullDistance)
+	{
+		bAllInstanceCullBoundsOutdated = true;
+	}
+
+	if (bAllInstanceCullBoundsOutdated == false && vOutdatedInstanceCullBounds.empty())
+	{
+		return;
+	}
+
+	DirectX::XMMATRIX componentWorld = DirectX::XMLoadFloat4x4(&vComponentWorld);
+
+	if (bAllInstanceCullBoundsOutdated)
+	{
+		instanceCullBounds.clear();
+		vOutdatedInstanceCullBounds.clear();
+
+		for (size_t i = 0; i < vInstanceData.size(); i++)
+		{
+			instanceCullBounds.add();
+			vOutdatedInstanceCullBounds.push_back(static_cast<unsigned int>(i));
+		}
+
+		vInstanceCullBoundsWorld = vComponentWorld;
+		instanceCullBoundsBox = boxCollision;
+		fInstanceCullBoundsCullDistance = fCullDistance;
+
+		bAllInstanceCullBoundsOutdated = false;
+	}
 
+	while (instanceCullBounds.size() < vInstanceData.size())
+	{
+		instanceCullBounds.add();
+	}
+
+	for (size_t i = 0; i < vOutdatedInstanceCullBounds.size(); i++)
+	{
+		const unsigned int iInstance = vOutdatedInstanceCullBounds[i];
+
+		DirectX::XMMATRIX instanceWorld =
+			// because instance world is relative to the component's world
+			DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&vInstanceData[iInstance].vWorld), componentWorld);
+
+		DirectX::XMFLOAT4X4 vInstanceWorld;
+		DirectX::XMStoreFloat4x4(&vInstanceWorld, instanceWorld);
+
+		instanceCullBounds.set(iInstance, boxCollision, vInstanceWorld, fCullDistance);
+	}
+
+	vOutdatedInstanceCullBounds.clear();
+}
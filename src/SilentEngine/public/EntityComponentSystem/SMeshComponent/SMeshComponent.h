@@ -15,6 +15,7 @@
 #include "SilentEngine/Private/EntityComponentSystem/SComponent/SComponent.h"
 #include "SilentEngine/Public/SPrimitiveShapeGenerator/SPrimitiveShapeGenerator.h"
 #include "SilentEngine/Private/SFrameResource/SFrameResource.h"
+#include "SilentEngine/Private/SFrustumCuller/SFrustumCuller.h"
 
 class SShader;
 
@@ -158,6 +159,17 @@ public:
 	*/
 	void setCullDistance       (float fCullDistance);
 
+	//@@Function
+	/*
+	* desc: used to set the distances at which instances switch to the next LOD. Visible instances are written to the instance buffer
+	grouped by LOD (LOD 0 first), use getVisibleInstanceCountPerLOD() to find the range of each LOD.
+	* param "vLODDistances": sorted distances, an instance closer to the camera than vLODDistances[0] is LOD 0,
+	an instance at vLODDistances[0] or farther is LOD 1 and so on. Pass an empty array to put all instances in LOD 0 (default).
+	* return: false if successful, true if the distances are not sorted.
+	* remarks: the distance between the camera and the instance location is considered. Does nothing if instancing is disabled.
+	*/
+	bool setInstanceLODDistances(const std::vector<float>& vLODDistances);
+
 	//@@Function
 	/*
 	* desc: used to set the UV offset to the mesh texture. Only affects how the textures will look for THIS mesh.
@@ -220,6 +232,13 @@ public:
 	*/
 	unsigned int getInstanceCount();
 
+	//@@Function
+	/*
+	* desc: used to retrieve the number of visible instances of each LOD after the last frustum culling.
+	* return: empty array if this mesh is not using instancing.
+	*/
+	std::vector<size_t> getVisibleInstanceCountPerLOD();
+
 	//@@Function
 	/*
 	* desc: returns true if the transparency for this component is enabled.
@@ -300,20 +319,22 @@ private:
 	* desc: creates vertex & index buffer (if bAddedRemovedIndices is true).
 	*/
 	void createGeometryBuffers (bool bAddedRemovedIndices);
+
+	SObjectConstants convertInstancePropsToConstants(const SInstanceProps& instanceData);
+
 	//@@Function
 	/*
-	* desc: updates the world matrix using getWorldMatrix().
+	* desc: marks the bounds of the instance as outdated, marks all bounds as outdated if the list of the outdated instances
+	grows to the number of instances (so that it does not grow while the component is not drawn).
+	* remarks: expects mtxInstancing to be locked.
 	*/
-	void updateWorldMatrix     ();
-
+	void markInstanceCullBoundsOutdated(unsigned int iInstanceIndex);
 	//@@Function
 	/*
-	* desc: called when parent's location/rotation/scale are changed.
+	* desc: updates world space bounds of the changed instances (or all instances if the component was changed).
+	* remarks: expects mtxInstancing to be locked.
 	*/
-	virtual void updateMyAndChildsLocationRotationScale(bool bCalledOnSelf) override;
-
-
-	SObjectConstants convertInstancePropsToConstants(const SInstanceProps& instanceData);
+	void updateInstanceCullBounds();
 
 
 	// ------------------------------------------------------------------------------------
@@ -323,6 +344,18 @@ private:
 
 	std::mutex  mtxInstancing;
 
+	// World space bounds of the instances (see updateInstanceCullBounds()), guarded by mtxInstancing.
+	SCullBounds                   instanceCullBounds;
+	std::vector<unsigned int>     vOutdatedInstanceCullBounds;
+	DirectX::XMFLOAT4X4           vInstanceCullBoundsWorld; // component world matrix, collision box and cull distance used for the bounds
+	DirectX::BoundingBox          instanceCullBoundsBox;
+	float                         fInstanceCullBoundsCullDistance;
+	bool                          bAllInstanceCullBoundsOutdated;
+
+	std::vector<float>  vInstanceLODDistances;
+	std::vector<size_t> vVisibleInstanceCountPerLOD;
+	size_t              iVisibleInstanceCount; // written to the frame resource buffer by the last main pass culling
+
 	bool        bVertexBufferUsedInComputeShader;
 	bool        bUseInstancing;
 };
@@ -74,6 +74,7 @@ void SRuntimeMeshComponent::setDisableFrustumCulling(bool bDisable)
 
 	if (bDisableFrustumCulling == false)
 	{
+		std::lock_guard<std::mutex> propsGuard(mtxComponentProps);
 		std::lock_guard<std::mutex> guard(mtxDrawComponent);
 
 		if (meshData.getVerticesCount() > 0)
@@ -148,6 +149,16 @@ void SRuntimeMeshComponent::setMeshData(const SMeshData& meshData, bool bAddedRe
 	this->meshData = meshData;
 	bNewMeshData = true;
 
+	// The vertex buffer is updated when the renderer collects the dirty queue.
+	markObjectCBDirty();
+
+	if (pTriangleBVH)
+	{
+		// Will be rebuilt on the next ray cast.
+		delete pTriangleBVH;
+		pTriangleBVH = nullptr;
+	}
+
 	if (bDisableFrustumCulling == false)
 	{
 		updateObjectBounds();
@@ -261,7 +272,14 @@ bool SRuntimeMeshComponent::setMeshMaterial(SMaterial* pMaterial)
 
 void SRuntimeMeshComponent::setCullDistance(float fCullDistance)
 {
+	mtxComponentProps.lock();
+
 	this->fCullDistance = fCullDistance;
+
+	// Update cull bounds.
+	markObjectCBDirty();
+
+	mtxComponentProps.unlock();
 }
 
 SMaterial* SRuntimeMeshComponent::getMeshMaterial()
@@ -285,6 +303,11 @@ bool SRuntimeMeshComponent::setMeshTextureUVOffset(const SVector& vMeshTexUVOffs
 
 	bool bResult = renderData.setTextureUVOffset(vMeshTexUVOffset);
 
+	if (bResult == false)
+	{
+		markObjectCBDirty();
+	}
+
 	mtxComponentProps.unlock();
 
 	return bResult;
@@ -296,6 +319,8 @@ void SRuntimeMeshComponent::setTextureUVScale(const SVector& vTextureUVScale)
 
 	renderData.setTextureUVScale(vTextureUVScale);
 
+	markObjectCBDirty();
+
 	mtxComponentProps.unlock();
 }
 
@@ -305,6 +330,8 @@ void SRuntimeMeshComponent::setTextureUVRotation(float fRotation)
 
 	renderData.setTextureUVRotation(fRotation);
 
+	markObjectCBDirty();
+
 	mtxComponentProps.unlock();
 }
 
@@ -314,7 +341,7 @@ void SRuntimeMeshComponent::setCustomShaderProperty(unsigned int iCustomProperty
 
 	renderData.iCustomShaderProperty = iCustomProperty;
 
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+	markObjectCBDirty();
 
 	mtxComponentProps.unlock();
 }
@@ -422,38 +449,6 @@ void SRuntimeMeshComponent::createIndexBuffer()
 	}
 }
 
-void SRuntimeMeshComponent::updateWorldMatrix()
-{
-	mtxComponentProps.lock();
-
-	DirectX::XMMATRIX world = getWorldMatrix();
-
-	mtxWorldMatrixUpdate.lock();
-	XMStoreFloat4x4(&renderData.vWorld, world);
-	mtxWorldMatrixUpdate.unlock();
-
-	mtxComponentProps.unlock();
-}
-
-void SRuntimeMeshComponent::updateMyAndChildsLocationRotationScale(bool bCalledOnSelf)
-{
-	updateWorldMatrix();
-
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-
-
-	if ((bCalledOnSelf == false) && onParentLocationRotationScaleChangedCallback)
-	{
-		onParentLocationRotationScaleChangedCallback(this);
-	}
-
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
-}
-
 void SRuntimeMeshComponent::addVertexBuffer(SFrameResource* pFrameResource)
 {
 	if (meshData.getVerticesCount() > 0)
@@ -246,18 +246,6 @@ private:
 	* desc: creates index buffer.
 	*/
 	void createIndexBuffer     ();
-	//@@Function
-	/*
-	* desc: updates world matrix using getWorldMatrix().
-	*/
-	void updateWorldMatrix     ();
-
-	//@@Function
-	/*
-	* desc: called when parent's location/rotation/scale are changed.
-	*/
-	virtual void updateMyAndChildsLocationRotationScale(bool bCalledOnSelf) override;
-
 	//@@Function
 	/*
 	* desc: add a vertex buffer to the specified frame resources.
@@ -17,26 +17,3 @@ STargetComponent::STargetComponent(const std::string& sComponentName)
 STargetComponent::~STargetComponent()
 {
 }
-
-void STargetComponent::updateMyAndChildsLocationRotationScale(bool bCalledOnSelf)
-{
-	mtxComponentProps.lock();
-
-	XMStoreFloat4x4(&renderData.vWorld, getWorldMatrix());
-
-	mtxComponentProps.unlock();
-
-
-	if ((bCalledOnSelf == false) && onParentLocationRotationScaleChangedCallback)
-	{
-		onParentLocationRotationScaleChangedCallback(this);
-	}
-
-
-	renderData.iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
-
-	for (size_t i = 0; i < vChildComponents.size(); i++)
-	{
-		vChildComponents[i]->updateMyAndChildsLocationRotationScale(false);
-	}
-}
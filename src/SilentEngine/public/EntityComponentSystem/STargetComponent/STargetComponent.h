@@ -30,13 +30,5 @@ public:
 	STargetComponent& operator= (const STargetComponent&) = delete;
 
 	virtual ~STargetComponent() override;
-
-private:
-
-	//@@Function
-	/*
-	* desc: called when parent's location/rotation/scale are changed.
-	*/
-	virtual void updateMyAndChildsLocationRotationScale(bool bCalledOnSelf) override;
 };
 
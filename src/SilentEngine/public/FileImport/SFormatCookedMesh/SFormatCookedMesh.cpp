@@ -0,0 +1,449 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "SFormatCookedMesh.h"
+
+// STL
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cfloat>
+
+namespace fs = std::filesystem;
+
+// Custom
+#include "SilentEngine/Private/SError/SError.h"
+#include "SilentEngine/Private/SMemoryMappedFile/SMemoryMappedFile.h"
+#include "SilentEngine/Public/FileImport/SFormatOBJImporter/SFormatOBJImporter.h"
+
+// Increase when the layout of the file or SMeshVertex changes.
+constexpr std::uint32_t COOKED_MESH_VERSION = 1;
+constexpr char COOKED_MESH_MAGIC[4] = { 'S', 'M', 'S', 'H' };
+constexpr std::uint64_t COOKED_MESH_DATA_ALIGNMENT = 16;
+
+constexpr std::uint32_t COOKED_MESH_FLIP_UV_FLAG = 1;
+constexpr std::uint32_t COOKED_MESH_WELD_FLAG = 2;
+
+// All offsets are in bytes from the start of the file.
+struct SCookedMeshFileHeader
+{
+	char          magic[4];
+	std::uint32_t iVersion;
+	std::uint32_t iVertexSizeInBytes;
+	std::uint32_t iIndexSizeInBytes; // 2 or 4
+
+	std::uint64_t iVertexCount;
+	std::uint64_t iIndexCount;
+	std::uint64_t iLODCount;
+
+	std::uint64_t iVertexDataOffset;
+	std::uint64_t iIndexDataOffset;
+	std::uint64_t iLODTableOffset;
+
+	DirectX::XMFLOAT3 vBoundsMin;
+	DirectX::XMFLOAT3 vBoundsMax;
+
+	// Information about the file this mesh was cooked from (zero if it was not cooked from a file).
+	std::int64_t  iSourceWriteTime;
+	std::uint64_t iSourceFileSize;
+	std::uint32_t iSourceImportFlags;
+	std::uint32_t iReserved;
+};
+
+static_assert(sizeof(SCookedMeshFileHeader) == 112, "the layout of the cooked mesh header changed, increase COOKED_MESH_VERSION and update this check");
+
+static std::uint64_t alignCookedMeshOffset(std::uint64_t iOffset)
+{
+	return (iOffset + COOKED_MESH_DATA_ALIGNMENT - 1) & ~(COOKED_MESH_DATA_ALIGNMENT - 1);
+}
+
+bool SFormatCookedMesh::writeMeshDataToFile(const std::wstring& sPathToFile, SMeshData* pMeshData, const std::vector<SCookedMeshLOD>* pLODs)
+{
+	return writeMeshDataToFile(sPathToFile, pMeshData, pLODs, 0, 0, 0);
+}
+
+bool SFormatCookedMesh::importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, DirectX::BoundingBox* pOutBounds,
+	std::vector<SCookedMeshLOD>* pOutLODs)
+{
+	std::string sErrorMessage;
+
+	if (readMeshDataFromFile(sPathToFile, pMeshData, pOutBounds, pOutLODs, sErrorMessage))
+	{
+		SError::showErrorMessageBoxAndLog(sErrorMessage);
+		return true;
+	}
+
+	return false;
+}
+
+bool SFormatCookedMesh::importOBJMeshDataUsingCache(const std::wstring& sPathToOBJFile, const std::wstring& sPathToCacheDirectory, SMeshData* pMeshData,
+	bool bFlipUVByY, bool bWeldVertices, bool* pOutLoadedFromCache)
+{
+	if (pOutLoadedFromCache)
+	{
+		*pOutLoadedFromCache = false;
+	}
+
+	std::error_code error;
+
+	const fs::path pathToSource = fs::absolute(sPathToOBJFile, error);
+	if (error || fs::exists(pathToSource) == false)
+	{
+		SError::showErrorMessageBoxAndLog("the specified file cannot be opened, does it exist?");
+		return true;
+	}
+
+	const std::int64_t  iSourceWriteTime = fs::last_write_time(pathToSource, error).time_since_epoch().count();
+	const std::uint64_t iSourceFileSize  = fs::file_size(pathToSource, error);
+	if (error)
+	{
+		SError::showErrorMessageBoxAndLog("failed to get the information about the source file.");
+		return true;
+	}
+
+	std::uint32_t iImportFlags = 0;
+	if (bFlipUVByY)
+	{
+		iImportFlags |= COOKED_MESH_FLIP_UV_FLAG;
+	}
+	if (bWeldVertices)
+	{
+		iImportFlags |= COOKED_MESH_WELD_FLAG;
+	}
+
+
+	// The name of the cooked file is the hash of the source path and import flags.
+
+	const size_t iKey = std::hash<std::wstring>{}(pathToSource.wstring() + L"|" + std::to_wstring(iImportFlags));
+
+	wchar_t vKey[17];
+	swprintf_s(vKey, L"%016llx", static_cast<unsigned long long>(iKey));
+
+	const fs::path pathToCooked = fs::path(sPathToCacheDirectory) / (pathToSource.stem().wstring() + L"_" + vKey + L".smesh");
+
+
+	// See if the cooked file is up to date.
+
+	std::int64_t  iCookedSourceWriteTime = 0;
+	std::uint64_t iCookedSourceFileSize = 0;
+	std::uint32_t iCookedImportFlags = 0;
+
+	if (readSourceInfo(pathToCooked.wstring(), iCookedSourceWriteTime, iCookedSourceFileSize, iCookedImportFlags) == false &&
+		iCookedSourceWriteTime == iSourceWriteTime && iCookedSourceFileSize == iSourceFileSize && iCookedImportFlags == iImportFlags)
+	{
+		std::string sErrorMessage;
+
+		if (readMeshDataFromFile(pathToCooked.wstring(), pMeshData, nullptr, nullptr, sErrorMessage) == false)
+		{
+			if (pOutLoadedFromCache)
+			{
+				*pOutLoadedFromCache = true;
+			}
+
+			return false;
+		}
+
+		// Truncated or corrupted (for example, the application was closed while the cache was copied), cook it again.
+		fs::remove(pathToCooked, error);
+	}
+
+
+	// Import and cook.
+
+	if (SFormatOBJImporter::importMeshDataFromFileParallel(pathToSource.wstring(), pMeshData, bFlipUVByY, 0, bWeldVertices))
+	{
+		return true;
+	}
+
+	fs::create_directories(sPathToCacheDirectory, error);
+
+	// Failing to write the cache is not fatal, the mesh is already imported.
+	writeMeshDataToFile(pathToCooked.wstring(), pMeshData, nullptr, iSourceWriteTime, iSourceFileSize, iImportFlags);
+
+	return false;
+}
+
+bool SFormatCookedMesh::writeMeshDataToFile(const std::wstring& sPathToFile, SMeshData* pMeshData, const std::vector<SCookedMeshLOD>* pLODs,
+	std::int64_t iSourceWriteTime, std::uint64_t iSourceFileSize, std::uint32_t iSourceImportFlags)
+{
+	const bool bUse16BitIndices = pMeshData->hasIndicesMoreThan16Bits() == false;
+
+	if (pLODs)
+	{
+		for (size_t i = 0; i < pLODs->size(); i++)
+		{
+			if (static_cast<std::uint64_t>((*pLODs)[i].iFirstIndex) + (*pLODs)[i].iIndexCount > pMeshData->getIndicesCount())
+			{
+				SError::showErrorMessageBoxAndLog("the LOD references indices that the mesh does not have.");
+				return true;
+			}
+		}
+	}
+
+	SCookedMeshFileHeader header;
+	std::memset(&header, 0, sizeof(SCookedMeshFileHeader));
+
+	std::memcpy(header.magic, COOKED_MESH_MAGIC, sizeof(COOKED_MESH_MAGIC));
+	header.iVersion           = COOKED_MESH_VERSION;
+	header.iVertexSizeInBytes = sizeof(SMeshVertex);
+	header.iIndexSizeInBytes  = bUse16BitIndices ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+
+	header.iVertexCount = pMeshData->getVerticesCount();
+	header.iIndexCount  = pMeshData->getIndicesCount();
+	header.iLODCount    = pLODs ? pLODs->size() : 0;
+
+	header.iVertexDataOffset = alignCookedMeshOffset(sizeof(SCookedMeshFileHeader));
+	header.iIndexDataOffset  = alignCookedMeshOffset(header.iVertexDataOffset + header.iVertexCount * sizeof(SMeshVertex));
+	header.iLODTableOffset   = alignCookedMeshOffset(header.iIndexDataOffset + header.iIndexCount * header.iIndexSizeInBytes);
+
+	header.iSourceWriteTime   = iSourceWriteTime;
+	header.iSourceFileSize    = iSourceFileSize;
+	header.iSourceImportFlags = iSourceImportFlags;
+
+
+	// Calculate bounds.
+
+	DirectX::XMFLOAT3 vMinf3(FLT_MAX, FLT_MAX, FLT_MAX);
+	DirectX::XMFLOAT3 vMaxf3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	DirectX::XMVECTOR vMin = DirectX::XMLoadFloat3(&vMinf3);
+	DirectX::XMVECTOR vMax = DirectX::XMLoadFloat3(&vMaxf3);
+
+	std::vector<SMeshVertex>* pvVerts = pMeshData->getVertices();
+
+	for (size_t i = 0; i < pvVerts->size(); i++)
+	{
+		DirectX::XMVECTOR P = DirectX::XMLoadFloat3(&pvVerts->operator[](i).vPosition);
+
+		vMin = DirectX::XMVectorMin(vMin, P);
+		vMax = DirectX::XMVectorMax(vMax, P);
+	}
+
+	if (pvVerts->empty())
+	{
+		vMin = DirectX::XMVectorZero();
+		vMax = DirectX::XMVectorZero();
+	}
+
+	DirectX::XMStoreFloat3(&header.vBoundsMin, vMin);
+	DirectX::XMStoreFloat3(&header.vBoundsMax, vMax);
+
+
+	// Write to a temporary file first so that a failed write never leaves a broken cooked file.
+
+	const fs::path pathToTempFile = fs::path(sPathToFile).wstring() + L".tmp";
+
+	std::ofstream meshFile(pathToTempFile, std::ios::binary | std::ios::trunc);
+	if (meshFile.is_open() == false)
+	{
+		SError::showErrorMessageBoxAndLog("failed to create the cooked mesh file.");
+		return true;
+	}
+
+	const char vPadding[COOKED_MESH_DATA_ALIGNMENT] = {};
+
+	auto writePadding = [&](std::uint64_t iOffset) {
+		const std::uint64_t iCurrentOffset = static_cast<std::uint64_t>(meshFile.tellp());
+		meshFile.write(vPadding, static_cast<std::streamsize>(iOffset - iCurrentOffset));
+	};
+
+	meshFile.write(reinterpret_cast<const char*>(&header), sizeof(SCookedMeshFileHeader));
+
+	writePadding(header.iVertexDataOffset);
+	meshFile.write(reinterpret_cast<const char*>(pvVerts->data()), static_cast<std::streamsize>(header.iVertexCount * sizeof(SMeshVertex)));
+
+	writePadding(header.iIndexDataOffset);
+	if (bUse16BitIndices)
+	{
+		std::vector<std::uint16_t>* pIndices = pMeshData->getIndices16();
+		meshFile.write(reinterpret_cast<const char*>(pIndices->data()), static_cast<std::streamsize>(header.iIndexCount * sizeof(std::uint16_t)));
+	}
+	else
+	{
+		std::vector<std::uint32_t>* pIndices = pMeshData->getIndices32();
+		meshFile.write(reinterpret_cast<const char*>(pIndices->data()), static_cast<std::streamsize>(header.iIndexCount * sizeof(std::uint32_t)));
+	}
+
+	writePadding(header.iLODTableOffset);
+	if (header.iLODCount > 0)
+	{
+		meshFile.write(reinterpret_cast<const char*>(pLODs->data()), static_cast<std::streamsize>(header.iLODCount * sizeof(SCookedMeshLOD)));
+	}
+
+	const bool bWriteFailed = meshFile.fail();
+
+	meshFile.close();
+
+	std::error_code error;
+
+	if (bWriteFailed)
+	{
+		fs::remove(pathToTempFile, error);
+
+		SError::showErrorMessageBoxAndLog("failed to write the cooked mesh file.");
+		return true;
+	}
+
+	fs::rename(pathToTempFile, sPathToFile, error);
+	if (error)
+	{
+		fs::remove(pathToTempFile, error);
+
+		SError::showErrorMessageBoxAndLog("failed to write the cooked mesh file.");
+		return true;
+	}
+
+	return false;
+}
+
+bool SFormatCookedMesh::readSourceInfo(const std::wstring& sPathToFile, std::int64_t& iSourceWriteTime, std::uint64_t& iSourceFileSize, std::uint32_t& iSourceImportFlags)
+{
+	std::ifstream meshFile(fs::path(sPathToFile), std::ios::binary);
+	if (meshFile.is_open() == false)
+	{
+		return true;
+	}
+
+	SCookedMeshFileHeader header;
+	meshFile.read(reinterpret_cast<char*>(&header), sizeof(SCookedMeshFileHeader));
+
+	if (meshFile.gcount() != sizeof(SCookedMeshFileHeader) ||
+		std::memcmp(header.magic, COOKED_MESH_MAGIC, sizeof(COOKED_MESH_MAGIC)) != 0 ||
+		header.iVersion != COOKED_MESH_VERSION || header.iVertexSizeInBytes != sizeof(SMeshVertex))
+	{
+		return true;
+	}
+
+	iSourceWriteTime   = header.iSourceWriteTime;
+	iSourceFileSize    = header.iSourceFileSize;
+	iSourceImportFlags = header.iSourceImportFlags;
+
+	return false;
+}
+
+bool SFormatCookedMesh::readMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, DirectX::BoundingBox* pOutBounds,
+	std::vector<SCookedMeshLOD>* pOutLODs, std::string& sOutErrorMessage)
+{
+	SMemoryMappedFile meshFile;
+	if (meshFile.open(sPathToFile))
+	{
+		sOutErrorMessage = "the specified file cannot be opened, does it exist?";
+		return true;
+	}
+
+
+	// Validate the header.
+
+	if (meshFile.getSize() < sizeof(SCookedMeshFileHeader))
+	{
+		sOutErrorMessage = "the file is not a cooked mesh file.";
+		return true;
+	}
+
+	SCookedMeshFileHeader header;
+	std::memcpy(&header, meshFile.getData(), sizeof(SCookedMeshFileHeader));
+
+	if (std::memcmp(header.magic, COOKED_MESH_MAGIC, sizeof(COOKED_MESH_MAGIC)) != 0)
+	{
+		sOutErrorMessage = "the file is not a cooked mesh file.";
+		return true;
+	}
+
+	if (header.iVersion != COOKED_MESH_VERSION || header.iVertexSizeInBytes != sizeof(SMeshVertex))
+	{
+		sOutErrorMessage = "the cooked mesh file was made by a different version of the engine, cook it again.";
+		return true;
+	}
+
+	if (header.iIndexSizeInBytes != sizeof(std::uint16_t) && header.iIndexSizeInBytes != sizeof(std::uint32_t))
+	{
+		sOutErrorMessage = "the cooked mesh file is corrupted.";
+		return true;
+	}
+
+	const std::uint64_t iFileSize = meshFile.getSize();
+
+	if (header.iVertexDataOffset > iFileSize || header.iVertexCount > (iFileSize - header.iVertexDataOffset) / sizeof(SMeshVertex) ||
+		header.iIndexDataOffset > iFileSize || header.iIndexCount > (iFileSize - header.iIndexDataOffset) / header.iIndexSizeInBytes ||
+		header.iLODTableOffset > iFileSize || header.iLODCount > (iFileSize - header.iLODTableOffset) / sizeof(SCookedMeshLOD) ||
+		header.iIndexCount > UINT32_MAX)
+	{
+		sOutErrorMessage = "the cooked mesh file is corrupted.";
+		return true;
+	}
+
+
+	// Validate the body (indices and LODs are used to draw the mesh so they should never point outside of the buffers).
+
+	std::vector<SCookedMeshLOD> vLODs(header.iLODCount);
+
+	if (header.iLODCount > 0)
+	{
+		std::memcpy(vLODs.data(), meshFile.getData() + header.iLODTableOffset, header.iLODCount * sizeof(SCookedMeshLOD));
+	}
+
+	for (size_t i = 0; i < vLODs.size(); i++)
+	{
+		if (static_cast<std::uint64_t>(vLODs[i].iFirstIndex) + vLODs[i].iIndexCount > header.iIndexCount)
+		{
+			sOutErrorMessage = "the cooked mesh file is corrupted (LOD references indices that the mesh does not have).";
+			return true;
+		}
+	}
+
+	const void* pIndexData = meshFile.getData() + header.iIndexDataOffset;
+
+	for (std::uint64_t i = 0; i < header.iIndexCount; i++)
+	{
+		const std::uint64_t iIndex = (header.iIndexSizeInBytes == sizeof(std::uint16_t)) ?
+			static_cast<const std::uint16_t*>(pIndexData)[i] : static_cast<const std::uint32_t*>(pIndexData)[i];
+
+		if (iIndex >= header.iVertexCount)
+		{
+			sOutErrorMessage = "the cooked mesh file is corrupted (index references a vertex that the mesh does not have).";
+			return true;
+		}
+	}
+
+
+	// Copy the data.
+
+	pMeshData->clearVertices();
+	pMeshData->clearIndices();
+
+	const SMeshVertex* pVertices = reinterpret_cast<const SMeshVertex*>(meshFile.getData() + header.iVertexDataOffset);
+	pMeshData->vVertices.assign(pVertices, pVertices + header.iVertexCount);
+
+	if (header.iIndexSizeInBytes == sizeof(std::uint16_t))
+	{
+		const std::uint16_t* pIndices = static_cast<const std::uint16_t*>(pIndexData);
+
+		// Keep both versions so that getIndices16() does not need to convert anything.
+		pMeshData->vIndices16.assign(pIndices, pIndices + header.iIndexCount);
+		pMeshData->vIndices32.assign(pIndices, pIndices + header.iIndexCount);
+		pMeshData->bHasIndicesMoreThan16Bits = false;
+	}
+	else
+	{
+		const std::uint32_t* pIndices = static_cast<const std::uint32_t*>(pIndexData);
+
+		pMeshData->vIndices32.assign(pIndices, pIndices + header.iIndexCount);
+		pMeshData->bHasIndicesMoreThan16Bits = true;
+	}
+
+	if (pOutBounds)
+	{
+		DirectX::BoundingBox::CreateFromPoints(*pOutBounds, DirectX::XMLoadFloat3(&header.vBoundsMin), DirectX::XMLoadFloat3(&header.vBoundsMax));
+	}
+
+	if (pOutLODs)
+	{
+		*pOutLODs = std::move(vLODs);
+	}
+
+	return false;
+}
@@ -0,0 +1,89 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#pragma once
+
+// STL
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// DirectX
+#include <DirectXCollision.h>
+
+// Custom
+#include "SilentEngine/Public/SPrimitiveShapeGenerator/SPrimitiveShapeGenerator.h"
+
+//@@Struct
+/*
+The struct represents one level of detail stored in the cooked mesh file as a range of indices.
+*/
+struct SCookedMeshLOD
+{
+	//@@Variable
+	/* the index of the first index of this LOD in the mesh indices. */
+	std::uint32_t iFirstIndex = 0;
+	//@@Variable
+	/* the number of indices in this LOD. */
+	std::uint32_t iIndexCount = 0;
+	//@@Variable
+	/* the maximum distance from the camera at which this LOD should be used. */
+	float fMaxViewDistance = 0.0f;
+	std::uint32_t iReserved = 0;
+};
+
+//@@Class
+/*
+The class is used to write and read mesh data in the engine's binary "cooked mesh" format (.smesh).
+Cooked meshes store the vertices in the same layout as SMeshVertex so they are loaded with a single copy
+instead of parsing text, which makes them much faster to load than .obj files.
+*/
+class SFormatCookedMesh
+{
+public:
+
+	//@@Function
+	/*
+	* desc: used to write the mesh data to the cooked mesh file.
+	* param "pLODs": optional, the table of LODs (ranges of the mesh indices) to store.
+	* return: false if successful, true otherwise.
+	*/
+	static bool writeMeshDataToFile(const std::wstring& sPathToFile, SMeshData* pMeshData, const std::vector<SCookedMeshLOD>* pLODs = nullptr);
+
+	//@@Function
+	/*
+	* desc: used to read mesh data from the cooked mesh file (the file is memory-mapped) into the 'pMeshData' pointer.
+	* param "pOutBounds": optional, will be filled with the bounding box of the mesh that was calculated when the file was written.
+	* param "pOutLODs": optional, will be filled with the LOD table of the mesh (empty if the file has no LODs).
+	* return: false if successful, true otherwise.
+	*/
+	static bool importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, DirectX::BoundingBox* pOutBounds = nullptr,
+		std::vector<SCookedMeshLOD>* pOutLODs = nullptr);
+
+	//@@Function
+	/*
+	* desc: used to read mesh data from .obj file using the cooked mesh cache. If the cache directory has a cooked version of this
+	.obj file that was made from the same file (path, last write time and size) with the same import settings, the cooked
+	file is loaded (a truncated or corrupted cooked file is treated as missing), otherwise the .obj file is imported using SFormatOBJImporter::importMeshDataFromFileParallel() and cooked for the next time.
+	* param "sPathToCacheDirectory": the directory to store the cooked files in, will be created if it does not exist.
+	* param "pOutLoadedFromCache": optional, will be set to true if the mesh was loaded from the cache.
+	* return: false if successful, true otherwise.
+	*/
+	static bool importOBJMeshDataUsingCache(const std::wstring& sPathToOBJFile, const std::wstring& sPathToCacheDirectory, SMeshData* pMeshData,
+		bool bFlipUVByY = true, bool bWeldVertices = true, bool* pOutLoadedFromCache = nullptr);
+
+private:
+
+	SFormatCookedMesh() = default;
+
+	static bool writeMeshDataToFile(const std::wstring& sPathToFile, SMeshData* pMeshData, const std::vector<SCookedMeshLOD>* pLODs,
+		std::int64_t iSourceWriteTime, std::uint64_t iSourceFileSize, std::uint32_t iSourceImportFlags);
+	// Same as importMeshDataFromFile() but does not show errors (returns the error message).
+	static bool readMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, DirectX::BoundingBox* pOutBounds,
+		std::vector<SCookedMeshLOD>* pOutLODs, std::string& sOutErrorMessage);
+	static bool readSourceInfo(const std::wstring& sPathToFile, std::int64_t& iSourceWriteTime, std::uint64_t& iSourceFileSize, std::uint32_t& iSourceImportFlags);
+};
@@ -10,14 +10,19 @@
 // STL
 #include <fstream>
 #include <filesystem>
+#include <charconv>
+#include <thread>
+#include <cstring>
+#include <algorithm>
 
 namespace fs = std::filesystem;
 
 // Custom
 #include "SilentEngine/Private/SError/SError.h"
+#include "SilentEngine/Private/SMemoryMappedFile/SMemoryMappedFile.h"
 #include "SilentEngine/Public/SVector/SVector.h"
 
-bool SFormatOBJImporter::importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY)
+bool SFormatOBJImporter::importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY, bool bWeldVertices, SMeshWeldStats* pOutWeldStats)
 {
 	// See if the file exists.
 
@@ -49,6 +54,9 @@ bool SFormatOBJImporter::importMeshDataFromFile(const std::wstring& sPathToFile,
 	std::vector<SVector> vUVs;
 	std::vector<SVector> vNormals;
 
+	SOBJVertexWelder welder;
+	size_t iCornerCount = 0;
+
 	pMeshData->clearVertices();
 	pMeshData->clearIndices();
 
@@ -109,8 +117,28 @@ bool SFormatOBJImporter::importMeshDataFromFile(const std::wstring& sPathToFile,
 
 				SMeshVertex vertex(vVertices[iVertexIndex], vNormal, SVector(), vUV);
 
-				pMeshData->addVertex(vertex);
-				pMeshData->addIndex(static_cast<uint32_t>(pMeshData->getVerticesCount() - 1));
+				if (bWeldVertices)
+				{
+					SOBJFaceCorner corner;
+					corner.iVertexIndex = iVertexIndex;
+					corner.iUVIndex     = iUVIndex;
+					corner.iNormalIndex = iNormalIndex;
+
+					std::uint32_t iIndex = 0;
+					if (findOrAddWeldedVertex(&welder, corner, static_cast<uint32_t>(pMeshData->getVerticesCount()), iIndex))
+					{
+						pMeshData->addVertex(vertex);
+					}
+
+					pMeshData->addIndex(iIndex);
+				}
+				else
+				{
+					pMeshData->addVertex(vertex);
+					pMeshData->addIndex(static_cast<uint32_t>(pMeshData->getVerticesCount() - 1));
+				}
+
+				iCornerCount++;
 
 				iVertexCount++;
 
@@ -132,9 +160,588 @@ bool SFormatOBJImporter::importMeshDataFromFile(const std::wstring& sPathToFile,
 
 	objFile.close();
 
+	if (pOutWeldStats)
+	{
+		pOutWeldStats->iVertexCountBeforeWeld = iCornerCount;
+		pOutWeldStats->iVertexCountAfterWeld  = pMeshData->getVerticesCount();
+	}
+
 	return false;
 }
 
+bool SFormatOBJImporter::importMeshDataFromFileParallel(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY, unsigned int iThreadCount,
+	bool bWeldVertices, SMeshWeldStats* pOutWeldStats)
+{
+	// (use ISO C++17 Standard for no errors on MSVC 2019 toolset)
+	if (fs::path(sPathToFile).extension().string() != ".obj")
+	{
+		// Not an .obj file.
+
+		SError::showErrorMessageBoxAndLog("file format is not '.obj'.");
+		return true;
+	}
+
+	SMemoryMappedFile objFile;
+	if (objFile.open(sPathToFile))
+	{
+		SError::showErrorMessageBoxAndLog("the specified file cannot be opened, does it exist?");
+		return true;
+	}
+
+	pMeshData->clearVertices();
+	pMeshData->clearIndices();
+
+	if (objFile.getSize() == 0)
+	{
+		return false;
+	}
+
+
+	// Split the file into chunks at line boundaries.
+
+	if (iThreadCount == 0)
+	{
+		iThreadCount = std::max<unsigned int>(1, std::thread::hardware_concurrency());
+	}
+
+	// Don't spawn threads for tiny chunks.
+	const size_t iMinChunkSizeInBytes = 256 * 1024;
+
+	const size_t iChunkCount = std::min<size_t>(iThreadCount, std::max<size_t>(1, objFile.getSize() / iMinChunkSizeInBytes));
+
+	const char* pFileBegin = objFile.getData();
+	const char* pFileEnd   = pFileBegin + objFile.getSize();
+
+	std::vector<SOBJChunk> vChunks(iChunkCount);
+
+	const char* pChunkBegin = pFileBegin;
+	for (size_t i = 0; i < iChunkCount; i++)
+	{
+		const char* pChunkEnd = pFileEnd;
+
+		if (i + 1 < iChunkCount)
+		{
+			pChunkEnd = std::max<const char*>(pChunkBegin, pFileBegin + (objFile.getSize() / iChunkCount) * (i + 1));
+
+			// Move to the start of the next line.
+			pChunkEnd = static_cast<const char*>(std::memchr(pChunkEnd, '\n', pFileEnd - pChunkEnd));
+			pChunkEnd = (pChunkEnd == nullptr) ? pFileEnd : pChunkEnd + 1;
+		}
+
+		vChunks[i].pBegin = pChunkBegin;
+		vChunks[i].pEnd   = pChunkEnd;
+
+		pChunkBegin = pChunkEnd;
+	}
+
+
+	// Parse chunks (the first one is parsed on this thread).
+
+	std::vector<std::thread> vThreads;
+	vThreads.reserve(iChunkCount - 1);
+
+	for (size_t i = 1; i < iChunkCount; i++)
+	{
+		vThreads.push_back(std::thread(&SFormatOBJImporter::parseChunk, &vChunks[i], bFlipUVByY));
+	}
+
+	parseChunk(&vChunks[0], bFlipUVByY);
+
+	for (size_t i = 0; i < vThreads.size(); i++)
+	{
+		vThreads[i].join();
+	}
+
+	vThreads.clear();
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		if (vChunks[i].sErrorMessage.empty() == false)
+		{
+			SError::showErrorMessageBoxAndLog(vChunks[i].sErrorMessage);
+			return true;
+		}
+	}
+
+
+	// Calculate where the data of each chunk goes.
+
+	size_t iPositionCount = 0;
+	size_t iUVCount       = 0;
+	size_t iNormalCount   = 0;
+	size_t iCornerCount   = 0;
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		vChunks[i].iPositionOffset = iPositionCount;
+		vChunks[i].iUVOffset       = iUVCount;
+		vChunks[i].iNormalOffset   = iNormalCount;
+		vChunks[i].iCornerOffset   = iCornerCount;
+
+		iPositionCount += vChunks[i].vPositions.size();
+		iUVCount       += vChunks[i].vUVs.size();
+		iNormalCount   += vChunks[i].vNormals.size();
+		iCornerCount   += vChunks[i].vCorners.size();
+	}
+
+	if (iCornerCount > static_cast<size_t>(UINT32_MAX))
+	{
+		SError::showErrorMessageBoxAndLog("the mesh has too many vertices.");
+		return true;
+	}
+
+
+	// Merge vertex attributes.
+
+	std::vector<DirectX::XMFLOAT3> vPositions(iPositionCount);
+	std::vector<DirectX::XMFLOAT2> vUVs(iUVCount);
+	std::vector<DirectX::XMFLOAT3> vNormals(iNormalCount);
+
+	for (size_t i = 0; i < vChunks.size(); i++)
+	{
+		if (vChunks[i].vPositions.empty() == false)
+		{
+			std::memcpy(&vPositions[vChunks[i].iPositionOffset], vChunks[i].vPositions.data(), vChunks[i].vPositions.size() * sizeof(DirectX::XMFLOAT3));
+		}
+
+		if (vChunks[i].vUVs.empty() == false)
+		{
+			std::memcpy(&vUVs[vChunks[i].iUVOffset], vChunks[i].vUVs.data(), vChunks[i].vUVs.size() * sizeof(DirectX::XMFLOAT2));
+		}
+
+		if (vChunks[i].vNormals.empty() == false)
+		{
+			std::memcpy(&vNormals[vChunks[i].iNormalOffset], vChunks[i].vNormals.data(), vChunks[i].vNormals.size() * sizeof(DirectX::XMFLOAT3));
+		}
+
+		vChunks[i].vPositions = std::vector<DirectX::XMFLOAT3>();
+		vChunks[i].vUVs       = std::vector<DirectX::XMFLOAT2>();
+		vChunks[i].vNormals   = std::vector<DirectX::XMFLOAT3>();
+	}
+
+
+	std::vector<std::string> vErrorMessages(iChunkCount);
+
+	if (bWeldVertices)
+	{
+		// Welding needs to see all previous corners so it's done on this thread.
+
+		pMeshData->vVertices.reserve(iPositionCount);
+		pMeshData->vIndices32.resize(iCornerCount);
+
+		fillWeldedVertices(&vChunks, &vPositions, &vUVs, &vNormals, pMeshData, &vErrorMessages[0]);
+
+		pMeshData->vVertices.shrink_to_fit();
+		pMeshData->bHasIndicesMoreThan16Bits = pMeshData->vVertices.size() > static_cast<size_t>(UINT16_MAX) + 1;
+	}
+	else
+	{
+		// Fill the mesh data (each chunk writes to its own range).
+
+		pMeshData->vVertices.resize(iCornerCount);
+		pMeshData->vIndices32.resize(iCornerCount);
+		pMeshData->bHasIndicesMoreThan16Bits = iCornerCount > static_cast<size_t>(UINT16_MAX) + 1;
+
+		for (size_t i = 1; i < iChunkCount; i++)
+		{
+			vThreads.push_back(std::thread(&SFormatOBJImporter::fillChunkVertices, &vChunks[i], &vPositions, &vUVs, &vNormals, pMeshData, &vErrorMessages[i]));
+		}
+
+		fillChunkVertices(&vChunks[0], &vPositions, &vUVs, &vNormals, pMeshData, &vErrorMessages[0]);
+
+		for (size_t i = 0; i < vThreads.size(); i++)
+		{
+			vThreads[i].join();
+		}
+	}
+
+	for (size_t i = 0; i < vErrorMessages.size(); i++)
+	{
+		if (vErrorMessages[i].empty() == false)
+		{
+			pMeshData->clearVertices();
+			pMeshData->clearIndices();
+
+			SError::showErrorMessageBoxAndLog(vErrorMessages[i]);
+			return true;
+		}
+	}
+
+	if (pOutWeldStats)
+	{
+		pOutWeldStats->iVertexCountBeforeWeld = iCornerCount;
+		pOutWeldStats->iVertexCountAfterWeld  = pMeshData->vVertices.size();
+	}
+
+	return false;
+}
+
+void SFormatOBJImporter::parseChunk(SOBJChunk* pChunk, bool bFlipUVByY)
+{
+	const char* pCurrent = pChunk->pBegin;
+
+	while (pCurrent < pChunk->pEnd)
+	{
+		const char* pLineEnd = static_cast<const char*>(std::memchr(pCurrent, '\n', pChunk->pEnd - pCurrent));
+		if (pLineEnd == nullptr)
+		{
+			pLineEnd = pChunk->pEnd;
+		}
+
+		const size_t iLineSize = pLineEnd - pCurrent;
+
+		if (iLineSize >= 2 && pCurrent[0] == 'v')
+		{
+			if (pCurrent[1] == ' ' || pCurrent[1] == '\t')
+			{
+				DirectX::XMFLOAT3 vPosition = { 0.0f, 0.0f, 0.0f };
+
+				const char* pRead = readFloat(pCurrent + 2, pLineEnd, vPosition.x);
+				if (pRead) pRead = readFloat(pRead, pLineEnd, vPosition.y);
+				if (pRead) pRead = readFloat(pRead, pLineEnd, vPosition.z);
+
+				if (pRead == nullptr)
+				{
+					pChunk->sErrorMessage = "failed to read vertex position.";
+					return;
+				}
+
+				pChunk->vPositions.push_back(vPosition);
+			}
+			else if (pCurrent[1] == 't')
+			{
+				DirectX::XMFLOAT2 vUV = { 0.0f, 0.0f };
+
+				const char* pRead = readFloat(pCurrent + 2, pLineEnd, vUV.x);
+				if (pRead) pRead = readFloat(pRead, pLineEnd, vUV.y);
+
+				if (pRead == nullptr)
+				{
+					pChunk->sErrorMessage = "failed to read vertex UV.";
+					return;
+				}
+
+				if (bFlipUVByY)
+				{
+					vUV.y = 1.0f - vUV.y;
+				}
+
+				pChunk->vUVs.push_back(vUV);
+			}
+			else if (pCurrent[1] == 'n')
+			{
+				DirectX::XMFLOAT3 vNormal = { 0.0f, 0.0f, 0.0f };
+
+				const char* pRead = readFloat(pCurrent + 2, pLineEnd, vNormal.x);
+				if (pRead) pRead = readFloat(pRead, pLineEnd, vNormal.y);
+				if (pRead) pRead = readFloat(pRead, pLineEnd, vNormal.z);
+
+				if (pRead == nullptr)
+				{
+					pChunk->sErrorMessage = "failed to read vertex normal.";
+					return;
+				}
+
+				DirectX::XMStoreFloat3(&vNormal, DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&vNormal)));
+
+				pChunk->vNormals.push_back(vNormal);
+			}
+		}
+		else if (iLineSize >= 2 && pCurrent[0] == 'f' && (pCurrent[1] == ' ' || pCurrent[1] == '\t'))
+		{
+			size_t iVertexCount = 0;
+
+			const char* pRead = skipSpaces(pCurrent + 2, pLineEnd);
+
+			while (pRead < pLineEnd)
+			{
+				if (iVertexCount == 3)
+				{
+					pChunk->sErrorMessage = "object faces are not triangulated.";
+					return;
+				}
+
+				SOBJFaceCorner corner;
+				bool bRelative = false;
+
+				pRead = readIndex(pRead, pLineEnd, pChunk->vPositions.size(), corner.iVertexIndex, bRelative);
+				if (bRelative) corner.iRelativeFlags |= iRelativeVertexFlag;
+
+				if (pRead && pRead < pLineEnd && *pRead == '/')
+				{
+					pRead++;
+
+					if (pRead < pLineEnd && *pRead != '/')
+					{
+						pRead = readIndex(pRead, pLineEnd, pChunk->vUVs.size(), corner.iUVIndex, bRelative);
+						if (bRelative) corner.iRelativeFlags |= iRelativeUVFlag;
+					}
+
+					if (pRead && pRead < pLineEnd && *pRead == '/')
+					{
+						pRead++;
+
+						pRead = readIndex(pRead, pLineEnd, pChunk->vNormals.size(), corner.iNormalIndex, bRelative);
+						if (bRelative) corner.iRelativeFlags |= iRelativeNormalFlag;
+					}
+				}
+
+				if (pRead == nullptr)
+				{
+					pChunk->sErrorMessage = "failed to read face.";
+					return;
+				}
+
+				pChunk->vCorners.push_back(corner);
+				iVertexCount++;
+
+				pRead = skipSpaces(pRead, pLineEnd);
+			}
+
+			if (iVertexCount != 3)
+			{
+				pChunk->sErrorMessage = "object faces are not triangulated.";
+				return;
+			}
+		}
+
+		if (pLineEnd == pChunk->pEnd)
+		{
+			break;
+		}
+
+		pCurrent = pLineEnd + 1;
+	}
+}
+
+void SFormatOBJImporter::fillChunkVertices(const SOBJChunk* pChunk, const std::vector<DirectX::XMFLOAT3>* pPositions,
+	const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshData* pMeshData, std::string* pErrorMessage)
+{
+	for (size_t i = 0; i < pChunk->vCorners.size(); i++)
+	{
+		SOBJFaceCorner corner;
+		if (resolveCorner(pChunk, pChunk->vCorners[i], pPositions->size(), pUVs->size(), pNormals->size(), corner, pErrorMessage))
+		{
+			return;
+		}
+
+		const size_t iMeshVertexIndex = pChunk->iCornerOffset + i;
+
+		fillVertex(corner, pPositions, pUVs, pNormals, pMeshData->vVertices[iMeshVertexIndex]);
+
+		pMeshData->vIndices32[iMeshVertexIndex] = static_cast<std::uint32_t>(iMeshVertexIndex);
+	}
+}
+
+void SFormatOBJImporter::fillWeldedVertices(const std::vector<SOBJChunk>* pChunks, const std::vector<DirectX::XMFLOAT3>* pPositions,
+	const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshData* pMeshData, std::string* pErrorMessage)
+{
+	SOBJVertexWelder welder;
+	welder.vFirstEntryByPosition.resize(pPositions->size(), SOBJVertexWelder::iNoEntry);
+
+	size_t iIndex = 0;
+
+	for (size_t iChunk = 0; iChunk < pChunks->size(); iChunk++)
+	{
+		const SOBJChunk* pChunk = &(*pChunks)[iChunk];
+
+		for (size_t i = 0; i < pChunk->vCorners.size(); i++)
+		{
+			SOBJFaceCorner corner;
+			if (resolveCorner(pChunk, pChunk->vCorners[i], pPositions->size(), pUVs->size(), pNormals->size(), corner, pErrorMessage))
+			{
+				return;
+			}
+
+			std::uint32_t iVertexIndex = 0;
+			if (findOrAddWeldedVertex(&welder, corner, static_cast<std::uint32_t>(pMeshData->vVertices.size()), iVertexIndex))
+			{
+				pMeshData->vVertices.push_back(SMeshVertex());
+				fillVertex(corner, pPositions, pUVs, pNormals, pMeshData->vVertices.back());
+			}
+
+			pMeshData->vIndices32[iIndex] = iVertexIndex;
+			iIndex++;
+		}
+	}
+}
+
+bool SFormatOBJImporter::resolveCorner(const SOBJChunk* pChunk, const SOBJFaceCorner& corner, size_t iPositionCount, size_t iUVCount,
+	size_t iNormalCount, SOBJFaceCorner& outCorner, std::string* pErrorMessage)
+{
+	long long iVertexIndex = corner.iVertexIndex;
+	if (corner.iRelativeFlags & iRelativeVertexFlag)
+	{
+		iVertexIndex += static_cast<long long>(pChunk->iPositionOffset);
+	}
+
+	if (iVertexIndex < 0 || iVertexIndex >= static_cast<long long>(iPositionCount))
+	{
+		*pErrorMessage = "face references a vertex that does not exist.";
+		return true;
+	}
+
+	outCorner.iVertexIndex = static_cast<int>(iVertexIndex);
+	outCorner.iUVIndex     = iNoIndex;
+	outCorner.iNormalIndex = iNoIndex;
+	outCorner.iRelativeFlags = 0;
+
+	if (corner.iUVIndex != iNoIndex)
+	{
+		long long iUVIndex = corner.iUVIndex;
+		if (corner.iRelativeFlags & iRelativeUVFlag)
+		{
+			iUVIndex += static_cast<long long>(pChunk->iUVOffset);
+		}
+
+		if (iUVIndex < 0 || iUVIndex >= static_cast<long long>(iUVCount))
+		{
+			*pErrorMessage = "face references a UV that does not exist.";
+			return true;
+		}
+
+		outCorner.iUVIndex = static_cast<int>(iUVIndex);
+	}
+
+	if (corner.iNormalIndex != iNoIndex)
+	{
+		long long iNormalIndex = corner.iNormalIndex;
+		if (corner.iRelativeFlags & iRelativeNormalFlag)
+		{
+			iNormalIndex += static_cast<long long>(pChunk->iNormalOffset);
+		}
+
+		if (iNormalIndex < 0 || iNormalIndex >= static_cast<long long>(iNormalCount))
+		{
+			*pErrorMessage = "face references a normal that does not exist.";
+			return true;
+		}
+
+		outCorner.iNormalIndex = static_cast<int>(iNormalIndex);
+	}
+
+	return false;
+}
+
+void SFormatOBJImporter::fillVertex(const SOBJFaceCorner& corner, const std::vector<DirectX::XMFLOAT3>* pPositions,
+	const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshVertex& vertex)
+{
+	vertex.vPosition = (*pPositions)[corner.iVertexIndex];
+
+	if (corner.iUVIndex != iNoIndex)
+	{
+		vertex.vUV = (*pUVs)[corner.iUVIndex];
+	}
+
+	if (corner.iNormalIndex != iNoIndex)
+	{
+		vertex.vNormal = (*pNormals)[corner.iNormalIndex];
+	}
+}
+
+bool SFormatOBJImporter::findOrAddWeldedVertex(SOBJVertexWelder* pWelder, const SOBJFaceCorner& corner, std::uint32_t iNewVertexIndex, std::uint32_t& iOutVertexIndex)
+{
+	// Corners are bucketed by the position index (which is a perfect hash for it),
+	// so we only need to compare UV and normal indices of the corners that share the position.
+
+	if (static_cast<size_t>(corner.iVertexIndex) >= pWelder->vFirstEntryByPosition.size())
+	{
+		pWelder->vFirstEntryByPosition.resize(static_cast<size_t>(corner.iVertexIndex) + 1, SOBJVertexWelder::iNoEntry);
+	}
+
+	std::uint32_t iEntry = pWelder->vFirstEntryByPosition[corner.iVertexIndex];
+
+	while (iEntry != SOBJVertexWelder::iNoEntry)
+	{
+		const SOBJVertexWelder::SEntry& entry = pWelder->vEntries[iEntry];
+
+		if (entry.iUVIndex == corner.iUVIndex && entry.iNormalIndex == corner.iNormalIndex)
+		{
+			iOutVertexIndex = entry.iVertexIndex;
+			return false;
+		}
+
+		iEntry = entry.iNextEntry;
+	}
+
+	SOBJVertexWelder::SEntry newEntry;
+	newEntry.iUVIndex     = corner.iUVIndex;
+	newEntry.iNormalIndex = corner.iNormalIndex;
+	newEntry.iVertexIndex = iNewVertexIndex;
+	newEntry.iNextEntry   = pWelder->vFirstEntryByPosition[corner.iVertexIndex];
+
+	pWelder->vFirstEntryByPosition[corner.iVertexIndex] = static_cast<std::uint32_t>(pWelder->vEntries.size());
+	pWelder->vEntries.push_back(newEntry);
+
+	iOutVertexIndex = iNewVertexIndex;
+
+	return true;
+}
+
+const char* SFormatOBJImporter::skipSpaces(const char* pCurrent, const char* pEnd)
+{
+	while (pCurrent < pEnd && (*pCurrent == ' ' || *pCurrent == '\t' || *pCurrent == '\r'))
+	{
+		pCurrent++;
+	}
+
+	return pCurrent;
+}
+
+const char* SFormatOBJImporter::readFloat(const char* pCurrent, const char* pEnd, float& fValue)
+{
+	pCurrent = skipSpaces(pCurrent, pEnd);
+
+	if (pCurrent == pEnd)
+	{
+		// Missing values are zero (same as in importMeshDataFromFile()).
+		return pCurrent;
+	}
+
+	if (*pCurrent == '+')
+	{
+		pCurrent++;
+	}
+
+	std::from_chars_result result = std::from_chars(pCurrent, pEnd, fValue);
+	if (result.ec != std::errc())
+	{
+		return nullptr;
+	}
+
+	return result.ptr;
+}
+
+const char* SFormatOBJImporter::readIndex(const char* pCurrent, const char* pEnd, size_t iLocalCount, int& iIndex, bool& bRelative)
+{
+	if (pCurrent == nullptr)
+	{
+		return nullptr;
+	}
+
+	int iValue = 0;
+
+	std::from_chars_result result = std::from_chars(pCurrent, pEnd, iValue);
+	if (result.ec != std::errc() || iValue == 0)
+	{
+		return nullptr;
+	}
+
+	if (iValue > 0)
+	{
+		iIndex = iValue - 1; // start from 0.
+		bRelative = false;
+	}
+	else
+	{
+		// Relative to the last element read so far.
+		iIndex = static_cast<int>(iLocalCount) + iValue;
+		bRelative = true;
+	}
+
+	return result.ptr;
+}
+
 SVector SFormatOBJImporter::readValues(const std::string& sLine, size_t iReadStartIndex, size_t iValueCount)
 {
 	size_t iReadValues = 0;
@@ -9,10 +9,27 @@
 
 // STL
 #include <string>
+#include <vector>
+#include <climits>
+#include <cstdint>
 
 // Custom
 #include "SilentEngine/Public/SPrimitiveShapeGenerator/SPrimitiveShapeGenerator.h"
 
+//@@Struct
+/*
+The struct is used to get the results of the vertex welding done by the SFormatOBJImporter.
+*/
+struct SMeshWeldStats
+{
+	//@@Variable
+	/* the number of vertices the mesh would have without welding (one vertex per face corner). */
+	size_t iVertexCountBeforeWeld = 0;
+	//@@Variable
+	/* the number of unique vertices in the imported mesh. */
+	size_t iVertexCountAfterWeld = 0;
+};
+
 //@@Class
 /*
 The class is used to import mesh data from files with the .obj format.
@@ -25,9 +42,29 @@ public:
 	/*
 	* desc: used to read mesh data from .obj file into the 'pMeshData' pointer.
 	* param "pMeshData": a pointer to your SMeshData instance that will be filled.
+	* param "bWeldVertices": if true, face corners that reference the same position, UV and normal will share one vertex,
+	otherwise every face corner is a separate vertex. Welded meshes use 16-bit indices if the vertex count allows it.
+	* param "pOutWeldStats": optional, will be filled with the vertex count before and after the welding.
 	* return: false if successful, true otherwise.
 	*/
-	static bool importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY = true);
+	static bool importMeshDataFromFile(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY = true, bool bWeldVertices = false,
+		SMeshWeldStats* pOutWeldStats = nullptr);
+
+	//@@Function
+	/*
+	* desc: used to read mesh data from .obj file into the 'pMeshData' pointer. Unlike importMeshDataFromFile() the file is
+	memory-mapped, split into chunks (at line boundaries) and the chunks are parsed in parallel, which makes
+	this function much faster on big files. The result is the same as in importMeshDataFromFile().
+	* param "pMeshData": a pointer to your SMeshData instance that will be filled.
+	* param "iThreadCount": the number of threads used to parse the file, 0 to use all hardware threads.
+	Small files are parsed using less threads.
+	* param "bWeldVertices": if true, face corners that reference the same position, UV and normal will share one vertex,
+	otherwise every face corner is a separate vertex. Welded meshes use 16-bit indices if the vertex count allows it.
+	* param "pOutWeldStats": optional, will be filled with the vertex count before and after the welding.
+	* return: false if successful, true otherwise.
+	*/
+	static bool importMeshDataFromFileParallel(const std::wstring& sPathToFile, SMeshData* pMeshData, bool bFlipUVByY = true, unsigned int iThreadCount = 0,
+		bool bWeldVertices = false, SMeshWeldStats* pOutWeldStats = nullptr);
 
 private:
 
@@ -36,5 +73,75 @@ private:
 	static SVector readValues(const std::string& sLine, size_t iReadStartIndex, size_t iValueCount);
 	static void    readVertex(const std::string& sLine, size_t& iReadIndex, int& iVertexIndex, int& iUVIndex, int& iNormalIndex);
 	static std::string  readVertexValue(const std::string& sLine, size_t& iReadIndex);
-};
 
+	static constexpr int iNoIndex = INT_MIN;
+
+	// Face corner as written in the file (already converted to start from 0).
+	// Negative (relative) indices are stored relative to the start of the chunk
+	// and marked in 'iRelativeFlags', they are resolved when the chunk offsets are known.
+	struct SOBJFaceCorner
+	{
+		int iVertexIndex = 0;
+		int iUVIndex     = iNoIndex;
+		int iNormalIndex = iNoIndex;
+
+		unsigned char iRelativeFlags = 0;
+	};
+
+	static constexpr unsigned char iRelativeVertexFlag = 1;
+	static constexpr unsigned char iRelativeUVFlag     = 2;
+	static constexpr unsigned char iRelativeNormalFlag = 4;
+
+	struct SOBJChunk
+	{
+		const char* pBegin = nullptr;
+		const char* pEnd   = nullptr;
+
+		std::vector<DirectX::XMFLOAT3> vPositions;
+		std::vector<DirectX::XMFLOAT2> vUVs;
+		std::vector<DirectX::XMFLOAT3> vNormals;
+		std::vector<SOBJFaceCorner>    vCorners;
+
+		size_t iPositionOffset = 0;
+		size_t iUVOffset       = 0;
+		size_t iNormalOffset   = 0;
+		size_t iCornerOffset   = 0;
+
+		std::string sErrorMessage; // empty if no error
+	};
+
+	// Unique (position, UV, normal) corners bucketed by the position index.
+	struct SOBJVertexWelder
+	{
+		struct SEntry
+		{
+			int iUVIndex = iNoIndex;
+			int iNormalIndex = iNoIndex;
+
+			std::uint32_t iVertexIndex = 0;
+			std::uint32_t iNextEntry = 0;
+		};
+
+		static constexpr std::uint32_t iNoEntry = UINT32_MAX;
+
+		std::vector<std::uint32_t> vFirstEntryByPosition;
+		std::vector<SEntry>        vEntries;
+	};
+
+	static void parseChunk        (SOBJChunk* pChunk, bool bFlipUVByY);
+	static void fillChunkVertices (const SOBJChunk* pChunk, const std::vector<DirectX::XMFLOAT3>* pPositions,
+		const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshData* pMeshData, std::string* pErrorMessage);
+	static void fillWeldedVertices(const std::vector<SOBJChunk>* pChunks, const std::vector<DirectX::XMFLOAT3>* pPositions,
+		const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshData* pMeshData, std::string* pErrorMessage);
+	// Converts chunk-relative indices to absolute, returns true if the corner references something that does not exist.
+	static bool resolveCorner     (const SOBJChunk* pChunk, const SOBJFaceCorner& corner, size_t iPositionCount, size_t iUVCount, size_t iNormalCount,
+		SOBJFaceCorner& outCorner, std::string* pErrorMessage);
+	static void fillVertex        (const SOBJFaceCorner& corner, const std::vector<DirectX::XMFLOAT3>* pPositions,
+		const std::vector<DirectX::XMFLOAT2>* pUVs, const std::vector<DirectX::XMFLOAT3>* pNormals, SMeshVertex& vertex);
+	// Returns true if the corner was not seen before (the caller should add a new vertex with the index 'iNewVertexIndex').
+	static bool findOrAddWeldedVertex(SOBJVertexWelder* pWelder, const SOBJFaceCorner& corner, std::uint32_t iNewVertexIndex, std::uint32_t& iOutVertexIndex);
+
+	static const char* skipSpaces (const char* pCurrent, const char* pEnd);
+	static const char* readFloat  (const char* pCurrent, const char* pEnd, float& fValue);
+	static const char* readIndex  (const char* pCurrent, const char* pEnd, size_t iLocalCount, int& iIndex, bool& bRelative);
+};
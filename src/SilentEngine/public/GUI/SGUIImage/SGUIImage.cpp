@@ -17,7 +17,6 @@ namespace fs = std::filesystem;
 #include "ResourceUploadBatch.h"
 #include "WICTextureLoader.h"
 #include "DDSTextureLoader.h"
-#include "CommonStates.h"
 #include "DirectXHelpers.h"
 
 // Custom
@@ -86,17 +85,8 @@ bool SGUIImage::loadImage(std::wstring_view sPathToImage)
 	}
 
 
-	DirectX::RenderTargetState rtState(pApp->BackBufferFormat, pApp->DepthStencilFormat);
-	rtState.sampleDesc.Count = pApp->MSAA_Enabled ? pApp->MSAA_SampleCount : 1;
-	rtState.sampleDesc.Quality = pApp->MSAA_Enabled ? (pApp->MSAA_Quality - 1) : 0;
-	D3D12_BLEND_DESC* bd = nullptr;
-	if (bIsDDS == false)
-	{
-		bd = const_cast<D3D12_BLEND_DESC*>(&DirectX::CommonStates::NonPremultiplied);
-	}
-	DirectX::SpriteBatchPipelineStateDescription pd(rtState, bd);
-
-	pSpriteBatch = std::make_unique<DirectX::SpriteBatch>(pApp->pDevice.Get(), resourceUpload, pd);
+	// Drawn using the shared sprite batch with the matching blend state.
+	bPremultipliedAlpha = bIsDDS;
 
 	DirectX::XMUINT2 texSize = DirectX::GetTextureSize(pTexture.Get());
 
@@ -116,10 +106,15 @@ bool SGUIImage::loadImage(std::wstring_view sPathToImage)
 	auto uploadResourcesFinished = resourceUpload.End(pApp->pCommandQueue.Get());
 	uploadResourcesFinished.wait();
 
-	pSpriteBatch->SetViewport(pApp->ScreenViewport);
-
 	recalculateSizeToKeepScaling();
 
+	if (layoutData.pLayout)
+	{
+		// Same as getFullSizeInPixels() (which locks mtxSprite).
+		updateLayoutContentSize(SVector(static_cast<float>(texSize.x * static_cast<uint32_t>(scale.x)),
+			static_cast<float>(texSize.y * static_cast<uint32_t>(scale.y))));
+	}
+
 	sPathToTexture = sPathToImage;
 
 	if (bIsRegistered)
@@ -195,10 +190,10 @@ void SGUIImage::setViewport(D3D12_VIEWPORT viewport)
 {
 	std::lock_guard<std::mutex> guard(mtxSprite);
 
-	if (pSpriteBatch)
+	// The viewport of the sprite batches is set by the SGUISpriteRenderer.
+
+	if (pTexture)
 	{
-		pSpriteBatch->SetViewport(viewport);
-		
 		recalculateSizeToKeepScaling();
 	}
 }
@@ -266,4 +261,5 @@ SGUIImage::SGUIImage(const std::string& sObjectName, bool bInteractable) : SGUIO
 	sourceRect = { 0.0f, 0.0f, 1.0f, 1.0f };
 
 	bIsInteractable = bInteractable;
+	bPremultipliedAlpha = true;
 }
@@ -101,8 +101,8 @@ protected:
 private:
 
 	friend class SApplication;
+	friend class SGUISpriteRenderer;
 
-	std::unique_ptr<DirectX::SpriteBatch>  pSpriteBatch = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12Resource> pTexture;
 
 	std::function<void(SGUIImage*)> noFocus;
@@ -119,5 +119,6 @@ private:
 	int          iIndexInHeap;
 
 	bool         bIsInteractable;
+	bool         bPremultipliedAlpha; // .dds images are premultiplied, others are drawn with non-premultiplied blending
 };
 
@@ -79,12 +79,6 @@ void SGUILayout::addChild(SGUIObject* pChildObject, int iRatio)
 		return;
 	}
 
-	if (pChildObject->objectType == SGUIType::SGT_LAYOUT)
-	{
-		SError::showErrorMessageBoxAndLog("sorry, but a layout inside of another layout is not implemented yet.");
-		return;
-	}
-
 	// See if already added.
 	for (size_t i = 0; i < vChilds.size(); i++)
 	{
@@ -95,15 +89,34 @@ void SGUILayout::addChild(SGUIObject* pChildObject, int iRatio)
 		}
 	}
 
-	vChilds.push_back(SLayoutChild{ pChildObject, iRatio });
+	SApplication* pApp = SApplication::getApp();
 
-	pChildObject->layoutData.pLayout = this;
-	pChildObject->origin = DirectX::SimpleMath::Vector2(0.5f, 0.5f);
+	if (pChildObject->objectType == SGUIType::SGT_LAYOUT)
+	{
+		std::lock_guard<std::mutex> layoutGuard(pApp->mtxGUILayout);
 
-	if (bIsRegistered)
+		if (pApp->guiLayoutSolver.addChild(iLayoutNodeId, pChildObject->iLayoutNodeId, iRatio))
+		{
+			SError::showErrorMessageBoxAndLog("a layout can't be added to itself or to its own child layout.");
+			return;
+		}
+	}
+	else
 	{
-		recalculateSizeToKeepScaling();
+		// Locks mtxSprite so should not be called under mtxGUILayout.
+		SVector vChildSize = pChildObject->getFullSizeInPixels();
+
+		std::lock_guard<std::mutex> layoutGuard(pApp->mtxGUILayout);
+
+		pChildObject->iLayoutNodeId = pApp->guiLayoutSolver.createItemNode(pChildObject);
+		pApp->guiLayoutSolver.setContentSize(pChildObject->iLayoutNodeId, vChildSize.getX(), vChildSize.getY());
+		pApp->guiLayoutSolver.addChild(iLayoutNodeId, pChildObject->iLayoutNodeId, iRatio);
 	}
+
+	vChilds.push_back(SLayoutChild{ pChildObject, iRatio });
+
+	pChildObject->layoutData.pLayout = this;
+	pChildObject->origin = DirectX::SimpleMath::Vector2(0.5f, 0.5f);
 }
 
 void SGUILayout::setPosition(const SVector& vPos)
@@ -125,16 +138,15 @@ void SGUILayout::setIndent(SLayoutIndent layoutIndent)
 
 	this->layoutIndent = layoutIndent;
 
-	if (bIsRegistered)
-	{
-		recalculateSizeToKeepScaling();
-	}
+	updateLayoutParams();
 }
 
 void SGUILayout::setScale(const SVector& vScale)
 {
 	SGUIObject::setScale(vScale);
 
+	updateLayoutParams();
+
 #if defined(DEBUG) || defined(_DEBUG)
 	pDebugLayoutFillImage->setScale(vScale);
 #endif
@@ -144,10 +156,7 @@ void SGUILayout::setAlignment(SLayoutAlignment alignment)
 {
 	layoutAlignment = alignment;
 
-	if (bIsRegistered)
-	{
-		recalculateSizeToKeepScaling();
-	}
+	updateLayoutParams();
 }
 
 #if defined(DEBUG) || defined(_DEBUG)
@@ -178,10 +187,7 @@ bool SGUILayout::removeChild(SGUIObject* pChildObject)
 			pChildObject->layoutData.pLayout = nullptr;
 			pChildObject->bIsVisible = false;
 
-			if (bIsRegistered)
-			{
-				recalculateSizeToKeepScaling();
-			}
+			removeChildFromSolver(pChildObject);
 
 			return false;
 		}
@@ -199,6 +205,8 @@ void SGUILayout::removeAllChilds()
 		vChilds[i].pChild->layoutData.pLayout = nullptr;
 		vChilds[i].pChild->screenScale = DirectX::XMFLOAT2(1.0f, 1.0f);
 		vChilds[i].pChild->bIsVisible = false;
+
+		removeChildFromSolver(vChilds[i].pChild);
 	}
 
 	vChilds.clear();
@@ -222,8 +230,7 @@ std::vector<SLayoutChild>* SGUILayout::getChilds()
 
 void SGUILayout::setViewport(D3D12_VIEWPORT viewport)
 {
-	std::lock_guard<std::mutex> guard(mtxChilds);
-	recalculateSizeToKeepScaling();
+	// The screen size is passed to the layout solver before the GUI is drawn.
 }
 
 bool SGUILayout::checkRequiredResourcesBeforeRegister()
@@ -233,140 +240,56 @@ bool SGUILayout::checkRequiredResourcesBeforeRegister()
 
 void SGUILayout::recalculateSizeToKeepScaling()
 {
-	if (vChilds.size() == 0)
-	{
-		return;
-	}
-
-	SScreenResolution res;
-	SApplication::getApp()->getVideoSettings()->getCurrentScreenResolution(&res);
-
-	float fFullWidth = static_cast<float>(fWidth * res.iWidth);
-	float fFullHeight = static_cast<float>(fHeight * res.iHeight);
-
-	fFullWidth *= scale.x;
-	fFullHeight *= scale.y;
-
 	screenScale.x = 1.0f; // no additional scaling
 	screenScale.y = 1.0f; // no additional scaling
 
-	// Calculate screenScale for every child.
-	int iFullRatio = 0;
-	for (size_t i = 0; i < vChilds.size(); i++)
-	{
-		if (bExpandItems == false)
-		{
-			vChilds[i].iRatio = 1; // ignore ratios
-		}
-
-		iFullRatio += vChilds[i].iRatio;
-	}
+	updateLayoutParams();
+}
 
-	float fPosBefore = 0.0f;
+SGUILayoutParams SGUILayout::getLayoutParams() const
+{
+	SGUILayoutParams params;
+	params.layoutType = layoutType;
+	params.alignment = layoutAlignment;
+	params.indent = layoutIndent;
+	params.fWidth = fWidth;
+	params.fHeight = fHeight;
+	params.fScaleX = scale.x;
+	params.fScaleY = scale.y;
+	params.bExpandItems = bExpandItems;
+
+	return params;
+}
 
-	for (size_t i = 0; i < vChilds.size(); i++)
+void SGUILayout::updateLayoutParams()
+{
+	if (iLayoutNodeId == SGUILayoutSolver::iInvalidNodeId)
 	{
-		DirectX::XMFLOAT2 vChildPos = pos;
-		vChildPos.x -= fWidth / 2.0f;
-		vChildPos.y -= fHeight / 2.0f;
+		return; // not registered yet, the params will be set on register
+	}
 
-		DirectX::XMFLOAT2 vScreenScale = DirectX::XMFLOAT2(1.0f, 1.0f);
+	SApplication* pApp = SApplication::getApp();
 
-		SVector vChildSize = vChilds[i].pChild->getFullSizeInPixels();
+	std::lock_guard<std::mutex> layoutGuard(pApp->mtxGUILayout);
 
-		vChilds[i].pChild->origin = DirectX::SimpleMath::Vector2(0.0f, 0.0f);
+	pApp->guiLayoutSolver.setLayoutParams(iLayoutNodeId, getLayoutParams());
+}
 
-		if (layoutType == SLayoutType::SLT_HORIZONTAL)
-		{
-			vScreenScale.y = fFullHeight / vChildSize.getY();
-			vScreenScale.x = (fFullWidth * (vChilds[i].iRatio / static_cast<float>(iFullRatio))) / vChildSize.getX();
-
-			if (bExpandItems)
-			{
-				vChildPos.x += fPosBefore + fWidth * (vChilds[i].iRatio / static_cast<float>(iFullRatio)) / 2.0f;
-				vChildPos.y += fHeight / 2.0f;
-			}
-			else
-			{
-				vChildPos.x += fPosBefore;
-
-				if (layoutAlignment == SLayoutAlignment::SLA_CENTER)
-				{
-					vChildPos.y += fHeight / 2.0f;
-					vChilds[i].pChild->origin = DirectX::SimpleMath::Vector2(0.5f, 0.0f);
-				}
-				else if (layoutAlignment == SLayoutAlignment::SLA_RIGHT)
-				{
-					vChildPos.y += fHeight;
-					vChilds[i].pChild->origin = DirectX::SimpleMath::Vector2(1.0f, 0.0f);
-
-					vChildPos.x -= fWidth * layoutIndent.fRightIndent;
-				}
-				else // SLA_LEFT
-				{
-					vChildPos.x += fWidth * layoutIndent.fLeftIndent;
-				}
-
-				vChildPos.y += fHeight * layoutIndent.fTopIndent - fHeight * layoutIndent.fBottomIndent;
-
-				vChilds[i].pChild->vSizeToKeep = SVector(fWidth * (vChilds[i].iRatio / static_cast<float>(iFullRatio)), fHeight);
-				vChilds[i].pChild->recalculateSizeToKeepScaling();
-			}
-
-			fPosBefore += fWidth * (vChilds[i].iRatio / static_cast<float>(iFullRatio));
-		}
-		else
-		{
-			vScreenScale.x = fFullWidth / vChildSize.getX();
-			vScreenScale.y = (fFullHeight * (vChilds[i].iRatio / static_cast<float>(iFullRatio))) / vChildSize.getY();
-
-			if (bExpandItems)
-			{
-				vChildPos.x += fWidth / 2.0f;
-				vChildPos.y += fPosBefore + fHeight * (vChilds[i].iRatio / static_cast<float>(iFullRatio)) / 2.0f;
-			}
-			else
-			{
-				vChildPos.y += fPosBefore;
-
-				if (layoutAlignment == SLayoutAlignment::SLA_CENTER)
-				{
-					vChildPos.x += fWidth / 2.0f;
-					vChilds[i].pChild->origin = DirectX::SimpleMath::Vector2(0.5f, 0.0f);
-				}
-				else if (layoutAlignment == SLayoutAlignment::SLA_RIGHT)
-				{
-					vChildPos.x += fWidth;
-					vChilds[i].pChild->origin = DirectX::SimpleMath::Vector2(1.0f, 0.0f);
-
-					vChildPos.x -= fWidth * layoutIndent.fRightIndent;
-				}
-				else // SLA_LEFT
-				{
-					vChildPos.x += fWidth * layoutIndent.fLeftIndent;
-				}
-
-
-				vChildPos.y += fHeight * layoutIndent.fTopIndent - fHeight * layoutIndent.fBottomIndent;
-
-
-				vChilds[i].pChild->vSizeToKeep = SVector(fWidth, fHeight * (vChilds[i].iRatio / static_cast<float>(iFullRatio)));
-				vChilds[i].pChild->recalculateSizeToKeepScaling();
-			}
-
-			fPosBefore += fHeight * (vChilds[i].iRatio / static_cast<float>(iFullRatio));
-		}
+void SGUILayout::removeChildFromSolver(SGUIObject* pChildObject)
+{
+	SApplication* pApp = SApplication::getApp();
 
-		if (bExpandItems)
-		{
-			vChilds[i].pChild->layoutScreenScale = vScreenScale;
-		}
-		else
-		{
-			vChilds[i].pChild->layoutScreenScale = DirectX::XMFLOAT2(1.0f, 1.0f);
-		}
+	std::lock_guard<std::mutex> layoutGuard(pApp->mtxGUILayout);
 
-		vChilds[i].pChild->pos = vChildPos - pos; // offset from the center of the layout
+	if (pChildObject->objectType == SGUIType::SGT_LAYOUT)
+	{
+		// The node of the layout lives until the layout is unregistered.
+		pApp->guiLayoutSolver.removeFromParent(pChildObject->iLayoutNodeId);
+	}
+	else
+	{
+		pApp->guiLayoutSolver.destroyNode(pChildObject->iLayoutNodeId);
+		pChildObject->iLayoutNodeId = SGUILayoutSolver::iInvalidNodeId;
 	}
 }
 
@@ -13,6 +13,7 @@
 
 // Custom
 #include "SilentEngine/Private/GUI/SGUIObject/SGUIObject.h"
+#include "SilentEngine/Private/GUI/SGUILayoutSolver/SGUILayoutSolver.h"
 
 #if defined(DEBUG) || defined(_DEBUG)
 class SGUIImage;
@@ -24,27 +25,6 @@ struct SLayoutChild
 	int iRatio;
 };
 
-enum class SLayoutType
-{
-	SLT_HORIZONTAL,
-	SLT_VERTICAL,
-};
-
-enum class SLayoutAlignment
-{
-	SLA_LEFT,
-	SLA_CENTER,
-	SLA_RIGHT,
-};
-
-struct SLayoutIndent
-{
-	float fLeftIndent = 0.0f;
-	float fRightIndent = 0.0f;
-	float fTopIndent = 0.0f;
-	float fBottomIndent = 0.0f;
-};
-
 //@@Class
 /*
 This class represents a layout that can have child GUI object.
@@ -75,7 +55,8 @@ public:
 	* desc: adds the object as a child to this layout.
 	* param "pChildObject": child object to add.
 	* param "fRatio": the ratio that this child object will take in the layout. Ignored when 'bExpandItems' is 'false'.
-	* remarks: for example, add 2 child objects with ratios 1 and 1, this means that the first one will take 50% of the layout space,
+	* remarks: a layout can be added to another layout, in this case its width and height are controlled by the parent layout.
+	For example, add 2 child objects with ratios 1 and 1, this means that the first one will take 50% of the layout space,
 	and the second one also takes 50% of the layout space. Another example, add 2 child objects with ratios 2 and 1, this means that the first
 	one will take (2 / (2 + 1)) = 66% of the layout space, and the other one 33% of the layout space.
 	*/
@@ -149,10 +130,14 @@ protected:
 
 	virtual void setViewport(D3D12_VIEWPORT viewport) override;
 	virtual bool checkRequiredResourcesBeforeRegister() override;
-	// call under mtxChilds
 	virtual void recalculateSizeToKeepScaling() override;
 	virtual SVector getFullSizeInPixels() override;
 
+	// childs are positioned by the SApplication's layout solver before the GUI is drawn
+	SGUILayoutParams getLayoutParams() const;
+	void updateLayoutParams();
+	void removeChildFromSolver(SGUIObject* pChildObject);
+
 	std::vector<SLayoutChild> vChilds;
 
 #if defined(DEBUG) || defined(_DEBUG)
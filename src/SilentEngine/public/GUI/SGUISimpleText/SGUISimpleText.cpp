@@ -14,21 +14,54 @@
 namespace fs = std::filesystem;
 
 // DirectXTK
-#include "ResourceUploadBatch.h"
-#include "CommonStates.h"
 #include "DirectXHelpers.h"
 
 // Custom
 #include "SilentEngine/Public/SApplication/SApplication.h"
 #include "SilentEngine/Private/SError/SError.h"
 
+//@@Class
+/*
+Provides the glyphs of a DirectXTK's SpriteFont to the SGUITextLayout.
+*/
+class SGUISpriteFontGlyphSource : public SGUIGlyphSource
+{
+public:
+	SGUISpriteFontGlyphSource(const DirectX::SpriteFont* pFont) : pFont(pFont) {}
+
+	virtual SGUIGlyph getGlyph(wchar_t character) const override
+	{
+		const DirectX::SpriteFont::Glyph* pGlyph = pFont->FindGlyph(character);
+
+		SGUIGlyph glyph;
+		glyph.iCharacter = pGlyph->Character;
+		glyph.iLeft = pGlyph->Subrect.left;
+		glyph.iTop = pGlyph->Subrect.top;
+		glyph.iRight = pGlyph->Subrect.right;
+		glyph.iBottom = pGlyph->Subrect.bottom;
+		glyph.fXOffset = pGlyph->XOffset;
+		glyph.fYOffset = pGlyph->YOffset;
+		glyph.fXAdvance = pGlyph->XAdvance;
+
+		return glyph;
+	}
+
+	virtual float getLineSpacing() const override
+	{
+		return pFont->GetLineSpacing();
+	}
+
+private:
+
+	const DirectX::SpriteFont* pFont;
+};
+
 SGUISimpleText::SGUISimpleText(const std::string& sObjectName) : SGUIObject(sObjectName)
 {
 	objectType = SGUIType::SGT_SIMPLE_TEXT;
 
 	sPathToSpriteFont = L"";
 	sRawText = L"";
-	sWrappedText = L"";
 
 	fMaxLineWidth = 0.0f;
 
@@ -95,7 +128,7 @@ void SGUISimpleText::setText(const std::wstring& sText)
 
 	if (pSpriteFont)
 	{
-		sWrappedText = wrapText();
+		updateLayout();
 		recalculateSizeToKeepScaling();
 	}
 }
@@ -126,7 +159,7 @@ void SGUISimpleText::setWordWrapMaxLineWidth(float fMaxLineWidth, bool bAlignTex
 
 	if (pSpriteFont)
 	{
-		sWrappedText = wrapText();
+		updateLayout();
 	}
 }
 
@@ -141,9 +174,11 @@ SVector SGUISimpleText::getSizeInPixels()
 
 	if (pSpriteFont)
 	{
-		DirectX::SimpleMath::Vector2 texSize = DirectX::SimpleMath::Vector2(pSpriteFont->MeasureString(sWrappedText.c_str(), false));
+		float fWidth = 0.0f;
+		float fHeight = 0.0f;
+		textLayout.getSize(fWidth, fHeight, false);
 
-		return SVector(texSize.x, texSize.y);
+		return SVector(fWidth, fHeight);
 	}
 	else
 	{
@@ -155,9 +190,12 @@ void SGUISimpleText::setViewport(D3D12_VIEWPORT viewport)
 {
 	std::lock_guard<std::mutex> guard(mtxSprite);
 
-	if (pSpriteBatch)
+	// The viewport of the sprite batches is set by the SGUISpriteRenderer.
+
+	if (pSpriteFont)
 	{
-		pSpriteBatch->SetViewport(viewport);
+		// Wrapping depends on the screen width.
+		updateLayout();
 
 		recalculateSizeToKeepScaling();
 	}
@@ -189,7 +227,8 @@ void SGUISimpleText::recalculateSizeToKeepScaling()
 	float fTargetWidth = vSizeToKeep.getX() * SApplication::getApp()->iMainWindowWidth;
 	float fTargetHeight = vSizeToKeep.getY() * SApplication::getApp()->iMainWindowHeight;
 
-	DirectX::SimpleMath::Vector2 texSize = DirectX::SimpleMath::Vector2(pSpriteFont->MeasureString(sWrappedText.c_str(), false));
+	DirectX::SimpleMath::Vector2 texSize;
+	textLayout.getSize(texSize.x, texSize.y, false);
 
 	texSize.x *= scale.x;
 	texSize.y *= scale.y;
@@ -229,7 +268,8 @@ void SGUISimpleText::recalculateSizeToKeepScaling()
 
 SVector SGUISimpleText::getFullSizeInPixels()
 {
-	DirectX::SimpleMath::Vector2 texSize = DirectX::SimpleMath::Vector2(pSpriteFont->MeasureString(sWrappedText.c_str(), false));
+	DirectX::SimpleMath::Vector2 texSize;
+	textLayout.getSize(texSize.x, texSize.y, false);
 
 	texSize.x *= scale.x;
 	texSize.y *= scale.y;
@@ -237,112 +277,37 @@ SVector SGUISimpleText::getFullSizeInPixels()
 	return SVector(texSize.x, texSize.y);
 }
 
-std::wstring SGUISimpleText::wrapText()
+void SGUISimpleText::updateLayout()
 {
-	if (fMaxLineWidth < 0.001f)
-	{
-		return sRawText;
-	}
-
-	std::vector<std::wstring> vWords;
-
-	// Split.
-	std::wstring sCurrentWord = L"";
-	for (size_t i = 0; i < sRawText.size(); i++)
-	{
-		if (sRawText[i] == L' ' && sCurrentWord != L"")
-		{
-			vWords.push_back(sCurrentWord);
-			sCurrentWord = L"";
-		}
-		else
-		{
-			sCurrentWord += sRawText[i];
-		}
-	}
-
-	if (sCurrentWord != L"")
+	if (pSpriteFont == nullptr)
 	{
-		vWords.push_back(sCurrentWord);
+		textLayout.clear();
+		return;
 	}
 
-
-	float fCurrentLineWidth = 0.0f;
-	float fSpaceWidth = DirectX::SimpleMath::Vector2(pSpriteFont->MeasureString(L" ", false)).x;
-
-	std::wstring sWrappedText = L"";
-
 	SApplication* pApp = SApplication::getApp();
-	float fWindowMaxLineWidth = fMaxLineWidth * pApp->ScreenViewport.Width;
 
-	size_t iLastLineStartIndex = 0;
+	SGUISpriteFontGlyphSource glyphSource(pSpriteFont.get());
 
-	for (size_t i = 0; i < vWords.size(); i++)
-	{
-		DirectX::SimpleMath::Vector2 wordSize(pSpriteFont->MeasureString(vWords[i].c_str()));
+	textLayout.build(&glyphSource, sRawText, fMaxLineWidth * pApp->ScreenViewport.Width, bAlignTextAtCenter,
+		pApp->ScreenViewport.Width * 0.1f);
 
-		if (fCurrentLineWidth + wordSize.x < fWindowMaxLineWidth)
-		{
-			sWrappedText.append(vWords[i] + L" ");
-			fCurrentLineWidth += wordSize.x + fSpaceWidth;
-		}
-		else
-		{
-			sWrappedText += L"\n";
-
-			iLastLineStartIndex = sWrappedText.size();
-
-			sWrappedText.append(vWords[i] + L" ");
-			fCurrentLineWidth = wordSize.x + fSpaceWidth;
-		}
-	}
-
-	if (bAlignTextAtCenter)
+	if (layoutData.pLayout)
 	{
-		float fDeltaInPixels = pApp->ScreenViewport.Width * 0.1f;
-		if (fCurrentLineWidth < fWindowMaxLineWidth - fDeltaInPixels)
-		{
-			float fNeedToAdd = fWindowMaxLineWidth - fCurrentLineWidth;
-			size_t iAddCount = static_cast<size_t>(fNeedToAdd / fSpaceWidth / 2.0);
-
-			for (size_t i = 0; i < iAddCount; i++)
-			{
-				sWrappedText.insert(sWrappedText.begin() + iLastLineStartIndex, L' ');
-			}
-		}
+		updateLayoutContentSize(getFullSizeInPixels());
 	}
-
-	return sWrappedText;
 }
 
 void SGUISimpleText::initFontResource()
 {
 	SApplication* pApp = SApplication::getApp();
 
-	DirectX::ResourceUploadBatch resourceUpload(pApp->pDevice.Get());
-
-	resourceUpload.Begin();
-
-	pSpriteFont = std::make_unique<DirectX::SpriteFont>(pApp->pDevice.Get(), resourceUpload, sPathToSpriteFont.c_str(), cpuHandle, gpuHandle);
-
-	DirectX::RenderTargetState rtState(pApp->BackBufferFormat, pApp->DepthStencilFormat);
-	rtState.sampleDesc.Count = pApp->MSAA_Enabled ? pApp->MSAA_SampleCount : 1;
-	rtState.sampleDesc.Quality = pApp->MSAA_Enabled ? (pApp->MSAA_Quality - 1) : 0;
-	DirectX::SpriteBatchPipelineStateDescription pd(rtState);
-
-	pSpriteBatch = std::make_unique<DirectX::SpriteBatch>(pApp->pDevice.Get(), resourceUpload, pd);
-
-	// Upload the resources to the GPU.
-	auto uploadResourcesFinished = resourceUpload.End(pApp->pCommandQueue.Get());
-
-	// Wait for the upload thread to terminate
-	uploadResourcesFinished.wait();
-
-	pSpriteBatch->SetViewport(pApp->ScreenViewport);
+	// Texts with the same font share one SpriteFont (and its texture) so that they can be drawn in one draw call.
+	pSpriteFont = pApp->getGUIFont(sPathToSpriteFont, cpuHandle, gpuHandle);
 
 	bInitFontCalled = true;
 
-	sWrappedText = wrapText();
+	updateLayout();
 
 	recalculateSizeToKeepScaling();
 }
@@ -10,6 +10,7 @@
 // STL
 #include <string>
 #include <mutex>
+#include <memory>
 
 // DirectX
 #include "SilentEngine/Private/d3dx12.h"
@@ -20,6 +21,7 @@
 
 // Custom
 #include "SilentEngine/Private/GUI/SGUIObject/SGUIObject.h"
+#include "SilentEngine/Private/GUI/SGUITextLayout/SGUITextLayout.h"
 
 //@@Class
 /*
@@ -94,13 +96,14 @@ protected:
 private:
 
 	friend class SApplication;
+	friend class SGUISpriteRenderer;
 
-	std::wstring wrapText();
+	// call under mtxSprite, wraps the text and lays out its glyphs again
+	void updateLayout();
 
 	void initFontResource();
 
-	std::unique_ptr<DirectX::SpriteBatch> pSpriteBatch = nullptr;
-	std::unique_ptr<DirectX::SpriteFont>  pSpriteFont = nullptr;
+	std::shared_ptr<DirectX::SpriteFont>  pSpriteFont = nullptr; // shared between texts with the same font
 
 	CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle;
 	CD3DX12_GPU_DESCRIPTOR_HANDLE gpuHandle;
@@ -111,7 +114,8 @@ private:
 
 	std::wstring sPathToSpriteFont;
 	std::wstring sRawText;
-	std::wstring sWrappedText;
+
+	SGUITextLayout textLayout; // rebuilt only when the text, font, wrapping or the screen width changes
 
 	float fMaxLineWidth;
 
@@ -41,6 +41,7 @@ namespace fs = std::filesystem;
 #include "SilentEngine/Public/EntityComponentSystem/SRuntimeMeshComponent/SRuntimeMeshComponent.h"
 #include "SilentEngine/Private/SShader/SShader.h"
 #include "SilentEngine/Private/SMiscHelpers/SMiscHelpers.h"
+#include "SilentEngine/Private/SMemoryMappedFile/SMemoryMappedFile.h"
 #include "SilentEngine/Public/GUI/SGUISimpleText/SGUISimpleText.h"
 #include "SilentEngine/Public/GUI/SGUIImage/SGUIImage.h"
 #include "SilentEngine/Public/GUI/SGUILayout/SGUILayout.h"
@@ -123,7 +124,8 @@ SMaterial* SApplication::registerMaterial(const std::string& sMaterialName, bool
 		pMat->sMaterialName = sMaterialName;
 		pMat->iMatCBIndex = iNewMaterialCBIndex;
 		pMat->bRegistered = true;
-		pMat->iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		pMat->pDirtyQueue = &materialDirtyQueue;
+		pMat->markDirty();
 
 		vRegisteredMaterials.push_back(pMat);
 
@@ -133,7 +135,9 @@ SMaterial* SApplication::registerMaterial(const std::string& sMaterialName, bool
 
 			for (size_t i = 0; i < vRegisteredMaterials.size(); i++)
 			{
-				vRegisteredMaterials[i]->iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+				vRegisteredMaterials[i]->mtxUpdateMat.lock();
+				vRegisteredMaterials[i]->markDirty();
+				vRegisteredMaterials[i]->mtxUpdateMat.unlock();
 			}
 
 			createCBVSRVUAVHeap();
@@ -207,9 +211,11 @@ bool SApplication::unregisterMaterial(const std::string& sMaterialName)
 	// Remove material.
 	// Find if any spawned object is using this material.
 
-	std::vector<SComponent*> vAllSpawnedMeshComponents = vAllRenderableSpawnedOpaqueComponents;
-	vAllSpawnedMeshComponents.insert(vAllSpawnedMeshComponents.end(), vAllRenderableSpawnedTransparentComponents.begin(),
-		vAllRenderableSpawnedTransparentComponents.end());
+	const std::vector<SMeshComponent*>& vSpawnedMeshComponents = pCurrentLevel->renderRegistry.getMeshComponents();
+	const std::vector<SRuntimeMeshComponent*>& vSpawnedRuntimeMeshComponents = pCurrentLevel->renderRegistry.getRuntimeMeshComponents();
+
+	std::vector<SComponent*> vAllSpawnedMeshComponents(vSpawnedMeshComponents.begin(), vSpawnedMeshComponents.end());
+	vAllSpawnedMeshComponents.insert(vAllSpawnedMeshComponents.end(), vSpawnedRuntimeMeshComponents.begin(), vSpawnedRuntimeMeshComponents.end());
 
 	for (size_t i = 0; i < vAllSpawnedMeshComponents.size(); i++)
 	{
@@ -220,11 +226,11 @@ bool SApplication::unregisterMaterial(const std::string& sMaterialName)
 			{
 				if (vAllSpawnedMeshComponents[i]->componentType == SComponentType::SCT_MESH)
 				{
-					dynamic_cast<SMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
+					static_cast<SMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
 				}
 				else if (vAllSpawnedMeshComponents[i]->componentType == SComponentType::SCT_RUNTIME_MESH)
 				{
-					dynamic_cast<SRuntimeMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
+					static_cast<SRuntimeMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
 				}
 			}
 		}
@@ -244,7 +250,12 @@ bool SApplication::unregisterMaterial(const std::string& sMaterialName)
 				vFrameResources[k]->removeMaterialCB(vRegisteredMaterials[i]->iMatCBIndex, &bResized);
 			}
 
+			vRegisteredMaterials[i]->mtxUpdateMat.lock();
 			vRegisteredMaterials[i]->bRegistered = false;
+			vRegisteredMaterials[i]->pDirtyQueue = nullptr;
+			vRegisteredMaterials[i]->mtxUpdateMat.unlock();
+
+			materialDirtyQueue.remove(vRegisteredMaterials[i]);
 
 			delete vRegisteredMaterials[i];
 
@@ -260,7 +271,9 @@ bool SApplication::unregisterMaterial(const std::string& sMaterialName)
 
 		for (size_t i = 0; i < vRegisteredMaterials.size(); i++)
 		{
-			vRegisteredMaterials[i]->iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+			vRegisteredMaterials[i]->mtxUpdateMat.lock();
+			vRegisteredMaterials[i]->markDirty();
+			vRegisteredMaterials[i]->mtxUpdateMat.unlock();
 		}
 
 		// Recreate cbv heap.
@@ -371,6 +384,13 @@ bool SApplication::unregisterGUIObject(SGUIObject* pGUIObject)
 					iInteractableImagesCount--;
 				}
 
+				if (vGUILayers[i].vGUIObjects[j]->iLayoutNodeId != SGUILayoutSolver::iInvalidNodeId)
+				{
+					std::lock_guard<std::mutex> layoutGuard(mtxGUILayout);
+
+					guiLayoutSolver.destroyNode(vGUILayers[i].vGUIObjects[j]->iLayoutNodeId);
+				}
+
 				delete vGUILayers[i].vGUIObjects[j];
 				vGUILayers[i].vGUIObjects.erase(vGUILayers[i].vGUIObjects.begin() + i);
 				bFound = true;
@@ -467,6 +487,15 @@ void SApplication::registerGUIObject(SGUIObject* pGUIObject, bool bWillBeUsedInL
 			pGUIObject->scale = DirectX::XMFLOAT2(1.0f, 1.0f);
 			pGUIObject->screenScale = DirectX::XMFLOAT2(1.0f, 1.0f);
 		}
+
+		if (pGUIObject->objectType == SGUIType::SGT_LAYOUT)
+		{
+			SGUILayout* pLayout = static_cast<SGUILayout*>(pGUIObject);
+
+			std::lock_guard<std::mutex> layoutGuard(mtxGUILayout);
+
+			pLayout->iLayoutNodeId = guiLayoutSolver.createLayoutNode(pLayout->getLayoutParams(), pLayout);
+		}
 	}
 
 	if (pGUIObject->iZLayer != 0)
@@ -527,32 +556,34 @@ STextureHandle SApplication::loadTextureFromDiskToGPU(std::string sTextureName,
 
 
 
-	// See if the file exists.
-
-	std::ifstream textureFile(sPathToTexture);
+	// See if the file format is .dds.
 
-	if (textureFile.is_open() == false)
+	if (fs::path(sPathToTexture).extension().string() != ".dds")
 	{
 		bErrorOccurred = true;
 
 		return STextureHandle();
 	}
-	else
-	{
-		textureFile.close();
-	}
 
 
 
-	// See if the file format is .dds.
+	// Map the file (this is also the check that the file exists), the texture is created straight from the mapping.
 
-	if (fs::path(sPathToTexture).extension().string() != ".dds")
+	SMemoryMappedFile textureFile;
+
+	if (textureFile.open(sPathToTexture))
 	{
 		bErrorOccurred = true;
 
 		return STextureHandle();
 	}
 
+	SDDSTextureDesc ddsDesc;
+	size_t iDDSHeaderSize = 0;
+	std::vector<SDDSMipRegion> vDDSRegions;
+
+	bool bLayoutParsed = SDDSTexture::parseLayout(textureFile.getData(), textureFile.getSize(), ddsDesc, iDDSHeaderSize, vDDSRegions) == false;
+
 
 
 	// Load texture.
@@ -568,8 +599,8 @@ STextureHandle SApplication::loadTextureFromDiskToGPU(std::string sTextureName,
 	DirectX::ResourceUploadBatch resourceUpload(pDevice.Get());
 	resourceUpload.Begin();
 	HRESULT hresult = 
-		DirectX::CreateDDSTextureFromFile(pDevice.Get(), resourceUpload, sPathToTexture.c_str(), pTexture->pResource.ReleaseAndGetAddressOf(),
-			false, 0Ui64, nullptr, &bIsCubeMap);
+		DirectX::CreateDDSTextureFromMemory(pDevice.Get(), resourceUpload, reinterpret_cast<const uint8_t*>(textureFile.getData()),
+			textureFile.getSize(), pTexture->pResource.ReleaseAndGetAddressOf(), false, 0Ui64, nullptr, &bIsCubeMap);
 	//HRESULT hresult = DirectX::CreateDDSTextureFromFile12(pDevice.Get(), pCommandList.Get(), sPathToTexture.c_str(),
 	//	pTexture->pResource, pTexture->pUploadHeap);
 
@@ -586,6 +617,9 @@ STextureHandle SApplication::loadTextureFromDiskToGPU(std::string sTextureName,
 
 	auto uploadResourcesFinished = resourceUpload.End(pCommandQueue.Get());
 
+	// The data was copied to the upload heap.
+	textureFile.close();
+
 	uploadResourcesFinished.wait();
 
 	/*if (executeCommandList())
@@ -632,6 +666,19 @@ STextureHandle SApplication::loadTextureFromDiskToGPU(std::string sTextureName,
 	pTexture->iResourceSizeInBytesOnGPU = info.SizeInBytes + info.Alignment;
 
 
+
+	// All mips are loaded, but the most detailed mips can be evicted later.
+
+	if (bLayoutParsed && ddsDesc.iMipCount == texDesc.MipLevels)
+	{
+		pTexture->ddsDesc = ddsDesc;
+		pTexture->iMinResidentMip = STextureLoader::getMinResidentMip(pTexture->ddsDesc);
+		pTexture->iResidentMip = 0;
+
+		registerTextureResidency(pTexture);
+	}
+
+
 	
 	// Add texture to loaded textures array.
 
@@ -662,6 +709,80 @@ STextureHandle SApplication::loadTextureFromDiskToGPU(std::string sTextureName,
 	return texHandle;
 }
 
+STextureHandle SApplication::loadTextureFromDiskToGPUAsync(std::string sTextureName, std::wstring sPathToTexture, bool bIsCubeMap, bool& bErrorOccurred)
+{
+	bErrorOccurred = false;
+
+
+	// See if the texture name is empty.
+
+	if (sTextureName == "")
+	{
+		bErrorOccurred = true;
+
+		return STextureHandle();
+	}
+
+
+
+	// See if the file exists and the file format is .dds (the file is read later on the I/O thread).
+
+	if (fs::exists(sPathToTexture) == false || fs::path(sPathToTexture).extension().string() != ".dds")
+	{
+		bErrorOccurred = true;
+
+		return STextureHandle();
+	}
+
+
+
+	// See if the texture name is not unique.
+
+	std::lock_guard<std::mutex> guard(mtxDraw);
+
+	for (size_t i = 0; i < vLoadedTextures.size(); i++)
+	{
+		if (vLoadedTextures[i]->sTextureName == sTextureName)
+		{
+			bErrorOccurred = true;
+
+			return STextureHandle();
+		}
+	}
+
+
+
+	// Queue the texture.
+
+	STextureInternal* pTexture = new STextureInternal();
+	pTexture->sTextureName = sTextureName;
+	pTexture->sPathToTexture = sPathToTexture;
+	pTexture->bIsCubeMap = bIsCubeMap;
+	pTexture->loadState = STextureLoadState::STLS_LOADING;
+	pTexture->iLoadMip = SIZE_MAX; // start with the least detailed mips
+
+	vLoadedTextures.push_back(pTexture);
+
+	textureLoader.loadTexture(pTexture);
+
+	// The heap is recreated in update() so that many textures loaded at once cause only one recreation.
+	bTextureViewsOutdated = true;
+
+
+
+	// Return texture handle.
+
+	STextureHandle texHandle;
+	texHandle.sTextureName = sTextureName;
+	texHandle.sPathToTexture = sPathToTexture;
+	texHandle.bRegistered = true;
+
+	texHandle.pRefToTexture = pTexture;
+
+
+	return texHandle;
+}
+
 STextureHandle SApplication::getLoadedTexture(const std::string& sTextureName, bool& bNotFound)
 {
 	bNotFound = true;
@@ -718,9 +839,11 @@ bool SApplication::unloadTextureFromGPU(STextureHandle& textureHandle)
 
 	// Find if any spawned object is using a material with this texture.
 
-	std::vector<SComponent*> vAllSpawnedMeshComponents = vAllRenderableSpawnedOpaqueComponents;
-	vAllSpawnedMeshComponents.insert(vAllSpawnedMeshComponents.end(), vAllRenderableSpawnedTransparentComponents.begin(),
-		vAllRenderableSpawnedTransparentComponents.end());
+	const std::vector<SMeshComponent*>& vSpawnedMeshComponents = pCurrentLevel->renderRegistry.getMeshComponents();
+	const std::vector<SRuntimeMeshComponent*>& vSpawnedRuntimeMeshComponents = pCurrentLevel->renderRegistry.getRuntimeMeshComponents();
+
+	std::vector<SComponent*> vAllSpawnedMeshComponents(vSpawnedMeshComponents.begin(), vSpawnedMeshComponents.end());
+	vAllSpawnedMeshComponents.insert(vAllSpawnedMeshComponents.end(), vSpawnedRuntimeMeshComponents.begin(), vSpawnedRuntimeMeshComponents.end());
 
 	for (size_t i = 0; i < vAllSpawnedMeshComponents.size(); i++)
 	{
@@ -735,11 +858,11 @@ bool SApplication::unloadTextureFromGPU(STextureHandle& textureHandle)
 				{
 					if (vAllSpawnedMeshComponents[i]->componentType == SComponentType::SCT_MESH)
 					{
-						dynamic_cast<SMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
+						static_cast<SMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
 					}
 					else if (vAllSpawnedMeshComponents[i]->componentType == SComponentType::SCT_RUNTIME_MESH)
 					{
-						dynamic_cast<SRuntimeMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
+						static_cast<SRuntimeMeshComponent*>(vAllSpawnedMeshComponents[i])->unbindMaterial();
 					}
 				}
 			}
@@ -754,6 +877,26 @@ bool SApplication::unloadTextureFromGPU(STextureHandle& textureHandle)
 	{
 		if (vLoadedTextures[i]->sTextureName == textureHandle.getTextureName())
 		{
+			textureLoader.cancelTexture(vLoadedTextures[i]);
+
+			for (size_t j = 0; j < vPostponedTextureSwaps.size(); )
+			{
+				if (vPostponedTextureSwaps[j].pTexture == vLoadedTextures[i])
+				{
+					vPostponedTextureSwaps.erase(vPostponedTextureSwaps.begin() + j);
+				}
+				else
+				{
+					j++;
+				}
+			}
+
+			if (vLoadedTextures[i]->iResidencyId != SIZE_MAX)
+			{
+				textureResidency.unregisterTexture(vLoadedTextures[i]->iResidencyId);
+				textureLoader.setResidencyTexture(vLoadedTextures[i]->iResidencyId, nullptr);
+			}
+
 			unsigned long iLeftRef = vLoadedTextures[i]->pResource.Reset();
 
 			if (iLeftRef != 0)
@@ -782,8 +925,87 @@ bool SApplication::unloadTextureFromGPU(STextureHandle& textureHandle)
 	return false;
 }
 
+void SApplication::setTextureMemoryBudget(unsigned long long iBudgetInBytes)
+{
+	std::lock_guard<std::mutex> guard(mtxDraw);
+
+	textureResidency.setBudget(iBudgetInBytes);
+}
+
+STextureResidencyStats SApplication::getTextureResidencyStats()
+{
+	std::lock_guard<std::mutex> guard(mtxDraw);
+
+	return textureResidency.getStats();
+}
+
+SShaderCacheStats SApplication::getShaderCacheStats()
+{
+	return shaderCache.getStats();
+}
+
+bool SApplication::clearShaderCache()
+{
+	return shaderCache.clear();
+}
+
 SShader* SApplication::compileCustomShader(const std::wstring& sPathToShaderFile, 
 	const SCustomShaderProperties& customProps, SCustomShaderResources** pOutCustomResources)
+{
+	SCustomShaderCompilation compilation;
+
+	if (startCustomShaderCompilation(sPathToShaderFile, compilation))
+	{
+		return nullptr;
+	}
+
+	return finishCustomShaderCompilation(sPathToShaderFile, compilation, customProps, pOutCustomResources);
+}
+
+std::vector<SShader*> SApplication::compileCustomShaders(const std::vector<std::wstring>& vPathsToShaderFiles,
+	const std::vector<SCustomShaderProperties>& vCustomProps, std::vector<SCustomShaderResources*>* pOutCustomResources)
+{
+	std::vector<SShader*> vShaders(vPathsToShaderFiles.size(), nullptr);
+
+	if (pOutCustomResources)
+	{
+		pOutCustomResources->assign(vPathsToShaderFiles.size(), nullptr);
+	}
+
+	if (vCustomProps.size() != vPathsToShaderFiles.size())
+	{
+		SError::showErrorMessageBoxAndLog("the number of shader properties should be equal to the number of shader files.");
+		return vShaders;
+	}
+
+
+	// Queue all shaders first so that they are compiled concurrently.
+
+	std::vector<SCustomShaderCompilation> vCompilations(vPathsToShaderFiles.size());
+
+	for (size_t i = 0; i < vPathsToShaderFiles.size(); i++)
+	{
+		vCompilations[i].bStarted = startCustomShaderCompilation(vPathsToShaderFiles[i], vCompilations[i]) == false;
+	}
+
+
+	// Create PSOs in the same order (waiting only for the shader that is needed right now).
+
+	for (size_t i = 0; i < vPathsToShaderFiles.size(); i++)
+	{
+		if (vCompilations[i].bStarted == false)
+		{
+			continue;
+		}
+
+		vShaders[i] = finishCustomShaderCompilation(vPathsToShaderFiles[i], vCompilations[i], vCustomProps[i],
+			pOutCustomResources ? &pOutCustomResources->operator[](i) : nullptr);
+	}
+
+	return vShaders;
+}
+
+bool SApplication::startCustomShaderCompilation(const std::wstring& sPathToShaderFile, SCustomShaderCompilation& outCompilation)
 {
 	// See if the file exists.
 
@@ -792,7 +1014,7 @@ SShader* SApplication::compileCustomShader(const std::wstring& sPathToShaderFile
 	if (shaderFile.is_open() == false)
 	{
 		SError::showErrorMessageBoxAndLog("could not open the shader file.");
-		return nullptr;
+		return true;
 	}
 	else
 	{
@@ -805,6 +1027,42 @@ SShader* SApplication::compileCustomShader(const std::wstring& sPathToShaderFile
 
 	if (fs::path(sPathToShaderFile).extension().string() != ".hlsl")
 	{
+		return true;
+	}
+
+
+	// Also change in SApplication::createShadersAndInputLayout().
+
+	SShaderCompileRequest request;
+	request.sPathToShader     = sPathToShaderFile;
+	request.bCompileInRelease = bCompileShadersInRelease;
+
+	request.sEntryPoint  = L"VS";
+	request.sShaderModel = SE_VS_SM;
+	outCompilation.vs = shaderCompiler.compileShader(request);
+
+	request.sEntryPoint  = L"PS";
+	request.sShaderModel = SE_PS_SM;
+	outCompilation.ps = shaderCompiler.compileShader(request);
+
+	request.vDefines.push_back({ "ALPHA_TEST", "1" });
+	outCompilation.alphaPS = shaderCompiler.compileShader(request);
+
+	return false;
+}
+
+SShader* SApplication::finishCustomShaderCompilation(const std::wstring& sPathToShaderFile, SCustomShaderCompilation& compilation,
+	const SCustomShaderProperties& customProps, SCustomShaderResources** pOutCustomResources)
+{
+	// Wait for the shaders (without holding mtxDraw so that the frames are still drawn).
+
+	ATL::CComPtr<IDxcBlob> pVS      = compilation.vs.get();
+	ATL::CComPtr<IDxcBlob> pPS      = compilation.ps.get();
+	ATL::CComPtr<IDxcBlob> pAlphaPS = compilation.alphaPS.get();
+
+	if (pVS == nullptr || pPS == nullptr || pAlphaPS == nullptr)
+	{
+		// The error was already shown.
 		return nullptr;
 	}
 
@@ -837,13 +1095,6 @@ SShader* SApplication::compileCustomShader(const std::wstring& sPathToShaderFile
 	}
 
 
-	const D3D_SHADER_MACRO alphaTestDefines[] =
-	{
-		"ALPHA_TEST", "1",
-		NULL, NULL
-	};
-
-
 	SShader* pNewShader = new SShader(sPathToShaderFile);
 
 	std::lock_guard<std::mutex> guard(mtxDraw);
@@ -883,9 +1134,9 @@ SShader* SApplication::compileCustomShader(const std::wstring& sPathToShaderFile
 		pNewShader->pCustomShaderResources->pCustomRootSignature = pRootSignature;
 	}
 
-	pNewShader->pVS = SMiscHelpers::compileShader(sPathToShaderFile, nullptr, L"VS", SE_VS_SM, bCompileShadersInRelease);
-	pNewShader->pPS = SMiscHelpers::compileShader(sPathToShaderFile, nullptr, L"PS", SE_PS_SM, bCompileShadersInRelease);
-	pNewShader->pAlphaPS = SMiscHelpers::compileShader(sPathToShaderFile, alphaTestDefines, L"PS", SE_PS_SM, bCompileShadersInRelease);
+	pNewShader->pVS = pVS;
+	pNewShader->pPS = pPS;
+	pNewShader->pAlphaPS = pAlphaPS;
 
 
 	if (createPSO(pNewShader))
@@ -1180,8 +1431,11 @@ bool SApplication::spawnContainerInLevel(SContainer* pContainer)
 		vAllRenderableSpawnedContainers.push_back(pContainer);
 
 
-		pContainer->getAllMeshComponents(&vAllRenderableSpawnedOpaqueComponents,
-			&vAllRenderableSpawnedTransparentComponents);
+		{
+			std::lock_guard<std::mutex> collisionGuard(pCurrentLevel->mtxCollision);
+
+			pCurrentLevel->renderRegistry.addContainer(pContainer);
+		}
 
 		pContainer->addMeshesByShader(&vOpaqueMeshesByCustomShader, &vTransparentMeshesByCustomShader);
 
@@ -1209,6 +1463,8 @@ bool SApplication::spawnContainerInLevel(SContainer* pContainer)
 		}
 	}
 
+	pCurrentLevel->transformSystem.addContainer(pContainer);
+
 	pContainer->setSpawnedInLevel(true);
 
 	return false;
@@ -1397,7 +1653,11 @@ void SApplication::despawnContainerFromLevel(SContainer* pContainer)
 		pContainer->setStartIndexInCB(0);
 
 
-		removeComponentsFromGlobalVectors(pContainer);
+		{
+			std::lock_guard<std::mutex> collisionGuard(pCurrentLevel->mtxCollision);
+
+			pCurrentLevel->renderRegistry.removeContainer(pContainer);
+		}
 
 		pContainer->removeMeshesByShader(&vOpaqueMeshesByCustomShader, &vTransparentMeshesByCustomShader);
 
@@ -1424,6 +1684,8 @@ void SApplication::despawnContainerFromLevel(SContainer* pContainer)
 		}
 	}
 
+	pCurrentLevel->transformSystem.removeContainer(pContainer);
+
 	pContainer->setSpawnedInLevel(false);
 
 	if (bExitCalled)
@@ -1815,6 +2077,11 @@ SAudioEngine* SApplication::getAudioEngine()
 	return pAudioEngine;
 }
 
+void SApplication::enqueueRenderCommand(std::function<void()> command)
+{
+	renderCommandQueue.push(std::move(command));
+}
+
 SApplication* SApplication::getApp()
 {
 	return pApp;
@@ -2513,6 +2780,11 @@ bool SApplication::onResize()
 		ScissorRect = { 0, 0, iMainWindowWidth, iMainWindowHeight };
 
 
+		if (pGUISpriteRenderer)
+		{
+			pGUISpriteRenderer->setViewport(ScreenViewport);
+		}
+
 		for (size_t i = 0; i < vGUILayers.size(); i++)
 		{
 			for (size_t j = 0; j < vGUILayers[i].vGUIObjects.size(); j++)
@@ -2654,6 +2926,10 @@ void SApplication::update()
 	std::chrono::time_point<std::chrono::steady_clock> timeOnUpdate = std::chrono::steady_clock::now();
 #endif
 
+	pCurrentLevel->transformSystem.updateWorldMatrices();
+	pCurrentLevel->transformSystem.callQueuedParentChangedCallbacks();
+
+	updateTextureStreaming();
 	updateMaterials();
 	updateObjectCBs();
 	updateShadowMapsCB(); // do before main pass
@@ -2666,151 +2942,273 @@ void SApplication::update()
 #endif
 }
 
-void SApplication::updateMaterials()
+void SApplication::updateTextureStreaming()
 {
 	std::lock_guard<std::mutex> guard(mtxDraw);
 
-	for (size_t i = 0; i < vRegisteredMaterials.size(); i++)
-	{
-		SMaterial* pMaterial = vRegisteredMaterials[i];
+	// update() waited for the fence of this frame resource so the resources that were replaced
+	// when this frame resource was used last time are no longer used by the GPU.
+	pCurrentFrameResource->vDeferredReleaseResources.clear();
 
-		pMaterial->mtxUpdateMat.lock();
+	std::vector<SLoadedTexture> vLoadedMips;
+	vLoadedMips.swap(vPostponedTextureSwaps);
+	textureLoader.collectUploadedTextures(vLoadedMips);
 
-		if (pMaterial->iUpdateCBInFrameResourceCount > 0)
-		{
-			updateMaterialInFrameResource(pMaterial);
-		}
+	const UINT64 iCompletedFence = pFence->GetCompletedValue();
 
-		pMaterial->mtxUpdateMat.unlock();
-	}
+	for (size_t i = 0; i < vLoadedMips.size(); i++)
+	{
+		STextureInternal* pTexture = vLoadedMips[i].pTexture;
+
+		if (vLoadedMips[i].bFailed)
+		{
+			if (pTexture->pResource == nullptr)
+			{
+				pTexture->loadState = STextureLoadState::STLS_FAILED;
+			}
+			else
+			{
+				textureResidency.onRequestFailed(pTexture->iResidencyId);
+			}
 
+			continue;
+		}
 
-	// Update material bundles.
-	if (vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles.size() > 0)
-	{
-		for (size_t i = 0; i < vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles.size(); i++)
+		if (pTexture->pResource)
 		{
-			for (size_t j = 0; j <
-			vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->pShaderUsingThisResource->pCustomShaderResources->vMaterials.size(); j++)
+			// The active SRV and the old resource may be used by the frames that the GPU is still processing,
+			// write the SRV of the new resource to the inactive SRV of the texture and switch to it.
+
+			if (bTextureViewsOutdated == false && iCompletedFence < pTexture->iInactiveSRVFence)
 			{
-				SMaterial* pMaterial =
-					vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->pShaderUsingThisResource->pCustomShaderResources->vMaterials[j];
+				// The inactive SRV was active in one of these frames, try again on the next frame.
+				vPostponedTextureSwaps.push_back(vLoadedMips[i]);
 
-				pMaterial->mtxUpdateMat.lock();
+				continue;
+			}
 
-				if (pMaterial->iUpdateCBInFrameResourceCount > 0)
-				{
-					updateMaterialInFrameResource(pMaterial,
-					vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->
-						pShaderUsingThisResource->pCustomShaderResources->vFrameResourceBundles[iCurrentFrameResourceIndex],
-						j);
-				}
+			pCurrentFrameResource->vDeferredReleaseResources.push_back(pTexture->pResource);
 
-				pMaterial->mtxUpdateMat.unlock();
+			pTexture->pResource = vLoadedMips[i].pResource;
+			pTexture->iResourceSizeInBytesOnGPU = vLoadedMips[i].iSizeInBytesOnGPU;
+			pTexture->iResidentMip = vLoadedMips[i].iMostDetailedMip;
+
+			textureResidency.onMipsResident(pTexture->iResidencyId, pTexture->iResidentMip);
+
+			if (bTextureViewsOutdated == false)
+			{
+				pTexture->iActiveSRV = 1 - pTexture->iActiveSRV;
+
+				// The last frame that can use the now inactive SRV was submitted before this update.
+				pTexture->iInactiveSRVFence = iCurrentFence;
+
+				createTextureView(pTexture, iPerFrameResEndOffset + pTexture->iTexSRVHeapIndex + pTexture->iActiveSRV);
 			}
+
+			continue;
 		}
-	}
-}
 
-void SApplication::updateObjectCBs()
-{
-	std::lock_guard<std::mutex> guard(mtxDraw);
 
-	SUploadBuffer<SObjectConstants>* pCurrentObjectCB = pCurrentFrameResource->pObjectsCB.get();
+		// First load.
 
-	std::vector<SContainer*>* pvRenderableContainers = pCurrentLevel->getRenderableContainers();
+		pTexture->pResource = vLoadedMips[i].pResource;
+		pTexture->iResourceSizeInBytesOnGPU = vLoadedMips[i].iSizeInBytesOnGPU;
+		pTexture->iResidentMip = vLoadedMips[i].iMostDetailedMip;
 
-	for (size_t i = 0; i < pvRenderableContainers->size(); i++)
-	{
-		for (size_t j = 0; j < pvRenderableContainers->operator[](i)->vComponents.size(); j++)
+		registerTextureResidency(pTexture);
+
+		pTexture->loadState = STextureLoadState::STLS_RESIDENT;
+
+		if (bTextureViewsOutdated == false)
 		{
-			updateComponentAndChilds(pvRenderableContainers->operator[](i)->vComponents[j], pCurrentObjectCB);
+			// The SRV of this texture is not used by the GPU (the placeholder was bound instead).
+			createTextureView(pTexture, iPerFrameResEndOffset + pTexture->iTexSRVHeapIndex + pTexture->iActiveSRV);
 		}
 	}
-}
 
-void SApplication::updateComponentAndChilds(SComponent* pComponent, SUploadBuffer<SObjectConstants>* pCurrentObjectCB)
-{
-	if (pComponent->componentType == SComponentType::SCT_MESH)
+	if (bTextureViewsOutdated)
 	{
-		SMeshComponent* pMeshComponent = dynamic_cast<SMeshComponent*>(pComponent);
+		bTextureViewsOutdated = false;
 
-		if (pMeshComponent->renderData.iUpdateCBInFrameResourceCount > 0)
-		{
-			pMeshComponent->mtxComponentProps.lock();
+		// The old heap may be used by the GPU.
+		flushCommandQueue();
 
-			DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&pMeshComponent->renderData.vWorld);
-			DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&pMeshComponent->renderData.vTexTransform);
+		// Recreate cbv heap.
+		createCBVSRVUAVHeap();
+		createViews();
+	}
 
-			SObjectConstants objConstants;
-			DirectX::XMStoreFloat4x4(&objConstants.vWorld, DirectX::XMMatrixTranspose(world));
-			DirectX::XMStoreFloat4x4(&objConstants.vTexTransform, DirectX::XMMatrixTranspose(texTransform));
-			objConstants.iCustomProperty = pMeshComponent->renderData.iCustomShaderProperty;
 
-			pCurrentObjectCB->copyDataToElement(pMeshComponent->renderData.iObjCBIndex, objConstants);
+	// Request mips for the textures used in the last frame.
+	textureResidency.update();
+}
 
-			// Next FrameResource need to be updated too.
-			pMeshComponent->renderData.iUpdateCBInFrameResourceCount--;
+void SApplication::registerTextureResidency(STextureInternal* pTexture)
+{
+	std::vector<uint64_t> vMipSizes(pTexture->ddsDesc.iMipCount);
 
-			pMeshComponent->mtxComponentProps.unlock();
-		}
+	for (size_t i = 0; i < vMipSizes.size(); i++)
+	{
+		vMipSizes[i] = SDDSTexture::getMipSizeInBytes(pTexture->ddsDesc, i);
 	}
-	else if (pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+
+	pTexture->iResidencyId = textureResidency.registerTexture(vMipSizes, pTexture->iMinResidentMip, pTexture->iResidentMip);
+
+	if (pTexture->iResidencyId == STextureResidencyManager::iInvalidTextureId)
 	{
-		SRuntimeMeshComponent* pRuntimeMeshComponent = dynamic_cast<SRuntimeMeshComponent*>(pComponent);
+		pTexture->iResidencyId = SIZE_MAX;
+	}
+	else
+	{
+		textureLoader.setResidencyTexture(pTexture->iResidencyId, pTexture);
+	}
+}
+
+void SApplication::updateMaterials()
+{
+	std::lock_guard<std::mutex> guard(mtxDraw);
+
+	// Only the materials that were changed in the last SFRAME_RES_COUNT frames are stored in the dirty queue.
+
+	const std::vector<SMaterial*>& vDirtyMaterials = materialDirtyQueue.collectDirtyItems();
 
+	pProfiler->iLastFrameDirtyMaterialCount = vDirtyMaterials.size();
 
-		if (pRuntimeMeshComponent->bNoMeshDataOnSpawn == false && pRuntimeMeshComponent->bNewMeshData)
+	for (size_t i = 0; i < vDirtyMaterials.size(); )
+	{
+		SMaterial* pMaterial = vDirtyMaterials[i];
+
+		pMaterial->mtxUpdateMat.lock();
+
+		if (pMaterial->iUpdateCBInFrameResourceCount > 0)
 		{
-			pRuntimeMeshComponent->mtxDrawComponent.lock();
+			updateMaterialInFrameResource(pMaterial);
+		}
 
-			auto pVertexBuffer = pCurrentFrameResource->vRuntimeMeshVertexBuffers[pRuntimeMeshComponent->iIndexInFrameResourceVertexBuffer].get();
+		if (pMaterial->iUpdateCBInFrameResourceCount <= 0)
+		{
+			// All frame resources have the new data.
+			materialDirtyQueue.removeDirtyItem(i);
+		}
+		else
+		{
+			i++;
+		}
 
-			std::vector<SVertex> vMeshShaderData = pRuntimeMeshComponent->meshData.toShaderVertex();
+		pMaterial->mtxUpdateMat.unlock();
+	}
 
-			pVertexBuffer->copyData(vMeshShaderData.data(), vMeshShaderData.size() * sizeof(SVertex));
 
-			/*for (UINT64 i = 0; i < vMeshShaderData.size(); i++)
+	// Update material bundles.
+	if (vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles.size() > 0)
+	{
+		for (size_t i = 0; i < vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles.size(); i++)
+		{
+			for (size_t j = 0; j <
+			vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->pShaderUsingThisResource->pCustomShaderResources->vMaterials.size(); j++)
 			{
-				pVertexBuffer->copyDataToElement(i, vMeshShaderData[i]);
-			}*/
+				SMaterial* pMaterial =
+					vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->pShaderUsingThisResource->pCustomShaderResources->vMaterials[j];
 
-			pRuntimeMeshComponent->renderData.pGeometry->pVertexBufferGPU = pVertexBuffer->getResource();
+				pMaterial->mtxUpdateMat.lock();
 
-			pRuntimeMeshComponent->bNewMeshData = false;
+				if (pMaterial->iUpdateCBInFrameResourceCount > 0)
+				{
+					updateMaterialInFrameResource(pMaterial,
+					vFrameResources[iCurrentFrameResourceIndex]->vMaterialBundles[i]->
+						pShaderUsingThisResource->pCustomShaderResources->vFrameResourceBundles[iCurrentFrameResourceIndex],
+						j);
+				}
 
-			pRuntimeMeshComponent->mtxDrawComponent.unlock();
+				pMaterial->mtxUpdateMat.unlock();
+			}
 		}
+	}
+}
 
+void SApplication::updateObjectCBs()
+{
+	std::lock_guard<std::mutex> guard(mtxDraw);
 
+	SUploadBuffer<SObjectConstants>* pCurrentObjectCB = pCurrentFrameResource->pObjectsCB.get();
 
-		if (pRuntimeMeshComponent->renderData.iUpdateCBInFrameResourceCount > 0)
-		{
-			pRuntimeMeshComponent->mtxComponentProps.lock();
+	// Only the components that were changed in the last SFRAME_RES_COUNT frames are stored in the dirty queue.
+	// Collision queries also consume this queue (see SLevel::updateCollisionBounds()) so mtxCollision is held while it's used.
+
+	std::lock_guard<std::mutex> collisionGuard(pCurrentLevel->mtxCollision);
+
+	pCurrentLevel->renderRegistry.updateDirtyBounds(); // cull bounds and BVH
+
+	SDirtyQueue<SComponent>& dirtyQueue = pCurrentLevel->renderRegistry.getObjectCBDirtyQueue();
+
+	const std::vector<SComponent*>& vDirtyComponents = dirtyQueue.collectDirtyItems();
 
-			DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&pRuntimeMeshComponent->renderData.vWorld);
-			DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&pRuntimeMeshComponent->renderData.vTexTransform);
+	pProfiler->iLastFrameDirtyObjectCBCount = vDirtyComponents.size();
 
-			SObjectConstants objConstants;
-			DirectX::XMStoreFloat4x4(&objConstants.vWorld, DirectX::XMMatrixTranspose(world));
-			DirectX::XMStoreFloat4x4(&objConstants.vTexTransform, DirectX::XMMatrixTranspose(texTransform));
-			objConstants.iCustomProperty = pRuntimeMeshComponent->renderData.iCustomShaderProperty;
+	for (size_t i = 0; i < vDirtyComponents.size(); )
+	{
+		SComponent* pComponent = vDirtyComponents[i];
+
+		pComponent->mtxComponentProps.lock();
 
-			pCurrentObjectCB->copyDataToElement(pRuntimeMeshComponent->renderData.iObjCBIndex, objConstants);
+		if (pComponent->componentType == SComponentType::SCT_RUNTIME_MESH)
+		{
+			// Runtime mesh components that got new vertex data are also pushed to the dirty queue.
+			updateRuntimeMeshVertexBuffer(static_cast<SRuntimeMeshComponent*>(pComponent));
+		}
 
-			// Next FrameResource need to be updated too.
-			pRuntimeMeshComponent->renderData.iUpdateCBInFrameResourceCount--;
+		updateComponentObjectCB(pComponent, pCurrentObjectCB);
 
-			pRuntimeMeshComponent->mtxComponentProps.unlock();
+		if (pComponent->renderData.iUpdateCBInFrameResourceCount <= 0)
+		{
+			// All frame resources have the new data.
+			dirtyQueue.removeDirtyItem(i);
 		}
+		else
+		{
+			i++;
+		}
+
+		pComponent->mtxComponentProps.unlock();
+	}
+}
+
+void SApplication::updateRuntimeMeshVertexBuffer(SRuntimeMeshComponent* pRuntimeMeshComponent)
+{
+	std::lock_guard<std::mutex> guard(pRuntimeMeshComponent->mtxDrawComponent);
+
+	if (pRuntimeMeshComponent->bNoMeshDataOnSpawn || pRuntimeMeshComponent->bNewMeshData == false)
+	{
+		return;
 	}
 
+	auto pVertexBuffer = pCurrentFrameResource->vRuntimeMeshVertexBuffers[pRuntimeMeshComponent->iIndexInFrameResourceVertexBuffer].get();
+
+	std::vector<SVertex> vMeshShaderData = pRuntimeMeshComponent->meshData.toShaderVertex();
 
-	std::vector<SComponent*> vChilds = pComponent->getChildComponents();
+	pVertexBuffer->copyData(vMeshShaderData.data(), vMeshShaderData.size() * sizeof(SVertex));
 
-	for (size_t i = 0; i < vChilds.size(); i++)
+	pRuntimeMeshComponent->renderData.pGeometry->pVertexBufferGPU = pVertexBuffer->getResource();
+
+	pRuntimeMeshComponent->bNewMeshData = false;
+}
+
+void SApplication::updateComponentObjectCB(SComponent* pComponent, SUploadBuffer<SObjectConstants>* pCurrentObjectCB)
+{
+	if (pComponent->renderData.iUpdateCBInFrameResourceCount > 0)
 	{
-		updateComponentAndChilds(pComponent->getChildComponents()[i], pCurrentObjectCB);
+		DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&pComponent->renderData.vWorld);
+		DirectX::XMMATRIX texTransform = DirectX::XMLoadFloat4x4(&pComponent->renderData.vTexTransform);
+
+		SObjectConstants objConstants;
+		DirectX::XMStoreFloat4x4(&objConstants.vWorld, DirectX::XMMatrixTranspose(world));
+		DirectX::XMStoreFloat4x4(&objConstants.vTexTransform, DirectX::XMMatrixTranspose(texTransform));
+		objConstants.iCustomProperty = pComponent->renderData.iCustomShaderProperty;
+
+		pCurrentObjectCB->copyDataToElement(pComponent->renderData.iObjCBIndex, objConstants);
+
+		// Next FrameResource need to be updated too.
+		pComponent->renderData.iUpdateCBInFrameResourceCount--;
 	}
 }
 
@@ -2939,45 +3337,182 @@ void SApplication::updateShadowMapsCB()
 	}
 }
 
-void SApplication::drawToShadowMaps()
+void SApplication::drawToShadowMap(SDrawJobContext& context, SCullPassResult& cullPass, SLightComponent* pLight, size_t iShadowMapIndex)
 {
-	SLevel* pLevel = getCurrentLevel();
-	if (pLevel == nullptr)
+	ID3D12DescriptorHeap* descriptorHeaps[] = { pCBVSRVUAVHeap.Get() };
+	context.pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+	context.pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
+
+	context.pCommandList->SetPipelineState(pShadowMapPSO.Get());
+
+	SPointLightComponent* pPointLight = nullptr;
+
+	if (pLight->lightType == SLightComponentType::SLCT_POINT)
 	{
-		return;
+		pPointLight = dynamic_cast<SPointLightComponent*>(pLight);
+
+		pPointLight->renderToShadowMaps(context.pCommandList, pCurrentFrameResource, &shadowMapsRenderPassCB, iShadowMapIndex);
+
+		context.pShadowMapConstants = pPointLight->getShadowMapConstants(iShadowMapIndex);
+	}
+	else
+	{
+		pLight->renderToShadowMaps(context.pCommandList, pCurrentFrameResource, &shadowMapsRenderPassCB);
+
+		context.pShadowMapConstants = pLight->getShadowMapConstants();
+	}
+
+	// Each shadow map face has its own visibility so that faces can be recorded at the same time.
+	cullComponents(cullPass, context.pShadowMapConstants, false);
+	context.pCullPass = &cullPass;
+
+	drawOpaqueComponents(context, 0, vOpaqueMeshesByCustomShader.size()); // drawing to shadow map
+
+	if (pPointLight)
+	{
+		pPointLight->finishRenderToShadowMaps(context.pCommandList, iShadowMapIndex);
+	}
+	else
+	{
+		pLight->finishRenderToShadowMaps(context.pCommandList);
 	}
+}
+
+void SApplication::addDrawJobs()
+{
+	renderJobGraph.clear();
+
+	// The command list of a job is vDrawJobContexts[iCommandListIndex].pCommandList (see draw()).
 
-	pCommandList->SetPipelineState(pShadowMapPSO.Get());
 
-	SRenderPassConstants renderPassCBCopy = mainRenderPassCB;
+	// Shadow maps (each face is a separate job).
 
-	for (size_t i = 0; i < pLevel->vSpawnedLightComponents.size(); i++)
+	SLevel* pLevel = getCurrentLevel();
+	size_t iShadowMapPassCount = 0;
+
+	if (pLevel)
 	{
-		if (pLevel->vSpawnedLightComponents[i]->isVisible())
+		for (size_t i = 0; i < pLevel->vSpawnedLightComponents.size(); i++)
 		{
-			if (pLevel->vSpawnedLightComponents[i]->lightType == SLightComponentType::SLCT_POINT)
+			SLightComponent* pLight = pLevel->vSpawnedLightComponents[i];
+
+			if (pLight->isVisible() == false)
 			{
-				SPointLightComponent* pPointLight = dynamic_cast<SPointLightComponent*>(pLevel->vSpawnedLightComponents[i]);
+				continue;
+			}
+
+			const size_t iShadowMapCount = (pLight->lightType == SLightComponentType::SLCT_POINT) ? 6 : 1;
 
-				for (size_t i = 0; i < 6; i++)
+			for (size_t j = 0; j < iShadowMapCount; j++)
+			{
+				if (iShadowMapPassCount == vShadowMapCullPasses.size())
 				{
-					pPointLight->renderToShadowMaps(pCommandList.Get(), pCurrentFrameResource, &renderPassCBCopy, i);
+					vShadowMapCullPasses.push_back(std::make_unique<SCullPassResult>());
+				}
 
-					drawOpaqueComponents(pPointLight->getShadowMapConstants(i)); // drawing to shadow map
+				SCullPassResult* pCullPass = vShadowMapCullPasses[iShadowMapPassCount].get();
+				iShadowMapPassCount++;
 
-					pPointLight->finishRenderToShadowMaps(pCommandList.Get(), i);
-				}
+				renderJobGraph.addJob([this, pCullPass, pLight, j](size_t iThreadIndex, size_t iCommandListIndex)
+				{
+					drawToShadowMap(vDrawJobContexts[iCommandListIndex], *pCullPass, pLight, j);
+				});
 			}
-			else
-			{
-				pLevel->vSpawnedLightComponents[i]->renderToShadowMaps(pCommandList.Get(), pCurrentFrameResource, &renderPassCBCopy);
+		}
+	}
 
-				drawOpaqueComponents(pLevel->vSpawnedLightComponents[i]->getShadowMapConstants()); // drawing to shadow map
 
-				pLevel->vSpawnedLightComponents[i]->finishRenderToShadowMaps(pCommandList.Get());
-			}
+	// Opaque shader buckets of the main pass (small buckets are recorded in one job).
+
+	size_t iFirstShader = 0;
+	size_t iComponentCount = 0;
+
+	for (size_t i = 0; i < vOpaqueMeshesByCustomShader.size(); i++)
+	{
+		iComponentCount += vOpaqueMeshesByCustomShader[i].vMeshComponentsWithThisShader.size();
+
+		if (iComponentCount < iMinComponentsPerDrawJob && i + 1 < vOpaqueMeshesByCustomShader.size())
+		{
+			continue;
 		}
+
+		const size_t iLastShader = i + 1;
+
+		renderJobGraph.addJob([this, iFirstShader, iLastShader](size_t iThreadIndex, size_t iCommandListIndex)
+		{
+			SDrawJobContext& context = vDrawJobContexts[iCommandListIndex];
+
+			beginMainPassJob(context);
+
+			drawOpaqueComponents(context, iFirstShader, iLastShader);
+		});
+
+		iFirstShader = iLastShader;
+		iComponentCount = 0;
+	}
+
+
+	// Transparent components (one job to keep the order of the shader buckets).
+
+	if (vTransparentMeshesByCustomShader.size() > 0)
+	{
+		renderJobGraph.addJob([this](size_t iThreadIndex, size_t iCommandListIndex)
+		{
+			SDrawJobContext& context = vDrawJobContexts[iCommandListIndex];
+
+			beginMainPassJob(context);
+
+			setTransparentPSO(context.pCommandList);
+
+			drawTransparentComponents(context);
+		});
+	}
+
+
+	// GUI (the GUI batcher and the sprite renderer are only used by this job).
+
+	if (bDrawGUI)
+	{
+		renderJobGraph.addJob([this](size_t iThreadIndex, size_t iCommandListIndex)
+		{
+			SDrawJobContext& context = vDrawJobContexts[iCommandListIndex];
+
+			beginMainPassJob(context);
+
+			drawGUIObjects(context);
+		});
+	}
+}
+
+void SApplication::beginMainPassJob(SDrawJobContext& context)
+{
+	// The command list of the job has no state.
+
+	ID3D12DescriptorHeap* descriptorHeaps[] = { pCBVSRVUAVHeap.Get() };
+	context.pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+	context.pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
+
+	context.pCommandList->RSSetViewports(1, &ScreenViewport);
+	context.pCommandList->RSSetScissorRects(1, &ScissorRect);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE backBufferCpuHandle = getCurrentBackBufferViewHandle();
+	D3D12_CPU_DESCRIPTOR_HANDLE depthBufferCpuHandle = getDepthStencilViewHandle();
+	context.pCommandList->OMSetRenderTargets(1, &backBufferCpuHandle, true, &depthBufferCpuHandle);
+
+	context.pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+
+	if (bUseFillModeWireframe)
+	{
+		context.pCommandList->SetPipelineState(pOpaqueWireframePSO.Get());
+	}
+	else
+	{
+		context.pCommandList->SetPipelineState(pOpaquePSO.Get());
 	}
+
+	context.pCullPass = &mainCullPass;
 }
 
 void SApplication::draw()
@@ -3019,79 +3554,99 @@ void SApplication::draw()
 	executeCustomComputeShaders(true);
 
 
-	// Record new commands in the command list:
 
-	// CBV/SRV heap & root signature.
+	// Translate back buffer state from present state to render target state.
 
-	ID3D12DescriptorHeap* descriptorHeaps[] = { pCBVSRVUAVHeap.Get() };
-	pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(getCurrentBackBufferResource(),
+		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
+	pCommandList->ResourceBarrier(1, &transition);
 
-	pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
 
 
-	drawToShadowMaps();
+	// Clear buffers.
 
+	// nullptr - "ClearRenderTargetView clears the entire resource view".
+	pCommandList->ClearRenderTargetView(getCurrentBackBufferViewHandle(), backBufferFillColor, 0, nullptr);
+	pCommandList->ClearDepthStencilView(getDepthStencilViewHandle(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
 
-	// Set the viewport and scissor rect. This needs to be reset whenever the command list is reset.
 
-	pCommandList->RSSetViewports(1, &ScreenViewport);
-	pCommandList->RSSetScissorRects(1, &ScissorRect);
 
+	// The start of the frame is executed before the command lists of the render jobs.
 
+	hresult = pCommandList->Close();
+	if (FAILED(hresult))
+	{
+		SError::showErrorMessageBoxAndLog(hresult);
+		return;
+	}
 
-	// Translate back buffer state from present state to render target state.
+	ID3D12CommandList* frameStartCommandLists[] = { pCommandList.Get() };
+	pCommandQueue->ExecuteCommandLists(_countof(frameStartCommandLists), frameStartCommandLists);
 
-	CD3DX12_RESOURCE_BARRIER transition = CD3DX12_RESOURCE_BARRIER::Transition(getCurrentBackBufferResource(),
-		D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET);
-	pCommandList->ResourceBarrier(1, &transition);
 
 
+	// The main pass is culled here (using the threads of the culler), shadow map faces are culled in their jobs.
 
-	// Clear buffers.
+	shadowMapsRenderPassCB = mainRenderPassCB;
 
-	// nullptr - "ClearRenderTargetView clears the entire resource view".
-	pCommandList->ClearRenderTargetView(getCurrentBackBufferViewHandle(), backBufferFillColor, 0, nullptr);
-	pCommandList->ClearDepthStencilView(getDepthStencilViewHandle(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr);
+	cullComponents(mainCullPass, nullptr, true);
 
+	cullInstancedMeshes(mainCullPass);
 
-	
-	// Binds the RTV and DSV to the rendering pipeline.
 
-	D3D12_CPU_DESCRIPTOR_HANDLE backBufferCpuHandle = getCurrentBackBufferViewHandle();
-	D3D12_CPU_DESCRIPTOR_HANDLE depthBufferCpuHandle = getDepthStencilViewHandle();
-	pCommandList->OMSetRenderTargets(1, &backBufferCpuHandle, true, &depthBufferCpuHandle);
 
+	// Record the passes in parallel (each job to its own command list), command lists are executed in the order of the jobs.
 
-	// Render pass cb.
+	addDrawJobs();
 
-	pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+	if (commandListPool.beginFrame(pCurrentFrameResource, renderJobGraph.getJobCount()))
+	{
+		return;
+	}
 
+	vDrawJobContexts.clear();
+	vDrawJobContexts.resize(renderJobGraph.getJobCount());
 
+	for (size_t i = 0; i < vDrawJobContexts.size(); i++)
+	{
+		vDrawJobContexts[i].pCommandList = commandListPool.getCommandList(i);
+		vDrawJobContexts[i].pCullPass = &mainCullPass;
+	}
 
-	// Draw.
+	if (renderJobGraph.execute(&commandListPool))
+	{
+		return;
+	}
 
 	iLastFrameDrawCallCount = 0;
 
-	if (bUseFillModeWireframe)
+	for (size_t i = 0; i < vDrawJobContexts.size(); i++)
 	{
-		pCommandList->SetPipelineState(pOpaqueWireframePSO.Get());
-	}
-	else
-	{
-		pCommandList->SetPipelineState(pOpaquePSO.Get());
+		iLastFrameDrawCallCount += vDrawJobContexts[i].iDrawCallCount;
+
+		// Texture residency is not thread-safe so the textures are marked after recording.
+		for (size_t j = 0; j < vDrawJobContexts[i].vUsedTextureResidencyIds.size(); j++)
+		{
+			textureResidency.markTextureUsed(vDrawJobContexts[i].vUsedTextureResidencyIds[j]);
+		}
 	}
 
-	drawOpaqueComponents();
 
-	setTransparentPSO();
 
-	drawTransparentComponents();
+	// The end of the frame (a command list can be reset after ExecuteCommandLists(), the allocator is still used by the GPU).
 
-	if (bDrawGUI)
+	hresult = pCommandList->Reset(pCurrentCommandListAllocator.Get(), nullptr);
+	if (FAILED(hresult))
 	{
-		drawGUIObjects();
+		SError::showErrorMessageBoxAndLog(hresult);
+		return;
 	}
 
+	ID3D12DescriptorHeap* descriptorHeaps[] = { pCBVSRVUAVHeap.Get() };
+	pCommandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+	pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
+
 	transition
 		= CD3DX12_RESOURCE_BARRIER::Transition(getCurrentBackBufferResource(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT);
 	pCommandList->ResourceBarrier(1, &transition);
@@ -3243,38 +3798,38 @@ void SApplication::draw()
 	mtxFenceUpdate.unlock();
 }
 
-void SApplication::drawOpaqueComponents(SRenderPassConstants* pShadowMapConstants)
+void SApplication::drawOpaqueComponents(SDrawJobContext& context, size_t iFirstShader, size_t iLastShader)
 {
 	bool bUsingCustomResources = false;
 
-	for (size_t i = 0; i < vOpaqueMeshesByCustomShader.size(); i++)
+	for (size_t i = iFirstShader; i < iLastShader; i++)
 	{
 		if (i != 0)
 		{
 			if (vOpaqueMeshesByCustomShader[i].pShader->pCustomShaderResources)
 			{
-				pCommandList->SetGraphicsRootSignature(vOpaqueMeshesByCustomShader[i].pShader->pCustomShaderResources->pCustomRootSignature.Get());
+				context.pCommandList->SetGraphicsRootSignature(vOpaqueMeshesByCustomShader[i].pShader->pCustomShaderResources->pCustomRootSignature.Get());
 
 				// do we need this?
 				// (also uncomment below)
-				//pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+				//context.pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
 
 				bUsingCustomResources = true;
 			}
 
-			if (pShadowMapConstants)
+			if (context.pShadowMapConstants)
 			{
-				pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pShadowMapPSO.Get());
+				context.pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pShadowMapPSO.Get());
 			}
 			else
 			{
 				if (bUseFillModeWireframe)
 				{
-					pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pOpaqueWireframePSO.Get());
+					context.pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pOpaqueWireframePSO.Get());
 				}
 				else
 				{
-					pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pOpaquePSO.Get());
+					context.pCommandList->SetPipelineState(vOpaqueMeshesByCustomShader[i].pShader->pOpaquePSO.Get());
 				}
 			}
 		}
@@ -3292,9 +3847,9 @@ void SApplication::drawOpaqueComponents(SRenderPassConstants* pShadowMapConstant
 
 				if (bParentVisible)
 				{
-					if (!(pShadowMapConstants && vOpaqueMeshesByCustomShader[i].vMeshComponentsWithThisShader[j]->getRenderData()->primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST))
+					if (!(context.pShadowMapConstants && vOpaqueMeshesByCustomShader[i].vMeshComponentsWithThisShader[j]->getRenderData()->primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST))
 					{
-						drawComponent(vOpaqueMeshesByCustomShader[i].vMeshComponentsWithThisShader[j], bUsingCustomResources, pShadowMapConstants);
+						drawComponent(context, vOpaqueMeshesByCustomShader[i].vMeshComponentsWithThisShader[j], bUsingCustomResources);
 					}
 				}
 			}
@@ -3304,8 +3859,8 @@ void SApplication::drawOpaqueComponents(SRenderPassConstants* pShadowMapConstant
 		{
 			if (vOpaqueMeshesByCustomShader[i].pShader->pCustomShaderResources)
 			{
-				pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
-				//pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+				context.pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
+				//context.pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
 
 				bUsingCustomResources = false;
 			}
@@ -3313,7 +3868,7 @@ void SApplication::drawOpaqueComponents(SRenderPassConstants* pShadowMapConstant
 	}
 }
 
-void SApplication::drawTransparentComponents()
+void SApplication::drawTransparentComponents(SDrawJobContext& context)
 {
 	bool bUsingCustomResources = false;
 
@@ -3323,26 +3878,26 @@ void SApplication::drawTransparentComponents()
 		{
 			if (vTransparentMeshesByCustomShader[i].pShader->pCustomShaderResources)
 			{
-				pCommandList->SetGraphicsRootSignature(vTransparentMeshesByCustomShader[i].pShader->pCustomShaderResources->pCustomRootSignature.Get());
+				context.pCommandList->SetGraphicsRootSignature(vTransparentMeshesByCustomShader[i].pShader->pCustomShaderResources->pCustomRootSignature.Get());
 
-				pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+				context.pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
 
 				bUsingCustomResources = true;
 			}
 
 			if (bUseFillModeWireframe)
 			{
-				pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentWireframePSO.Get());
+				context.pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentWireframePSO.Get());
 			}
 			else
 			{
 				if (MSAA_Enabled)
 				{
-					pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentAlphaToCoveragePSO.Get());
+					context.pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentAlphaToCoveragePSO.Get());
 				}
 				else
 				{
-					pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentPSO.Get());
+					context.pCommandList->SetPipelineState(vTransparentMeshesByCustomShader[i].pShader->pTransparentPSO.Get());
 				}
 			}
 		}
@@ -3359,7 +3914,7 @@ void SApplication::drawTransparentComponents()
 				}
 
 				if (bParentVisible)
-					drawComponent(vTransparentMeshesByCustomShader[i].vMeshComponentsWithThisShader[j], bUsingCustomResources);
+					drawComponent(context, vTransparentMeshesByCustomShader[i].vMeshComponentsWithThisShader[j], bUsingCustomResources);
 			}
 		}
 
@@ -3367,8 +3922,8 @@ void SApplication::drawTransparentComponents()
 		{
 			if (vTransparentMeshesByCustomShader[i].pShader->pCustomShaderResources)
 			{
-				pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
-				pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
+				context.pCommandList->SetGraphicsRootSignature(pRootSignature.Get());
+				context.pCommandList->SetGraphicsRootConstantBufferView(0, pCurrentFrameResource->pRenderPassCB.get()->getResource()->GetGPUVirtualAddress());
 
 				bUsingCustomResources = false;
 			}
@@ -3376,125 +3931,123 @@ void SApplication::drawTransparentComponents()
 	}
 }
 
-void SApplication::drawGUIObjects()
+void SApplication::drawGUIObjects(SDrawJobContext& context)
 {
+	applyGUILayout();
+
+	pGUISpriteRenderer->beginFrame(context.pCommandList, pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart(), iCBVSRVUAVDescriptorSize,
+		iMainWindowWidth, iMainWindowHeight);
+
+	guiBatcher.beginFrame();
+
 	for (size_t i = 0; i < vGUILayers.size(); i++)
 	{
 		for (size_t j = 0; j < vGUILayers[i].vGUIObjects.size(); j++)
 		{
-			if (vGUILayers[i].vGUIObjects[j]->isVisible())
+			SGUIObject* pObject = vGUILayers[i].vGUIObjects[j];
+
+			if (pObject->isVisible() == false)
+			{
+				continue;
+			}
+
+			SGUIBatchItem item;
+			item.pObject = pObject;
+
+			if (pObject->objectType == SGUIType::SGT_IMAGE)
+			{
+				SGUIImage* pImage = static_cast<SGUIImage*>(pObject);
+
+				item.iTextureKey = pGUISpriteRenderer->getImageTextureKey(pImage);
+				item.iSpriteCount = 1;
+				item.blendMode = pImage->bPremultipliedAlpha ? SGUIBlendMode::SGBM_PREMULTIPLIED : SGUIBlendMode::SGBM_NON_PREMULTIPLIED;
+			}
+			else if (pObject->objectType == SGUIType::SGT_SIMPLE_TEXT)
 			{
-				if (vGUILayers[i].vGUIObjects[j]->objectType == SGUIType::SGT_IMAGE)
+				SGUISimpleText* pText = static_cast<SGUISimpleText*>(pObject);
+
+				if (pText->pSpriteFont == nullptr)
 				{
-					SGUIImage* pImage = dynamic_cast<SGUIImage*>(vGUILayers[i].vGUIObjects[j]);
+					continue;
+				}
 
-					pImage->pSpriteBatch->Begin(pCommandList.Get());
-
-					auto heapHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart());
-					heapHandle.Offset(pImage->iIndexInHeap, iCBVSRVUAVDescriptorSize);
-
-					// Position.
-					SVector position = pImage->getFullPosition();
-					DirectX::SimpleMath::Vector2 pos = DirectX::SimpleMath::Vector2(position.getX(), position.getY());
-					pos.x *= iMainWindowWidth;
-					pos.y *= iMainWindowHeight;
-
-					DirectX::XMUINT2 texSize = DirectX::GetTextureSize(pImage->pTexture.Get());
-
-					// Origin.
-					DirectX::SimpleMath::Vector2 origin = pImage->origin;
-					origin.x *= texSize.x;
-					origin.y *= texSize.y;
-
-					// Source rect.
-					RECT sourceRect;
-					sourceRect.left = static_cast<LONG>(pImage->sourceRect.getX() * texSize.x);
-					sourceRect.top = static_cast<LONG>(pImage->sourceRect.getY() * texSize.y);
-					sourceRect.right = static_cast<LONG>(pImage->sourceRect.getZ() * texSize.x);
-					sourceRect.bottom = static_cast<LONG>(pImage->sourceRect.getW() * texSize.y);
-
-					// Scaling.
-					DirectX::XMFLOAT2 scaling = pImage->scale; // usual scale
-					SVector screenScaling = pImage->getFullScreenScaling();
-					scaling.x *= screenScaling.getX();
-					scaling.y *= screenScaling.getY();
-
-					RECT bounds;
-					bounds.left = static_cast<LONG>(pos.x - (texSize.x * scaling.x / 2));
-					bounds.right = static_cast<LONG>(pos.x + (texSize.x * scaling.x / 2));
-					bounds.top = static_cast<LONG>(pos.y - (texSize.y * scaling.y / 2));
-					bounds.bottom = static_cast<LONG>(pos.y + (texSize.y * scaling.y / 2));
-					pImage->lastDrawBounds = bounds;
-
-					pImage->pSpriteBatch->Draw(heapHandle,
-						texSize, pos, &sourceRect, DirectX::XMLoadFloat4(&pImage->color), pImage->fRotationInRad, origin,
-						scaling);
-
-					pImage->pSpriteBatch->End();
-					iLastFrameDrawCallCount++;
+				size_t iPassCount = 1;
+				if (pText->bDrawOutline)
+				{
+					iPassCount += 4;
 				}
-				else if (vGUILayers[i].vGUIObjects[j]->objectType == SGUIType::SGT_SIMPLE_TEXT)
+				if (pText->bDrawShadow)
 				{
-					SGUISimpleText* pText = dynamic_cast<SGUISimpleText*>(vGUILayers[i].vGUIObjects[j]);
+					iPassCount += 2;
+				}
 
-					pText->pSpriteBatch->Begin(pCommandList.Get());
+				item.iTextureKey = pText->pSpriteFont->GetSpriteSheet().ptr;
+				item.iSpriteCount = pText->textLayout.getQuads().size() * iPassCount;
+				item.blendMode = SGUIBlendMode::SGBM_PREMULTIPLIED;
+			}
+			else
+			{
+				continue;
+			}
 
-					// Origin.
-					DirectX::SimpleMath::Vector2 texSize = pText->pSpriteFont->MeasureString(pText->sWrappedText.c_str());
-					DirectX::SimpleMath::Vector2 origin = pText->origin;
-					origin.x *= texSize.x;
-					origin.y *= texSize.y;
+			guiBatcher.addItem(item);
+		}
 
-					// Position.
-					SVector position = pText->getFullPosition();
-					DirectX::SimpleMath::Vector2 pos = DirectX::SimpleMath::Vector2(position.getX(), position.getY());
-					pos.x *= iMainWindowWidth;
-					pos.y *= iMainWindowHeight;
+		// Layers and objects inside of a layer are drawn in order, adjacent objects with the same texture are merged.
+		guiBatcher.flushLayer(pGUISpriteRenderer.get());
+	}
 
-					// Scaling.
-					DirectX::XMFLOAT2 scaling = pText->scale;
-					SVector screenScaling = pText->getFullScreenScaling();
-					scaling.x *= screenScaling.getX();
-					scaling.y *= screenScaling.getY();
+	context.iDrawCallCount += guiBatcher.getStats().iDrawCount;
+}
 
-					if (pText->bDrawOutline)
-					{
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(1.f, 1.f), DirectX::XMLoadFloat4(&pText->outlineColor), pText->fRotationInRad,
-							origin, scaling);
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(-1.f, 1.f), DirectX::XMLoadFloat4(&pText->outlineColor), pText->fRotationInRad,
-							origin, scaling);
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(-1.f, -1.f), DirectX::XMLoadFloat4(&pText->outlineColor), pText->fRotationInRad,
-							origin, scaling);
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(1.f, -1.f), DirectX::XMLoadFloat4(&pText->outlineColor), pText->fRotationInRad,
-							origin, scaling);
-					}
+void SApplication::applyGUILayout()
+{
+	std::lock_guard<std::mutex> layoutGuard(mtxGUILayout);
 
-					if (pText->bDrawShadow)
-					{
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(1.f, 1.f), DirectX::Colors::Black, pText->fRotationInRad,
-							origin, scaling);
-						pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(),
-							pos + DirectX::SimpleMath::Vector2(-1.f, 1.f), DirectX::Colors::Black, pText->fRotationInRad,
-							origin, scaling);
-					}
+	guiLayoutSolver.setScreenSize(static_cast<float>(iMainWindowWidth), static_cast<float>(iMainWindowHeight));
 
-					pText->pSpriteFont->DrawString(pText->pSpriteBatch.get(), pText->sWrappedText.c_str(), pos, DirectX::XMLoadFloat4(&pText->color),
-						pText->fRotationInRad, origin, scaling);
+	// Only the childs of the changed layouts and the changed childs are recalculated.
+	if (guiLayoutSolver.solve() == 0)
+	{
+		return;
+	}
 
-					pText->pSpriteBatch->End();
-					iLastFrameDrawCallCount++;
-				}
-			}
+	const std::vector<size_t>& vUpdatedNodes = guiLayoutSolver.getUpdatedNodes();
+
+	for (size_t i = 0; i < vUpdatedNodes.size(); i++)
+	{
+		SGUIObject* pObject = static_cast<SGUIObject*>(guiLayoutSolver.getUserData(vUpdatedNodes[i]));
+		const SGUILayoutResult& result = guiLayoutSolver.getResult(vUpdatedNodes[i]);
+
+		pObject->pos = DirectX::SimpleMath::Vector2(result.fOffsetX, result.fOffsetY); // offset from the center of the layout
+		pObject->origin = DirectX::SimpleMath::Vector2(result.fOriginX, result.fOriginY);
+		pObject->layoutScreenScale = DirectX::XMFLOAT2(result.fLayoutScreenScaleX, result.fLayoutScreenScaleY);
+
+		if (pObject->objectType == SGUIType::SGT_LAYOUT)
+		{
+			SGUILayout* pLayout = static_cast<SGUILayout*>(pObject);
+
+			pLayout->fWidth = result.fFrameWidth;
+			pLayout->fHeight = result.fFrameHeight;
+			pLayout->vSizeToKeep = SVector(result.fFrameWidth, result.fFrameHeight);
+
+#if defined(DEBUG) || defined(_DEBUG)
+			// Parents are updated before their childs.
+			SVector vLayoutPos = pLayout->getFullPosition();
+			pLayout->pDebugLayoutFillImage->pos = DirectX::SimpleMath::Vector2(vLayoutPos.getX(), vLayoutPos.getY());
+			pLayout->pDebugLayoutFillImage->vSizeToKeep = pLayout->vSizeToKeep;
+			pLayout->pDebugLayoutFillImage->recalculateSizeToKeepScaling();
+#endif
+		}
+		else if (result.bHasSizeToKeep)
+		{
+			pObject->vSizeToKeep = SVector(result.fSizeToKeepX, result.fSizeToKeepY);
+			pObject->recalculateSizeToKeepScaling();
 		}
 	}
 }
 
-void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResources, SRenderPassConstants* pShadowMapConstants)
+void SApplication::drawComponent(SDrawJobContext& context, SComponent* pComponent, bool bUsingCustomResources)
 {
 	bool bDrawThisComponent = false;
 	bool bUseFrustumCulling = true;
@@ -3558,35 +4111,46 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 		return;
 	}
 
-	if (bUsingInstancing == false && pComponent->fCullDistance > 0.0f)
+	if (bUsingInstancing == false)
 	{
-		SVector vToOrigin = pComponent->getLocationInWorld() - camera.getCameraLocationInWorld();
-		if (vToOrigin.length() >= pComponent->fCullDistance)
+		if (bUseFrustumCulling)
 		{
-			return; // culled by distance
-		}
-	}
+			// See cullComponents().
+			const std::vector<uint8_t>& vVisible = (pComponent->componentType == SComponentType::SCT_MESH)
+				? context.pCullPass->vMeshVisible : context.pCullPass->vRuntimeMeshVisible;
 
-	if (bUseFrustumCulling && bUsingInstancing == false)
-	{
-		if (doFrustumCulling(pComponent, pShadowMapConstants) == false)
+			if (vVisible[pComponent->iRenderRegistryIndex] == 0)
+			{
+				return; // mesh is outside of the view frustum or culled by distance
+			}
+		}
+		else if (pComponent->fCullDistance > 0.0f)
 		{
-			return; // mesh is outside of the view frustum
+			pComponent->mtxWorldMatrixUpdate.lock();
+			SVector vLocation(pComponent->renderData.vWorld._41, pComponent->renderData.vWorld._42, pComponent->renderData.vWorld._43);
+			pComponent->mtxWorldMatrixUpdate.unlock();
+
+			const DirectX::XMFLOAT3& vCameraLocation = context.pCullPass->vCameraLocation;
+
+			if ((vLocation - SVector(vCameraLocation.x, vCameraLocation.y, vCameraLocation.z)).length() >= pComponent->fCullDistance)
+			{
+				return; // culled by distance
+			}
 		}
 	}
 
 
 	if (pComponent->getRenderData()->primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST)
 	{
-		pCommandList->SetPipelineState(pOpaqueLineTopologyPSO.Get());
+		context.pCommandList->SetPipelineState(pOpaqueLineTopologyPSO.Get());
 	}
 
 	D3D12_VERTEX_BUFFER_VIEW vertBufView = pComponent->getRenderData()->pGeometry->getVertexBufferView();
 	D3D12_INDEX_BUFFER_VIEW indBufView = pComponent->getRenderData()->pGeometry->getIndexBufferView();
 
-	pCommandList->IASetVertexBuffers(0, 1, &vertBufView);
-	pCommandList->IASetIndexBuffer(&indBufView);
-	pCommandList->IASetPrimitiveTopology(pComponent->getRenderData()->primitiveTopologyType);
+	context.pCommandList->IASetVertexBuffers(0, 1, &vertBufView);
+	context.pCommandList->IASetIndexBuffer(&indBufView);
+	context.pCommandList->IASetPrimitiveTopology(pComponent->getRenderData()->primitiveTopologyType);
 
 
 	size_t iMaterialCount = roundUp(vRegisteredMaterials.size(), OBJECT_CB_RESIZE_MULTIPLE);
@@ -3646,8 +4210,22 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 	if (bHasTexture)
 	{
-		heapHandle.Offset(iPerFrameResEndOffset + tex.pRefToTexture->iTexSRVHeapIndex, iCBVSRVUAVDescriptorSize);
-		pCommandList->SetGraphicsRootDescriptorTable(3, heapHandle);
+		if (tex.pRefToTexture->loadState == STextureLoadState::STLS_RESIDENT)
+		{
+			heapHandle.Offset(iPerFrameResEndOffset + tex.pRefToTexture->iTexSRVHeapIndex + tex.pRefToTexture->iActiveSRV, iCBVSRVUAVDescriptorSize);
+
+			if (context.pShadowMapConstants == nullptr && tex.pRefToTexture->iResidencyId != SIZE_MAX)
+			{
+				// Visible in the main pass (marked after all jobs are recorded, see draw()).
+				context.vUsedTextureResidencyIds.push_back(tex.pRefToTexture->iResidencyId);
+			}
+		}
+		else
+		{
+			heapHandle.Offset(iPlaceholderTextureSRVOffset + (tex.pRefToTexture->bIsCubeMap ? 1 : 0), iCBVSRVUAVDescriptorSize);
+		}
+
+		context.pCommandList->SetGraphicsRootDescriptorTable(3, heapHandle);
 	}
 
 
@@ -3656,7 +4234,7 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 	// (uncomment 'recreate cbv heap' in spawn/despawnContainer if
 	// will use views)
-	pCommandList->SetGraphicsRootConstantBufferView(1,
+	context.pCommandList->SetGraphicsRootConstantBufferView(1,
 		pCurrentFrameResource->pObjectsCB.get()->getResource()->GetGPUVirtualAddress() +
 		pComponent->getRenderData()->iObjCBIndex * pCurrentFrameResource->pObjectsCB->getElementSize());
 	// (same in shadow maps)
@@ -3670,10 +4248,9 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 	if (bUsingInstancing)
 	{
-		// Do frustum culling anyway.
+		// Instances were culled once for all passes (see cullInstancedMeshes()).
 
-		UINT64 drawCount = 0;
-		doFrustumCullingOnInstancedMesh(dynamic_cast<SMeshComponent*>(pComponent), drawCount, pShadowMapConstants);
+		UINT64 drawCount = dynamic_cast<SMeshComponent*>(pComponent)->iVisibleInstanceCount;
 
 #if defined(DEBUG) || defined(_DEBUG)
 		if (drawCount > UINT_MAX)
@@ -3685,7 +4262,7 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 		iDrawInstanceCount = static_cast<UINT>(drawCount);
 
-		pCommandList->SetGraphicsRootShaderResourceView(5,
+		context.pCommandList->SetGraphicsRootShaderResourceView(5,
 			dynamic_cast<SMeshComponent*>(pComponent)->vFrameResourcesInstancedData[iCurrentFrameResourceIndex]->getResource()->GetGPUVirtualAddress());
 	}
 
@@ -3703,7 +4280,7 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 	auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart());
 	cbvHandle.Offset(iCBVIndex, iCBVSRVUAVDescriptorSize);
 
-	pCommandList->SetGraphicsRootDescriptorTable(2, cbvHandle);*/
+	context.pCommandList->SetGraphicsRootDescriptorTable(2, cbvHandle);*/
 
 	bool bUsingMaterialBundle = false;
 
@@ -3717,23 +4294,23 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 	if (bUsingMaterialBundle)
 	{
-		pCommandList->SetGraphicsRootShaderResourceView(2,
+		context.pCommandList->SetGraphicsRootShaderResourceView(2,
 			pComponent->pCustomShader->pCustomShaderResources->vFrameResourceBundles[iCurrentFrameResourceIndex]->getResource()->GetGPUVirtualAddress());
 	}
 	else
 	{
-		pCommandList->SetGraphicsRootConstantBufferView(2,
+		context.pCommandList->SetGraphicsRootConstantBufferView(2,
 			pCurrentFrameResource->pMaterialCB.get()->getResource()->GetGPUVirtualAddress()
 			+ iMatCBIndex * pCurrentFrameResource->pMaterialCB->getElementSize());
 	}
 
 
 	// Bind shadow maps.
-	if (!pShadowMapConstants && getCurrentLevel() && getCurrentLevel()->vSpawnedLightComponents.size() > 0)
+	if (!context.pShadowMapConstants && getCurrentLevel() && getCurrentLevel()->vSpawnedLightComponents.size() > 0)
 	{
 		auto gpuHandleToShadowMaps = CD3DX12_GPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart());
 		gpuHandleToShadowMaps.Offset(iShadowMapSRVStartOffset, iCBVSRVUAVDescriptorSize);
-		pCommandList->SetGraphicsRootDescriptorTable(4, gpuHandleToShadowMaps);
+		context.pCommandList->SetGraphicsRootDescriptorTable(4, gpuHandleToShadowMaps);
 	}
 
 
@@ -3741,10 +4318,10 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 
 	if (iDrawInstanceCount != 0)
 	{
-		pCommandList->DrawIndexedInstanced(pComponent->getRenderData()->iIndexCount, iDrawInstanceCount, pComponent->getRenderData()->iStartIndexLocation,
+		context.pCommandList->DrawIndexedInstanced(pComponent->getRenderData()->iIndexCount, iDrawInstanceCount, pComponent->getRenderData()->iStartIndexLocation,
 			pComponent->getRenderData()->iStartVertexLocation, 0);
 
-		iLastFrameDrawCallCount++;
+		context.iDrawCallCount++;
 	}
 
 
@@ -3752,11 +4329,11 @@ void SApplication::drawComponent(SComponent* pComponent, bool bUsingCustomResour
 	{
 		if (bUseFillModeWireframe)
 		{
-			pCommandList->SetPipelineState(pOpaqueWireframePSO.Get());
+			context.pCommandList->SetPipelineState(pOpaqueWireframePSO.Get());
 		}
 		else
 		{
-			pCommandList->SetPipelineState(pOpaquePSO.Get());
+			context.pCommandList->SetPipelineState(pOpaquePSO.Get());
 		}
 	}
 }
@@ -4172,6 +4749,13 @@ bool SApplication::initD3DFirstStage()
 
 
 
+	if (textureLoader.init(pDevice.Get()))
+	{
+		return true;
+	}
+
+
+
 	if (getFirstOutputDisplay(*pOutput.GetAddressOf()))
 	{
 		SError::showErrorMessageBoxAndLog("can't find any output adapters for current display adapter.");
@@ -4638,7 +5222,7 @@ bool SApplication::createCBVSRVUAVHeap()
 
 	iPerFrameResEndOffset = iDescriptorCount;
 
-	iDescriptorCount += static_cast<UINT>(vLoadedTextures.size()); // one SRV per texture
+	iDescriptorCount += static_cast<UINT>(vLoadedTextures.size() * 2); // two SRVs per texture (see updateTextureStreaming())
 
 	// get gui item count
 	size_t iGUIItemCount = 0; // also including SRVs to layouts that don't need an SRV (those SRVs are not going to be used at all (TODO))
@@ -4661,6 +5245,9 @@ bool SApplication::createCBVSRVUAVHeap()
 		}
 	}
 
+	iPlaceholderTextureSRVOffset = iDescriptorCount;
+	iDescriptorCount += 2; // placeholders for textures that are still loading (2D and cube map)
+
 	// --------------------------------------
 	// new global stuff goes here
 	// --------------------------------------
@@ -4725,8 +5312,8 @@ void SApplication::createViews()
 	}
 
 
-	// Need one SRV per loaded texture.
-	if (iPerFrameResEndOffset + vLoadedTextures.size() > INT_MAX)
+	// Need two SRVs per loaded texture (the second one is used when a new resource with other mips is streamed in).
+	if (iPerFrameResEndOffset + vLoadedTextures.size() * 2 > INT_MAX)
 	{
 		SError::showErrorMessageBoxAndLog("cannot create SRVs because an overflow will occur.");
 		return;
@@ -4734,41 +5321,38 @@ void SApplication::createViews()
 
 	for (size_t i = 0; i < vLoadedTextures.size(); i++)
 	{
-		int iIndexInHeap = iPerFrameResEndOffset + static_cast<int>(i);
-		auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetCPUDescriptorHandleForHeapStart());
-
-		handle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+		// The new heap is not used by the GPU.
+		vLoadedTextures[i]->iTexSRVHeapIndex = static_cast<int>(i * 2);
+		vLoadedTextures[i]->iActiveSRV = 0;
+		vLoadedTextures[i]->iInactiveSRVFence = 0;
 
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Format = vLoadedTextures[i]->pResource->GetDesc().Format;
+		createTextureView(vLoadedTextures[i], iPerFrameResEndOffset + vLoadedTextures[i]->iTexSRVHeapIndex);
+	}
 
-		if (vLoadedTextures[i]->bIsCubeMap)
-		{
-			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
-		}
-		else
-		{
-			srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		}
-		
-		srvDesc.Texture2D.MostDetailedMip = 0;
-		srvDesc.Texture2D.MipLevels = vLoadedTextures[i]->pResource->GetDesc().MipLevels;
-		srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-		pDevice->CreateShaderResourceView(vLoadedTextures[i]->pResource.Get(), &srvDesc, handle);
+	// Placeholders for the textures that are still loading (null SRVs are read as black).
+	STextureInternal placeholder;
+	placeholder.loadState = STextureLoadState::STLS_LOADING;
+	createTextureView(&placeholder, iPlaceholderTextureSRVOffset);
 
-		vLoadedTextures[i]->iTexSRVHeapIndex = static_cast<int>(i);
-	}
+	placeholder.bIsCubeMap = true;
+	createTextureView(&placeholder, iPlaceholderTextureSRVOffset + 1);
 
 
 	// GUI SRVs
+
+	{
+		// Fonts reference the SRVs of the old heap, texts will load them again.
+		std::lock_guard<std::mutex> fontGuard(mtxGUIFonts);
+		mGUIFonts.clear();
+	}
+
 	int iCurrentIndex = 0;
 	for (size_t i = 0; i < vGUILayers.size(); i++)
 	{
 		for (size_t j = 0; j < vGUILayers[i].vGUIObjects.size(); j++)
 		{
-			int iIndexInHeap = iPerFrameResEndOffset + static_cast<int>(vLoadedTextures.size()) + iCurrentIndex;
+			int iIndexInHeap = iPerFrameResEndOffset + static_cast<int>(vLoadedTextures.size() * 2) + iCurrentIndex;
 
 			if (vGUILayers[i].vGUIObjects[j]->objectType == SGUIType::SGT_IMAGE)
 			{
@@ -4807,27 +5391,63 @@ void SApplication::createViews()
 		}
 	}
 
-	// get gui item count
-	size_t iGUIItemCount = 0;
-	for (size_t i = 0; i < vGUILayers.size(); i++)
+	// get gui item count
+	size_t iGUIItemCount = 0;
+	for (size_t i = 0; i < vGUILayers.size(); i++)
+	{
+		iGUIItemCount += vGUILayers[i].vGUIObjects.size();
+	}
+
+	if (pBlurEffect)
+	{
+		// Need 2 SRV & 2 UAV for blur.
+
+		int iIndexInHeap = iPerFrameResEndOffset + static_cast<int>(vLoadedTextures.size() * 2 + iGUIItemCount);
+
+		auto cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetCPUDescriptorHandleForHeapStart());
+		cpuHandle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+
+		auto gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart());
+		gpuHandle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+
+		pBlurEffect->assignHeapHandles(cpuHandle, gpuHandle, iCBVSRVUAVDescriptorSize);
+	}
+}
+
+void SApplication::createTextureView(STextureInternal* pTexture, int iIndexInHeap)
+{
+	auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetCPUDescriptorHandleForHeapStart());
+
+	handle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+
+	bool bResident = pTexture->loadState == STextureLoadState::STLS_RESIDENT;
+
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+	if (bResident)
+	{
+		srvDesc.Format = pTexture->pResource->GetDesc().Format;
+	}
+	else
+	{
+		srvDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	if (pTexture->bIsCubeMap)
 	{
-		iGUIItemCount += vGUILayers[i].vGUIObjects.size();
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
 	}
-
-	if (pBlurEffect)
+	else
 	{
-		// Need 2 SRV & 2 UAV for blur.
-
-		int iIndexInHeap = iPerFrameResEndOffset + static_cast<int>(vLoadedTextures.size() + iGUIItemCount);
-
-		auto cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetCPUDescriptorHandleForHeapStart());
-		cpuHandle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+	}
 
-		auto gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(pCBVSRVUAVHeap->GetGPUDescriptorHandleForHeapStart());
-		gpuHandle.Offset(iIndexInHeap, iCBVSRVUAVDescriptorSize);
+	srvDesc.Texture2D.MostDetailedMip = 0;
+	srvDesc.Texture2D.MipLevels = bResident ? pTexture->pResource->GetDesc().MipLevels : 1;
+	srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
 
-		pBlurEffect->assignHeapHandles(cpuHandle, gpuHandle, iCBVSRVUAVDescriptorSize);
-	}
+	pDevice->CreateShaderResourceView(bResident ? pTexture->pResource.Get() : nullptr, &srvDesc, handle);
 }
 
 void SApplication::createFrameResources()
@@ -4981,6 +5601,9 @@ bool SApplication::createRootSignature(SCustomShaderResources* pCustomShaderReso
 		return true;
 	}
 
+	registerRootSignature(pCustomShaderResources ? pCustomShaderResources->pCustomRootSignature.Get() : pRootSignature.Get(),
+		serializedRootSignature.Get());
+
 
 	return false;
 }
@@ -5035,25 +5658,38 @@ bool SApplication::createBlurRootSignature()
 		return true;
 	}
 
+	registerRootSignature(pBlurRootSignature.Get(), serializedRootSig.Get());
+
 
 	return false;
 }
 
 bool SApplication::createShadersAndInputLayout()
 {
-	// Also change in SApplication::compileCustomShader().
-	const D3D_SHADER_MACRO alphaTestDefines[] =
+	// Shaders are compiled on the shader compiler threads, createPSO() waits for them.
+
+	auto compile = [&](const std::wstring& sPathToShader, const std::wstring& sEntryPoint, const std::wstring& sShaderModel, bool bAlphaTest)
 	{
-		"ALPHA_TEST", "1",
-		NULL, NULL
+		SShaderCompileRequest request;
+		request.sPathToShader     = sPathToShader;
+		request.sEntryPoint       = sEntryPoint;
+		request.sShaderModel      = sShaderModel;
+		request.bCompileInRelease = bCompileShadersInRelease;
+
+		if (bAlphaTest)
+		{
+			// Also change in SApplication::startCustomShaderCompilation().
+			request.vDefines.push_back({ "ALPHA_TEST", "1" });
+		}
+
+		return shaderCompiler.compileShader(request);
 	};
-	// Also change in SApplication::compileCustomShader().
 
-	mShaders["basicVS"] = SMiscHelpers::compileShader(L"shaders/basic.hlsl", nullptr, L"VS", SE_VS_SM, bCompileShadersInRelease);
-	mShaders["basicPS"] = SMiscHelpers::compileShader(L"shaders/basic.hlsl", nullptr, L"PS", SE_PS_SM, bCompileShadersInRelease);
-	mShaders["basicAlphaPS"] = SMiscHelpers::compileShader(L"shaders/basic.hlsl", alphaTestDefines, L"PS", SE_PS_SM, bCompileShadersInRelease);
-	mShaders["horzBlurCS"] = SMiscHelpers::compileShader(L"shaders/compute_blur.hlsl", nullptr, L"horzBlurCS", SE_CS_SM, bCompileShadersInRelease);
-	mShaders["vertBlurCS"] = SMiscHelpers::compileShader(L"shaders/compute_blur.hlsl", nullptr, L"vertBlurCS", SE_CS_SM, bCompileShadersInRelease);
+	mPendingShaders["basicVS"]      = compile(L"shaders/basic.hlsl", L"VS", SE_VS_SM, false);
+	mPendingShaders["basicPS"]      = compile(L"shaders/basic.hlsl", L"PS", SE_PS_SM, false);
+	mPendingShaders["basicAlphaPS"] = compile(L"shaders/basic.hlsl", L"PS", SE_PS_SM, true);
+	mPendingShaders["horzBlurCS"]   = compile(L"shaders/compute_blur.hlsl", L"horzBlurCS", SE_CS_SM, false);
+	mPendingShaders["vertBlurCS"]   = compile(L"shaders/compute_blur.hlsl", L"vertBlurCS", SE_CS_SM, false);
 
 
 	// All meshes with default shader will be here.
@@ -5077,8 +5713,33 @@ bool SApplication::createShadersAndInputLayout()
 }
 
 
+bool SApplication::waitForPendingShaders()
+{
+	bool bError = false;
+
+	for (auto it = mPendingShaders.begin(); it != mPendingShaders.end(); ++it)
+	{
+		mShaders[it->first] = it->second.get();
+
+		if (mShaders[it->first] == nullptr)
+		{
+			// The error was already shown.
+			bError = true;
+		}
+	}
+
+	mPendingShaders.clear();
+
+	return bError;
+}
+
 bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 {
+	if (pPSOsForCustomShader == nullptr && waitForPendingShaders())
+	{
+		return true;
+	}
+
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc;
 	memset(&psoDesc, 0, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
 
@@ -5181,7 +5842,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	// only run vertex shader
 	smapPsoDesc.PS =
 	{   // no alpha tests for shadow maps for now
-		// also drawing only opaque objects in drawToShadowMaps()
+		// also drawing only opaque objects in drawToShadowMap()
 		// also custom shaders will only run vertex shader for now
 		nullptr,
 		0
@@ -5190,7 +5851,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	HRESULT hresult;
 	if (pPSOsForCustomShader)
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pOpaquePSO));
+		hresult = createGraphicsPSO(psoDesc, pPSOsForCustomShader->pOpaquePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5199,7 +5860,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 
 		// Shadow map PSO.
 
-		hresult = pDevice->CreateGraphicsPipelineState(&smapPsoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pShadowMapPSO));
+		hresult = createGraphicsPSO(smapPsoDesc, pPSOsForCustomShader->pShadowMapPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5208,14 +5869,14 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	}
 	else
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&pOpaquePSO));
+		hresult = createGraphicsPSO(psoDesc, pOpaquePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
 			return true;
 		}
 
-		hresult = pDevice->CreateGraphicsPipelineState(&smapPsoDesc, IID_PPV_ARGS(&pShadowMapPSO));
+		hresult = createGraphicsPSO(smapPsoDesc, pShadowMapPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5226,7 +5887,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 		// PSO for line topology.
 		D3D12_GRAPHICS_PIPELINE_STATE_DESC psoLineDesc = psoDesc;
 		psoLineDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE;
-		hresult = pDevice->CreateGraphicsPipelineState(&psoLineDesc, IID_PPV_ARGS(&pOpaqueLineTopologyPSO));
+		hresult = createGraphicsPSO(psoLineDesc, pOpaqueLineTopologyPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5246,7 +5907,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 			reinterpret_cast<BYTE*>(pPSOsForCustomShader->pAlphaPS->GetBufferPointer()),
 			pPSOsForCustomShader->pAlphaPS->GetBufferSize()
 		};
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentPsoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pTransparentPSO));
+		hresult = createGraphicsPSO(transparentPsoDesc, pPSOsForCustomShader->pTransparentPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5260,7 +5921,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 			reinterpret_cast<BYTE*>(mShaders["basicAlphaPS"]->GetBufferPointer()),
 			mShaders["basicAlphaPS"]->GetBufferSize()
 		};
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentPsoDesc, IID_PPV_ARGS(&pTransparentPSO));
+		hresult = createGraphicsPSO(transparentPsoDesc, pTransparentPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5276,7 +5937,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 
 	if (pPSOsForCustomShader)
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentAlphaToCoveragePsoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pTransparentAlphaToCoveragePSO));
+		hresult = createGraphicsPSO(transparentAlphaToCoveragePsoDesc, pPSOsForCustomShader->pTransparentAlphaToCoveragePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5285,7 +5946,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	}
 	else
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentAlphaToCoveragePsoDesc, IID_PPV_ARGS(&pTransparentAlphaToCoveragePSO));
+		hresult = createGraphicsPSO(transparentAlphaToCoveragePsoDesc, pTransparentAlphaToCoveragePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5300,7 +5961,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 
 	if (pPSOsForCustomShader)
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&opaqueWireframePsoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pOpaqueWireframePSO));
+		hresult = createGraphicsPSO(opaqueWireframePsoDesc, pPSOsForCustomShader->pOpaqueWireframePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5309,7 +5970,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	}
 	else
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&opaqueWireframePsoDesc, IID_PPV_ARGS(&pOpaqueWireframePSO));
+		hresult = createGraphicsPSO(opaqueWireframePsoDesc, pOpaqueWireframePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5325,7 +5986,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	if (pPSOsForCustomShader)
 	{
 		
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentWireframePsoDesc, IID_PPV_ARGS(&pPSOsForCustomShader->pTransparentWireframePSO));
+		hresult = createGraphicsPSO(transparentWireframePsoDesc, pPSOsForCustomShader->pTransparentWireframePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5334,7 +5995,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	}
 	else
 	{
-		hresult = pDevice->CreateGraphicsPipelineState(&transparentWireframePsoDesc, IID_PPV_ARGS(&pTransparentWireframePSO));
+		hresult = createGraphicsPSO(transparentWireframePsoDesc, pTransparentWireframePSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5352,7 +6013,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 			mShaders["horzBlurCS"]->GetBufferSize()
 		};
 		horzBlurPSO.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-		hresult = pDevice->CreateComputePipelineState(&horzBlurPSO, IID_PPV_ARGS(&pBlurHorizontalPSO));
+		hresult = createComputePSO(horzBlurPSO, pBlurHorizontalPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5368,7 +6029,7 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 			mShaders["vertBlurCS"]->GetBufferSize()
 		};
 		vertBlurPSO.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-		hresult = pDevice->CreateComputePipelineState(&vertBlurPSO, IID_PPV_ARGS(&pBlurVerticalPSO));
+		hresult = createComputePSO(vertBlurPSO, pBlurVerticalPSO);
 		if (FAILED(hresult))
 		{
 			SError::showErrorMessageBoxAndLog(hresult);
@@ -5380,6 +6041,180 @@ bool SApplication::createPSO(SShader* pPSOsForCustomShader)
 	return false;
 }
 
+HRESULT SApplication::createGraphicsPSO(D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& pOutPSO)
+{
+	// The key is made from everything that defines the PSO (the root signature is hashed from its serialized blob).
+
+	uint64_t iKey = SShaderCache::iHashSeed;
+
+	if (hashRootSignature(psoDesc.pRootSignature, iKey))
+	{
+		// Not created by registerRootSignature(), don't use the cache.
+		return pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+	}
+
+	iKey = SShaderCache::hashBytes(psoDesc.VS.pShaderBytecode, psoDesc.VS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.PS.pShaderBytecode, psoDesc.PS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.DS.pShaderBytecode, psoDesc.DS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.HS.pShaderBytecode, psoDesc.HS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.GS.pShaderBytecode, psoDesc.GS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.BlendState, sizeof(psoDesc.BlendState), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.SampleMask, sizeof(psoDesc.SampleMask), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.RasterizerState, sizeof(psoDesc.RasterizerState), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.DepthStencilState, sizeof(psoDesc.DepthStencilState), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.IBStripCutValue, sizeof(psoDesc.IBStripCutValue), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.PrimitiveTopologyType, sizeof(psoDesc.PrimitiveTopologyType), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.NumRenderTargets, sizeof(psoDesc.NumRenderTargets), iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.RTVFormats, sizeof(psoDesc.RTVFormats), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.DSVFormat, sizeof(psoDesc.DSVFormat), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.SampleDesc, sizeof(psoDesc.SampleDesc), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.NodeMask, sizeof(psoDesc.NodeMask), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.Flags, sizeof(psoDesc.Flags), iKey);
+
+	for (UINT i = 0; i < psoDesc.InputLayout.NumElements; i++)
+	{
+		const D3D12_INPUT_ELEMENT_DESC& element = psoDesc.InputLayout.pInputElementDescs[i];
+
+		iKey = SShaderCache::hashBytes(element.SemanticName, strlen(element.SemanticName) + 1, iKey);
+		iKey = SShaderCache::hashBytes(&element.SemanticIndex, sizeof(element.SemanticIndex), iKey);
+		iKey = SShaderCache::hashBytes(&element.Format, sizeof(element.Format), iKey);
+		iKey = SShaderCache::hashBytes(&element.InputSlot, sizeof(element.InputSlot), iKey);
+		iKey = SShaderCache::hashBytes(&element.AlignedByteOffset, sizeof(element.AlignedByteOffset), iKey);
+		iKey = SShaderCache::hashBytes(&element.InputSlotClass, sizeof(element.InputSlotClass), iKey);
+		iKey = SShaderCache::hashBytes(&element.InstanceDataStepRate, sizeof(element.InstanceDataStepRate), iKey);
+	}
+
+	for (UINT i = 0; i < psoDesc.StreamOutput.NumEntries; i++)
+	{
+		const D3D12_SO_DECLARATION_ENTRY& entry = psoDesc.StreamOutput.pSODeclaration[i];
+
+		iKey = SShaderCache::hashBytes(&entry.Stream, sizeof(entry.Stream), iKey);
+		if (entry.SemanticName)
+		{
+			iKey = SShaderCache::hashBytes(entry.SemanticName, strlen(entry.SemanticName) + 1, iKey);
+		}
+		iKey = SShaderCache::hashBytes(&entry.SemanticIndex, sizeof(entry.SemanticIndex), iKey);
+		iKey = SShaderCache::hashBytes(&entry.StartComponent, sizeof(entry.StartComponent), iKey);
+		iKey = SShaderCache::hashBytes(&entry.ComponentCount, sizeof(entry.ComponentCount), iKey);
+		iKey = SShaderCache::hashBytes(&entry.OutputSlot, sizeof(entry.OutputSlot), iKey);
+	}
+
+	iKey = SShaderCache::hashBytes(&psoDesc.StreamOutput.NumEntries, sizeof(psoDesc.StreamOutput.NumEntries), iKey);
+	iKey = SShaderCache::hashBytes(psoDesc.StreamOutput.pBufferStrides, psoDesc.StreamOutput.NumStrides * sizeof(UINT), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.StreamOutput.RasterizedStream, sizeof(psoDesc.StreamOutput.RasterizedStream), iKey);
+
+
+	std::vector<char> vCachedPSO;
+
+	if (shaderCache.load(SShaderCacheEntryType::SCET_PSO, iKey, vCachedPSO) == false)
+	{
+		psoDesc.CachedPSO = { vCachedPSO.data(), vCachedPSO.size() };
+
+		HRESULT hresult = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+		if (SUCCEEDED(hresult))
+		{
+			return hresult;
+		}
+
+		// Different driver/adapter or the blob does not match, create from scratch and replace the blob.
+		shaderCache.onPSORejected();
+
+		psoDesc.CachedPSO = { nullptr, 0 };
+	}
+
+	HRESULT hresult = pDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+	if (FAILED(hresult))
+	{
+		return hresult;
+	}
+
+	storePSOInCache(pOutPSO.Get(), iKey);
+
+	return hresult;
+}
+
+HRESULT SApplication::createComputePSO(D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& pOutPSO)
+{
+	// Compute PSO is defined by its shader, root signature and flags (see createGraphicsPSO()).
+
+	uint64_t iKey = SShaderCache::hashBytes("CS", 2);
+
+	if (hashRootSignature(psoDesc.pRootSignature, iKey))
+	{
+		return pDevice->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+	}
+
+	iKey = SShaderCache::hashBytes(psoDesc.CS.pShaderBytecode, psoDesc.CS.BytecodeLength, iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.NodeMask, sizeof(psoDesc.NodeMask), iKey);
+	iKey = SShaderCache::hashBytes(&psoDesc.Flags, sizeof(psoDesc.Flags), iKey);
+
+	std::vector<char> vCachedPSO;
+
+	if (shaderCache.load(SShaderCacheEntryType::SCET_PSO, iKey, vCachedPSO) == false)
+	{
+		psoDesc.CachedPSO = { vCachedPSO.data(), vCachedPSO.size() };
+
+		HRESULT hresult = pDevice->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+		if (SUCCEEDED(hresult))
+		{
+			return hresult;
+		}
+
+		shaderCache.onPSORejected();
+
+		psoDesc.CachedPSO = { nullptr, 0 };
+	}
+
+	HRESULT hresult = pDevice->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(pOutPSO.ReleaseAndGetAddressOf()));
+	if (FAILED(hresult))
+	{
+		return hresult;
+	}
+
+	storePSOInCache(pOutPSO.Get(), iKey);
+
+	return hresult;
+}
+
+void SApplication::registerRootSignature(ID3D12RootSignature* pRootSignature, ID3DBlob* pSerializedRootSignature)
+{
+	std::lock_guard<std::mutex> guard(mtxRootSignatureHashes);
+
+	// A new root signature can have the address of a released one, the hash is replaced.
+	rootSignatureHashes[pRootSignature] = SShaderCache::hashBytes(pSerializedRootSignature->GetBufferPointer(), pSerializedRootSignature->GetBufferSize());
+}
+
+bool SApplication::hashRootSignature(ID3D12RootSignature* pRootSignature, uint64_t& iKey)
+{
+	std::lock_guard<std::mutex> guard(mtxRootSignatureHashes);
+
+	auto it = rootSignatureHashes.find(pRootSignature);
+	if (it == rootSignatureHashes.end())
+	{
+		return true;
+	}
+
+	iKey = SShaderCache::hashBytes(&it->second, sizeof(it->second), iKey);
+
+	return false;
+}
+
+void SApplication::storePSOInCache(ID3D12PipelineState* pPSO, uint64_t iKey)
+{
+	if (shaderCache.isEnabled() == false)
+	{
+		return;
+	}
+
+	Microsoft::WRL::ComPtr<ID3DBlob> pCachedBlob;
+
+	if (SUCCEEDED(pPSO->GetCachedBlob(pCachedBlob.GetAddressOf())))
+	{
+		// Failing to write the cache is not an error.
+		shaderCache.store(SShaderCacheEntryType::SCET_PSO, iKey, pCachedBlob->GetBufferPointer(), pCachedBlob->GetBufferSize());
+	}
+}
+
 bool SApplication::resetCommandList()
 {
 	// A command list can be reset after it has been added to the command queue via ExecuteCommandList (was added in init()).
@@ -5519,72 +6354,6 @@ void SApplication::showDeviceRemovedReason()
 	SError::showErrorMessageBoxAndLog(hResult);
 }
 
-void SApplication::removeComponentsFromGlobalVectors(SContainer* pContainer)
-{
-	std::vector<SComponent*> vOpaqueMeshComponents;
-	std::vector<SComponent*> vTransparentMeshComponents;
-
-	pContainer->getAllMeshComponents(&vOpaqueMeshComponents, &vTransparentMeshComponents);
-
-	size_t iLeftComponents = vOpaqueMeshComponents.size();
-
-	for (long long i = 0; i < static_cast<long long>(vAllRenderableSpawnedOpaqueComponents.size()); i++)
-	{
-		for (long long j = 0; j < static_cast<long long>(vOpaqueMeshComponents.size()); j++)
-		{
-			if (vAllRenderableSpawnedOpaqueComponents[i] == vOpaqueMeshComponents[j])
-			{
-				vAllRenderableSpawnedOpaqueComponents.erase(vAllRenderableSpawnedOpaqueComponents.begin() + i);
-				i--;
-
-				iLeftComponents--;
-
-				break;
-			}
-		}
-
-		if (iLeftComponents == 0)
-		{
-			break;
-		}
-	}
-
-	if (iLeftComponents != 0)
-	{
-		showMessageBox(L"Error", L"SApplication::despawnContainerFromLevel() error: not all opaque components were removed.");
-	}
-
-
-
-	iLeftComponents = vTransparentMeshComponents.size();
-
-	for (long long i = 0; i < static_cast<long long>(vAllRenderableSpawnedTransparentComponents.size()); i++)
-	{
-		for (long long j = 0; j < static_cast<long long>(vTransparentMeshComponents.size()); j++)
-		{
-			if (vAllRenderableSpawnedTransparentComponents[i] == vTransparentMeshComponents[j])
-			{
-				vAllRenderableSpawnedTransparentComponents.erase(vAllRenderableSpawnedTransparentComponents.begin() + i);
-				i--;
-
-				iLeftComponents--;
-
-				break;
-			}
-		}
-
-		if (iLeftComponents == 0)
-		{
-			break;
-		}
-	}
-
-	if (iLeftComponents != 0)
-	{
-		showMessageBox(L"Error", L"SApplication::despawnContainerFromLevel() error: not all transparent components were removed.");
-	}
-}
-
 void SApplication::moveGUIObjectToLayer(SGUIObject* pObject, int iNewLayer)
 {
 	if (iNewLayer < 0)
@@ -5700,6 +6469,39 @@ void SApplication::refreshHeap()
 	createViews();
 }
 
+std::shared_ptr<DirectX::SpriteFont> SApplication::getGUIFont(const std::wstring& sPathToSpriteFont, D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle,
+	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle)
+{
+	std::lock_guard<std::mutex> guard(mtxGUIFonts);
+
+	auto it = mGUIFonts.find(sPathToSpriteFont);
+	if (it != mGUIFonts.end())
+	{
+		std::shared_ptr<DirectX::SpriteFont> pFont = it->second.lock();
+		if (pFont)
+		{
+			return pFont;
+		}
+	}
+
+	DirectX::ResourceUploadBatch resourceUpload(pDevice.Get());
+
+	resourceUpload.Begin();
+
+	std::shared_ptr<DirectX::SpriteFont> pFont
+		= std::make_shared<DirectX::SpriteFont>(pDevice.Get(), resourceUpload, sPathToSpriteFont.c_str(), cpuHandle, gpuHandle);
+
+	// Upload the resources to the GPU.
+	auto uploadResourcesFinished = resourceUpload.End(pCommandQueue.Get());
+
+	// Wait for the upload thread to terminate
+	uploadResourcesFinished.wait();
+
+	mGUIFonts[sPathToSpriteFont] = pFont;
+
+	return pFont;
+}
+
 void SApplication::releaseShader(SShader* pShader)
 {
 	pShader->pVS.Release();
@@ -6167,23 +6969,7 @@ bool SApplication::doesComponentExists(SComponent* pComponent)
 {
 	std::lock_guard<std::mutex> guard(mtxDraw);
 
-	for (size_t i = 0; i < vAllRenderableSpawnedOpaqueComponents.size(); i++)
-	{
-		if (vAllRenderableSpawnedOpaqueComponents[i] == pComponent)
-		{
-			return true;
-		}
-	}
-
-	for (size_t i = 0; i < vAllRenderableSpawnedTransparentComponents.size(); i++)
-	{
-		if (vAllRenderableSpawnedTransparentComponents[i] == pComponent)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return pCurrentLevel->renderRegistry.isComponentRegistered(pComponent);
 }
 
 bool SApplication::doesComputeShaderExists(SComputeShader* pShader)
@@ -6262,35 +7048,27 @@ SMaterial* SApplication::registerMaterialBundleElement(const std::string& sMater
 	return pMat;
 }
 
-void SApplication::setTransparentPSO()
+void SApplication::setTransparentPSO(ID3D12GraphicsCommandList* pJobCommandList)
 {
 	if (bUseFillModeWireframe)
 	{
-		pCommandList->SetPipelineState(pTransparentWireframePSO.Get());
+		pJobCommandList->SetPipelineState(pTransparentWireframePSO.Get());
 	}
 	else
 	{
 		if (MSAA_Enabled)
 		{
-			pCommandList->SetPipelineState(pTransparentAlphaToCoveragePSO.Get());
+			pJobCommandList->SetPipelineState(pTransparentAlphaToCoveragePSO.Get());
 		}
 		else
 		{
-			pCommandList->SetPipelineState(pTransparentPSO.Get());
+			pJobCommandList->SetPipelineState(pTransparentPSO.Get());
 		}
 	}
 }
 
-bool SApplication::doFrustumCulling(SComponent* pComponent, SRenderPassConstants* pShadowMapConstants)
+void SApplication::cullComponents(SCullPassResult& cullPass, SRenderPassConstants* pShadowMapConstants, bool bUseCullerThreads)
 {
-	pComponent->mtxWorldMatrixUpdate.lock();
-	DirectX::XMMATRIX world    = DirectX::XMLoadFloat4x4(&pComponent->renderData.vWorld);
-	pComponent->mtxWorldMatrixUpdate.unlock();
-
-	DirectX::XMVECTOR worldDet = XMMatrixDeterminant(world);
-
-	DirectX::XMMATRIX invWorld = DirectX::XMMatrixInverse(&worldDet, world);
-
 	DirectX::XMMATRIX view;
 	if (pShadowMapConstants)
 	{
@@ -6305,89 +7083,103 @@ bool SApplication::doFrustumCulling(SComponent* pComponent, SRenderPassConstants
 	DirectX::XMVECTOR viewDet = XMMatrixDeterminant(view);
 	DirectX::XMMATRIX invView = DirectX::XMMatrixInverse(&viewDet, view);
 
-	// View space to the object's local space.
-	DirectX::XMMATRIX viewToObjectLocal = XMMatrixMultiply(invView, invWorld);
+	// Transform the camera frustum from view space to world space once per pass
+	// (instead of transforming it to the local space of every object).
+	DirectX::BoundingFrustum worldSpaceFrustum;
+	cameraBoundingFrustumOnLastMainPassUpdate.Transform(worldSpaceFrustum, invView);
 
-	// Transform the camera frustum from view space to the object's local space.
-	DirectX::BoundingFrustum localSpaceFrustum;
-	cameraBoundingFrustumOnLastMainPassUpdate.Transform(localSpaceFrustum, viewToObjectLocal);
+	SFrustumCuller::getFrustumPlanes(worldSpaceFrustum, cullPass.planes);
 
-	// Perform the box/frustum intersection test in local space.
-	if (localSpaceFrustum.Contains(pComponent->boxCollision) != DirectX::DISJOINT)
-	{
-		// Draw this component.
-		return true;
-	}
+	SVector vCameraLocation = camera.getCameraLocationInWorld();
+	cullPass.vCameraLocation = DirectX::XMFLOAT3(vCameraLocation.getX(), vCameraLocation.getY(), vCameraLocation.getZ());
 
-	return false;
-}
 
-void SApplication::doFrustumCullingOnInstancedMesh(SMeshComponent* pMeshComponent, UINT64& iOutVisibleInstanceCount, SRenderPassConstants* pShadowMapConstants)
-{
-	std::lock_guard<std::mutex> lock(pMeshComponent->mtxInstancing);
+	SRenderRegistry& renderRegistry = pCurrentLevel->renderRegistry;
+
+	const SCullBounds& meshCullBounds = renderRegistry.getMeshCullBounds();
+	const SCullBounds& runtimeMeshCullBounds = renderRegistry.getRuntimeMeshCullBounds();
 
+	if (bUseCullerThreads)
+	{
+		frustumCuller.cull(cullPass.planes, cullPass.vCameraLocation, meshCullBounds, cullPass.vVisibleMeshIndices);
+		frustumCuller.cull(cullPass.planes, cullPass.vCameraLocation, runtimeMeshCullBounds, cullPass.vVisibleRuntimeMeshIndices);
+	}
+	else
+	{
+		// The culler is not reentrant, render jobs cull on their own thread.
+		cullPass.vVisibleMeshIndices.clear();
+		cullPass.vVisibleRuntimeMeshIndices.clear();
+
+		SFrustumCuller::cullRange(cullPass.planes, cullPass.vCameraLocation, meshCullBounds, 0, meshCullBounds.size(),
+			cullPass.vVisibleMeshIndices);
+		SFrustumCuller::cullRange(cullPass.planes, cullPass.vCameraLocation, runtimeMeshCullBounds, 0, runtimeMeshCullBounds.size(),
+			cullPass.vVisibleRuntimeMeshIndices);
+	}
 
-	pMeshComponent->mtxWorldMatrixUpdate.lock();
-	DirectX::XMMATRIX componentWorld = DirectX::XMLoadFloat4x4(&pMeshComponent->renderData.vWorld);
-	pMeshComponent->mtxWorldMatrixUpdate.unlock();
 
-	UINT64 iVisibleInstanceCount = 0;
+	// Mark visible components of this pass (see drawComponent()).
 
-	for (size_t i = 0; i < pMeshComponent->vInstanceData.size(); i++)
+	cullPass.vMeshVisible.assign(meshCullBounds.size(), 0);
+	for (size_t i = 0; i < cullPass.vVisibleMeshIndices.size(); i++)
 	{
-		DirectX::XMMATRIX instanceWorld =
-			// because instance world is relative to the component's world
-			DirectX::XMMatrixMultiply(DirectX::XMLoadFloat4x4(&pMeshComponent->vInstanceData[i].vWorld), componentWorld);
+		cullPass.vMeshVisible[cullPass.vVisibleMeshIndices[i]] = 1;
+	}
 
+	cullPass.vRuntimeMeshVisible.assign(runtimeMeshCullBounds.size(), 0);
+	for (size_t i = 0; i < cullPass.vVisibleRuntimeMeshIndices.size(); i++)
+	{
+		cullPass.vRuntimeMeshVisible[cullPass.vVisibleRuntimeMeshIndices[i]] = 1;
+	}
+}
 
-		DirectX::XMFLOAT4X4 vInstanceWorldFloat4x4;
-		DirectX::XMStoreFloat4x4(&vInstanceWorldFloat4x4, instanceWorld);
-		SVector vInstanceLocationInWorld(vInstanceWorldFloat4x4._41, vInstanceWorldFloat4x4._42, vInstanceWorldFloat4x4._43);
+void SApplication::cullInstancedMeshes(const SCullPassResult& cullPass)
+{
+	// The frame resource has one instance buffer per mesh so all passes (shadow maps too) draw the instances
+	// that are visible in the main pass.
 
-		if ((vInstanceLocationInWorld - camera.getCameraLocationInWorld()).length() >= pMeshComponent->fCullDistance)
-		{
-			continue;
-		}
-		
+	const std::vector<SMeshComponent*>& vMeshComponents = pCurrentLevel->renderRegistry.getMeshComponents();
 
+	for (size_t i = 0; i < vMeshComponents.size(); i++)
+	{
+		SMeshComponent* pMeshComponent = vMeshComponents[i];
 
-		DirectX::XMVECTOR instWorldDet = XMMatrixDeterminant(instanceWorld);
+		bool bCullInstances = false;
 
-		DirectX::XMMATRIX invWorld = DirectX::XMMatrixInverse(&instWorldDet, instanceWorld);
+		pMeshComponent->mtxComponentProps.lock();
+		if (pMeshComponent->bUseInstancing && pMeshComponent->isVisible() && (pMeshComponent->vFrameResourcesInstancedData.size() > 0))
+		{
+			bCullInstances = pMeshComponent->vFrameResourcesInstancedData[0]->getElementCount() > 0;
+		}
+		pMeshComponent->mtxComponentProps.unlock();
 
-		DirectX::XMMATRIX view;
-		if (pShadowMapConstants)
+		if (bCullInstances)
 		{
-			// drawing for shadow maps
-			// cull from light source perspective
-			view = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&pShadowMapConstants->vView)); // transpose back (see updateMainPassCB()).
+			UINT64 iVisibleInstanceCount = 0;
+			doFrustumCullingOnInstancedMesh(pMeshComponent, cullPass, iVisibleInstanceCount);
+
+			pMeshComponent->iVisibleInstanceCount = static_cast<size_t>(iVisibleInstanceCount);
 		}
 		else
 		{
-			view = DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&mainRenderPassCB.vView)); // transpose back (see updateMainPassCB()).
+			pMeshComponent->iVisibleInstanceCount = 0;
 		}
-		DirectX::XMVECTOR viewDet = XMMatrixDeterminant(view);
-		DirectX::XMMATRIX invView = DirectX::XMMatrixInverse(&viewDet, view);
+	}
+}
 
-		// View space to the object's local space.
-		DirectX::XMMATRIX viewToObjectLocal = XMMatrixMultiply(invView, invWorld);
+void SApplication::doFrustumCullingOnInstancedMesh(SMeshComponent* pMeshComponent, const SCullPassResult& cullPass, UINT64& iOutVisibleInstanceCount)
+{
+	std::lock_guard<std::mutex> lock(pMeshComponent->mtxInstancing);
 
-		// Transform the camera frustum from view space to the object's local space.
-		DirectX::BoundingFrustum localSpaceFrustum;
-		cameraBoundingFrustumOnLastMainPassUpdate.Transform(localSpaceFrustum, viewToObjectLocal);
+	pMeshComponent->updateInstanceCullBounds();
 
-		// Perform the box/frustum intersection test in local space.
-		if (localSpaceFrustum.Contains(pMeshComponent->boxCollision) != DirectX::DISJOINT)
-		{
-			// Draw this instance.
-			pMeshComponent->vFrameResourcesInstancedData[iCurrentFrameResourceIndex]->
-				copyDataToElement(iVisibleInstanceCount, pMeshComponent->vInstanceData[i]);
+	// Visible instances are written to the upload buffer at once (per chunk).
 
-			iVisibleInstanceCount++;
-		}
-	}
+	size_t iMappedDataSizeInBytes = 0;
+	unsigned char* pMappedData = pMeshComponent->vFrameResourcesInstancedData[iCurrentFrameResourceIndex]->getMappedData(iMappedDataSizeInBytes);
 
-	iOutVisibleInstanceCount = iVisibleInstanceCount;
+	iOutVisibleInstanceCount = frustumCuller.cullInstances(cullPass.planes, cullPass.vCameraLocation, pMeshComponent->instanceCullBounds,
+		pMeshComponent->vInstanceLODDistances, pMeshComponent->vInstanceData.data(), sizeof(SObjectConstants), pMappedData,
+		iMappedDataSizeInBytes, pMeshComponent->vVisibleInstanceCountPerLOD);
 }
 
 SApplication::SApplication(HINSTANCE hInstance)
@@ -6438,8 +7230,14 @@ SApplication::~SApplication()
 		}
 	}
 
+	shaderCompiler.stop();
+
+	renderJobGraph.stop();
+
 	// Clear loaded textures.
 
+	textureLoader.stop();
+
 	for (size_t i = 0; i < vLoadedTextures.size(); i++)
 	{
 		unsigned long iLeft = vLoadedTextures[i]->pResource.Reset();
@@ -6541,6 +7339,16 @@ bool SApplication::init(const std::wstring& sMainWindowClassName, bool bDisableP
 
 	pDXTKGraphicsMemory = std::make_unique<DirectX::GraphicsMemory>(pDevice.Get());
 
+	DirectX::RenderTargetState guiRTState(BackBufferFormat, DepthStencilFormat);
+	guiRTState.sampleDesc.Count = MSAA_Enabled ? MSAA_SampleCount : 1;
+	guiRTState.sampleDesc.Quality = MSAA_Enabled ? (MSAA_Quality - 1) : 0;
+
+	pGUISpriteRenderer = std::make_unique<SGUISpriteRenderer>();
+	if (pGUISpriteRenderer->init(pDevice.Get(), pCommandQueue.Get(), guiRTState))
+	{
+		return true;
+	}
+
 	bInitCalled = true;
 
 	// Do the initial resize code.
@@ -6565,6 +7373,11 @@ bool SApplication::init(const std::wstring& sMainWindowClassName, bool bDisableP
 		return true;
 	}
 
+	// Not fatal, shaders will be compiled every time.
+	shaderCache.setCacheDirectory(L"_shader_cache/");
+
+	shaderCompiler.start(0, &shaderCache);
+
 	if (createShadersAndInputLayout())
 	{
 		return true;
@@ -6572,6 +7385,18 @@ bool SApplication::init(const std::wstring& sMainWindowClassName, bool bDisableP
 
 	createFrameResources();
 
+	// Each thread that records render jobs has its own command allocator in every frame resource.
+	renderJobGraph.start();
+	commandListPool.init(pDevice.Get(), pCommandQueue.Get());
+
+	for (size_t i = 0; i < vFrameResources.size(); i++)
+	{
+		if (vFrameResources[i]->createRecordingThreadAllocators(renderJobGraph.getRecordingThreadCount()))
+		{
+			return true;
+		}
+	}
+
 	if (createCBVSRVUAVHeap())
 	{
 		return true;
@@ -7032,6 +7857,10 @@ int SApplication::run()
 #endif
 
 
+				// Changes queued by other threads are applied here, so they don't wait for the frame to be drawn.
+				renderCommandQueue.execute();
+
+
 				update();
 
 
@@ -32,6 +32,7 @@
 
 // DirectXTK
 #include "GraphicsMemory.h"
+#include "SpriteFont.h"
 
 // Custom
 #include "SilentEngine/Private/SGameTimer/SGameTimer.h"
@@ -51,6 +52,16 @@
 #include "SilentEngine/Private/SCustomShaderResources/SCustomShaderResources.h"
 #include "SilentEngine/Private/AudioEngine/SAudioEngine/SAudioEngine.h"
 #include "SilentEngine/Private/GUI/SGUIObject/SGUIObject.h"
+#include "SilentEngine/Private/GUI/SGUIBatcher/SGUIBatcher.h"
+#include "SilentEngine/Private/GUI/SGUISpriteRenderer/SGUISpriteRenderer.h"
+#include "SilentEngine/Private/GUI/SGUILayoutSolver/SGUILayoutSolver.h"
+#include "SilentEngine/Private/SFrustumCuller/SFrustumCuller.h"
+#include "SilentEngine/Private/STextureLoader/STextureLoader.h"
+#include "SilentEngine/Private/SShaderCache/SShaderCache.h"
+#include "SilentEngine/Private/SShaderCompiler/SShaderCompiler.h"
+#include "SilentEngine/Private/SRenderCommandQueue/SRenderCommandQueue.h"
+#include "SilentEngine/Private/SRenderJobGraph/SRenderJobGraph.h"
+#include "SilentEngine/Private/SCommandListPool/SCommandListPool.h"
 
 // Other
 #include <Windows.h>
@@ -68,10 +79,12 @@
 
 class SContainer;
 class SComponent;
+class SRuntimeMeshComponent;
 class SShader;
 class SShaderObjects;
 class SComputeShader;
 class SCameraComponent;
+class SLightComponent;
 class SGUIObject;
 class SGUILayer;
 
@@ -91,6 +104,36 @@ struct SCustomShaderProperties
 	STextureHandle skyboxTexture; // if using skybox texture, don't touch other members of this struct.
 };
 
+// Used internally, queued compilation of the custom shader.
+struct SCustomShaderCompilation
+{
+	std::shared_future<ATL::CComPtr<IDxcBlob>> vs;
+	std::shared_future<ATL::CComPtr<IDxcBlob>> ps;
+	std::shared_future<ATL::CComPtr<IDxcBlob>> alphaPS;
+	bool bStarted = false;
+};
+
+// Used internally, visibility of the components in one render pass (see cullComponents()).
+struct SCullPassResult
+{
+	SFrustumPlanes        planes; // world space planes of the pass
+	DirectX::XMFLOAT3     vCameraLocation = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	std::vector<uint32_t> vVisibleMeshIndices;
+	std::vector<uint32_t> vVisibleRuntimeMeshIndices;
+	std::vector<uint8_t>  vMeshVisible;        // indexed by SComponent::iRenderRegistryIndex
+	std::vector<uint8_t>  vRuntimeMeshVisible; // indexed by SComponent::iRenderRegistryIndex
+};
+
+// Used internally, state of one job of the render job graph (each job records to its own command list).
+struct SDrawJobContext
+{
+	ID3D12GraphicsCommandList* pCommandList        = nullptr;
+	const SCullPassResult*     pCullPass           = nullptr;
+	SRenderPassConstants*      pShadowMapConstants = nullptr; // not nullptr when drawing to a shadow map
+	std::vector<size_t>        vUsedTextureResidencyIds;      // textures used in the main pass (marked after recording)
+	unsigned long long         iDrawCallCount      = 0;
+};
+
 
 //@@Class
 /*
@@ -311,6 +354,19 @@ public:
 		STextureHandle  loadTextureFromDiskToGPU               (std::string sTextureName, std::wstring sPathToTextureFile, bool bIsCubeMap, bool& bErrorOccurred);
 		//@@Function
 		/*
+		* desc: same as loadTextureFromDiskToGPU() but returns the handle right away, the file is read on a background thread
+		and uploaded using a copy queue so the rendering is not stopped while the texture is loading.
+		* param "sTextureName": unique name of the texture, cannot be empty.
+		* param "sPathToTexture": path to the texture file (only .dds texture format).
+		* param "bIsCubeMap": set to 'true' if the texture is a cube map.
+		* param "bErrorOccurred": will be true if an error occurred and the returned handle is invalid, false otherwise.
+		* remarks: use STextureHandle::getLoadState() to check if the texture is loaded, until then the materials with this texture
+		are rendered using a black placeholder texture. If the file fails to load the state becomes STLS_FAILED and the texture
+		still needs to be unloaded via SApplication::unloadTextureFromGPU().
+		*/
+		STextureHandle  loadTextureFromDiskToGPUAsync          (std::string sTextureName, std::wstring sPathToTextureFile, bool bIsCubeMap, bool& bErrorOccurred);
+		//@@Function
+		/*
 		* desc: returns a loaded texture.
 		* param "sTextureName": the name of the loaded texture.
 		* param "bNotFound": will be true if there is no loaded texture with this name.
@@ -337,6 +393,20 @@ public:
 		as this function may drop the framerate a little.
 		*/
 		bool            unloadTextureFromGPU                   (STextureHandle& textureHandle);
+		//@@Function
+		/*
+		* desc: sets the GPU memory budget for the texture mips, when the budget is exceeded the most detailed mips
+		of the least recently used textures are evicted (the least detailed mips of the textures are always kept).
+		* remarks: textures loaded via loadTextureFromDiskToGPUAsync() start with their least detailed mips
+		and get more detailed mips (one mip per frame) while they are used by the visible objects.
+		By default the budget is not limited.
+		*/
+		void            setTextureMemoryBudget                 (unsigned long long iBudgetInBytes);
+		//@@Function
+		/*
+		* desc: returns the statistics of the texture mip streaming.
+		*/
+		STextureResidencyStats getTextureResidencyStats        ();
 
 
 	// Shaders
@@ -360,6 +430,31 @@ public:
 		SShader*        compileCustomShader                   (const std::wstring& sPathToShaderFile,
 			const SCustomShaderProperties& customProps, SCustomShaderResources** pOutCustomResources = nullptr);
 
+		//@@Function
+		/*
+		* desc: same as compileCustomShader() but for multiple shaders, all shaders (and their permutations)
+		are compiled concurrently on the shader compiler threads.
+		* param "vCustomProps": properties of each shader (same size as vPathsToShaderFiles).
+		* param "pOutCustomResources": (optional) filled with the created resources of each shader (nullptr if failed).
+		* return: compiled shaders in the same order as vPathsToShaderFiles (nullptr if the shader failed to compile).
+		*/
+		std::vector<SShader*> compileCustomShaders            (const std::vector<std::wstring>& vPathsToShaderFiles,
+			const std::vector<SCustomShaderProperties>& vCustomProps, std::vector<SCustomShaderResources*>* pOutCustomResources = nullptr);
+
+		//@@Function
+		/*
+		* desc: returns the statistics of the shader cache (compiled shaders and pipeline states are cached on the disk
+		in the "_shader_cache" directory, a shader is compiled again only if its file, its includes, defines or compile flags change).
+		*/
+		SShaderCacheStats getShaderCacheStats                 ();
+
+		//@@Function
+		/*
+		* desc: removes all compiled shaders and pipeline states from the disk cache (shaders that are already compiled are not affected).
+		* return: false if successful, true otherwise.
+		*/
+		bool            clearShaderCache                      ();
+
 		//@@Function
 		/*
 		* desc: used to retrieve all compiled custom shaders.
@@ -487,6 +582,14 @@ public:
 		*/
 		SAudioEngine*          getAudioEngine                  ();
 
+		//@@Function
+		/*
+		* desc: queues the function to be called on the main thread at the start of the next frame (before the frame is updated and drawn).
+		* remarks: thread-safe and lock-free (does not wait for the current frame to be drawn), use it in onPhysicsTick() or in your threads
+		instead of the functions that change the level, the functions are called in the order in which they were queued and can use any engine function.
+		*/
+		void                   enqueueRenderCommand            (std::function<void()> command);
+
 		//@@Function
 		/*
 		* desc: returns the pointer to the SApplication instance if one was created.
@@ -763,6 +866,11 @@ private:
 		void createViews                     ();
 		//@@Function
 		/*
+		* desc: creates the SRV of the texture in its slot of the CBV/SRV/UAV heap (a null SRV if the texture is not resident).
+		*/
+		void createTextureView               (STextureInternal* pTexture, int iIndexInHeap);
+		//@@Function
+		/*
 		* desc: creates frame resources.
 		* remarks: each frame resource has everything to render a frame.
 		So we can render N frames using N frame resources continuously, without waiting
@@ -784,12 +892,58 @@ private:
 		bool createShadersAndInputLayout     ();
 		//@@Function
 		/*
+		* desc: waits for the shaders queued in createShadersAndInputLayout() and moves them to mShaders.
+		* return: false if successful, true if some shader failed to compile.
+		*/
+		bool waitForPendingShaders           ();
+		//@@Function
+		/*
+		* desc: checks the custom shader file and queues its compilation.
+		* return: false if successful, true otherwise.
+		*/
+		bool startCustomShaderCompilation    (const std::wstring& sPathToShaderFile, SCustomShaderCompilation& outCompilation);
+		//@@Function
+		/*
+		* desc: waits for the compiled custom shader and creates its resources and PSOs.
+		* return: valid pointer if successful, nullptr otherwise.
+		*/
+		SShader* finishCustomShaderCompilation(const std::wstring& sPathToShaderFile, SCustomShaderCompilation& compilation,
+			const SCustomShaderProperties& customProps, SCustomShaderResources** pOutCustomResources);
+		//@@Function
+		/*
 		* desc: creates PSO.
 		* return: false if successful, true otherwise.
 		*/
 		bool createPSO                       (SShader* pPSOsForCustomShader = nullptr);
 		//@@Function
 		/*
+		* desc: creates the graphics PSO using the cached PSO blob (if it's in the shader cache) and stores the blob of the new PSO in the cache.
+		*/
+		HRESULT createGraphicsPSO            (D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& pOutPSO);
+		//@@Function
+		/*
+		* desc: creates the compute PSO using the cached PSO blob (if it's in the shader cache) and stores the blob of the new PSO in the cache.
+		*/
+		HRESULT createComputePSO             (D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& pOutPSO);
+		//@@Function
+		/*
+		* desc: remembers the hash of the serialized root signature so that PSOs that use it are cached under different keys
+		(should be called for every created root signature).
+		*/
+		void registerRootSignature           (ID3D12RootSignature* pRootSignature, ID3DBlob* pSerializedRootSignature);
+		//@@Function
+		/*
+		* desc: adds the hash of the root signature (see registerRootSignature()) to the PSO cache key.
+		* return: false if successful, true if the root signature was not registered.
+		*/
+		bool hashRootSignature               (ID3D12RootSignature* pRootSignature, uint64_t& iKey);
+		//@@Function
+		/*
+		* desc: stores the cached blob of the PSO in the shader cache.
+		*/
+		void storePSOInCache                 (ID3D12PipelineState* pPSO, uint64_t iKey);
+		//@@Function
+		/*
 		* desc: resets command list so it can be used.
 		* return: false if successful, true otherwise.
 		*/
@@ -830,6 +984,17 @@ private:
 		* desc: updates the camera and buffers.
 		*/
 		void update                          ();
+		//@@Function
+		/*
+		* desc: creates views for the textures (and mips) uploaded by the textureLoader, recreates the CBV/SRV/UAV heap
+		if new textures were added (at most once per frame) and requests mips for the textures used in the last frame.
+		*/
+		void updateTextureStreaming          ();
+		//@@Function
+		/*
+		* desc: starts managing the mips of the texture (pTexture->ddsDesc, iMinResidentMip and iResidentMip should be set).
+		*/
+		void registerTextureResidency        (STextureInternal* pTexture);
 		void updateMaterials                 ();
 		//@@Function
 		/*
@@ -838,9 +1003,16 @@ private:
 		void updateObjectCBs                 ();
 		//@@Function
 		/*
-		* desc: updates the objects' constant buffers.
+		* desc: copies new vertex data (if the mesh data was changed) of the runtime mesh component to the current frame resource.
+		* remarks: expects the component's mtxComponentProps to be locked.
+		*/
+		void updateRuntimeMeshVertexBuffer   (SRuntimeMeshComponent* pRuntimeMeshComponent);
+		//@@Function
+		/*
+		* desc: updates the object's constant buffer (if needed) of the mesh or runtime mesh component.
+		* remarks: expects the component's mtxComponentProps to be locked.
 		*/
-		void updateComponentAndChilds        (SComponent* pComponent, SUploadBuffer<SObjectConstants>* pCurrentObjectCB);
+		void updateComponentObjectCB         (SComponent* pComponent, SUploadBuffer<SObjectConstants>* pCurrentObjectCB);
 		//@@Function
 		/*
 		* desc: updates the main pass constant buffer.
@@ -852,11 +1024,26 @@ private:
 		* desc: draws the frame.
 		*/
 		void draw                            ();
-		void drawOpaqueComponents            (SRenderPassConstants* pShadowMapConstants = nullptr);
-		void drawTransparentComponents       ();
-		void drawGUIObjects                  ();
-		void drawComponent                   (SComponent* pComponent, bool bUsingCustomResources = false, SRenderPassConstants* pShadowMapConstants = nullptr);
-		void drawToShadowMaps                ();
+		//@@Function
+		/*
+		* desc: adds the jobs of the frame to the render job graph (shadow map faces, opaque shader buckets, transparent pass and GUI).
+		*/
+		void addDrawJobs                     ();
+		//@@Function
+		/*
+		* desc: sets the state of the main pass (descriptor heaps, root signature, render targets and render pass CB) to the job's command list.
+		*/
+		void beginMainPassJob                (SDrawJobContext& context);
+		//@@Function
+		/*
+		* desc: draws opaque components of the shader buckets in range [iFirstShader, iLastShader).
+		*/
+		void drawOpaqueComponents            (SDrawJobContext& context, size_t iFirstShader, size_t iLastShader);
+		void drawTransparentComponents       (SDrawJobContext& context);
+		void drawGUIObjects                  (SDrawJobContext& context);
+		void applyGUILayout                  ();
+		void drawComponent                   (SDrawJobContext& context, SComponent* pComponent, bool bUsingCustomResources = false);
+		void drawToShadowMap                 (SDrawJobContext& context, SCullPassResult& cullPass, SLightComponent* pLight, size_t iShadowMapIndex);
 		//@@Function
 		/*
 		* desc: used to set the FPS limit (FPS cap).
@@ -1199,17 +1386,24 @@ private:
 	SMaterial* registerMaterialBundleElement(const std::string& sMaterialName, bool& bErrorOccurred);
 
 	// Frustum culling.
-	bool doFrustumCulling(SComponent* pComponent, SRenderPassConstants* pShadowMapConstants = nullptr);
-	void doFrustumCullingOnInstancedMesh(SMeshComponent* pMeshComponent, UINT64& iOutVisibleInstanceCount, SRenderPassConstants* pShadowMapConstants = nullptr);
+	// fills the visibility of the pass (pShadowMapConstants is nullptr for the main pass), bUseCullerThreads should be false in render jobs
+	void cullComponents(SCullPassResult& cullPass, SRenderPassConstants* pShadowMapConstants, bool bUseCullerThreads);
+	// writes visible instances of all instanced meshes to the frame resource (once per frame, using the main pass)
+	void cullInstancedMeshes(const SCullPassResult& cullPass);
+	void doFrustumCullingOnInstancedMesh(SMeshComponent* pMeshComponent, const SCullPassResult& cullPass, UINT64& iOutVisibleInstanceCount);
 
 	// Other.
 	void showDeviceRemovedReason();
 	bool nanosleep(long long ns);
-	void setTransparentPSO();
-	void removeComponentsFromGlobalVectors(SContainer* pContainer);
+	void setTransparentPSO(ID3D12GraphicsCommandList* pJobCommandList);
 	void moveGUIObjectToLayer(SGUIObject* pObject, int iNewLayer);
 	void refreshHeap();
 
+	// GUI.
+	// returns the font that is already loaded from this file or loads the font using the specified SRV handles
+	std::shared_ptr<DirectX::SpriteFont> getGUIFont(const std::wstring& sPathToSpriteFont, D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle,
+		D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle);
+
 
 	// -----------------------------------------------------------------
 
@@ -1225,6 +1419,7 @@ private:
 	friend class SGUIObject;
 	friend class SGUIImage;
 	friend class SGUISimpleText;
+	friend class SGUILayout;
 	friend class SShadowMap;
 
 
@@ -1242,6 +1437,12 @@ private:
 	// GUI.
 	std::vector<SGUILayer>                   vGUILayers;
 	std::unique_ptr<DirectX::GraphicsMemory> pDXTKGraphicsMemory;
+	std::unique_ptr<SGUISpriteRenderer>      pGUISpriteRenderer;
+	SGUIBatcher                              guiBatcher;
+	std::unordered_map<std::wstring, std::weak_ptr<DirectX::SpriteFont>> mGUIFonts; // cleared when the heap is recreated
+	std::mutex                               mtxGUIFonts;
+	SGUILayoutSolver                         guiLayoutSolver;
+	std::mutex                               mtxGUILayout; // guards guiLayoutSolver, should not be held while locking other mutexes
 	bool                                     bDrawGUI = true;
 	size_t                                   iInteractableImagesCount = 0;
 	std::wstring                             sPathToDefaultFont = L"res/default_font.spritefont";
@@ -1299,6 +1500,7 @@ private:
 	Microsoft::WRL::ComPtr<ID3D12RootSignature>  pRootSignature;
 	Microsoft::WRL::ComPtr<ID3D12RootSignature>  pBlurRootSignature;
 	std::unordered_map<std::string, ATL::CComPtr<IDxcBlob>> mShaders;
+	std::unordered_map<std::string, std::shared_future<ATL::CComPtr<IDxcBlob>>> mPendingShaders; // waited for in createPSO()
 
 
 	// CB constants.
@@ -1310,8 +1512,18 @@ private:
 
 	// Materials / Textures / Shaders
 	std::vector<SMaterial*> vRegisteredMaterials;
+	SDirtyQueue<SMaterial>  materialDirtyQueue;
 	std::string sDefaultEngineMaterialName = "Default Engine Material";
 	std::vector<STextureInternal*> vLoadedTextures;
+	STextureLoader textureLoader;
+	std::vector<SLoadedTexture> vPostponedTextureSwaps; // loaded mips that wait for the inactive SRV of their texture to be unused by the GPU
+	STextureResidencyManager textureResidency{&textureLoader};
+	SShaderCache shaderCache;
+	std::unordered_map<ID3D12RootSignature*, uint64_t> rootSignatureHashes; // hashes of the serialized root signatures (PSO cache keys)
+	std::mutex mtxRootSignatureHashes;
+	SShaderCompiler shaderCompiler;
+	bool bTextureViewsOutdated = false; // the CBV/SRV/UAV heap needs to be recreated for the new textures
+	int iPlaceholderTextureSRVOffset = 0; // 2D placeholder, cube map placeholder is next
 	TEX_FILTER_MODE textureFilterIndex = TEX_FILTER_MODE::TFM_ANISOTROPIC;
 	std::vector<SShader*> vCompiledUserShaders;
 	std::vector<SShaderObjects> vOpaqueMeshesByCustomShader;
@@ -1339,8 +1551,6 @@ private:
 	SLevel*        pCurrentLevel = nullptr;
 	std::vector<SContainer*> vAllRenderableSpawnedContainers;
 	std::vector<SContainer*> vAllNonrenderableSpawnedContainers;
-	std::vector<SComponent*> vAllRenderableSpawnedOpaqueComponents;
-	std::vector<SComponent*> vAllRenderableSpawnedTransparentComponents;
 
 
 	// MSAA.
@@ -1376,6 +1586,20 @@ private:
 	SCamera        camera;
 	DirectX::BoundingFrustum cameraBoundingFrustumOnLastMainPassUpdate;
 
+
+	// Frustum culling.
+	SFrustumCuller        frustumCuller;
+	SCullPassResult       mainCullPass;
+	std::vector<std::unique_ptr<SCullPassResult>> vShadowMapCullPasses; // one per shadow map face, grows when needed
+
+
+	// Multithreaded recording.
+	SRenderJobGraph              renderJobGraph;
+	SCommandListPool             commandListPool;
+	std::vector<SDrawJobContext> vDrawJobContexts;     // one per job of the render job graph
+	SRenderPassConstants         shadowMapsRenderPassCB; // copy of the main pass CB for the lights
+	static constexpr size_t      iMinComponentsPerDrawJob = 128; // opaque shader buckets are merged until the job has this many components
+
 	
 	// Windows stuff.
 	std::wstring   sMainWindowClassName;
@@ -1430,6 +1654,8 @@ private:
 	std::mutex     mtxDraw;
 	std::mutex     mtxFenceUpdate;
 
+	SRenderCommandQueue renderCommandQueue; // executed once per frame on the main thread (without mtxDraw)
+
 
 	std::wstring   sMainWindowTitle         = L"Silent Application";
 	std::wstring   sPreferredDisplayAdapter = L"";
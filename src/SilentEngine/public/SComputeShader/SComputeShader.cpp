@@ -89,6 +89,20 @@ bool SComputeShader::startShaderExecution(unsigned int iThreadGroupCountX, unsig
 	if (pComputeRootSignature == nullptr)
 	{
 		// First time started compute shader.
+
+		if (compiledShaderFuture.valid())
+		{
+			// Wait for the shader compiler.
+			pCompiledShader = compiledShaderFuture.get();
+			compiledShaderFuture = std::shared_future<ATL::CComPtr<IDxcBlob>>();
+		}
+
+		if (pCompiledShader == nullptr)
+		{
+			// The error was already shown.
+			return true;
+		}
+
 		createRootSignatureAndPSO();
 	}
 
@@ -111,7 +125,16 @@ void SComputeShader::stopShaderExecution()
 
 void SComputeShader::compileShader(const std::wstring& sPathToShaderFile, const std::wstring& sShaderEntryFunctionName)
 {
-	pCompiledShader = SMiscHelpers::compileShader(sPathToShaderFile, nullptr, sShaderEntryFunctionName, SE_CS_SM, bCompileShaderInReleaseMode);
+	// Compiled on the shader compiler threads, startShaderExecution() waits for it.
+
+	SShaderCompileRequest request;
+	request.sPathToShader     = sPathToShaderFile;
+	request.sEntryPoint       = sShaderEntryFunctionName;
+	request.sShaderModel      = SE_CS_SM;
+	request.bCompileInRelease = bCompileShaderInReleaseMode;
+
+	pCompiledShader = nullptr;
+	compiledShaderFuture = SApplication::getApp()->shaderCompiler.compileShader(request);
 
 	bCompiledShader = true;
 }
@@ -496,6 +519,8 @@ void SComputeShader::createRootSignatureAndPSO()
 
 	delete[] pSlotRootParameter;
 
+	SApplication::getApp()->registerRootSignature(pComputeRootSignature.Get(), serializedRootSig.Get());
+
 
 	// Create PSO.
 
@@ -507,7 +532,7 @@ void SComputeShader::createRootSignatureAndPSO()
 		pCompiledShader->GetBufferSize()
 	};
 	horzBlurPSO.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-	hresult = pDevice->CreateComputePipelineState(&horzBlurPSO, IID_PPV_ARGS(&pComputePSO));
+	hresult = SApplication::getApp()->createComputePSO(horzBlurPSO, pComputePSO);
 	if (FAILED(hresult))
 	{
 		SError::showErrorMessageBoxAndLog(hresult);
@@ -12,6 +12,7 @@
 #include <vector>
 #include <mutex>
 #include <functional>
+#include <future>
 
 // DirectX
 #include <d3d12.h>
@@ -178,6 +179,7 @@ private:
 	Microsoft::WRL::ComPtr<ID3D12RootSignature> pComputeRootSignature;
 	Microsoft::WRL::ComPtr<ID3D12PipelineState> pComputePSO;
 	ATL::CComPtr<IDxcBlob> pCompiledShader;
+	std::shared_future<ATL::CComPtr<IDxcBlob>> compiledShaderFuture; // valid until startShaderExecution() waits for it
 
 
 	std::vector<SComputeShaderResource*> vShaderResources;
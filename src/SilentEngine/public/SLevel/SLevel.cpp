@@ -7,6 +7,9 @@
 
 #include "SLevel.h"
 
+// STL
+#include <algorithm>
+
 // Custom
 #include "SilentEngine/Public/SApplication/SApplication.h"
 #include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
@@ -20,7 +23,6 @@ SLevel::SLevel(SApplication* pApp)
 
 	bLevelBoundsCalculated = false;
 	bEnableIntersectionTests = false;
-	bInCollisionIntersectionTests = false;
 }
 
 SLevel::~SLevel()
@@ -36,181 +38,168 @@ SLevel::~SLevel()
 
 void SLevel::rayCast(SVector& vRayStartPos, SVector& vRayStopPos, std::vector<SRayCastHit>& vHitResult, const std::vector<SComponent*>& vIgnoreList)
 {
-	if (bInCollisionIntersectionTests == false) std::lock_guard<std::mutex> guard(pApp->mtxDraw);
+	std::lock_guard<std::mutex> guard(mtxCollision);
+
+	updateCollisionBounds();
+
+	SVector vRayDirection = vRayStopPos - vRayStartPos;
+	float fRayLength = vRayDirection.length();
+	vRayDirection.normalizeVector();
+
+	// Find components which world space bounds are hit by the ray.
 
-	std::vector<SComponent*> vRenderableAllComponents = pApp->vAllRenderableSpawnedOpaqueComponents;
-	vRenderableAllComponents.insert(vRenderableAllComponents.end(), pApp->vAllRenderableSpawnedTransparentComponents.begin(), pApp->vAllRenderableSpawnedTransparentComponents.end());
+	std::vector<uint32_t> vProxies;
+	renderRegistry.getBVH().rayCast(DirectX::XMFLOAT3(vRayStartPos.getX(), vRayStartPos.getY(), vRayStartPos.getZ()),
+		DirectX::XMFLOAT3(vRayDirection.getX(), vRayDirection.getY(), vRayDirection.getZ()), fRayLength, vProxies);
 
-	for (size_t i = 0; i < vRenderableAllComponents.size(); i++)
+	// Test in the same order as rayCastBatch() so that hits with equal distance are sorted the same way.
+	std::sort(vProxies.begin(), vProxies.end());
+
+	for (size_t i = 0; i < vProxies.size(); i++)
 	{
-		std::mutex* pMeshPropsMtx = nullptr;
-		SMeshData* pMeshData = nullptr;
+		SComponent* pComponent = renderRegistry.getBVHProxyComponent(vProxies[i]);
 
-		if (vRenderableAllComponents[i]->getComponentType() == SComponentType::SCT_MESH)
+		if (isComponentCollidable(pComponent) == false || isComponentIgnored(pComponent, vIgnoreList))
 		{
-			SMeshComponent* pMesh = dynamic_cast<SMeshComponent*>(vRenderableAllComponents[i]);
-			bool bVisible = pMesh->isVisible() && pMesh->getContainer()->isVisible();
+			continue;
+		}
 
-			if (bVisible == false || (pMesh->pParentComponent && pMesh->pParentComponent->bVisible == false))
-			{
-				continue;
-			}
+		pComponent->mtxComponentProps.lock();
 
-			if (pMesh->renderData.primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST)
-			{
-				continue; // lines have no collision
-			}
+		rayCastComponent(pComponent, getInvWorldMatrix(pComponent), vRayStartPos, vRayDirection, fRayLength, vHitResult);
 
-			if (pMesh->getCollisionPreset() == SCollisionPreset::SCP_NO_COLLISION || pMesh->bUseInstancing)
-			{
-				continue;
-			}
+		pComponent->mtxComponentProps.unlock();
+	}
 
-			pMeshPropsMtx = &pMesh->mtxComponentProps;
-			pMeshPropsMtx->lock();
-			pMeshData = pMesh->getMeshData();
-		}
-		else if (vRenderableAllComponents[i]->getComponentType() == SComponentType::SCT_RUNTIME_MESH)
-		{
-			SRuntimeMeshComponent* pMesh = dynamic_cast<SRuntimeMeshComponent*>(vRenderableAllComponents[i]);
-			bool bVisible = pMesh->isVisible() && pMesh->getContainer()->isVisible();
+	std::stable_sort(vHitResult.begin(), vHitResult.end(), [](const SRayCastHit& a, const SRayCastHit& b) {return a.fHitDistanceFromRayOrigin < b.fHitDistanceFromRayOrigin; });
+}
 
-			if (bVisible == false || (pMesh->pParentComponent && pMesh->pParentComponent->bVisible == false))
-			{
-				continue;
-			}
+void SLevel::rayCastBatch(const std::vector<SRay>& vRays, std::vector<std::vector<SRayCastHit>>& vHitResults, const std::vector<SComponent*>& vIgnoreList,
+	bool bUseMultipleThreads)
+{
+	std::lock_guard<std::mutex> guard(mtxCollision);
 
-			if (pMesh->getCollisionPreset() == SCollisionPreset::SCP_NO_COLLISION)
-			{
-				continue;
-			}
+	updateCollisionBounds();
 
-			pMeshPropsMtx = &pMesh->mtxComponentProps;
-			pMeshPropsMtx->lock();
-			pMeshData = pMesh->getMeshData();
-		}
+	vHitResults.clear();
+	vHitResults.resize(vRays.size());
+
+	if (vRays.empty())
+	{
+		return;
+	}
 
-		// Check ingore list.
-		for (size_t j = 0; j < vIgnoreList.size(); j++)
+	size_t iThreadCount = 1;
+	if (bUseMultipleThreads && vRays.size() / iMinRaysPerThread > 1)
+	{
+		// mtxCollision is held so only one batch uses the workers at a time.
+		if (pRayCastThreadPool == nullptr)
 		{
-			if (vRenderableAllComponents[i] == vIgnoreList[j])
-			{
-				pMeshPropsMtx->unlock();
-				continue;
-			}
+			pRayCastThreadPool = std::make_unique<SThreadPool>();
 		}
 
-		SVector vRayDirection = vRayStopPos - vRayStartPos;
-		float fRayLength = vRayDirection.length();
-		vRayDirection.normalizeVector();
+		iThreadCount = std::min<size_t>(pRayCastThreadPool->getWorkerCount() + 1, vRays.size() / iMinRaysPerThread);
+	}
 
-		DirectX::XMMATRIX mMeshWorld = DirectX::XMLoadFloat4x4(&vRenderableAllComponents[i]->renderData.vWorld);
-		auto det = XMMatrixDeterminant(mMeshWorld);
-		DirectX::XMMATRIX mInvMeshWorld = DirectX::XMMatrixInverse(&det, mMeshWorld);
+	if (iThreadCount <= 1)
+	{
+		rayCastBatchRange(vRays, vHitResults, vIgnoreList, 0, vRays.size());
+		return;
+	}
 
-		DirectX::XMVECTOR vRayOriginLocal
-			= DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(vRayStartPos.getX(), vRayStartPos.getY(), vRayStartPos.getZ(), 1.0f), mInvMeshWorld);
-		DirectX::XMVECTOR vRayDirectionLocal
-			= DirectX::XMVector3TransformNormal(DirectX::XMVectorSet(vRayDirection.getX(), vRayDirection.getY(), vRayDirection.getZ(), 0.0f), mInvMeshWorld);
+	// Ranges are a multiple of the packet size so that the packets are not split.
 
-		vRayDirectionLocal = DirectX::XMVector3Normalize(vRayDirectionLocal);
+	const size_t iPacketSize = SBoundingVolumeHierarchy::iRayPacketSize;
+	const size_t iPacketCount = (vRays.size() + iPacketSize - 1) / iPacketSize;
+	const size_t iRaysPerThread = ((iPacketCount + iThreadCount - 1) / iThreadCount) * iPacketSize;
 
-		float fHitDistance = 0.0f;
-		bool bHit = false;
-		if (vRenderableAllComponents[i]->collisionPreset == SCollisionPreset::SCP_SPHERE)
-		{
-			if (vRenderableAllComponents[i]->sphereCollision.Intersects(vRayOriginLocal, vRayDirectionLocal, fHitDistance))
-			{
-				bHit = true;
-			}
-		}
-		else
+	// mtxCollision is held by this thread so the tree and the components do not change while the workers are running.
+
+	pRayCastThreadPool->runJobs(iThreadCount, [&](size_t iJob)
+	{
+		const size_t iFirst = std::min<size_t>(iJob * iRaysPerThread, vRays.size());
+		const size_t iLast  = std::min<size_t>(iFirst + iRaysPerThread, vRays.size());
+
+		rayCastBatchRange(vRays, vHitResults, vIgnoreList, iFirst, iLast);
+	});
+}
+
+void SLevel::overlapBox(const DirectX::BoundingBox& box, std::vector<SComponent*>& vOverlappingComponents, const std::vector<SComponent*>& vIgnoreList)
+{
+	std::lock_guard<std::mutex> guard(mtxCollision);
+
+	updateCollisionBounds();
+
+	std::vector<uint32_t> vProxies;
+	renderRegistry.getBVH().overlap(box, vProxies);
+
+	for (size_t i = 0; i < vProxies.size(); i++)
+	{
+		SComponent* pComponent = renderRegistry.getBVHProxyComponent(vProxies[i]);
+
+		if (isComponentCollidable(pComponent) == false)
 		{
-			if (vRenderableAllComponents[i]->boxCollision.Intersects(vRayOriginLocal, vRayDirectionLocal, fHitDistance))
-			{
-				bHit = true;
-			}
+			continue;
 		}
 
-		if (bHit == false)
+		if (std::find(vIgnoreList.begin(), vIgnoreList.end(), pComponent) != vIgnoreList.end())
 		{
-			pMeshPropsMtx->unlock();
 			continue;
 		}
 
-		if (fHitDistance > fRayLength)
+		if (isBoxIntersectingComponent(box, DirectX::XMMatrixIdentity(), pComponent))
 		{
-			pMeshPropsMtx->unlock();
-			continue;
+			vOverlappingComponents.push_back(pComponent);
 		}
+	}
+}
+
+void SLevel::sweepBox(const DirectX::BoundingBox& box, const SVector& vSweepDirection, float fSweepDistance, std::vector<SSweepHit>& vHitResult,
+	const std::vector<SComponent*>& vIgnoreList)
+{
+	std::lock_guard<std::mutex> guard(mtxCollision);
 
-		bool bHitTriangle = false;
-		fHitDistance = FLT_MAX;
-		SVector vHitNormal;
+	updateCollisionBounds();
 
-		// Iterate over all trianges.
-		std::vector<uint32_t>* vIndices = pMeshData->getIndices32();
-		size_t iTrisCount = vIndices->size() / 3;
-		size_t vHitTriangle[3] = { 0 };
-		for (size_t i = 0; i < iTrisCount; i++)
+	SVector vDirection = vSweepDirection;
+	vDirection.normalizeVector();
+
+	const DirectX::XMFLOAT3 vDirectionFloat3(vDirection.getX(), vDirection.getY(), vDirection.getZ());
+
+	std::vector<uint32_t> vProxies;
+	renderRegistry.getBVH().sweep(box, vDirectionFloat3, fSweepDistance, vProxies);
+
+	for (size_t i = 0; i < vProxies.size(); i++)
+	{
+		SComponent* pComponent = renderRegistry.getBVHProxyComponent(vProxies[i]);
+
+		if (isComponentCollidable(pComponent) == false)
 		{
-			// Indices for this triangle.
-			UINT i0 = vIndices->operator[](i * 3 + 0);
-			UINT i1 = vIndices->operator[](i * 3 + 1);
-			UINT i2 = vIndices->operator[](i * 3 + 2);
-
-			// Vertices for this triangle.
-			DirectX::XMVECTOR v0 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i0).vPosition);
-			DirectX::XMVECTOR v1 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i1).vPosition);
-			DirectX::XMVECTOR v2 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i2).vPosition);
-
-			float fTriangleHitDistance = FLT_MAX;
-			if (DirectX::TriangleTests::Intersects(vRayOriginLocal, vRayDirectionLocal, v0, v1, v2, fTriangleHitDistance))
-			{
-				bHitTriangle = true;
-
-				if (fTriangleHitDistance < fHitDistance)
-				{
-					fHitDistance = fTriangleHitDistance;
-
-					vHitTriangle[0] = i0;
-					vHitTriangle[1] = i1;
-					vHitTriangle[2] = i2;
-
-					vHitNormal.setX(
-						(pMeshData->getVertices()->operator[](i0).getNormal().getX()
-							+ pMeshData->getVertices()->operator[](i1).getNormal().getX()
-							+ pMeshData->getVertices()->operator[](i2).getNormal().getX()) / 3.0f);
-					vHitNormal.setY(
-						(pMeshData->getVertices()->operator[](i0).getNormal().getY()
-							+ pMeshData->getVertices()->operator[](i1).getNormal().getY()
-							+ pMeshData->getVertices()->operator[](i2).getNormal().getY()) / 3.0f);
-					vHitNormal.setZ(
-						(pMeshData->getVertices()->operator[](i0).getNormal().getZ()
-							+ pMeshData->getVertices()->operator[](i1).getNormal().getZ()
-							+ pMeshData->getVertices()->operator[](i2).getNormal().getZ()) / 3.0f);
-				}
-			}
+			continue;
 		}
 
-		if (bHitTriangle)
+		if (std::find(vIgnoreList.begin(), vIgnoreList.end(), pComponent) != vIgnoreList.end())
 		{
-			SRayCastHit hitResult;
-			hitResult.pHitComponent = vRenderableAllComponents[i];
-			hitResult.fHitDistanceFromRayOrigin = fHitDistance;
-			hitResult.vHitNormal = vHitNormal;
+			continue;
+		}
+
+		// Moving box vs component bounds is the same as the ray from the box center vs the bounds expanded by the box extents.
+
+		DirectX::BoundingBox expandedBounds = renderRegistry.getBVH().getProxyBox(vProxies[i]);
+		expandedBounds.Extents.x += box.Extents.x;
+		expandedBounds.Extents.y += box.Extents.y;
+		expandedBounds.Extents.z += box.Extents.z;
 
-			hitResult.vHitTriangleIndices[0] = vHitTriangle[0];
-			hitResult.vHitTriangleIndices[1] = vHitTriangle[1];
-			hitResult.vHitTriangleIndices[2] = vHitTriangle[2];
+		SSweepHit hitResult;
+		hitResult.pHitComponent = pComponent;
 
+		if (SBoundingVolumeHierarchy::getRayHitDistance(expandedBounds, box.Center, vDirectionFloat3, fSweepDistance, hitResult.fHitDistance))
+		{
 			vHitResult.push_back(hitResult);
 		}
-
-		pMeshPropsMtx->unlock();
 	}
 
-	std::sort(vHitResult.begin(), vHitResult.end(), [](SRayCastHit a, SRayCastHit b) {return a.fHitDistanceFromRayOrigin < b.fHitDistanceFromRayOrigin; });
+	std::sort(vHitResult.begin(), vHitResult.end(), [](const SSweepHit& a, const SSweepHit& b) {return a.fHitDistance < b.fHitDistance; });
 }
 
 void SLevel::setEnableCollisionIntersectionTests(bool bEnable, SMeshComponent* pDynamicObject)
@@ -263,6 +252,20 @@ void SLevel::despawnContainerFromLevel(SContainer* pContainer)
 	pApp->despawnContainerFromLevel(pContainer);
 }
 
+void SLevel::spawnContainerInLevelDeferred(SContainer* pContainer)
+{
+	SApplication* pApp = this->pApp;
+
+	pApp->enqueueRenderCommand([pApp, pContainer]() { pApp->spawnContainerInLevel(pContainer); });
+}
+
+void SLevel::despawnContainerFromLevelDeferred(SContainer* pContainer)
+{
+	SApplication* pApp = this->pApp;
+
+	pApp->enqueueRenderCommand([pApp, pContainer]() { pApp->despawnContainerFromLevel(pContainer); });
+}
+
 DirectX::BoundingSphere* SLevel::getLevelBounds(bool bRecalculateLevelBounds)
 {
 	std::lock_guard<std::mutex> guard(pApp->mtxDraw);
@@ -277,39 +280,35 @@ DirectX::BoundingSphere* SLevel::getLevelBounds(bool bRecalculateLevelBounds)
 		return &levelBounds;
 	}
 
-	std::vector<SComponent*> vRenderableAllComponents = pApp->vAllRenderableSpawnedOpaqueComponents;
-	vRenderableAllComponents.insert(vRenderableAllComponents.end(), pApp->vAllRenderableSpawnedTransparentComponents.begin(), pApp->vAllRenderableSpawnedTransparentComponents.end());
+	const std::vector<SMeshComponent*>& vMeshComponents = renderRegistry.getMeshComponents();
 
 	DirectX::BoundingSphere levelBoundingSphere;
 
-	if (vRenderableAllComponents.size() > 0)
+	if (vMeshComponents.size() > 0)
 	{
 		bool bSphereValid = false;
 
-		for (size_t i = 0; i < vRenderableAllComponents.size(); i++)
+		for (size_t i = 0; i < vMeshComponents.size(); i++)
 		{
-			if (vRenderableAllComponents[i]->componentType == SComponentType::SCT_MESH)
+			SMeshComponent* pMesh = vMeshComponents[i];
+			if (pMesh->getCollisionPreset() == SCollisionPreset::SCP_NO_COLLISION)
 			{
-				SMeshComponent* pMesh = dynamic_cast<SMeshComponent*>(vRenderableAllComponents[i]);
-				if (pMesh->getCollisionPreset() == SCollisionPreset::SCP_NO_COLLISION)
-				{
-					continue;
-				}
-
-				if (pMesh->getCollisionPreset() != SCollisionPreset::SCP_SPHERE)
-				{
-					pMesh->updateSphereBounds();
-				}
-
-				if (bSphereValid == false)
-				{
-					levelBoundingSphere = pMesh->sphereCollision;
-					bSphereValid = true;
-				}
-				else
-				{
-					DirectX::BoundingSphere::CreateMerged(levelBoundingSphere, levelBoundingSphere, pMesh->sphereCollision);
-				}
+				continue;
+			}
+
+			if (pMesh->getCollisionPreset() != SCollisionPreset::SCP_SPHERE)
+			{
+				pMesh->updateSphereBounds();
+			}
+
+			if (bSphereValid == false)
+			{
+				levelBoundingSphere = pMesh->sphereCollision;
+				bSphereValid = true;
+			}
+			else
+			{
+				DirectX::BoundingSphere::CreateMerged(levelBoundingSphere, levelBoundingSphere, pMesh->sphereCollision);
 			}
 		}
 
@@ -333,77 +332,391 @@ std::vector<SContainer*>* SLevel::getNotRenderableContainers()
 
 bool SLevel::doCollisionIntersectionTests()
 {
-	std::lock_guard<std::mutex> guard(pApp->mtxDraw);
+	std::lock_guard<std::mutex> guard(mtxCollision);
 
-	std::vector<SComponent*> vRenderableAllComponents = pApp->vAllRenderableSpawnedOpaqueComponents;
-	vRenderableAllComponents.insert(vRenderableAllComponents.end(), pApp->vAllRenderableSpawnedTransparentComponents.begin(), pApp->vAllRenderableSpawnedTransparentComponents.end());
+	updateCollisionBounds();
 
-	for (size_t i = 0; i < vRenderableAllComponents.size(); i++)
+	SMeshComponent* pDynamicObject = dynamicObject.pDynamicObject;
+
+	if (pDynamicObject->iBVHProxyId == SBoundingVolumeHierarchy::iNoProxy)
 	{
-		if (vRenderableAllComponents[i] == dynamicObject.pDynamicObject)
+		return false; // not spawned
+	}
+
+	pDynamicObject->mtxWorldMatrixUpdate.lock();
+	DirectX::XMMATRIX dynamicObjectWorld = DirectX::XMLoadFloat4x4(&pDynamicObject->renderData.vWorld);
+	pDynamicObject->mtxWorldMatrixUpdate.unlock();
+
+	// Find components which world space bounds intersect with the dynamic object's world space bounds.
+
+	std::vector<uint32_t> vProxies;
+	renderRegistry.getBVH().overlap(renderRegistry.getBVH().getProxyBox(pDynamicObject->iBVHProxyId), vProxies);
+
+	for (size_t i = 0; i < vProxies.size(); i++)
+	{
+		SComponent* pComponent = renderRegistry.getBVHProxyComponent(vProxies[i]);
+
+		if (pComponent == pDynamicObject || pComponent->componentType != SComponentType::SCT_MESH)
 		{
 			continue;
 		}
 
+		if (isComponentCollidable(pComponent) == false)
+		{
+			continue;
+		}
+
+		if (isBoxIntersectingComponent(pDynamicObject->boxCollision, dynamicObjectWorld, pComponent))
+		{
+			// return dynamic object back to previous place.
+			pDynamicObject->setLocalLocation(dynamicObject.vLocalLocationLastPhysicsTick);
+			pDynamicObject->setLocalRotation(dynamicObject.vLocalRotationLastPhysicsTick);
+			pDynamicObject->setLocalScale(dynamicObject.vLocalScaleLastPhysicsTick);
+
+			return true;
+		}
+	}
+
+	pDynamicObject->mtxWorldMatrixUpdate.lock();
+	dynamicObject.vLocalLocationLastPhysicsTick = pDynamicObject->vLocation;
+	dynamicObject.vLocalRotationLastPhysicsTick = pDynamicObject->vRotation;
+	dynamicObject.vLocalScaleLastPhysicsTick = pDynamicObject->vScale;
+	pDynamicObject->mtxWorldMatrixUpdate.unlock();
+
+	return false;
+}
+
+void SLevel::updateCollisionBounds()
+{
+	transformSystem.updateWorldMatrices();
+
+	renderRegistry.updateDirtyBounds();
+}
+
+bool SLevel::isComponentCollidable(SComponent* pComponent)
+{
+	bool bVisible = pComponent->bVisible && pComponent->getContainer()->isVisible();
+
+	if (bVisible == false || (pComponent->pParentComponent && pComponent->pParentComponent->bVisible == false))
+	{
+		return false;
+	}
+
+	if (pComponent->componentType == SComponentType::SCT_MESH)
+	{
+		if (pComponent->renderData.primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST)
+		{
+			return false; // lines have no collision
+		}
+
+		if (static_cast<SMeshComponent*>(pComponent)->bUseInstancing)
+		{
+			return false;
+		}
+	}
 
-		// Check if no collision, not visible or something else...
+	return pComponent->collisionPreset != SCollisionPreset::SCP_NO_COLLISION;
+}
 
-		if (vRenderableAllComponents[i]->getComponentType() != SComponentType::SCT_MESH)
+bool SLevel::isComponentIgnored(SComponent* pComponent, const std::vector<SComponent*>& vIgnoreList)
+{
+	for (size_t i = 0; i < vIgnoreList.size(); i++)
+	{
+		if (pComponent == vIgnoreList[i])
 		{
-			continue;
+			return true;
 		}
+	}
+
+	return false;
+}
+
+void SLevel::rayCastBatchRange(const std::vector<SRay>& vRays, std::vector<std::vector<SRayCastHit>>& vHitResults,
+	const std::vector<SComponent*>& vIgnoreList, size_t iFirst, size_t iLast)
+{
+	const size_t iPacketSize = SBoundingVolumeHierarchy::iRayPacketSize;
+
+	std::vector<SVector> vRayDirections(iLast - iFirst);
+	std::vector<float>   vRayLengths(iLast - iFirst);
+
+	// Find components which world space bounds are hit by the rays (a packet of rays at a time).
 
-		SMeshComponent* pMesh = dynamic_cast<SMeshComponent*>(vRenderableAllComponents[i]);
-		bool bVisible = pMesh->isVisible() && pMesh->getContainer()->isVisible();
+	std::vector<std::pair<uint32_t, uint32_t>> vCandidates; // proxy, ray
+	std::vector<uint32_t> vPacketProxies[iPacketSize];
 
-		if (bVisible == false || (pMesh->pParentComponent && pMesh->pParentComponent->bVisible == false))
+	for (size_t iPacketStart = iFirst; iPacketStart < iLast; iPacketStart += iPacketSize)
+	{
+		const size_t iRayCount = std::min<size_t>(iPacketSize, iLast - iPacketStart);
+
+		DirectX::XMFLOAT3 vOrigins[iPacketSize];
+		DirectX::XMFLOAT3 vDirections[iPacketSize];
+		float vMaxDistances[iPacketSize];
+
+		for (size_t i = 0; i < iRayCount; i++)
 		{
-			continue;
+			const SRay& ray = vRays[iPacketStart + i];
+
+			SVector vRayStopPos = ray.vRayStopPos;
+			SVector vRayDirection = vRayStopPos - ray.vRayStartPos;
+			float fRayLength = vRayDirection.length();
+			vRayDirection.normalizeVector();
+
+			vRayDirections[iPacketStart + i - iFirst] = vRayDirection;
+			vRayLengths[iPacketStart + i - iFirst] = fRayLength;
+
+			vOrigins[i] = DirectX::XMFLOAT3(ray.vRayStartPos.getX(), ray.vRayStartPos.getY(), ray.vRayStartPos.getZ());
+			vDirections[i] = DirectX::XMFLOAT3(vRayDirection.getX(), vRayDirection.getY(), vRayDirection.getZ());
+			vMaxDistances[i] = fRayLength;
+
+			vPacketProxies[i].clear();
 		}
 
-		if (pMesh->renderData.primitiveTopologyType == D3D_PRIMITIVE_TOPOLOGY_LINELIST)
+		renderRegistry.getBVH().rayCastPacket(vOrigins, vDirections, vMaxDistances, iRayCount, vPacketProxies);
+
+		for (size_t i = 0; i < iRayCount; i++)
 		{
-			continue; // lines have no collision
+			for (size_t j = 0; j < vPacketProxies[i].size(); j++)
+			{
+				vCandidates.push_back(std::make_pair(vPacketProxies[i][j], static_cast<uint32_t>(iPacketStart + i)));
+			}
 		}
+	}
+
+	// Group the rays by component so that each component is checked, locked and inverted once for the whole batch.
+	// Rays get hits in the order of the proxy IDs (same as in rayCast()).
 
-		if (pMesh->getCollisionPreset() == SCollisionPreset::SCP_NO_COLLISION || pMesh->bUseInstancing)
+	std::sort(vCandidates.begin(), vCandidates.end());
+
+	for (size_t i = 0; i < vCandidates.size(); )
+	{
+		size_t iGroupEnd = i + 1;
+		while (iGroupEnd < vCandidates.size() && vCandidates[iGroupEnd].first == vCandidates[i].first)
 		{
-			continue;
+			iGroupEnd++;
 		}
 
+		SComponent* pComponent = renderRegistry.getBVHProxyComponent(vCandidates[i].first);
+
+		if (isComponentCollidable(pComponent) && isComponentIgnored(pComponent, vIgnoreList) == false)
+		{
+			pComponent->mtxComponentProps.lock();
+
+			const DirectX::XMMATRIX mInvMeshWorld = getInvWorldMatrix(pComponent);
+
+			for (size_t j = i; j < iGroupEnd; j++)
+			{
+				const size_t iRay = vCandidates[j].second;
+
+				rayCastComponent(pComponent, mInvMeshWorld, vRays[iRay].vRayStartPos, vRayDirections[iRay - iFirst], vRayLengths[iRay - iFirst],
+					vHitResults[iRay]);
+			}
 
+			pComponent->mtxComponentProps.unlock();
+		}
 
-		vRenderableAllComponents[i]->mtxWorldMatrixUpdate.lock();
-		DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&vRenderableAllComponents[i]->renderData.vWorld);
-		vRenderableAllComponents[i]->mtxWorldMatrixUpdate.unlock();
+		i = iGroupEnd;
+	}
 
-		DirectX::XMVECTOR worldDet = XMMatrixDeterminant(world);
-		DirectX::XMMATRIX invWorld = DirectX::XMMatrixInverse(&worldDet, world);
+	for (size_t i = iFirst; i < iLast; i++)
+	{
+		std::stable_sort(vHitResults[i].begin(), vHitResults[i].end(),
+			[](const SRayCastHit& a, const SRayCastHit& b) {return a.fHitDistanceFromRayOrigin < b.fHitDistanceFromRayOrigin; });
+	}
+}
 
+DirectX::XMMATRIX XM_CALLCONV SLevel::getInvWorldMatrix(SComponent* pComponent)
+{
+	DirectX::XMMATRIX mMeshWorld = DirectX::XMLoadFloat4x4(&pComponent->renderData.vWorld);
+	auto det = XMMatrixDeterminant(mMeshWorld);
 
-		DirectX::XMMATRIX toObjectLocal = XMMatrixMultiply(DirectX::XMLoadFloat4x4(&dynamicObject.pDynamicObject->renderData.vWorld), invWorld);
+	return DirectX::XMMatrixInverse(&det, mMeshWorld);
+}
 
+void SLevel::rayCastComponent(SComponent* pComponent, const DirectX::XMMATRIX& mInvMeshWorld, const SVector& vRayStartPos,
+	const SVector& vRayDirection, float fRayLength, std::vector<SRayCastHit>& vHitResult)
+{
+	SMeshData* pMeshData = &pComponent->meshData;
+
+	DirectX::XMVECTOR vRayOriginLocal
+		= DirectX::XMVector3TransformCoord(DirectX::XMVectorSet(vRayStartPos.getX(), vRayStartPos.getY(), vRayStartPos.getZ(), 1.0f), mInvMeshWorld);
+	DirectX::XMVECTOR vRayDirectionLocal
+		= DirectX::XMVector3TransformNormal(DirectX::XMVectorSet(vRayDirection.getX(), vRayDirection.getY(), vRayDirection.getZ(), 0.0f), mInvMeshWorld);
 
-		DirectX::BoundingBox localSpaceBox;
-		dynamicObject.pDynamicObject->boxCollision.Transform(localSpaceBox, toObjectLocal);
+	vRayDirectionLocal = DirectX::XMVector3Normalize(vRayDirectionLocal);
 
-		// Perform the box/box intersection test in local space.
-		if (localSpaceBox.Contains(vRenderableAllComponents[i]->boxCollision) != DirectX::DISJOINT)
+	float fHitDistance = 0.0f;
+	bool bHit = false;
+	if (pComponent->collisionPreset == SCollisionPreset::SCP_SPHERE)
+	{
+		if (pComponent->sphereCollision.Intersects(vRayOriginLocal, vRayDirectionLocal, fHitDistance))
 		{
-			// return dynamic object back to previous place.
-			dynamicObject.pDynamicObject->setLocalLocation(dynamicObject.vLocalLocationLastPhysicsTick);
-			dynamicObject.pDynamicObject->setLocalRotation(dynamicObject.vLocalRotationLastPhysicsTick);
-			dynamicObject.pDynamicObject->setLocalScale(dynamicObject.vLocalScaleLastPhysicsTick);
+			bHit = true;
+		}
+	}
+	else
+	{
+		if (pComponent->boxCollision.Intersects(vRayOriginLocal, vRayDirectionLocal, fHitDistance))
+		{
+			bHit = true;
+		}
+	}
 
-			return true;
+	if (bHit == false)
+	{
+		return;
+	}
+
+	if (fHitDistance > fRayLength)
+	{
+		return;
+	}
+
+	bool bHitTriangle = false;
+	fHitDistance = FLT_MAX;
+	SVector vHitNormal;
+
+	std::vector<uint32_t>* vIndices = pMeshData->getIndices32();
+	size_t iTrisCount = vIndices->size() / 3;
+
+	// Big meshes only test triangles which bounds are hit by the ray.
+	SBoundingVolumeHierarchy* pTriangleBVH = getTriangleBVH(pComponent);
+	std::vector<uint32_t> vTriangles;
+
+	if (pTriangleBVH)
+	{
+		DirectX::XMFLOAT3 vOrigin;
+		DirectX::XMFLOAT3 vDirection;
+		DirectX::XMStoreFloat3(&vOrigin, vRayOriginLocal);
+		DirectX::XMStoreFloat3(&vDirection, vRayDirectionLocal);
+
+		pTriangleBVH->rayCast(vOrigin, vDirection, FLT_MAX, vTriangles);
+
+		// Test in the same order as without the BVH (the first triangle wins if the distance is equal).
+		std::sort(vTriangles.begin(), vTriangles.end());
+
+		iTrisCount = vTriangles.size();
+	}
+
+	// Iterate over all trianges.
+	size_t vHitTriangle[3] = { 0 };
+	for (size_t j = 0; j < iTrisCount; j++)
+	{
+		size_t i = pTriangleBVH ? vTriangles[j] : j;
+
+		// Indices for this triangle.
+		UINT i0 = vIndices->operator[](i * 3 + 0);
+		UINT i1 = vIndices->operator[](i * 3 + 1);
+		UINT i2 = vIndices->operator[](i * 3 + 2);
+
+		// Vertices for this triangle.
+		DirectX::XMVECTOR v0 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i0).vPosition);
+		DirectX::XMVECTOR v1 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i1).vPosition);
+		DirectX::XMVECTOR v2 = DirectX::XMLoadFloat3(&pMeshData->getVertices()->operator[](i2).vPosition);
+
+		float fTriangleHitDistance = FLT_MAX;
+		if (DirectX::TriangleTests::Intersects(vRayOriginLocal, vRayDirectionLocal, v0, v1, v2, fTriangleHitDistance))
+		{
+			bHitTriangle = true;
+
+			if (fTriangleHitDistance < fHitDistance)
+			{
+				fHitDistance = fTriangleHitDistance;
+
+				vHitTriangle[0] = i0;
+				vHitTriangle[1] = i1;
+				vHitTriangle[2] = i2;
+
+				vHitNormal.setX(
+					(pMeshData->getVertices()->operator[](i0).getNormal().getX()
+						+ pMeshData->getVertices()->operator[](i1).getNormal().getX()
+						+ pMeshData->getVertices()->operator[](i2).getNormal().getX()) / 3.0f);
+				vHitNormal.setY(
+					(pMeshData->getVertices()->operator[](i0).getNormal().getY()
+						+ pMeshData->getVertices()->operator[](i1).getNormal().getY()
+						+ pMeshData->getVertices()->operator[](i2).getNormal().getY()) / 3.0f);
+				vHitNormal.setZ(
+					(pMeshData->getVertices()->operator[](i0).getNormal().getZ()
+						+ pMeshData->getVertices()->operator[](i1).getNormal().getZ()
+						+ pMeshData->getVertices()->operator[](i2).getNormal().getZ()) / 3.0f);
+			}
 		}
 	}
 
-	dynamicObject.pDynamicObject->mtxWorldMatrixUpdate.lock();
-	dynamicObject.vLocalLocationLastPhysicsTick = dynamicObject.pDynamicObject->vLocation;
-	dynamicObject.vLocalRotationLastPhysicsTick = dynamicObject.pDynamicObject->vRotation;
-	dynamicObject.vLocalScaleLastPhysicsTick = dynamicObject.pDynamicObject->vScale;
-	dynamicObject.pDynamicObject->mtxWorldMatrixUpdate.unlock();
+	if (bHitTriangle)
+	{
+		SRayCastHit hitResult;
+		hitResult.pHitComponent = pComponent;
+		hitResult.fHitDistanceFromRayOrigin = fHitDistance;
+		hitResult.vHitNormal = vHitNormal;
 
-	return false;
+		hitResult.vHitTriangleIndices[0] = vHitTriangle[0];
+		hitResult.vHitTriangleIndices[1] = vHitTriangle[1];
+		hitResult.vHitTriangleIndices[2] = vHitTriangle[2];
+
+		vHitResult.push_back(hitResult);
+	}
+}
+
+bool SLevel::isBoxIntersectingComponent(const DirectX::BoundingBox& box, DirectX::FXMMATRIX boxWorld, SComponent* pComponent)
+{
+	pComponent->mtxWorldMatrixUpdate.lock();
+	DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&pComponent->renderData.vWorld);
+	pComponent->mtxWorldMatrixUpdate.unlock();
+
+	DirectX::XMVECTOR worldDet = XMMatrixDeterminant(world);
+	DirectX::XMMATRIX invWorld = DirectX::XMMatrixInverse(&worldDet, world);
+
+
+	DirectX::XMMATRIX toObjectLocal = XMMatrixMultiply(boxWorld, invWorld);
+
+
+	DirectX::BoundingBox localSpaceBox;
+	box.Transform(localSpaceBox, toObjectLocal);
+
+	// Perform the box/box intersection test in local space.
+	return localSpaceBox.Contains(pComponent->boxCollision) != DirectX::DISJOINT;
+}
+
+SBoundingVolumeHierarchy* SLevel::getTriangleBVH(SComponent* pComponent)
+{
+	std::vector<uint32_t>* pIndices = pComponent->meshData.getIndices32();
+	std::vector<SMeshVertex>* pVertices = pComponent->meshData.getVertices();
+
+	const size_t iTriangleCount = pIndices->size() / 3;
+
+	if (iTriangleCount < iMinTrianglesForBVH)
+	{
+		return nullptr;
+	}
+
+	if (pComponent->pTriangleBVH)
+	{
+		return pComponent->pTriangleBVH;
+	}
+
+
+	std::vector<DirectX::BoundingBox> vTriangleBoxes(iTriangleCount);
+
+	for (size_t i = 0; i < iTriangleCount; i++)
+	{
+		DirectX::XMVECTOR v0 = DirectX::XMLoadFloat3(&pVertices->operator[](pIndices->operator[](i * 3 + 0)).vPosition);
+		DirectX::XMVECTOR v1 = DirectX::XMLoadFloat3(&pVertices->operator[](pIndices->operator[](i * 3 + 1)).vPosition);
+		DirectX::XMVECTOR v2 = DirectX::XMLoadFloat3(&pVertices->operator[](pIndices->operator[](i * 3 + 2)).vPosition);
+
+		DirectX::XMVECTOR vMin = DirectX::XMVectorMin(DirectX::XMVectorMin(v0, v1), v2);
+		DirectX::XMVECTOR vMax = DirectX::XMVectorMax(DirectX::XMVectorMax(v0, v1), v2);
+
+		DirectX::BoundingBox::CreateFromPoints(vTriangleBoxes[i], vMin, vMax);
+
+		// Flat triangles have zero thickness, add a little bit so that the box is not missed because of the float precision.
+		const float fPadding = 1e-4f * (1.0f + std::max<float>(vTriangleBoxes[i].Extents.x, std::max<float>(vTriangleBoxes[i].Extents.y, vTriangleBoxes[i].Extents.z)));
+		vTriangleBoxes[i].Extents.x += fPadding;
+		vTriangleBoxes[i].Extents.y += fPadding;
+		vTriangleBoxes[i].Extents.z += fPadding;
+	}
+
+	pComponent->pTriangleBVH = new SBoundingVolumeHierarchy();
+	pComponent->pTriangleBVH->build(vTriangleBoxes);
+
+	return pComponent->pTriangleBVH;
 }
@@ -10,12 +10,16 @@
 // STL
 #include <vector>
 #include <mutex>
+#include <memory>
 
 // DirectX
 #include <DirectXCollision.h>
 
 // Custom
 #include "SilentEngine/Public/SVector/SVector.h"
+#include "SilentEngine/Private/STransformSystem/STransformSystem.h"
+#include "SilentEngine/Private/SRenderRegistry/SRenderRegistry.h"
+#include "SilentEngine/Private/SThreadPool/SThreadPool.h"
 
 class SApplication;
 class SContainer;
@@ -31,6 +35,20 @@ public:
 	size_t vHitTriangleIndices[3]; // indices of hit triangle, use pMeshData->getVertices() with those indices to get triangle
 };
 
+class SRay
+{
+public:
+	SVector vRayStartPos;
+	SVector vRayStopPos;
+};
+
+class SSweepHit
+{
+public:
+	SComponent* pHitComponent;
+	float fHitDistance; // distance that the box can move along the sweep direction before touching the component's bounds
+};
+
 class SCollisionTestsDynamicObject
 {
 public:
@@ -63,9 +81,51 @@ public:
 		* param "vHitResult": objects that were hit by the ray, use SComponent::getComponentType() to cast to correct type.
 		* param "vIgnoreList": (optional) list of component that will be ignored in this ray cast.
 		* remarks: instanced mesh components are currently ignored (TODO).
+		Only components which world space bounds are hit by the ray (found using the level BVH) are tested,
+		meshes with many triangles use a BVH of triangles.
 		*/
 		void rayCast(SVector& vRayStartPos, SVector& vRayStopPos, std::vector<SRayCastHit>& vHitResult, const std::vector<SComponent*>& vIgnoreList = std::vector<SComponent*>());
 
+		//@@Function
+		/*
+		* desc: same as rayCast() but for many rays at once, the level is locked and updated once for the whole batch.
+		* param "vRays": rays to emit.
+		* param "vHitResults": hits of each ray (same as rayCast() would return for this ray), resized to the number of rays.
+		* param "vIgnoreList": (optional) list of component that will be ignored in this ray cast.
+		* param "bUseMultipleThreads": (optional) split big batches between the worker threads of the level (started on the first such batch
+		and reused by the next batches).
+		* remarks: rays are tested against the level BVH in packets (works best if the rays go in similar directions) and
+		the world matrix of each component is inverted once for all rays that hit it.
+		*/
+		void rayCastBatch(const std::vector<SRay>& vRays, std::vector<std::vector<SRayCastHit>>& vHitResults,
+			const std::vector<SComponent*>& vIgnoreList = std::vector<SComponent*>(), bool bUseMultipleThreads = false);
+
+		//@@Function
+		/*
+		* desc: used to find components with collision that intersect with the box.
+		* param "box": world space box.
+		* param "vOverlappingComponents": components that intersect with the box (in no particular order).
+		* param "vIgnoreList": (optional) list of component that will be ignored in this query.
+		* remarks: the box is tested against the collision box of each component (in the component's local space),
+		instanced mesh components are ignored.
+		*/
+		void overlapBox(const DirectX::BoundingBox& box, std::vector<SComponent*>& vOverlappingComponents,
+			const std::vector<SComponent*>& vIgnoreList = std::vector<SComponent*>());
+
+		//@@Function
+		/*
+		* desc: used to find components with collision that will be hit by the box if the box is moved along the direction.
+		* param "box": world space box at the start of the movement.
+		* param "vSweepDirection": direction of the movement.
+		* param "fSweepDistance": length of the movement.
+		* param "vHitResult": components that were hit sorted by the hit distance.
+		* param "vIgnoreList": (optional) list of component that will be ignored in this query.
+		* remarks: the box is tested against world space bounding boxes of the components,
+		instanced mesh components are ignored.
+		*/
+		void sweepBox(const DirectX::BoundingBox& box, const SVector& vSweepDirection, float fSweepDistance, std::vector<SSweepHit>& vHitResult,
+			const std::vector<SComponent*>& vIgnoreList = std::vector<SComponent*>());
+
 
 	// Set functions
 
@@ -99,6 +159,23 @@ public:
 		*/
 		void despawnContainerFromLevel      (SContainer* pContainer);
 
+		//@@Function
+		/*
+		* desc: spawns the container in level at the start of the next frame (see SApplication::enqueueRenderCommand()).
+		* param "pContainer": the pointer to a container that you want to spawn.
+		* remarks: this function is thread-safe and lock-free, unlike spawnContainerInLevel() it does not wait for the current
+		frame to be drawn so use it in onPhysicsTick(). Errors are shown when the container is spawned.
+		*/
+		void spawnContainerInLevelDeferred  (SContainer* pContainer);
+
+		//@@Function
+		/*
+		* desc: despawns the container from level at the start of the next frame (see SApplication::enqueueRenderCommand()).
+		* param "pContainer": the pointer to a container that you want to despawn.
+		* remarks: this function is thread-safe and lock-free, the container should not be deleted until the next frame is started.
+		*/
+		void despawnContainerFromLevelDeferred(SContainer* pContainer);
+
 
 	// Get functions
 
@@ -133,6 +210,56 @@ private:
 	// return value can be ignored
 	bool doCollisionIntersectionTests();
 
+	//@@Function
+	/*
+	* desc: updates world matrices and world space bounds of the changed components, should be called before collision queries.
+	* remarks: expects mtxCollision to be locked.
+	*/
+	void updateCollisionBounds();
+	//@@Function
+	/*
+	* desc: returns true if the component is visible and has collision (not instanced, not lines).
+	*/
+	bool isComponentCollidable(SComponent* pComponent);
+	//@@Function
+	/*
+	* desc: returns true if the component is in the ignore list.
+	*/
+	bool isComponentIgnored(SComponent* pComponent, const std::vector<SComponent*>& vIgnoreList);
+	//@@Function
+	/*
+	* desc: ray casts rays in range [iFirst, iLast) of rayCastBatch(), can be called from multiple threads for different ranges.
+	* remarks: expects mtxCollision to be locked and the collision bounds to be updated.
+	*/
+	void rayCastBatchRange(const std::vector<SRay>& vRays, std::vector<std::vector<SRayCastHit>>& vHitResults,
+		const std::vector<SComponent*>& vIgnoreList, size_t iFirst, size_t iLast);
+	//@@Function
+	/*
+	* desc: returns the inverse of the component's world matrix.
+	* remarks: expects the component's mtxComponentProps to be locked.
+	*/
+	DirectX::XMMATRIX XM_CALLCONV getInvWorldMatrix(SComponent* pComponent);
+	//@@Function
+	/*
+	* desc: tests the ray against the collision and the triangles of the component, adds the hit to vHitResult.
+	* param "mInvMeshWorld": inverse world matrix of the component (see getInvWorldMatrix()).
+	* param "vRayDirection": normalized direction of the ray.
+	* remarks: expects the component's mtxComponentProps to be locked.
+	*/
+	void rayCastComponent(SComponent* pComponent, const DirectX::XMMATRIX& mInvMeshWorld, const SVector& vRayStartPos,
+		const SVector& vRayDirection, float fRayLength, std::vector<SRayCastHit>& vHitResult);
+	//@@Function
+	/*
+	* desc: returns true if the box (with the specified world matrix) intersects with the collision box of the component.
+	*/
+	bool isBoxIntersectingComponent(const DirectX::BoundingBox& box, DirectX::FXMMATRIX boxWorld, SComponent* pComponent);
+	//@@Function
+	/*
+	* desc: returns BVH of the mesh triangles (builds it if needed) or nullptr if the mesh has few triangles.
+	* remarks: expects the component's mtxComponentProps to be locked.
+	*/
+	SBoundingVolumeHierarchy* getTriangleBVH(SComponent* pComponent);
+
 	friend class SApplication;
 
 	//@@Variable
@@ -152,15 +279,37 @@ private:
 	std::vector<class SLightComponent*> vSpawnedLightComponents;
 
 
+	//@@Variable
+	/* local/world transforms of all spawned containers and their components. */
+	STransformSystem transformSystem;
+	//@@Variable
+	/* dense lists of all spawned mesh and runtime mesh components. */
+	SRenderRegistry renderRegistry;
+
+	//@@Variable
+	/* guards the world space bounds and the BVH of the render registry, collision queries use it instead of
+	SApplication::mtxDraw so that they don't wait for the frame to be drawn. Lock order: mtxDraw, then mtxCollision. */
+	std::mutex mtxCollision;
+
+
 	std::mutex mtxLevelBounds;
 	DirectX::BoundingSphere levelBounds;
 
 
 	SCollisionTestsDynamicObject dynamicObject;
 
+
+	// Meshes with fewer triangles are tested without the BVH of triangles.
+	static constexpr size_t iMinTrianglesForBVH = 32;
+
+	// rayCastBatch() does not use more threads than (number of rays / this value).
+	static constexpr size_t iMinRaysPerThread = 256;
+
+	// Workers of rayCastBatch(), started on the first batch that is split between threads.
+	std::unique_ptr<SThreadPool> pRayCastThreadPool;
+
 	
 	bool bLevelBoundsCalculated;
 	bool bEnableIntersectionTests;
-	bool bInCollisionIntersectionTests;
 };
 
@@ -23,6 +23,8 @@ SMaterial::SMaterial()
 
 	iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
 
+	pDirtyQueue = nullptr;
+
 	vMatTransform = SMath::getIdentityMatrix4x4();
 
 	vMatUVOffset = SVector(1.0f, 1.0f, 1.0f);
@@ -58,6 +60,8 @@ SMaterial& SMaterial::operator=(const SMaterial& mat)
 
 	vMatTransform = mat.vMatTransform;
 
+	markDirty();
+
 	mtxUpdateMat.unlock();
 
 	return *this;
@@ -71,7 +75,7 @@ void SMaterial::setMaterialProperties(const SMaterialProperties& matProps)
 
 		this->matProps = matProps;
 
-		iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		markDirty();
 
 		mtxUpdateMat.unlock();
 	}
@@ -97,7 +101,7 @@ bool SMaterial::setMaterialUVOffset(const SVector& vMaterialUVOffset)
 
 		updateMatTransform();
 
-		iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		markDirty();
 
 		mtxUpdateMat.unlock();
 
@@ -117,7 +121,7 @@ void SMaterial::setMaterialUVScale(const SVector& vMaterialUVScale)
 
 		updateMatTransform();
 
-		iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		markDirty();
 
 		mtxUpdateMat.unlock();
 	}
@@ -133,7 +137,7 @@ void SMaterial::setMaterialUVRotation(float fRotation)
 
 		updateMatTransform();
 
-		iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+		markDirty();
 
 		mtxUpdateMat.unlock();
 	}
@@ -204,6 +208,16 @@ void SMaterial::updateMatTransform()
 	DirectX::XMStoreFloat4x4(&vMatTransform, transform);
 }
 
+void SMaterial::markDirty()
+{
+	iUpdateCBInFrameResourceCount = SFRAME_RES_COUNT;
+
+	if (pDirtyQueue)
+	{
+		pDirtyQueue->push(this);
+	}
+}
+
 void SMaterialProperties::setCustomTransparency(float fCustomTransparency)
 {
 	this->fCustomTransparency = SMath::clamp(fCustomTransparency, 0.0f, 1.0f);
@@ -343,3 +357,33 @@ unsigned long long STextureHandle::getTextureSizeInBytesOnGPU() const
 		return 0;
 	}
 }
+
+size_t STextureHandle::getResidentMipCount() const
+{
+	if (pRefToTexture == nullptr || pRefToTexture->loadState != STextureLoadState::STLS_RESIDENT)
+	{
+		return 0;
+	}
+
+	if (pRefToTexture->iResidencyId == SIZE_MAX)
+	{
+		// Not streamed, the resource is never replaced.
+		return pRefToTexture->pResource->GetDesc().MipLevels;
+	}
+	else
+	{
+		return pRefToTexture->ddsDesc.iMipCount - pRefToTexture->iResidentMip;
+	}
+}
+
+STextureLoadState STextureHandle::getLoadState() const
+{
+	if (pRefToTexture)
+	{
+		return pRefToTexture->loadState;
+	}
+	else
+	{
+		return STextureLoadState::STLS_FAILED;
+	}
+}
@@ -10,9 +10,13 @@
 // STL
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <cstdint>
 
 // Custom
 #include "SilentEngine/Public/SVector/SVector.h"
+#include "SilentEngine/Private/SDirtyQueue/SDirtyQueue.h"
+#include "SilentEngine/Private/SDDSTexture/SDDSTexture.h"
 
 // DirectX
 #include <DirectXMath.h>
@@ -21,6 +25,13 @@
 
 class STextureInternal;
 
+enum class STextureLoadState
+{
+	STLS_LOADING,
+	STLS_RESIDENT,
+	STLS_FAILED
+};
+
 struct STextureHandle
 {
 	//@@Function
@@ -42,6 +53,23 @@ struct STextureHandle
 	*/
 	unsigned long long getTextureSizeInBytesOnGPU() const;
 
+	//@@Function
+	/*
+	* desc: returns the number of mips of the texture that are stored in the GPU memory (the least detailed mips are always stored,
+	more detailed mips are streamed in when the texture is used and evicted when the texture memory budget is exceeded,
+	see SApplication::setTextureMemoryBudget()).
+	* remarks: returns 0 if the texture is not resident.
+	*/
+	size_t getResidentMipCount() const;
+
+	//@@Function
+	/*
+	* desc: returns STLS_RESIDENT if the texture can be used for rendering.
+	* remarks: textures loaded via SApplication::loadTextureFromDiskToGPUAsync() are STLS_LOADING until their upload is finished
+	(a placeholder texture is used for rendering until then), returns STLS_FAILED if the handle is not valid.
+	*/
+	STextureLoadState getLoadState() const;
+
 private:
 
 	friend class SApplication;
@@ -67,9 +95,20 @@ public:
 	Microsoft::WRL::ComPtr<ID3D12Resource> pResource = nullptr;
 	Microsoft::WRL::ComPtr<ID3D12Resource> pUploadHeap = nullptr;
 
-	int iTexSRVHeapIndex = -1;
+	int iTexSRVHeapIndex = -1;                    // first of the two SRVs of the texture
+	int iActiveSRV = 0;                           // 0 or 1, the SRV (after iTexSRVHeapIndex) that references pResource
+	unsigned long long iInactiveSRVFence = 0;     // the inactive SRV can be rewritten once the GPU reaches this fence
 
 	bool bIsCubeMap = false;
+
+	std::atomic<STextureLoadState> loadState{STextureLoadState::STLS_RESIDENT};
+
+	// Mip streaming.
+	SDDSTextureDesc ddsDesc;               // filled on the first load (iWidth is 0 before that)
+	size_t iMinResidentMip  = 0;           // mips starting from this one are never evicted
+	size_t iLoadMip         = 0;           // most detailed mip that STextureLoader will load, SIZE_MAX to load only [iMinResidentMip, mip count)
+	size_t iResidentMip     = 0;           // most detailed mip of the file that pResource has
+	size_t iResidencyId     = SIZE_MAX;    // ID in the STextureResidencyManager, SIZE_MAX if not managed
 };
 
 //@@Class
@@ -247,6 +286,7 @@ private:
 	friend class SMeshComponent;
 	friend class SRuntimeMeshComponent;
 	friend class SMeshData;
+	template<typename T> friend class SDirtyQueue;
 
 
 	// Only SApplication can create instances of SMaterial.
@@ -267,6 +307,13 @@ private:
 
 
 	void updateMatTransform();
+	//@@Function
+	/*
+	* desc: sets the iUpdateCBInFrameResourceCount to SFRAME_RES_COUNT and pushes this material to the dirty queue (if registered)
+	so that its constant buffer will be updated in the next frames.
+	* remarks: expects mtxUpdateMat to be locked.
+	*/
+	void markDirty();
 
 
 	std::mutex mtxUpdateMat;
@@ -279,6 +326,11 @@ private:
 	int iUpdateCBInFrameResourceCount;
 
 
+	// not nullptr only while registered (not used for materials in bundles)
+	SDirtyQueue<SMaterial>* pDirtyQueue;
+	SDirtyQueueNode<SMaterial> dirtyQueueNode;
+
+
 	SMaterialProperties matProps;
 
 
@@ -159,6 +159,8 @@ private:
 	friend class SPrimitiveShapeGenerator;
 	friend class SComponent;
 	friend class SLevel;
+	friend class SFormatOBJImporter;
+	friend class SFormatCookedMesh;
 
 	DirectX::XMFLOAT3 vPosition;
 	DirectX::XMFLOAT3 vNormal;
@@ -420,6 +422,8 @@ private:
 	friend class SRuntimeMeshComponent;
 	friend class SContainer;
 	friend class SComponent;
+	friend class SFormatOBJImporter;
+	friend class SFormatCookedMesh;
 
 	// nullptr or registered original material
 	SMaterial* pMeshMaterial = nullptr;
@@ -165,6 +165,16 @@ bool SProfiler::getLastFrameDrawCallCount(unsigned long long* iDrawCallCount) co
 	return pApp->getLastFrameDrawCallCount(iDrawCallCount);
 }
 
+size_t SProfiler::getLastFrameDirtyObjectCBCount() const
+{
+	return iLastFrameDirtyObjectCBCount;
+}
+
+size_t SProfiler::getLastFrameDirtyMaterialCount() const
+{
+	return iLastFrameDirtyMaterialCount;
+}
+
 bool SProfiler::getVideoMemoryUsageInBytesOfCurrentDisplayAdapter(unsigned long long* pSizeInBytes)
 {
 	return pApp->getVideoMemoryUsageInBytesOfCurrentDisplayAdapter(pSizeInBytes);
@@ -131,6 +131,19 @@ public:
 	bool   getLastFrameDrawCallCount                         (unsigned long long* iDrawCallCount) const;
 	//@@Function
 	/*
+	* desc: returns the number of mesh components whose constant buffer was updated (or waited for the update) in the last frame.
+	* remarks: only changed (moved, new custom shader property, etc.) components are updated so this value does not depend on the
+	number of spawned components. A changed component stays in this number for SFRAME_RES_COUNT frames (once per frame resource).
+	*/
+	size_t getLastFrameDirtyObjectCBCount                    () const;
+	//@@Function
+	/*
+	* desc: returns the number of registered materials whose constant buffer was updated (or waited for the update) in the last frame.
+	* remarks: see getLastFrameDirtyObjectCBCount().
+	*/
+	size_t getLastFrameDirtyMaterialCount                    () const;
+	//@@Function
+	/*
 	* desc: returns currently used memory space (i.e. how much of the VRAM is used) of the display adapter (i.e. "video card").
 	* param "pSizeInBytes": pointer to your unsigned long long value which will be used to set the memory value.
 	* return: false if successful, true otherwise.
@@ -165,6 +178,9 @@ private:
 
 	float fTimeSpentWaitingForGPUBetweenFramesInMS = 0.0f;
 
+	size_t iLastFrameDirtyObjectCBCount = 0;
+	size_t iLastFrameDirtyMaterialCount = 0;
+
 	//@@Variable
 	/* pointer to the SApplication which will be profiled. */
 	SApplication* pApp;
@@ -9,6 +9,7 @@
 
 #define SLEEP_BETWEEN_TESTS_MS 200
 
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include "Catch2/catch.hpp"
 
 #include <thread>
@@ -7,6 +7,10 @@
 
 #include "Common.h"
 
+// STL
+#include <fstream>
+#include <filesystem>
+
 TEST_CASE("Initialize and run the engine with default settings.", "[MainTests::initAndRun]") {
 	EditorApplication app(GetModuleHandle(NULL));
 
@@ -209,6 +213,245 @@ TEST_CASE("Load/unload textures.", "[MainTests::loadUnloadTextures]") {
 	REQUIRE(true);
 }
 
+TEST_CASE("Load textures asynchronously while rendering.", "[MainTests::loadTexturesAsync]") {
+	EditorApplication app(GetModuleHandle(NULL));
+
+	std::promise<bool> promiseReady;
+	std::promise<bool> promiseFinishRun;
+	std::future<bool> futureFinishRun = promiseFinishRun.get_future();
+	std::future<bool> futureReady = promiseReady.get_future();
+
+	std::thread t([&app, &promiseReady, &promiseFinishRun]() {
+		//app.initCompileShadersInRelease();  // uncomment for more fps in debug build
+		//app.initDisableD3DDebugLayer(); // not recommended, but uncomment for more fps in debug build
+		std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_BETWEEN_TESTS_MS));
+		if (app.init(L"MainWindow_" + std::to_wstring(time(0)), true))
+		{
+			promiseReady.set_value(true);
+			promiseFinishRun.set_value(true);
+			//REQUIRE(false);
+			return;
+		}
+		app.getVideoSettings()->setFPSLimit(120.0f);
+		promiseReady.set_value(false);
+		app.run();
+		promiseFinishRun.set_value(false);
+		});
+	t.detach();
+
+	bool bError = futureReady.get();
+	if (bError)
+	{
+		REQUIRE(false); // init failed
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	app.hideWindow(); // hide for testing
+
+
+	// --------------------------------------------------
+
+	// Request textures (like a loading screen would do).
+
+	const std::wstring sTex = L"assets/tex.dds";
+	const size_t iTextureCount = 300;
+
+	std::vector<STextureHandle> vTextures;
+
+	std::chrono::time_point<std::chrono::steady_clock> timeStart = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < iTextureCount; i++)
+	{
+		bError = false;
+		vTextures.push_back(app.loadTextureFromDiskToGPUAsync("tex" + std::to_string(i), sTex, false, bError));
+		if (bError)
+		{
+			REQUIRE(false);
+		}
+	}
+
+	long long iRequestTimeInMS = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - timeStart).count();
+
+	REQUIRE(app.getLoadedTextures().size() == iTextureCount);
+
+	// Not unique name.
+	app.loadTextureFromDiskToGPUAsync("tex0", sTex, false, bError);
+	REQUIRE(bError);
+
+
+	// Wait for the textures while the frames are rendered.
+
+	float fMaxFrameTimeInMS = 0.0f;
+	bool bAllResident = false;
+
+	while (std::chrono::steady_clock::now() - timeStart < std::chrono::seconds(60))
+	{
+		float fFrameTimeInMS = 0.0f;
+		app.getProfiler()->getTimeToRenderFrame(&fFrameTimeInMS);
+		fMaxFrameTimeInMS = std::max<float>(fMaxFrameTimeInMS, fFrameTimeInMS);
+
+		bAllResident = true;
+
+		for (size_t i = 0; i < vTextures.size(); i++)
+		{
+			REQUIRE(vTextures[i].getLoadState() != STextureLoadState::STLS_FAILED);
+
+			if (vTextures[i].getLoadState() != STextureLoadState::STLS_RESIDENT)
+			{
+				bAllResident = false;
+			}
+		}
+
+		if (bAllResident)
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	std::chrono::time_point<std::chrono::steady_clock> timeEnd = std::chrono::steady_clock::now();
+
+	WARN("requested " << iTextureCount << " textures in " << iRequestTimeInMS << " ms, all resident after "
+		<< std::chrono::duration_cast<std::chrono::milliseconds>(timeEnd - timeStart).count() << " ms, max frame time: " << fMaxFrameTimeInMS << " ms");
+
+	REQUIRE(bAllResident);
+	REQUIRE(vTextures[0].getTextureSizeInBytesOnGPU() > 0);
+
+	// Loading these textures synchronously stops the rendering for seconds.
+	REQUIRE(fMaxFrameTimeInMS < 100.0f);
+
+
+	// Unload textures.
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		if (app.unloadTextureFromGPU(vTextures[i]))
+		{
+			REQUIRE(false);
+		}
+	}
+
+	REQUIRE(app.getLoadedTextures().size() == 0);
+
+	// --------------------------------------------------
+
+	PostMessage(app.getMainWindowHandle(), WM_QUIT, 0, 0);
+
+	futureFinishRun.get();
+
+	REQUIRE(true);
+}
+
+TEST_CASE("Asynchronous loading of a corrupted texture file fails.", "[MainTests::loadTextureAsyncFailed]") {
+	EditorApplication app(GetModuleHandle(NULL));
+
+	std::promise<bool> promiseReady;
+	std::promise<bool> promiseFinishRun;
+	std::future<bool> futureFinishRun = promiseFinishRun.get_future();
+	std::future<bool> futureReady = promiseReady.get_future();
+
+	std::thread t([&app, &promiseReady, &promiseFinishRun]() {
+		//app.initCompileShadersInRelease();  // uncomment for more fps in debug build
+		//app.initDisableD3DDebugLayer(); // not recommended, but uncomment for more fps in debug build
+		std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_BETWEEN_TESTS_MS));
+		if (app.init(L"MainWindow_" + std::to_wstring(time(0)), true))
+		{
+			promiseReady.set_value(true);
+			promiseFinishRun.set_value(true);
+			//REQUIRE(false);
+			return;
+		}
+		app.getVideoSettings()->setFPSLimit(120.0f);
+		promiseReady.set_value(false);
+		app.run();
+		promiseFinishRun.set_value(false);
+		});
+	t.detach();
+
+	bool bError = futureReady.get();
+	if (bError)
+	{
+		REQUIRE(false); // init failed
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	app.hideWindow(); // hide for testing
+
+
+	// --------------------------------------------------
+
+	// Files that exist (checked when the texture is requested) but fail on the I/O thread.
+
+	const std::filesystem::path pathToNotDDS = std::filesystem::temp_directory_path() / "silent_not_dds.dds";
+	const std::filesystem::path pathToTruncated = std::filesystem::temp_directory_path() / "silent_truncated.dds";
+
+	{
+		std::ofstream file(pathToNotDDS, std::ios::binary | std::ios::trunc);
+		file << "this is not a texture";
+	}
+
+	std::filesystem::copy_file(L"assets/tex.dds", pathToTruncated, std::filesystem::copy_options::overwrite_existing);
+	std::filesystem::resize_file(pathToTruncated, std::filesystem::file_size(pathToTruncated) / 2);
+
+	std::vector<STextureHandle> vTextures;
+
+	vTextures.push_back(app.loadTextureFromDiskToGPUAsync("notDDS", pathToNotDDS.wstring(), false, bError));
+	REQUIRE(bError == false);
+
+	vTextures.push_back(app.loadTextureFromDiskToGPUAsync("truncated", pathToTruncated.wstring(), false, bError));
+	REQUIRE(bError == false);
+
+	// Also a good texture after them (the I/O threads keep working).
+	vTextures.push_back(app.loadTextureFromDiskToGPUAsync("tex", L"assets/tex.dds", false, bError));
+	REQUIRE(bError == false);
+
+
+	std::chrono::time_point<std::chrono::steady_clock> timeStart = std::chrono::steady_clock::now();
+
+	while (std::chrono::steady_clock::now() - timeStart < std::chrono::seconds(10))
+	{
+		if (vTextures[0].getLoadState() != STextureLoadState::STLS_LOADING &&
+			vTextures[1].getLoadState() != STextureLoadState::STLS_LOADING &&
+			vTextures[2].getLoadState() != STextureLoadState::STLS_LOADING)
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	REQUIRE(vTextures[0].getLoadState() == STextureLoadState::STLS_FAILED);
+	REQUIRE(vTextures[1].getLoadState() == STextureLoadState::STLS_FAILED);
+	REQUIRE(vTextures[2].getLoadState() == STextureLoadState::STLS_RESIDENT);
+
+
+	// Failed textures still need to be unloaded.
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		if (app.unloadTextureFromGPU(vTextures[i]))
+		{
+			REQUIRE(false);
+		}
+	}
+
+	REQUIRE(app.getLoadedTextures().size() == 0);
+
+	std::filesystem::remove(pathToNotDDS);
+	std::filesystem::remove(pathToTruncated);
+
+	// --------------------------------------------------
+
+	PostMessage(app.getMainWindowHandle(), WM_QUIT, 0, 0);
+
+	futureFinishRun.get();
+
+	REQUIRE(true);
+}
+
 TEST_CASE("Compile custom shader.", "[MainTests::compileCustomShader]") {
 	EditorApplication app(GetModuleHandle(NULL));
 
@@ -0,0 +1,421 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <cstdint>
+
+// Custom
+#include "SilentEngine/Private/AudioEngine/SAudioStreamRing/saudiostreamring.h"
+
+//@@Class
+/*
+Generates PCM data instead of a decoder: byte N of the stream is (N * 7 + 3) % 251, decoded blocks
+have different sizes (like Media Foundation samples) and the source can stall (no data available).
+*/
+class SSyntheticPCMSource : public SPCMSource
+{
+public:
+	SSyntheticPCMSource(size_t iStreamSizeInBytes, size_t iMaxBlockSizeInBytes)
+	{
+		this->iStreamSizeInBytes = iStreamSizeInBytes;
+		this->iMaxBlockSizeInBytes = iMaxBlockSizeInBytes;
+	}
+
+	virtual bool readPCM(unsigned char* pDestination, size_t iMaxSizeInBytes, size_t& iReadSizeInBytes, bool& bEndOfStream) override
+	{
+		iReadSizeInBytes = 0;
+		bEndOfStream = false;
+
+		if (bStalled)
+		{
+			return false;
+		}
+
+		if (iBlockLeftInBytes == 0)
+		{
+			if (iReadPosition == iStreamSizeInBytes)
+			{
+				bEndOfStream = true;
+				return false;
+			}
+
+			// Next decoded block.
+			iBlockLeftInBytes = iMaxBlockSizeInBytes / 2 + (iBlockCount * 131) % (iMaxBlockSizeInBytes / 2 + 1);
+			iBlockLeftInBytes = std::min(iBlockLeftInBytes, iStreamSizeInBytes - iReadPosition);
+			iBlockCount++;
+		}
+
+		iReadSizeInBytes = std::min(iBlockLeftInBytes, iMaxSizeInBytes);
+
+		for (size_t i = 0; i < iReadSizeInBytes; i++)
+		{
+			pDestination[i] = getExpectedByte(iReadPosition + i);
+		}
+
+		iReadPosition += iReadSizeInBytes;
+		iBlockLeftInBytes -= iReadSizeInBytes;
+
+		return false;
+	}
+
+	static unsigned char getExpectedByte(size_t iPosition)
+	{
+		return static_cast<unsigned char>((iPosition * 7 + 3) % 251);
+	}
+
+	size_t iStreamSizeInBytes;
+	size_t iMaxBlockSizeInBytes;
+
+	size_t iReadPosition = 0;
+	size_t iBlockLeftInBytes = 0;
+	size_t iBlockCount = 0;
+
+	bool   bStalled = false;
+};
+
+TEST_CASE("Slots are allocated once and aligned to cache lines.", "[SAudioStreamRingTests::alignment]") {
+	SAudioStreamRing ring(4, 4410 * 4);
+
+	REQUIRE(ring.getSlotCount() == 4);
+	REQUIRE(ring.getSlotSizeInBytes() == 4410 * 4);
+	REQUIRE(ring.getFreeSlotCount() == 4);
+
+	std::vector<unsigned char*> vSlots;
+
+	for (size_t iRound = 0; iRound < 3; iRound++)
+	{
+		for (size_t i = 0; i < 4; i++)
+		{
+			unsigned char* pSlot = ring.getWriteSlot();
+			REQUIRE(pSlot != nullptr);
+			REQUIRE(reinterpret_cast<uintptr_t>(pSlot) % 64 == 0);
+
+			if (iRound == 0)
+			{
+				vSlots.push_back(pSlot);
+			}
+			else
+			{
+				// The same memory is reused.
+				REQUIRE(pSlot == vSlots[i]);
+			}
+
+			ring.commitWriteSlot(16);
+		}
+
+		REQUIRE(ring.getWriteSlot() == nullptr);
+		REQUIRE(ring.getFreeSlotCount() == 0);
+
+		for (size_t i = 0; i < 4; i++)
+		{
+			const unsigned char* pData = nullptr;
+			size_t iSizeInBytes = 0;
+
+			REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+			REQUIRE(pData == vSlots[i]);
+			REQUIRE(iSizeInBytes == 16);
+
+			ring.releaseReadSlot();
+		}
+	}
+}
+
+TEST_CASE("Decoded blocks are streamed through the slots in order.", "[SAudioStreamRingTests::order]") {
+	const size_t iStreamSizeInBytes = 100000;
+
+	SSyntheticPCMSource source(iStreamSizeInBytes, 3000);
+	SAudioStreamRing ring(3, 1024);
+
+	std::vector<unsigned char> vPlayed;
+
+	while (true)
+	{
+		REQUIRE(ring.refill(&source) == false);
+
+		const unsigned char* pData = nullptr;
+		size_t iSizeInBytes = 0;
+
+		if (ring.acquireReadSlot(pData, iSizeInBytes))
+		{
+			break;
+		}
+
+		// Only the last slot can be partially filled.
+		if (vPlayed.size() + iSizeInBytes < iStreamSizeInBytes)
+		{
+			REQUIRE(iSizeInBytes == 1024);
+		}
+
+		vPlayed.insert(vPlayed.end(), pData, pData + iSizeInBytes);
+
+		ring.releaseReadSlot();
+	}
+
+	REQUIRE(ring.isEndOfStream());
+	REQUIRE(vPlayed.size() == iStreamSizeInBytes);
+	for (size_t i = 0; i < vPlayed.size(); i++)
+	{
+		REQUIRE(vPlayed[i] == SSyntheticPCMSource::getExpectedByte(i));
+	}
+
+	SAudioStreamStats stats = ring.getStats();
+	REQUIRE(stats.iUnderrunCount == 0);
+	REQUIRE(stats.iStreamedBytes == iStreamSizeInBytes);
+	REQUIRE(stats.iFilledSlotCount == (iStreamSizeInBytes + 1023) / 1024);
+}
+
+TEST_CASE("Underruns are counted when the consumer runs out of slots.", "[SAudioStreamRingTests::underrun]") {
+	SSyntheticPCMSource source(10000, 512);
+	SAudioStreamRing ring(4, 256);
+
+	REQUIRE(ring.refill(&source) == false);
+	REQUIRE(ring.getReadySlotCount() == 4);
+
+	const unsigned char* pData = nullptr;
+	size_t iSizeInBytes = 0;
+
+	// The decoder stalls, the consumer plays all slots.
+	source.bStalled = true;
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+		ring.releaseReadSlot();
+	}
+
+	REQUIRE(ring.refill(&source) == false);
+	REQUIRE(ring.getReadySlotCount() == 0);
+
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes));
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes));
+	REQUIRE(ring.getStats().iUnderrunCount == 2);
+
+	// The decoder continues.
+	source.bStalled = false;
+
+	REQUIRE(ring.refill(&source) == false);
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+	REQUIRE(pData[0] == SSyntheticPCMSource::getExpectedByte(4 * 256));
+	ring.releaseReadSlot();
+
+	// Reported by the voice.
+	ring.reportUnderrun();
+	REQUIRE(ring.getStats().iUnderrunCount == 3);
+
+	// The end of the stream is not an underrun.
+	while (ring.isEndOfStream() == false)
+	{
+		REQUIRE(ring.refill(&source) == false);
+
+		while (ring.getReadySlotCount() > 0)
+		{
+			REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+			ring.releaseReadSlot();
+		}
+	}
+
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes));
+	REQUIRE(ring.getStats().iUnderrunCount == 3);
+
+	ring.reset();
+	REQUIRE(ring.isEndOfStream() == false);
+	REQUIRE(ring.getFreeSlotCount() == 4);
+}
+
+TEST_CASE("Slots are released by another thread than the producer.", "[SAudioStreamRingTests::threads]") {
+	const size_t iStreamSizeInBytes = 4 * 1024 * 1024;
+
+	SSyntheticPCMSource source(iStreamSizeInBytes, 4608);
+	SAudioStreamRing ring(4, 4096);
+
+	std::vector<unsigned char> vPlayed;
+	vPlayed.reserve(iStreamSizeInBytes);
+
+	std::atomic<bool> bProducerFailed{ false };
+
+	// The streaming thread of SSound.
+	std::thread producer([&]()
+	{
+		while (ring.isEndOfStream() == false)
+		{
+			if (ring.refill(&source))
+			{
+				bProducerFailed = true;
+				break;
+			}
+
+			std::this_thread::yield();
+		}
+	});
+
+	// The voice.
+	while (true)
+	{
+		const unsigned char* pData = nullptr;
+		size_t iSizeInBytes = 0;
+
+		if (ring.acquireReadSlot(pData, iSizeInBytes))
+		{
+			if (ring.isEndOfStream() && ring.getReadySlotCount() == 0)
+			{
+				break;
+			}
+
+			std::this_thread::yield();
+			continue;
+		}
+
+		vPlayed.insert(vPlayed.end(), pData, pData + iSizeInBytes);
+
+		ring.releaseReadSlot();
+	}
+
+	producer.join();
+
+	REQUIRE(bProducerFailed == false);
+	REQUIRE(vPlayed.size() == iStreamSizeInBytes);
+
+	bool bValid = true;
+	for (size_t i = 0; i < vPlayed.size(); i++)
+	{
+		bValid = bValid && (vPlayed[i] == SSyntheticPCMSource::getExpectedByte(i));
+	}
+	REQUIRE(bValid);
+}
+
+TEST_CASE("Acquired slots are counted until the consumer releases them.", "[SAudioStreamRingTests::acquired]") {
+	SAudioStreamRing ring(4, 64);
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		REQUIRE(ring.getWriteSlot() != nullptr);
+		ring.commitWriteSlot(16);
+	}
+
+	// Committed but not acquired slots are not used by the consumer.
+	REQUIRE(ring.getAcquiredSlotCount() == 0);
+
+	const unsigned char* pData = nullptr;
+	size_t iSizeInBytes = 0;
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+	REQUIRE(ring.acquireReadSlot(pData, iSizeInBytes) == false);
+	REQUIRE(ring.getAcquiredSlotCount() == 2);
+
+	ring.releaseReadSlot();
+	REQUIRE(ring.getAcquiredSlotCount() == 1);
+
+	// Like a voice that returns the flushed buffers, only then the ring can be reset.
+	ring.releaseReadSlot();
+	REQUIRE(ring.getAcquiredSlotCount() == 0);
+
+	ring.reset();
+	REQUIRE(ring.getFreeSlotCount() == 4);
+	REQUIRE(ring.getAcquiredSlotCount() == 0);
+}
+
+TEST_CASE("Benchmark streaming through the ring.", "[.][benchmark][SAudioStreamRingTests::benchmark]") {
+	// 10 minutes of 44.1 kHz 16 bit stereo music decoded in 4608 byte blocks (MP3 frames).
+	const size_t iStreamSizeInBytes = 44100 * 4 * 600;
+	const size_t iBlockSizeInBytes = 4608;
+
+	std::vector<unsigned char> vDecodedBlock(iBlockSizeInBytes);
+	for (size_t i = 0; i < vDecodedBlock.size(); i++)
+	{
+		vDecodedBlock[i] = SSyntheticPCMSource::getExpectedByte(i);
+	}
+
+	size_t iPushedBytes = 0;
+	size_t iRingBytes = 0;
+
+	// Old: every byte is appended to a vector.
+	BENCHMARK("per-byte push_back") {
+		iPushedBytes = 0;
+
+		std::vector<unsigned char> vWaveData;
+		for (size_t iRead = 0; iRead < iStreamSizeInBytes; iRead += iBlockSizeInBytes)
+		{
+			const size_t iReadSizeInBytes = std::min(iBlockSizeInBytes, iStreamSizeInBytes - iRead);
+
+			for (size_t i = 0; i < iReadSizeInBytes; i++)
+			{
+				vWaveData.push_back(vDecodedBlock[i]);
+			}
+
+			if (vWaveData.size() >= 44100 * 4 / 10)
+			{
+				iPushedBytes += vWaveData.size();
+				vWaveData = std::vector<unsigned char>(); // submitted buffer is freed
+			}
+		}
+		iPushedBytes += vWaveData.size();
+
+		return iPushedBytes;
+	};
+
+
+	// New: blocks are bulk copied to preallocated slots.
+	class SBlockSource : public SPCMSource
+	{
+	public:
+		virtual bool readPCM(unsigned char* pDestination, size_t iMaxSizeInBytes, size_t& iReadSizeInBytes, bool& bEndOfStream) override
+		{
+			bEndOfStream = iRead >= iStreamSize;
+			iReadSizeInBytes = 0;
+			if (bEndOfStream)
+			{
+				return false;
+			}
+
+			iReadSizeInBytes = std::min(iMaxSizeInBytes, pBlock->size() - iBlockOffset);
+			std::memcpy(pDestination, pBlock->data() + iBlockOffset, iReadSizeInBytes);
+
+			iBlockOffset = (iBlockOffset + iReadSizeInBytes) % pBlock->size();
+			iRead += iReadSizeInBytes;
+
+			return false;
+		}
+
+		const std::vector<unsigned char>* pBlock = nullptr;
+		size_t iBlockOffset = 0;
+		size_t iRead = 0;
+		size_t iStreamSize = 0;
+	};
+
+	BENCHMARK("preallocated ring") {
+		SBlockSource source;
+		source.pBlock = &vDecodedBlock;
+		source.iStreamSize = iStreamSizeInBytes;
+
+		SAudioStreamRing ring(4, 44100 * 4 / 10);
+
+		iRingBytes = 0;
+		while (true)
+		{
+			ring.refill(&source);
+
+			const unsigned char* pData = nullptr;
+			size_t iSizeInBytes = 0;
+			if (ring.acquireReadSlot(pData, iSizeInBytes))
+			{
+				break;
+			}
+
+			iRingBytes += iSizeInBytes;
+			ring.releaseReadSlot();
+		}
+
+		return iRingBytes;
+	};
+
+	REQUIRE(iPushedBytes == iRingBytes);
+}
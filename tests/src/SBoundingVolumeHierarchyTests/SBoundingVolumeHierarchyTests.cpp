@@ -0,0 +1,431 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <algorithm>
+#include <cmath>
+
+// Custom
+#include "SilentEngine/Private/SBoundingVolumeHierarchy/SBoundingVolumeHierarchy.h"
+
+static float getPseudoRandom(size_t& iState, float fMin, float fMax)
+{
+	iState = iState * 6364136223846793005ULL + 1442695040888963407ULL;
+
+	return fMin + (fMax - fMin) * static_cast<float>((iState >> 40) & 0xFFFF) / 65535.0f;
+}
+
+static DirectX::BoundingBox createRandomBox(size_t& iState)
+{
+	DirectX::BoundingBox box;
+	box.Center  = DirectX::XMFLOAT3(getPseudoRandom(iState, -100.0f, 100.0f), getPseudoRandom(iState, -100.0f, 100.0f),
+		getPseudoRandom(iState, -100.0f, 100.0f));
+	box.Extents = DirectX::XMFLOAT3(getPseudoRandom(iState, 0.1f, 3.0f), getPseudoRandom(iState, 0.1f, 3.0f), getPseudoRandom(iState, 0.1f, 3.0f));
+
+	return box;
+}
+
+static DirectX::XMFLOAT3 createRandomDirection(size_t& iState)
+{
+	DirectX::XMFLOAT3 vDirection(getPseudoRandom(iState, -1.0f, 1.0f), getPseudoRandom(iState, -1.0f, 1.0f), getPseudoRandom(iState, -1.0f, 1.0f));
+
+	const float fLength = std::sqrt(vDirection.x * vDirection.x + vDirection.y * vDirection.y + vDirection.z * vDirection.z);
+
+	return DirectX::XMFLOAT3(vDirection.x / fLength, vDirection.y / fLength, vDirection.z / fLength);
+}
+
+static bool isBoxOverlapping(const DirectX::BoundingBox& a, const DirectX::BoundingBox& b)
+{
+	return std::fabs(a.Center.x - b.Center.x) <= a.Extents.x + b.Extents.x
+		&& std::fabs(a.Center.y - b.Center.y) <= a.Extents.y + b.Extents.y
+		&& std::fabs(a.Center.z - b.Center.z) <= a.Extents.z + b.Extents.z;
+}
+
+static void compareQueriesWithBruteForce(const SBoundingVolumeHierarchy& bvh, const std::vector<DirectX::BoundingBox>& vBoxes,
+	const std::vector<bool>& vAdded, size_t& iState)
+{
+	// Same results as testing every box.
+
+	for (size_t iQuery = 0; iQuery < 200; iQuery++)
+	{
+		const DirectX::BoundingBox queryBox = createRandomBox(iState);
+		const DirectX::XMFLOAT3 vDirection = createRandomDirection(iState);
+		const float fDistance = getPseudoRandom(iState, 10.0f, 150.0f);
+
+		std::vector<uint32_t> vExpectedRay;
+		std::vector<uint32_t> vExpectedOverlap;
+		std::vector<uint32_t> vExpectedSweep;
+
+		for (size_t i = 0; i < vBoxes.size(); i++)
+		{
+			if (vAdded[i] == false)
+			{
+				continue;
+			}
+
+			float fHitDistance = 0.0f;
+
+			if (SBoundingVolumeHierarchy::getRayHitDistance(vBoxes[i], queryBox.Center, vDirection, fDistance, fHitDistance))
+			{
+				vExpectedRay.push_back(static_cast<uint32_t>(i));
+			}
+
+			if (isBoxOverlapping(vBoxes[i], queryBox))
+			{
+				vExpectedOverlap.push_back(static_cast<uint32_t>(i));
+			}
+
+			DirectX::BoundingBox expandedBox = vBoxes[i];
+			expandedBox.Extents.x += queryBox.Extents.x;
+			expandedBox.Extents.y += queryBox.Extents.y;
+			expandedBox.Extents.z += queryBox.Extents.z;
+
+			if (SBoundingVolumeHierarchy::getRayHitDistance(expandedBox, queryBox.Center, vDirection, fDistance, fHitDistance))
+			{
+				vExpectedSweep.push_back(static_cast<uint32_t>(i));
+			}
+		}
+
+		std::vector<uint32_t> vRay;
+		std::vector<uint32_t> vOverlap;
+		std::vector<uint32_t> vSweep;
+
+		bvh.rayCast(queryBox.Center, vDirection, fDistance, vRay);
+		bvh.overlap(queryBox, vOverlap);
+		bvh.sweep(queryBox, vDirection, fDistance, vSweep);
+
+		std::sort(vRay.begin(), vRay.end());
+		std::sort(vOverlap.begin(), vOverlap.end());
+		std::sort(vSweep.begin(), vSweep.end());
+
+		REQUIRE(vRay == vExpectedRay);
+		REQUIRE(vOverlap == vExpectedOverlap);
+		REQUIRE(vSweep == vExpectedSweep);
+	}
+}
+
+TEST_CASE("Ray/box test returns the entry distance.", "[SBoundingVolumeHierarchyTests::rayHitDistance]") {
+	DirectX::BoundingBox box;
+	box.Center  = DirectX::XMFLOAT3(10.0f, 0.0f, 0.0f);
+	box.Extents = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+
+	float fHitDistance = 0.0f;
+
+	REQUIRE(SBoundingVolumeHierarchy::getRayHitDistance(box, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f),
+		100.0f, fHitDistance));
+	REQUIRE(fHitDistance == Approx(9.0f));
+
+	// Too short.
+	REQUIRE(SBoundingVolumeHierarchy::getRayHitDistance(box, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f),
+		8.0f, fHitDistance) == false);
+
+	// Wrong direction.
+	REQUIRE(SBoundingVolumeHierarchy::getRayHitDistance(box, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(-1.0f, 0.0f, 0.0f),
+		100.0f, fHitDistance) == false);
+
+	// Origin inside.
+	REQUIRE(SBoundingVolumeHierarchy::getRayHitDistance(box, DirectX::XMFLOAT3(10.0f, 0.5f, 0.0f), DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f),
+		100.0f, fHitDistance));
+	REQUIRE(fHitDistance == 0.0f);
+}
+
+TEST_CASE("BVH built using SAH returns the same boxes as the brute force test.", "[SBoundingVolumeHierarchyTests::build]") {
+	size_t iState = 7;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	for (size_t i = 0; i < 2000; i++)
+	{
+		vBoxes.push_back(createRandomBox(iState));
+	}
+
+	SBoundingVolumeHierarchy bvh;
+	bvh.build(vBoxes);
+
+	REQUIRE(bvh.getProxyCount() == vBoxes.size());
+	REQUIRE(bvh.getCost() > 0.0f);
+
+	compareQueriesWithBruteForce(bvh, vBoxes, std::vector<bool>(vBoxes.size(), true), iState);
+}
+
+TEST_CASE("BVH changed incrementally returns the same boxes as the brute force test.", "[SBoundingVolumeHierarchyTests::incremental]") {
+	size_t iState = 13;
+
+	SBoundingVolumeHierarchy bvh;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	std::vector<bool> vAdded;
+
+	for (size_t i = 0; i < 1000; i++)
+	{
+		const uint32_t iProxy = bvh.addProxy(createRandomBox(iState));
+
+		REQUIRE(iProxy == i);
+
+		vBoxes.push_back(bvh.getProxyBox(iProxy));
+		vAdded.push_back(true);
+	}
+
+	// Remove every third proxy and move every second.
+
+	for (uint32_t i = 0; i < vBoxes.size(); i++)
+	{
+		if (i % 3 == 0)
+		{
+			bvh.removeProxy(i);
+			vAdded[i] = false;
+		}
+		else if (i % 2 == 0)
+		{
+			bvh.updateProxy(i, createRandomBox(iState));
+			vBoxes[i] = bvh.getProxyBox(i);
+		}
+	}
+
+	REQUIRE(bvh.getProxyCount() == 666);
+
+	compareQueriesWithBruteForce(bvh, vBoxes, vAdded, iState);
+
+	// Removed proxy IDs are reused.
+
+	const uint32_t iProxy = bvh.addProxy(createRandomBox(iState));
+
+	REQUIRE(iProxy % 3 == 0);
+	REQUIRE(iProxy < vBoxes.size());
+
+	vBoxes[iProxy] = bvh.getProxyBox(iProxy);
+	vAdded[iProxy] = true;
+
+	// Proxy IDs do not change after the rebuild.
+
+	const float fCostBeforeRebuild = bvh.getCost();
+
+	bvh.rebuild();
+
+	REQUIRE(bvh.getCost() <= fCostBeforeRebuild);
+
+	compareQueriesWithBruteForce(bvh, vBoxes, vAdded, iState);
+}
+
+TEST_CASE("BVH is rebuilt after many changes.", "[SBoundingVolumeHierarchyTests::rebuildIfDegraded]") {
+	size_t iState = 21;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	for (size_t i = 0; i < 1000; i++)
+	{
+		vBoxes.push_back(createRandomBox(iState));
+	}
+
+	SBoundingVolumeHierarchy bvh;
+	bvh.build(vBoxes);
+
+	REQUIRE(bvh.rebuildIfDegraded() == false);
+
+	const float fCostAfterBuild = bvh.getCost();
+
+	// Move all boxes far away so that refitted nodes overlap a lot.
+
+	for (uint32_t i = 0; i < vBoxes.size(); i++)
+	{
+		DirectX::BoundingBox box = createRandomBox(iState);
+		box.Center.x *= 10.0f;
+		box.Center.y *= 10.0f;
+		box.Center.z *= 10.0f;
+
+		bvh.updateProxy(i, box);
+	}
+
+	REQUIRE(bvh.getCost() > fCostAfterBuild * 1.5f);
+	REQUIRE(bvh.rebuildIfDegraded());
+	REQUIRE(bvh.getCost() < fCostAfterBuild * 1.5f);
+}
+
+static void rayCastPackets(const SBoundingVolumeHierarchy& bvh, const std::vector<DirectX::XMFLOAT3>& vOrigins,
+	const std::vector<DirectX::XMFLOAT3>& vDirections, float fMaxDistance, std::vector<std::vector<uint32_t>>& vOutProxies)
+{
+	vOutProxies.resize(vOrigins.size());
+
+	const float vMaxDistances[SBoundingVolumeHierarchy::iRayPacketSize] = { fMaxDistance, fMaxDistance, fMaxDistance, fMaxDistance };
+
+	for (size_t i = 0; i < vOrigins.size(); i += SBoundingVolumeHierarchy::iRayPacketSize)
+	{
+		const size_t iRayCount = std::min<size_t>(SBoundingVolumeHierarchy::iRayPacketSize, vOrigins.size() - i);
+
+		for (size_t j = 0; j < iRayCount; j++)
+		{
+			vOutProxies[i + j].clear();
+		}
+
+		bvh.rayCastPacket(&vOrigins[i], &vDirections[i], vMaxDistances, iRayCount, &vOutProxies[i]);
+	}
+}
+
+TEST_CASE("Ray packets return the same boxes as single rays.", "[SBoundingVolumeHierarchyTests::rayCastPacket]") {
+	size_t iState = 5;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	for (size_t i = 0; i < 2000; i++)
+	{
+		vBoxes.push_back(createRandomBox(iState));
+	}
+
+	SBoundingVolumeHierarchy bvh;
+	bvh.build(vBoxes);
+
+	// Not a multiple of the packet size to also test a partial packet.
+	// Half of the rays go in similar directions (like the rays of a camera), others are random.
+
+	std::vector<DirectX::XMFLOAT3> vOrigins;
+	std::vector<DirectX::XMFLOAT3> vDirections;
+	for (size_t i = 0; i < 503; i++)
+	{
+		if (i % 2 == 0)
+		{
+			vOrigins.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, -150.0f));
+			vDirections.push_back(createRandomDirection(iState));
+			vDirections.back().z = 3.0f + std::fabs(vDirections.back().z);
+
+			const float fLength = std::sqrt(vDirections.back().x * vDirections.back().x + vDirections.back().y * vDirections.back().y
+				+ vDirections.back().z * vDirections.back().z);
+
+			vDirections.back().x /= fLength;
+			vDirections.back().y /= fLength;
+			vDirections.back().z /= fLength;
+		}
+		else
+		{
+			vOrigins.push_back(createRandomBox(iState).Center);
+			vDirections.push_back(createRandomDirection(iState));
+		}
+	}
+
+	// Axis aligned ray (zero direction components).
+	vOrigins.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, -150.0f));
+	vDirections.push_back(DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f));
+
+	std::vector<std::vector<uint32_t>> vPacketProxies;
+	rayCastPackets(bvh, vOrigins, vDirections, 300.0f, vPacketProxies);
+
+	REQUIRE(vPacketProxies.size() == vOrigins.size());
+
+	size_t iHitCount = 0;
+
+	for (size_t i = 0; i < vOrigins.size(); i++)
+	{
+		std::vector<uint32_t> vExpectedProxies;
+		bvh.rayCast(vOrigins[i], vDirections[i], 300.0f, vExpectedProxies);
+
+		std::sort(vExpectedProxies.begin(), vExpectedProxies.end());
+		std::sort(vPacketProxies[i].begin(), vPacketProxies[i].end());
+
+		REQUIRE(vPacketProxies[i] == vExpectedProxies);
+
+		iHitCount += vExpectedProxies.size();
+	}
+
+	REQUIRE(iHitCount > 0);
+}
+
+TEST_CASE("Benchmark ray casts against 10k boxes.", "[.][benchmark][SBoundingVolumeHierarchyTests::benchmarkRayCast]") {
+	size_t iState = 42;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		vBoxes.push_back(createRandomBox(iState));
+	}
+
+	SBoundingVolumeHierarchy bvh;
+	bvh.build(vBoxes);
+
+	std::vector<DirectX::XMFLOAT3> vOrigins;
+	std::vector<DirectX::XMFLOAT3> vDirections;
+	for (size_t i = 0; i < 100; i++)
+	{
+		vOrigins.push_back(createRandomBox(iState).Center);
+		vDirections.push_back(createRandomDirection(iState));
+	}
+
+	BENCHMARK("linear: 100 rays") {
+		size_t iHitCount = 0;
+
+		for (size_t iRay = 0; iRay < vOrigins.size(); iRay++)
+		{
+			for (size_t i = 0; i < vBoxes.size(); i++)
+			{
+				float fHitDistance = 0.0f;
+				if (SBoundingVolumeHierarchy::getRayHitDistance(vBoxes[i], vOrigins[iRay], vDirections[iRay], 50.0f, fHitDistance))
+				{
+					iHitCount++;
+				}
+			}
+		}
+
+		return iHitCount;
+	};
+
+	std::vector<uint32_t> vProxies;
+
+	BENCHMARK("BVH: 100 rays") {
+		vProxies.clear();
+
+		for (size_t iRay = 0; iRay < vOrigins.size(); iRay++)
+		{
+			bvh.rayCast(vOrigins[iRay], vDirections[iRay], 50.0f, vProxies);
+		}
+
+		return vProxies.size();
+	};
+}
+
+TEST_CASE("Benchmark ray cast throughput (rays per second) against 10k boxes.", "[.][benchmark][SBoundingVolumeHierarchyTests::benchmarkRayThroughput]") {
+	size_t iState = 42;
+
+	std::vector<DirectX::BoundingBox> vBoxes;
+	for (size_t i = 0; i < 10000; i++)
+	{
+		vBoxes.push_back(createRandomBox(iState));
+	}
+
+	SBoundingVolumeHierarchy bvh;
+	bvh.build(vBoxes);
+
+	// Camera-like rays: same origin, similar directions.
+	// Rays per second is the ray count divided by the mean time of a benchmark.
+
+	std::vector<DirectX::XMFLOAT3> vOrigins(4096, DirectX::XMFLOAT3(0.0f, 0.0f, -150.0f));
+	std::vector<DirectX::XMFLOAT3> vDirections;
+	for (size_t i = 0; i < vOrigins.size(); i++)
+	{
+		const float fX = static_cast<float>(i % 64) / 64.0f - 0.5f;
+		const float fY = static_cast<float>(i / 64) / 64.0f - 0.5f;
+		const float fLength = std::sqrt(fX * fX + fY * fY + 1.0f);
+
+		vDirections.push_back(DirectX::XMFLOAT3(fX / fLength, fY / fLength, 1.0f / fLength));
+	}
+
+	std::vector<uint32_t> vProxies;
+	std::vector<std::vector<uint32_t>> vPacketProxies;
+
+	BENCHMARK("single rays: 4096 rays") {
+		vProxies.clear();
+
+		for (size_t i = 0; i < vOrigins.size(); i++)
+		{
+			bvh.rayCast(vOrigins[i], vDirections[i], 300.0f, vProxies);
+		}
+
+		return vProxies.size();
+	};
+
+	BENCHMARK("ray packets: 4096 rays") {
+		rayCastPackets(bvh, vOrigins, vDirections, 300.0f, vPacketProxies);
+
+		return vPacketProxies.size();
+	};
+}
@@ -0,0 +1,202 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "Catch2/catch.hpp"
+
+// STL
+#include <fstream>
+#include <cstring>
+#include <iterator>
+
+// Custom
+#include "SilentEngine/Private/SDDSTexture/SDDSTexture.h"
+
+static std::vector<unsigned char> createLegacyHeader(uint32_t iWidth, uint32_t iHeight, uint32_t iMipCount, const char* pFourCC, uint32_t iCaps2)
+{
+	std::vector<unsigned char> vData(4 + 124, 0);
+
+	auto write = [&](size_t iOffset, uint32_t iValue) { std::memcpy(vData.data() + iOffset, &iValue, sizeof(iValue)); };
+
+	std::memcpy(vData.data(), "DDS ", 4);
+	write(4, 124);
+	write(8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000); // caps, height, width, pixel format, mip count
+	write(12, iHeight);
+	write(16, iWidth);
+	write(28, iMipCount);
+	write(76, 32);
+	write(80, 0x4); // four CC
+	std::memcpy(vData.data() + 84, pFourCC, 4);
+	write(112, iCaps2);
+
+	return vData;
+}
+
+TEST_CASE("Read the header of a .dds file.", "[SDDSTextureTests::readDesc]") {
+	SDDSTextureDesc desc;
+
+	REQUIRE(SDDSTexture::readDesc(L"assets/tex.dds", desc) == false);
+
+	REQUIRE(desc.iWidth == 256);
+	REQUIRE(desc.iHeight == 256);
+	REQUIRE(desc.iDepth == 1);
+	REQUIRE(desc.iMipCount == 9);
+	REQUIRE(desc.iArraySize == 1);
+	REQUIRE(desc.bIsCubeMap == false);
+	REQUIRE(desc.format == SDDSFormat::SDF_BC7_UNORM);
+	REQUIRE(desc.iBlockSize == 4);
+	REQUIRE(desc.iBytesPerBlock == 16);
+
+	// Pixel data should take the rest of the file.
+	std::ifstream file("assets/tex.dds", std::ios::binary | std::ios::ate);
+	REQUIRE(file.is_open());
+
+	size_t iFileSize = static_cast<size_t>(file.tellg());
+	REQUIRE(SDDSTexture::getDataSizeInBytes(desc) == iFileSize - (4 + 124 + 20));
+
+	REQUIRE(SDDSTexture::readDesc(L"assets/not_existing.dds", desc));
+	REQUIRE(SDDSTexture::readDesc(L"assets/test_matrix_compute.hlsl", desc));
+}
+
+TEST_CASE("Parse legacy headers.", "[SDDSTextureTests::parseLegacyHeader]") {
+	SDDSTextureDesc desc;
+	size_t iHeaderSize = 0;
+
+	std::vector<unsigned char> vHeader = createLegacyHeader(64, 32, 7, "DXT1", 0);
+
+	REQUIRE(SDDSTexture::parseHeader(vHeader.data(), vHeader.size(), desc, iHeaderSize) == false);
+	REQUIRE(iHeaderSize == 128);
+	REQUIRE(desc.format == SDDSFormat::SDF_BC1_UNORM);
+	REQUIRE(desc.iBytesPerBlock == 8);
+	REQUIRE(desc.iWidth == 64);
+	REQUIRE(desc.iHeight == 32);
+	REQUIRE(desc.iMipCount == 7);
+
+	// Cube map.
+	vHeader = createLegacyHeader(16, 16, 1, "DXT5", 0x200 | 0xFC00);
+
+	REQUIRE(SDDSTexture::parseHeader(vHeader.data(), vHeader.size(), desc, iHeaderSize) == false);
+	REQUIRE(desc.format == SDDSFormat::SDF_BC3_UNORM);
+	REQUIRE(desc.bIsCubeMap);
+	REQUIRE(desc.iArraySize == 6);
+
+	// Partial cube map.
+	vHeader = createLegacyHeader(16, 16, 1, "DXT5", 0x200 | 0x400);
+	REQUIRE(SDDSTexture::parseHeader(vHeader.data(), vHeader.size(), desc, iHeaderSize));
+
+	// Not supported format.
+	vHeader = createLegacyHeader(16, 16, 1, "ABCD", 0);
+	REQUIRE(SDDSTexture::parseHeader(vHeader.data(), vHeader.size(), desc, iHeaderSize));
+
+	// Too small.
+	REQUIRE(SDDSTexture::parseHeader(vHeader.data(), 100, desc, iHeaderSize));
+}
+
+TEST_CASE("Calculate mip ranges.", "[SDDSTextureTests::getMipRange]") {
+	SDDSTextureDesc desc;
+	desc.iWidth = 256;
+	desc.iHeight = 128;
+	desc.iMipCount = 9;
+	desc.iArraySize = 2;
+	desc.format = SDDSFormat::SDF_BC1_UNORM;
+	desc.iBlockSize = 4;
+	desc.iBytesPerBlock = 8;
+
+	std::vector<SDDSMipRegion> vAll;
+	SDDSTexture::getMipRange(desc, 0, desc.iMipCount, vAll);
+
+	REQUIRE(vAll.size() == 18);
+
+	// Regions go one after another, each array slice stores all of its mips.
+	size_t iOffset = 0;
+	for (size_t i = 0; i < vAll.size(); i++)
+	{
+		REQUIRE(vAll[i].iOffset == iOffset);
+		REQUIRE(vAll[i].iArrayIndex == i / 9);
+		REQUIRE(vAll[i].iMip == i % 9);
+		iOffset += vAll[i].iSizeInBytes;
+	}
+
+	REQUIRE(iOffset == SDDSTexture::getDataSizeInBytes(desc));
+
+	// Mip 0: 64x32 blocks of 8 bytes.
+	REQUIRE(vAll[0].iRowPitch == 64 * 8);
+	REQUIRE(vAll[0].iRowCount == 32);
+	REQUIRE(vAll[0].iSizeInBytes == 64 * 8 * 32);
+
+	// Mip 8: 1x1 pixels is still one block.
+	REQUIRE(vAll[8].iWidth == 1);
+	REQUIRE(vAll[8].iHeight == 1);
+	REQUIRE(vAll[8].iSizeInBytes == 8);
+
+	// Sub range.
+	std::vector<SDDSMipRegion> vRange;
+	SDDSTexture::getMipRange(desc, 6, 9, vRange);
+
+	REQUIRE(vRange.size() == 6);
+	REQUIRE(vRange[0].iOffset == vAll[6].iOffset);
+	REQUIRE(vRange[3].iOffset == vAll[15].iOffset);
+
+	size_t iRangeSize = 0;
+	for (size_t i = 0; i < vRange.size(); i++)
+	{
+		iRangeSize += vRange[i].iSizeInBytes;
+	}
+
+	REQUIRE(iRangeSize == SDDSTexture::getMipSizeInBytes(desc, 6) + SDDSTexture::getMipSizeInBytes(desc, 7) + SDDSTexture::getMipSizeInBytes(desc, 8));
+
+	REQUIRE(SDDSTexture::getFirstMipNotBiggerThan(desc, 64) == 2);
+	REQUIRE(SDDSTexture::getFirstMipNotBiggerThan(desc, 0) == 8);
+}
+
+TEST_CASE("Parse the layout of a whole .dds file.", "[SDDSTextureTests::parseLayout]") {
+	std::ifstream file("assets/tex.dds", std::ios::binary);
+	REQUIRE(file.is_open());
+
+	std::vector<char> vFileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	SDDSTextureDesc desc;
+	size_t iHeaderSize = 0;
+	std::vector<SDDSMipRegion> vRegions;
+
+	REQUIRE(SDDSTexture::parseLayout(vFileData.data(), vFileData.size(), desc, iHeaderSize, vRegions) == false);
+
+	REQUIRE(iHeaderSize == 4 + 124 + 20);
+	REQUIRE(desc.format == SDDSFormat::SDF_BC7_UNORM);
+	REQUIRE(vRegions.size() == 9);
+
+	// 256x256 BC7: 64 blocks of 16 bytes in a row.
+	REQUIRE(vRegions[0].iOffset == 0);
+	REQUIRE(vRegions[0].iRowPitch == 64 * 16);
+	REQUIRE(vRegions[0].iRowCount == 64);
+
+	// 4x4 and smaller mips take one block.
+	for (size_t i = 6; i < vRegions.size(); i++)
+	{
+		REQUIRE(vRegions[i].iRowPitch == 16);
+		REQUIRE(vRegions[i].iRowCount == 1);
+	}
+
+	// The last mip ends at the end of the file.
+	REQUIRE(iHeaderSize + vRegions.back().iOffset + vRegions.back().iSizeInBytes == vFileData.size());
+
+	// Truncated file.
+	REQUIRE(SDDSTexture::parseLayout(vFileData.data(), vFileData.size() - 1, desc, iHeaderSize, vRegions));
+	REQUIRE(vRegions.size() == 0);
+
+	// Only the header.
+	REQUIRE(SDDSTexture::parseLayout(vFileData.data(), iHeaderSize, desc, iHeaderSize, vRegions));
+
+	// Too many mips for the size.
+	std::vector<unsigned char> vHeader = createLegacyHeader(16, 16, 6, "DXT1", 0);
+	vHeader.resize(vHeader.size() + 1024);
+	REQUIRE(SDDSTexture::parseLayout(vHeader.data(), vHeader.size(), desc, iHeaderSize, vRegions));
+
+	// Too big.
+	vHeader = createLegacyHeader(32768, 16, 1, "DXT1", 0);
+	REQUIRE(SDDSTexture::parseLayout(vHeader.data(), vHeader.size(), desc, iHeaderSize, vRegions));
+}
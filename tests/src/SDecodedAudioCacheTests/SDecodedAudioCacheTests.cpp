@@ -0,0 +1,229 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <cstdint>
+
+// Custom
+#include "SilentEngine/Private/AudioEngine/SDecodedAudioCache/sdecodedaudiocache.h"
+
+static SDecodedAudioFormat makePCMFormat(unsigned short iChannels, unsigned long iSampleRate)
+{
+	SDecodedAudioFormat format;
+	format.iFormatTag = 1; // WAVE_FORMAT_PCM
+	format.iChannels = iChannels;
+	format.iSampleRate = iSampleRate;
+	format.iBitsPerSample = 16;
+
+	return format;
+}
+
+static std::vector<unsigned char> makePCMData(size_t iSizeInBytes, unsigned char iValue)
+{
+	return std::vector<unsigned char>(iSizeInBytes, iValue);
+}
+
+TEST_CASE("Sounds that load the same file share the decoded data.", "[SDecodedAudioCacheTests::share]") {
+	SDecodedAudioCache cache;
+
+	const SDecodedAudioFormat format = makePCMFormat(1, 44100);
+
+	REQUIRE(cache.find(L"footstep.wav", format) == nullptr);
+
+	std::shared_ptr<const SDecodedAudio> pFirstSound = cache.add(L"footstep.wav", format, makePCMData(1000, 7));
+	REQUIRE(pFirstSound != nullptr);
+	REQUIRE(pFirstSound->vPCMData.size() == 1000);
+	REQUIRE(pFirstSound->format.iSampleRate == 44100);
+
+	std::shared_ptr<const SDecodedAudio> pSecondSound = cache.find(L"footstep.wav", format);
+	REQUIRE(pSecondSound == pFirstSound);
+
+	// Another output format is another entry.
+	REQUIRE(cache.find(L"footstep.wav", makePCMFormat(2, 44100)) == nullptr);
+	REQUIRE(cache.find(L"footstep.wav", makePCMFormat(1, 48000)) == nullptr);
+	REQUIRE(cache.find(L"impact.wav", format) == nullptr);
+
+	// The file was decoded by another sound at the same time.
+	std::shared_ptr<const SDecodedAudio> pThirdSound = cache.add(L"footstep.wav", format, makePCMData(1000, 9));
+	REQUIRE(pThirdSound == pFirstSound);
+	REQUIRE(pThirdSound->vPCMData[0] == 7);
+
+	SDecodedAudioCacheStats stats = cache.getStats();
+	REQUIRE(stats.iHitCount == 1);
+	REQUIRE(stats.iMissCount == 4);
+	REQUIRE(stats.iEntryCount == 1);
+	REQUIRE(stats.iResidentBytes == 1000);
+}
+
+TEST_CASE("Least recently used unused data is removed when the budget is exceeded.", "[SDecodedAudioCacheTests::lru]") {
+	SDecodedAudioCache cache(3000);
+
+	const SDecodedAudioFormat format = makePCMFormat(1, 44100);
+
+	// "a" and "c" are used by sounds, "b" is not.
+	std::shared_ptr<const SDecodedAudio> pA = cache.add(L"a.wav", format, makePCMData(1000, 1));
+	cache.add(L"b.wav", format, makePCMData(1000, 2));
+	std::shared_ptr<const SDecodedAudio> pC = cache.add(L"c.wav", format, makePCMData(1000, 3));
+
+	REQUIRE(cache.getStats().iResidentBytes == 3000);
+
+	// "b" is the least recently used unused entry.
+	std::shared_ptr<const SDecodedAudio> pD = cache.add(L"d.wav", format, makePCMData(1000, 4));
+
+	REQUIRE(cache.find(L"b.wav", format) == nullptr);
+	REQUIRE(cache.find(L"a.wav", format) == pA);
+	REQUIRE(cache.getStats().iEvictionCount == 1);
+	REQUIRE(cache.getStats().iResidentBytes == 3000);
+
+	// The data used by sounds is never removed (even over the budget).
+	std::shared_ptr<const SDecodedAudio> pE = cache.add(L"e.wav", format, makePCMData(1000, 5));
+	REQUIRE(cache.getStats().iResidentBytes == 4000);
+	REQUIRE(cache.getStats().iEntryCount == 4);
+
+	// Sounds are deleted: "c" was used less recently than "d".
+	pC = nullptr;
+	pD = nullptr;
+	pE = nullptr;
+
+	cache.setBudget(2000);
+
+	REQUIRE(cache.find(L"c.wav", format) == nullptr);
+	REQUIRE(cache.find(L"d.wav", format) == nullptr);
+	REQUIRE(cache.find(L"e.wav", format) != nullptr);
+	REQUIRE(cache.find(L"a.wav", format) == pA);
+	REQUIRE(cache.getStats().iResidentBytes == 2000);
+
+	// Level unload.
+	cache.removeUnused();
+
+	SDecodedAudioCacheStats stats = cache.getStats();
+	REQUIRE(stats.iEntryCount == 1);
+	REQUIRE(stats.iResidentBytes == 1000);
+	REQUIRE(stats.iBudgetInBytes == 2000);
+	REQUIRE(pA->vPCMData[0] == 1);
+}
+
+TEST_CASE("Sounds load the same files from multiple threads.", "[SDecodedAudioCacheTests::threads]") {
+	SDecodedAudioCache cache;
+
+	const SDecodedAudioFormat format = makePCMFormat(2, 48000);
+
+	const size_t iThreadCount = 4;
+	const size_t iFileCount = 8;
+
+	std::vector<std::vector<std::shared_ptr<const SDecodedAudio>>> vLoadedSounds(iThreadCount);
+
+	std::vector<std::thread> vThreads;
+	for (size_t iThread = 0; iThread < iThreadCount; iThread++)
+	{
+		vThreads.push_back(std::thread([&, iThread]()
+		{
+			for (size_t i = 0; i < iFileCount * 10; i++)
+			{
+				const std::wstring sPath = L"sound" + std::to_wstring(i % iFileCount) + L".wav";
+
+				std::shared_ptr<const SDecodedAudio> pDecodedAudio = cache.find(sPath, format);
+				if (pDecodedAudio == nullptr)
+				{
+					pDecodedAudio = cache.add(sPath, format, makePCMData(256, static_cast<unsigned char>(i % iFileCount)));
+				}
+
+				vLoadedSounds[iThread].push_back(pDecodedAudio);
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < vThreads.size(); i++)
+	{
+		vThreads[i].join();
+	}
+
+	// All sounds of the same file use the same data.
+	for (size_t iThread = 0; iThread < iThreadCount; iThread++)
+	{
+		for (size_t i = 0; i < vLoadedSounds[iThread].size(); i++)
+		{
+			REQUIRE(vLoadedSounds[iThread][i] == vLoadedSounds[0][i % iFileCount]);
+			REQUIRE(vLoadedSounds[iThread][i]->vPCMData[0] == i % iFileCount);
+		}
+	}
+
+	SDecodedAudioCacheStats stats = cache.getStats();
+	REQUIRE(stats.iEntryCount == iFileCount);
+	REQUIRE(stats.iResidentBytes == iFileCount * 256);
+	REQUIRE(stats.iHitCount + stats.iMissCount == iThreadCount * iFileCount * 10);
+}
+
+TEST_CASE("Benchmark loading 300 sounds that use 30 files.", "[.][benchmark][SDecodedAudioCacheTests::benchmark]") {
+	// 2 seconds of 44.1 kHz 16 bit mono per file, decoding is simulated by generating the samples.
+	const size_t iFileCount = 30;
+	const size_t iSoundCount = 300;
+	const size_t iDecodedSizeInBytes = 44100 * 2 * 2;
+
+	const SDecodedAudioFormat format = makePCMFormat(1, 44100);
+
+	auto decode = [&](size_t iFileIndex) -> std::vector<unsigned char>
+	{
+		std::vector<unsigned char> vPCMData(iDecodedSizeInBytes);
+		uint32_t iState = static_cast<uint32_t>(iFileIndex) + 1;
+		for (size_t i = 0; i < vPCMData.size(); i++)
+		{
+			iState = iState * 1664525u + 1013904223u;
+			vPCMData[i] = static_cast<unsigned char>(iState >> 24);
+		}
+		return vPCMData;
+	};
+
+	size_t iOwnBytes = 0;
+	SDecodedAudioCacheStats stats;
+
+	// Without the cache every sound decodes its own copy.
+	BENCHMARK("own data") {
+		std::vector<std::vector<unsigned char>> vOwnData;
+		iOwnBytes = 0;
+		for (size_t i = 0; i < iSoundCount; i++)
+		{
+			vOwnData.push_back(decode(i % iFileCount));
+			iOwnBytes += vOwnData.back().size();
+		}
+
+		return vOwnData.size();
+	};
+
+	BENCHMARK("shared data") {
+		SDecodedAudioCache cache;
+
+		std::vector<std::shared_ptr<const SDecodedAudio>> vSharedData;
+		for (size_t i = 0; i < iSoundCount; i++)
+		{
+			const std::wstring sPath = L"sound" + std::to_wstring(i % iFileCount) + L".wav";
+
+			std::shared_ptr<const SDecodedAudio> pDecodedAudio = cache.find(sPath, format);
+			if (pDecodedAudio == nullptr)
+			{
+				pDecodedAudio = cache.add(sPath, format, decode(i % iFileCount));
+			}
+
+			vSharedData.push_back(pDecodedAudio);
+		}
+
+		stats = cache.getStats();
+
+		return vSharedData.size();
+	};
+
+	REQUIRE(iOwnBytes == iSoundCount * iDecodedSizeInBytes);
+	REQUIRE(stats.iResidentBytes == iFileCount * iDecodedSizeInBytes);
+	REQUIRE(stats.iMissCount == iFileCount);
+	REQUIRE(stats.iHitCount == iSoundCount - iFileCount);
+}
@@ -0,0 +1,166 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <thread>
+
+// Custom
+#include "SilentEngine/Private/SDirtyQueue/SDirtyQueue.h"
+
+struct STestDirtyObject
+{
+	int iUpdateCount = 0;
+
+	SDirtyQueueNode<STestDirtyObject> dirtyQueueNode;
+};
+
+TEST_CASE("Dirty queue stores an object only once.", "[SDirtyQueueTests::pushOnce]") {
+	SDirtyQueue<STestDirtyObject> dirtyQueue;
+
+	std::vector<STestDirtyObject> vObjects(4);
+
+	dirtyQueue.push(&vObjects[1]);
+	dirtyQueue.push(&vObjects[3]);
+	dirtyQueue.push(&vObjects[1]);
+
+	REQUIRE(dirtyQueue.getDirtyItemCount() == 0);
+	REQUIRE(dirtyQueue.collectDirtyItems().size() == 2);
+
+	// Still queued until removed.
+	dirtyQueue.push(&vObjects[3]);
+	REQUIRE(dirtyQueue.collectDirtyItems().size() == 2);
+
+	dirtyQueue.removeDirtyItem(vObjects[1].dirtyQueueNode.iDirtyItemIndex);
+
+	REQUIRE(dirtyQueue.getDirtyItemCount() == 1);
+	REQUIRE(dirtyQueue.collectDirtyItems()[0] == &vObjects[3]);
+
+	dirtyQueue.push(&vObjects[1]);
+	dirtyQueue.push(&vObjects[2]);
+
+	dirtyQueue.remove(&vObjects[2]);
+	dirtyQueue.remove(&vObjects[0]);
+
+	const std::vector<STestDirtyObject*>& vDirtyItems = dirtyQueue.collectDirtyItems();
+
+	REQUIRE(vDirtyItems.size() == 2);
+	REQUIRE(vObjects[2].dirtyQueueNode.bQueued == false);
+
+	for (size_t i = 0; i < vDirtyItems.size(); i++)
+	{
+		REQUIRE(vDirtyItems[i]->dirtyQueueNode.iDirtyItemIndex == i);
+	}
+}
+
+TEST_CASE("Dirty queue collects objects pushed from multiple threads.", "[SDirtyQueueTests::concurrentPush]") {
+	SDirtyQueue<STestDirtyObject> dirtyQueue;
+
+	const size_t iThreadCount = 4;
+	const size_t iObjectsPerThread = 10000;
+
+	std::vector<STestDirtyObject> vObjects(iThreadCount * iObjectsPerThread);
+
+	std::vector<std::thread> vThreads;
+
+	for (size_t i = 0; i < iThreadCount; i++)
+	{
+		vThreads.push_back(std::thread([&dirtyQueue, &vObjects, i, iThreadCount, iObjectsPerThread]() {
+			// Every thread pushes every object once, so each object is pushed from all threads.
+			for (size_t j = 0; j < vObjects.size(); j++)
+			{
+				dirtyQueue.push(&vObjects[(j + i * iObjectsPerThread) % vObjects.size()]);
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < vThreads.size(); i++)
+	{
+		vThreads[i].join();
+	}
+
+	const std::vector<STestDirtyObject*>& vDirtyItems = dirtyQueue.collectDirtyItems();
+
+	REQUIRE(vDirtyItems.size() == vObjects.size());
+
+	for (size_t i = 0; i < vDirtyItems.size(); i++)
+	{
+		vDirtyItems[i]->iUpdateCount++;
+	}
+
+	for (size_t i = 0; i < vObjects.size(); i++)
+	{
+		REQUIRE(vObjects[i].iUpdateCount == 1);
+	}
+}
+
+TEST_CASE("Benchmark per-frame update of 1% changed objects.", "[.][benchmark][SDirtyQueueTests::benchmarkUpdate]") {
+	const size_t iObjectCount = 100000;
+	const size_t iChangedPerFrame = iObjectCount / 100;
+
+	std::vector<STestDirtyObject> vObjects(iObjectCount);
+
+	SDirtyQueue<STestDirtyObject> dirtyQueue;
+
+	size_t iFrame = 0;
+
+	BENCHMARK("scan all objects") {
+		iFrame++;
+
+		for (size_t i = 0; i < iChangedPerFrame; i++)
+		{
+			vObjects[(iFrame * 7919 + i * 97) % iObjectCount].iUpdateCount = 1;
+		}
+
+		size_t iUpdated = 0;
+
+		for (size_t i = 0; i < vObjects.size(); i++)
+		{
+			if (vObjects[i].iUpdateCount > 0)
+			{
+				vObjects[i].iUpdateCount--;
+				iUpdated++;
+			}
+		}
+
+		return iUpdated;
+	};
+
+	BENCHMARK("dirty queue") {
+		iFrame++;
+
+		for (size_t i = 0; i < iChangedPerFrame; i++)
+		{
+			STestDirtyObject* pObject = &vObjects[(iFrame * 7919 + i * 97) % iObjectCount];
+
+			pObject->iUpdateCount = 1;
+			dirtyQueue.push(pObject);
+		}
+
+		const std::vector<STestDirtyObject*>& vDirtyItems = dirtyQueue.collectDirtyItems();
+
+		size_t iUpdated = 0;
+
+		for (size_t i = 0; i < vDirtyItems.size(); )
+		{
+			vDirtyItems[i]->iUpdateCount--;
+			iUpdated++;
+
+			if (vDirtyItems[i]->iUpdateCount <= 0)
+			{
+				dirtyQueue.removeDirtyItem(i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+
+		return iUpdated;
+	};
+}
@@ -0,0 +1,206 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <filesystem>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+
+// Custom
+#include "SilentEngine/Public/FileImport/SFormatOBJImporter/SFormatOBJImporter.h"
+#include "SilentEngine/Public/FileImport/SFormatCookedMesh/SFormatCookedMesh.h"
+
+namespace fs = std::filesystem;
+
+TEST_CASE("Cooked mesh keeps the imported mesh data.", "[SFormatCookedMeshTests::writeReadCookedMesh]") {
+	const std::wstring sPathToOBJ = L"../ide/sample_data/suzanne.obj";
+	const std::wstring sPathToCooked = (fs::temp_directory_path() / "silent_suzanne.smesh").wstring();
+
+	SMeshData meshData;
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFile(sPathToOBJ, &meshData, true, true) == false);
+
+	std::vector<SCookedMeshLOD> vLODs(1);
+	vLODs[0].iIndexCount = 3;
+	vLODs[0].fMaxViewDistance = 100.0f;
+
+	REQUIRE(SFormatCookedMesh::writeMeshDataToFile(sPathToCooked, &meshData, &vLODs) == false);
+
+	SMeshData cookedMeshData;
+	DirectX::BoundingBox bounds;
+	std::vector<SCookedMeshLOD> vCookedLODs;
+	REQUIRE(SFormatCookedMesh::importMeshDataFromFile(sPathToCooked, &cookedMeshData, &bounds, &vCookedLODs) == false);
+
+	REQUIRE(cookedMeshData.getVertices()->size() == meshData.getVertices()->size());
+	REQUIRE(std::memcmp(cookedMeshData.getVertices()->data(), meshData.getVertices()->data(), meshData.getVertices()->size() * sizeof(SMeshVertex)) == 0);
+
+	REQUIRE(vCookedLODs.size() == 1);
+	REQUIRE(vCookedLODs[0].iIndexCount == 3);
+	REQUIRE(vCookedLODs[0].fMaxViewDistance == Approx(100.0f));
+
+	for (size_t i = 0; i < meshData.getVertices()->size(); i++)
+	{
+		SVector vPos = meshData.getVertexAt(i).getPosition();
+
+		REQUIRE(std::abs(vPos.getX() - bounds.Center.x) <= bounds.Extents.x + 0.0001f);
+		REQUIRE(std::abs(vPos.getY() - bounds.Center.y) <= bounds.Extents.y + 0.0001f);
+		REQUIRE(std::abs(vPos.getZ() - bounds.Center.z) <= bounds.Extents.z + 0.0001f);
+	}
+
+	fs::remove(sPathToCooked);
+}
+
+TEST_CASE("Cooked mesh cache is used when the source file is not changed.", "[SFormatCookedMeshTests::cookedMeshCache]") {
+	const std::wstring sPathToOBJ = L"../ide/sample_data/floor.obj";
+	const fs::path pathToCache = fs::temp_directory_path() / "silent_cooked_mesh_cache";
+
+	fs::remove_all(pathToCache);
+
+	SMeshData meshData;
+	bool bLoadedFromCache = true;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+
+	SMeshData cachedMeshData;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &cachedMeshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache);
+
+	REQUIRE(cachedMeshData.getVertices()->size() == meshData.getVertices()->size());
+
+	// Different import settings should not use the same cooked file.
+	SMeshData notWeldedMeshData;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &notWeldedMeshData, true, false, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+
+	fs::remove_all(pathToCache);
+}
+
+TEST_CASE("Cooked mesh keeps the indices and LODs.", "[SFormatCookedMeshTests::writeReadIndicesAndLODs]") {
+	const std::wstring sPathToCooked = (fs::temp_directory_path() / "silent_indices.smesh").wstring();
+
+	// 16 bit and 32 bit indices.
+	for (size_t iVertexCount : { 300, 70000 })
+	{
+		SMeshData meshData;
+
+		for (size_t i = 0; i < iVertexCount; i++)
+		{
+			meshData.addVertex(SMeshVertex(SVector(static_cast<float>(i), 0.0f, 0.0f), SVector(0.0f, 0.0f, 1.0f), SVector(), SVector(0.0f, 0.0f)));
+		}
+
+		for (size_t i = 0; i + 2 < iVertexCount; i++)
+		{
+			// Reversed order so that indices differ from their positions.
+			meshData.addIndex(static_cast<std::uint32_t>(iVertexCount - 1 - i));
+			meshData.addIndex(static_cast<std::uint32_t>(iVertexCount - 2 - i));
+			meshData.addIndex(static_cast<std::uint32_t>(iVertexCount - 3 - i));
+		}
+
+		REQUIRE(meshData.hasIndicesMoreThan16Bits() == (iVertexCount > 65536));
+
+		const std::uint32_t iIndexCount = static_cast<std::uint32_t>(meshData.getIndicesCount());
+
+		std::vector<SCookedMeshLOD> vLODs(2);
+		vLODs[0].iFirstIndex = 0;
+		vLODs[0].iIndexCount = iIndexCount;
+		vLODs[0].fMaxViewDistance = 50.0f;
+		vLODs[1].iFirstIndex = iIndexCount - 30;
+		vLODs[1].iIndexCount = 30;
+		vLODs[1].fMaxViewDistance = 200.0f;
+
+		REQUIRE(SFormatCookedMesh::writeMeshDataToFile(sPathToCooked, &meshData, &vLODs) == false);
+
+		SMeshData cookedMeshData;
+		std::vector<SCookedMeshLOD> vCookedLODs;
+		REQUIRE(SFormatCookedMesh::importMeshDataFromFile(sPathToCooked, &cookedMeshData, nullptr, &vCookedLODs) == false);
+
+		REQUIRE(cookedMeshData.getVerticesCount() == iVertexCount);
+		REQUIRE(*cookedMeshData.getIndices32() == *meshData.getIndices32());
+		REQUIRE(cookedMeshData.hasIndicesMoreThan16Bits() == meshData.hasIndicesMoreThan16Bits());
+
+		if (cookedMeshData.hasIndicesMoreThan16Bits() == false)
+		{
+			REQUIRE(*cookedMeshData.getIndices16() == *meshData.getIndices16());
+		}
+
+		REQUIRE(vCookedLODs.size() == 2);
+
+		for (size_t i = 0; i < vLODs.size(); i++)
+		{
+			REQUIRE(vCookedLODs[i].iFirstIndex == vLODs[i].iFirstIndex);
+			REQUIRE(vCookedLODs[i].iIndexCount == vLODs[i].iIndexCount);
+			REQUIRE(vCookedLODs[i].fMaxViewDistance == vLODs[i].fMaxViewDistance);
+		}
+	}
+
+	fs::remove(sPathToCooked);
+}
+
+TEST_CASE("Cooked mesh cache is cooked again when the source file is newer.", "[SFormatCookedMeshTests::cookedMeshCacheSourceChanged]") {
+	const fs::path pathToCache = fs::temp_directory_path() / "silent_cooked_mesh_cache_changed";
+	const fs::path pathToOBJ = fs::temp_directory_path() / "silent_cooked_mesh_source.obj";
+
+	fs::remove_all(pathToCache);
+	fs::copy_file(L"../ide/sample_data/floor.obj", pathToOBJ, fs::copy_options::overwrite_existing);
+
+	SMeshData meshData;
+	bool bLoadedFromCache = true;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(pathToOBJ.wstring(), pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(pathToOBJ.wstring(), pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache);
+
+	// Same size, newer.
+	fs::last_write_time(pathToOBJ, fs::last_write_time(pathToOBJ) + std::chrono::hours(1));
+
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(pathToOBJ.wstring(), pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(pathToOBJ.wstring(), pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache);
+
+	fs::remove_all(pathToCache);
+	fs::remove(pathToOBJ);
+}
+
+TEST_CASE("Corrupted cooked mesh cache is cooked again.", "[SFormatCookedMeshTests::cookedMeshCacheCorrupted]") {
+	const std::wstring sPathToOBJ = L"../ide/sample_data/suzanne.obj";
+	const fs::path pathToCache = fs::temp_directory_path() / "silent_cooked_mesh_cache_corrupted";
+
+	fs::remove_all(pathToCache);
+
+	SMeshData meshData;
+	bool bLoadedFromCache = true;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &meshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+
+	fs::path pathToCooked;
+	for (const auto& entry : fs::directory_iterator(pathToCache))
+	{
+		pathToCooked = entry.path();
+	}
+	REQUIRE(pathToCooked.extension() == ".smesh");
+
+	// The header is valid but the body is truncated.
+	fs::resize_file(pathToCooked, fs::file_size(pathToCooked) / 2);
+
+	SMeshData recookedMeshData;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &recookedMeshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache == false);
+	REQUIRE(*recookedMeshData.getIndices32() == *meshData.getIndices32());
+
+	// Cooked again.
+	SMeshData cachedMeshData;
+	REQUIRE(SFormatCookedMesh::importOBJMeshDataUsingCache(sPathToOBJ, pathToCache.wstring(), &cachedMeshData, true, true, &bLoadedFromCache) == false);
+	REQUIRE(bLoadedFromCache);
+	REQUIRE(*cachedMeshData.getIndices32() == *meshData.getIndices32());
+
+	fs::remove_all(pathToCache);
+}
@@ -0,0 +1,264 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <fstream>
+#include <filesystem>
+
+// Custom
+#include "SilentEngine/Public/FileImport/SFormatOBJImporter/SFormatOBJImporter.h"
+
+namespace fs = std::filesystem;
+
+static const std::vector<std::wstring> vSampleMeshes = {
+	L"../ide/sample_data/suzanne.obj",
+	L"../ide/sample_data/floor.obj",
+	L"../ide/sample_data/skyboxMesh.obj"
+};
+
+// Writes a grid of 'iSideQuadCount' x 'iSideQuadCount' quads (2 triangles each), rows of vertices are followed by
+// the faces that use them, all faces share one normal (written first). A few faces at the end of the file use the first vertices.
+// If 'bRelativeIndices' is true faces use negative (relative) indices, the mesh is the same.
+static std::wstring writeSyntheticOBJ(size_t iSideQuadCount, bool bRelativeIndices = false)
+{
+	const fs::path pathToFile = fs::temp_directory_path() /
+		("silent_synthetic_" + std::to_string(iSideQuadCount) + (bRelativeIndices ? "_relative" : "") + ".obj");
+
+	// Always rewritten (a file left by an older version of this test may differ).
+	std::ofstream file(pathToFile, std::ios::trunc);
+
+	const size_t iSideVertexCount = iSideQuadCount + 1;
+
+	// Number of 'v' (and 'vt') lines written so far.
+	size_t iWrittenVertexCount = 0;
+
+	auto writeRow = [&](size_t y)
+	{
+		for (size_t x = 0; x < iSideVertexCount; x++)
+		{
+			file << "v " << x * 0.01f << " " << y * 0.01f << " 0.0\n";
+			file << "vt " << static_cast<float>(x) / iSideQuadCount << " " << static_cast<float>(y) / iSideQuadCount << "\n";
+		}
+
+		iWrittenVertexCount += iSideVertexCount;
+	};
+
+	// 'iIndex' starts from 1.
+	auto writeCorner = [&](size_t iIndex)
+	{
+		if (bRelativeIndices)
+		{
+			const long long iRelativeIndex = static_cast<long long>(iIndex) - static_cast<long long>(iWrittenVertexCount) - 1;
+
+			file << " " << iRelativeIndex << "/" << iRelativeIndex << "/-1";
+		}
+		else
+		{
+			file << " " << iIndex << "/" << iIndex << "/1";
+		}
+	};
+
+	auto writeFace = [&](size_t a, size_t b, size_t c)
+	{
+		file << "f";
+		writeCorner(a);
+		writeCorner(b);
+		writeCorner(c);
+		file << "\n";
+	};
+
+	file << "vn 0.0 0.0 1.0\n";
+
+	writeRow(0);
+
+	for (size_t y = 0; y < iSideQuadCount; y++)
+	{
+		writeRow(y + 1);
+
+		for (size_t x = 0; x < iSideQuadCount; x++)
+		{
+			const size_t a = y * iSideVertexCount + x + 1;
+			const size_t b = a + 1;
+			const size_t c = a + iSideVertexCount;
+			const size_t d = c + 1;
+
+			writeFace(a, b, c);
+			writeFace(b, d, c);
+		}
+	}
+
+	// Far from the chunk that has these vertices.
+	for (size_t x = 0; x < iSideQuadCount; x++)
+	{
+		writeFace(x + 1, x + 2, x + 1 + iSideVertexCount);
+	}
+
+	file.close();
+
+	return pathToFile.wstring();
+}
+
+static bool isSameVertex(SMeshVertex a, SMeshVertex b)
+{
+	return a.getPosition().getX() == Approx(b.getPosition().getX()) &&
+		a.getPosition().getY() == Approx(b.getPosition().getY()) &&
+		a.getPosition().getZ() == Approx(b.getPosition().getZ()) &&
+		a.getNormal().getX() == Approx(b.getNormal().getX()) &&
+		a.getNormal().getY() == Approx(b.getNormal().getY()) &&
+		a.getNormal().getZ() == Approx(b.getNormal().getZ()) &&
+		a.getUV().getX() == Approx(b.getUV().getX()) &&
+		a.getUV().getY() == Approx(b.getUV().getY());
+}
+
+static bool isSameMeshData(SMeshData& meshA, SMeshData& meshB)
+{
+	if (meshA.getVertices()->size() != meshB.getVertices()->size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < meshA.getVertices()->size(); i++)
+	{
+		if (isSameVertex(meshA.getVertexAt(i), meshB.getVertexAt(i)) == false)
+		{
+			return false;
+		}
+	}
+
+	if (*meshA.getIndices32() != *meshB.getIndices32())
+	{
+		return false;
+	}
+
+	return meshA.hasIndicesMoreThan16Bits() == meshB.hasIndicesMoreThan16Bits();
+}
+
+TEST_CASE("Parallel OBJ import produces the same mesh as the line by line import.", "[SFormatOBJImporterTests::parallelImportMatchesImport]") {
+	for (size_t i = 0; i < vSampleMeshes.size(); i++)
+	{
+		SMeshData meshData;
+		SMeshData meshDataParallel;
+
+		REQUIRE(SFormatOBJImporter::importMeshDataFromFile(vSampleMeshes[i], &meshData) == false);
+
+		// Sample meshes are smaller than the minimum chunk size (parsed as one chunk).
+		REQUIRE(SFormatOBJImporter::importMeshDataFromFileParallel(vSampleMeshes[i], &meshDataParallel, true, 4) == false);
+
+		REQUIRE(isSameMeshData(meshData, meshDataParallel));
+	}
+}
+
+TEST_CASE("Parallel OBJ import merges chunks and resolves relative indices.", "[SFormatOBJImporterTests::parallelImportChunks]") {
+	const std::wstring sMesh = writeSyntheticOBJ(150);
+	const std::wstring sMeshRelative = writeSyntheticOBJ(150, true);
+
+	// Large enough to be split into 4 chunks (see the minimum chunk size in importMeshDataFromFileParallel()).
+	REQUIRE(fs::file_size(sMesh) > 4 * 256 * 1024);
+	REQUIRE(fs::file_size(sMeshRelative) > 4 * 256 * 1024);
+
+	// The line by line import does not support relative indices.
+	SMeshData meshData;
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFile(sMesh, &meshData) == false);
+	REQUIRE(meshData.getIndicesCount() == (150 * 150 * 2 + 150) * 3);
+
+	SMeshData meshDataParallel;
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFileParallel(sMesh, &meshDataParallel, true, 4) == false);
+	REQUIRE(isSameMeshData(meshData, meshDataParallel));
+
+	SMeshData meshDataRelative;
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFileParallel(sMeshRelative, &meshDataRelative, true, 4) == false);
+	REQUIRE(isSameMeshData(meshData, meshDataRelative));
+
+
+	// Welding sees corners of all chunks.
+
+	SMeshData meshDataWelded;
+	SMeshData meshDataWeldedRelative;
+
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFile(sMesh, &meshDataWelded, true, true) == false);
+	REQUIRE(SFormatOBJImporter::importMeshDataFromFileParallel(sMeshRelative, &meshDataWeldedRelative, true, 4, true) == false);
+
+	REQUIRE(meshDataWelded.getVerticesCount() == 151 * 151);
+	REQUIRE(isSameMeshData(meshDataWelded, meshDataWeldedRelative));
+}
+
+TEST_CASE("Vertex welding keeps only unique vertices.", "[SFormatOBJImporterTests::weldVertices]") {
+	for (size_t i = 0; i < vSampleMeshes.size(); i++)
+	{
+		SMeshData meshData;
+		SMeshData meshDataWelded;
+		SMeshData meshDataWeldedParallel;
+
+		SMeshWeldStats stats;
+		SMeshWeldStats statsParallel;
+
+		REQUIRE(SFormatOBJImporter::importMeshDataFromFile(vSampleMeshes[i], &meshData) == false);
+		REQUIRE(SFormatOBJImporter::importMeshDataFromFile(vSampleMeshes[i], &meshDataWelded, true, true, &stats) == false);
+		REQUIRE(SFormatOBJImporter::importMeshDataFromFileParallel(vSampleMeshes[i], &meshDataWeldedParallel, true, 4, true, &statsParallel) == false);
+
+		REQUIRE(stats.iVertexCountBeforeWeld == meshData.getVertices()->size());
+		REQUIRE(stats.iVertexCountAfterWeld == meshDataWelded.getVertices()->size());
+		REQUIRE(stats.iVertexCountAfterWeld < stats.iVertexCountBeforeWeld);
+
+		// Both import paths should weld in the same order.
+		REQUIRE(statsParallel.iVertexCountBeforeWeld == stats.iVertexCountBeforeWeld);
+		REQUIRE(statsParallel.iVertexCountAfterWeld == stats.iVertexCountAfterWeld);
+		REQUIRE(isSameMeshData(meshDataWelded, meshDataWeldedParallel));
+
+		// Expanding the welded mesh gives the original triangles (one vertex per index).
+		REQUIRE(meshDataWelded.getIndicesCount() == meshData.getVerticesCount());
+
+		for (size_t j = 0; j < meshDataWelded.getIndicesCount(); j++)
+		{
+			const std::uint32_t iIndex = meshDataWelded.getIndexAt(j);
+
+			REQUIRE(iIndex < meshDataWelded.getVerticesCount());
+			REQUIRE(isSameVertex(meshDataWelded.getVertexAt(iIndex), meshData.getVertexAt(j)));
+		}
+
+		// Less than 65536 vertices: 16 bit indices.
+		REQUIRE(meshDataWelded.getVerticesCount() <= static_cast<size_t>(UINT16_MAX) + 1);
+		REQUIRE(meshDataWelded.hasIndicesMoreThan16Bits() == false);
+		REQUIRE(meshDataWeldedParallel.hasIndicesMoreThan16Bits() == false);
+	}
+}
+
+TEST_CASE("Benchmark OBJ import.", "[.][benchmark][SFormatOBJImporterTests::benchmarkImport]") {
+	for (size_t i = 0; i < vSampleMeshes.size(); i++)
+	{
+		const std::string sName = fs::path(vSampleMeshes[i]).filename().string();
+
+		BENCHMARK("importMeshDataFromFile: " + sName)
+		{
+			SMeshData meshData;
+			return SFormatOBJImporter::importMeshDataFromFile(vSampleMeshes[i], &meshData);
+		};
+
+		BENCHMARK("importMeshDataFromFileParallel: " + sName)
+		{
+			SMeshData meshData;
+			return SFormatOBJImporter::importMeshDataFromFileParallel(vSampleMeshes[i], &meshData);
+		};
+	}
+
+	// About 2 million triangles.
+	const std::wstring sSyntheticMesh = writeSyntheticOBJ(1000);
+
+	BENCHMARK("importMeshDataFromFile: synthetic 2M triangles")
+	{
+		SMeshData meshData;
+		return SFormatOBJImporter::importMeshDataFromFile(sSyntheticMesh, &meshData);
+	};
+
+	BENCHMARK("importMeshDataFromFileParallel: synthetic 2M triangles")
+	{
+		SMeshData meshData;
+		return SFormatOBJImporter::importMeshDataFromFileParallel(sSyntheticMesh, &meshData);
+	};
+}
@@ -0,0 +1,377 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <cmath>
+#include <cstring>
+
+// Custom
+#include "SilentEngine/Private/SFrustumCuller/SFrustumCuller.h"
+
+static void createBoxPlanes(float fHalfSize, SFrustumPlanes& outPlanes)
+{
+	// Axis aligned box [-fHalfSize, fHalfSize] as a "frustum", normals point outside.
+
+	const float vNormals[6][3] = { {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1} };
+
+	for (size_t i = 0; i < 6; i++)
+	{
+		outPlanes.vNormalX[i]  = vNormals[i][0];
+		outPlanes.vNormalY[i]  = vNormals[i][1];
+		outPlanes.vNormalZ[i]  = vNormals[i][2];
+		outPlanes.vDistance[i] = -fHalfSize;
+	}
+}
+
+static DirectX::XMFLOAT4X4 createTranslationScale(float fX, float fY, float fZ, float fScale)
+{
+	return DirectX::XMFLOAT4X4(
+		fScale, 0.0f,   0.0f,   0.0f,
+		0.0f,   fScale, 0.0f,   0.0f,
+		0.0f,   0.0f,   fScale, 0.0f,
+		fX,     fY,     fZ,     1.0f);
+}
+
+static float getPseudoRandom(size_t& iState, float fMin, float fMax)
+{
+	iState = iState * 6364136223846793005ULL + 1442695040888963407ULL;
+
+	return fMin + (fMax - fMin) * static_cast<float>((iState >> 40) & 0xFFFF) / 65535.0f;
+}
+
+static void fillRandomBounds(size_t iCount, SCullBounds& bounds, std::vector<DirectX::XMFLOAT4X4>& vOutWorld)
+{
+	DirectX::BoundingBox localBox;
+	localBox.Center  = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	localBox.Extents = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+
+	size_t iState = 42;
+
+	for (size_t i = 0; i < iCount; i++)
+	{
+		vOutWorld.push_back(createTranslationScale(getPseudoRandom(iState, -100.0f, 100.0f), getPseudoRandom(iState, -100.0f, 100.0f),
+			getPseudoRandom(iState, -100.0f, 100.0f), getPseudoRandom(iState, 0.5f, 3.0f)));
+
+		bounds.set(bounds.add(), localBox, vOutWorld.back(), 0.0f);
+	}
+}
+
+static bool isBoxVisible(float fHalfSize, const DirectX::XMFLOAT4X4& vWorld)
+{
+	// Reference: unit box with uniform scale and translation against the axis aligned "frustum".
+
+	const float fExtent = vWorld._11;
+	const float vCenter[3] = { vWorld._41, vWorld._42, vWorld._43 };
+
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (std::fabs(vCenter[i]) - fExtent > fHalfSize)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+TEST_CASE("Frustum culler outputs the same visible bounds as the reference test.", "[SFrustumCullerTests::visibleBounds]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(50.0f, planes);
+
+	SCullBounds bounds;
+	std::vector<DirectX::XMFLOAT4X4> vWorld;
+
+	// Not a multiple of 4 to also test the scalar tail.
+	fillRandomBounds(1003, bounds, vWorld);
+
+	std::vector<uint32_t> vVisibleIndices;
+	SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, 0, bounds.size(), vVisibleIndices);
+
+	std::vector<uint32_t> vExpectedIndices;
+	for (size_t i = 0; i < vWorld.size(); i++)
+	{
+		if (isBoxVisible(50.0f, vWorld[i]))
+		{
+			vExpectedIndices.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	REQUIRE(vExpectedIndices.empty() == false);
+	REQUIRE(vExpectedIndices.size() < vWorld.size());
+	REQUIRE(vVisibleIndices == vExpectedIndices);
+}
+
+TEST_CASE("Frustum culler culls bounds by distance.", "[SFrustumCullerTests::cullDistance]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(1000.0f, planes);
+
+	DirectX::BoundingBox localBox;
+	localBox.Center  = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+	localBox.Extents = DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f);
+
+	SCullBounds bounds;
+
+	bounds.set(bounds.add(), localBox, createTranslationScale(10.0f, 0.0f, 0.0f, 1.0f), 20.0f); // visible
+	bounds.set(bounds.add(), localBox, createTranslationScale(30.0f, 0.0f, 0.0f, 1.0f), 20.0f); // too far
+	bounds.set(bounds.add(), localBox, createTranslationScale(500.0f, 0.0f, 0.0f, 1.0f), 0.0f); // no cull distance
+	bounds.set(bounds.add(), localBox, createTranslationScale(500.0f, 0.0f, 0.0f, 1.0f), -1.0f); // no cull distance
+	bounds.set(bounds.add(), localBox, createTranslationScale(0.0f, 30.0f, 0.0f, 1.0f), 20.0f); // too far (scalar tail)
+
+	std::vector<uint32_t> vVisibleIndices;
+	SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, 0, bounds.size(), vVisibleIndices);
+
+	REQUIRE(vVisibleIndices == std::vector<uint32_t>{ 0, 2, 3 });
+
+	// Remove the first bounds so the last bounds are moved to index 0.
+
+	bounds.removeSwap(0);
+
+	vVisibleIndices.clear();
+	SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 25.0f, 0.0f), bounds, 0, bounds.size(), vVisibleIndices);
+
+	REQUIRE(bounds.size() == 4);
+	REQUIRE(vVisibleIndices == std::vector<uint32_t>{ 0, 2, 3 });
+}
+
+TEST_CASE("Frustum culler outputs the same result using worker threads.", "[SFrustumCullerTests::workerThreads]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(50.0f, planes);
+
+	SCullBounds bounds;
+	std::vector<DirectX::XMFLOAT4X4> vWorld;
+
+	fillRandomBounds(SFrustumCuller::iMinBoundsPerJob * 4 + 7, bounds, vWorld);
+
+	std::vector<uint32_t> vExpectedIndices;
+	SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, 0, bounds.size(), vExpectedIndices);
+
+	SFrustumCuller frustumCuller(3);
+
+	REQUIRE(frustumCuller.getWorkerCount() == 3);
+
+	std::vector<uint32_t> vVisibleIndices;
+
+	// Run a few times to reuse the workers.
+	for (size_t i = 0; i < 3; i++)
+	{
+		frustumCuller.cull(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, vVisibleIndices);
+
+		REQUIRE(vVisibleIndices == vExpectedIndices);
+	}
+}
+
+struct STestInstanceData
+{
+	uint32_t iInstanceIndex;
+	float    vPadding[31]; // about the size of the real instance data
+};
+
+static void cullInstancesReference(const SFrustumPlanes& planes, const SCullBounds& bounds, const std::vector<DirectX::XMFLOAT4X4>& vWorld,
+	const std::vector<float>& vLODDistances, std::vector<uint32_t>& vOutInstanceIndices, std::vector<size_t>& vOutLODInstanceCounts)
+{
+	std::vector<uint32_t> vVisibleIndices;
+	SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, 0, bounds.size(), vVisibleIndices);
+
+	vOutInstanceIndices.clear();
+	vOutLODInstanceCounts.assign(vLODDistances.size() + 1, 0);
+
+	for (size_t iLOD = 0; iLOD <= vLODDistances.size(); iLOD++)
+	{
+		for (size_t i = 0; i < vVisibleIndices.size(); i++)
+		{
+			const DirectX::XMFLOAT4X4& vInstanceWorld = vWorld[vVisibleIndices[i]];
+			const float fDistanceSquared = vInstanceWorld._41 * vInstanceWorld._41 + vInstanceWorld._42 * vInstanceWorld._42
+				+ vInstanceWorld._43 * vInstanceWorld._43;
+
+			size_t iInstanceLOD = 0;
+			while (iInstanceLOD < vLODDistances.size() && fDistanceSquared >= vLODDistances[iInstanceLOD] * vLODDistances[iInstanceLOD])
+			{
+				iInstanceLOD++;
+			}
+
+			if (iInstanceLOD == iLOD)
+			{
+				vOutInstanceIndices.push_back(vVisibleIndices[i]);
+				vOutLODInstanceCounts[iLOD]++;
+			}
+		}
+	}
+}
+
+TEST_CASE("Instance culling outputs compacted data of the visible instances grouped by LOD.", "[SFrustumCullerTests::cullInstances]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(50.0f, planes);
+
+	SCullBounds bounds;
+	std::vector<DirectX::XMFLOAT4X4> vWorld;
+
+	// Big enough to be split between the threads, not a multiple of 4.
+	fillRandomBounds(SFrustumCuller::iMinBoundsPerJob * 4 + 7, bounds, vWorld);
+
+	std::vector<STestInstanceData> vInstanceData(bounds.size());
+	for (size_t i = 0; i < vInstanceData.size(); i++)
+	{
+		vInstanceData[i].iInstanceIndex = static_cast<uint32_t>(i);
+	}
+
+	// LOD distances are not far from the distance to the box centers to also test distances close to the LOD switch.
+	const std::vector<std::vector<float>> vLODDistancesToTest = { {}, { 30.0f }, { 20.0f, 40.0f, 60.0f } };
+
+	SFrustumCuller frustumCuller(3);
+
+	for (size_t iTest = 0; iTest < vLODDistancesToTest.size(); iTest++)
+	{
+		const std::vector<float>& vLODDistances = vLODDistancesToTest[iTest];
+
+		std::vector<uint32_t> vExpectedIndices;
+		std::vector<size_t>   vExpectedLODCounts;
+		cullInstancesReference(planes, bounds, vWorld, vLODDistances, vExpectedIndices, vExpectedLODCounts);
+
+		REQUIRE(vExpectedIndices.empty() == false);
+
+		std::vector<STestInstanceData> vOutData(vInstanceData.size());
+		std::vector<size_t> vLODCounts;
+
+		const size_t iVisibleCount = frustumCuller.cullInstances(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, vLODDistances,
+			vInstanceData.data(), sizeof(STestInstanceData), vOutData.data(), vOutData.size() * sizeof(STestInstanceData), vLODCounts);
+
+		REQUIRE(iVisibleCount == vExpectedIndices.size());
+		REQUIRE(vLODCounts == vExpectedLODCounts);
+
+		std::vector<uint32_t> vOutIndices;
+		for (size_t i = 0; i < iVisibleCount; i++)
+		{
+			vOutIndices.push_back(vOutData[i].iInstanceIndex);
+		}
+
+		REQUIRE(vOutIndices == vExpectedIndices);
+	}
+
+	// Small arrays are culled on the calling thread.
+
+	SCullBounds smallBounds;
+	std::vector<DirectX::XMFLOAT4X4> vSmallWorld;
+	fillRandomBounds(101, smallBounds, vSmallWorld);
+
+	std::vector<uint32_t> vExpectedIndices;
+	std::vector<size_t>   vExpectedLODCounts;
+	cullInstancesReference(planes, smallBounds, vSmallWorld, { 30.0f }, vExpectedIndices, vExpectedLODCounts);
+
+	std::vector<STestInstanceData> vOutData(smallBounds.size());
+	std::vector<size_t> vLODCounts;
+
+	const size_t iVisibleCount = frustumCuller.cullInstances(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), smallBounds, { 30.0f },
+		vInstanceData.data(), sizeof(STestInstanceData), vOutData.data(), vOutData.size() * sizeof(STestInstanceData), vLODCounts);
+
+	REQUIRE(iVisibleCount == vExpectedIndices.size());
+	REQUIRE(vLODCounts == vExpectedLODCounts);
+
+	for (size_t i = 0; i < iVisibleCount; i++)
+	{
+		REQUIRE(vOutData[i].iInstanceIndex == vExpectedIndices[i]);
+	}
+
+	// Output buffer smaller than the bounds: only the instances that fit are culled.
+
+	std::vector<STestInstanceData> vSmallOutData(smallBounds.size() / 2);
+
+	const size_t iSmallOutVisibleCount = frustumCuller.cullInstances(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), smallBounds, { 30.0f },
+		vInstanceData.data(), sizeof(STestInstanceData), vSmallOutData.data(), vSmallOutData.size() * sizeof(STestInstanceData), vLODCounts);
+
+	size_t iExpectedSmallOutVisibleCount = 0;
+	for (size_t i = 0; i < vExpectedIndices.size(); i++)
+	{
+		if (vExpectedIndices[i] < vSmallOutData.size())
+		{
+			iExpectedSmallOutVisibleCount++;
+		}
+	}
+
+	REQUIRE(iSmallOutVisibleCount == iExpectedSmallOutVisibleCount);
+
+	for (size_t i = 0; i < iSmallOutVisibleCount; i++)
+	{
+		REQUIRE(vSmallOutData[i].iInstanceIndex < vSmallOutData.size());
+	}
+}
+
+TEST_CASE("Benchmark frustum culling of 100k bounds.", "[.][benchmark][SFrustumCullerTests::benchmarkCull]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(50.0f, planes);
+
+	SCullBounds bounds;
+	std::vector<DirectX::XMFLOAT4X4> vWorld;
+
+	fillRandomBounds(100000, bounds, vWorld);
+
+	SFrustumCuller frustumCuller;
+
+	std::vector<uint32_t> vVisibleIndices;
+
+	BENCHMARK("scalar reference") {
+		size_t iVisibleCount = 0;
+
+		for (size_t i = 0; i < vWorld.size(); i++)
+		{
+			if (isBoxVisible(50.0f, vWorld[i]))
+			{
+				iVisibleCount++;
+			}
+		}
+
+		return iVisibleCount;
+	};
+
+	BENCHMARK("SSE, one thread") {
+		vVisibleIndices.clear();
+		SFrustumCuller::cullRange(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, 0, bounds.size(), vVisibleIndices);
+
+		return vVisibleIndices.size();
+	};
+
+	BENCHMARK("SSE, worker threads") {
+		frustumCuller.cull(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, vVisibleIndices);
+
+		return vVisibleIndices.size();
+	};
+}
+
+TEST_CASE("Benchmark culling of 50k instances.", "[.][benchmark][SFrustumCullerTests::benchmarkCullInstances]") {
+	SFrustumPlanes planes;
+	createBoxPlanes(50.0f, planes);
+
+	SCullBounds bounds;
+	std::vector<DirectX::XMFLOAT4X4> vWorld;
+
+	fillRandomBounds(50000, bounds, vWorld);
+
+	std::vector<STestInstanceData> vInstanceData(bounds.size());
+	std::vector<STestInstanceData> vOutData(bounds.size());
+
+	SFrustumCuller frustumCuller;
+
+	std::vector<uint32_t> vVisibleIndices;
+	std::vector<size_t> vLODCounts;
+
+	BENCHMARK("cull, then copy each instance") {
+		frustumCuller.cull(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, vVisibleIndices);
+
+		for (size_t i = 0; i < vVisibleIndices.size(); i++)
+		{
+			std::memcpy(&vOutData[i], &vInstanceData[vVisibleIndices[i]], sizeof(STestInstanceData));
+		}
+
+		return vVisibleIndices.size();
+	};
+
+	BENCHMARK("cullInstances, 3 LODs") {
+		return frustumCuller.cullInstances(planes, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), bounds, { 20.0f, 40.0f },
+			vInstanceData.data(), sizeof(STestInstanceData), vOutData.data(), vOutData.size() * sizeof(STestInstanceData), vLODCounts);
+	};
+}
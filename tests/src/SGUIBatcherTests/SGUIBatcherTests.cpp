@@ -0,0 +1,173 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// Custom
+#include "SilentEngine/Private/GUI/SGUIBatcher/SGUIBatcher.h"
+
+//@@Class
+/*
+Backend that records the calls instead of drawing.
+*/
+class SRecordingGUIBackend : public SGUIBatchBackend
+{
+public:
+	struct SBatch
+	{
+		SGUIBlendMode blendMode;
+		std::vector<uint64_t> vTextureKeys;
+		bool bEnded = false;
+	};
+
+	virtual void beginBatch(SGUIBlendMode blendMode) override
+	{
+		vBatches.push_back({ blendMode, {}, false });
+	}
+
+	virtual void drawItem(const SGUIBatchItem& item) override
+	{
+		vBatches.back().vTextureKeys.push_back(item.iTextureKey);
+	}
+
+	virtual void endBatch() override
+	{
+		vBatches.back().bEnded = true;
+	}
+
+	std::vector<SBatch> vBatches;
+};
+
+static SGUIBatchItem makeItem(uint64_t iTextureKey, SGUIBlendMode blendMode = SGUIBlendMode::SGBM_PREMULTIPLIED, size_t iSpriteCount = 1)
+{
+	SGUIBatchItem item;
+	item.iTextureKey = iTextureKey;
+	item.blendMode = blendMode;
+	item.iSpriteCount = iSpriteCount;
+
+	return item;
+}
+
+TEST_CASE("Adjacent items with the same texture are drawn together.", "[SGUIBatcherTests::mergeAdjacent]") {
+	SRecordingGUIBackend backend;
+	SGUIBatcher batcher;
+
+	batcher.beginFrame();
+
+	// 400 HUD elements using 3 textures, added in groups.
+	for (size_t i = 0; i < 400; i++)
+	{
+		batcher.addItem(makeItem(i / 150));
+	}
+
+	batcher.flushLayer(&backend);
+
+	REQUIRE(backend.vBatches.size() == 1);
+	REQUIRE(backend.vBatches[0].bEnded);
+	REQUIRE(backend.vBatches[0].vTextureKeys.size() == 400);
+
+	for (size_t i = 0; i < backend.vBatches[0].vTextureKeys.size(); i++)
+	{
+		REQUIRE(backend.vBatches[0].vTextureKeys[i] == i / 150);
+	}
+
+	SGUIBatchStats stats = batcher.getStats();
+	REQUIRE(stats.iItemCount == 400);
+	REQUIRE(stats.iBatchCount == 1);
+	REQUIRE(stats.iDrawCount == 3);
+	REQUIRE(stats.iSpriteCount == 400);
+}
+
+TEST_CASE("Overlapping items of one layer are drawn in the order in which they were added.", "[SGUIBatcherTests::order]") {
+	SRecordingGUIBackend backend;
+	SGUIBatcher batcher;
+
+	batcher.beginFrame();
+
+	// A PNG panel, text on top of it, then another PNG panel and a text on top of it.
+	batcher.addItem(makeItem(5, SGUIBlendMode::SGBM_NON_PREMULTIPLIED));
+	batcher.addItem(makeItem(1));
+	batcher.addItem(makeItem(2));
+	batcher.addItem(makeItem(5, SGUIBlendMode::SGBM_NON_PREMULTIPLIED));
+	batcher.addItem(makeItem(1));
+	batcher.flushLayer(&backend);
+
+	REQUIRE(backend.vBatches.size() == 4);
+
+	REQUIRE(backend.vBatches[0].blendMode == SGUIBlendMode::SGBM_NON_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[0].vTextureKeys == std::vector<uint64_t>{ 5 });
+	REQUIRE(backend.vBatches[1].blendMode == SGUIBlendMode::SGBM_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[1].vTextureKeys == std::vector<uint64_t>{ 1, 2 });
+	REQUIRE(backend.vBatches[2].blendMode == SGUIBlendMode::SGBM_NON_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[2].vTextureKeys == std::vector<uint64_t>{ 5 });
+	REQUIRE(backend.vBatches[3].blendMode == SGUIBlendMode::SGBM_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[3].vTextureKeys == std::vector<uint64_t>{ 1 });
+
+	REQUIRE(batcher.getStats().iBatchCount == 4);
+	REQUIRE(batcher.getStats().iDrawCount == 5);
+}
+
+TEST_CASE("Each blend mode gets its own batch and layers keep their order.", "[SGUIBatcherTests::layers]") {
+	SRecordingGUIBackend backend;
+	SGUIBatcher batcher;
+
+	batcher.beginFrame();
+
+	// Layer 0.
+	batcher.addItem(makeItem(1));
+	batcher.addItem(makeItem(1));
+	batcher.addItem(makeItem(5, SGUIBlendMode::SGBM_NON_PREMULTIPLIED));
+	batcher.addItem(makeItem(5, SGUIBlendMode::SGBM_NON_PREMULTIPLIED));
+	batcher.flushLayer(&backend);
+
+	// Empty layer.
+	batcher.flushLayer(&backend);
+
+	// Layer 2.
+	batcher.addItem(makeItem(0));
+	batcher.flushLayer(&backend);
+
+	REQUIRE(backend.vBatches.size() == 3);
+
+	REQUIRE(backend.vBatches[0].blendMode == SGUIBlendMode::SGBM_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[0].vTextureKeys == std::vector<uint64_t>{ 1, 1 });
+	REQUIRE(backend.vBatches[1].blendMode == SGUIBlendMode::SGBM_NON_PREMULTIPLIED);
+	REQUIRE(backend.vBatches[1].vTextureKeys == std::vector<uint64_t>{ 5, 5 });
+	REQUIRE(backend.vBatches[2].vTextureKeys == std::vector<uint64_t>{ 0 });
+
+	for (size_t i = 0; i < backend.vBatches.size(); i++)
+	{
+		REQUIRE(backend.vBatches[i].bEnded);
+	}
+
+	REQUIRE(batcher.getStats().iBatchCount == 3);
+	REQUIRE(batcher.getStats().iDrawCount == 3);
+
+	// Stats are reset every frame.
+	batcher.beginFrame();
+	REQUIRE(batcher.getStats().iDrawCount == 0);
+	REQUIRE(batcher.getStats().iItemCount == 0);
+}
+
+TEST_CASE("Big runs are split into multiple draws.", "[SGUIBatcherTests::maxSpritesPerDraw]") {
+	SRecordingGUIBackend backend;
+	SGUIBatcher batcher;
+
+	batcher.beginFrame();
+
+	// Text with an outline and a shadow: 7 passes of 200 glyphs.
+	for (size_t i = 0; i < 3; i++)
+	{
+		batcher.addItem(makeItem(7, SGUIBlendMode::SGBM_PREMULTIPLIED, 1400));
+	}
+
+	batcher.flushLayer(&backend);
+
+	REQUIRE(batcher.getStats().iSpriteCount == 4200);
+	REQUIRE(batcher.getStats().iDrawCount == (4200 + SGUIBatcher::iMaxSpritesPerDraw - 1) / SGUIBatcher::iMaxSpritesPerDraw);
+	REQUIRE(backend.vBatches.size() == 1);
+}
@@ -0,0 +1,271 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+
+// Custom
+#include "SilentEngine/Private/GUI/SGUILayoutSolver/SGUILayoutSolver.h"
+
+static SGUILayoutParams createLayoutParams(SLayoutType layoutType, bool bExpandItems, float fWidth, float fHeight)
+{
+	SGUILayoutParams params;
+	params.layoutType = layoutType;
+	params.bExpandItems = bExpandItems;
+	params.fWidth = fWidth;
+	params.fHeight = fHeight;
+
+	return params;
+}
+
+TEST_CASE("Expanding layout stretches childs using ratios.", "[SGUILayoutSolverTests::expand]") {
+	SGUILayoutSolver solver;
+	solver.setScreenSize(1000.0f, 500.0f);
+
+	size_t iLayout = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 0.5f, 0.2f), nullptr);
+
+	size_t iFirst = solver.createItemNode(nullptr);
+	size_t iSecond = solver.createItemNode(nullptr);
+	solver.setContentSize(iFirst, 100.0f, 50.0f);
+	solver.setContentSize(iSecond, 100.0f, 50.0f);
+
+	REQUIRE(solver.addChild(iLayout, iFirst, 1) == false);
+	REQUIRE(solver.addChild(iLayout, iSecond, 3) == false);
+
+	REQUIRE(solver.solve() == 2);
+
+	// Layout is 500x100 pixels, the first child takes 25% of the width.
+	const SGUILayoutResult& first = solver.getResult(iFirst);
+	REQUIRE(first.fOffsetX == Approx(-0.1875f));
+	REQUIRE(first.fOffsetY == Approx(0.0f));
+	REQUIRE(first.fLayoutScreenScaleX == Approx(1.25f));
+	REQUIRE(first.fLayoutScreenScaleY == Approx(2.0f));
+	REQUIRE(first.fOriginX == 0.0f);
+	REQUIRE(first.fOriginY == 0.0f);
+	REQUIRE(first.bHasSizeToKeep == false);
+
+	const SGUILayoutResult& second = solver.getResult(iSecond);
+	REQUIRE(second.fOffsetX == Approx(0.0625f));
+	REQUIRE(second.fLayoutScreenScaleX == Approx(3.75f));
+	REQUIRE(second.fLayoutScreenScaleY == Approx(2.0f));
+
+	REQUIRE(solver.isDirty() == false);
+	REQUIRE(solver.solve() == 0);
+}
+
+TEST_CASE("Non expanding layout uses alignment and indent.", "[SGUILayoutSolverTests::alignment]") {
+	SGUILayoutSolver solver;
+	solver.setScreenSize(1000.0f, 1000.0f);
+
+	SGUILayoutParams params = createLayoutParams(SLayoutType::SLT_VERTICAL, false, 0.4f, 0.6f);
+	params.alignment = SLayoutAlignment::SLA_RIGHT;
+	params.indent.fRightIndent = 0.1f;
+	params.indent.fTopIndent = 0.2f;
+
+	size_t iLayout = solver.createLayoutNode(params, nullptr);
+
+	std::vector<size_t> vItems;
+	for (int i = 0; i < 3; i++)
+	{
+		vItems.push_back(solver.createItemNode(nullptr));
+		solver.setContentSize(vItems.back(), 10.0f, 10.0f);
+
+		// Ratios are ignored.
+		solver.addChild(iLayout, vItems.back(), 5 - i);
+	}
+
+	REQUIRE(solver.solve() == 3);
+
+	for (size_t i = 0; i < vItems.size(); i++)
+	{
+		const SGUILayoutResult& result = solver.getResult(vItems[i]);
+
+		REQUIRE(result.fOffsetX == Approx(0.16f));
+		REQUIRE(result.fOffsetY == Approx(i * 0.2f + 0.12f - 0.3f));
+		REQUIRE(result.fOriginX == 1.0f);
+		REQUIRE(result.fOriginY == 0.0f);
+		REQUIRE(result.fLayoutScreenScaleX == 1.0f);
+		REQUIRE(result.fLayoutScreenScaleY == 1.0f);
+		REQUIRE(result.bHasSizeToKeep);
+		REQUIRE(result.fSizeToKeepX == Approx(0.4f));
+		REQUIRE(result.fSizeToKeepY == Approx(0.2f));
+	}
+
+	// Center alignment.
+	params.alignment = SLayoutAlignment::SLA_CENTER;
+	solver.setLayoutParams(iLayout, params);
+
+	REQUIRE(solver.solve() == 3);
+	REQUIRE(solver.getResult(vItems[0]).fOffsetX == Approx(0.0f));
+	REQUIRE(solver.getResult(vItems[0]).fOriginX == 0.5f);
+}
+
+TEST_CASE("Child layout is sized by its parent.", "[SGUILayoutSolverTests::nested]") {
+	SGUILayoutSolver solver;
+	solver.setScreenSize(100.0f, 100.0f);
+
+	size_t iRoot = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_VERTICAL, true, 1.0f, 1.0f), nullptr);
+
+	// The size of the child layouts is ignored.
+	size_t iTop = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 0.1f, 0.1f), nullptr);
+	size_t iBottom = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 0.1f, 0.1f), nullptr);
+
+	REQUIRE(solver.addChild(iRoot, iTop, 1) == false);
+	REQUIRE(solver.addChild(iRoot, iBottom, 1) == false);
+
+	std::vector<size_t> vTopItems;
+	for (int i = 0; i < 2; i++)
+	{
+		vTopItems.push_back(solver.createItemNode(nullptr));
+		solver.setContentSize(vTopItems.back(), 10.0f, 10.0f);
+		solver.addChild(iTop, vTopItems.back(), 1);
+	}
+
+	size_t iBottomItem = solver.createItemNode(nullptr);
+	solver.setContentSize(iBottomItem, 10.0f, 10.0f);
+	solver.addChild(iBottom, iBottomItem, 1);
+
+	REQUIRE(solver.solve() == 5);
+
+	const SGUILayoutResult& top = solver.getResult(iTop);
+	REQUIRE(top.fFrameWidth == Approx(1.0f));
+	REQUIRE(top.fFrameHeight == Approx(0.5f));
+	REQUIRE(top.fOffsetX == Approx(0.0f));
+	REQUIRE(top.fOffsetY == Approx(-0.25f));
+
+	REQUIRE(solver.getResult(iBottom).fOffsetY == Approx(0.25f));
+
+	// Top layout is 100x50 pixels.
+	const SGUILayoutResult& item = solver.getResult(vTopItems[0]);
+	REQUIRE(item.fOffsetX == Approx(-0.25f));
+	REQUIRE(item.fOffsetY == Approx(0.0f));
+	REQUIRE(item.fLayoutScreenScaleX == Approx(5.0f));
+	REQUIRE(item.fLayoutScreenScaleY == Approx(5.0f));
+
+	REQUIRE(solver.getResult(iBottomItem).fLayoutScreenScaleX == Approx(10.0f));
+
+	// Cycles are not allowed.
+	REQUIRE(solver.addChild(iTop, iRoot, 1));
+	REQUIRE(solver.addChild(iTop, iTop, 1));
+	REQUIRE(solver.addChild(iBottom, vTopItems[0], 1)); // already has a parent
+	REQUIRE(solver.addChild(vTopItems[0], iBottomItem, 1)); // not a layout
+}
+
+TEST_CASE("Only changed nodes are recalculated.", "[SGUILayoutSolverTests::incremental]") {
+	SGUILayoutSolver solver;
+	solver.setScreenSize(100.0f, 100.0f);
+
+	size_t iRoot = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_VERTICAL, true, 1.0f, 1.0f), nullptr);
+	size_t iTop = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 1.0f, 1.0f), nullptr);
+	size_t iBottom = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 1.0f, 1.0f), nullptr);
+	solver.addChild(iRoot, iTop, 1);
+	solver.addChild(iRoot, iBottom, 1);
+
+	int iUserData[4] = {};
+
+	std::vector<size_t> vItems;
+	for (int i = 0; i < 4; i++)
+	{
+		vItems.push_back(solver.createItemNode(&iUserData[i]));
+		solver.setContentSize(vItems.back(), 10.0f, 10.0f);
+		solver.addChild(i < 2 ? iTop : iBottom, vItems.back(), 1);
+	}
+
+	REQUIRE(solver.solve() == 6);
+	REQUIRE(solver.getUserData(vItems[3]) == &iUserData[3]);
+	REQUIRE(solver.getParent(vItems[3]) == iBottom);
+
+	// Size of the item does not change the size of the layout.
+	solver.setContentSize(vItems[1], 20.0f, 10.0f);
+	REQUIRE(solver.solve() == 1);
+	REQUIRE(solver.getUpdatedNodes()[0] == vItems[1]);
+	REQUIRE(solver.getResult(vItems[1]).fLayoutScreenScaleX == Approx(2.5f));
+	REQUIRE(solver.getResult(vItems[0]).fLayoutScreenScaleX == Approx(5.0f));
+
+	// Same size.
+	solver.setContentSize(vItems[1], 20.0f, 10.0f);
+	REQUIRE(solver.isDirty() == false);
+	REQUIRE(solver.solve() == 0);
+
+	// Params of the child layout only affect its childs.
+	SGUILayoutParams params = createLayoutParams(SLayoutType::SLT_HORIZONTAL, true, 1.0f, 1.0f);
+	params.fScaleX = 2.0f;
+	solver.setLayoutParams(iBottom, params);
+	REQUIRE(solver.solve() == 2);
+	REQUIRE(solver.getResult(vItems[2]).fLayoutScreenScaleX == Approx(10.0f));
+
+	// Change of the root layout does not relayout child layouts with the same size.
+	solver.markLayoutDirty(iRoot);
+	REQUIRE(solver.solve() == 2);
+
+	// New child changes the sizes of the siblings.
+	size_t iNewItem = solver.createItemNode(nullptr);
+	solver.setContentSize(iNewItem, 10.0f, 10.0f);
+	solver.addChild(iRoot, iNewItem, 2);
+	REQUIRE(solver.solve() == 3 + 4); // root childs and childs of both child layouts
+	REQUIRE(solver.getResult(iTop).fFrameHeight == Approx(0.25f));
+
+	// Removed child.
+	solver.removeFromParent(vItems[0]);
+	REQUIRE(solver.solve() == 1);
+	REQUIRE(solver.getResult(vItems[1]).fOffsetX == Approx(0.0f));
+
+	// Screen size relays out everything.
+	solver.setScreenSize(200.0f, 100.0f);
+	REQUIRE(solver.solve() == 3 + 1 + 2);
+
+	// Destroyed nodes are reused.
+	solver.destroyNode(iNewItem);
+	size_t iReusedItem = solver.createItemNode(nullptr);
+	REQUIRE(iReusedItem == iNewItem);
+	REQUIRE(solver.getParent(iReusedItem) == SGUILayoutSolver::iInvalidNodeId);
+	REQUIRE(solver.solve() == 2 + 3);
+}
+
+TEST_CASE("Benchmark relayout of 5000 items in nested layouts.", "[.][benchmark][SGUILayoutSolverTests::benchmarkRelayout]") {
+	SGUILayoutSolver solver;
+	solver.setScreenSize(1920.0f, 1080.0f);
+
+	// 50 rows of 100 items.
+	size_t iRoot = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_VERTICAL, true, 1.0f, 1.0f), nullptr);
+
+	std::vector<size_t> vItems;
+	for (size_t iRow = 0; iRow < 50; iRow++)
+	{
+		size_t iRowLayout = solver.createLayoutNode(createLayoutParams(SLayoutType::SLT_HORIZONTAL, false, 1.0f, 1.0f), nullptr);
+		solver.addChild(iRoot, iRowLayout, 1);
+
+		for (size_t i = 0; i < 100; i++)
+		{
+			vItems.push_back(solver.createItemNode(nullptr));
+			solver.setContentSize(vItems.back(), 16.0f, 16.0f);
+			solver.addChild(iRowLayout, vItems.back(), 1);
+		}
+	}
+
+	REQUIRE(solver.solve() == 5000 + 50);
+
+	float fSize = 16.0f;
+
+	BENCHMARK("single item change") {
+		fSize = fSize == 16.0f ? 32.0f : 16.0f;
+		solver.setContentSize(vItems[vItems.size() / 2], fSize, fSize);
+
+		return solver.solve();
+	};
+
+	float fScreenWidth = 1920.0f;
+
+	BENCHMARK("full relayout") {
+		fScreenWidth = fScreenWidth == 1920.0f ? 1280.0f : 1920.0f;
+		solver.setScreenSize(fScreenWidth, 1080.0f);
+
+		return solver.solve();
+	};
+}
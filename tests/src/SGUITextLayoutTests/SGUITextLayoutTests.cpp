@@ -0,0 +1,146 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// Custom
+#include "SilentEngine/Private/GUI/SGUITextLayout/SGUITextLayout.h"
+
+//@@Class
+/*
+Monospaced font: every glyph is 8x10 pixels with 2 pixels of advance, the space is 1 pixel wide with 3 pixels of advance.
+*/
+class SFakeGlyphSource : public SGUIGlyphSource
+{
+public:
+	virtual SGUIGlyph getGlyph(wchar_t character) const override
+	{
+		iGlyphRequests++;
+
+		SGUIGlyph glyph;
+		glyph.iCharacter = character;
+
+		if (character == L' ')
+		{
+			glyph.iRight = 1;
+			glyph.iBottom = 1;
+			glyph.fXAdvance = 3.0f;
+
+			return glyph;
+		}
+
+		// Each character has its own cell in the sprite sheet.
+		glyph.iLeft = static_cast<int32_t>(character) * 8;
+		glyph.iRight = glyph.iLeft + 8;
+		glyph.iTop = 0;
+		glyph.iBottom = 10;
+		glyph.fYOffset = 1.0f;
+		glyph.fXAdvance = 2.0f;
+
+		return glyph;
+	}
+
+	virtual float getLineSpacing() const override
+	{
+		return 12.0f;
+	}
+
+	mutable size_t iGlyphRequests = 0;
+};
+
+TEST_CASE("Glyph quads and size are calculated once.", "[SGUITextLayoutTests::build]") {
+	SFakeGlyphSource font;
+	SGUITextLayout layout;
+
+	layout.build(&font, L"ab c\nd", 0.0f, false, 0.0f);
+
+	REQUIRE(layout.getWrappedText() == L"ab c\nd");
+
+	// The space is not drawn.
+	const std::vector<SGUIGlyphQuad>& vQuads = layout.getQuads();
+	REQUIRE(vQuads.size() == 4);
+
+	REQUIRE(vQuads[0].fX == 0.0f);
+	REQUIRE(vQuads[0].fY == 1.0f);
+	REQUIRE(vQuads[0].iLeft == L'a' * 8);
+	REQUIRE(vQuads[0].iRight == L'a' * 8 + 8);
+
+	REQUIRE(vQuads[1].fX == 10.0f);
+	REQUIRE(vQuads[2].fX == 24.0f); // 'a' + 'b' + ' '
+	REQUIRE(vQuads[3].fX == 0.0f);
+	REQUIRE(vQuads[3].fY == 13.0f); // second line
+
+	float fWidth = 0.0f;
+	float fHeight = 0.0f;
+	layout.getSize(fWidth, fHeight);
+	REQUIRE(fWidth == 32.0f);
+	REQUIRE(fHeight == 24.0f);
+
+	float fMeasuredWidth = 0.0f;
+	float fMeasuredHeight = 0.0f;
+	SGUITextLayout::measureString(&font, L"ab c\nd", true, fMeasuredWidth, fMeasuredHeight);
+	REQUIRE(fMeasuredWidth == fWidth);
+	REQUIRE(fMeasuredHeight == fHeight);
+
+	// Drawing the quads (for any number of passes) does not touch the font.
+	size_t iRequests = font.iGlyphRequests;
+
+	for (size_t iPass = 0; iPass < 7; iPass++)
+	{
+		REQUIRE(layout.getQuads().size() == 4);
+		layout.getSize(fWidth, fHeight);
+	}
+
+	REQUIRE(font.iGlyphRequests == iRequests);
+}
+
+TEST_CASE("Trailing whitespace is only measured when asked.", "[SGUITextLayoutTests::whitespace]") {
+	SFakeGlyphSource font;
+	SGUITextLayout layout;
+
+	layout.build(&font, L"a ", 0.0f, false, 0.0f);
+
+	float fWidth = 0.0f;
+	float fHeight = 0.0f;
+
+	layout.getSize(fWidth, fHeight, true);
+	REQUIRE(fWidth == 8.0f);
+
+	layout.getSize(fWidth, fHeight, false);
+	REQUIRE(fWidth == 11.0f); // 'a' with advance + 1 pixel of space
+	REQUIRE(fHeight == 12.0f);
+
+	// Empty text.
+	layout.build(&font, L"", 0.0f, false, 0.0f);
+	layout.getSize(fWidth, fHeight);
+	REQUIRE(layout.getQuads().size() == 0);
+	REQUIRE(fWidth == 0.0f);
+	REQUIRE(fHeight == 0.0f);
+}
+
+TEST_CASE("Text is wrapped by the max line width.", "[SGUITextLayoutTests::wrap]") {
+	SFakeGlyphSource font;
+	SGUITextLayout layout;
+
+	// Each 2-letter word is 18 pixels wide, the measured width of the space is 1.
+	layout.build(&font, L"aa bb cc dd", 45.0f, false, 0.0f);
+
+	REQUIRE(layout.getWrappedText() == L"aa bb \ncc dd ");
+	REQUIRE(layout.getQuads().size() == 8);
+	REQUIRE(layout.getQuads()[4].fY == 13.0f);
+
+	// Last line is moved to the center using spaces.
+	layout.build(&font, L"aa bb cc", 45.0f, true, 5.0f);
+
+	// Last line is 19 pixels wide: (45 - 19) / 1 / 2 = 13 spaces.
+	REQUIRE(layout.getWrappedText() == L"aa bb \n" + std::wstring(13, L' ') + L"cc ");
+
+	// Clear.
+	layout.clear();
+	REQUIRE(layout.getQuads().size() == 0);
+	REQUIRE(layout.getWrappedText() == L"");
+}
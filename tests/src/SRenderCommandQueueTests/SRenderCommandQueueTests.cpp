@@ -0,0 +1,184 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+// Custom
+#include "SilentEngine/Private/SRenderCommandQueue/SRenderCommandQueue.h"
+
+TEST_CASE("Commands are executed in the push order.", "[SRenderCommandQueueTests::order]") {
+	SRenderCommandQueue queue;
+
+	REQUIRE(queue.isEmpty());
+	REQUIRE(queue.execute() == 0);
+
+	std::vector<int> vExecuted;
+	for (int i = 0; i < 5; i++)
+	{
+		queue.push([&vExecuted, i]() { vExecuted.push_back(i); });
+	}
+
+	REQUIRE(queue.isEmpty() == false);
+	REQUIRE(queue.execute() == 5);
+	REQUIRE(queue.isEmpty());
+
+	REQUIRE(vExecuted == std::vector<int>{ 0, 1, 2, 3, 4 });
+}
+
+TEST_CASE("Commands pushed by commands are executed in the next call.", "[SRenderCommandQueueTests::nested]") {
+	SRenderCommandQueue queue;
+
+	int iExecutedCount = 0;
+
+	queue.push([&]() {
+		iExecutedCount++;
+		queue.push([&]() { iExecutedCount++; });
+	});
+
+	REQUIRE(queue.execute() == 1);
+	REQUIRE(iExecutedCount == 1);
+
+	REQUIRE(queue.execute() == 1);
+	REQUIRE(iExecutedCount == 2);
+}
+
+TEST_CASE("Not executed commands are destroyed with the queue.", "[SRenderCommandQueueTests::destroy]") {
+	std::shared_ptr<int> pCaptured = std::make_shared<int>(0);
+
+	{
+		SRenderCommandQueue queue;
+		queue.push([pCaptured]() { (*pCaptured)++; });
+
+		REQUIRE(pCaptured.use_count() == 2);
+	}
+
+	REQUIRE(pCaptured.use_count() == 1);
+	REQUIRE(*pCaptured == 0);
+}
+
+TEST_CASE("Commands from many threads are executed once and in order per thread.", "[SRenderCommandQueueTests::multipleProducers]") {
+	SRenderCommandQueue queue;
+
+	const size_t iProducerCount = 4;
+	const size_t iCommandsPerProducer = 20000;
+
+	// Only changed by the consumer thread.
+	std::vector<size_t> vNextExpected(iProducerCount, 0);
+	size_t iOutOfOrderCount = 0;
+
+	std::atomic<size_t> iFinishedProducers{ 0 };
+
+	std::vector<std::thread> vProducers;
+	for (size_t iProducer = 0; iProducer < iProducerCount; iProducer++)
+	{
+		vProducers.push_back(std::thread([&, iProducer]() {
+			for (size_t i = 0; i < iCommandsPerProducer; i++)
+			{
+				queue.push([&, iProducer, i]() {
+					if (vNextExpected[iProducer] != i)
+					{
+						iOutOfOrderCount++;
+					}
+
+					vNextExpected[iProducer] = i + 1;
+				});
+			}
+
+			iFinishedProducers++;
+		}));
+	}
+
+	size_t iExecutedCount = 0;
+
+	while (iFinishedProducers.load() != iProducerCount)
+	{
+		iExecutedCount += queue.execute();
+	}
+
+	iExecutedCount += queue.execute();
+
+	for (size_t i = 0; i < vProducers.size(); i++)
+	{
+		vProducers[i].join();
+	}
+
+	REQUIRE(iExecutedCount == iProducerCount * iCommandsPerProducer);
+	REQUIRE(iOutOfOrderCount == 0);
+
+	for (size_t i = 0; i < iProducerCount; i++)
+	{
+		REQUIRE(vNextExpected[i] == iCommandsPerProducer);
+	}
+}
+
+TEST_CASE("Benchmark physics tick latency while the render thread is drawing.", "[.][benchmark][SRenderCommandQueueTests::benchmarkContention]") {
+	const auto frameDrawTime = std::chrono::milliseconds(4);
+	const size_t iChangesPerTick = 16;
+
+	std::mutex mtxDraw;
+	SRenderCommandQueue queue;
+
+	size_t iSceneValue = 0; // guarded by mtxDraw
+	size_t iExpectedSceneValue = 0;
+
+	std::atomic<bool> bStopRendering{ false };
+
+	// The render thread holds the draw mutex for most of the frame.
+	std::thread renderThread([&]() {
+		while (bStopRendering.load() == false)
+		{
+			std::lock_guard<std::mutex> guard(mtxDraw);
+
+			// Sync point.
+			queue.execute();
+
+			// Draw.
+			auto drawStart = std::chrono::steady_clock::now();
+			while (std::chrono::steady_clock::now() - drawStart < frameDrawTime)
+			{
+			}
+		}
+	});
+
+	BENCHMARK("physics tick, draw mutex") {
+		for (size_t i = 0; i < iChangesPerTick; i++)
+		{
+			std::lock_guard<std::mutex> guard(mtxDraw);
+			iSceneValue++;
+		}
+
+		iExpectedSceneValue += iChangesPerTick;
+
+		return iExpectedSceneValue;
+	};
+
+	BENCHMARK("physics tick, command queue") {
+		for (size_t i = 0; i < iChangesPerTick; i++)
+		{
+			queue.push([&iSceneValue]() { iSceneValue++; });
+		}
+
+		iExpectedSceneValue += iChangesPerTick;
+
+		return iExpectedSceneValue;
+	};
+
+	bStopRendering = true;
+	renderThread.join();
+
+	queue.execute();
+
+	REQUIRE(iSceneValue == iExpectedSceneValue);
+}
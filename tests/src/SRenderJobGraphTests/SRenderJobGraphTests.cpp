@@ -0,0 +1,284 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+// Custom
+#include "SilentEngine/Private/SRenderJobGraph/SRenderJobGraph.h"
+
+//@@Class
+/*
+Records the commands of each command list as numbers, checks that a thread (allocator) records only one list at a time.
+*/
+class SMockRecorder : public SCommandListRecorder
+{
+public:
+	SMockRecorder(size_t iThreadCount, size_t iCommandListCount)
+	{
+		vThreadRecording = std::vector<std::atomic<bool>>(iThreadCount);
+		vCommandLists.resize(iCommandListCount);
+		vRecordingThread.resize(iCommandListCount, SIZE_MAX);
+	}
+
+	virtual bool beginCommandList(size_t iThreadIndex, size_t iCommandListIndex) override
+	{
+		if (iThreadIndex >= vThreadRecording.size() || vThreadRecording[iThreadIndex].exchange(true))
+		{
+			bAllocatorMisused = true;
+		}
+
+		vRecordingThread[iCommandListIndex] = iThreadIndex;
+
+		if (iCommandListIndex == iFailingCommandList)
+		{
+			// endCommandList() is not called for the failed list.
+			vThreadRecording[iThreadIndex] = false;
+			return true;
+		}
+
+		return false;
+	}
+
+	virtual bool endCommandList(size_t iThreadIndex, size_t iCommandListIndex) override
+	{
+		if (vRecordingThread[iCommandListIndex] != iThreadIndex)
+		{
+			bAllocatorMisused = true;
+		}
+
+		vThreadRecording[iThreadIndex] = false;
+
+		return false;
+	}
+
+	virtual void submitCommandLists(const std::vector<size_t>& vCommandListIndices) override
+	{
+		for (size_t i = 0; i < vCommandListIndices.size(); i++)
+		{
+			vSubmitted.insert(vSubmitted.end(), vCommandLists[vCommandListIndices[i]].begin(), vCommandLists[vCommandListIndices[i]].end());
+		}
+	}
+
+	void record(size_t iThreadIndex, size_t iCommandListIndex, int iCommand)
+	{
+		if (vRecordingThread[iCommandListIndex] != iThreadIndex)
+		{
+			bAllocatorMisused = true;
+		}
+
+		vCommandLists[iCommandListIndex].push_back(iCommand);
+	}
+
+	std::vector<std::atomic<bool>> vThreadRecording;
+	std::vector<std::vector<int>>  vCommandLists;
+	std::vector<size_t>            vRecordingThread;
+
+	std::vector<int>               vSubmitted;
+
+	std::atomic<bool>              bAllocatorMisused{ false };
+
+	size_t                         iFailingCommandList = SIZE_MAX;
+};
+
+TEST_CASE("Command lists are submitted in the order of the jobs.", "[SRenderJobGraphTests::order]") {
+	SRenderJobGraph graph;
+	graph.start(4);
+
+	REQUIRE(graph.getRecordingThreadCount() == 5);
+
+	const size_t iJobCount = 64;
+
+	SMockRecorder recorder(graph.getRecordingThreadCount(), iJobCount);
+
+	for (size_t iFrame = 0; iFrame < 3; iFrame++)
+	{
+		graph.clear();
+
+		for (size_t i = 0; i < iJobCount; i++)
+		{
+			// Jobs take different time so they finish in a different order.
+			graph.addJob([&recorder, i](size_t iThreadIndex, size_t iCommandListIndex)
+			{
+				std::this_thread::sleep_for(std::chrono::microseconds((iJobCount - i) % 7 * 50));
+
+				recorder.record(iThreadIndex, iCommandListIndex, static_cast<int>(i) * 2);
+				recorder.record(iThreadIndex, iCommandListIndex, static_cast<int>(i) * 2 + 1);
+			});
+		}
+
+		REQUIRE(graph.getJobCount() == iJobCount);
+
+		recorder.vCommandLists = std::vector<std::vector<int>>(iJobCount);
+		recorder.vSubmitted.clear();
+
+		REQUIRE(graph.execute(&recorder) == false);
+
+		REQUIRE(recorder.vSubmitted.size() == iJobCount * 2);
+		for (size_t i = 0; i < recorder.vSubmitted.size(); i++)
+		{
+			REQUIRE(recorder.vSubmitted[i] == static_cast<int>(i));
+		}
+	}
+
+	REQUIRE(recorder.bAllocatorMisused == false);
+}
+
+TEST_CASE("Jobs are started after their dependencies.", "[SRenderJobGraphTests::dependencies]") {
+	SRenderJobGraph graph;
+	graph.start(3);
+
+	SMockRecorder recorder(graph.getRecordingThreadCount(), 6);
+
+	std::vector<std::atomic<bool>> vFinished(6);
+	std::atomic<bool> bDependencyNotFinished{ false };
+
+	// Culling job, 4 jobs that use its results and a job that depends on 2 of them.
+	const size_t iCullJob = graph.addJob([&](size_t, size_t)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		vFinished[0] = true;
+	});
+
+	std::vector<size_t> vDrawJobs;
+	for (size_t i = 1; i <= 4; i++)
+	{
+		vDrawJobs.push_back(graph.addJob([&, i](size_t, size_t)
+		{
+			if (vFinished[0] == false)
+			{
+				bDependencyNotFinished = true;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(i));
+			vFinished[i] = true;
+		}, { iCullJob }));
+	}
+
+	graph.addJob([&](size_t, size_t)
+	{
+		if (vFinished[1] == false || vFinished[4] == false)
+		{
+			bDependencyNotFinished = true;
+		}
+
+		vFinished[5] = true;
+	}, { vDrawJobs[0], vDrawJobs[3] });
+
+	REQUIRE(graph.execute(&recorder) == false);
+
+	REQUIRE(bDependencyNotFinished == false);
+	for (size_t i = 0; i < vFinished.size(); i++)
+	{
+		REQUIRE(vFinished[i]);
+	}
+}
+
+TEST_CASE("Command lists are not submitted if one of them failed.", "[SRenderJobGraphTests::failure]") {
+	SRenderJobGraph graph;
+	graph.start(2);
+
+	SMockRecorder recorder(graph.getRecordingThreadCount(), 8);
+	recorder.iFailingCommandList = 3;
+
+	std::atomic<size_t> iRecordedCount{ 0 };
+
+	std::vector<size_t> vDependencies;
+	for (size_t i = 0; i < 8; i++)
+	{
+		// Jobs that depend on the failed job are still processed.
+		vDependencies.push_back(graph.addJob([&](size_t iThreadIndex, size_t iCommandListIndex)
+		{
+			recorder.record(iThreadIndex, iCommandListIndex, 1);
+			iRecordedCount++;
+		}, vDependencies));
+	}
+
+	REQUIRE(graph.execute(&recorder) == true);
+
+	REQUIRE(iRecordedCount == 7);
+	REQUIRE(recorder.vSubmitted.size() == 0);
+	REQUIRE(recorder.bAllocatorMisused == false);
+}
+
+TEST_CASE("Jobs are recorded on the calling thread without workers.", "[SRenderJobGraphTests::noWorkers]") {
+	SRenderJobGraph graph;
+	graph.start(2);
+	graph.stop();
+
+	REQUIRE(graph.getRecordingThreadCount() == 1);
+
+	SMockRecorder recorder(1, 4);
+
+	const std::thread::id callingThreadId = std::this_thread::get_id();
+	bool bOtherThread = false;
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		graph.addJob([&, i](size_t iThreadIndex, size_t iCommandListIndex)
+		{
+			bOtherThread = bOtherThread || (std::this_thread::get_id() != callingThreadId) || (iThreadIndex != 0);
+			recorder.record(iThreadIndex, iCommandListIndex, static_cast<int>(i));
+		});
+	}
+
+	REQUIRE(graph.execute(&recorder) == false);
+
+	REQUIRE(bOtherThread == false);
+	REQUIRE(recorder.vSubmitted == std::vector<int>{ 0, 1, 2, 3 });
+}
+
+TEST_CASE("Benchmark parallel command list recording.", "[.][benchmark][SRenderJobGraphTests::benchmark]") {
+	// 6 shadow map faces and 16 opaque shader buckets, each one records 500 draws
+	// (the cost of a draw is simulated by some math, about the same as filling the draw arguments).
+	const size_t iJobCount = 22;
+	const size_t iDrawsPerJob = 500;
+
+	auto recordDraws = [](size_t iJobIndex) -> uint64_t
+	{
+		uint64_t iHash = iJobIndex + 1;
+		for (size_t i = 0; i < iDrawsPerJob * 200; i++)
+		{
+			iHash = iHash * 6364136223846793005ULL + 1442695040888963407ULL;
+		}
+		return iHash;
+	};
+
+	std::vector<uint64_t> vResults(iJobCount);
+
+	auto addJobs = [&](SRenderJobGraph& graph)
+	{
+		for (size_t i = 0; i < iJobCount; i++)
+		{
+			graph.addJob([&, i](size_t, size_t iCommandListIndex) { vResults[iCommandListIndex] = recordDraws(i); });
+		}
+	};
+
+	SRenderJobGraph serialGraph; // no workers: everything is recorded on one thread like before
+	SRenderJobGraph parallelGraph;
+	parallelGraph.start();
+
+	addJobs(serialGraph);
+	addJobs(parallelGraph);
+
+	SMockRecorder serialRecorder(serialGraph.getRecordingThreadCount(), iJobCount);
+	SMockRecorder parallelRecorder(parallelGraph.getRecordingThreadCount(), iJobCount);
+
+	BENCHMARK("one command list on one thread") {
+		return serialGraph.execute(&serialRecorder);
+	};
+
+	BENCHMARK("all recording threads") {
+		return parallelGraph.execute(&parallelRecorder);
+	};
+}
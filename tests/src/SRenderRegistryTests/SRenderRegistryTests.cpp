@@ -0,0 +1,165 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// Custom
+#include "SilentEngine/Private/SRenderRegistry/SRenderRegistry.h"
+#include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
+#include "SilentEngine/Public/EntityComponentSystem/SMeshComponent/SMeshComponent.h"
+#include "SilentEngine/Public/EntityComponentSystem/SRuntimeMeshComponent/SRuntimeMeshComponent.h"
+#include "SilentEngine/Public/EntityComponentSystem/STargetComponent/STargetComponent.h"
+
+static void createMeshContainers(size_t iComponentCount, std::vector<SContainer*>& vOutContainers)
+{
+	// Each container has a target component with 7 mesh components as childs.
+
+	const size_t iComponentsPerContainer = 8;
+
+	for (size_t i = 0; i < iComponentCount / iComponentsPerContainer; i++)
+	{
+		SContainer* pContainer = new SContainer("container_" + std::to_string(i));
+
+		STargetComponent* pTarget = new STargetComponent("target");
+		pContainer->addComponentToContainer(pTarget);
+
+		for (size_t j = 0; j < iComponentsPerContainer - 1; j++)
+		{
+			pTarget->addChildComponent(new SMeshComponent("mesh_" + std::to_string(j)));
+		}
+
+		vOutContainers.push_back(pContainer);
+	}
+}
+
+static void walkComponentAndChilds(SComponent* pComponent, size_t& iVisibleCount)
+{
+	// This is how the per-frame walk used to look like.
+
+	if (pComponent->getComponentType() == SComponentType::SCT_MESH)
+	{
+		SMeshComponent* pMesh = dynamic_cast<SMeshComponent*>(pComponent);
+		if (pMesh->isVisible())
+		{
+			iVisibleCount++;
+		}
+	}
+	else if (pComponent->getComponentType() == SComponentType::SCT_RUNTIME_MESH)
+	{
+		SRuntimeMeshComponent* pMesh = dynamic_cast<SRuntimeMeshComponent*>(pComponent);
+		if (pMesh->isVisible())
+		{
+			iVisibleCount++;
+		}
+	}
+
+	std::vector<SComponent*> vChilds = pComponent->getChildComponents();
+	for (size_t i = 0; i < vChilds.size(); i++)
+	{
+		walkComponentAndChilds(vChilds[i], iVisibleCount);
+	}
+}
+
+TEST_CASE("Render registry stores mesh components of the container and its childs.", "[SRenderRegistryTests::addRemove]") {
+	SRenderRegistry renderRegistry;
+
+	SContainer* pFirstContainer = new SContainer("first");
+	SMeshComponent* pMesh = new SMeshComponent("mesh");
+	SRuntimeMeshComponent* pRuntimeMesh = new SRuntimeMeshComponent("runtime mesh", false);
+	STargetComponent* pTarget = new STargetComponent("target");
+	SMeshComponent* pChildMesh = new SMeshComponent("child mesh");
+
+	pFirstContainer->addComponentToContainer(pMesh);
+	pMesh->addChildComponent(pRuntimeMesh);
+	pMesh->addChildComponent(pTarget);
+	pTarget->addChildComponent(pChildMesh);
+
+	SContainer* pSecondContainer = new SContainer("second");
+	SMeshComponent* pSecondMesh = new SMeshComponent("mesh");
+	pSecondContainer->addComponentToContainer(pSecondMesh);
+
+	renderRegistry.addContainer(pFirstContainer);
+	renderRegistry.addContainer(pSecondContainer);
+
+	REQUIRE(renderRegistry.getMeshComponents().size() == 3);
+	REQUIRE(renderRegistry.getRuntimeMeshComponents().size() == 1);
+	REQUIRE(renderRegistry.getComponentCount() == 4);
+	REQUIRE(renderRegistry.isComponentRegistered(pChildMesh));
+	REQUIRE(renderRegistry.isComponentRegistered(pTarget) == false);
+
+	// Remove the first container so the second container's mesh is moved.
+
+	renderRegistry.removeContainer(pFirstContainer);
+
+	REQUIRE(renderRegistry.getMeshComponents().size() == 1);
+	REQUIRE(renderRegistry.getMeshComponents()[0] == pSecondMesh);
+	REQUIRE(renderRegistry.getRuntimeMeshComponents().empty());
+	REQUIRE(renderRegistry.isComponentRegistered(pMesh) == false);
+	REQUIRE(renderRegistry.isComponentRegistered(pRuntimeMesh) == false);
+
+	renderRegistry.removeContainer(pSecondContainer);
+
+	REQUIRE(renderRegistry.getComponentCount() == 0);
+
+	delete pFirstContainer;
+	delete pSecondContainer;
+}
+
+TEST_CASE("Benchmark per-frame iteration over spawned mesh components.", "[.][benchmark][SRenderRegistryTests::benchmarkIteration]") {
+	const size_t vComponentCounts[] = { 10000, 100000 };
+
+	for (size_t iTest = 0; iTest < 2; iTest++)
+	{
+		SRenderRegistry renderRegistry;
+		std::vector<SContainer*> vContainers;
+
+		createMeshContainers(vComponentCounts[iTest], vContainers);
+
+		for (size_t i = 0; i < vContainers.size(); i++)
+		{
+			renderRegistry.addContainer(vContainers[i]);
+		}
+
+		const std::string sCount = std::to_string(vComponentCounts[iTest]);
+
+		BENCHMARK("recursive walk with dynamic_cast: " + sCount + " components") {
+			size_t iVisibleCount = 0;
+
+			for (size_t i = 0; i < vContainers.size(); i++)
+			{
+				std::vector<SComponent*> vComponents = vContainers[i]->getComponents();
+				for (size_t j = 0; j < vComponents.size(); j++)
+				{
+					walkComponentAndChilds(vComponents[j], iVisibleCount);
+				}
+			}
+
+			return iVisibleCount;
+		};
+
+		BENCHMARK("render registry: " + sCount + " components") {
+			size_t iVisibleCount = 0;
+
+			const std::vector<SMeshComponent*>& vMeshComponents = renderRegistry.getMeshComponents();
+			for (size_t i = 0; i < vMeshComponents.size(); i++)
+			{
+				if (vMeshComponents[i]->isVisible())
+				{
+					iVisibleCount++;
+				}
+			}
+
+			return iVisibleCount;
+		};
+
+		for (size_t i = 0; i < vContainers.size(); i++)
+		{
+			renderRegistry.removeContainer(vContainers[i]);
+			delete vContainers[i];
+		}
+	}
+}
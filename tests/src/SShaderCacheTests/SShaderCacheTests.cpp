@@ -0,0 +1,144 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <fstream>
+#include <filesystem>
+
+// Custom
+#include "SilentEngine/Private/SShaderCache/SShaderCache.h"
+
+static void writeTextFile(const std::filesystem::path& path, const std::string& sText)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file << sText;
+}
+
+TEST_CASE("Shader keys depend on the source, includes and compile options.", "[SShaderCacheTests::computeShaderKey]") {
+	const std::filesystem::path dir = "shader_cache_key_test";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir / "include");
+
+	writeTextFile(dir / "shader.hlsl", "#include \"include/common.hlsl\"\nfloat4 PS() : SV_Target { return COLOR; }\n");
+	writeTextFile(dir / "include/common.hlsl", "#include \"light.hlsl\"\n#define COLOR float4(1, 0, 0, 1)\n");
+	writeTextFile(dir / "include/light.hlsl", "// light\n");
+
+	const std::wstring sPathToShader = (dir / "shader.hlsl").wstring();
+	std::vector<std::pair<std::string, std::string>> vNoDefines;
+
+	uint64_t iKey = 0;
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_0", true, iKey) == false);
+
+	// Same input gives the same key.
+	uint64_t iSameKey = 0;
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_0", true, iSameKey) == false);
+	REQUIRE(iKey == iSameKey);
+
+	// Compile options.
+	uint64_t iOtherKey = 0;
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_0", false, iOtherKey) == false);
+	REQUIRE(iOtherKey != iKey);
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_5", true, iOtherKey) == false);
+	REQUIRE(iOtherKey != iKey);
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"VS", L"ps_6_0", true, iOtherKey) == false);
+	REQUIRE(iOtherKey != iKey);
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, { { "ALPHA_TEST", "1" } }, L"PS", L"ps_6_0", true, iOtherKey) == false);
+	REQUIRE(iOtherKey != iKey);
+
+	// Include of the include changed.
+	writeTextFile(dir / "include/light.hlsl", "// light 2\n");
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_0", true, iOtherKey) == false);
+	REQUIRE(iOtherKey != iKey);
+
+	// Back to the original content.
+	writeTextFile(dir / "include/light.hlsl", "// light\n");
+	REQUIRE(SShaderCache::computeShaderKey(sPathToShader, vNoDefines, L"PS", L"ps_6_0", true, iOtherKey) == false);
+	REQUIRE(iOtherKey == iKey);
+
+	// Missing file.
+	REQUIRE(SShaderCache::computeShaderKey((dir / "missing.hlsl").wstring(), vNoDefines, L"PS", L"ps_6_0", true, iOtherKey));
+
+	std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("Store and load cache entries.", "[SShaderCacheTests::storeLoad]") {
+	const std::filesystem::path dir = "shader_cache_store_test";
+	std::filesystem::remove_all(dir);
+
+	SShaderCache cache;
+
+	std::vector<char> vData;
+
+	// Disabled until the directory is set.
+	REQUIRE(cache.isEnabled() == false);
+	REQUIRE(cache.store(SShaderCacheEntryType::SCET_SHADER, 1, "abc", 3));
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_SHADER, 1, vData));
+
+	REQUIRE(cache.setCacheDirectory(dir.wstring()) == false);
+	REQUIRE(cache.isEnabled());
+	REQUIRE(std::filesystem::is_directory(dir));
+
+	const std::string sBlob = "compiled shader";
+	REQUIRE(cache.store(SShaderCacheEntryType::SCET_SHADER, 42, sBlob.data(), sBlob.size()) == false);
+
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_SHADER, 42, vData) == false);
+	REQUIRE(std::string(vData.begin(), vData.end()) == sBlob);
+
+	// Other key and other type with the same key.
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_SHADER, 43, vData));
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_PSO, 42, vData));
+
+	REQUIRE(cache.store(SShaderCacheEntryType::SCET_PSO, 42, "pso", 3) == false);
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_PSO, 42, vData) == false);
+	REQUIRE(std::string(vData.begin(), vData.end()) == "pso");
+
+	SShaderCacheStats stats = cache.getStats();
+	REQUIRE(stats.iShaderHits == 1);
+	REQUIRE(stats.iShaderMisses == 2);
+	REQUIRE(stats.iPSOHits == 1);
+	REQUIRE(stats.iPSOMisses == 1);
+	REQUIRE(stats.iBytesRead == sBlob.size() + 3);
+	REQUIRE(stats.iBytesWritten > sBlob.size() + 3);
+
+	// A new cache (next start of the application) sees the entries.
+	{
+		SShaderCache newCache;
+		REQUIRE(newCache.setCacheDirectory(dir.wstring()) == false);
+		REQUIRE(newCache.load(SShaderCacheEntryType::SCET_SHADER, 42, vData) == false);
+
+		newCache.setEnabled(false);
+		REQUIRE(newCache.load(SShaderCacheEntryType::SCET_SHADER, 42, vData));
+
+		REQUIRE(newCache.getStats().iShaderHits == 1);
+		REQUIRE(newCache.getStats().iShaderMisses == 1);
+	}
+
+	// Corrupted entry is a miss.
+	for (const auto& entry : std::filesystem::directory_iterator(dir))
+	{
+		if (entry.path().extension() == ".dxil")
+		{
+			std::fstream file(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+			file.seekp(-1, std::ios::end);
+			file.put('X');
+		}
+	}
+
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_SHADER, 42, vData));
+
+	cache.resetStats();
+	REQUIRE(cache.getStats().iShaderMisses == 0);
+
+	// Clear.
+	REQUIRE(cache.clear() == false);
+	REQUIRE(cache.load(SShaderCacheEntryType::SCET_PSO, 42, vData));
+	REQUIRE(std::filesystem::is_empty(dir));
+
+	std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,125 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <atomic>
+
+// Custom
+#include "SilentEngine/Private/SShaderCompiler/SShaderCompiler.h"
+
+TEST_CASE("Jobs run without started workers.", "[SShaderCompilerTests::runInline]") {
+	SShaderCompiler compiler;
+
+	std::thread::id callerId = std::this_thread::get_id();
+
+	std::shared_future<std::thread::id> future = compiler.submit<std::thread::id>([]() { return std::this_thread::get_id(); });
+
+	REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	REQUIRE(future.get() == callerId);
+}
+
+TEST_CASE("Jobs run on the workers.", "[SShaderCompilerTests::submit]") {
+	SShaderCompiler compiler;
+	compiler.start(4);
+
+	REQUIRE(compiler.getThreadCount() == 4);
+
+	std::vector<std::shared_future<int>> vFutures;
+	for (int i = 0; i < 100; i++)
+	{
+		vFutures.push_back(compiler.submit<int>([i]() { return i * i; }));
+	}
+
+	for (int i = 0; i < 100; i++)
+	{
+		REQUIRE(vFutures[i].get() == i * i);
+	}
+
+	// Futures can be waited on by several owners.
+	std::shared_future<int> copy = vFutures[10];
+	REQUIRE(copy.get() == 100);
+
+	compiler.stop();
+
+	REQUIRE(compiler.getThreadCount() == 0);
+}
+
+TEST_CASE("Independent jobs run concurrently.", "[SShaderCompilerTests::concurrency]") {
+	SShaderCompiler compiler;
+	compiler.start(4);
+
+	std::atomic<int> iRunning{0};
+	std::atomic<int> iMaxRunning{0};
+
+	auto job = [&]() -> bool
+	{
+		int iNow = ++iRunning;
+
+		int iMax = iMaxRunning.load();
+		while (iNow > iMax && iMaxRunning.compare_exchange_weak(iMax, iNow) == false)
+		{
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		iRunning--;
+
+		return true;
+	};
+
+	std::vector<std::shared_future<bool>> vFutures;
+	for (int i = 0; i < 8; i++)
+	{
+		vFutures.push_back(compiler.submit<bool>(job));
+	}
+
+	for (size_t i = 0; i < vFutures.size(); i++)
+	{
+		REQUIRE(vFutures[i].get());
+	}
+
+	REQUIRE(iMaxRunning.load() > 1);
+	REQUIRE(iMaxRunning.load() <= 4);
+}
+
+TEST_CASE("Stop finishes the queued jobs.", "[SShaderCompilerTests::stop]") {
+	SShaderCompiler compiler;
+	compiler.start(1);
+
+	std::atomic<int> iFinished{0};
+
+	std::vector<std::shared_future<bool>> vFutures;
+	for (int i = 0; i < 10; i++)
+	{
+		vFutures.push_back(compiler.submit<bool>([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			iFinished++;
+			return true;
+		}));
+	}
+
+	compiler.stop();
+
+	REQUIRE(iFinished.load() == 10);
+	REQUIRE(compiler.getQueuedJobCount() == 0);
+
+	for (size_t i = 0; i < vFutures.size(); i++)
+	{
+		REQUIRE(vFutures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+	}
+
+	// After stop the jobs run on the calling thread.
+	std::shared_future<int> future = compiler.submit<int>([]() { return 5; });
+	REQUIRE(future.get() == 5);
+
+	// Can be started again.
+	compiler.start(2);
+	REQUIRE(compiler.submit<int>([]() { return 7; }).get() == 7);
+}
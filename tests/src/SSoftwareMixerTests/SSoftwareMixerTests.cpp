@@ -0,0 +1,624 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+
+// Custom
+#include "SilentEngine/Private/AudioEngine/SSoftwareMixer/ssoftwaremixer.h"
+#include "SilentEngine/Private/AudioEngine/SSoftwareMixer/smixerkernels.h"
+#include "SilentEngine/Private/AudioEngine/SAudioOutputSink/snullaudiooutputsink.h"
+#include "SilentEngine/Private/AudioEngine/SAudioOutputSink/swavefileaudiooutputsink.h"
+
+static std::shared_ptr<const SDecodedAudio> makeSound(unsigned short iChannels, unsigned long iSampleRate, const std::vector<int16_t>& vSamples)
+{
+	std::shared_ptr<SDecodedAudio> pDecodedAudio = std::make_shared<SDecodedAudio>();
+	pDecodedAudio->format.iFormatTag = 1; // WAVE_FORMAT_PCM
+	pDecodedAudio->format.iChannels = iChannels;
+	pDecodedAudio->format.iSampleRate = iSampleRate;
+	pDecodedAudio->format.iBitsPerSample = 16;
+
+	pDecodedAudio->vPCMData.resize(vSamples.size() * sizeof(int16_t));
+	memcpy(pDecodedAudio->vPCMData.data(), vSamples.data(), pDecodedAudio->vPCMData.size());
+
+	return pDecodedAudio;
+}
+
+static std::vector<int16_t> makeSine(size_t iChannels, unsigned long iSampleRate, double dFrequency, size_t iFrameCount, double dAmplitude)
+{
+	std::vector<int16_t> vSamples(iFrameCount * iChannels);
+	for (size_t i = 0; i < iFrameCount; i++)
+	{
+		for (size_t iChannel = 0; iChannel < iChannels; iChannel++)
+		{
+			// Channels have different phases.
+			const double dValue = dAmplitude * std::sin(6.283185307179586 * dFrequency * i / iSampleRate + iChannel * 1.5);
+			vSamples[i * iChannels + iChannel] = static_cast<int16_t>(std::lround(dValue * 32767.0));
+		}
+	}
+
+	return vSamples;
+}
+
+static std::vector<int16_t> makeNoise(size_t iSampleCount, uint32_t iSeed)
+{
+	std::vector<int16_t> vSamples(iSampleCount);
+	for (size_t i = 0; i < iSampleCount; i++)
+	{
+		iSeed = iSeed * 1664525u + 1013904223u;
+		vSamples[i] = static_cast<int16_t>(iSeed >> 16);
+	}
+
+	return vSamples;
+}
+
+// Scalar version of SMixerKernels::resampleToFloat().
+static size_t resampleReference(const std::vector<int16_t>& vSource, size_t iChannels, double& dPosition, double dStep, bool bLoop,
+	std::vector<float>& vOutLeft, std::vector<float>& vOutRight, size_t iFrameCount)
+{
+	const size_t iSourceFrameCount = vSource.size() / iChannels;
+
+	for (size_t i = 0; i < iFrameCount; i++)
+	{
+		if (dPosition >= iSourceFrameCount)
+		{
+			if (bLoop == false)
+			{
+				return i;
+			}
+
+			dPosition = std::fmod(dPosition, static_cast<double>(iSourceFrameCount));
+		}
+
+		const size_t iFirst = static_cast<size_t>(dPosition);
+		const size_t iSecond = (iFirst + 1 < iSourceFrameCount) ? iFirst + 1 : (bLoop ? 0 : iFirst);
+		const float fFraction = static_cast<float>(dPosition - iFirst);
+
+		for (size_t iChannel = 0; iChannel < iChannels; iChannel++)
+		{
+			const float fA = vSource[iFirst * iChannels + iChannel];
+			const float fB = vSource[iSecond * iChannels + iChannel];
+
+			((iChannel == 0) ? vOutLeft : vOutRight)[i] = (fA + (fB - fA) * fFraction) / 32768.0f;
+		}
+
+		dPosition += dStep;
+	}
+
+	return iFrameCount;
+}
+
+// A fixed scene: resampled, pitched, looped, panned and stopped voices on two buses.
+static std::vector<float> renderGoldenScene()
+{
+	SSoftwareMixer mixer(48000, 480, 16, 4);
+
+	size_t iMusicBus = 0;
+	size_t iEffectsBus = 0;
+	REQUIRE(mixer.createBus(iMusicBus) == false);
+	REQUIRE(mixer.createBus(iEffectsBus) == false);
+
+	mixer.setBusVolume(iMusicBus, 0.8f);
+
+	SMixerVoiceDesc music;
+	music.pDecodedAudio = makeSound(2, 44100, makeSine(2, 44100, 220.0, 4410, 0.4));
+	music.bLoop = true;
+	music.iBusIndex = iMusicBus;
+
+	SMixerVoiceDesc beep;
+	beep.pDecodedAudio = makeSound(1, 48000, makeSine(1, 48000, 1000.0, 9000, 0.4));
+	beep.fPan = -0.5f;
+	beep.fPitch = 1.25f;
+	beep.iBusIndex = iEffectsBus;
+
+	SMixerVoiceDesc noise;
+	noise.pDecodedAudio = makeSound(1, 22050, makeNoise(22050, 7));
+	noise.fVolume = 0.25f;
+	noise.fPan = 0.75f;
+	noise.bLoop = true;
+	noise.iBusIndex = iEffectsBus;
+
+	size_t iMusicId = 0;
+	size_t iBeepId = 0;
+	size_t iNoiseId = 0;
+	REQUIRE(mixer.playVoice(music, iMusicId) == false);
+	REQUIRE(mixer.playVoice(beep, iBeepId) == false);
+	REQUIRE(mixer.playVoice(noise, iNoiseId) == false);
+
+	const size_t iFrameCount = 48000 / 4;
+	std::vector<float> vOutput(iFrameCount * 2);
+
+	// Changes between blocks.
+	mixer.mix(vOutput.data(), 4800);
+
+	mixer.setVoicePan(iNoiseId, -0.75f);
+	mixer.setVoiceVolume(iMusicId, 0.5f);
+	mixer.setBusVolume(iEffectsBus, 0.6f);
+	mixer.mix(vOutput.data() + 4800 * 2, 2400);
+
+	mixer.stopVoice(iNoiseId);
+	mixer.setVoicePitch(iMusicId, 0.9f);
+	mixer.setBusVolume(SSoftwareMixer::iMasterBusIndex, 0.9f);
+	mixer.mix(vOutput.data() + 7200 * 2, iFrameCount - 7200);
+
+	return vOutput;
+}
+
+TEST_CASE("SIMD kernels match the scalar reference.", "[SSoftwareMixerTests::kernels]") {
+	for (size_t iChannels = 1; iChannels <= 2; iChannels++)
+	{
+		const std::vector<int16_t> vSource = makeNoise(1003 * iChannels, static_cast<uint32_t>(iChannels));
+
+		// Same rate, slower, faster, looped and not looped.
+		const double vSteps[] = { 1.0, 0.73, 1.5, 44100.0 / 48000.0 };
+
+		for (double dStep : vSteps)
+		{
+			for (int iLoop = 0; iLoop < 2; iLoop++)
+			{
+				const bool bLoop = (iLoop == 1);
+
+				double dPosition = 3.0;
+				double dReferencePosition = 3.0;
+
+				std::vector<float> vLeft(701), vRight(701), vReferenceLeft(701), vReferenceRight(701);
+
+				size_t iProducedTotal = 0;
+				size_t iReferenceProducedTotal = 0;
+
+				// Several calls, like mixer blocks.
+				for (size_t iCall = 0; iCall < 4; iCall++)
+				{
+					const size_t iProduced = SMixerKernels::resampleToFloat(vSource.data(), vSource.size() / iChannels, iChannels, dPosition, dStep, bLoop,
+						vLeft.data(), vRight.data(), 701);
+					const size_t iReferenceProduced = resampleReference(vSource, iChannels, dReferencePosition, dStep, bLoop,
+						vReferenceLeft, vReferenceRight, 701);
+
+					REQUIRE(iProduced == iReferenceProduced);
+					REQUIRE(dPosition == dReferencePosition);
+
+					for (size_t i = 0; i < iProduced; i++)
+					{
+						REQUIRE(vLeft[i] == Approx(vReferenceLeft[i]).margin(1e-6));
+						if (iChannels == 2)
+						{
+							REQUIRE(vRight[i] == Approx(vReferenceRight[i]).margin(1e-6));
+						}
+					}
+
+					iProducedTotal += iProduced;
+					iReferenceProducedTotal += iReferenceProduced;
+				}
+
+				if (bLoop)
+				{
+					REQUIRE(iProducedTotal == 701 * 4);
+				}
+				else
+				{
+					REQUIRE(iProducedTotal < 701 * 4);
+				}
+			}
+		}
+	}
+
+
+	// Gain ramp and interleaving (odd size for the scalar tail).
+
+	const size_t iFrameCount = 37;
+
+	std::vector<float> vSourceLeft(iFrameCount), vSourceRight(iFrameCount);
+	for (size_t i = 0; i < iFrameCount; i++)
+	{
+		vSourceLeft[i] = 0.1f * static_cast<float>(i % 11) - 0.5f;
+		vSourceRight[i] = 0.05f * static_cast<float>(i % 7);
+	}
+
+	std::vector<float> vOutLeft(iFrameCount, 0.25f), vOutRight(iFrameCount, -0.25f);
+	SMixerKernels::mixToStereo(vSourceLeft.data(), vSourceRight.data(), 1.0f, 0.0f, 0.5f, 2.0f, vOutLeft.data(), vOutRight.data(), iFrameCount);
+
+	for (size_t i = 0; i < iFrameCount; i++)
+	{
+		const float fLeftGain = 1.0f + (0.0f - 1.0f) * i / iFrameCount;
+		const float fRightGain = 0.5f + (2.0f - 0.5f) * i / iFrameCount;
+
+		REQUIRE(vOutLeft[i] == Approx(0.25f + vSourceLeft[i] * fLeftGain).margin(1e-6));
+		REQUIRE(vOutRight[i] == Approx(-0.25f + vSourceRight[i] * fRightGain).margin(1e-6));
+	}
+
+	std::vector<float> vInterleaved(iFrameCount * 2);
+	SMixerKernels::interleaveStereo(vOutLeft.data(), vOutRight.data(), 3.0f, vInterleaved.data(), iFrameCount);
+
+	for (size_t i = 0; i < iFrameCount; i++)
+	{
+		REQUIRE(vInterleaved[i * 2] == Approx(std::min(std::max(vOutLeft[i] * 3.0f, -1.0f), 1.0f)));
+		REQUIRE(vInterleaved[i * 2 + 1] == Approx(std::min(std::max(vOutRight[i] * 3.0f, -1.0f), 1.0f)));
+	}
+
+
+	// Pan.
+
+	float fLeftGain = 0.0f;
+	float fRightGain = 0.0f;
+
+	SMixerKernels::getPanGains(1.0f, 0.0f, 1, fLeftGain, fRightGain);
+	REQUIRE(fLeftGain == Approx(std::sqrt(0.5f)));
+	REQUIRE(fRightGain == Approx(std::sqrt(0.5f)));
+
+	SMixerKernels::getPanGains(0.5f, -1.0f, 1, fLeftGain, fRightGain);
+	REQUIRE(fLeftGain == Approx(0.5f));
+	REQUIRE(fRightGain == Approx(0.0f).margin(1e-6));
+
+	SMixerKernels::getPanGains(1.0f, 0.5f, 2, fLeftGain, fRightGain);
+	REQUIRE(fLeftGain == Approx(0.5f));
+	REQUIRE(fRightGain == Approx(1.0f));
+}
+
+TEST_CASE("Voices are mixed into buses.", "[SSoftwareMixerTests::buses]") {
+	const size_t iFramesPerBlock = 64;
+
+	SSoftwareMixer mixer(48000, iFramesPerBlock, 2, 3);
+
+	size_t iBus = 0;
+	size_t iChildBus = 0;
+	REQUIRE(mixer.createBus(iBus) == false);
+	REQUIRE(mixer.createBus(iChildBus, iBus) == false);
+	REQUIRE(iBus == 1);
+	REQUIRE(iChildBus == 2);
+
+	size_t iNoBus = 0;
+	REQUIRE(mixer.createBus(iNoBus) == true);
+
+	// Constant 0.5 stereo on the child bus.
+	SMixerVoiceDesc voice;
+	voice.pDecodedAudio = makeSound(2, 48000, std::vector<int16_t>(iFramesPerBlock * 4 * 2, 16384));
+	voice.iBusIndex = iChildBus;
+
+	size_t iVoiceId = 0;
+	REQUIRE(mixer.playVoice(voice, iVoiceId) == false);
+
+	std::vector<float> vOutput(iFramesPerBlock * 2);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.5f));
+	REQUIRE(vOutput[iFramesPerBlock * 2 - 1] == Approx(0.5f));
+
+	// Volume of the parent is ramped over the block.
+	mixer.setBusVolume(iBus, 0.5f);
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.5f));
+	REQUIRE(vOutput[iFramesPerBlock * 2 - 1] < 0.26f);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.25f));
+	REQUIRE(vOutput[iFramesPerBlock * 2 - 1] == Approx(0.25f));
+
+	// The sound ends on the next block.
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(mixer.getStats().iActiveVoiceCount == 1);
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.0f));
+	REQUIRE(mixer.getStats().iActiveVoiceCount == 0);
+
+
+	// Voice limit and stop.
+
+	voice.bLoop = true;
+
+	size_t vVoiceIds[3];
+	for (size_t i = 0; i < 3; i++)
+	{
+		REQUIRE(mixer.playVoice(voice, vVoiceIds[i]) == false);
+	}
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+
+	SSoftwareMixerStats stats = mixer.getStats();
+	REQUIRE(stats.iActiveVoiceCount == 2);
+	REQUIRE(stats.iDroppedVoiceCount == 1);
+
+	// Faded out over one block.
+	mixer.stopVoice(vVoiceIds[0]);
+	mixer.stopVoice(vVoiceIds[1]);
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.5f));
+	REQUIRE(std::fabs(vOutput[iFramesPerBlock * 2 - 1]) < 0.01f);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == 0.0f);
+	REQUIRE(mixer.getStats().iActiveVoiceCount == 0);
+
+	// Unsupported format.
+	SMixerVoiceDesc wrongVoice = voice;
+	std::shared_ptr<SDecodedAudio> pFloatAudio = std::make_shared<SDecodedAudio>(*voice.pDecodedAudio);
+	pFloatAudio->format.iBitsPerSample = 32;
+	wrongVoice.pDecodedAudio = pFloatAudio;
+	REQUIRE(mixer.playVoice(wrongVoice, iVoiceId) == true);
+}
+
+TEST_CASE("Released buses are reused.", "[SSoftwareMixerTests::releaseBus]") {
+	const size_t iFramesPerBlock = 64;
+	const size_t iMaxBusCount = 4;
+
+	SSoftwareMixer mixer(48000, iFramesPerBlock, 2, iMaxBusCount);
+
+	// Like sound mixes that are created and destroyed while the mixer is not started,
+	// bus changes don't fill the command ring.
+	for (size_t i = 0; i < 10000; i++)
+	{
+		size_t iBus = 0;
+		REQUIRE(mixer.createBus(iBus) == false);
+		REQUIRE(iBus == 1);
+
+		mixer.setBusVolume(iBus, 0.5f);
+
+		REQUIRE(mixer.releaseBus(iBus) == false);
+	}
+
+	// Children have higher indices than their parents, parents with children are not released.
+	size_t iParentBus = 0;
+	size_t iChildBus = 0;
+	REQUIRE(mixer.createBus(iParentBus) == false);
+	REQUIRE(mixer.createBus(iChildBus, iParentBus) == false);
+	REQUIRE(iChildBus > iParentBus);
+	REQUIRE(mixer.releaseBus(iParentBus) == true);
+	REQUIRE(mixer.releaseBus(SSoftwareMixer::iMasterBusIndex) == true);
+	REQUIRE(mixer.releaseBus(iChildBus) == false);
+	REQUIRE(mixer.releaseBus(iChildBus) == true);
+	REQUIRE(mixer.releaseBus(iParentBus) == false);
+
+	// Voices of a released bus are stopped.
+	SMixerVoiceDesc voice;
+	voice.pDecodedAudio = makeSound(2, 48000, std::vector<int16_t>(iFramesPerBlock * 2, 16384));
+	voice.bLoop = true;
+	REQUIRE(mixer.createBus(voice.iBusIndex) == false);
+
+	size_t iVoiceId = 0;
+	REQUIRE(mixer.playVoice(voice, iVoiceId) == false);
+
+	std::vector<float> vOutput(iFramesPerBlock * 2);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.5f));
+
+	REQUIRE(mixer.releaseBus(voice.iBusIndex) == false);
+	REQUIRE(mixer.playVoice(voice, iVoiceId) == true);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == 0.0f);
+	REQUIRE(mixer.getStats().iActiveVoiceCount == 0);
+
+	// The same index is used by the new bus, the new bus starts with the full volume.
+	size_t iNewBus = 0;
+	REQUIRE(mixer.createBus(iNewBus) == false);
+	REQUIRE(iNewBus == voice.iBusIndex);
+	REQUIRE(mixer.playVoice(voice, iVoiceId) == false);
+
+	mixer.mix(vOutput.data(), iFramesPerBlock);
+	REQUIRE(vOutput[0] == Approx(0.5f));
+	REQUIRE(mixer.getStats().iActiveVoiceCount == 1);
+
+	// Buses are created and released while the mixer thread runs.
+	SNullAudioOutputSink sink;
+	REQUIRE(mixer.start(&sink) == false);
+
+	for (size_t i = 0; i < 10000; i++)
+	{
+		size_t iBus = 0;
+		REQUIRE(mixer.createBus(iBus) == false);
+
+		mixer.setBusVolume(iBus, 0.5f);
+
+		REQUIRE(mixer.releaseBus(iBus) == false);
+	}
+
+	mixer.stop();
+
+	size_t iLastBus = 0;
+	REQUIRE(mixer.createBus(iLastBus) == false);
+	REQUIRE(mixer.createBus(iLastBus) == false);
+	REQUIRE(mixer.createBus(iLastBus) == true);
+}
+
+TEST_CASE("Mixed output matches the golden file.", "[SSoftwareMixerTests::golden]") {
+	const std::vector<float> vOutput = renderGoldenScene();
+
+	unsigned long iSampleRate = 0;
+	size_t iChannelCount = 0;
+	std::vector<float> vGolden;
+	REQUIRE(SWaveFileAudioOutputSink::readWaveFile(L"assets/mixer_golden.wav", iSampleRate, iChannelCount, vGolden) == false);
+
+	REQUIRE(iSampleRate == 48000);
+	REQUIRE(iChannelCount == 2);
+	REQUIRE(vGolden.size() == vOutput.size());
+
+	float fMaxDifference = 0.0f;
+	for (size_t i = 0; i < vOutput.size(); i++)
+	{
+		fMaxDifference = std::max(fMaxDifference, std::fabs(vOutput[i] - vGolden[i]));
+	}
+
+	REQUIRE(fMaxDifference < 1e-5f);
+}
+
+TEST_CASE("The WAV file sink writes what the mixer thread mixed.", "[SSoftwareMixerTests::wave]") {
+	const std::wstring sPathToFile = L"mixer_test_output.wav";
+
+	{
+		SSoftwareMixer mixer(44100, 441, 4, 1);
+
+		SMixerVoiceDesc voice;
+		voice.pDecodedAudio = makeSound(1, 44100, makeSine(1, 44100, 440.0, 44100, 0.5));
+		voice.fPan = -1.0f;
+
+		size_t iVoiceId = 0;
+		REQUIRE(mixer.playVoice(voice, iVoiceId) == false);
+
+		SWaveFileAudioOutputSink sink(sPathToFile);
+		REQUIRE(mixer.start(&sink) == false);
+		REQUIRE(mixer.isStarted());
+
+		while (mixer.getStats().iMixedBlockCount < 50)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		mixer.stop();
+		REQUIRE(mixer.isStarted() == false);
+	}
+
+	unsigned long iSampleRate = 0;
+	size_t iChannelCount = 0;
+	std::vector<float> vSamples;
+	REQUIRE(SWaveFileAudioOutputSink::readWaveFile(sPathToFile, iSampleRate, iChannelCount, vSamples) == false);
+
+	REQUIRE(iSampleRate == 44100);
+	REQUIRE(iChannelCount == 2);
+	REQUIRE(vSamples.size() >= 50 * 441 * 2);
+
+	// Panned left, ended after 1 second.
+	const std::vector<int16_t> vSource = makeSine(1, 44100, 440.0, 44100, 0.5);
+	for (size_t i = 0; i < vSamples.size() / 2; i++)
+	{
+		const float fExpected = (i < vSource.size()) ? vSource[i] / 32768.0f : 0.0f;
+
+		REQUIRE(vSamples[i * 2] == Approx(fExpected).margin(1e-6));
+		REQUIRE(vSamples[i * 2 + 1] == Approx(0.0f).margin(1e-6));
+	}
+
+	std::remove("mixer_test_output.wav");
+}
+
+TEST_CASE("Voices are controlled from other threads while the mixer thread runs.", "[SSoftwareMixerTests::threads]") {
+	SSoftwareMixer mixer(48000, 240, 32, 8);
+
+	SNullAudioOutputSink sink;
+	REQUIRE(mixer.start(&sink) == false);
+
+	std::shared_ptr<const SDecodedAudio> pSound = makeSound(1, 44100, makeSine(1, 44100, 300.0, 2000, 0.5));
+
+	const size_t iThreadCount = 4;
+	const size_t iVoicesPerThread = 200;
+
+	std::atomic<bool> bError{ false };
+
+	std::vector<std::thread> vThreads;
+	for (size_t iThread = 0; iThread < iThreadCount; iThread++)
+	{
+		vThreads.push_back(std::thread([&, iThread]()
+		{
+			size_t iBus = 0;
+			if (mixer.createBus(iBus))
+			{
+				bError = true;
+				return;
+			}
+
+			for (size_t i = 0; i < iVoicesPerThread; i++)
+			{
+				SMixerVoiceDesc voice;
+				voice.pDecodedAudio = pSound;
+				voice.iBusIndex = iBus;
+				voice.bLoop = (i % 3 == 0);
+
+				size_t iVoiceId = 0;
+				if (mixer.playVoice(voice, iVoiceId))
+				{
+					bError = true;
+					return;
+				}
+
+				mixer.setVoicePan(iVoiceId, (i % 5) * 0.25f - 0.5f);
+				mixer.setBusVolume(iBus, (i % 4) * 0.25f);
+
+				if (voice.bLoop)
+				{
+					mixer.setVoicePitch(iVoiceId, 1.1f);
+					mixer.stopVoice(iVoiceId);
+				}
+
+				if (i % 50 == 0)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		}));
+	}
+
+	for (size_t i = 0; i < vThreads.size(); i++)
+	{
+		vThreads[i].join();
+	}
+
+	REQUIRE(bError == false);
+
+	// Wait for the commands and the voices to finish.
+	const unsigned long long iBlocksBefore = mixer.getStats().iMixedBlockCount;
+	while ((mixer.getStats().iMixedBlockCount < iBlocksBefore + 20) || (mixer.getStats().iActiveVoiceCount > 0))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	mixer.stop();
+
+	SSoftwareMixerStats stats = mixer.getStats();
+	REQUIRE(stats.iActiveVoiceCount == 0);
+	REQUIRE(stats.iMixedVoiceCount > 0);
+	REQUIRE(sink.getWrittenFrameCount() == stats.iMixedBlockCount * 240);
+}
+
+TEST_CASE("Benchmark mixing 256 voices.", "[.][benchmark][SSoftwareMixerTests::benchmark]") {
+	const size_t iVoiceCount = 256;
+	const size_t iFramesPerBlock = 480;
+
+	SSoftwareMixer mixer(48000, iFramesPerBlock, iVoiceCount, 16);
+
+	std::vector<size_t> vBuses(8);
+	for (size_t i = 0; i < vBuses.size(); i++)
+	{
+		REQUIRE(mixer.createBus(vBuses[i]) == false);
+	}
+
+	// Half of the voices need resampling.
+	std::shared_ptr<const SDecodedAudio> pMonoSound = makeSound(1, 44100, makeNoise(44100, 1));
+	std::shared_ptr<const SDecodedAudio> pStereoSound = makeSound(2, 48000, makeNoise(48000 * 2, 2));
+
+	for (size_t i = 0; i < iVoiceCount; i++)
+	{
+		SMixerVoiceDesc voice;
+		voice.pDecodedAudio = (i % 2 == 0) ? pMonoSound : pStereoSound;
+		voice.fVolume = 1.0f / iVoiceCount;
+		voice.fPan = (i % 9) * 0.25f - 1.0f;
+		voice.bLoop = true;
+		voice.iBusIndex = vBuses[i % vBuses.size()];
+
+		size_t iVoiceId = 0;
+		REQUIRE(mixer.playVoice(voice, iVoiceId) == false);
+	}
+
+	std::vector<float> vOutput(iFramesPerBlock * 2);
+
+	// One block of every voice, divide the voice count by the mean to get the voices mixed per ms.
+	BENCHMARK("mix one block of 256 voices") {
+		mixer.mix(vOutput.data(), iFramesPerBlock);
+		return vOutput[0];
+	};
+
+	SSoftwareMixerStats stats = mixer.getStats();
+	REQUIRE(stats.iActiveVoiceCount == iVoiceCount);
+}
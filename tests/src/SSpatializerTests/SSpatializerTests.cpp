@@ -0,0 +1,260 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <thread>
+
+// Custom
+#include "SilentEngine/Private/AudioEngine/SSpatializer/sspatializer.h"
+
+// Same fields as X3DAUDIO_DISTANCE_CURVE_POINT.
+struct SCurvePoint
+{
+	float Distance;
+	float DSPSetting;
+};
+
+static void addEmitter(SSpatializerInput& input, uint64_t iId, float fX, float fY, float fZ, float fVelocityX = 0.0f,
+	float fDopplerScaler = 0.0f, const std::vector<SCurvePoint>& vCurve = std::vector<SCurvePoint>())
+{
+	const float vPosition[3] = { fX, fY, fZ };
+	const float vVelocity[3] = { fVelocityX, 0.0f, 0.0f };
+
+	input.addEmitter(iId, vPosition, vVelocity, 1.0f, fDopplerScaler, vCurve);
+}
+
+static void fillRandomEmitters(SSpatializerInput& input, size_t iCount, uint32_t& iState)
+{
+	auto random = [&](float fMin, float fMax)
+	{
+		iState = iState * 1664525u + 1013904223u;
+		return fMin + (fMax - fMin) * ((iState >> 8) / 16777216.0f);
+	};
+
+	const std::vector<SCurvePoint> vNoCurve;
+	const std::vector<SCurvePoint> vCurve = { { 10.0f, 1.0f }, { 20.0f, 0.5f }, { 40.0f, 0.0f } };
+
+	input.clear();
+
+	for (size_t i = 0; i < iCount; i++)
+	{
+		const float vPosition[3] = { random(-100.0f, 100.0f), random(-100.0f, 100.0f), random(-10.0f, 10.0f) };
+		const float vVelocity[3] = { random(-50.0f, 50.0f), random(-50.0f, 50.0f), 0.0f };
+
+		input.addEmitter(i, vPosition, vVelocity, random(0.5f, 3.0f), (i % 2) ? 1.0f : 0.0f, (i % 3) ? vNoCurve : vCurve);
+	}
+}
+
+TEST_CASE("Emitters are attenuated, panned and doppler shifted.", "[SSpatializerTests::spatialize]") {
+	SSpatializerListener listener;
+	listener.vRight[0] = 0.0f;
+	listener.vRight[1] = 1.0f;
+
+	SSpatializerInput input;
+	addEmitter(input, 10, 0.0f, 4.0f, 0.0f);                            // right
+	addEmitter(input, 11, 0.0f, -0.5f, 0.0f);                           // left, closer than the multiplier
+	addEmitter(input, 12, 2.0f, 0.0f, 0.0f);                            // in front
+	addEmitter(input, 13, 0.0f, 0.0f, 0.0f);                            // at the listener
+	addEmitter(input, 14, 100.0f, 0.0f, 0.0f, -40.0f, 1.0f);            // approaching
+	addEmitter(input, 15, 100.0f, 0.0f, 0.0f, -40.0f, 0.0f);            // approaching without doppler
+	addEmitter(input, 16, 15.0f, 0.0f, 0.0f, 0.0f, 0.0f, { { 10.0f, 1.0f }, { 20.0f, 0.0f } });
+
+	SSpatializerOutput output;
+	SSpatializer::compute(listener, input, output);
+
+	REQUIRE(output.vEmitterIds == input.vEmitterIds);
+
+	REQUIRE(output.vDistance[0] == Approx(4.0f));
+	REQUIRE(output.vAttenuation[0] == Approx(0.25f));
+	REQUIRE(output.vLeftGain[0] == Approx(0.0f).margin(1e-6));
+	REQUIRE(output.vRightGain[0] == Approx(0.25f));
+
+	REQUIRE(output.vAttenuation[1] == 1.0f);
+	REQUIRE(output.vLeftGain[1] == Approx(1.0f));
+	REQUIRE(output.vRightGain[1] == Approx(0.0f).margin(1e-6));
+
+	// Constant power.
+	REQUIRE(output.vLeftGain[2] == Approx(0.5f * std::sqrt(0.5f)));
+	REQUIRE(output.vRightGain[2] == Approx(0.5f * std::sqrt(0.5f)));
+
+	REQUIRE(output.vAttenuation[3] == 1.0f);
+	REQUIRE(output.vLeftGain[3] == Approx(output.vRightGain[3]));
+	REQUIRE(output.vDopplerFactor[3] == 1.0f);
+
+	REQUIRE(output.vDopplerFactor[4] == Approx(SSpatializer::fSpeedOfSound / (SSpatializer::fSpeedOfSound - 40.0f)));
+	REQUIRE(output.vDopplerFactor[5] == 1.0f);
+
+	REQUIRE(output.vAttenuation[6] == Approx(0.5f));
+}
+
+TEST_CASE("SSE2 and scalar spatialization match.", "[SSpatializerTests::simd]") {
+	SSpatializerListener listener;
+	listener.vPosition[0] = 3.0f;
+	listener.vPosition[1] = -7.0f;
+	listener.vPosition[2] = 1.5f;
+	listener.vVelocity[0] = 5.0f;
+	listener.vRight[0] = std::sqrt(0.5f);
+	listener.vRight[1] = std::sqrt(0.5f);
+
+	uint32_t iState = 7;
+
+	// Not a multiple of 4.
+	for (size_t iCount : { 1, 3, 4, 37 })
+	{
+		SSpatializerInput input;
+		fillRandomEmitters(input, iCount, iState);
+
+		SSpatializerOutput simdOutput;
+		SSpatializerOutput scalarOutput;
+
+		SSpatializer::compute(listener, input, simdOutput);
+		SSpatializer::computeScalar(listener, input, scalarOutput);
+
+		REQUIRE(simdOutput.vEmitterIds == scalarOutput.vEmitterIds);
+
+		for (size_t i = 0; i < iCount; i++)
+		{
+			REQUIRE(simdOutput.vDistance[i] == Approx(scalarOutput.vDistance[i]));
+			REQUIRE(simdOutput.vAttenuation[i] == Approx(scalarOutput.vAttenuation[i]));
+			REQUIRE(simdOutput.vDopplerFactor[i] == Approx(scalarOutput.vDopplerFactor[i]));
+			REQUIRE(simdOutput.vLeftGain[i] == Approx(scalarOutput.vLeftGain[i]).margin(1e-6));
+			REQUIRE(simdOutput.vRightGain[i] == Approx(scalarOutput.vRightGain[i]).margin(1e-6));
+		}
+	}
+}
+
+TEST_CASE("The spatialization thread publishes complete ticks.", "[SSpatializerTests::publish]") {
+	const size_t iEmitterCount = 101;
+	const unsigned long long iTickCount = 2000;
+
+	SSpatializer spatializer;
+
+	// Not started: spatialized on the calling thread.
+	REQUIRE(spatializer.getLatestOutput() == nullptr);
+
+	SSpatializerListener listener;
+	SSpatializerInput input;
+	addEmitter(input, 1, 2.0f, 0.0f, 0.0f);
+
+	spatializer.submit(listener, input);
+
+	const SSpatializerOutput* pOutput = spatializer.getLatestOutput();
+	REQUIRE(pOutput != nullptr);
+	REQUIRE(pOutput->iTick == 1);
+	REQUIRE(pOutput->vDistance[0] == Approx(2.0f));
+
+
+	REQUIRE(spatializer.start() == false);
+
+	std::atomic<bool> bDone{ false };
+	std::atomic<bool> bError{ false };
+	std::atomic<unsigned long long> iReadCount{ 0 };
+
+	// Every emitter of the tick N is at the distance N.
+	std::thread reader([&]()
+	{
+		unsigned long long iLastTick = 0;
+
+		while (bDone == false)
+		{
+			const SSpatializerOutput* pOutput = spatializer.getLatestOutput();
+			if (pOutput == nullptr)
+			{
+				continue;
+			}
+
+			if (pOutput->iTick < iLastTick)
+			{
+				bError = true;
+			}
+			iLastTick = pOutput->iTick;
+
+			if ((pOutput->iTick > 1) && (pOutput->vDistance.size() != iEmitterCount))
+			{
+				bError = true;
+			}
+
+			for (size_t i = 0; (pOutput->iTick > 1) && (i < pOutput->vDistance.size()); i++)
+			{
+				if ((pOutput->vDistance[i] != static_cast<float>(pOutput->iTick)) || (pOutput->vEmitterIds[i] != pOutput->iTick))
+				{
+					bError = true;
+				}
+			}
+
+			iReadCount++;
+		}
+	});
+
+	for (unsigned long long iTick = 2; iTick <= iTickCount; iTick++)
+	{
+		input.clear();
+
+		for (size_t i = 0; i < iEmitterCount; i++)
+		{
+			addEmitter(input, iTick, static_cast<float>(iTick), 0.0f, 0.0f);
+		}
+
+		spatializer.submit(listener, input);
+	}
+
+	spatializer.waitForIdle();
+
+	bDone = true;
+	reader.join();
+
+	REQUIRE(bError == false);
+	REQUIRE(iReadCount > 0);
+
+	pOutput = spatializer.getLatestOutput();
+	REQUIRE(pOutput->iTick == iTickCount);
+
+	spatializer.stop();
+}
+
+TEST_CASE("Benchmark spatializing 1k and 10k emitters.", "[.][benchmark][SSpatializerTests::benchmark]") {
+	SSpatializerListener listener;
+	listener.vRight[0] = 1.0f;
+
+	uint32_t iState = 1;
+
+	SSpatializerInput input1k;
+	fillRandomEmitters(input1k, 1000, iState);
+
+	SSpatializerInput input10k;
+	fillRandomEmitters(input10k, 10000, iState);
+
+	SSpatializerOutput output;
+
+	BENCHMARK("1k emitters, scalar") {
+		SSpatializer::computeScalar(listener, input1k, output);
+		return output.vDistance.size();
+	};
+
+	BENCHMARK("1k emitters, SSE2") {
+		SSpatializer::compute(listener, input1k, output);
+		return output.vDistance.size();
+	};
+
+	BENCHMARK("10k emitters, scalar") {
+		SSpatializer::computeScalar(listener, input10k, output);
+		return output.vDistance.size();
+	};
+
+	BENCHMARK("10k emitters, SSE2") {
+		SSpatializer::compute(listener, input10k, output);
+		return output.vDistance.size();
+	};
+
+	REQUIRE(output.vDistance.size() == 10000);
+}
@@ -0,0 +1,307 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// Custom
+#include "SilentEngine/Private/STextureResidency/STextureResidency.h"
+
+//@@Class
+/*
+Backend that keeps the requests until finishRequests() is called (or finishes them right away).
+*/
+class SFakeResidencyBackend : public STextureResidencyBackend
+{
+public:
+	struct SRequest
+	{
+		size_t iTextureId;
+		size_t iMostDetailedMip;
+	};
+
+	virtual bool requestResidentMips(size_t iTextureId, size_t iMostDetailedMip) override
+	{
+		if (bFailRequests)
+		{
+			return true;
+		}
+
+		vRequests.push_back({ iTextureId, iMostDetailedMip });
+		vAllRequests.push_back({ iTextureId, iMostDetailedMip });
+
+		if (bFinishRightAway)
+		{
+			finishRequests();
+		}
+
+		return false;
+	}
+
+	void finishRequests()
+	{
+		std::vector<SRequest> vFinished;
+		vFinished.swap(vRequests);
+
+		for (size_t i = 0; i < vFinished.size(); i++)
+		{
+			pManager->onMipsResident(vFinished[i].iTextureId, vFinished[i].iMostDetailedMip);
+		}
+	}
+
+	STextureResidencyManager* pManager = nullptr;
+
+	std::vector<SRequest> vRequests;
+	std::vector<SRequest> vAllRequests;
+
+	bool bFinishRightAway = true;
+	bool bFailRequests = false;
+};
+
+static std::vector<uint64_t> getSquareMipSizes(size_t iMipCount)
+{
+	// 4 bytes per pixel, the last mip is 1x1.
+
+	std::vector<uint64_t> vSizes;
+
+	for (size_t i = 0; i < iMipCount; i++)
+	{
+		uint64_t iSize = 1ULL << (iMipCount - 1 - i);
+		vSizes.push_back(iSize * iSize * 4);
+	}
+
+	return vSizes;
+}
+
+static uint64_t getMipRangeSize(const std::vector<uint64_t>& vSizes, size_t iFirstMip)
+{
+	uint64_t iSize = 0;
+
+	for (size_t i = iFirstMip; i < vSizes.size(); i++)
+	{
+		iSize += vSizes[i];
+	}
+
+	return iSize;
+}
+
+TEST_CASE("New textures get only the lowest mips.", "[STextureResidencyTests::registerTexture]") {
+	SFakeResidencyBackend backend;
+	STextureResidencyManager manager(&backend);
+	backend.pManager = &manager;
+
+	std::vector<uint64_t> vSizes = getSquareMipSizes(9); // 256x256
+
+	size_t iTexture = manager.registerTexture(vSizes, 6, vSizes.size());
+
+	REQUIRE(iTexture != STextureResidencyManager::iInvalidTextureId);
+	REQUIRE(backend.vAllRequests.size() == 1);
+	REQUIRE(backend.vAllRequests[0].iMostDetailedMip == 6);
+	REQUIRE(manager.getResidentMip(iTexture) == 6);
+	REQUIRE(manager.getStats().iUsedBytes == getMipRangeSize(vSizes, 6));
+
+	// Already resident textures are not requested.
+	size_t iResidentTexture = manager.registerTexture(vSizes, 6, 0);
+
+	REQUIRE(backend.vAllRequests.size() == 1);
+	REQUIRE(manager.getResidentMip(iResidentTexture) == 0);
+	REQUIRE(manager.getStats().iUsedBytes == getMipRangeSize(vSizes, 6) + getMipRangeSize(vSizes, 0));
+	REQUIRE(manager.getStats().iTextureCount == 2);
+
+	// Unregister.
+	manager.unregisterTexture(iResidentTexture);
+	manager.unregisterTexture(iTexture);
+
+	REQUIRE(manager.getStats().iUsedBytes == 0);
+	REQUIRE(manager.getStats().iTextureCount == 0);
+
+	// Failed initial request.
+	backend.bFailRequests = true;
+	REQUIRE(manager.registerTexture(vSizes, 6, vSizes.size()) == STextureResidencyManager::iInvalidTextureId);
+	REQUIRE(manager.getStats().iUsedBytes == 0);
+}
+
+TEST_CASE("Used textures stream in one mip per frame.", "[STextureResidencyTests::streamIn]") {
+	SFakeResidencyBackend backend;
+	STextureResidencyManager manager(&backend);
+	backend.pManager = &manager;
+
+	std::vector<uint64_t> vSizes = getSquareMipSizes(9);
+
+	size_t iUsed = manager.registerTexture(vSizes, 6, vSizes.size());
+	size_t iNotUsed = manager.registerTexture(vSizes, 6, vSizes.size());
+
+	for (size_t iFrame = 0; iFrame < 6; iFrame++)
+	{
+		manager.markTextureUsed(iUsed);
+		manager.update();
+
+		REQUIRE(manager.getResidentMip(iUsed) == 5 - iFrame);
+		REQUIRE(manager.getResidentMip(iNotUsed) == 6);
+	}
+
+	// Mip 0 is resident, nothing to request.
+	size_t iRequestCount = backend.vAllRequests.size();
+
+	manager.markTextureUsed(iUsed);
+	manager.update();
+
+	REQUIRE(backend.vAllRequests.size() == iRequestCount);
+	REQUIRE(manager.getStats().iMipsStreamedIn == 6);
+	REQUIRE(manager.getStats().iUsedBytes == getMipRangeSize(vSizes, 0) + getMipRangeSize(vSizes, 6));
+}
+
+TEST_CASE("Pending requests are not repeated.", "[STextureResidencyTests::pendingRequests]") {
+	SFakeResidencyBackend backend;
+	backend.bFinishRightAway = false;
+
+	STextureResidencyManager manager(&backend);
+	backend.pManager = &manager;
+
+	std::vector<uint64_t> vSizes = getSquareMipSizes(9);
+
+	size_t iTexture = manager.registerTexture(vSizes, 6, vSizes.size());
+	REQUIRE(manager.getStats().iPendingRequestCount == 1);
+
+	// The initial request is counted right away.
+	REQUIRE(manager.getStats().iUsedBytes == getMipRangeSize(vSizes, 6));
+
+	manager.markTextureUsed(iTexture);
+	manager.update();
+
+	REQUIRE(backend.vAllRequests.size() == 1);
+
+	backend.finishRequests();
+	REQUIRE(manager.getResidentMip(iTexture) == 6);
+
+	manager.markTextureUsed(iTexture);
+	manager.update();
+
+	REQUIRE(backend.vAllRequests.size() == 2);
+	REQUIRE(manager.getRequestedMip(iTexture) == 5);
+	REQUIRE(manager.getResidentMip(iTexture) == 6);
+
+	// Failed request returns the texture to its resident mips.
+	manager.onRequestFailed(iTexture);
+	backend.vRequests.clear();
+
+	REQUIRE(manager.getRequestedMip(iTexture) == 6);
+	REQUIRE(manager.getStats().iUsedBytes == getMipRangeSize(vSizes, 6));
+	REQUIRE(manager.getStats().iPendingRequestCount == 0);
+}
+
+TEST_CASE("Least recently used textures are evicted to fit in the budget.", "[STextureResidencyTests::evictLRU]") {
+	SFakeResidencyBackend backend;
+
+	std::vector<uint64_t> vSizes = getSquareMipSizes(9);
+	const uint64_t iFullSize = getMipRangeSize(vSizes, 0);
+	const uint64_t iTailSize = getMipRangeSize(vSizes, 6);
+
+	// Budget for 2 full textures and one texture with only the lowest mips.
+	STextureResidencyManager manager(&backend, iFullSize * 2 + iTailSize);
+	backend.pManager = &manager;
+
+	size_t iOld = manager.registerTexture(vSizes, 6, 0);
+	size_t iRecent = manager.registerTexture(vSizes, 6, 0);
+	size_t iNew = manager.registerTexture(vSizes, 6, vSizes.size());
+
+	manager.markTextureUsed(iOld);
+	manager.markTextureUsed(iRecent);
+	manager.update();
+
+	manager.markTextureUsed(iRecent);
+	manager.update();
+
+	REQUIRE(manager.getStats().iMipsEvicted == 0);
+
+	// Stream in the new texture, the old texture should lose its most detailed mips (but not the recent texture).
+	for (size_t i = 0; i < 6; i++)
+	{
+		manager.markTextureUsed(iNew);
+		manager.update();
+
+		REQUIRE(manager.getStats().iUsedBytes <= iFullSize * 2 + iTailSize);
+	}
+
+	REQUIRE(manager.getResidentMip(iNew) == 0);
+	REQUIRE(manager.getResidentMip(iRecent) == 0);
+	REQUIRE(manager.getResidentMip(iOld) == 6);
+	REQUIRE(manager.getStats().iMipsEvicted == 6);
+	REQUIRE(manager.getStats().iRequestsOverBudget == 0);
+
+
+	// Now everything is used, nothing can be evicted.
+	manager.markTextureUsed(iOld);
+	manager.markTextureUsed(iRecent);
+	manager.markTextureUsed(iNew);
+	manager.update();
+
+	REQUIRE(manager.getResidentMip(iOld) == 6);
+	REQUIRE(manager.getStats().iRequestsOverBudget == 1);
+
+
+	// Smaller budget, unused textures are evicted down to their lowest mips only.
+	manager.setBudget(iTailSize);
+	manager.update();
+
+	REQUIRE(manager.getResidentMip(iOld) == 6);
+	REQUIRE(manager.getResidentMip(iRecent) == 6);
+	REQUIRE(manager.getResidentMip(iNew) == 6);
+	REQUIRE(manager.getStats().iUsedBytes == iTailSize * 3);
+}
+
+TEST_CASE("Requested bytes per frame are limited.", "[STextureResidencyTests::maxRequestedBytesPerFrame]") {
+	SFakeResidencyBackend backend;
+	STextureResidencyManager manager(&backend);
+	backend.pManager = &manager;
+
+	std::vector<uint64_t> vSizes = getSquareMipSizes(9);
+
+	std::vector<size_t> vTextures;
+	for (size_t i = 0; i < 4; i++)
+	{
+		vTextures.push_back(manager.registerTexture(vSizes, 6, vSizes.size()));
+	}
+
+	// Enough for 2 textures to get mip 5.
+	manager.setMaxRequestedBytesPerFrame(vSizes[5] * 2);
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		manager.markTextureUsed(vTextures[i]);
+	}
+	manager.update();
+
+	size_t iStreamedTextures = 0;
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		if (manager.getResidentMip(vTextures[i]) == 5)
+		{
+			iStreamedTextures++;
+		}
+	}
+
+	REQUIRE(iStreamedTextures == 2);
+
+	// Next frame the least detailed textures go first.
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		manager.markTextureUsed(vTextures[i]);
+	}
+	manager.update();
+
+	for (size_t i = 0; i < vTextures.size(); i++)
+	{
+		REQUIRE(manager.getResidentMip(vTextures[i]) == 5);
+	}
+
+	// At least one request is made even if the mip is bigger than the limit.
+	manager.setMaxRequestedBytesPerFrame(1);
+	manager.markTextureUsed(vTextures[0]);
+	manager.update();
+
+	REQUIRE(manager.getResidentMip(vTextures[0]) == 4);
+}
@@ -0,0 +1,55 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <set>
+
+// Custom
+#include "SilentEngine/Private/SThreadPool/SThreadPool.h"
+
+TEST_CASE("Every job is run once per call on its own thread.", "[SThreadPoolTests::runJobs]") {
+	SThreadPool threadPool(3);
+
+	REQUIRE(threadPool.getWorkerCount() == 3);
+
+	// The same workers are used by all calls.
+	std::set<std::thread::id> vAllThreads;
+
+	for (size_t iCall = 0; iCall < 500; iCall++)
+	{
+		const size_t iJobs = 1 + iCall % (threadPool.getWorkerCount() + 1);
+
+		std::vector<std::atomic<size_t>> vCallCounts(iJobs);
+		std::vector<std::thread::id> vThreads(iJobs);
+
+		threadPool.runJobs(iJobs, [&](size_t iJob)
+		{
+			vCallCounts[iJob]++;
+			vThreads[iJob] = std::this_thread::get_id();
+		});
+
+		std::set<std::thread::id> vCallThreads(vThreads.begin(), vThreads.end());
+
+		REQUIRE(vCallThreads.size() == iJobs);
+		REQUIRE(vThreads[0] == std::this_thread::get_id());
+
+		for (size_t i = 0; i < iJobs; i++)
+		{
+			REQUIRE(vCallCounts[i] == 1);
+		}
+
+		vAllThreads.insert(vCallThreads.begin(), vCallThreads.end());
+	}
+
+	REQUIRE(vAllThreads.size() == threadPool.getWorkerCount() + 1);
+}
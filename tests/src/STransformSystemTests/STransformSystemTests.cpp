@@ -0,0 +1,235 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <thread>
+#include <atomic>
+
+// Custom
+#include "SilentEngine/Private/STransformSystem/STransformSystem.h"
+#include "SilentEngine/Public/EntityComponentSystem/SContainer/SContainer.h"
+#include "SilentEngine/Public/EntityComponentSystem/STargetComponent/STargetComponent.h"
+
+static SContainer* createComponentChain(const std::string& sContainerName, size_t iDepth, std::vector<SComponent*>& vOutComponents)
+{
+	SContainer* pContainer = new SContainer(sContainerName);
+
+	for (size_t i = 0; i < iDepth; i++)
+	{
+		STargetComponent* pComponent = new STargetComponent("target_" + std::to_string(i));
+
+		if (i == 0)
+		{
+			pContainer->addComponentToContainer(pComponent);
+		}
+		else
+		{
+			vOutComponents.back()->addChildComponent(pComponent);
+		}
+
+		pComponent->setLocalLocation(SVector(1.0f, 0.5f * i, 0.0f));
+		pComponent->setLocalRotation(SVector(3.0f, 5.0f, 7.0f));
+		pComponent->setLocalScale(SVector(1.01f, 1.0f, 0.99f));
+
+		vOutComponents.push_back(pComponent);
+	}
+
+	return pContainer;
+}
+
+static void requireSameWorldLocations(const std::vector<SComponent*>& vComponents, const std::vector<SComponent*>& vReferenceComponents)
+{
+	for (size_t i = 0; i < vComponents.size(); i++)
+	{
+		SVector vLocation = vComponents[i]->getLocationInWorld();
+		SVector vReferenceLocation = vReferenceComponents[i]->getLocationInWorld();
+
+		REQUIRE(vLocation.getX() == Approx(vReferenceLocation.getX()).margin(0.001f));
+		REQUIRE(vLocation.getY() == Approx(vReferenceLocation.getY()).margin(0.001f));
+		REQUIRE(vLocation.getZ() == Approx(vReferenceLocation.getZ()).margin(0.001f));
+	}
+}
+
+TEST_CASE("Transform system matches world transforms calculated using parents.", "[STransformSystemTests::matchesHierarchy]") {
+	STransformSystem transformSystem;
+
+	std::vector<SComponent*> vComponents;
+	std::vector<SComponent*> vReferenceComponents;
+
+	SContainer* pContainer = createComponentChain("container", 64, vComponents);
+	SContainer* pReferenceContainer = createComponentChain("reference", 64, vReferenceComponents);
+
+	transformSystem.addContainer(pContainer);
+
+	REQUIRE(transformSystem.getNodeCount() == 65);
+
+	requireSameWorldLocations(vComponents, vReferenceComponents);
+
+	// Move the container and one component in the middle of the chain.
+
+	pContainer->setLocation(SVector(10.0f, -2.0f, 3.0f));
+	pContainer->setRotation(SVector(0.0f, 45.0f, 0.0f));
+	vComponents[30]->setLocalRotation(SVector(0.0f, 0.0f, 90.0f));
+
+	pReferenceContainer->setLocation(SVector(10.0f, -2.0f, 3.0f));
+	pReferenceContainer->setRotation(SVector(0.0f, 45.0f, 0.0f));
+	vReferenceComponents[30]->setLocalRotation(SVector(0.0f, 0.0f, 90.0f));
+
+	transformSystem.updateWorldMatrices();
+
+	requireSameWorldLocations(vComponents, vReferenceComponents);
+
+	transformSystem.removeContainer(pContainer);
+
+	REQUIRE(transformSystem.getNodeCount() == 0);
+
+	delete pContainer;
+	delete pReferenceContainer;
+}
+
+TEST_CASE("Parent changed callback is called once after the parent is moved.", "[STransformSystemTests::parentChangedCallback]") {
+	STransformSystem transformSystem;
+
+	std::vector<SComponent*> vComponents;
+	SContainer* pContainer = createComponentChain("container", 3, vComponents);
+
+	size_t iCallCount = 0;
+	vComponents[2]->setBindOnParentLocationRotationScaleChangedCallback([&iCallCount](SComponent* pComponent) {
+		iCallCount++;
+	});
+
+	transformSystem.addContainer(pContainer);
+	transformSystem.updateWorldMatrices();
+	transformSystem.callQueuedParentChangedCallbacks();
+
+	REQUIRE(iCallCount == 0);
+
+	// Moving the component itself does not call its callback.
+	vComponents[2]->setLocalLocation(SVector(1.0f, 1.0f, 1.0f));
+	transformSystem.updateWorldMatrices();
+	transformSystem.callQueuedParentChangedCallbacks();
+
+	REQUIRE(iCallCount == 0);
+
+	// Moving the parent twice before the callbacks are called.
+	vComponents[0]->setLocalLocation(SVector(2.0f, 0.0f, 0.0f));
+	transformSystem.updateWorldMatrices();
+	pContainer->setLocation(SVector(0.0f, 5.0f, 0.0f));
+	transformSystem.updateWorldMatrices();
+	transformSystem.callQueuedParentChangedCallbacks();
+
+	REQUIRE(iCallCount == 1);
+
+	transformSystem.removeContainer(pContainer);
+
+	delete pContainer;
+}
+
+TEST_CASE("Moving components while other containers are removed changes only their nodes.", "[STransformSystemTests::concurrentRemove]") {
+	STransformSystem transformSystem;
+
+	std::vector<SComponent*> vComponents;
+	std::vector<SComponent*> vReferenceComponents;
+
+	SContainer* pContainer = createComponentChain("container", 16, vComponents);
+	SContainer* pReferenceContainer = createComponentChain("reference", 16, vReferenceComponents);
+
+	// Added before 'pContainer' so that removing it renumbers the nodes of 'pContainer'.
+	std::vector<SComponent*> vOtherComponents;
+	SContainer* pOtherContainer = createComponentChain("other", 16, vOtherComponents);
+
+	transformSystem.addContainer(pOtherContainer);
+	transformSystem.addContainer(pContainer);
+
+	std::atomic<bool> bDone{ false };
+
+	std::thread mover([&]()
+	{
+		for (size_t i = 0; i < 2000; i++)
+		{
+			vComponents[i % vComponents.size()]->setLocalLocation(SVector(1.0f, 0.5f * (i % vComponents.size()), 0.0f));
+			pContainer->setLocation(SVector(static_cast<float>(i % 7), 0.0f, 0.0f));
+		}
+
+		bDone = true;
+	});
+
+	while (bDone == false)
+	{
+		transformSystem.removeContainer(pOtherContainer);
+		transformSystem.updateWorldMatrices();
+		transformSystem.addContainer(pOtherContainer);
+	}
+
+	mover.join();
+
+	// A removed container is not changed through the system.
+	transformSystem.removeContainer(pOtherContainer);
+	vOtherComponents[0]->setLocalLocation(SVector(5.0f, 0.0f, 0.0f));
+
+	REQUIRE(transformSystem.getNodeCount() == 17);
+
+	pReferenceContainer->setLocation(SVector(static_cast<float>(1999 % 7), 0.0f, 0.0f));
+
+	transformSystem.updateWorldMatrices();
+
+	requireSameWorldLocations(vComponents, vReferenceComponents);
+
+	transformSystem.removeContainer(pContainer);
+
+	delete pContainer;
+	delete pReferenceContainer;
+	delete pOtherContainer;
+}
+
+TEST_CASE("Benchmark world transform updates of a deep hierarchy.", "[.][benchmark][STransformSystemTests::benchmarkDeepHierarchy]") {
+	STransformSystem transformSystem;
+
+	std::vector<SComponent*> vComponents;
+	std::vector<SComponent*> vReferenceComponents;
+
+	SContainer* pContainer = createComponentChain("container", 512, vComponents);
+	SContainer* pReferenceContainer = createComponentChain("reference", 512, vReferenceComponents);
+
+	transformSystem.addContainer(pContainer);
+	transformSystem.updateWorldMatrices();
+
+	float fOffset = 0.0f;
+
+	BENCHMARK("move the container, world locations calculated using parents") {
+		fOffset += 1.0f;
+		pReferenceContainer->setLocation(SVector(fOffset, 0.0f, 0.0f));
+
+		float fSum = 0.0f;
+		for (size_t i = 0; i < vReferenceComponents.size(); i++)
+		{
+			fSum += vReferenceComponents[i]->getLocationInWorld().getX();
+		}
+		return fSum;
+	};
+
+	BENCHMARK("move the container, transform system") {
+		fOffset += 1.0f;
+		pContainer->setLocation(SVector(fOffset, 0.0f, 0.0f));
+
+		transformSystem.updateWorldMatrices();
+
+		float fSum = 0.0f;
+		for (size_t i = 0; i < vComponents.size(); i++)
+		{
+			fSum += vComponents[i]->getLocationInWorld().getX();
+		}
+		return fSum;
+	};
+
+	transformSystem.removeContainer(pContainer);
+
+	delete pContainer;
+	delete pReferenceContainer;
+}
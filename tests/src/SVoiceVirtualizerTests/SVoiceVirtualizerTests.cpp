@@ -0,0 +1,190 @@
+// ******************************************************************
+// This file is part of the Silent Engine.
+// Copyright Aleksandr "Flone" Tretyakov (github.com/Flone-dnb).
+// Licensed under the ZLib license.
+// Refer to the LICENSE file included.
+// ******************************************************************
+
+#include "Common.h"
+
+// STL
+#include <vector>
+#include <cstdint>
+
+// Custom
+#include "SilentEngine/Private/AudioEngine/SVoiceVirtualizer/svoicevirtualizer.h"
+
+// Same fields as X3DAUDIO_DISTANCE_CURVE_POINT.
+struct SCurvePoint
+{
+	float Distance;
+	float DSPSetting;
+};
+
+static SVirtualVoice makeVoice(float fAudibility, int iPriority = 0, double dLengthInSec = 10.0)
+{
+	SVirtualVoice voice;
+	voice.fAudibility = fAudibility;
+	voice.iPriority = iPriority;
+	voice.dLengthInSec = dLengthInSec;
+	voice.bActive = true;
+
+	return voice;
+}
+
+TEST_CASE("Only the loudest voices stay real.", "[SVoiceVirtualizerTests::rank]") {
+	SVoiceVirtualizer virtualizer(2);
+
+	std::vector<SVirtualVoice> vVoices;
+	vVoices.push_back(makeVoice(0.2f));
+	vVoices.push_back(makeVoice(0.9f));
+	vVoices.push_back(makeVoice(0.5f));
+	vVoices.push_back(makeVoice(0.0001f)); // inaudible
+
+	virtualizer.update(vVoices, 0.0);
+
+	REQUIRE(vVoices[0].bReal == false);
+	REQUIRE(vVoices[0].bBecameVirtual);
+	REQUIRE(vVoices[1].bReal);
+	REQUIRE(vVoices[1].bBecameVirtual == false);
+	REQUIRE(vVoices[2].bReal);
+	REQUIRE(vVoices[3].bReal == false);
+
+	SVoiceVirtualizerStats stats = virtualizer.getStats();
+	REQUIRE(stats.iRealVoiceCount == 2);
+	REQUIRE(stats.iVirtualVoiceCount == 2);
+	REQUIRE(stats.iInaudibleVoiceCount == 1);
+	REQUIRE(stats.iVirtualizedCount == 2);
+
+	// Priority is more important than the audibility.
+	vVoices[0].iPriority = 1;
+	virtualizer.update(vVoices, 0.0);
+
+	REQUIRE(vVoices[0].bReal);
+	REQUIRE(vVoices[0].bBecameReal);
+	REQUIRE(vVoices[1].bReal);
+	REQUIRE(vVoices[2].bReal == false);
+	REQUIRE(vVoices[2].bBecameVirtual);
+
+	// Inactive voices are not ranked and keep their state.
+	vVoices[0].bActive = false;
+	vVoices[1].bActive = false;
+	virtualizer.update(vVoices, 0.0);
+
+	REQUIRE(vVoices[0].bReal);
+	REQUIRE(vVoices[1].bReal);
+	REQUIRE(vVoices[2].bReal);
+	REQUIRE(vVoices[3].bReal == false);
+	REQUIRE(virtualizer.getStats().iRealVoiceCount == 1);
+}
+
+TEST_CASE("Voices of similar audibility don't switch every tick.", "[SVoiceVirtualizerTests::hysteresis]") {
+	SVoiceVirtualizer virtualizer(1);
+
+	std::vector<SVirtualVoice> vVoices;
+	vVoices.push_back(makeVoice(0.5f));
+	vVoices.push_back(makeVoice(0.4f));
+
+	virtualizer.update(vVoices, 0.0);
+	REQUIRE(vVoices[0].bReal);
+	REQUIRE(vVoices[1].bReal == false);
+
+	// Slightly louder than the real voice.
+	vVoices[1].fAudibility = 0.55f;
+	virtualizer.update(vVoices, 0.0);
+	REQUIRE(vVoices[0].bReal);
+	REQUIRE(vVoices[1].bReal == false);
+
+	// Clearly louder.
+	vVoices[1].fAudibility = 0.5f * SVoiceVirtualizer::fRealVoiceBias + 0.01f;
+	virtualizer.update(vVoices, 0.0);
+	REQUIRE(vVoices[0].bReal == false);
+	REQUIRE(vVoices[1].bReal);
+	REQUIRE(vVoices[1].bBecameReal);
+}
+
+TEST_CASE("Virtual playheads advance and finish.", "[SVoiceVirtualizerTests::playhead]") {
+	SVoiceVirtualizer virtualizer(1);
+
+	std::vector<SVirtualVoice> vVoices;
+	vVoices.push_back(makeVoice(1.0f, 0, 10.0));
+	vVoices.push_back(makeVoice(0.1f, 0, 1.0));
+
+	virtualizer.update(vVoices, 0.0);
+	REQUIRE(vVoices[1].bBecameVirtual);
+
+	// The engine stores the position of the voice when it becomes virtual.
+	vVoices[1].dPositionInSec = 0.25;
+	vVoices[1].fPitch = 2.0f;
+
+	virtualizer.update(vVoices, 0.1);
+	REQUIRE(vVoices[1].dPositionInSec == Approx(0.45));
+	REQUIRE(vVoices[0].dPositionInSec == 0.0); // real voices are played by their source voices
+
+	// Becomes audible again: resumes at the advanced position.
+	vVoices[0].bActive = false;
+	virtualizer.update(vVoices, 0.1);
+	REQUIRE(vVoices[1].bBecameReal);
+	REQUIRE(vVoices[1].dPositionInSec == Approx(0.65));
+
+	// Virtual again until the end of the sound.
+	vVoices[0].bActive = true;
+	vVoices[1].fAudibility = 0.01f;
+	virtualizer.update(vVoices, 0.0);
+	REQUIRE(vVoices[1].bBecameVirtual);
+
+	virtualizer.update(vVoices, 0.1);
+	REQUIRE(vVoices[1].bFinished == false);
+
+	virtualizer.update(vVoices, 0.2);
+	REQUIRE(vVoices[1].bFinished);
+	REQUIRE(vVoices[1].bActive == false);
+	REQUIRE(vVoices[1].dPositionInSec == 1.0);
+}
+
+TEST_CASE("Distance attenuation matches the volume curve.", "[SVoiceVirtualizerTests::attenuation]") {
+	const std::vector<SCurvePoint> vNoCurve;
+
+	// Inverse distance.
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(0.5f, 1.0f, vNoCurve) == 1.0f);
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(4.0f, 1.0f, vNoCurve) == Approx(0.25f));
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(4.0f, 2.0f, vNoCurve) == Approx(0.5f));
+
+	// Full volume up to 10, silent after 20 (see S3DSoundProps).
+	const std::vector<SCurvePoint> vCurve = { { 10.0f, 1.0f }, { 20.0f, 0.0f } };
+
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(5.0f, 1.0f, vCurve) == 1.0f);
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(15.0f, 1.0f, vCurve) == Approx(0.5f));
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(25.0f, 1.0f, vCurve) == 0.0f);
+	REQUIRE(SVoiceVirtualizer::getDistanceAttenuation(30.0f, 2.0f, vCurve) == Approx(0.5f));
+}
+
+TEST_CASE("Benchmark virtualizing 1000 emitters.", "[.][benchmark][SVoiceVirtualizerTests::benchmark]") {
+	const size_t iEmitterCount = 1000;
+
+	SVoiceVirtualizer virtualizer(64);
+
+	std::vector<SVirtualVoice> vVoices(iEmitterCount);
+
+	uint32_t iState = 1;
+
+	BENCHMARK("one tick") {
+		// Emitters move around the listener.
+		for (size_t i = 0; i < vVoices.size(); i++)
+		{
+			iState = iState * 1664525u + 1013904223u;
+
+			vVoices[i].fAudibility = (iState >> 8) / 16777216.0f;
+			vVoices[i].iPriority = static_cast<int>(i % 3);
+			vVoices[i].dLengthInSec = 1000.0;
+			vVoices[i].bActive = true;
+		}
+
+		virtualizer.update(vVoices, 1.0 / 60);
+
+		return vVoices[0].bReal;
+	};
+
+	SVoiceVirtualizerStats stats = virtualizer.getStats();
+	REQUIRE(stats.iRealVoiceCount == 64);
+}
@@ -6,6 +6,7 @@
 // ******************************************************************
 
 #define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
 #include <iostream>
 #include "Catch2/catch.hpp"
 